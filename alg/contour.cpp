@@ -34,14 +34,21 @@
 #include "utility.h"
 #include "contour_generator.h"
 #include "segment_merger.h"
+#include "stripe_merger.h"
 
 #include "gdal.h"
 #include "gdal_alg.h"
+#include "gdal_alg_priv.h"
 #include "cpl_conv.h"
 #include "cpl_string.h"
 #include "ogr_api.h"
 #include "ogr_srs_api.h"
 #include "ogr_geometry.h"
+#include "cpl_worker_thread_pool.h"
+
+#include <algorithm>
+#include <deque>
+#include <memory>
 
 static CPLErr OGRPolygonContourWriter( double dfLevelMin, double dfLevelMax,
                                 const OGRMultiPolygon& multipoly,
@@ -251,6 +258,224 @@ CPLErr OGRContourWriter( double dfLevel,
     return eErr == OGRERR_NONE ? CE_None : CE_Failure;
 }
 
+/************************************************************************/
+/*                         ContourStripeJob                             */
+/************************************************************************/
+
+namespace {
+
+// Contour generation on a horizontal stripe of the raster, run by a worker
+// thread.
+template <typename LevelGenerator>
+struct ContourStripeJob
+{
+    size_t startLine = 0;
+    size_t lineCount = 0;
+    size_t width = 0;
+    size_t height = 0;
+    bool hasNoData = false;
+    double noDataValue = 0.0;
+    bool polygonize = false;
+    LevelGenerator* levels = nullptr;
+    // Values of line startLine - 1 (when startLine > 0), followed by the
+    // values of the lineCount lines of the stripe.
+    std::vector<double> values{};
+    std::vector<marching_squares::StripeLine> lines{};
+    std::string errorMsg{};
+    GDALJobDoneFlag done{};
+};
+
+template <typename LevelGenerator>
+void ContourStripeJobFunc( void* pData )
+{
+    using namespace marching_squares;
+    ContourStripeJob<LevelGenerator>* job =
+        static_cast<ContourStripeJob<LevelGenerator>*>(pData);
+    try
+    {
+        StripeLineCollector collector( job->lines );
+        SegmentMerger<StripeLineCollector, LevelGenerator> merger(
+            collector, *job->levels, job->polygonize );
+        ContourGenerator<decltype(merger), LevelGenerator> cg(
+            job->width, job->height, job->hasNoData, job->noDataValue,
+            merger, *job->levels );
+        const bool hasPreviousLine = job->startLine > 0;
+        cg.setStartLine( job->startLine,
+                         hasPreviousLine ? &job->values[0] : nullptr );
+        const double* line = &job->values[hasPreviousLine ? job->width : 0];
+        for ( size_t i = 0; i < job->lineCount; i++, line += job->width )
+            cg.feedLine( line );
+    }
+    catch (const std::exception & e)
+    {
+        job->errorMsg = e.what();
+    }
+    // Free the input values as soon as possible.
+    std::vector<double>().swap( job->values );
+
+    job->done.SetDone();
+}
+
+// Number of lines of a stripe: about 8 MB of Float64 values and at least
+// one stripe per thread, but not too small to limit the number of lines
+// cut at stripe boundaries.
+size_t ContourGetStripeHeight( size_t width, size_t height, int nThreads )
+{
+    const size_t minStripeHeight = 16;
+    size_t stripeHeight = ( 8 * 1024 * 1024 / sizeof(double) ) / width;
+    stripeHeight = std::min( stripeHeight,
+                             ( height + nThreads - 1 ) / nThreads );
+    return std::max( stripeHeight, minStripeHeight );
+}
+
+/************************************************************************/
+/*                    ContourGenerateMultiThreaded()                    */
+/************************************************************************/
+
+// Raster lines are read by the calling thread and contoured in stripes by
+// a pool of worker threads. Stripes are then merged in order, so that the
+// output does not depend on the scheduling of the threads.
+template <typename LineWriter, typename LevelGenerator>
+bool ContourGenerateMultiThreaded( GDALRasterBandH hBand,
+                                   bool useNoData, double noDataValue,
+                                   LineWriter& lineWriter,
+                                   LevelGenerator& levels, bool polygonize,
+                                   int nThreads,
+                                   GDALProgressFunc pfnProgress,
+                                   void* pProgressArg )
+{
+    using namespace marching_squares;
+    typedef ContourStripeJob<LevelGenerator> Job;
+
+    const size_t width = GDALGetRasterBandXSize( hBand );
+    const size_t height = GDALGetRasterBandYSize( hBand );
+    const size_t stripeHeight = ContourGetStripeHeight( width, height, nThreads );
+    const size_t maxJobsInFlight = 2 * static_cast<size_t>(nThreads);
+
+    // Must be declared before the pool, so that jobs are destroyed after
+    // they have completed.
+    std::deque<std::unique_ptr<Job>> jobs;
+
+    CPLWorkerThreadPool oPool;
+    if ( !oPool.Setup( nThreads, nullptr, nullptr ) )
+        return false;
+
+    StripeMerger<LineWriter> stripeMerger( lineWriter );
+
+    // Wait for the completion of the oldest job and merge its lines.
+    const auto mergeFirstJob = [&]()
+    {
+        Job* job = jobs.front().get();
+        job->done.Wait();
+        bool bRet = true;
+        if ( !job->errorMsg.empty() )
+        {
+            CPLError( CE_Failure, CPLE_AppDefined, "%s", job->errorMsg.c_str() );
+            bRet = false;
+        }
+        else
+        {
+            const size_t endLine = job->startLine + job->lineCount;
+            stripeMerger.addStripe( job->lines, endLine - .5, endLine == height );
+            if ( pfnProgress( double(endLine) / height, "Processing line",
+                              pProgressArg ) == FALSE )
+            {
+                CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+                bRet = false;
+            }
+        }
+        jobs.pop_front();
+        return bRet;
+    };
+
+    bool ok = true;
+    std::vector<double> lastLine;
+    for ( size_t startLine = 0; ok && startLine < height; startLine += stripeHeight )
+    {
+        if ( jobs.size() == maxJobsInFlight && !mergeFirstJob() )
+        {
+            ok = false;
+            break;
+        }
+
+        std::unique_ptr<Job> job( new Job() );
+        job->startLine = startLine;
+        job->lineCount = std::min( stripeHeight, height - startLine );
+        job->width = width;
+        job->height = height;
+        job->hasNoData = useNoData;
+        job->noDataValue = noDataValue;
+        job->polygonize = polygonize;
+        job->levels = &levels;
+
+        const size_t offset = lastLine.empty() ? 0 : width;
+        job->values.resize( offset + job->lineCount * width );
+        std::copy( lastLine.begin(), lastLine.end(), job->values.begin() );
+        CPLErr error = GDALRasterIO( hBand, GF_Read, 0, int(startLine),
+                                     int(width), int(job->lineCount),
+                                     &job->values[offset],
+                                     int(width), int(job->lineCount),
+                                     GDT_Float64, 0, 0 );
+        if ( error != CE_None )
+        {
+            CPLDebug( "CONTOUR", "failed fetch %d %d", int(startLine), int(width) );
+            ok = false;
+            break;
+        }
+        lastLine.assign( job->values.end() - width, job->values.end() );
+
+        jobs.push_back( std::move(job) );
+        if ( !oPool.SubmitJob( ContourStripeJobFunc<LevelGenerator>, jobs.back().get() ) )
+        {
+            jobs.pop_back();
+            ok = false;
+        }
+    }
+
+    while ( ok && !jobs.empty() )
+        ok = mergeFirstJob();
+    oPool.WaitCompletion();
+    if ( ok )
+        stripeMerger.flush();
+
+    if ( ok )
+        pfnProgress( 1.0, "", pProgressArg );
+    return ok;
+}
+
+/************************************************************************/
+/*                          ContourGenerate()                           */
+/************************************************************************/
+
+template <typename LineWriter, typename LevelGenerator>
+bool ContourGenerate( GDALRasterBandH hBand,
+                      bool useNoData, double noDataValue,
+                      LineWriter& lineWriter,
+                      LevelGenerator& levels, bool polygonize,
+                      int nThreads,
+                      GDALProgressFunc pfnProgress, void* pProgressArg )
+{
+    using namespace marching_squares;
+
+    const size_t width = GDALGetRasterBandXSize( hBand );
+    const size_t height = GDALGetRasterBandYSize( hBand );
+    if ( nThreads > 1 && width > 0 &&
+         ContourGetStripeHeight( width, height, nThreads ) < height )
+    {
+        return ContourGenerateMultiThreaded( hBand, useNoData, noDataValue,
+                                             lineWriter, levels, polygonize,
+                                             nThreads, pfnProgress,
+                                             pProgressArg );
+    }
+
+    SegmentMerger<LineWriter, LevelGenerator> writer( lineWriter, levels, polygonize );
+    ContourGeneratorFromRaster<decltype(writer), LevelGenerator> cg(
+        hBand, useNoData, noDataValue, writer, levels );
+    return cg.process( pfnProgress, pProgressArg );
+}
+
+} // namespace
+
 /************************************************************************/
 /*                        GDALContourGenerate()                         */
 /************************************************************************/
@@ -517,6 +742,14 @@ an averaged value from the two nearby points (in this case (12+3+5)/3).
  *
  * If YES, contour polygons will be created, rather than polygon lines.
  *
+ *   NUM_THREADS=d|ALL_CPUS
+ *
+ * (GDAL >= 3.1) Number of worker threads used to generate contours. When
+ * greater than 1, horizontal stripes of the raster are contoured concurrently
+ * and the lines cut at stripe boundaries are joined afterwards. Features are
+ * still written to the layer from the calling thread. Defaults to the value
+ * of the GDAL_NUM_THREADS configuration option, or 1.
+ *
  *
  * @return CE_None on success or CE_Failure if an error occurs.
  */
@@ -600,6 +833,9 @@ CPLErr GDALContourGenerateEx( GDALRasterBandH hBand, void *hLayer,
 
     bool polygonize = CPLFetchBool( options, "POLYGONIZE", false );
 
+    const int nThreads = CPLGetNumThreadsOption(
+        CSLFetchNameValue( options, "NUM_THREADS" ), "1" );
+
     using namespace marching_squares;
 
     OGRContourWriterInfo oCWI;
@@ -630,21 +866,18 @@ CPLErr GDALContourGenerateEx( GDALRasterBandH hBand, void *hLayer,
             RingAppender appender( w );
             if ( ! fixedLevels.empty() ) {
                 FixedLevelRangeIterator levels( &fixedLevels[0], fixedLevels.size(), GDALGetRasterMaximum( hBand, &bSuccess ) );
-                SegmentMerger<RingAppender, FixedLevelRangeIterator> writer(appender, levels, /* polygonize */ true);
-                ContourGeneratorFromRaster<decltype(writer), FixedLevelRangeIterator> cg( hBand, useNoData, noDataValue, writer, levels );
-                ok = cg.process( pfnProgress, pProgressArg );
+                ok = ContourGenerate( hBand, useNoData, noDataValue, appender, levels, /* polygonize */ true,
+                                      nThreads, pfnProgress, pProgressArg );
             }
             else if ( expBase > 0.0 ) {
                 ExponentialLevelRangeIterator levels( expBase );
-                SegmentMerger<RingAppender, ExponentialLevelRangeIterator> writer(appender, levels, /* polygonize */ true);
-                ContourGeneratorFromRaster<decltype(writer), ExponentialLevelRangeIterator> cg( hBand, useNoData, noDataValue, writer, levels );
-                ok = cg.process( pfnProgress, pProgressArg );
+                ok = ContourGenerate( hBand, useNoData, noDataValue, appender, levels, /* polygonize */ true,
+                                      nThreads, pfnProgress, pProgressArg );
             }
             else {
                 IntervalLevelRangeIterator levels( contourBase, contourInterval );
-                SegmentMerger<RingAppender, IntervalLevelRangeIterator> writer(appender, levels, /* polygonize */ true);
-                ContourGeneratorFromRaster<decltype(writer), IntervalLevelRangeIterator> cg( hBand, useNoData, noDataValue, writer, levels );
-                ok = cg.process( pfnProgress, pProgressArg );
+                ok = ContourGenerate( hBand, useNoData, noDataValue, appender, levels, /* polygonize */ true,
+                                      nThreads, pfnProgress, pProgressArg );
             }
         }
         else
@@ -652,21 +885,18 @@ CPLErr GDALContourGenerateEx( GDALRasterBandH hBand, void *hLayer,
             GDALRingAppender appender(OGRContourWriter, &oCWI);
             if ( ! fixedLevels.empty() ) {
                 FixedLevelRangeIterator levels( &fixedLevels[0], fixedLevels.size() );
-                SegmentMerger<GDALRingAppender, FixedLevelRangeIterator> writer(appender, levels, /* polygonize */ false);
-                ContourGeneratorFromRaster<decltype(writer), FixedLevelRangeIterator> cg( hBand, useNoData, noDataValue, writer, levels );
-                ok = cg.process( pfnProgress, pProgressArg );
+                ok = ContourGenerate( hBand, useNoData, noDataValue, appender, levels, /* polygonize */ false,
+                                      nThreads, pfnProgress, pProgressArg );
             }
             else if ( expBase > 0.0 ) {
                 ExponentialLevelRangeIterator levels( expBase );
-                SegmentMerger<GDALRingAppender, ExponentialLevelRangeIterator> writer(appender, levels, /* polygonize */ false);
-                ContourGeneratorFromRaster<decltype(writer), ExponentialLevelRangeIterator> cg( hBand, useNoData, noDataValue, writer, levels );
-                ok = cg.process( pfnProgress, pProgressArg );
+                ok = ContourGenerate( hBand, useNoData, noDataValue, appender, levels, /* polygonize */ false,
+                                      nThreads, pfnProgress, pProgressArg );
             }
             else {
                 IntervalLevelRangeIterator levels( contourBase, contourInterval );
-                SegmentMerger<GDALRingAppender, IntervalLevelRangeIterator> writer(appender, levels, /* polygonize */ false);
-                ContourGeneratorFromRaster<decltype(writer), IntervalLevelRangeIterator> cg( hBand, useNoData, noDataValue, writer, levels );
-                ok = cg.process( pfnProgress, pProgressArg );
+                ok = ContourGenerate( hBand, useNoData, noDataValue, appender, levels, /* polygonize */ false,
+                                      nThreads, pfnProgress, pProgressArg );
             }
         }
     }
@@ -65,6 +65,14 @@ int CPL_DLL CPL_STDCALL GDALDitherRGB2PCT( GDALRasterBandH hRed,
 int CPL_DLL CPL_STDCALL GDALChecksumImage( GDALRasterBandH hBand,
                                int nXOff, int nYOff, int nXSize, int nYSize );
 
+CPLErr CPL_DLL GDALChecksumImageEx( GDALRasterBandH hBand,
+                                    int nXOff, int nYOff,
+                                    int nXSize, int nYSize,
+                                    CSLConstList papszOptions,
+                                    GUIntBig* pnHash,
+                                    GDALProgressFunc pfnProgress,
+                                    void* pProgressData );
+
 CPLErr CPL_DLL CPL_STDCALL
 GDALComputeProximity( GDALRasterBandH hSrcBand,
                       GDALRasterBandH hProximityBand,
@@ -243,6 +251,8 @@ GDALCreateApproxTransformer( GDALTransformerFunc pfnRawTransformer,
                              void *pRawTransformerArg, double dfMaxError );
 void CPL_DLL GDALApproxTransformerOwnsSubtransformer( void *pCBData,
                                                       int bOwnFlag );
+void CPL_DLL GDALApproxTransformerSetGridStep( void *pCBData,
+                                               double dfGridStep );
 void CPL_DLL GDALDestroyApproxTransformer( void *pApproxArg );
 int  CPL_DLL GDALApproxTransform(
     void *pTransformArg, int bDstToSrc, int nPointCount,
@@ -373,6 +383,19 @@ GDALViewshedGenerate(GDALRasterBandH hBand,
                      GDALProgressFunc pfnProgress, void *pProgressArg,
                      GDALViewshedOutputType heightMode, CSLConstList papszExtraOptions);
 
+GDALDatasetH CPL_DLL
+GDALViewshedGenerateCumulative(GDALRasterBandH hBand,
+                               const char* pszDriverName,
+                               const char* pszTargetRasterName,
+                               CSLConstList papszCreationOptions,
+                               int nObserverCount,
+                               const double* padfObserverX, const double* padfObserverY,
+                               double dfObserverHeight, double dfTargetHeight,
+                               double dfCurvCoeff, GDALViewshedMode eMode,
+                               double dfMaxDistance,
+                               GDALProgressFunc pfnProgress, void *pProgressArg,
+                               CSLConstList papszExtraOptions);
+
 /************************************************************************/
 /*      Rasterizer API - geometries burned into GDAL raster.            */
 /************************************************************************/
@@ -37,6 +37,9 @@
 #include "gdal_alg.h"
 #include "ogr_spatialref.h"
 
+#include <condition_variable>
+#include <mutex>
+
 CPL_C_START
 
 /** Source of the burn value */
@@ -243,6 +246,36 @@ bool GDALComputeAreaOfInterest(OGRSpatialReference* poSRS,
                                double& dfEastLongitudeDeg,
                                double& dfNorthLatitudeDeg );
 
+/************************************************************************/
+/*                           GDALJobDoneFlag                            */
+/************************************************************************/
+
+/* Completion of a job run by a worker thread, which the thread that */
+/* submitted it waits for to consume its result. */
+class GDALJobDoneFlag
+{
+    std::mutex              m_oMutex{};
+    std::condition_variable m_oCV{};
+    bool                    m_bDone = false;
+
+    CPL_DISALLOW_COPY_ASSIGN(GDALJobDoneFlag)
+
+public:
+    GDALJobDoneFlag() = default;
+
+    void SetDone()
+    {
+        std::lock_guard<std::mutex> oLock(m_oMutex);
+        m_bDone = true;
+        m_oCV.notify_all();
+    }
+
+    void Wait()
+    {
+        std::unique_lock<std::mutex> oLock(m_oMutex);
+        m_oCV.wait(oLock, [this]() { return m_bDone; });
+    }
+};
 
 #endif /* #ifndef DOXYGEN_SKIP */
 
@@ -32,10 +32,17 @@
 
 #include <cmath>
 #include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
+#include "cpl_string.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal.h"
 
 
@@ -178,3 +185,613 @@ GDALChecksumImage( GDALRasterBandH hBand,
 
     return nChecksum;
 }
+
+/************************************************************************/
+/*                              GDALXXH64                               */
+/************************************************************************/
+
+namespace {
+
+// Streaming implementation of the XXH64 hash algorithm by Yann Collet
+// (https://github.com/Cyan4973/xxHash), with a seed of 0. Its four
+// independent accumulators let the CPU process 32 bytes per iteration.
+class GDALXXH64
+{
+    static constexpr GUInt64 PRIME1 = 0x9E3779B185EBCA87ULL;
+    static constexpr GUInt64 PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+    static constexpr GUInt64 PRIME3 = 0x165667B19E3779F9ULL;
+    static constexpr GUInt64 PRIME4 = 0x85EBCA77C2B2AE63ULL;
+    static constexpr GUInt64 PRIME5 = 0x27D4EB2F165667C5ULL;
+
+    GUInt64 m_anAcc[4] = { PRIME1 + PRIME2, PRIME2, 0, 0 - PRIME1 };
+    GByte   m_abyPending[32] = {};
+    size_t  m_nPending = 0;
+    GUInt64 m_nTotalSize = 0;
+
+    static inline GUInt64 RotateLeft( GUInt64 nVal, int nBits )
+    {
+        return (nVal << nBits) | (nVal >> (64 - nBits));
+    }
+
+    static inline GUInt64 Read64( const GByte* pabyData )
+    {
+        GUInt64 nVal;
+        memcpy(&nVal, pabyData, sizeof(nVal));
+        CPL_LSBPTR64(&nVal);
+        return nVal;
+    }
+
+    static inline GUInt32 Read32( const GByte* pabyData )
+    {
+        GUInt32 nVal;
+        memcpy(&nVal, pabyData, sizeof(nVal));
+        CPL_LSBPTR32(&nVal);
+        return nVal;
+    }
+
+    static inline GUInt64 Round( GUInt64 nAcc, GUInt64 nInput )
+    {
+        nAcc += nInput * PRIME2;
+        nAcc = RotateLeft(nAcc, 31);
+        return nAcc * PRIME1;
+    }
+
+    static inline GUInt64 MergeRound( GUInt64 nAcc, GUInt64 nVal )
+    {
+        nAcc ^= Round(0, nVal);
+        return nAcc * PRIME1 + PRIME4;
+    }
+
+    inline void ProcessStripe( const GByte* pabyData )
+    {
+        m_anAcc[0] = Round(m_anAcc[0], Read64(pabyData));
+        m_anAcc[1] = Round(m_anAcc[1], Read64(pabyData + 8));
+        m_anAcc[2] = Round(m_anAcc[2], Read64(pabyData + 16));
+        m_anAcc[3] = Round(m_anAcc[3], Read64(pabyData + 24));
+    }
+
+  public:
+    void Update( const void* pData, size_t nSize )
+    {
+        const GByte* pabyData = static_cast<const GByte*>(pData);
+        m_nTotalSize += nSize;
+
+        if( m_nPending + nSize < 32 )
+        {
+            memcpy(m_abyPending + m_nPending, pabyData, nSize);
+            m_nPending += nSize;
+            return;
+        }
+
+        if( m_nPending > 0 )
+        {
+            const size_t nFill = 32 - m_nPending;
+            memcpy(m_abyPending + m_nPending, pabyData, nFill);
+            ProcessStripe(m_abyPending);
+            pabyData += nFill;
+            nSize -= nFill;
+            m_nPending = 0;
+        }
+
+        for( ; nSize >= 32; pabyData += 32, nSize -= 32 )
+            ProcessStripe(pabyData);
+
+        memcpy(m_abyPending, pabyData, nSize);
+        m_nPending = nSize;
+    }
+
+    void Update( GUInt64 nVal )
+    {
+        CPL_LSBPTR64(&nVal);
+        Update(&nVal, sizeof(nVal));
+    }
+
+    GUInt64 Digest() const
+    {
+        GUInt64 nHash;
+        if( m_nTotalSize >= 32 )
+        {
+            nHash = RotateLeft(m_anAcc[0], 1) + RotateLeft(m_anAcc[1], 7) +
+                    RotateLeft(m_anAcc[2], 12) + RotateLeft(m_anAcc[3], 18);
+            for( int i = 0; i < 4; i++ )
+                nHash = MergeRound(nHash, m_anAcc[i]);
+        }
+        else
+        {
+            nHash = PRIME5;
+        }
+        nHash += m_nTotalSize;
+
+        const GByte* pabyData = m_abyPending;
+        size_t nSize = m_nPending;
+        for( ; nSize >= 8; pabyData += 8, nSize -= 8 )
+        {
+            nHash ^= Round(0, Read64(pabyData));
+            nHash = RotateLeft(nHash, 27) * PRIME1 + PRIME4;
+        }
+        if( nSize >= 4 )
+        {
+            nHash ^= static_cast<GUInt64>(Read32(pabyData)) * PRIME1;
+            nHash = RotateLeft(nHash, 23) * PRIME2 + PRIME3;
+            pabyData += 4;
+            nSize -= 4;
+        }
+        for( ; nSize > 0; pabyData++, nSize-- )
+        {
+            nHash ^= *pabyData * PRIME5;
+            nHash = RotateLeft(nHash, 11) * PRIME1;
+        }
+
+        nHash ^= nHash >> 33;
+        nHash *= PRIME2;
+        nHash ^= nHash >> 29;
+        nHash *= PRIME3;
+        nHash ^= nHash >> 32;
+        return nHash;
+    }
+};
+
+/************************************************************************/
+/*                         GDALChecksumChunk                            */
+/************************************************************************/
+
+// Unit of work of GDALChecksumImageEx(): a range of lines of pixels, or a
+// block as stored in the file.
+struct GDALChecksumChunk
+{
+    // MODE=PIXELS
+    const GByte  *pabyData = nullptr;
+    GSpacing      nLineSpace = 0;
+    int           nLines = 0;
+    size_t        nLineBytes = 0;
+
+    // MODE=RAW_BLOCKS
+    vsi_l_offset  nOffset = 0;
+    size_t        nRawSize = 0;
+    bool          bAvailable = false;
+
+    GUInt64       nHash = 0;
+    bool          bError = false;
+};
+
+struct GDALChecksumJob
+{
+    std::vector<GDALChecksumChunk> *paoChunks = nullptr;
+    size_t                          iFirst = 0;
+    size_t                          iEnd = 0;
+    int                             iSlot = 0;
+    int                             nSlots = 1;
+    VSILFILE                       *fp = nullptr;
+    std::vector<GByte>             *pabyBuffer = nullptr;
+};
+
+void GDALHashPixelChunk( GDALChecksumChunk& oChunk )
+{
+    GDALXXH64 oHash;
+    for( int iLine = 0; iLine < oChunk.nLines; iLine++ )
+    {
+        oHash.Update(oChunk.pabyData + iLine * oChunk.nLineSpace,
+                     oChunk.nLineBytes);
+    }
+    oChunk.nHash = oHash.Digest();
+}
+
+void GDALHashRawChunk( GDALChecksumChunk& oChunk, VSILFILE* fp,
+                       std::vector<GByte>& abyBuffer )
+{
+    if( !oChunk.bAvailable )
+    {
+        // Sparse block.
+        oChunk.nHash = 0;
+        return;
+    }
+    try
+    {
+        abyBuffer.resize(oChunk.nRawSize);
+    }
+    catch( const std::exception& )
+    {
+        oChunk.bError = true;
+        return;
+    }
+    if( VSIFSeekL(fp, oChunk.nOffset, SEEK_SET) != 0 ||
+        VSIFReadL(abyBuffer.data(), 1, oChunk.nRawSize, fp) !=
+                                                        oChunk.nRawSize )
+    {
+        oChunk.bError = true;
+        return;
+    }
+    GDALXXH64 oHash;
+    oHash.Update(abyBuffer.data(), oChunk.nRawSize);
+    oChunk.nHash = oHash.Digest();
+}
+
+void GDALChecksumJobFunc( void* pData )
+{
+    GDALChecksumJob* psJob = static_cast<GDALChecksumJob*>(pData);
+    std::vector<GDALChecksumChunk>& aoChunks = *(psJob->paoChunks);
+    for( size_t i = psJob->iFirst + psJob->iSlot; i < psJob->iEnd;
+         i += psJob->nSlots )
+    {
+        if( psJob->fp != nullptr )
+            GDALHashRawChunk(aoChunks[i], psJob->fp, *(psJob->pabyBuffer));
+        else
+            GDALHashPixelChunk(aoChunks[i]);
+    }
+}
+
+} // namespace
+
+/************************************************************************/
+/*                        GDALChecksumImageEx()                         */
+/************************************************************************/
+
+/**
+ * Compute a 64 bit content hash for an image region.
+ *
+ * Unlike GDALChecksumImage(), all the bits of the pixel values are taken
+ * into account, and the hash is computed with the XXH64 algorithm, so that
+ * different contents are very unlikely to give the same hash.
+ *
+ * The region is split into chunks of consecutive lines of about 1 MB,
+ * which are hashed independently, possibly in parallel, and the result is
+ * the hash of the sequence of chunk hashes. The hash of a given content
+ * does not depend on the number of threads, on the block layout of the
+ * dataset nor on the byte order of the host.
+ *
+ * Supported options:
+ * <ul>
+ * <li>MODE=PIXELS/RAW_BLOCKS. PIXELS (default) hashes the pixel values, in
+ * the data type of the band. RAW_BLOCKS hashes the bytes of each block as
+ * stored in the file, in block order, without decoding them. This is much
+ * faster for compressed files, but the hash then also depends on the
+ * compression and layout of the file. It requires the whole band to be
+ * selected, and a driver that reports the location of blocks with the
+ * BLOCK_OFFSET_[xblock]_[yblock] and BLOCK_SIZE_[xblock]_[yblock] band
+ * metadata items of the TIFF domain, such as the GTiff driver (which also
+ * reads COG files). Sparse blocks are hashed as a zero value.</li>
+ * <li>NUM_THREADS=number_of_threads/ALL_CPUS. Number of threads used to
+ * hash the chunks. Defaults to the value of the GDAL_NUM_THREADS
+ * configuration option, or 1.</li>
+ * </ul>
+ *
+ * @param hBand the raster band to read from.
+ * @param nXOff pixel offset of window to read.
+ * @param nYOff line offset of window to read.
+ * @param nXSize pixel size of window to read.
+ * @param nYSize line size of window to read.
+ * @param papszOptions NULL terminated list of options, or NULL.
+ * @param pnHash location where to store the hash.
+ * @param pfnProgress a function to call to report progress, or NULL.
+ * @param pProgressData application data to pass to the progress function.
+ *
+ * @return CE_None on success, or CE_Failure if an error occurs or processing
+ * is terminated by the user.
+ *
+ * @since GDAL 3.1
+ */
+
+CPLErr GDALChecksumImageEx( GDALRasterBandH hBand,
+                            int nXOff, int nYOff, int nXSize, int nYSize,
+                            CSLConstList papszOptions,
+                            GUIntBig* pnHash,
+                            GDALProgressFunc pfnProgress,
+                            void* pProgressData )
+{
+    VALIDATE_POINTER1( hBand, "GDALChecksumImageEx", CE_Failure );
+    VALIDATE_POINTER1( pnHash, "GDALChecksumImageEx", CE_Failure );
+
+    if( pfnProgress == nullptr )
+        pfnProgress = GDALDummyProgress;
+    *pnHash = 0;
+
+    const int nRasterXSize = GDALGetRasterBandXSize(hBand);
+    const int nRasterYSize = GDALGetRasterBandYSize(hBand);
+    if( nXOff < 0 || nYOff < 0 || nXSize <= 0 || nYSize <= 0 ||
+        nXSize > nRasterXSize - nXOff || nYSize > nRasterYSize - nYOff )
+    {
+        CPLError( CE_Failure, CPLE_IllegalArg,
+                  "Invalid window: %d,%d,%d,%d for a %dx%d band",
+                  nXOff, nYOff, nXSize, nYSize, nRasterXSize, nRasterYSize );
+        return CE_Failure;
+    }
+
+    const char* pszMode = CSLFetchNameValueDef(papszOptions, "MODE", "PIXELS");
+    const bool bRawBlocks = EQUAL(pszMode, "RAW_BLOCKS");
+    if( !bRawBlocks && !EQUAL(pszMode, "PIXELS") )
+    {
+        CPLError( CE_Failure, CPLE_NotSupported,
+                  "Unsupported value for MODE: %s", pszMode );
+        return CE_Failure;
+    }
+
+    int nThreads = CPLGetNumThreadsOption(
+        CSLFetchNameValue(papszOptions, "NUM_THREADS"), "1");
+
+    const GDALDataType eDataType = GDALGetRasterDataType(hBand);
+    const int nDTSize = GDALGetDataTypeSizeBytes(eDataType);
+    GDALXXH64 oHash;
+    std::vector<GDALChecksumChunk> aoChunks;
+
+    // Hashing of pixels: chunks of nChunkLines lines.
+    int nChunkLines = 0;
+    const size_t nLineBytes = static_cast<size_t>(nXSize) * nDTSize;
+    const GByte* pabyView = nullptr;
+    GSpacing nViewLineSpace = 0;
+    // Chunks of pixels are read in two sets of buffers, so that a set can
+    // be read while the other one is hashed.
+    std::vector<GByte> abyBuffers[2];
+
+    // Hashing of raw blocks.
+    std::vector<VSILFILE*> apoFiles;
+    std::vector<std::vector<GByte>> aabyRawBuffers;
+
+    if( bRawBlocks )
+    {
+        if( nXOff != 0 || nYOff != 0 ||
+            nXSize != nRasterXSize || nYSize != nRasterYSize )
+        {
+            CPLError( CE_Failure, CPLE_NotSupported,
+                      "MODE=RAW_BLOCKS requires the whole band" );
+            return CE_Failure;
+        }
+
+        GDALDatasetH hDS = GDALGetBandDataset(hBand);
+        const char* pszFilename =
+            hDS != nullptr ? GDALGetDescription(hDS) : "";
+
+        int nBlockXSize = 0;
+        int nBlockYSize = 0;
+        GDALGetBlockSize( hBand, &nBlockXSize, &nBlockYSize );
+        const int nBlocksPerRow = (nRasterXSize - 1) / nBlockXSize + 1;
+        const int nBlocksPerColumn = (nRasterYSize - 1) / nBlockYSize + 1;
+
+        bool bHasOffsets = false;
+        try
+        {
+            aoChunks.resize(static_cast<size_t>(nBlocksPerRow) *
+                                                        nBlocksPerColumn);
+        }
+        catch( const std::exception& )
+        {
+            CPLError( CE_Failure, CPLE_OutOfMemory, "Out of memory" );
+            return CE_Failure;
+        }
+        for( int iYBlock = 0; iYBlock < nBlocksPerColumn; iYBlock++ )
+        {
+            for( int iXBlock = 0; iXBlock < nBlocksPerRow; iXBlock++ )
+            {
+                GDALChecksumChunk& oChunk = aoChunks[
+                    static_cast<size_t>(iYBlock) * nBlocksPerRow + iXBlock];
+                const char* pszOffset = GDALGetMetadataItem(
+                    hBand, CPLSPrintf("BLOCK_OFFSET_%d_%d", iXBlock, iYBlock),
+                    "TIFF");
+                const char* pszSize = GDALGetMetadataItem(
+                    hBand, CPLSPrintf("BLOCK_SIZE_%d_%d", iXBlock, iYBlock),
+                    "TIFF");
+                if( pszOffset == nullptr || pszSize == nullptr )
+                    continue;
+                const GUIntBig nSize = CPLScanUIntBig(
+                    pszSize, static_cast<int>(strlen(pszSize)));
+                if( nSize != static_cast<size_t>(nSize) )
+                {
+                    CPLError( CE_Failure, CPLE_AppDefined,
+                              "Block %d,%d is too large", iXBlock, iYBlock );
+                    return CE_Failure;
+                }
+                oChunk.nOffset = CPLScanUIntBig(
+                    pszOffset, static_cast<int>(strlen(pszOffset)));
+                oChunk.nRawSize = static_cast<size_t>(nSize);
+                oChunk.bAvailable = true;
+                bHasOffsets = true;
+            }
+        }
+        if( !bHasOffsets )
+        {
+            CPLError( CE_Failure, CPLE_NotSupported,
+                      "MODE=RAW_BLOCKS is not supported for this band: "
+                      "the location of its blocks is not reported in the "
+                      "TIFF metadata domain" );
+            return CE_Failure;
+        }
+
+        nThreads = static_cast<int>(
+            std::min(static_cast<size_t>(nThreads), aoChunks.size()));
+        for( int i = 0; i < nThreads; i++ )
+        {
+            VSILFILE* fp = VSIFOpenL(pszFilename, "rb");
+            if( fp == nullptr )
+            {
+                CPLError( CE_Failure, CPLE_OpenFailed,
+                          "Cannot open %s", pszFilename );
+                for( VSILFILE* fpOther: apoFiles )
+                    VSIFCloseL(fpOther);
+                return CE_Failure;
+            }
+            apoFiles.push_back(fp);
+        }
+        aabyRawBuffers.resize(nThreads);
+
+        oHash.Update(static_cast<GUInt64>(nBlockXSize));
+        oHash.Update(static_cast<GUInt64>(nBlockYSize));
+    }
+    else
+    {
+        nChunkLines = static_cast<int>(std::max<size_t>(1,
+            std::min<size_t>(nYSize, 1024 * 1024 / nLineBytes)));
+        aoChunks.resize((nYSize - 1) / nChunkLines + 1);
+        for( size_t i = 0; i < aoChunks.size(); i++ )
+        {
+            aoChunks[i].nLines = std::min(nChunkLines,
+                nYSize - static_cast<int>(i) * nChunkLines);
+            aoChunks[i].nLineBytes = nLineBytes;
+        }
+        nThreads = static_cast<int>(
+            std::min(static_cast<size_t>(nThreads), aoChunks.size()));
+
+#ifdef CPL_LSB
+        // Memory mapped or in-memory bands are hashed in place.
+        GSpacing nViewPixelSpace = 0;
+        pabyView = static_cast<const GByte*>(
+            GDALGetDirectReadPointer(hBand, &nViewPixelSpace,
+                                     &nViewLineSpace));
+        if( pabyView != nullptr && nViewPixelSpace != nDTSize )
+            pabyView = nullptr;
+#endif
+        if( pabyView == nullptr )
+        {
+            const size_t nBufferSize =
+                static_cast<size_t>(nThreads) * nChunkLines * nLineBytes;
+            try
+            {
+                abyBuffers[0].resize(nBufferSize);
+                if( nThreads > 1 )
+                    abyBuffers[1].resize(nBufferSize);
+            }
+            catch( const std::exception& )
+            {
+                CPLError( CE_Failure, CPLE_OutOfMemory, "Out of memory" );
+                return CE_Failure;
+            }
+        }
+
+        oHash.Update(static_cast<GUInt64>(eDataType));
+    }
+    oHash.Update(static_cast<GUInt64>(nXSize));
+    oHash.Update(static_cast<GUInt64>(nYSize));
+
+    std::unique_ptr<CPLWorkerThreadPool> poPool;
+    if( nThreads > 1 )
+    {
+        poPool.reset(new CPLWorkerThreadPool());
+        if( !poPool->Setup(nThreads, nullptr, nullptr) )
+        {
+            poPool.reset();
+            nThreads = 1;
+        }
+    }
+
+    std::vector<GDALChecksumJob> asJobs(nThreads);
+    std::vector<void*> apJobs(nThreads);
+    for( int i = 0; i < nThreads; i++ )
+    {
+        asJobs[i].paoChunks = &aoChunks;
+        asJobs[i].iSlot = i;
+        asJobs[i].nSlots = nThreads;
+        if( bRawBlocks )
+        {
+            asJobs[i].fp = apoFiles[i];
+            asJobs[i].pabyBuffer = &aabyRawBuffers[i];
+        }
+        apJobs[i] = &asJobs[i];
+    }
+
+    // Chunks are processed in batches, so that progress can be reported
+    // and, for pixels, so that the next batch can be read while the
+    // current one is hashed.
+    const size_t nBatchSize = (bRawBlocks || pabyView != nullptr) ?
+                                static_cast<size_t>(nThreads) * 16 :
+                                static_cast<size_t>(nThreads);
+    CPLErr eErr = CE_None;
+    size_t iPendingFirst = 0;
+    size_t iPendingEnd = 0;
+    for( size_t iFirst = 0; eErr == CE_None; iFirst += nBatchSize )
+    {
+        const size_t iEnd = std::min(aoChunks.size(), iFirst + nBatchSize);
+
+        // Read the pixels of the next batch.
+        for( size_t i = iFirst; !bRawBlocks && i < iEnd; i++ )
+        {
+            GDALChecksumChunk& oChunk = aoChunks[i];
+            const int nYChunkOff =
+                nYOff + static_cast<int>(i) * nChunkLines;
+            if( pabyView != nullptr )
+            {
+                oChunk.pabyData = pabyView +
+                    static_cast<GPtrDiff_t>(nYChunkOff) * nViewLineSpace +
+                    static_cast<GPtrDiff_t>(nXOff) * nDTSize;
+                oChunk.nLineSpace = nViewLineSpace;
+                continue;
+            }
+
+            GByte* pabyBuffer =
+                abyBuffers[poPool ? (iFirst / nBatchSize) % 2 : 0].data() +
+                (i - iFirst) * nChunkLines * nLineBytes;
+            if( GDALRasterIO( hBand, GF_Read, nXOff, nYChunkOff,
+                              nXSize, oChunk.nLines,
+                              pabyBuffer, nXSize, oChunk.nLines, eDataType,
+                              0, 0 ) != CE_None )
+            {
+                CPLError( CE_Failure, CPLE_FileIO,
+                          "Checksum value could not be computed due to I/O "
+                          "read error." );
+                eErr = CE_Failure;
+                break;
+            }
+#ifdef CPL_MSB
+            if( nDTSize > 1 )
+            {
+                const int nWordSize = GDALDataTypeIsComplex(eDataType) ?
+                                                    nDTSize / 2 : nDTSize;
+                GDALSwapWords( pabyBuffer, nWordSize,
+                               static_cast<int>(nLineBytes / nWordSize *
+                                                oChunk.nLines),
+                               nWordSize );
+            }
+#endif
+            oChunk.pabyData = pabyBuffer;
+            oChunk.nLineSpace = static_cast<GSpacing>(nLineBytes);
+        }
+
+        // Wait for the previous batch.
+        if( poPool )
+            poPool->WaitCompletion();
+        for( size_t i = iPendingFirst; i < iPendingEnd; i++ )
+        {
+            if( aoChunks[i].bError )
+            {
+                CPLError( CE_Failure, CPLE_FileIO,
+                          "Checksum value could not be computed due to I/O "
+                          "read error." );
+                eErr = CE_Failure;
+                break;
+            }
+        }
+        if( eErr == CE_None && iPendingEnd > 0 &&
+            !pfnProgress( static_cast<double>(iPendingEnd) / aoChunks.size(),
+                          "", pProgressData ) )
+        {
+            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+            eErr = CE_Failure;
+        }
+        if( eErr != CE_None || iFirst >= iEnd )
+            break;
+
+        // Hash the batch.
+        for( auto& sJob: asJobs )
+        {
+            sJob.iFirst = iFirst;
+            sJob.iEnd = iEnd;
+        }
+        if( poPool )
+            poPool->SubmitJobs(GDALChecksumJobFunc, apJobs);
+        else
+            GDALChecksumJobFunc(apJobs[0]);
+        iPendingFirst = iFirst;
+        iPendingEnd = iEnd;
+    }
+
+    if( poPool )
+        poPool->WaitCompletion();
+    for( VSILFILE* fp: apoFiles )
+        VSIFCloseL(fp);
+
+    if( eErr != CE_None )
+        return eErr;
+
+    for( const auto& oChunk: aoChunks )
+        oHash.Update(oChunk.nHash);
+    *pnHash = oHash.Digest();
+
+    return CE_None;
+}
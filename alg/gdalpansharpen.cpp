@@ -31,12 +31,15 @@
 #include "gdalpansharpen.h"
 
 #include <algorithm>
+#include <condition_variable>
 #include <cstddef>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <limits>
+#include <mutex>
 #include <new>
+#include <type_traits>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
@@ -46,7 +49,7 @@
 #include "../frmts/vrt/vrtdataset.h"
 #include "gdal_priv.h"
 #include "gdal_priv_templates.hpp"
-// #include "gdalsse_priv.h"
+#include "gdalsse_priv.h"
 
 // Limit types to practical use cases.
 #define LIMIT_TYPES 1
@@ -414,94 +417,279 @@ GDALPansharpenOperation::Initialize( const GDALPansharpenOptions* psOptionsIn )
 }
 
 /************************************************************************/
-/*                    WeightedBroveyWithNoData()                        */
+/*                           ComputeFactor()                            */
 /************************************************************************/
 
-template<class WorkDataType, class OutDataType>
-                    void GDALPansharpenOperation::WeightedBroveyWithNoData(
-                                                     const WorkDataType* pPanBuffer,
-                                                     const WorkDataType* pUpsampledSpectralBuffer,
-                                                     OutDataType* pDataBuf,
-                                                     size_t nValues,
-                                                     size_t nBandValues,
-                                                     WorkDataType nMaxValue) const
+template<class T> static inline double ComputeFactor(T panValue,
+                                                     double dfPseudoPanchro)
 {
-    WorkDataType noData, validValue;
-    GDALCopyWord(psOptions->dfNoData, noData);
+    if( dfPseudoPanchro == 0.0 )
+        return 0.0;
 
-    if( !(std::numeric_limits<WorkDataType>::is_integer) )
-        validValue = static_cast<WorkDataType>(noData + 1e-5);
-    else if( noData == std::numeric_limits<WorkDataType>::min() )
-        validValue = std::numeric_limits<WorkDataType>::min() + 1;
+    return panValue / dfPseudoPanchro;
+}
+
+/************************************************************************/
+/*                           ClampAndRound()                            */
+/************************************************************************/
+
+template<class T> static inline T ClampAndRound(double dfVal, T nMaxValue)
+{
+    if( dfVal > nMaxValue )
+        return nMaxValue;
     else
-        validValue = noData - 1;
+        return static_cast<T>(dfVal + 0.5);
+}
+
+/************************************************************************/
+/*                        PansharpenLoad4Val()                          */
+/************************************************************************/
 
-    for( size_t j = 0; j < nValues; j++ )
+// XMMReg4Double has direct loaders for the most common data types. Other
+// types go through a temporary array.
+template<class T> static inline XMMReg4Double PansharpenLoad4Val(const T* p)
+{
+    const double adfVal[4] = { static_cast<double>(p[0]),
+                               static_cast<double>(p[1]),
+                               static_cast<double>(p[2]),
+                               static_cast<double>(p[3]) };
+    return XMMReg4Double::Load4Val(adfVal);
+}
+
+static inline XMMReg4Double PansharpenLoad4Val(const GByte* p)
+{
+    return XMMReg4Double::Load4Val(p);
+}
+
+static inline XMMReg4Double PansharpenLoad4Val(const GInt16* p)
+{
+    return XMMReg4Double::Load4Val(p);
+}
+
+static inline XMMReg4Double PansharpenLoad4Val(const GUInt16* p)
+{
+    return XMMReg4Double::Load4Val(p);
+}
+
+static inline XMMReg4Double PansharpenLoad4Val(const float* p)
+{
+    return XMMReg4Double::Load4Val(p);
+}
+
+static inline XMMReg4Double PansharpenLoad4Val(const double* p)
+{
+    return XMMReg4Double::Load4Val(p);
+}
+
+/************************************************************************/
+/*                        GDALPansharpenJobBatch                        */
+/************************************************************************/
+
+// Completion counter of a batch of jobs, so that the batch can be waited for
+// without waiting for the other jobs of the thread pool.
+struct GDALPansharpenJobBatch
+{
+    std::mutex              oMutex{};
+    std::condition_variable oCV{};
+    int                     nRemaining = 0;
+};
+
+/************************************************************************/
+/*                        PansharpenStore4Val()                         */
+/************************************************************************/
+
+// Only used for floating-point outputs. Float values go through
+// GDALCopyWord() so that values beyond FLT_MAX are clamped as in the scalar
+// code, instead of becoming infinite.
+template<class T> static inline void PansharpenStore4Val(
+    const XMMReg4Double& oVal, T* p)
+{
+    double adfVal[4];
+    oVal.Store4Val(adfVal);
+    for( int i = 0; i < 4; i++ )
+        GDALCopyWord(adfVal[i], p[i]);
+}
+
+static inline void PansharpenStore4Val(const XMMReg4Double& oVal, double* p)
+{
+    oVal.Store4Val(p);
+}
+
+/************************************************************************/
+/*                     WeightedBroveyVectorized()                       */
+/************************************************************************/
+
+// Generic weighted Brovey kernel, for any combination of working and
+// output data types, with or without nodata. Pixels are processed by chunks:
+// the Brovey factors of a chunk are first computed 4 pixels at a time, and
+// then applied to each output band. The final conversion to the working data
+// type, the bit depth clamping and the nodata substitution are done exactly
+// as in the scalar code, so that the result does not depend on the code path.
+template<class WorkDataType, class OutDataType, bool bHasNoData>
+static void WeightedBroveyVectorized(
+    const GDALPansharpenOptions* psOptions,
+    const WorkDataType* pPanBuffer,
+    const WorkDataType* pUpsampledSpectralBuffer,
+    OutDataType* pDataBuf,
+    size_t nValues,
+    size_t nBandValues,
+    WorkDataType nMaxValue,
+    WorkDataType noData,
+    WorkDataType validValue)
+{
+    constexpr size_t CHUNK_SIZE = 256;
+    double adfFactor[CHUNK_SIZE];
+    double adfValue[CHUNK_SIZE];
+    bool abValid[CHUNK_SIZE];
+
+    // Storing directly the products is only possible if converting them to
+    // the working data type and then to the output data type is a no-op.
+    const bool bDirectStore =
+        !bHasNoData && nMaxValue == 0 &&
+        ((std::is_same<WorkDataType, double>::value &&
+          !std::numeric_limits<OutDataType>::is_integer) ||
+         (std::is_same<WorkDataType, float>::value &&
+          std::is_same<OutDataType, float>::value));
+
+    const int nInputBands = psOptions->nInputSpectralBands;
+    const XMMReg4Double zero = XMMReg4Double::Zero();
+    const double dfNoData = static_cast<double>(noData);
+    const XMMReg4Double noDataReg = XMMReg4Double::Load1ValHighAndLow(&dfNoData);
+
+    for( size_t jChunk = 0; jChunk < nValues; jChunk += CHUNK_SIZE )
     {
-        double dfPseudoPanchro = 0.0;
-        for( int i = 0; i < psOptions->nInputSpectralBands; i++ )
+        const size_t nChunkValues = std::min(CHUNK_SIZE, nValues - jChunk);
+        const size_t nChunkValuesSIMD = nChunkValues & ~static_cast<size_t>(3);
+
+        // Compute the pseudo panchromatic value and the Brovey factor.
+        size_t k = 0;  // Used after for.
+        for( ; k < nChunkValuesSIMD; k += 4 )
         {
-            WorkDataType nSpectralVal =
-                pUpsampledSpectralBuffer[i * nBandValues + j];
-            if( nSpectralVal == noData )
+            const size_t j = jChunk + k;
+            const XMMReg4Double pan = PansharpenLoad4Val(pPanBuffer + j);
+            XMMReg4Double valid = bHasNoData ?
+                XMMReg4Double::NotEquals(pan, noDataReg) : zero;
+            XMMReg4Double pseudoPanchro = zero;
+            for( int i = 0; i < nInputBands; i++ )
+            {
+                const XMMReg4Double val = PansharpenLoad4Val(
+                    pUpsampledSpectralBuffer + i * nBandValues + j);
+                if( bHasNoData )
+                    valid = XMMReg4Double::And(
+                        valid, XMMReg4Double::NotEquals(val, noDataReg));
+                pseudoPanchro += XMMReg4Double::Load1ValHighAndLow(
+                    psOptions->padfWeights + i) * val;
+            }
+            const XMMReg4Double nonZero =
+                XMMReg4Double::NotEquals(pseudoPanchro, zero);
+            XMMReg4Double::And(nonZero, pan / pseudoPanchro).
+                Store4Val(adfFactor + k);
+            if( bHasNoData )
             {
-                dfPseudoPanchro = 0.0;
-                break;
+                GByte abyMask[32];
+                XMMReg4Double::And(valid, nonZero).StoreMask(abyMask);
+                for( int l = 0; l < 4; l++ )
+                    abValid[k + l] = abyMask[8 * l] != 0;
             }
-            dfPseudoPanchro += psOptions->padfWeights[i] * nSpectralVal;
         }
-        if( dfPseudoPanchro != 0.0 && pPanBuffer[j] != noData )
+        for( ; k < nChunkValues; k++ )
         {
-            const double dfFactor = pPanBuffer[j] / dfPseudoPanchro;
-            for( int i = 0; i < psOptions->nOutPansharpenedBands; i++ )
+            const size_t j = jChunk + k;
+            bool bValid = !bHasNoData || pPanBuffer[j] != noData;
+            double dfPseudoPanchro = 0.0;
+            for( int i = 0; i < nInputBands; i++ )
             {
-                WorkDataType nRawValue =
-                    pUpsampledSpectralBuffer[
-                        psOptions->panOutPansharpenedBands[i] * nBandValues +
-                        j];
+                const WorkDataType nSpectralVal =
+                    pUpsampledSpectralBuffer[i * nBandValues + j];
+                if( bHasNoData && nSpectralVal == noData )
+                    bValid = false;
+                dfPseudoPanchro += psOptions->padfWeights[i] * nSpectralVal;
+            }
+            adfFactor[k] = ComputeFactor(pPanBuffer[j], dfPseudoPanchro);
+            if( bHasNoData )
+                abValid[k] = bValid && dfPseudoPanchro != 0.0;
+        }
+
+        // Apply it to the output bands.
+        for( int i = 0; i < psOptions->nOutPansharpenedBands; i++ )
+        {
+            const WorkDataType* pSrc = pUpsampledSpectralBuffer +
+                psOptions->panOutPansharpenedBands[i] * nBandValues + jChunk;
+            OutDataType* pDst = pDataBuf + i * nBandValues + jChunk;
+
+            if( bDirectStore )
+            {
+                for( k = 0; k < nChunkValuesSIMD; k += 4 )
+                {
+                    PansharpenStore4Val(
+                        PansharpenLoad4Val(pSrc + k) *
+                            XMMReg4Double::Load4Val(adfFactor + k),
+                        pDst + k);
+                }
+                for( ; k < nChunkValues; k++ )
+                {
+                    WorkDataType nPansharpenedValue;
+                    GDALCopyWord(pSrc[k] * adfFactor[k], nPansharpenedValue);
+                    GDALCopyWord(nPansharpenedValue, pDst[k]);
+                }
+                continue;
+            }
+
+            for( k = 0; k < nChunkValuesSIMD; k += 4 )
+            {
+                (PansharpenLoad4Val(pSrc + k) *
+                    XMMReg4Double::Load4Val(adfFactor + k)).
+                        Store4Val(adfValue + k);
+            }
+            for( ; k < nChunkValues; k++ )
+                adfValue[k] = pSrc[k] * adfFactor[k];
+
+            for( k = 0; k < nChunkValues; k++ )
+            {
+                if( bHasNoData && !abValid[k] )
+                {
+                    GDALCopyWord(noData, pDst[k]);
+                    continue;
+                }
                 WorkDataType nPansharpenedValue;
-                GDALCopyWord(nRawValue * dfFactor, nPansharpenedValue);
+                GDALCopyWord(adfValue[k], nPansharpenedValue);
                 if( nMaxValue != 0 && nPansharpenedValue > nMaxValue )
                     nPansharpenedValue = nMaxValue;
                 // We don't want a valid value to be mapped to NoData.
-                if( nPansharpenedValue == noData )
+                if( bHasNoData && nPansharpenedValue == noData )
                     nPansharpenedValue = validValue;
-                GDALCopyWord(nPansharpenedValue, pDataBuf[i * nBandValues + j]);
-            }
-        }
-        else
-        {
-            for( int i = 0; i < psOptions->nOutPansharpenedBands; i++ )
-            {
-                GDALCopyWord(noData, pDataBuf[i * nBandValues + j]);
+                GDALCopyWord(nPansharpenedValue, pDst[k]);
             }
         }
     }
 }
 
 /************************************************************************/
-/*                           ComputeFactor()                            */
+/*                    WeightedBroveyWithNoData()                        */
 /************************************************************************/
 
-template<class T> static inline double ComputeFactor(T panValue,
-                                                     double dfPseudoPanchro)
+template<class WorkDataType, class OutDataType>
+                    void GDALPansharpenOperation::WeightedBroveyWithNoData(
+                                                     const WorkDataType* pPanBuffer,
+                                                     const WorkDataType* pUpsampledSpectralBuffer,
+                                                     OutDataType* pDataBuf,
+                                                     size_t nValues,
+                                                     size_t nBandValues,
+                                                     WorkDataType nMaxValue) const
 {
-    if( dfPseudoPanchro == 0.0 )
-        return 0.0;
-
-    return panValue / dfPseudoPanchro;
-}
-
-/************************************************************************/
-/*                           ClampAndRound()                            */
-/************************************************************************/
+    WorkDataType noData, validValue;
+    GDALCopyWord(psOptions->dfNoData, noData);
 
-template<class T> static inline T ClampAndRound(double dfVal, T nMaxValue)
-{
-    if( dfVal > nMaxValue )
-        return nMaxValue;
+    if( !(std::numeric_limits<WorkDataType>::is_integer) )
+        validValue = static_cast<WorkDataType>(noData + 1e-5);
+    else if( noData == std::numeric_limits<WorkDataType>::min() )
+        validValue = std::numeric_limits<WorkDataType>::min() + 1;
     else
-        return static_cast<T>(dfVal + 0.5);
+        validValue = noData - 1;
+
+    WeightedBroveyVectorized<WorkDataType, OutDataType, true>(
+        psOptions, pPanBuffer, pUpsampledSpectralBuffer, pDataBuf,
+        nValues, nBandValues, nMaxValue, noData, validValue);
 }
 
 /************************************************************************/
@@ -525,39 +713,17 @@ void GDALPansharpenOperation::WeightedBrovey3(
         return;
     }
 
-    for( size_t j = 0; j < nValues; j++ )
-    {
-        double dfFactor = 0.0;
-        // if( pPanBuffer[j] == 0 )
-        //     dfFactor = 1.0;
-        // else
-        {
-            double dfPseudoPanchro = 0.0;
-            for( int i = 0; i < psOptions->nInputSpectralBands; i++ )
-                dfPseudoPanchro += psOptions->padfWeights[i] *
-                                pUpsampledSpectralBuffer[i * nBandValues + j];
-            dfFactor = ComputeFactor(pPanBuffer[j], dfPseudoPanchro);
-        }
-
-        for( int i = 0; i < psOptions->nOutPansharpenedBands; i++ )
-        {
-            WorkDataType nRawValue =
-                pUpsampledSpectralBuffer[psOptions->panOutPansharpenedBands[i] * nBandValues + j];
-            WorkDataType nPansharpenedValue;
-            GDALCopyWord(nRawValue * dfFactor, nPansharpenedValue);
-            if( bHasBitDepth && nPansharpenedValue > nMaxValue )
-                nPansharpenedValue = nMaxValue;
-            GDALCopyWord(nPansharpenedValue, pDataBuf[i * nBandValues + j]);
-        }
-    }
+    WeightedBroveyVectorized<WorkDataType, OutDataType, false>(
+        psOptions, pPanBuffer, pUpsampledSpectralBuffer, pDataBuf,
+        nValues, nBandValues,
+        bHasBitDepth ? nMaxValue : static_cast<WorkDataType>(0),
+        static_cast<WorkDataType>(0), static_cast<WorkDataType>(0));
 }
 
 /* We restrict to 64bit processors because they are guaranteed to have SSE2 */
 /* Could possibly be used too on 32bit, but we would need to check at runtime */
 #if defined(__x86_64) || defined(_M_X64)
 
-#include "gdalsse_priv.h"
-
 template<class T, int NINPUT, int NOUTPUT>
 size_t GDALPansharpenOperation::WeightedBroveyPositiveWeightsInternal(
                                                      const T* pPanBuffer,
@@ -919,12 +1085,13 @@ template<class WorkDataType> CPLErr GDALPansharpenOperation::WeightedBrovey(
                            nValues, nBandValues, nMaxValue);
             break;
 
+#endif
+
         case GDT_Float32:
             WeightedBrovey(pPanBuffer, pUpsampledSpectralBuffer,
                            static_cast<float *>(pDataBuf),
                            nValues, nBandValues, nMaxValue);
             break;
-#endif
 
         case GDT_Float64:
             WeightedBrovey(pPanBuffer, pUpsampledSpectralBuffer,
@@ -982,12 +1149,13 @@ template<class WorkDataType> CPLErr GDALPansharpenOperation::WeightedBrovey(
                 static_cast<GInt32 *>(pDataBuf), nValues, nBandValues, 0);
             break;
 
+#endif
+
         case GDT_Float32:
             WeightedBrovey3<WorkDataType, float, FALSE>(
                 pPanBuffer, pUpsampledSpectralBuffer,
                 static_cast<float *>(pDataBuf), nValues, nBandValues, 0);
             break;
-#endif
 
         case GDT_Float64:
             WeightedBrovey3<WorkDataType, double, FALSE>(
@@ -1012,88 +1180,41 @@ template<class WorkDataType> CPLErr GDALPansharpenOperation::WeightedBrovey(
 template< class T >
 static void ClampValues( T* panBuffer, size_t nValues, T nMaxVal )
 {
+    // Written without a branch so that compilers can vectorize it.
     for( size_t i = 0; i < nValues; i++ )
-    {
-        if( panBuffer[i] > nMaxVal )
-            panBuffer[i] = nMaxVal;
-    }
+        panBuffer[i] = std::min(panBuffer[i], nMaxVal);
 }
 
 /************************************************************************/
-/*                         ProcessRegion()                              */
+/*                          ReadInputRegion()                           */
 /************************************************************************/
 
-/** Executes a pansharpening operation on a rectangular region of the
- * resulting dataset.
- *
- * The window is expressed with respect to the dimensions of the panchromatic
- * band.
- *
- * Spectral bands are upsampled and merged with the panchromatic band according
- * to the select algorithm and options.
- *
- * @param nXOff pixel offset.
- * @param nYOff pixel offset.
- * @param nXSize width of the pansharpened region to compute.
- * @param nYSize height of the pansharpened region to compute.
- * @param pDataBuf output buffer. Must be nXSize * nYSize *
- *                 GDALGetDataTypeSizeBytes(eBufDataType) *
- *                 psOptions->nOutPansharpenedBands large.
- *                 It begins with all values of the first output band, followed
- *                 by values of the second output band, etc...
- * @param eBufDataType data type of the output buffer
- *
- * @return CE_None in case of success, CE_Failure in case of failure.
- *
- * @since GDAL 2.1
- */
-CPLErr GDALPansharpenOperation::ProcessRegion( int nXOff, int nYOff,
-                                               int nXSize, int nYSize,
-                                               void *pDataBuf,
-                                               GDALDataType eBufDataType )
+// Reads the panchromatic band and the upsampled spectral bands of a
+// rectangular region. pPanBuffer receives nXSize * nYSize values, and the
+// values of the spectral bands are nSpectralBandSpace bytes apart.
+// Must be called from the thread that owns the datasets. The thread pool
+// is only used for the upsampling of the spectral bands.
+CPLErr GDALPansharpenOperation::ReadInputRegion( int nXOff, int nYOff,
+                                                 int nXSize, int nYSize,
+                                                 GDALDataType eWorkDataType,
+                                                 GByte* pPanBuffer,
+                                                 GByte* pUpsampledSpectralBuffer,
+                                                 GSpacing nSpectralBandSpace,
+                                                 int nTasks )
 {
-    if( psOptions == nullptr )
-        return CE_Failure;
-
-    // TODO: Avoid allocating buffers each time.
     GDALRasterBand* poPanchroBand = GDALRasterBand::FromHandle(
                                                     psOptions->hPanchroBand);
-    GDALDataType eWorkDataType = poPanchroBand->GetRasterDataType();
-#ifdef LIMIT_TYPES
-    if( eWorkDataType != GDT_Byte && eWorkDataType != GDT_UInt16 )
-        eWorkDataType = GDT_Float64;
-#endif
     const int nDataTypeSize = GDALGetDataTypeSizeBytes(eWorkDataType);
-    GByte* pUpsampledSpectralBuffer = static_cast<GByte *>(
-        VSI_MALLOC3_VERBOSE(nXSize, nYSize,
-                            psOptions->nInputSpectralBands * nDataTypeSize));
-    GByte* pPanBuffer = static_cast<GByte *>(
-        VSI_MALLOC3_VERBOSE(nXSize, nYSize, nDataTypeSize));
-    if( pUpsampledSpectralBuffer == nullptr || pPanBuffer == nullptr )
-    {
-        VSIFree(pUpsampledSpectralBuffer);
-        VSIFree(pPanBuffer);
-        return CE_Failure;
-    }
 
     CPLErr eErr =
         poPanchroBand->RasterIO(GF_Read,
                 nXOff, nYOff, nXSize, nYSize, pPanBuffer, nXSize, nYSize,
                 eWorkDataType, 0, 0, nullptr);
     if( eErr != CE_None )
-    {
-        VSIFree(pUpsampledSpectralBuffer);
-        VSIFree(pPanBuffer);
         return CE_Failure;
-    }
 
-    int nTasks = 0;
-    if( poThreadPool )
-    {
-        nTasks = poThreadPool->GetThreadCount();
-        if( nTasks > nYSize )
-            nTasks = nYSize;
-    }
+    if( nTasks > nYSize )
+        nTasks = nYSize;
 
     GDALRasterIOExtraArg sExtraArg;
     INIT_RASTERIO_EXTRA_ARG(sExtraArg);
@@ -1154,11 +1275,7 @@ CPLErr GDALPansharpenOperation::ProcessRegion( int nXOff, int nYOff,
                 nXSizeExtract, nYSizeExtract,
                 psOptions->nInputSpectralBands * nDataTypeSize));
         if( pSpectralBuffer == nullptr )
-        {
-            VSIFree(pUpsampledSpectralBuffer);
-            VSIFree(pPanBuffer);
             return CE_Failure;
-        }
 
         if( !anInputBands.empty() )
         {
@@ -1193,8 +1310,6 @@ CPLErr GDALPansharpenOperation::ProcessRegion( int nXOff, int nYOff,
         if( eErr != CE_None )
         {
             VSIFree(pSpectralBuffer);
-            VSIFree(pUpsampledSpectralBuffer);
-            VSIFree(pPanBuffer);
             return CE_Failure;
         }
 
@@ -1254,7 +1369,7 @@ CPLErr GDALPansharpenOperation::ProcessRegion( int nXOff, int nYOff,
                               pUpsampledSpectralBuffer, nXSize, nYSize,
                               eWorkDataType,
                               psOptions->nInputSpectralBands, nullptr,
-                              0, 0, 0,
+                              0, 0, nSpectralBandSpace,
                               &sExtraArg));
         }
         else
@@ -1330,8 +1445,7 @@ CPLErr GDALPansharpenOperation::ProcessRegion( int nXOff, int nYOff,
                     pasJobs[i].nBufYSize =
                         static_cast<int>(iNextStartLine - iStartLine);
                     pasJobs[i].nBandCount = psOptions->nInputSpectralBands;
-                    pasJobs[i].nBandSpace =
-                        static_cast<GSpacing>(nXSize) * nYSize * nDataTypeSize;
+                    pasJobs[i].nBandSpace = nSpectralBandSpace;
 #ifdef DEBUG_TIMING
                     pasJobs[i].ptv = &tv;
 #endif
@@ -1340,9 +1454,17 @@ CPLErr GDALPansharpenOperation::ProcessRegion( int nXOff, int nYOff,
 #ifdef DEBUG_TIMING
                 gettimeofday(&tv, nullptr);
 #endif
+                // Only wait for our jobs: the pool may still be
+                // pansharpening the previous strip.
+                GDALPansharpenJobBatch oBatch;
+                oBatch.nRemaining = nTasks;
+                for( int i = 0; i < nTasks; i++ )
+                    pasJobs[i].psBatch = &oBatch;
                 poThreadPool->SubmitJobs(PansharpenResampleJobThreadFunc,
                                          ahJobData);
-                poThreadPool->WaitCompletion();
+                std::unique_lock<std::mutex> oLock(oBatch.oMutex);
+                oBatch.oCV.wait(oLock,
+                                [&oBatch]{ return oBatch.nRemaining == 0; });
             }
         }
 
@@ -1363,7 +1485,7 @@ CPLErr GDALPansharpenOperation::ProcessRegion( int nXOff, int nYOff,
                 nXSize, nYSize,
                 eWorkDataType,
                 static_cast<int>(anInputBands.size()), &anInputBands[0],
-                0, 0, 0, &sExtraArg);
+                0, 0, nSpectralBandSpace, &sExtraArg);
         }
         else
         {
@@ -1375,18 +1497,13 @@ CPLErr GDALPansharpenOperation::ProcessRegion( int nXOff, int nYOff,
                     GF_Read,
                     nSpectralXOff, nSpectralYOff,
                     nSpectralXSize, nSpectralYSize,
-                    pUpsampledSpectralBuffer +
-                    static_cast<size_t>(i) * nXSize * nYSize * nDataTypeSize,
+                    pUpsampledSpectralBuffer + i * nSpectralBandSpace,
                     nXSize, nYSize,
                     eWorkDataType, 0, 0, &sExtraArg);
             }
         }
         if( eErr != CE_None )
-        {
-            VSIFree(pUpsampledSpectralBuffer);
-            VSIFree(pPanBuffer);
             return CE_Failure;
-        }
     }
 
     // In case NBITS was not set on the spectral bands, clamp the values
@@ -1408,21 +1525,20 @@ CPLErr GDALPansharpenOperation::ProcessRegion( int nXOff, int nYOff,
             {
                 if( eWorkDataType == GDT_Byte )
                 {
-                    ClampValues(reinterpret_cast<GByte*>(pUpsampledSpectralBuffer) + static_cast<size_t>(i) * nXSize * nYSize,
+                    ClampValues(reinterpret_cast<GByte*>(pUpsampledSpectralBuffer + i * nSpectralBandSpace),
                                static_cast<size_t>(nXSize)*nYSize,
                                static_cast<GByte>((1 << nBitDepth)-1));
                 }
                 else if( eWorkDataType == GDT_UInt16 )
                 {
-                    ClampValues(reinterpret_cast<GUInt16*>(pUpsampledSpectralBuffer) + static_cast<size_t>(i) * nXSize * nYSize,
+                    ClampValues(reinterpret_cast<GUInt16*>(pUpsampledSpectralBuffer + i * nSpectralBandSpace),
                                static_cast<size_t>(nXSize)*nYSize,
                                static_cast<GUInt16>((1 << nBitDepth)-1));
                 }
 #ifndef LIMIT_TYPES
                 else if( eWorkDataType == GDT_UInt32 )
                 {
-                    ClampValues(reinterpret_cast<GUInt32*>(pUpsampledSpectralBuffer) +
-                                static_cast<size_t>(i) * nXSize * nYSize,
+                    ClampValues(reinterpret_cast<GUInt32*>(pUpsampledSpectralBuffer + i * nSpectralBandSpace),
                                 static_cast<size_t>(nXSize)*nYSize,
                                 (static_cast<GUInt32>((1 << nBitDepth)-1));
                 }
@@ -1431,14 +1547,87 @@ CPLErr GDALPansharpenOperation::ProcessRegion( int nXOff, int nYOff,
         }
     }
 
-    GUInt32 nMaxValue = (1 << nBitDepth) - 1;
+    return CE_None;
+}
+
+/************************************************************************/
+/*                         ProcessRegion()                              */
+/************************************************************************/
+
+/** Executes a pansharpening operation on a rectangular region of the
+ * resulting dataset.
+ *
+ * The window is expressed with respect to the dimensions of the panchromatic
+ * band.
+ *
+ * Spectral bands are upsampled and merged with the panchromatic band according
+ * to the select algorithm and options.
+ *
+ * @param nXOff pixel offset.
+ * @param nYOff pixel offset.
+ * @param nXSize width of the pansharpened region to compute.
+ * @param nYSize height of the pansharpened region to compute.
+ * @param pDataBuf output buffer. Must be nXSize * nYSize *
+ *                 GDALGetDataTypeSizeBytes(eBufDataType) *
+ *                 psOptions->nOutPansharpenedBands large.
+ *                 It begins with all values of the first output band, followed
+ *                 by values of the second output band, etc...
+ * @param eBufDataType data type of the output buffer
+ *
+ * @return CE_None in case of success, CE_Failure in case of failure.
+ *
+ * @since GDAL 2.1
+ */
+CPLErr GDALPansharpenOperation::ProcessRegion( int nXOff, int nYOff,
+                                               int nXSize, int nYSize,
+                                               void *pDataBuf,
+                                               GDALDataType eBufDataType )
+{
+    if( psOptions == nullptr )
+        return CE_Failure;
+
+    // TODO: Avoid allocating buffers each time.
+    GDALRasterBand* poPanchroBand = GDALRasterBand::FromHandle(
+                                                    psOptions->hPanchroBand);
+    GDALDataType eWorkDataType = poPanchroBand->GetRasterDataType();
+#ifdef LIMIT_TYPES
+    // Float32 is only used as the working data type when the output is
+    // Float32 too, as it then gives the same result as Float64 with half of
+    // the memory bandwidth.
+    if( eWorkDataType != GDT_Byte && eWorkDataType != GDT_UInt16 &&
+        !(eWorkDataType == GDT_Float32 && eBufDataType == GDT_Float32) )
+        eWorkDataType = GDT_Float64;
+#endif
+    const int nDataTypeSize = GDALGetDataTypeSizeBytes(eWorkDataType);
+    GByte* pUpsampledSpectralBuffer = static_cast<GByte *>(
+        VSI_MALLOC3_VERBOSE(nXSize, nYSize,
+                            psOptions->nInputSpectralBands * nDataTypeSize));
+    GByte* pPanBuffer = static_cast<GByte *>(
+        VSI_MALLOC3_VERBOSE(nXSize, nYSize, nDataTypeSize));
+    if( pUpsampledSpectralBuffer == nullptr || pPanBuffer == nullptr )
+    {
+        VSIFree(pUpsampledSpectralBuffer);
+        VSIFree(pPanBuffer);
+        return CE_Failure;
+    }
+
+    int nTasks = 0;
+    if( poThreadPool )
+    {
+        nTasks = poThreadPool->GetThreadCount();
+        if( nTasks > nYSize )
+            nTasks = nYSize;
+    }
+
+    GUInt32 nMaxValue = (1 << psOptions->nBitDepth) - 1;
 
     double* padfTempBuffer = nullptr;
     GDALDataType eBufDataTypeOri = eBufDataType;
     void* pDataBufOri = pDataBuf;
     // CFloat64 is the query type used by gdallocationinfo...
 #ifdef LIMIT_TYPES
-    if( eBufDataType != GDT_Byte && eBufDataType != GDT_UInt16 )
+    if( eBufDataType != GDT_Byte && eBufDataType != GDT_UInt16 &&
+        eBufDataType != GDT_Float32 )
 #else
     if( eBufDataType == GDT_CFloat64 )
 #endif
@@ -1457,75 +1646,136 @@ CPLErr GDALPansharpenOperation::ProcessRegion( int nXOff, int nYOff,
         eBufDataType = GDT_Float64;
     }
 
+    // With several threads, large regions are processed by strips of lines
+    // covering one or several rows of blocks of the panchromatic band: the
+    // inputs of a strip are read while the worker threads are still
+    // pansharpening the previous one.
+    int nLinesPerStrip = nYSize;
     if( nTasks > 1 )
     {
-        std::vector<GDALPansharpenJob> asJobs;
-        asJobs.resize( nTasks );
-        GDALPansharpenJob* pasJobs = &(asJobs[0]);
+        int nBlockXSize = 0;
+        int nBlockYSize = 0;
+        poPanchroBand->GetBlockSize(&nBlockXSize, &nBlockYSize);
+        nBlockYSize = std::max(1, nBlockYSize);
+        nLinesPerStrip = std::max(nTasks, (1024 * 1024) / nXSize);
+        nLinesPerStrip =
+            ((nLinesPerStrip + nBlockYSize - 1) / nBlockYSize) * nBlockYSize;
+        if( nLinesPerStrip > nYSize / 2 )
+            nLinesPerStrip = nYSize;
+    }
+
+    const GSpacing nSpectralBandSpace =
+        static_cast<GSpacing>(nXSize) * nYSize * nDataTypeSize;
+    const size_t nBandValues = static_cast<size_t>(nXSize) * nYSize;
+    const int nBufDataTypeSize = GDALGetDataTypeSizeBytes(eBufDataType);
+    std::vector<GDALPansharpenJob> aasJobs[2];
+    int nPendingJobSet = -1;
+    CPLErr eErr = CE_None;
+
+    for( int nStripYOff = 0, iStrip = 0;
+         eErr == CE_None && nStripYOff < nYSize;
+         nStripYOff += nLinesPerStrip, iStrip++ )
+    {
+        const int nStripYSize = std::min(nLinesPerStrip, nYSize - nStripYOff);
+        const size_t nStripOffset = static_cast<size_t>(nStripYOff) * nXSize;
+        eErr = ReadInputRegion(nXOff, nYOff + nStripYOff, nXSize, nStripYSize,
+                               eWorkDataType,
+                               pPanBuffer + nStripOffset * nDataTypeSize,
+                               pUpsampledSpectralBuffer +
+                                    nStripOffset * nDataTypeSize,
+                               nSpectralBandSpace, nTasks);
+
+        if( nTasks <= 1 )
         {
-            std::vector<void*> ahJobData;
-            ahJobData.resize( nTasks );
-#ifdef DEBUG_TIMING
-            struct timeval tv;
-#endif
-            for( int i=0;i<nTasks;i++)
+            if( eErr == CE_None )
+            {
+                eErr = PansharpenChunk( eWorkDataType, eBufDataType,
+                                        pPanBuffer,
+                                        pUpsampledSpectralBuffer,
+                                        pDataBuf,
+                                        nBandValues,
+                                        nBandValues,
+                                        nMaxValue);
+            }
+            continue;
+        }
+
+        // Wait for the previous strip.
+        poThreadPool->WaitCompletion();
+        if( nPendingJobSet >= 0 )
+        {
+            for( const auto& sJob: aasJobs[nPendingJobSet] )
             {
-                const size_t iStartLine =
-                    (static_cast<size_t>(i) * nYSize) / nTasks;
-                const size_t iNextStartLine =
-                    (static_cast<size_t>(i + 1) * nYSize) / nTasks;
-                pasJobs[i].poPansharpenOperation = this;
-                pasJobs[i].eWorkDataType = eWorkDataType;
-                pasJobs[i].eBufDataType = eBufDataType;
-                pasJobs[i].pPanBuffer =
-                    pPanBuffer + iStartLine *  nXSize * nDataTypeSize;
-                pasJobs[i].pUpsampledSpectralBuffer =
-                    pUpsampledSpectralBuffer +
-                    iStartLine * nXSize * nDataTypeSize;
-                pasJobs[i].pDataBuf =
-                    static_cast<GByte*>(pDataBuf) +
-                    iStartLine * nXSize *
-                    GDALGetDataTypeSizeBytes(eBufDataType);
-                pasJobs[i].nValues =
-                    (iNextStartLine - iStartLine) * nXSize;
-                pasJobs[i].nBandValues = static_cast<size_t>(nXSize) * nYSize;
-                pasJobs[i].nMaxValue = nMaxValue;
+                if( sJob.eErr != CE_None )
+                    eErr = CE_Failure;
+            }
+            nPendingJobSet = -1;
+        }
+        if( eErr != CE_None )
+            break;
+
+        const int nStripTasks = std::min(nTasks, nStripYSize);
+        std::vector<GDALPansharpenJob>& asJobs = aasJobs[iStrip % 2];
+        asJobs.resize( nStripTasks );
+        GDALPansharpenJob* pasJobs = &(asJobs[0]);
+        std::vector<void*> ahJobData;
+        ahJobData.resize( nStripTasks );
 #ifdef DEBUG_TIMING
-                pasJobs[i].ptv = &tv;
+        struct timeval tv;
 #endif
-                ahJobData[i] = &(pasJobs[i]);
-            }
+        for( int i=0;i<nStripTasks;i++)
+        {
+            const size_t iStartLine = nStripYOff +
+                (static_cast<size_t>(i) * nStripYSize) / nStripTasks;
+            const size_t iNextStartLine = nStripYOff +
+                (static_cast<size_t>(i + 1) * nStripYSize) / nStripTasks;
+            pasJobs[i].poPansharpenOperation = this;
+            pasJobs[i].eWorkDataType = eWorkDataType;
+            pasJobs[i].eBufDataType = eBufDataType;
+            pasJobs[i].pPanBuffer =
+                pPanBuffer + iStartLine *  nXSize * nDataTypeSize;
+            pasJobs[i].pUpsampledSpectralBuffer =
+                pUpsampledSpectralBuffer +
+                iStartLine * nXSize * nDataTypeSize;
+            pasJobs[i].pDataBuf =
+                static_cast<GByte*>(pDataBuf) +
+                iStartLine * nXSize * nBufDataTypeSize;
+            pasJobs[i].nValues =
+                (iNextStartLine - iStartLine) * nXSize;
+            pasJobs[i].nBandValues = nBandValues;
+            pasJobs[i].nMaxValue = nMaxValue;
+            pasJobs[i].eErr = CE_Failure;
 #ifdef DEBUG_TIMING
-            gettimeofday(&tv, nullptr);
+            pasJobs[i].ptv = &tv;
 #endif
-            poThreadPool->SubmitJobs(PansharpenJobThreadFunc, ahJobData);
-            poThreadPool->WaitCompletion();
+            ahJobData[i] = &(pasJobs[i]);
         }
+#ifdef DEBUG_TIMING
+        gettimeofday(&tv, nullptr);
+#endif
+        poThreadPool->SubmitJobs(PansharpenJobThreadFunc, ahJobData);
+        nPendingJobSet = iStrip % 2;
+    }
 
-        eErr = CE_None;
-        for( int i=0;i<nTasks;i++)
+    if( nPendingJobSet >= 0 )
+    {
+        poThreadPool->WaitCompletion();
+        for( const auto& sJob: aasJobs[nPendingJobSet] )
         {
-            if( pasJobs[i].eErr != CE_None )
+            if( sJob.eErr != CE_None )
                 eErr = CE_Failure;
         }
     }
-    else
-    {
-        eErr = PansharpenChunk( eWorkDataType, eBufDataType,
-                                pPanBuffer,
-                                pUpsampledSpectralBuffer,
-                                pDataBuf,
-                                static_cast<size_t>(nXSize) * nYSize,
-                                static_cast<size_t>(nXSize) * nYSize,
-                                nMaxValue);
-    }
 
     if( padfTempBuffer )
     {
-        GDALCopyWords64(padfTempBuffer, GDT_Float64, sizeof(double),
-                      pDataBufOri, eBufDataTypeOri,
-                      GDALGetDataTypeSizeBytes(eBufDataTypeOri),
-                      static_cast<size_t>(nXSize)*nYSize*psOptions->nOutPansharpenedBands);
+        if( eErr == CE_None )
+        {
+            GDALCopyWords64(padfTempBuffer, GDT_Float64, sizeof(double),
+                          pDataBufOri, eBufDataTypeOri,
+                          GDALGetDataTypeSizeBytes(eBufDataTypeOri),
+                          static_cast<size_t>(nXSize)*nYSize*psOptions->nOutPansharpenedBands);
+        }
         VSIFree(padfTempBuffer);
     }
 
@@ -1584,6 +1834,15 @@ void GDALPansharpenOperation::PansharpenResampleJobThreadFunc(void* pUserData)
                              &sExtraArg));
 #endif
 
+    if( psJob->psBatch )
+    {
+        // Notify under the lock, as the batch is destroyed as soon as
+        // the waiting thread sees nRemaining == 0.
+        std::lock_guard<std::mutex> oLock(psJob->psBatch->oMutex);
+        if( --psJob->psBatch->nRemaining == 0 )
+            psJob->psBatch->oCV.notify_all();
+    }
+
 #ifdef DEBUG_TIMING
     struct timeval tv_end;
     gettimeofday(&tv_end, nullptr);
@@ -1699,13 +1958,15 @@ GDALPansharpenOperation::PansharpenChunk( GDALDataType eWorkDataType,
                                   nValues, nBandValues);
             break;
 
+#endif
+
         case GDT_Float32:
             eErr = WeightedBrovey(static_cast<const float*>(pPanBuffer),
                                   static_cast<const float*>(pUpsampledSpectralBuffer),
                                   pDataBuf, eBufDataType,
                                   nValues, nBandValues);
             break;
-#endif
+
         case GDT_Float64:
             eErr = WeightedBrovey(static_cast<const double*>(pPanBuffer),
                                   static_cast<const double*>(pUpsampledSpectralBuffer),
@@ -1735,6 +1996,18 @@ GDALPansharpenOptions* GDALPansharpenOperation::GetOptions()
     return psOptions;
 }
 
+/************************************************************************/
+/*                           GetThreadCount()                           */
+/************************************************************************/
+
+/** Return the number of threads used to process a region.
+ * @return number of threads (1 in single threaded mode).
+ */
+int GDALPansharpenOperation::GetThreadCount() const
+{
+    return poThreadPool ? poThreadPool->GetThreadCount() : 1;
+}
+
 /************************************************************************/
 /*                     GDALCreatePansharpenOperation()                  */
 /************************************************************************/
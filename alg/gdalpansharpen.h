@@ -137,6 +137,7 @@ CPL_C_END
 #endif
 
 class GDALPansharpenOperation;
+struct GDALPansharpenJobBatch;
 
 //! @cond Doxygen_Suppress
 typedef struct
@@ -176,6 +177,7 @@ typedef struct
     int          nBandCount;
     GDALRIOResampleAlg eResampleAlg;
     GSpacing     nBandSpace;
+    GDALPansharpenJobBatch* psBatch;
 
 #ifdef DEBUG_TIMING
     struct timeval* ptv;
@@ -272,6 +274,13 @@ class GDALPansharpenOperation
                                                      size_t nValues,
                                                      size_t nBandValues,
                                                      GUInt32 nMaxValue) const;
+        CPLErr ReadInputRegion( int nXOff, int nYOff,
+                                int nXSize, int nYSize,
+                                GDALDataType eWorkDataType,
+                                GByte* pPanBuffer,
+                                GByte* pUpsampledSpectralBuffer,
+                                GSpacing nSpectralBandSpace,
+                                int nTasks );
     public:
                              GDALPansharpenOperation();
                             ~GDALPansharpenOperation();
@@ -282,6 +291,7 @@ class GDALPansharpenOperation
                                            void *pDataBuf,
                                            GDALDataType eBufDataType);
         GDALPansharpenOptions* GetOptions();
+        int                  GetThreadCount() const;
 };
 
 #endif /* __cplusplus */
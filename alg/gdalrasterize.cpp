@@ -38,12 +38,18 @@
 #include <cfloat>
 #include <vector>
 #include <algorithm>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <new>
+#include <utility>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
 #include "cpl_progress.h"
 #include "cpl_string.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal.h"
 #include "gdal_priv.h"
 #include "ogr_api.h"
@@ -363,51 +369,62 @@ static void GDALCollectRingsFromGeometry(
 }
 
 /************************************************************************/
-/*                       gv_rasterize_one_shape()                       */
+/*                    GDALCollectTransformedRings()                     */
 /************************************************************************/
-static void
-gv_rasterize_one_shape( unsigned char *pabyChunkBuf, int nXOff, int nYOff,
-                        int nXSize, int nYSize,
-                        int nBands, GDALDataType eType,
-                        int nPixelSpace, GSpacing nLineSpace, GSpacing nBandSpace,
-                        int bAllTouched,
-                        const OGRGeometry *poShape,
-                        const double *padfBurnValue,
-                        GDALBurnValueSrc eBurnValueSrc,
-                        GDALRasterMergeAlg eMergeAlg,
-                        GDALTransformerFunc pfnTransformer,
-                        void *pTransformArg )
+
+static void GDALCollectTransformedRings(
+    const OGRGeometry *poShape,
+    std::vector<double> &aPointX, std::vector<double> &aPointY,
+    std::vector<double> &aPointVariant,
+    std::vector<int> &aPartSize, GDALBurnValueSrc eBurnValueSrc,
+    GDALTransformerFunc pfnTransformer, void *pTransformArg )
 
 {
-    if( poShape == nullptr || poShape->IsEmpty() )
-        return;
-    const auto eGeomType = wkbFlatten(poShape->getGeometryType());
+/* -------------------------------------------------------------------- */
+/*      Transform polygon geometries into a set of rings and a part     */
+/*      size list.                                                      */
+/* -------------------------------------------------------------------- */
+    GDALCollectRingsFromGeometry( poShape, aPointX, aPointY, aPointVariant,
+                                  aPartSize, eBurnValueSrc );
 
-    if( (eGeomType == wkbMultiLineString ||
-         eGeomType == wkbMultiPolygon ||
-         eGeomType == wkbGeometryCollection) &&
-        eMergeAlg == GRMA_Replace )
+/* -------------------------------------------------------------------- */
+/*      Transform points if needed.                                     */
+/* -------------------------------------------------------------------- */
+    if( pfnTransformer != nullptr )
     {
-        // Speed optimization: in replace mode, we can rasterize each part of
-        // a geometry collection separately.
-        const auto poGC = poShape->toGeometryCollection();
-        for( const auto poPart: *poGC )
-        {
-            gv_rasterize_one_shape(pabyChunkBuf, nXOff, nYOff,
-                                   nXSize, nYSize,
-                                   nBands, eType,
-                                   nPixelSpace, nLineSpace, nBandSpace,
-                                   bAllTouched,
-                                   poPart,
-                                   padfBurnValue,
-                                   eBurnValueSrc,
-                                   eMergeAlg,
-                                   pfnTransformer,
-                                   pTransformArg);
-        }
-        return;
+        int *panSuccess =
+            static_cast<int *>(CPLCalloc(sizeof(int), aPointX.size()));
+
+        // TODO: We need to add all appropriate error checking at some point.
+        pfnTransformer( pTransformArg, FALSE, static_cast<int>(aPointX.size()),
+                        aPointX.data(), aPointY.data(), nullptr, panSuccess );
+        CPLFree( panSuccess );
     }
+}
+
+/************************************************************************/
+/*                         gv_rasterize_rings()                         */
+/*                                                                      */
+/*      Burn rings already transformed to pixel/line coordinates of     */
+/*      the whole raster into a buffer at offset nXOff, nYOff.  The     */
+/*      point arrays are modified.                                      */
+/************************************************************************/
+static void
+gv_rasterize_rings( unsigned char *pabyChunkBuf, int nXOff, int nYOff,
+                    int nXSize, int nYSize,
+                    int nBands, GDALDataType eType,
+                    int nPixelSpace, GSpacing nLineSpace, GSpacing nBandSpace,
+                    int bAllTouched,
+                    OGRwkbGeometryType eGeomType,
+                    std::vector<double> &aPointX,
+                    std::vector<double> &aPointY,
+                    std::vector<double> &aPointVariant,
+                    std::vector<int> &aPartSize,
+                    const double *padfBurnValue,
+                    GDALBurnValueSrc eBurnValueSrc,
+                    GDALRasterMergeAlg eMergeAlg )
 
+{
     if(nPixelSpace == 0)
     {
         nPixelSpace = GDALGetDataTypeSizeBytes(eType);
@@ -434,32 +451,6 @@ gv_rasterize_one_shape( unsigned char *pabyChunkBuf, int nXOff, int nYOff,
     sInfo.eBurnValueSource = eBurnValueSrc;
     sInfo.eMergeAlg = eMergeAlg;
 
-/* -------------------------------------------------------------------- */
-/*      Transform polygon geometries into a set of rings and a part     */
-/*      size list.                                                      */
-/* -------------------------------------------------------------------- */
-    std::vector<double> aPointX;
-    std::vector<double> aPointY;
-    std::vector<double> aPointVariant;
-    std::vector<int> aPartSize;
-
-    GDALCollectRingsFromGeometry( poShape, aPointX, aPointY, aPointVariant,
-                                  aPartSize, eBurnValueSrc );
-
-/* -------------------------------------------------------------------- */
-/*      Transform points if needed.                                     */
-/* -------------------------------------------------------------------- */
-    if( pfnTransformer != nullptr )
-    {
-        int *panSuccess =
-            static_cast<int *>(CPLCalloc(sizeof(int), aPointX.size()));
-
-        // TODO: We need to add all appropriate error checking at some point.
-        pfnTransformer( pTransformArg, FALSE, static_cast<int>(aPointX.size()),
-                        aPointX.data(), aPointY.data(), nullptr, panSuccess );
-        CPLFree( panSuccess );
-    }
-
 /* -------------------------------------------------------------------- */
 /*      Shift to account for the buffer offset of this buffer.          */
 /* -------------------------------------------------------------------- */
@@ -557,6 +548,68 @@ gv_rasterize_one_shape( unsigned char *pabyChunkBuf, int nXOff, int nYOff,
     }
 }
 
+/************************************************************************/
+/*                       gv_rasterize_one_shape()                       */
+/************************************************************************/
+static void
+gv_rasterize_one_shape( unsigned char *pabyChunkBuf, int nXOff, int nYOff,
+                        int nXSize, int nYSize,
+                        int nBands, GDALDataType eType,
+                        int nPixelSpace, GSpacing nLineSpace, GSpacing nBandSpace,
+                        int bAllTouched,
+                        const OGRGeometry *poShape,
+                        const double *padfBurnValue,
+                        GDALBurnValueSrc eBurnValueSrc,
+                        GDALRasterMergeAlg eMergeAlg,
+                        GDALTransformerFunc pfnTransformer,
+                        void *pTransformArg )
+
+{
+    if( poShape == nullptr || poShape->IsEmpty() )
+        return;
+    const auto eGeomType = wkbFlatten(poShape->getGeometryType());
+
+    if( (eGeomType == wkbMultiLineString ||
+         eGeomType == wkbMultiPolygon ||
+         eGeomType == wkbGeometryCollection) &&
+        eMergeAlg == GRMA_Replace )
+    {
+        // Speed optimization: in replace mode, we can rasterize each part of
+        // a geometry collection separately.
+        const auto poGC = poShape->toGeometryCollection();
+        for( const auto poPart: *poGC )
+        {
+            gv_rasterize_one_shape(pabyChunkBuf, nXOff, nYOff,
+                                   nXSize, nYSize,
+                                   nBands, eType,
+                                   nPixelSpace, nLineSpace, nBandSpace,
+                                   bAllTouched,
+                                   poPart,
+                                   padfBurnValue,
+                                   eBurnValueSrc,
+                                   eMergeAlg,
+                                   pfnTransformer,
+                                   pTransformArg);
+        }
+        return;
+    }
+
+    std::vector<double> aPointX;
+    std::vector<double> aPointY;
+    std::vector<double> aPointVariant;
+    std::vector<int> aPartSize;
+
+    GDALCollectTransformedRings( poShape, aPointX, aPointY, aPointVariant,
+                                 aPartSize, eBurnValueSrc,
+                                 pfnTransformer, pTransformArg );
+
+    gv_rasterize_rings( pabyChunkBuf, nXOff, nYOff, nXSize, nYSize,
+                        nBands, eType, nPixelSpace, nLineSpace, nBandSpace,
+                        bAllTouched, eGeomType,
+                        aPointX, aPointY, aPointVariant, aPartSize,
+                        padfBurnValue, eBurnValueSrc, eMergeAlg );
+}
+
 /************************************************************************/
 /*                        GDALRasterizeOptions()                        */
 /*                                                                      */
@@ -1113,6 +1166,631 @@ CPLErr GDALRasterizeGeometries( GDALDatasetH hDS,
     return eErr;
 }
 
+/************************************************************************/
+/*                  GDALRasterizeCreateLayerTransformer()               */
+/*                                                                      */
+/*      Create a transformer from the coordinate system of a layer to   */
+/*      the pixel/line coordinates of the target dataset.               */
+/************************************************************************/
+
+static void *GDALRasterizeCreateLayerTransformer( OGRLayer *poLayer,
+                                                  GDALDataset *poDS )
+{
+    char *pszProjection = nullptr;
+
+    OGRSpatialReference *poSRS = poLayer->GetSpatialRef();
+    if( !poSRS )
+    {
+        CPLError( CE_Warning, CPLE_AppDefined,
+                  "Failed to fetch spatial reference on layer %s "
+                  "to build transformer, assuming matching coordinate "
+                  "systems.",
+                  poLayer->GetLayerDefn()->GetName() );
+    }
+    else
+    {
+        poSRS->exportToWkt( &pszProjection );
+    }
+
+    char** papszTransformerOptions = nullptr;
+    if( pszProjection != nullptr )
+        papszTransformerOptions = CSLSetNameValue(
+                papszTransformerOptions, "SRC_SRS", pszProjection );
+    double adfGeoTransform[6] = {};
+    if( poDS->GetGeoTransform( adfGeoTransform ) != CE_None &&
+        poDS->GetGCPCount() == 0 &&
+        poDS->GetMetadata("RPC") == nullptr )
+    {
+        papszTransformerOptions = CSLSetNameValue(
+            papszTransformerOptions, "DST_METHOD", "NO_GEOTRANSFORM");
+    }
+
+    void *pTransformArg =
+        GDALCreateGenImgProjTransformer2( nullptr,
+                                          GDALDataset::ToHandle(poDS),
+                                          papszTransformerOptions );
+
+    CPLFree( pszProjection );
+    CSLDestroy( papszTransformerOptions );
+
+    return pTransformArg;
+}
+
+/************************************************************************/
+/*                       GDALRasterizeChunkIndex                        */
+/************************************************************************/
+
+namespace {
+
+// Header of a record of the temporary file of a GDALRasterizeChunkIndex.
+// It is followed by nBands burn values, nParts part sizes (as GInt32),
+// then nPoints X, nPoints Y and, if bHasVariant, nPoints variant values
+// (as doubles), all in native byte order.
+struct GDALRasterizeRecordHeader
+{
+    GInt32 nGeomType;
+    GInt32 nParts;
+    GInt32 nPoints;
+    GInt32 bHasVariant;
+};
+
+// Geometries converted once to pixel/line rings and stored in a temporary
+// file, with for each horizontal chunk of the output raster the list of
+// the records whose extent intersects it, in burning order.
+class GDALRasterizeChunkIndex
+{
+  public:
+    GDALRasterizeChunkIndex( int nXSize, int nYSize, int nYChunkSize,
+                             int nBands, GDALBurnValueSrc eBurnValueSrc,
+                             GDALRasterMergeAlg eMergeAlg ) :
+        m_nXSize(nXSize), m_nYSize(nYSize), m_nYChunkSize(nYChunkSize),
+        m_nBands(nBands), m_eBurnValueSrc(eBurnValueSrc),
+        m_eMergeAlg(eMergeAlg),
+        m_aoChunkRecords((nYSize + nYChunkSize - 1) / nYChunkSize)
+    {}
+
+    ~GDALRasterizeChunkIndex()
+    {
+        if( m_fp != nullptr )
+        {
+            VSIFCloseL( m_fp );
+            VSIUnlink( m_osFilename );
+        }
+    }
+
+    bool Open()
+    {
+        m_osFilename = CPLGenerateTempFilename( "gdal_rasterize" );
+        m_fp = VSIFOpenL( m_osFilename, "wb+" );
+        return m_fp != nullptr;
+    }
+
+    const char *GetFilename() const { return m_osFilename.c_str(); }
+
+    int GetChunkCount() const
+        { return static_cast<int>(m_aoChunkRecords.size()); }
+
+    bool AddShape( const OGRGeometry *poShape, const double *padfBurnValue,
+                   GDALTransformerFunc pfnTransformer, void *pTransformArg );
+
+    bool ReadChunk( int iChunk, std::vector<GByte> &abyRecords );
+
+  private:
+    // Offset and size of consecutive records of the temporary file.
+    typedef std::pair<vsi_l_offset, size_t> Extent;
+
+    int m_nXSize;
+    int m_nYSize;
+    int m_nYChunkSize;
+    int m_nBands;
+    GDALBurnValueSrc m_eBurnValueSrc;
+    GDALRasterMergeAlg m_eMergeAlg;
+    CPLString m_osFilename{};
+    VSILFILE *m_fp = nullptr;
+    vsi_l_offset m_nFileSize = 0;
+    std::vector<std::vector<Extent>> m_aoChunkRecords;
+    std::vector<GByte> m_abyRecord{};
+
+    GDALRasterizeChunkIndex(const GDALRasterizeChunkIndex&) = delete;
+    GDALRasterizeChunkIndex& operator=(const GDALRasterizeChunkIndex&) = delete;
+};
+
+/************************************************************************/
+/*                              AddShape()                              */
+/************************************************************************/
+
+bool GDALRasterizeChunkIndex::AddShape( const OGRGeometry *poShape,
+                                        const double *padfBurnValue,
+                                        GDALTransformerFunc pfnTransformer,
+                                        void *pTransformArg )
+{
+    if( poShape == nullptr || poShape->IsEmpty() )
+        return true;
+    const auto eGeomType = wkbFlatten(poShape->getGeometryType());
+
+    // Same splitting of collections as gv_rasterize_one_shape().
+    if( (eGeomType == wkbMultiLineString ||
+         eGeomType == wkbMultiPolygon ||
+         eGeomType == wkbGeometryCollection) &&
+        m_eMergeAlg == GRMA_Replace )
+    {
+        const auto poGC = poShape->toGeometryCollection();
+        for( const auto poPart: *poGC )
+        {
+            if( !AddShape(poPart, padfBurnValue,
+                          pfnTransformer, pTransformArg) )
+                return false;
+        }
+        return true;
+    }
+
+    std::vector<double> aPointX;
+    std::vector<double> aPointY;
+    std::vector<double> aPointVariant;
+    std::vector<int> aPartSize;
+
+    GDALCollectTransformedRings( poShape, aPointX, aPointY, aPointVariant,
+                                 aPartSize, m_eBurnValueSrc,
+                                 pfnTransformer, pTransformArg );
+    if( aPointX.empty() )
+        return true;
+
+/* -------------------------------------------------------------------- */
+/*      Find the chunks that the shape may touch.  A margin of one      */
+/*      pixel is kept so that ALL_TOUCHED mode is also covered.         */
+/* -------------------------------------------------------------------- */
+    double dfMinX = std::numeric_limits<double>::infinity();
+    double dfMaxX = -std::numeric_limits<double>::infinity();
+    double dfMinY = std::numeric_limits<double>::infinity();
+    double dfMaxY = -std::numeric_limits<double>::infinity();
+    for( size_t i = 0; i < aPointX.size(); i++ )
+    {
+        if( aPointX[i] < dfMinX ) dfMinX = aPointX[i];
+        if( aPointX[i] > dfMaxX ) dfMaxX = aPointX[i];
+        if( aPointY[i] < dfMinY ) dfMinY = aPointY[i];
+        if( aPointY[i] > dfMaxY ) dfMaxY = aPointY[i];
+    }
+    if( !(dfMaxX >= -1.0 && dfMinX <= m_nXSize + 1.0 &&
+          dfMaxY >= -1.0 && dfMinY <= m_nYSize + 1.0) )
+    {
+        return true;
+    }
+    const int nMinLine = static_cast<int>(
+        std::max(0.0, floor(dfMinY) - 1.0));
+    const int nMaxLine = static_cast<int>(
+        std::min(static_cast<double>(m_nYSize - 1), floor(dfMaxY) + 1.0));
+
+/* -------------------------------------------------------------------- */
+/*      Serialize the record.                                           */
+/* -------------------------------------------------------------------- */
+    GDALRasterizeRecordHeader sHeader;
+    sHeader.nGeomType = static_cast<GInt32>(eGeomType);
+    sHeader.nParts = static_cast<GInt32>(aPartSize.size());
+    sHeader.nPoints = static_cast<GInt32>(aPointX.size());
+    sHeader.bHasVariant = m_eBurnValueSrc != GBV_UserBurnValue;
+
+    const size_t nPointArrays = sHeader.bHasVariant ? 3 : 2;
+    const size_t nRecordSize = sizeof(sHeader) +
+        m_nBands * sizeof(double) + aPartSize.size() * sizeof(GInt32) +
+        nPointArrays * aPointX.size() * sizeof(double);
+    m_abyRecord.resize( nRecordSize );
+
+    GByte *pabyIter = m_abyRecord.data();
+    memcpy( pabyIter, &sHeader, sizeof(sHeader) );
+    pabyIter += sizeof(sHeader);
+    memcpy( pabyIter, padfBurnValue, m_nBands * sizeof(double) );
+    pabyIter += m_nBands * sizeof(double);
+    for( size_t i = 0; i < aPartSize.size(); i++ )
+    {
+        const GInt32 nPartSize = aPartSize[i];
+        memcpy( pabyIter, &nPartSize, sizeof(GInt32) );
+        pabyIter += sizeof(GInt32);
+    }
+    memcpy( pabyIter, aPointX.data(), aPointX.size() * sizeof(double) );
+    pabyIter += aPointX.size() * sizeof(double);
+    memcpy( pabyIter, aPointY.data(), aPointY.size() * sizeof(double) );
+    pabyIter += aPointY.size() * sizeof(double);
+    if( sHeader.bHasVariant )
+        memcpy( pabyIter, aPointVariant.data(),
+                aPointVariant.size() * sizeof(double) );
+
+    if( VSIFWriteL( m_abyRecord.data(), nRecordSize, 1, m_fp ) != 1 )
+    {
+        CPLError( CE_Failure, CPLE_FileIO,
+                  "Cannot write to temporary file %s",
+                  m_osFilename.c_str() );
+        return false;
+    }
+
+    for( int iChunk = nMinLine / m_nYChunkSize;
+         iChunk <= nMaxLine / m_nYChunkSize; iChunk++ )
+    {
+        auto &aoExtents = m_aoChunkRecords[iChunk];
+        if( !aoExtents.empty() &&
+            aoExtents.back().first + aoExtents.back().second == m_nFileSize )
+        {
+            aoExtents.back().second += nRecordSize;
+        }
+        else
+        {
+            aoExtents.push_back( Extent(m_nFileSize, nRecordSize) );
+        }
+    }
+    m_nFileSize += nRecordSize;
+
+    return true;
+}
+
+/************************************************************************/
+/*                             ReadChunk()                              */
+/************************************************************************/
+
+bool GDALRasterizeChunkIndex::ReadChunk( int iChunk,
+                                         std::vector<GByte> &abyRecords )
+{
+    const auto &aoExtents = m_aoChunkRecords[iChunk];
+    size_t nSize = 0;
+    for( const auto &oExtent: aoExtents )
+        nSize += oExtent.second;
+
+    try
+    {
+        abyRecords.resize( nSize );
+    }
+    catch( const std::bad_alloc& )
+    {
+        CPLError( CE_Failure, CPLE_OutOfMemory,
+                  "Cannot allocate " CPL_FRMT_GUIB " bytes",
+                  static_cast<GUIntBig>(nSize) );
+        return false;
+    }
+
+    GByte *pabyIter = abyRecords.data();
+    for( const auto &oExtent: aoExtents )
+    {
+        if( VSIFSeekL( m_fp, oExtent.first, SEEK_SET ) != 0 ||
+            VSIFReadL( pabyIter, oExtent.second, 1, m_fp ) != 1 )
+        {
+            CPLError( CE_Failure, CPLE_FileIO,
+                      "Cannot read temporary file %s",
+                      m_osFilename.c_str() );
+            return false;
+        }
+        pabyIter += oExtent.second;
+    }
+
+    // The records of this chunk are no longer needed.
+    std::vector<Extent>().swap( m_aoChunkRecords[iChunk] );
+    return true;
+}
+
+/************************************************************************/
+/*                        GDALRasterizeChunkJob                         */
+/************************************************************************/
+
+// Burning of the records of a chunk into its buffer, possibly run by a
+// worker thread.
+struct GDALRasterizeChunkJob
+{
+    int nYOff = 0;
+    int nXSize = 0;
+    int nYSize = 0;
+    int nBands = 0;
+    GDALDataType eType = GDT_Unknown;
+    int bAllTouched = FALSE;
+    GDALBurnValueSrc eBurnValueSrc = GBV_UserBurnValue;
+    GDALRasterMergeAlg eMergeAlg = GRMA_Replace;
+    unsigned char *pabyChunkBuf = nullptr;
+    std::vector<GByte> abyRecords{};
+    GDALJobDoneFlag oDone{};
+
+    GDALRasterizeChunkJob() = default;
+    ~GDALRasterizeChunkJob() { VSIFree( pabyChunkBuf ); }
+
+    GDALRasterizeChunkJob(const GDALRasterizeChunkJob&) = delete;
+    GDALRasterizeChunkJob& operator=(const GDALRasterizeChunkJob&) = delete;
+};
+
+void GDALRasterizeChunkJobFunc( void *pData )
+{
+    GDALRasterizeChunkJob *psJob = static_cast<GDALRasterizeChunkJob *>(pData);
+
+    std::vector<double> aPointX;
+    std::vector<double> aPointY;
+    std::vector<double> aPointVariant;
+    std::vector<int> aPartSize;
+    std::vector<double> adfBurnValue(psJob->nBands);
+
+    const GByte *pabyIter = psJob->abyRecords.data();
+    const GByte *pabyEnd = pabyIter + psJob->abyRecords.size();
+    while( pabyIter < pabyEnd )
+    {
+        GDALRasterizeRecordHeader sHeader;
+        memcpy( &sHeader, pabyIter, sizeof(sHeader) );
+        pabyIter += sizeof(sHeader);
+
+        memcpy( adfBurnValue.data(), pabyIter,
+                psJob->nBands * sizeof(double) );
+        pabyIter += psJob->nBands * sizeof(double);
+
+        aPartSize.resize( sHeader.nParts );
+        for( int i = 0; i < sHeader.nParts; i++ )
+        {
+            GInt32 nPartSize = 0;
+            memcpy( &nPartSize, pabyIter, sizeof(GInt32) );
+            pabyIter += sizeof(GInt32);
+            aPartSize[i] = nPartSize;
+        }
+
+        const size_t nArraySize = sHeader.nPoints * sizeof(double);
+        aPointX.resize( sHeader.nPoints );
+        memcpy( aPointX.data(), pabyIter, nArraySize );
+        pabyIter += nArraySize;
+        aPointY.resize( sHeader.nPoints );
+        memcpy( aPointY.data(), pabyIter, nArraySize );
+        pabyIter += nArraySize;
+        if( sHeader.bHasVariant )
+        {
+            aPointVariant.resize( sHeader.nPoints );
+            memcpy( aPointVariant.data(), pabyIter, nArraySize );
+            pabyIter += nArraySize;
+        }
+        else
+        {
+            aPointVariant.clear();
+        }
+
+        gv_rasterize_rings( psJob->pabyChunkBuf, 0, psJob->nYOff,
+                            psJob->nXSize, psJob->nYSize,
+                            psJob->nBands, psJob->eType, 0, 0, 0,
+                            psJob->bAllTouched,
+                            static_cast<OGRwkbGeometryType>(sHeader.nGeomType),
+                            aPointX, aPointY, aPointVariant, aPartSize,
+                            adfBurnValue.data(), psJob->eBurnValueSrc,
+                            psJob->eMergeAlg );
+    }
+
+    // Free the records as soon as possible.
+    std::vector<GByte>().swap( psJob->abyRecords );
+
+    psJob->oDone.SetDone();
+}
+
+} // namespace
+
+/************************************************************************/
+/*                     GDALRasterizeLayersBinned()                      */
+/*                                                                      */
+/*      Read the features of all layers once, binning them by output    */
+/*      chunk in a temporary file, then burn the chunks, concurrently   */
+/*      if nThreads > 1.  Raster I/O is done from the calling thread    */
+/*      only, and the shapes of a chunk are burnt in layer and feature  */
+/*      order, so the result is the same as in the sequential path.     */
+/************************************************************************/
+
+static CPLErr GDALRasterizeLayersBinned( GDALRasterizeChunkIndex &oIndex,
+                                         GDALDataset *poDS,
+                                         int nBandCount, int *panBandList,
+                                         int nLayerCount, OGRLayerH *pahLayers,
+                                         GDALTransformerFunc pfnTransformer,
+                                         void *pTransformArg,
+                                         double *padfLayerBurnValues,
+                                         const char *pszBurnAttribute,
+                                         int bAllTouched,
+                                         GDALBurnValueSrc eBurnValueSource,
+                                         GDALRasterMergeAlg eMergeAlg,
+                                         GDALDataType eType,
+                                         int nYChunkSize, int nThreads,
+                                         GDALProgressFunc pfnProgress,
+                                         void *pProgressArg )
+{
+    const int nXSize = poDS->GetRasterXSize();
+    const int nYSize = poDS->GetRasterYSize();
+
+    // Binning of the features accounts for the first 20% of the progress.
+    const double dfBinningRatio = 0.2;
+    pfnProgress( 0.0, nullptr, pProgressArg );
+
+/* ==================================================================== */
+/*      Read all features once, transforming them and binning them by   */
+/*      chunk.                                                          */
+/* ==================================================================== */
+    CPLErr eErr = CE_None;
+    std::vector<double> adfAttrValues(nBandCount);
+
+    for( int iLayer = 0; iLayer < nLayerCount && eErr == CE_None; iLayer++ )
+    {
+        OGRLayer *poLayer = reinterpret_cast<OGRLayer *>(pahLayers[iLayer]);
+
+        if( !poLayer )
+        {
+            CPLError( CE_Warning, CPLE_AppDefined,
+                      "Layer element number %d is NULL, skipping.", iLayer );
+            continue;
+        }
+
+        if( poLayer->GetFeatureCount(FALSE) == 0 )
+            continue;
+
+        int iBurnField = -1;
+        const double *padfBurnValues = nullptr;
+
+        if( pszBurnAttribute )
+        {
+            iBurnField =
+                poLayer->GetLayerDefn()->GetFieldIndex( pszBurnAttribute );
+            if( iBurnField == -1 )
+            {
+                CPLError( CE_Warning, CPLE_AppDefined,
+                          "Failed to find field %s on layer %s, skipping.",
+                          pszBurnAttribute,
+                          poLayer->GetLayerDefn()->GetName() );
+                continue;
+            }
+            padfBurnValues = adfAttrValues.data();
+        }
+        else
+        {
+            padfBurnValues = padfLayerBurnValues + iLayer * nBandCount;
+        }
+
+        GDALTransformerFunc pfnLayerTransformer = pfnTransformer;
+        void *pLayerTransformArg = pTransformArg;
+        if( pfnTransformer == nullptr )
+        {
+            pLayerTransformArg =
+                GDALRasterizeCreateLayerTransformer( poLayer, poDS );
+            if( pLayerTransformArg == nullptr )
+                return CE_Failure;
+            pfnLayerTransformer = GDALGenImgProjTransform;
+        }
+
+        poLayer->ResetReading();
+
+        OGRFeature *poFeat = nullptr;
+        while( eErr == CE_None &&
+               (poFeat = poLayer->GetNextFeature()) != nullptr )
+        {
+            if( pszBurnAttribute )
+            {
+                const double dfAttrValue =
+                    poFeat->GetFieldAsDouble( iBurnField );
+                for( int iBand = 0 ; iBand < nBandCount ; iBand++)
+                    adfAttrValues[iBand] = dfAttrValue;
+            }
+
+            if( !oIndex.AddShape( poFeat->GetGeometryRef(), padfBurnValues,
+                                  pfnLayerTransformer, pLayerTransformArg ) )
+                eErr = CE_Failure;
+
+            delete poFeat;
+        }
+
+        poLayer->ResetReading();
+
+        if( pfnTransformer == nullptr )
+            GDALDestroyTransformer( pLayerTransformArg );
+
+        if( eErr == CE_None &&
+            !pfnProgress( dfBinningRatio * (iLayer + 1) / nLayerCount,
+                          "", pProgressArg ) )
+        {
+            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+            eErr = CE_Failure;
+        }
+    }
+    if( eErr != CE_None )
+        return eErr;
+
+/* ==================================================================== */
+/*      Burn the chunks.  At most nThreads chunk buffers are in use at  */
+/*      the same time.                                                  */
+/* ==================================================================== */
+    const int nChunkCount = oIndex.GetChunkCount();
+    CPLDebug( "GDAL",
+              "Rasterizer operating on %d binned swaths of %d scanlines "
+              "with %d thread(s).",
+              nChunkCount, nYChunkSize, nThreads );
+
+    // Must be declared before the pool, so that jobs are destroyed after
+    // they have completed.
+    std::deque<std::unique_ptr<GDALRasterizeChunkJob>> apoJobs;
+
+    std::unique_ptr<CPLWorkerThreadPool> poPool;
+    if( nThreads > 1 )
+    {
+        poPool.reset( new CPLWorkerThreadPool() );
+        if( !poPool->Setup( nThreads, nullptr, nullptr ) )
+            return CE_Failure;
+    }
+    const size_t nMaxJobsInFlight = std::max( 1, nThreads );
+
+    // Wait for the completion of the oldest job and write its buffer.
+    const auto writeFirstJob = [&]()
+    {
+        GDALRasterizeChunkJob *psJob = apoJobs.front().get();
+        psJob->oDone.Wait();
+        CPLErr eJobErr =
+            poDS->RasterIO( GF_Write, 0, psJob->nYOff,
+                            nXSize, psJob->nYSize,
+                            psJob->pabyChunkBuf, nXSize, psJob->nYSize,
+                            eType, nBandCount, panBandList,
+                            0, 0, 0, nullptr );
+        if( eJobErr == CE_None &&
+            !pfnProgress( dfBinningRatio + (1.0 - dfBinningRatio) *
+                              (psJob->nYOff + psJob->nYSize) / nYSize,
+                          "", pProgressArg ) )
+        {
+            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+            eJobErr = CE_Failure;
+        }
+        apoJobs.pop_front();
+        return eJobErr;
+    };
+
+    const int nScanlineBytes =
+        nBandCount * nXSize * GDALGetDataTypeSizeBytes(eType);
+
+    for( int iChunk = 0; iChunk < nChunkCount && eErr == CE_None; iChunk++ )
+    {
+        if( apoJobs.size() == nMaxJobsInFlight )
+        {
+            eErr = writeFirstJob();
+            if( eErr != CE_None )
+                break;
+        }
+
+        std::unique_ptr<GDALRasterizeChunkJob> poJob(
+            new GDALRasterizeChunkJob() );
+        poJob->nYOff = iChunk * nYChunkSize;
+        poJob->nXSize = nXSize;
+        poJob->nYSize = std::min( nYChunkSize, nYSize - poJob->nYOff );
+        poJob->nBands = nBandCount;
+        poJob->eType = eType;
+        poJob->bAllTouched = bAllTouched;
+        poJob->eBurnValueSrc = eBurnValueSource;
+        poJob->eMergeAlg = eMergeAlg;
+        poJob->pabyChunkBuf = static_cast<unsigned char *>(
+            VSI_MALLOC2_VERBOSE(poJob->nYSize, nScanlineBytes));
+        if( poJob->pabyChunkBuf == nullptr ||
+            !oIndex.ReadChunk( iChunk, poJob->abyRecords ) )
+        {
+            eErr = CE_Failure;
+            break;
+        }
+
+        eErr = poDS->RasterIO( GF_Read, 0, poJob->nYOff,
+                               nXSize, poJob->nYSize,
+                               poJob->pabyChunkBuf, nXSize, poJob->nYSize,
+                               eType, nBandCount, panBandList,
+                               0, 0, 0, nullptr );
+        if( eErr != CE_None )
+            break;
+
+        apoJobs.push_back( std::move(poJob) );
+        if( poPool )
+        {
+            if( !poPool->SubmitJob( GDALRasterizeChunkJobFunc,
+                                    apoJobs.back().get() ) )
+            {
+                apoJobs.pop_back();
+                eErr = CE_Failure;
+            }
+        }
+        else
+        {
+            GDALRasterizeChunkJobFunc( apoJobs.back().get() );
+        }
+    }
+
+    while( eErr == CE_None && !apoJobs.empty() )
+        eErr = writeFirstJob();
+    if( poPool )
+        poPool->WaitCompletion();
+
+    return eErr;
+}
+
 /************************************************************************/
 /*                        GDALRasterizeLayers()                         */
 /************************************************************************/
@@ -1169,7 +1847,25 @@ CPLErr GDALRasterizeGeometries( GDALDatasetH hDS,
  * <li>"MERGE_ALG": May be REPLACE (the default) or ADD.  REPLACE results in
  * overwriting of value, while ADD adds the new value to the existing raster,
  * suitable for heatmaps for instance.</li>
+ * <li>"NUM_THREADS": (GDAL >= 3.1) Number of worker threads used to burn
+ * chunks, or ALL_CPUS. Defaults to the value of the GDAL_NUM_THREADS
+ * configuration option, or 1. When greater than 1, the default chunk size
+ * is divided by the number of threads, and BINNING defaults to YES.</li>
+ * <li>"BINNING": (GDAL >= 3.1) May be set to YES so that, when the raster
+ * is processed in more than one chunk, the features are read only once
+ * instead of once per chunk. Defaults to YES if NUM_THREADS is greater
+ * than 1, NO otherwise.</li>
  * </ul>
+ *
+ * With BINNING=YES, the features are transformed to pixel/line coordinates
+ * and binned by chunk in a temporary file (created in the directory pointed
+ * by the CPL_TMPDIR configuration option, or the current directory), and
+ * the chunks are then burnt, concurrently if NUM_THREADS is greater than 1.
+ * The shapes of a chunk are always burnt in layer and feature order, so
+ * that the result does not depend on the number of threads, whatever the
+ * MERGE_ALG. If the temporary file cannot be created, the features are read
+ * once per chunk, on a single thread.
+ *
  * @param pfnProgress the progress function to report completion.
  * @param pProgressArg callback data for progress function.
  *
@@ -1243,11 +1939,61 @@ CPLErr GDALRasterizeLayers( GDALDatasetH hDS,
             nYChunkSize = static_cast<int>(nYChunkSize64);
     }
 
+    const int nSingleThreadYChunkSize =
+        std::max(1, std::min(nYChunkSize, poDS->GetRasterYSize()));
+    const int nThreads = CPLGetNumThreadsOption(
+        CSLFetchNameValue(papszOptions, "NUM_THREADS"), "1");
+    if( nThreads > 1 )
+    {
+        // Each thread works on its own chunk: share the memory budget
+        // between them, and make sure that all threads get some work.
+        if( pszYChunkSize == nullptr || atoi(pszYChunkSize) == 0 )
+            nYChunkSize /= nThreads;
+        nYChunkSize = std::min( nYChunkSize,
+                                (poDS->GetRasterYSize() + nThreads - 1) /
+                                    nThreads );
+    }
+
     if( nYChunkSize < 1 )
         nYChunkSize = 1;
     if( nYChunkSize > poDS->GetRasterYSize() )
         nYChunkSize = poDS->GetRasterYSize();
 
+    const char *pszBurnAttribute = CSLFetchNameValue(papszOptions, "ATTRIBUTE");
+
+/* -------------------------------------------------------------------- */
+/*      When the raster must be processed in several chunks, and if     */
+/*      requested, read the layers only once, binning the features by   */
+/*      chunk in a temporary file, instead of reading them again for    */
+/*      each chunk.  Fall back to the latter if the file cannot be      */
+/*      created.                                                        */
+/* -------------------------------------------------------------------- */
+    if( nYChunkSize < poDS->GetRasterYSize() &&
+        CPLFetchBool(papszOptions, "BINNING", nThreads > 1) )
+    {
+        GDALRasterizeChunkIndex oIndex( poDS->GetRasterXSize(),
+                                        poDS->GetRasterYSize(), nYChunkSize,
+                                        nBandCount, eBurnValueSource,
+                                        eMergeAlg );
+        if( oIndex.Open() )
+        {
+            return GDALRasterizeLayersBinned( oIndex, poDS,
+                                              nBandCount, panBandList,
+                                              nLayerCount, pahLayers,
+                                              pfnTransformer, pTransformArg,
+                                              padfLayerBurnValues,
+                                              pszBurnAttribute, bAllTouched,
+                                              eBurnValueSource, eMergeAlg,
+                                              eType, nYChunkSize, nThreads,
+                                              pfnProgress, pProgressArg );
+        }
+        CPLDebug( "GDAL",
+                  "Cannot create temporary file %s. "
+                  "Rasterizing without binning, on a single thread.",
+                  oIndex.GetFilename() );
+        nYChunkSize = nSingleThreadYChunkSize;
+    }
+
     CPLDebug( "GDAL", "Rasterizer operating on %d swaths of %d scanlines.",
               (poDS->GetRasterYSize() + nYChunkSize - 1) / nYChunkSize,
               nYChunkSize );
@@ -1280,7 +2026,6 @@ CPLErr GDALRasterizeLayers( GDALDatasetH hDS,
 /*      geometries.                                                     */
 /* ==================================================================== */
     CPLErr eErr = CE_None;
-    const char *pszBurnAttribute = CSLFetchNameValue(papszOptions, "ATTRIBUTE");
 
     pfnProgress( 0.0, nullptr, pProgressArg );
 
@@ -1333,43 +2078,11 @@ CPLErr GDALRasterizeLayers( GDALDatasetH hDS,
 
         if( pfnTransformer == nullptr )
         {
-            char *pszProjection = nullptr;
             bNeedToFreeTransformer = true;
 
-            OGRSpatialReference *poSRS = poLayer->GetSpatialRef();
-            if( !poSRS )
-            {
-                CPLError( CE_Warning, CPLE_AppDefined,
-                          "Failed to fetch spatial reference on layer %s "
-                          "to build transformer, assuming matching coordinate "
-                          "systems.",
-                          poLayer->GetLayerDefn()->GetName() );
-            }
-            else
-            {
-                poSRS->exportToWkt( &pszProjection );
-            }
-
-            char** papszTransformerOptions = nullptr;
-            if( pszProjection != nullptr )
-                papszTransformerOptions = CSLSetNameValue(
-                        papszTransformerOptions, "SRC_SRS", pszProjection );
-            double adfGeoTransform[6] = {};
-            if( poDS->GetGeoTransform( adfGeoTransform ) != CE_None &&
-                poDS->GetGCPCount() == 0 &&
-                poDS->GetMetadata("RPC") == nullptr )
-            {
-                papszTransformerOptions = CSLSetNameValue(
-                    papszTransformerOptions, "DST_METHOD", "NO_GEOTRANSFORM");
-            }
-
             pTransformArg =
-                GDALCreateGenImgProjTransformer2( nullptr, hDS,
-                                                  papszTransformerOptions );
+                GDALRasterizeCreateLayerTransformer( poLayer, poDS );
             pfnTransformer = GDALGenImgProjTransform;
-
-            CPLFree( pszProjection );
-            CSLDestroy( papszTransformerOptions );
             if( pTransformArg == nullptr )
             {
                 CPLFree( pabyChunkBuf );
@@ -42,6 +42,9 @@
 #include <cstring>
 
 #include <algorithm>
+#include <map>
+#include <mutex>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
@@ -52,6 +55,7 @@
 #include "cpl_vsi.h"
 #include "gdal.h"
 #include "gdal_priv.h"
+#include "gdalsse_priv.h"
 #include "ogr_core.h"
 #include "ogr_spatialref.h"
 #include "ogr_srs_api.h"
@@ -68,6 +72,9 @@ CPL_C_END
 
 static CPLXMLNode *GDALSerializeReprojectionTransformer( void *pTransformArg );
 static void *GDALDeserializeReprojectionTransformer( CPLXMLNode *psTree );
+static void *GDALCreateSimilarReprojectionTransformer( void *hTransformArg,
+                                                       double dfRatioX,
+                                                       double dfRatioY );
 
 static CPLXMLNode *GDALSerializeGenImgProjTransformer( void *pTransformArg );
 static void *GDALDeserializeGenImgProjTransformer( CPLXMLNode *psTree );
@@ -2877,6 +2884,7 @@ void *GDALCreateReprojectionTransformerEx(
     psInfo->sTI.pfnTransform = GDALReprojectionTransform;
     psInfo->sTI.pfnCleanup = GDALDestroyReprojectionTransformer;
     psInfo->sTI.pfnSerialize = GDALSerializeReprojectionTransformer;
+    psInfo->sTI.pfnCreateSimilar = GDALCreateSimilarReprojectionTransformer;
 
     return psInfo;
 }
@@ -2912,6 +2920,42 @@ void GDALDestroyReprojectionTransformer( void *pTransformArg )
     delete psInfo;
 }
 
+/************************************************************************/
+/*               GDALCreateSimilarReprojectionTransformer()             */
+/************************************************************************/
+
+// Clones the coordinate transformations, which share the coordinate
+// operations already researched, instead of serializing the transformer and
+// creating new ones from the WKT of the CRS.
+static void *
+GDALCreateSimilarReprojectionTransformer( void *hTransformArg,
+                                          double /* dfRatioX */,
+                                          double /* dfRatioY */ )
+{
+    VALIDATE_POINTER1( hTransformArg,
+                       "GDALCreateSimilarReprojectionTransformer", nullptr );
+
+    GDALReprojectionTransformInfo *psInfo =
+        static_cast<GDALReprojectionTransformInfo *>(hTransformArg);
+
+    // Working on georeferenced coordinates, the ratios do not apply.
+    OGRCoordinateTransformation *poForwardTransform =
+        psInfo->poForwardTransform->Clone();
+    if( poForwardTransform == nullptr )
+        return nullptr;
+
+    GDALReprojectionTransformInfo *psClonedInfo =
+        new GDALReprojectionTransformInfo();
+    memcpy( &psClonedInfo->sTI, &psInfo->sTI, sizeof(GDALTransformerInfo) );
+    psClonedInfo->papszOptions = CSLDuplicate(psInfo->papszOptions);
+    psClonedInfo->dfTime = psInfo->dfTime;
+    psClonedInfo->poForwardTransform = poForwardTransform;
+    if( psInfo->poReverseTransform )
+        psClonedInfo->poReverseTransform = psInfo->poReverseTransform->Clone();
+
+    return psClonedInfo;
+}
+
 /************************************************************************/
 /*                     GDALReprojectionTransform()                      */
 /************************************************************************/
@@ -3097,6 +3141,440 @@ GDALDeserializeReprojectionTransformer( CPLXMLNode *psTree )
 /* ==================================================================== */
 /************************************************************************/
 
+/************************************************************************/
+/*                       ApproxTransformLattice                         */
+/************************************************************************/
+
+namespace {
+
+// States of lattice nodes, edges and cells.
+constexpr GByte APPROX_LATTICE_UNKNOWN = 0;
+constexpr GByte APPROX_LATTICE_OK = 1;
+constexpr GByte APPROX_LATTICE_FAILED = 2;
+
+// Line j of the lattice: exact transformation of the nodes (i * step,
+// j * step), and validity of the horizontal edge starting at node i, of the
+// vertical edge from node (i, j) to node (i, j + 1) and of the cell whose
+// top-left corner is node (i, j).
+struct ApproxLatticeRow
+{
+    int nFirst = 0;
+    std::vector<double> adfX{};
+    std::vector<double> adfY{};
+    std::vector<double> adfZ{};
+    std::vector<GByte> abyNode{};
+    std::vector<GByte> abyHEdge{};
+    std::vector<GByte> abyVEdge{};
+    std::vector<GByte> abyCell{};
+
+    int GetLast() const { return nFirst + static_cast<int>(adfX.size()) - 1; }
+
+    void Extend( int nMin, int nMax );
+};
+
+// Interpolation coefficients of a cell along a line of constant y:
+// value = A + u * (B - A) with u the position inside the cell.
+struct ApproxLatticeCellLine
+{
+    bool bValid;
+    double dfAX, dfDX;
+    double dfAY, dfDY;
+    double dfAZ, dfDZ;
+};
+
+// Lattice of exactly transformed points on which the transformation is
+// bilinearly interpolated, for the two directions. It may be shared by
+// similar approximate transformers (for example the per-thread clones of a
+// warp transformer), hence the reference counting and the mutex.
+class ApproxTransformLattice
+{
+  public:
+    explicit ApproxTransformLattice( double dfStep ) : m_dfStep(dfStep) {}
+
+    ApproxTransformLattice *Reference()
+    {
+        std::lock_guard<std::mutex> oLock(m_oMutex);
+        m_nRefCount++;
+        return this;
+    }
+
+    void Release()
+    {
+        bool bDelete = false;
+        {
+            std::lock_guard<std::mutex> oLock(m_oMutex);
+            bDelete = --m_nRefCount == 0;
+        }
+        if( bDelete )
+            delete this;
+    }
+
+    double GetStep() const { return m_dfStep; }
+
+    bool GetCellLine( GDALTransformerFunc pfnBaseTransformer,
+                      void *pBaseCBData, int bDstToSrc, double dfMaxError,
+                      int nCellY, double dfV, int nCellMin, int nCellMax,
+                      std::vector<ApproxLatticeCellLine> &asCells );
+
+  private:
+    // Maximum number of lattice nodes kept in memory.
+    static constexpr size_t knMaxNodes = 1024 * 1024;
+
+    double m_dfStep;
+    std::mutex m_oMutex{};
+    int m_nRefCount = 1;
+    std::map<int, ApproxLatticeRow> m_aoRows[2]{};
+    size_t m_nNodes = 0;
+    // Incremented each time the rows are cleared.
+    int m_nGeneration = 0;
+
+    ApproxLatticeRow &GetRow( int bDstToSrc, int nRow, int nMin, int nMax );
+
+    ApproxTransformLattice(const ApproxTransformLattice&) = delete;
+    ApproxTransformLattice& operator=(const ApproxTransformLattice&) = delete;
+};
+
+/************************************************************************/
+/*                       ApproxLatticeRow::Extend()                     */
+/************************************************************************/
+
+void ApproxLatticeRow::Extend( int nMin, int nMax )
+{
+    if( adfX.empty() )
+    {
+        nFirst = nMin;
+    }
+    else
+    {
+        nMin = std::min(nMin, nFirst);
+        nMax = std::max(nMax, GetLast());
+    }
+    const size_t nBefore = static_cast<size_t>(nFirst - nMin);
+    const size_t nAfter = static_cast<size_t>(nMax - nMin + 1) -
+                          nBefore - adfX.size();
+    if( nBefore == 0 && nAfter == 0 )
+        return;
+
+    const auto extendDouble = [nBefore, nAfter](std::vector<double> &v)
+    {
+        v.insert(v.begin(), nBefore, 0.0);
+        v.insert(v.end(), nAfter, 0.0);
+    };
+    const auto extendState = [nBefore, nAfter](std::vector<GByte> &v)
+    {
+        v.insert(v.begin(), nBefore, APPROX_LATTICE_UNKNOWN);
+        v.insert(v.end(), nAfter, APPROX_LATTICE_UNKNOWN);
+    };
+    extendDouble(adfX);
+    extendDouble(adfY);
+    extendDouble(adfZ);
+    extendState(abyNode);
+    extendState(abyHEdge);
+    extendState(abyVEdge);
+    extendState(abyCell);
+    nFirst = nMin;
+}
+
+/************************************************************************/
+/*                  ApproxTransformLattice::GetRow()                    */
+/************************************************************************/
+
+ApproxLatticeRow &ApproxTransformLattice::GetRow( int bDstToSrc, int nRow,
+                                                  int nMin, int nMax )
+{
+    ApproxLatticeRow &oRow = m_aoRows[bDstToSrc ? 1 : 0][nRow];
+    const size_t nOldSize = oRow.adfX.size();
+    oRow.Extend(nMin, nMax);
+    m_nNodes += oRow.adfX.size() - nOldSize;
+    return oRow;
+}
+
+/************************************************************************/
+/*               ApproxTransformLattice::GetCellLine()                  */
+/*                                                                      */
+/*      Compute, if not already done, the lattice nodes and validate    */
+/*      the cells nCellMin to nCellMax of the line of cells nCellY, and */
+/*      return their interpolation coefficients for the position dfV    */
+/*      (in [0,1[) inside the cells.                                    */
+/*                                                                      */
+/*      The exact transformations are done without holding the mutex,  */
+/*      so that other threads can use the lattice meanwhile. Two        */
+/*      threads may then compute the same nodes or tests, in which case */
+/*      the first published result is kept.                             */
+/************************************************************************/
+
+bool ApproxTransformLattice::GetCellLine(
+    GDALTransformerFunc pfnBaseTransformer, void *pBaseCBData,
+    int bDstToSrc, double dfMaxError,
+    int nCellY, double dfV, int nCellMin, int nCellMax,
+    std::vector<ApproxLatticeCellLine> &asCells )
+{
+    std::vector<double> adfX;
+    std::vector<double> adfY;
+    std::vector<double> adfZ;
+    std::vector<int> anSuccess;
+
+    const auto transform = [&]()
+    {
+        anSuccess.resize(adfX.size());
+        std::fill(anSuccess.begin(), anSuccess.end(), FALSE);
+        if( !adfX.empty() &&
+            !pfnBaseTransformer(pBaseCBData, bDstToSrc,
+                                static_cast<int>(adfX.size()),
+                                adfX.data(), adfY.data(), adfZ.data(),
+                                anSuccess.data()) )
+        {
+            std::fill(anSuccess.begin(), anSuccess.end(), FALSE);
+        }
+    };
+
+    // Must be called with the mutex held. The rows are only valid until it
+    // is released.
+    ApproxLatticeRow *apoRows[2] = { nullptr, nullptr };
+    const auto getRows = [&]()
+    {
+        for( int iRow = 0; iRow < 2; iRow++ )
+            apoRows[iRow] = &GetRow(bDstToSrc, nCellY + iRow,
+                                    nCellMin, nCellMax + 1);
+    };
+
+/* -------------------------------------------------------------------- */
+/*      Transform the nodes that are not known yet.                     */
+/* -------------------------------------------------------------------- */
+    // Row (0 or 1) and column of the nodes to transform.
+    std::vector<std::pair<int, int>> aoNodes;
+    int nGeneration = 0;
+    {
+        std::lock_guard<std::mutex> oLock(m_oMutex);
+
+        if( m_nNodes > knMaxNodes )
+        {
+            m_aoRows[0].clear();
+            m_aoRows[1].clear();
+            m_nNodes = 0;
+            m_nGeneration++;
+        }
+        nGeneration = m_nGeneration;
+
+        getRows();
+        for( int iRow = 0; iRow < 2; iRow++ )
+        {
+            const ApproxLatticeRow &oRow = *apoRows[iRow];
+            for( int i = nCellMin; i <= nCellMax + 1; i++ )
+            {
+                if( oRow.abyNode[i - oRow.nFirst] == APPROX_LATTICE_UNKNOWN )
+                {
+                    aoNodes.push_back(std::pair<int, int>(iRow, i));
+                    adfX.push_back(i * m_dfStep);
+                    adfY.push_back((nCellY + iRow) * m_dfStep);
+                    adfZ.push_back(0.0);
+                }
+            }
+        }
+    }
+
+    if( !aoNodes.empty() )
+    {
+        transform();
+
+        std::lock_guard<std::mutex> oLock(m_oMutex);
+        // Nothing to publish in a lattice that has been cleared meanwhile.
+        if( nGeneration != m_nGeneration )
+            return false;
+        getRows();
+        for( size_t iPoint = 0; iPoint < aoNodes.size(); iPoint++ )
+        {
+            ApproxLatticeRow &oRow = *apoRows[aoNodes[iPoint].first];
+            const int k = aoNodes[iPoint].second - oRow.nFirst;
+            if( oRow.abyNode[k] == APPROX_LATTICE_UNKNOWN )
+            {
+                oRow.adfX[k] = adfX[iPoint];
+                oRow.adfY[k] = adfY[iPoint];
+                oRow.adfZ[k] = adfZ[iPoint];
+                oRow.abyNode[k] = anSuccess[iPoint] ?
+                    APPROX_LATTICE_OK : APPROX_LATTICE_FAILED;
+            }
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Transform the middle of the edges and the center of the cells   */
+/*      that are not validated yet.  A cell is valid if the bilinear    */
+/*      interpolation is within the error threshold at those points.    */
+/* -------------------------------------------------------------------- */
+    adfX.clear();
+    adfY.clear();
+    adfZ.clear();
+
+    // Which edge or cell a test point belongs to: horizontal edge of the
+    // top (nRow = 0) or bottom (nRow = 1) row, vertical edge or cell.
+    enum TestKind { TEST_HEDGE, TEST_VEDGE, TEST_CELL };
+    struct TestPoint
+    {
+        TestKind eKind;
+        int nRow;
+        int i;
+        double dfExpectedX;
+        double dfExpectedY;
+    };
+    std::vector<TestPoint> asTests;
+
+    const auto getState = [&apoRows](TestKind eKind, int nRow, int i) -> GByte&
+    {
+        ApproxLatticeRow &oRow = *apoRows[nRow];
+        const int k = i - oRow.nFirst;
+        return eKind == TEST_HEDGE ? oRow.abyHEdge[k] :
+               eKind == TEST_VEDGE ? oRow.abyVEdge[k] : oRow.abyCell[k];
+    };
+
+    // Queue the test of the middle of the segment between the given
+    // nodes (2 or 4), or mark it as failed if one of them is.
+    const auto addTest = [&](TestKind eKind, int nRow, int i,
+                             const int *panNodeRows, const int *panNodeCols,
+                             int nNodes, double dfX, double dfY)
+    {
+        GByte &byState = getState(eKind, nRow, i);
+        if( byState != APPROX_LATTICE_UNKNOWN )
+            return;
+        double dfExpectedX = 0.0;
+        double dfExpectedY = 0.0;
+        for( int iNode = 0; iNode < nNodes; iNode++ )
+        {
+            const ApproxLatticeRow &oRow = *apoRows[panNodeRows[iNode]];
+            const int k = panNodeCols[iNode] - oRow.nFirst;
+            if( oRow.abyNode[k] != APPROX_LATTICE_OK )
+            {
+                byState = APPROX_LATTICE_FAILED;
+                return;
+            }
+            dfExpectedX += oRow.adfX[k] / nNodes;
+            dfExpectedY += oRow.adfY[k] / nNodes;
+        }
+        adfX.push_back(dfX);
+        adfY.push_back(dfY);
+        adfZ.push_back(0.0);
+        TestPoint sTest = { eKind, nRow, i, dfExpectedX, dfExpectedY };
+        asTests.push_back(sTest);
+    };
+
+    const double dfTop = nCellY * m_dfStep;
+    const double dfHalfStep = 0.5 * m_dfStep;
+    {
+        std::lock_guard<std::mutex> oLock(m_oMutex);
+        if( nGeneration != m_nGeneration )
+            return false;
+        getRows();
+
+        for( int i = nCellMin; i <= nCellMax + 1; i++ )
+        {
+            const double dfLeft = i * m_dfStep;
+            if( i <= nCellMax )
+            {
+                for( int iRow = 0; iRow < 2; iRow++ )
+                {
+                    const int anRows[2] = { iRow, iRow };
+                    const int anCols[2] = { i, i + 1 };
+                    addTest(TEST_HEDGE, iRow, i, anRows, anCols, 2,
+                            dfLeft + dfHalfStep, dfTop + iRow * m_dfStep);
+                }
+            }
+            {
+                const int anRows[2] = { 0, 1 };
+                const int anCols[2] = { i, i };
+                addTest(TEST_VEDGE, 0, i, anRows, anCols, 2,
+                        dfLeft, dfTop + dfHalfStep);
+            }
+            if( i <= nCellMax )
+            {
+                const int anRows[4] = { 0, 0, 1, 1 };
+                const int anCols[4] = { i, i + 1, i, i + 1 };
+                addTest(TEST_CELL, 0, i, anRows, anCols, 4,
+                        dfLeft + dfHalfStep, dfTop + dfHalfStep);
+            }
+        }
+    }
+
+    if( !asTests.empty() )
+        transform();
+
+    std::lock_guard<std::mutex> oLock(m_oMutex);
+    if( nGeneration != m_nGeneration )
+        return false;
+    getRows();
+
+    if( !asTests.empty() )
+    {
+        // Edges first, as the validity of a cell depends on its edges.
+        for( int iPass = 0; iPass < 2; iPass++ )
+        {
+            for( size_t iTest = 0; iTest < asTests.size(); iTest++ )
+            {
+                const TestPoint &sTest = asTests[iTest];
+                if( (sTest.eKind == TEST_CELL) != (iPass == 1) )
+                    continue;
+                GByte &byState = getState(sTest.eKind, sTest.nRow, sTest.i);
+                if( byState != APPROX_LATTICE_UNKNOWN )
+                    continue;
+                const double dfError =
+                    fabs(sTest.dfExpectedX - adfX[iTest]) +
+                    fabs(sTest.dfExpectedY - adfY[iTest]);
+                byState = anSuccess[iTest] && dfError <= dfMaxError ?
+                    APPROX_LATTICE_OK : APPROX_LATTICE_FAILED;
+
+                // A cell is only valid if its 4 edges are valid too.
+                if( sTest.eKind == TEST_CELL && byState == APPROX_LATTICE_OK &&
+                    (getState(TEST_HEDGE, 0, sTest.i) != APPROX_LATTICE_OK ||
+                     getState(TEST_HEDGE, 1, sTest.i) != APPROX_LATTICE_OK ||
+                     getState(TEST_VEDGE, 0, sTest.i) != APPROX_LATTICE_OK ||
+                     getState(TEST_VEDGE, 0, sTest.i + 1) !=
+                                                        APPROX_LATTICE_OK) )
+                {
+                    byState = APPROX_LATTICE_FAILED;
+                }
+            }
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Interpolate the cells vertically at dfV.                        */
+/* -------------------------------------------------------------------- */
+    const ApproxLatticeRow &oTop = *apoRows[0];
+    const ApproxLatticeRow &oBottom = *apoRows[1];
+    asCells.resize(nCellMax - nCellMin + 1);
+    bool bAnyValid = false;
+    for( int i = nCellMin; i <= nCellMax; i++ )
+    {
+        ApproxLatticeCellLine &sCell = asCells[i - nCellMin];
+        const int kTop = i - oTop.nFirst;
+        const int kBottom = i - oBottom.nFirst;
+        sCell.bValid = oTop.abyCell[kTop] == APPROX_LATTICE_OK;
+        if( !sCell.bValid )
+            continue;
+        bAnyValid = true;
+
+        const auto interpolate = [dfV](const std::vector<double> &adfTop,
+                                       const std::vector<double> &adfBottom,
+                                       int k1, int k2,
+                                       double &dfA, double &dfD)
+        {
+            dfA = adfTop[k1] + dfV * (adfBottom[k2] - adfTop[k1]);
+            const double dfB =
+                adfTop[k1 + 1] + dfV * (adfBottom[k2 + 1] - adfTop[k1 + 1]);
+            dfD = dfB - dfA;
+        };
+        interpolate(oTop.adfX, oBottom.adfX, kTop, kBottom,
+                    sCell.dfAX, sCell.dfDX);
+        interpolate(oTop.adfY, oBottom.adfY, kTop, kBottom,
+                    sCell.dfAY, sCell.dfDY);
+        interpolate(oTop.adfZ, oBottom.adfZ, kTop, kBottom,
+                    sCell.dfAZ, sCell.dfDZ);
+    }
+
+    return bAnyValid;
+}
+
+} // namespace
+
 typedef struct
 {
     GDALTransformerInfo sTI;
@@ -3107,6 +3585,10 @@ typedef struct
     double dfMaxErrorReverse;
 
     int bOwnSubtransformer;
+
+    // Non-null when interpolating on a lattice of exactly transformed
+    // points is enabled (see GDALApproxTransformerSetGridStep()).
+    ApproxTransformLattice *poLattice;
 } ApproxTransformInfo;
 
 /************************************************************************/
@@ -3127,6 +3609,7 @@ GDALCreateSimilarApproxTransformer( void *hTransformArg,
         CPLMalloc(sizeof(ApproxTransformInfo)));
 
     memcpy(psClonedInfo, psInfo, sizeof(ApproxTransformInfo));
+    psClonedInfo->poLattice = nullptr;
     if( psClonedInfo->pBaseCBData )
     {
         psClonedInfo->pBaseCBData =
@@ -3141,6 +3624,18 @@ GDALCreateSimilarApproxTransformer( void *hTransformArg,
     }
     psClonedInfo->bOwnSubtransformer = TRUE;
 
+    if( psInfo->poLattice != nullptr )
+    {
+        // A clone shares the lattice of its original, so that the points
+        // transformed by one are reused by the other.  This is not possible
+        // if the source pixel size changes.
+        if( dfSrcRatioX == 1.0 && dfSrcRatioY == 1.0 )
+            psClonedInfo->poLattice = psInfo->poLattice->Reference();
+        else
+            GDALApproxTransformerSetGridStep(
+                psClonedInfo, psInfo->poLattice->GetStep() );
+    }
+
     return psClonedInfo;
 }
 
@@ -3174,6 +3669,12 @@ GDALSerializeApproxTransformer( void *pTransformArg )
                         CPLString().Printf("%g", psInfo->dfMaxErrorReverse) );
     }
 
+    if( psInfo->poLattice != nullptr )
+    {
+        CPLCreateXMLElementAndValue( psTree, "GridStep",
+                        CPLString().Printf("%g", psInfo->poLattice->GetStep()) );
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Capture underlying transformer.                                 */
 /* -------------------------------------------------------------------- */
@@ -3256,6 +3757,7 @@ void *GDALCreateApproxTransformer2( GDALTransformerFunc pfnBaseTransformer,
     psATInfo->dfMaxErrorForward = dfMaxErrorForward;
     psATInfo->dfMaxErrorReverse = dfMaxErrorReverse;
     psATInfo->bOwnSubtransformer = FALSE;
+    psATInfo->poLattice = nullptr;
 
     memcpy(psATInfo->sTI.abySignature,
            GDAL_GTI2_SIGNATURE,
@@ -3282,6 +3784,52 @@ void GDALApproxTransformerOwnsSubtransformer( void *pCBData, int bOwnFlag )
     psATInfo->bOwnSubtransformer = bOwnFlag;
 }
 
+/************************************************************************/
+/*                  GDALApproxTransformerSetGridStep()                  */
+/************************************************************************/
+
+/**
+ * Enable the lattice mode of an approximate transformer.
+ *
+ * In this mode, the points of a line of constant Y are not approximated by
+ * recursive bisection of the line.  Instead, points of a regular lattice
+ * with a spacing of dfGridStep in the input space of the transformer are
+ * transformed exactly once, and the transformation of any point is
+ * bilinearly interpolated from the 4 corners of the cell that contains it.
+ * A cell is only used if the interpolation at the middle of its edges and
+ * at its center is within the error threshold, otherwise the line
+ * approximation is used for the points of this cell.
+ *
+ * The lattice is kept for the lifetime of the transformer, and is shared
+ * with the transformers cloned from it, so repeated transformations of
+ * nearby lines (as done when warping by chunks, possibly from several
+ * threads) are much faster.  As the step is expressed in the units of the
+ * input coordinates, this mode is mostly suited to transformations between
+ * pixel/line coordinates, like the ones used by gdalwarp.  gdalwarp and
+ * GDALReprojectImage() enable it when the GDAL_APPROX_TRANSFORMER_GRID_STEP
+ * configuration option is set to a positive step (in target pixels).
+ *
+ * @param pCBData callback data originally returned by
+ * GDALCreateApproxTransformer().
+ * @param dfGridStep spacing of the lattice, or 0 to disable the lattice mode.
+ *
+ * @since GDAL 3.1
+ */
+
+void GDALApproxTransformerSetGridStep( void *pCBData, double dfGridStep )
+
+{
+    ApproxTransformInfo *psATInfo = static_cast<ApproxTransformInfo *>(pCBData);
+
+    if( psATInfo->poLattice != nullptr )
+    {
+        psATInfo->poLattice->Release();
+        psATInfo->poLattice = nullptr;
+    }
+    if( dfGridStep > 0.0 )
+        psATInfo->poLattice = new ApproxTransformLattice(dfGridStep);
+}
+
 /************************************************************************/
 /*                    GDALDestroyApproxTransformer()                    */
 /************************************************************************/
@@ -3306,6 +3854,9 @@ void GDALDestroyApproxTransformer( void * pCBData )
     if( psATInfo->bOwnSubtransformer )
         GDALDestroyTransformer( psATInfo->pBaseCBData );
 
+    if( psATInfo->poLattice != nullptr )
+        psATInfo->poLattice->Release();
+
     CPLFree( pCBData );
 }
 
@@ -3601,20 +4152,15 @@ static int GDALApproxTransformInternal( void *pCBData, int bDstToSrc,
 }
 
 /************************************************************************/
-/*                        GDALApproxTransform()                         */
+/*                      GDALApproxTransformLine()                       */
+/*                                                                      */
+/*      Approximate transformation of a line of points by recursive     */
+/*      bisection.                                                      */
 /************************************************************************/
 
-/**
- * Perform approximate transformation.
- *
- * Actually performs the approximate transformation described in
- * GDALCreateApproxTransformer().  This function matches the
- * GDALTransformerFunc() signature.  Details of the arguments are described
- * there.
- */
-
-int GDALApproxTransform( void *pCBData, int bDstToSrc, int nPoints,
-                         double *x, double *y, double *z, int *panSuccess )
+static int GDALApproxTransformLine( void *pCBData, int bDstToSrc, int nPoints,
+                                    double *x, double *y, double *z,
+                                    int *panSuccess )
 
 {
     ApproxTransformInfo *psATInfo = static_cast<ApproxTransformInfo *>(pCBData);
@@ -3680,6 +4226,166 @@ end:
     return bRet;
 }
 
+/************************************************************************/
+/*                     GDALApproxTransformLattice()                     */
+/*                                                                      */
+/*      Approximate transformation of a line of points of constant Y    */
+/*      by interpolation on the lattice.  Returns false if the points   */
+/*      are not suitable, in which case they are left untouched.        */
+/************************************************************************/
+
+static bool GDALApproxTransformLattice( ApproxTransformInfo *psATInfo,
+                                        int bDstToSrc, int nPoints,
+                                        double *x, double *y, double *z,
+                                        int *panSuccess, int *pbRet )
+
+{
+    ApproxTransformLattice *poLattice = psATInfo->poLattice;
+    const double dfInvStep = 1.0 / poLattice->GetStep();
+
+    double dfMinX = x[0];
+    double dfMaxX = x[0];
+    for( int i = 0; i < nPoints; i++ )
+    {
+        if( y[i] != y[0] || z[i] != 0.0 )
+            return false;
+        dfMinX = std::min(dfMinX, x[i]);
+        dfMaxX = std::max(dfMaxX, x[i]);
+    }
+
+    const double dfCellMin = floor(dfMinX * dfInvStep);
+    const double dfCellMax = floor(dfMaxX * dfInvStep);
+    const double dfCellY = floor(y[0] * dfInvStep);
+    const double dfLimit = INT_MAX / 2;
+    if( !(dfCellMin >= -dfLimit && dfCellMax <= dfLimit &&
+          dfCellY >= -dfLimit && dfCellY <= dfLimit) ||
+        // Not worth it if the points are sparser than the cells.
+        dfCellMax - dfCellMin >= nPoints )
+    {
+        return false;
+    }
+
+    const int nCellMin = static_cast<int>(dfCellMin);
+    const int nCellY = static_cast<int>(dfCellY);
+    std::vector<ApproxLatticeCellLine> asCells;
+    if( !poLattice->GetCellLine( psATInfo->pfnBaseTransformer,
+                                 psATInfo->pBaseCBData, bDstToSrc,
+                                 bDstToSrc ? psATInfo->dfMaxErrorReverse :
+                                             psATInfo->dfMaxErrorForward,
+                                 nCellY, y[0] * dfInvStep - dfCellY,
+                                 nCellMin, static_cast<int>(dfCellMax),
+                                 asCells ) )
+    {
+        return false;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Interpolate the runs of points that fall in the same valid      */
+/*      cell.  The runs of points in invalid cells go through the line  */
+/*      approximation.                                                  */
+/* -------------------------------------------------------------------- */
+    const auto cellOf = [dfInvStep, nCellMin](double dfX)
+        { return static_cast<int>(floor(dfX * dfInvStep)) - nCellMin; };
+
+    int bRet = TRUE;
+    int i = 0;
+    while( i < nPoints )
+    {
+        const int iCell = cellOf(x[i]);
+        const ApproxLatticeCellLine &sCell = asCells[iCell];
+        int iEnd = i + 1;
+        if( sCell.bValid )
+        {
+            while( iEnd < nPoints && cellOf(x[iEnd]) == iCell )
+                iEnd++;
+
+            const double dfOrigin = static_cast<double>(nCellMin + iCell);
+            int k = i;
+            const XMMReg2Double xmmInvStep =
+                XMMReg2Double::Load1ValHighAndLow(&dfInvStep);
+            const XMMReg2Double xmmOrigin =
+                XMMReg2Double::Load1ValHighAndLow(&dfOrigin);
+            const XMMReg2Double xmmAX =
+                XMMReg2Double::Load1ValHighAndLow(&sCell.dfAX);
+            const XMMReg2Double xmmDX =
+                XMMReg2Double::Load1ValHighAndLow(&sCell.dfDX);
+            const XMMReg2Double xmmAY =
+                XMMReg2Double::Load1ValHighAndLow(&sCell.dfAY);
+            const XMMReg2Double xmmDY =
+                XMMReg2Double::Load1ValHighAndLow(&sCell.dfDY);
+            const XMMReg2Double xmmAZ =
+                XMMReg2Double::Load1ValHighAndLow(&sCell.dfAZ);
+            const XMMReg2Double xmmDZ =
+                XMMReg2Double::Load1ValHighAndLow(&sCell.dfDZ);
+            for( ; k + 1 < iEnd; k += 2 )
+            {
+                const XMMReg2Double xmmU =
+                    XMMReg2Double::Load2Val(x + k) * xmmInvStep - xmmOrigin;
+                (xmmAX + xmmU * xmmDX).Store2Val(x + k);
+                (xmmAY + xmmU * xmmDY).Store2Val(y + k);
+                (xmmAZ + xmmU * xmmDZ).Store2Val(z + k);
+                panSuccess[k] = TRUE;
+                panSuccess[k + 1] = TRUE;
+            }
+            for( ; k < iEnd; k++ )
+            {
+                const double dfU = x[k] * dfInvStep - dfOrigin;
+                x[k] = sCell.dfAX + dfU * sCell.dfDX;
+                y[k] = sCell.dfAY + dfU * sCell.dfDY;
+                z[k] = sCell.dfAZ + dfU * sCell.dfDZ;
+                panSuccess[k] = TRUE;
+            }
+        }
+        else
+        {
+            while( iEnd < nPoints && !asCells[cellOf(x[iEnd])].bValid )
+                iEnd++;
+
+            if( !GDALApproxTransformLine( psATInfo, bDstToSrc, iEnd - i,
+                                          x + i, y + i, z + i,
+                                          panSuccess + i ) )
+                bRet = FALSE;
+        }
+        i = iEnd;
+    }
+
+    *pbRet = bRet;
+    return true;
+}
+
+/************************************************************************/
+/*                        GDALApproxTransform()                         */
+/************************************************************************/
+
+/**
+ * Perform approximate transformation.
+ *
+ * Actually performs the approximate transformation described in
+ * GDALCreateApproxTransformer().  This function matches the
+ * GDALTransformerFunc() signature.  Details of the arguments are described
+ * there.
+ */
+
+int GDALApproxTransform( void *pCBData, int bDstToSrc, int nPoints,
+                         double *x, double *y, double *z, int *panSuccess )
+
+{
+    ApproxTransformInfo *psATInfo = static_cast<ApproxTransformInfo *>(pCBData);
+
+    if( psATInfo->poLattice != nullptr && nPoints > 5 &&
+        (psATInfo->dfMaxErrorForward != 0.0 ||
+         psATInfo->dfMaxErrorReverse != 0.0) )
+    {
+        int bRet = FALSE;
+        if( GDALApproxTransformLattice( psATInfo, bDstToSrc, nPoints,
+                                        x, y, z, panSuccess, &bRet ) )
+            return bRet;
+    }
+
+    return GDALApproxTransformLine( pCBData, bDstToSrc, nPoints,
+                                    x, y, z, panSuccess );
+}
+
 /************************************************************************/
 /*                  GDALDeserializeApproxTransformer()                  */
 /************************************************************************/
@@ -3734,6 +4440,13 @@ GDALDeserializeApproxTransformer( CPLXMLNode *psTree )
                                                         dfMaxErrorReverse );
     GDALApproxTransformerOwnsSubtransformer( pApproxCBData, TRUE );
 
+    const char* pszGridStep = CPLGetXMLValue( psTree, "GridStep", nullptr);
+    if( pszGridStep != nullptr )
+    {
+        GDALApproxTransformerSetGridStep( pApproxCBData,
+                                          CPLAtof(pszGridStep) );
+    }
+
     return pApproxCBData;
 }
 
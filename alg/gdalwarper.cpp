@@ -132,6 +132,10 @@ GDALReprojectImage( GDALDatasetH hSrcDS, const char *pszSrcWKT,
         psWOptions->pTransformerArg =
             GDALCreateApproxTransformer( GDALGenImgProjTransform,
                                          hTransformArg, dfMaxError );
+        GDALApproxTransformerSetGridStep(
+            psWOptions->pTransformerArg,
+            CPLAtof(CPLGetConfigOption("GDAL_APPROX_TRANSFORMER_GRID_STEP",
+                                       "0")) );
 
         psWOptions->pfnTransformer = GDALApproxTransform;
     }
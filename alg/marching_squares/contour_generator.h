@@ -71,6 +71,18 @@ public:
         }
         return CE_None;
     }
+
+    // Start the generation at line lineIdx instead of the first line.
+    // previousLine holds the values of line lineIdx - 1 (nullptr if lineIdx is 0).
+    // This allows horizontal stripes of a raster to be processed independently.
+    void setStartLine( size_t lineIdx, const double* previousLine )
+    {
+        lineIdx_ = lineIdx;
+        if ( previousLine != nullptr )
+            std::copy( previousLine, previousLine + width_, previousLine_.begin() );
+        else
+            std::fill( previousLine_.begin(), previousLine_.end(), NaN );
+    }
 private:
     size_t width_;
     size_t height_;
@@ -0,0 +1,236 @@
+/******************************************************************************
+ *
+ * Project:  Marching square algorithm
+ * Purpose:  Merge of contour lines generated on horizontal stripes
+ *
+ ******************************************************************************
+ * Copyright (c) 2020, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+#ifndef MARCHING_SQUARES_STRIPE_MERGER_H
+#define MARCHING_SQUARES_STRIPE_MERGER_H
+
+#include "point.h"
+
+#include <list>
+#include <map>
+#include <tuple>
+#include <vector>
+
+namespace marching_squares {
+
+// A (possibly partial) contour line generated on a horizontal stripe
+struct StripeLine
+{
+    double level = 0.0;
+    LineString ls = LineString();
+    bool closed = false;
+};
+
+// LineWriter that stores the lines of a stripe so that they can be
+// merged and written afterwards, possibly from another thread
+struct StripeLineCollector
+{
+    explicit StripeLineCollector( std::vector<StripeLine>& lines )
+        : lines_( lines )
+    {}
+
+    void addLine( double level, LineString& ls, bool closed )
+    {
+        lines_.push_back( StripeLine() );
+        lines_.back().level = level;
+        lines_.back().ls.swap( ls );
+        lines_.back().closed = closed;
+    }
+
+    StripeLineCollector( const StripeLineCollector& ) = delete;
+    StripeLineCollector& operator=( const StripeLineCollector& ) = delete;
+
+private:
+    std::vector<StripeLine>& lines_;
+};
+
+// StripeMerger: join lines that have been cut at the boundary between two
+// stripes and forward them to a LineWriter.
+// Stripes must be added from top to bottom. Lines that have an end on the
+// bottom boundary of the last added stripe are kept until the next stripe
+// is added, all other ones are written as soon as they are complete.
+// flush() writes the kept lines; lines still kept on destruction (after an
+// error) are discarded, as writing them may throw.
+template <typename LineWriter>
+class StripeMerger
+{
+public:
+    explicit StripeMerger( LineWriter& lineWriter )
+        : lineWriter_( lineWriter )
+    {}
+
+    // Write the lines kept for the next stripe, if any.
+    void flush()
+    {
+        for ( auto& line : pending_ )
+        {
+            lineWriter_.addLine( line.level, line.ls, /* closed */ false );
+        }
+        pending_.clear();
+        index_.clear();
+    }
+
+    // bottomY is the ordinate of the boundary with the next stripe.
+    void addStripe( std::vector<StripeLine>& lines, double bottomY, bool lastStripe )
+    {
+        // Lines that have an end on the boundary with the previous stripe.
+        // Lines of this stripe may be appended to them.
+        Pending previous;
+        previous.swap( pending_ );
+        Index previousIndex;
+        previousIndex.swap( index_ );
+
+        for ( auto& line : lines )
+        {
+            if ( line.closed )
+            {
+                lineWriter_.addLine( line.level, line.ls, /* closed */ true );
+                continue;
+            }
+
+            join_( previous, previousIndex, line.level, line.ls );
+
+            if ( line.ls.front() == line.ls.back() )
+            {
+                lineWriter_.addLine( line.level, line.ls, /* closed */ true );
+            }
+            else if ( isOnBoundary_( line.ls, topY_ ) )
+            {
+                addPending_( previous, previousIndex, line.level, line.ls );
+            }
+            else if ( !lastStripe && isOnBoundary_( line.ls, bottomY ) )
+            {
+                addPending_( pending_, index_, line.level, line.ls );
+            }
+            else
+            {
+                lineWriter_.addLine( line.level, line.ls, /* closed */ false );
+            }
+        }
+        lines.clear();
+
+        // Lines that cannot be joined any more, unless they continue
+        // in the next stripe.
+        for ( auto& line : previous )
+        {
+            if ( !lastStripe && isOnBoundary_( line.ls, bottomY ) )
+                addPending_( pending_, index_, line.level, line.ls );
+            else
+                lineWriter_.addLine( line.level, line.ls, /* closed */ false );
+        }
+        topY_ = bottomY;
+    }
+
+    // non copyable
+    StripeMerger( const StripeMerger<LineWriter>& ) = delete;
+    StripeMerger<LineWriter>& operator=( const StripeMerger<LineWriter>& ) = delete;
+
+private:
+    typedef std::list<StripeLine> Pending;
+    // (level, x, y) of line ends -> pending line
+    typedef std::tuple<double, double, double> EndKey;
+    typedef std::multimap<EndKey, typename Pending::iterator> Index;
+
+    LineWriter &lineWriter_;
+    Pending pending_ = Pending();
+    Index index_ = Index();
+    double topY_ = NaN;
+
+    static bool isOnBoundary_( const LineString& ls, double y )
+    {
+        return ls.front().y == y || ls.back().y == y;
+    }
+
+    static EndKey key_( double level, const Point& p )
+    {
+        return EndKey( level, p.x, p.y );
+    }
+
+    static void addPending_( Pending& pending, Index& index, double level, LineString& ls )
+    {
+        pending.push_back( StripeLine() );
+        auto it = pending.end();
+        --it;
+        it->level = level;
+        it->ls.swap( ls );
+        index.insert( std::make_pair( key_( level, it->ls.front() ), it ) );
+        index.insert( std::make_pair( key_( level, it->ls.back() ), it ) );
+    }
+
+    static void unindex_( Index& index, typename Pending::iterator it, const Point& p )
+    {
+        auto range = index.equal_range( key_( it->level, p ) );
+        for ( auto idxIt = range.first; idxIt != range.second; ++idxIt )
+        {
+            if ( idxIt->second == it )
+            {
+                index.erase( idxIt );
+                return;
+            }
+        }
+    }
+
+    // Append to ls all the pending lines that share one of its ends
+    static void join_( Pending& pending, Index& index, double level, LineString& ls )
+    {
+        while ( !( ls.front() == ls.back() ) )
+        {
+            auto idxIt = index.find( key_( level, ls.back() ) );
+            bool atBack = true;
+            if ( idxIt == index.end() )
+            {
+                idxIt = index.find( key_( level, ls.front() ) );
+                atBack = false;
+            }
+            if ( idxIt == index.end() )
+                break;
+
+            auto other = idxIt->second;
+            unindex_( index, other, other->ls.front() );
+            unindex_( index, other, other->ls.back() );
+
+            LineString& ols = other->ls;
+            if ( atBack )
+            {
+                if ( !( ols.front() == ls.back() ) )
+                    ols.reverse();
+                ols.pop_front();
+                ls.splice( ls.end(), ols );
+            }
+            else
+            {
+                if ( !( ols.back() == ls.front() ) )
+                    ols.reverse();
+                ols.pop_back();
+                ls.splice( ls.begin(), ols );
+            }
+            pending.erase( other );
+        }
+    }
+};
+
+}
+#endif
@@ -33,11 +33,15 @@
 #include <array>
 #include <limits>
 #include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
 #include "cpl_progress.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal.h"
 #include "gdal_priv.h"
 #include "gdal_priv_templates.hpp"
@@ -50,15 +54,15 @@ CPL_CVSID("$Id: viewshed.cpp 60d13e19f89619ca16040b9a270d3837b8f0df63 2020-03-05
 
 
 inline static void SetVisibility(int iPixel, double dfZ, double dfZTarget, double* padfZVal,
-    std::vector<GByte>& vResult, GByte byVisibleVal, GByte byInvisibleVal)
+    GByte* pabyResult, GByte byVisibleVal, GByte byInvisibleVal)
 {
     if (padfZVal[iPixel] + dfZTarget < dfZ)
     {
         padfZVal[iPixel] = dfZ;
-        vResult[iPixel] = byInvisibleVal;
+        pabyResult[iPixel] = byInvisibleVal;
     }
     else
-        vResult[iPixel] = byVisibleVal;
+        pabyResult[iPixel] = byVisibleVal;
 }
 
 inline static bool AdjustHeightInRange(const double* adfGeoTransform, int iPixel, int iLine, double& dfHeight, double dfDistance2, double dfCurvCoeff, double dfSphereDiameter)
@@ -113,6 +117,706 @@ inline static double CalcHeight(double dfZ, double dfZ2, GDALViewshedMode eMode)
         return dfZ;
 }
 
+namespace {
+
+/************************************************************************/
+/*                           ViewshedParams                             */
+/************************************************************************/
+
+// Parameters of the viewshed computation for one observer.
+// Columns are relative to nXStart, lines are absolute.
+struct ViewshedParams
+{
+    std::array<double, 6> adfGeoTransform {{0.0, 1.0, 0.0, 0.0, 0.0, 1.0}};
+    int nX = 0;
+    int nY = 0;
+    int nXStart = 0;
+    int nXSize = 0;
+    int nYStart = 0;
+    int nYStop = 0;
+    double dfObserverHeight = 0.0;
+    double dfZObserver = 0.0;
+    double dfTargetHeight = 0.0;
+    double dfDistance2 = 0.0;
+    double dfCurvCoeff = 0.0;
+    double dfSphereDiameter = std::numeric_limits<double>::infinity();
+    GDALViewshedMode eMode = GVM_Edge;
+    GDALViewshedOutputType heightMode = GVOT_NORMAL;
+    GByte byVisibleVal = 255;
+    GByte byInvisibleVal = 0;
+    GByte byOutOfRangeVal = 0;
+    double dfOutOfRangeVal = 0.0;
+};
+
+/************************************************************************/
+/*                        ViewshedSetupWindow()                         */
+/************************************************************************/
+
+// Compute the observer position and the area of interest.
+static bool ViewshedSetupWindow(ViewshedParams& p, double* adfInvGeoTransform,
+                                double dfObserverX, double dfObserverY,
+                                double dfMaxDistance, int nRasterXSize, int nRasterYSize)
+{
+    double dfX, dfY;
+    GDALApplyGeoTransform(adfInvGeoTransform, dfObserverX, dfObserverY, &dfX, &dfY);
+    const int nX = static_cast<int>(std::round(dfX));
+    const int nY = static_cast<int>(std::round(dfY));
+
+    if (nX < 0 ||
+        nX >= nRasterXSize ||
+        nY < 0 ||
+        nY >= nRasterYSize)
+    {
+        return false;
+    }
+
+    /* calculate the area of interest */
+    const int nXStart = dfMaxDistance > 0? (std::max)(0, static_cast<int>(std::floor(nX - adfInvGeoTransform[1] * dfMaxDistance))) : 0;
+    const int nXStop = dfMaxDistance > 0? (std::min)(nRasterXSize, static_cast<int>(std::ceil(nX + adfInvGeoTransform[1] * dfMaxDistance) + 1)) : nRasterXSize;
+    const int nYStart = dfMaxDistance > 0? (std::max)(0, static_cast<int>(std::floor(nY + adfInvGeoTransform[5] * dfMaxDistance))) : 0;
+    const int nYStop = dfMaxDistance > 0? (std::min)(nRasterYSize, static_cast<int>(std::ceil(nY - adfInvGeoTransform[5] * dfMaxDistance) + 1)) : nRasterYSize;
+
+    /* normalize horizontal index (0 - nXSize) */
+    p.nX = nX - nXStart;
+    p.nY = nY;
+    p.nXStart = nXStart;
+    p.nXSize = nXStop - nXStart;
+    p.nYStart = nYStart;
+    p.nYStop = nYStop;
+    p.dfDistance2 = dfMaxDistance * dfMaxDistance;
+    return true;
+}
+
+/************************************************************************/
+/*                         ViewshedGetSphereDiameter()                  */
+/************************************************************************/
+
+/* If we can't get a SemiMajor axis from the SRS, it will be
+ * SRS_WGS84_SEMIMAJOR
+*/
+static double ViewshedGetSphereDiameter(const OGRSpatialReference* poSRS)
+{
+    double dfSphereDiameter(std::numeric_limits<double>::infinity());
+    if (poSRS)
+    {
+        OGRErr eSRSerr;
+        double dfSemiMajor = poSRS->GetSemiMajor(&eSRSerr);
+
+        /* If we fetched the axis from the SRS, use it */
+        if (eSRSerr != OGRERR_FAILURE)
+            dfSphereDiameter = dfSemiMajor * 2.0;
+        else
+            CPLDebug( "GDALViewshedGenerate", "Unable to fetch SemiMajor axis from spatial reference");
+    }
+    return dfSphereDiameter;
+}
+
+/************************************************************************/
+/*                          ProcessObserverLine()                       */
+/************************************************************************/
+
+// Compute the visibility of the line of the observer.
+static void ProcessObserverLine(const ViewshedParams& p, double* padfLineVal,
+                                GByte* pabyResult, double* padfHeightResult)
+{
+    const int nX = p.nX;
+    const bool bHeight = p.heightMode != GVOT_NORMAL;
+
+    /* mark the observer point as visible */
+    double dfGroundLevel = p.heightMode == GVOT_MIN_TARGET_HEIGHT_FROM_DEM ? padfLineVal[nX] : 0.0;
+    pabyResult[nX] = p.byVisibleVal;
+    if(bHeight)
+        padfHeightResult[nX] = dfGroundLevel;
+
+    for (int nDir = -1; nDir <= 1; nDir += 2)
+    {
+        const int iNeighbour = nX + nDir;
+        if (iNeighbour < 0 || iNeighbour >= p.nXSize)
+            continue;
+
+        dfGroundLevel = p.heightMode == GVOT_MIN_TARGET_HEIGHT_FROM_DEM ? padfLineVal[iNeighbour] : 0.0;
+        CPL_IGNORE_RET_VAL(
+            AdjustHeightInRange(p.adfGeoTransform.data(),
+                            1,
+                            0,
+                            padfLineVal[iNeighbour],
+                            p.dfDistance2,
+                            p.dfCurvCoeff,
+                            p.dfSphereDiameter));
+        pabyResult[iNeighbour] = p.byVisibleVal;
+        if(bHeight)
+            padfHeightResult[iNeighbour] = dfGroundLevel;
+    }
+
+    for (int nDir = -1; nDir <= 1; nDir += 2)
+    {
+        for (int iPixel = nX + 2 * nDir; iPixel >= 0 && iPixel < p.nXSize; iPixel += nDir)
+        {
+            dfGroundLevel = p.heightMode == GVOT_MIN_TARGET_HEIGHT_FROM_DEM ? padfLineVal[iPixel] : 0.0;
+            const int nDX = std::abs(iPixel - nX);
+            bool adjusted = AdjustHeightInRange(p.adfGeoTransform.data(),
+                                                nDX,
+                                                0,
+                                                padfLineVal[iPixel],
+                                                p.dfDistance2,
+                                                p.dfCurvCoeff,
+                                                p.dfSphereDiameter);
+            if (adjusted)
+            {
+                const double dfZ = CalcHeightLine(nDX,
+                                                  padfLineVal[iPixel - nDir],
+                                                  p.dfZObserver);
+
+                if(bHeight)
+                    padfHeightResult[iPixel] = std::max(0.0, (dfZ - padfLineVal[iPixel] + dfGroundLevel));
+
+                SetVisibility(iPixel,
+                              dfZ,
+                              p.dfTargetHeight,
+                              padfLineVal,
+                              pabyResult,
+                              p.byVisibleVal,
+                              p.byInvisibleVal);
+            }
+            else
+            {
+                for (; iPixel >= 0 && iPixel < p.nXSize; iPixel += nDir)
+                {
+                    pabyResult[iPixel] = p.byOutOfRangeVal;
+                    if(bHeight)
+                        padfHeightResult[iPixel] = p.dfOutOfRangeVal;
+                }
+            }
+        }
+    }
+}
+
+/************************************************************************/
+/*                           ProcessLineCenter()                        */
+/************************************************************************/
+
+// Compute the visibility of the pixel of the observer column, on a line at
+// nDY lines from the observer.
+static void ProcessLineCenter(const ViewshedParams& p, int nDY,
+                              double* padfThisLineVal, const double* padfLastLineVal,
+                              GByte* pabyResult, double* padfHeightResult)
+{
+    const int nX = p.nX;
+    const double dfGroundLevel = p.heightMode == GVOT_MIN_TARGET_HEIGHT_FROM_DEM ? padfThisLineVal[nX] : 0.0;
+    bool adjusted = AdjustHeightInRange(p.adfGeoTransform.data(),
+                                        0,
+                                        nDY,
+                                        padfThisLineVal[nX],
+                                        p.dfDistance2,
+                                        p.dfCurvCoeff,
+                                        p.dfSphereDiameter);
+    if (adjusted)
+    {
+        const double dfZ = CalcHeightLine(nDY,
+                                          padfLastLineVal[nX],
+                                          p.dfZObserver);
+
+        if(p.heightMode != GVOT_NORMAL)
+            padfHeightResult[nX] = std::max(0.0, (dfZ - padfThisLineVal[nX] + dfGroundLevel));
+
+        SetVisibility(nX,
+                      dfZ,
+                      p.dfTargetHeight,
+                      padfThisLineVal,
+                      pabyResult,
+                      p.byVisibleVal,
+                      p.byInvisibleVal);
+    }
+    else
+    {
+        pabyResult[nX] = p.byOutOfRangeVal;
+        if(p.heightMode != GVOT_NORMAL)
+            padfHeightResult[nX] = p.dfOutOfRangeVal;
+    }
+}
+
+/************************************************************************/
+/*                            ProcessLineHalf()                         */
+/************************************************************************/
+
+// Compute the visibility of the pixels on one side (nDir = -1 for left,
+// 1 for right) of the observer column, on a line at nDY lines from the
+// observer. The observer column must have been processed.
+static void ProcessLineHalf(const ViewshedParams& p, int nDY, int nDir,
+                            double* padfThisLineVal, const double* padfLastLineVal,
+                            GByte* pabyResult, double* padfHeightResult)
+{
+    const int nX = p.nX;
+    const bool bHeight = p.heightMode != GVOT_NORMAL;
+    double dfZ = 0.0;
+
+    for (int iPixel = nX + nDir; iPixel >= 0 && iPixel < p.nXSize; iPixel += nDir)
+    {
+        const double dfGroundLevel = p.heightMode == GVOT_MIN_TARGET_HEIGHT_FROM_DEM ? padfThisLineVal[iPixel] : 0.0;
+        const int nDX = std::abs(iPixel - nX);
+        // Previous pixel, on the side of the observer
+        const int iPrev = iPixel - nDir;
+        bool adjusted = AdjustHeightInRange(p.adfGeoTransform.data(),
+                                            nDX,
+                                            nDY,
+                                            padfThisLineVal[iPixel],
+                                            p.dfDistance2,
+                                            p.dfCurvCoeff,
+                                            p.dfSphereDiameter);
+        if (adjusted)
+        {
+            if (p.eMode != GVM_Edge)
+                dfZ = CalcHeightDiagonal(nDX,
+                                         nDY,
+                                         padfThisLineVal[iPrev],
+                                         padfLastLineVal[iPixel],
+                                         p.dfZObserver);
+
+            if (p.eMode != GVM_Diagonal)
+            {
+                double dfZ2 = nDX >= nDY ?
+                    CalcHeightEdge(nDY,
+                                   nDX,
+                                   padfLastLineVal[iPrev],
+                                   padfThisLineVal[iPrev],
+                                   p.dfZObserver) :
+                    CalcHeightEdge(nDX,
+                                   nDY,
+                                   padfLastLineVal[iPrev],
+                                   padfLastLineVal[iPixel],
+                                   p.dfZObserver);
+                dfZ = CalcHeight(dfZ, dfZ2, p.eMode);
+            }
+
+            if(bHeight)
+                padfHeightResult[iPixel] = std::max(0.0, (dfZ - padfThisLineVal[iPixel] + dfGroundLevel));
+
+            SetVisibility(iPixel,
+                          dfZ,
+                          p.dfTargetHeight,
+                          padfThisLineVal,
+                          pabyResult,
+                          p.byVisibleVal,
+                          p.byInvisibleVal);
+        }
+        else
+        {
+            for (; iPixel >= 0 && iPixel < p.nXSize; iPixel += nDir)
+            {
+                pabyResult[iPixel] = p.byOutOfRangeVal;
+                if(bHeight)
+                    padfHeightResult[iPixel] = p.dfOutOfRangeVal;
+            }
+        }
+    }
+}
+
+/************************************************************************/
+/*                              ViewshedIO                              */
+/************************************************************************/
+
+// Reads the DEM and writes the result, so that several sweeps can run
+// concurrently on the same datasets. The source and target bands have their
+// own mutex, held during each RasterIO() call only. In cumulative mode, the
+// read-add-write of a target line is made atomic by a lock on its block row,
+// so that sweeps working on different block rows do not wait for each other.
+class ViewshedIO
+{
+    CPL_DISALLOW_COPY_ASSIGN(ViewshedIO)
+
+    // Number of locks the block rows of the target are distributed on.
+    static constexpr int knRowLocks = 64;
+
+    GDALRasterBandH hSrcBand_;
+    GDALRasterBandH hDstBand_;
+    // Position of the target raster in the source raster
+    int nDstXOrigin_;
+    int nDstYOrigin_;
+    // In cumulative mode, results are added to the target raster.
+    bool bCumulative_;
+    int nDstBlockYSize_ = 1;
+    std::mutex srcMutex_{};
+    std::mutex dstMutex_{};
+    std::vector<std::mutex> rowMutexes_;
+
+    CPLErr DstRasterIO(GDALRWFlag eRWFlag, int nXOff, int nLine, int nCount,
+                       void* pData, GDALDataType eType)
+    {
+        std::lock_guard<std::mutex> oLock(dstMutex_);
+        return GDALRasterIO(hDstBand_, eRWFlag, nXOff, nLine, nCount, 1,
+                            pData, nCount, 1, eType, 0, 0);
+    }
+
+public:
+    ViewshedIO(GDALRasterBandH hSrcBand, GDALRasterBandH hDstBand,
+               int nDstXOrigin, int nDstYOrigin, bool bCumulative)
+        : hSrcBand_(hSrcBand), hDstBand_(hDstBand),
+          nDstXOrigin_(nDstXOrigin), nDstYOrigin_(nDstYOrigin),
+          bCumulative_(bCumulative),
+          rowMutexes_(bCumulative ? knRowLocks : 0)
+    {
+        int nBlockXSize = 0;
+        GDALGetBlockSize(hDstBand, &nBlockXSize, &nDstBlockYSize_);
+        nDstBlockYSize_ = std::max(1, nDstBlockYSize_);
+    }
+
+    bool ReadLine(int nXOff, int nLine, int nCount, double* padfVal)
+    {
+        CPLErr eErr;
+        {
+            std::lock_guard<std::mutex> oLock(srcMutex_);
+            eErr = GDALRasterIO(hSrcBand_, GF_Read, nXOff, nLine, nCount, 1,
+                                padfVal, nCount, 1, GDT_Float64, 0, 0);
+        }
+        if (eErr != CE_None)
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                "RasterIO error when reading DEM at position (%d,%d), size (%d,%d)", nXOff, nLine, nCount, 1);
+            return false;
+        }
+        return true;
+    }
+
+    bool WriteLine(int nXOff, int nLine, int nCount,
+                   const GByte* pabyResult, const double* padfHeightResult)
+    {
+        const int nDstXOff = nXOff - nDstXOrigin_;
+        const int nDstLine = nLine - nDstYOrigin_;
+        CPLErr eErr = CE_None;
+        if (bCumulative_)
+        {
+            std::vector<GUInt32> anCount;
+            try
+            {
+                anCount.resize(nCount);
+            } catch (...)
+            {
+                CPLError(CE_Failure, CPLE_AppDefined,
+                         "Cannot allocate vectors for viewshed");
+                return false;
+            }
+            std::lock_guard<std::mutex> oRowLock(
+                rowMutexes_[(nDstLine / nDstBlockYSize_) % knRowLocks]);
+            eErr = DstRasterIO(GF_Read, nDstXOff, nDstLine, nCount,
+                               anCount.data(), GDT_UInt32);
+            if (eErr == CE_None)
+            {
+                for (int i = 0; i < nCount; i++)
+                    anCount[i] += pabyResult[i];
+                eErr = DstRasterIO(GF_Write, nDstXOff, nDstLine, nCount,
+                                   anCount.data(), GDT_UInt32);
+            }
+        }
+        else if (padfHeightResult)
+        {
+            eErr = DstRasterIO(GF_Write, nDstXOff, nDstLine, nCount,
+                               const_cast<double*>(padfHeightResult), GDT_Float64);
+        }
+        else
+        {
+            eErr = DstRasterIO(GF_Write, nDstXOff, nDstLine, nCount,
+                               const_cast<GByte*>(pabyResult), GDT_Byte);
+        }
+        if (eErr != CE_None)
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                "RasterIO error when writing target raster at position (%d,%d), size (%d,%d)", nDstXOff, nDstLine, nCount, 1);
+            return false;
+        }
+        return true;
+    }
+};
+
+/************************************************************************/
+/*                           ViewshedProgress                           */
+/************************************************************************/
+
+// Progress of sweeps that may run in worker threads. The progress callback
+// is only invoked from the calling thread.
+class ViewshedProgress
+{
+    CPL_DISALLOW_COPY_ASSIGN(ViewshedProgress)
+
+    GDALProgressFunc pfnProgress_;
+    void* pProgressArg_;
+    double dfTotal_;
+    double dfDone_ = 0.0;
+    bool bThreaded_ = false;
+    int nRunningJobs_ = 0;
+    bool bStop_ = false;
+    std::mutex mutex_{};
+    std::condition_variable cv_{};
+
+public:
+    ViewshedProgress(GDALProgressFunc pfnProgress, void* pProgressArg, double dfTotal)
+        : pfnProgress_(pfnProgress), pProgressArg_(pProgressArg),
+          dfTotal_(dfTotal > 0 ? dfTotal : 1.0)
+    {}
+
+    // Must be called before jobs are submitted to worker threads.
+    void SetRunningJobs(int nJobs)
+    {
+        bThreaded_ = true;
+        nRunningJobs_ = nJobs;
+    }
+
+    // Report that a line has been processed. Returns false if processing
+    // must stop.
+    bool Advance(double dfIncrement = 1.0)
+    {
+        if (!bThreaded_)
+        {
+            dfDone_ += dfIncrement;
+            if (!pfnProgress_(std::min(1.0, dfDone_ / dfTotal_), "", pProgressArg_))
+            {
+                CPLError(CE_Failure, CPLE_UserInterrupt, "User terminated");
+                bStop_ = true;
+            }
+            return !bStop_;
+        }
+        std::lock_guard<std::mutex> oLock(mutex_);
+        dfDone_ += dfIncrement;
+        cv_.notify_all();
+        return !bStop_;
+    }
+
+    void Fail()
+    {
+        std::lock_guard<std::mutex> oLock(mutex_);
+        bStop_ = true;
+        cv_.notify_all();
+    }
+
+    void JobDone()
+    {
+        std::lock_guard<std::mutex> oLock(mutex_);
+        nRunningJobs_--;
+        cv_.notify_all();
+    }
+
+    // Called from the calling thread to wait for the completion of the jobs
+    // while reporting progress. Returns false on failure or interruption.
+    bool WaitJobs()
+    {
+        std::unique_lock<std::mutex> oLock(mutex_);
+        while (nRunningJobs_ > 0)
+        {
+            cv_.wait(oLock);
+            if (!bStop_)
+            {
+                const double dfDone = dfDone_;
+                oLock.unlock();
+                const bool bContinue =
+                    pfnProgress_(std::min(1.0, dfDone / dfTotal_), "", pProgressArg_) != FALSE;
+                oLock.lock();
+                if (!bContinue)
+                {
+                    CPLError(CE_Failure, CPLE_UserInterrupt, "User terminated");
+                    bStop_ = true;
+                }
+            }
+        }
+        return !bStop_;
+    }
+
+    bool IsStopped()
+    {
+        std::lock_guard<std::mutex> oLock(mutex_);
+        return bStop_;
+    }
+};
+
+/************************************************************************/
+/*                              SweepLines()                            */
+/************************************************************************/
+
+// Process the lines above (nDirY = -1) or below (nDirY = 1) the observer
+// line, in the columns left (nDirX = -1), right (nDirX = 1) or on both
+// sides (nDirX = 0) of the observer. Sweeps in different directions are
+// independent and may run concurrently.
+static bool SweepLines(const ViewshedParams& p, ViewshedIO& oIO,
+                       ViewshedProgress& oProgress, int nDirY, int nDirX,
+                       const double* padfObserverLineVal)
+{
+    const int nColMin = nDirX > 0 ? p.nX : 0;
+    const int nColMax = nDirX < 0 ? p.nX : p.nXSize - 1;
+    // The observer column is written by the left sweep
+    const int nWriteMin = nDirX > 0 ? p.nX + 1 : 0;
+    const bool bHeight = p.heightMode != GVOT_NORMAL;
+
+    std::vector<double> vLastLineVal;
+    std::vector<double> vThisLineVal;
+    std::vector<GByte> vResult;
+    std::vector<double> vHeightResult;
+    try
+    {
+        vLastLineVal.assign(padfObserverLineVal, padfObserverLineVal + p.nXSize);
+        vThisLineVal.resize(p.nXSize);
+        vResult.resize(p.nXSize);
+        if (bHeight)
+            vHeightResult.resize(p.nXSize);
+    } catch (...)
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "Cannot allocate vectors for viewshed");
+        oProgress.Fail();
+        return false;
+    }
+
+    double *padfLastLineVal = vLastLineVal.data();
+    double *padfThisLineVal = vThisLineVal.data();
+    GByte *pabyResult = vResult.data();
+    double *padfHeightResult = bHeight ? vHeightResult.data() : nullptr;
+
+    for (int iLine = p.nY + nDirY;
+         nDirY < 0 ? iLine >= p.nYStart : iLine < p.nYStop;
+         iLine += nDirY)
+    {
+        if (!oIO.ReadLine(p.nXStart + nColMin, iLine, nColMax - nColMin + 1,
+                          padfThisLineVal + nColMin))
+        {
+            oProgress.Fail();
+            return false;
+        }
+
+        const int nDY = std::abs(iLine - p.nY);
+        ProcessLineCenter(p, nDY, padfThisLineVal, padfLastLineVal,
+                          pabyResult, padfHeightResult);
+        if (nDirX <= 0)
+            ProcessLineHalf(p, nDY, -1, padfThisLineVal, padfLastLineVal,
+                            pabyResult, padfHeightResult);
+        if (nDirX >= 0)
+            ProcessLineHalf(p, nDY, 1, padfThisLineVal, padfLastLineVal,
+                            pabyResult, padfHeightResult);
+
+        /* write result line */
+        if (nWriteMin <= nColMax &&
+            !oIO.WriteLine(p.nXStart + nWriteMin, iLine, nColMax - nWriteMin + 1,
+                           pabyResult + nWriteMin,
+                           padfHeightResult ? padfHeightResult + nWriteMin : nullptr))
+        {
+            oProgress.Fail();
+            return false;
+        }
+
+        std::swap(padfLastLineVal, padfThisLineVal);
+
+        // Lines are shared by the sweeps of the left and right quadrants
+        if (!oProgress.Advance(nDirX == 0 ? 1.0 : 0.5))
+            return false;
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                            ViewshedSweepJob                          */
+/************************************************************************/
+
+struct ViewshedSweepJob
+{
+    const ViewshedParams* psParams = nullptr;
+    ViewshedIO* poIO = nullptr;
+    ViewshedProgress* poProgress = nullptr;
+    int nDirY = 0;
+    int nDirX = 0;
+    const double* padfObserverLineVal = nullptr;
+};
+
+static void ViewshedSweepJobFunc(void* pData)
+{
+    ViewshedSweepJob* psJob = static_cast<ViewshedSweepJob*>(pData);
+    SweepLines(*psJob->psParams, *psJob->poIO, *psJob->poProgress,
+               psJob->nDirY, psJob->nDirX, psJob->padfObserverLineVal);
+    psJob->poProgress->JobDone();
+}
+
+/************************************************************************/
+/*                        ViewshedGetThreadCount()                      */
+/************************************************************************/
+
+// NUM_THREADS option, or GDAL_NUM_THREADS configuration option: a number of
+// threads or ALL_CPUS.
+static int ViewshedGetThreadCount(CSLConstList papszOptions)
+{
+    return CPLGetNumThreadsOption(
+        CSLFetchNameValue(papszOptions, "NUM_THREADS"), "1");
+}
+
+/************************************************************************/
+/*                          ViewshedProcess()                           */
+/************************************************************************/
+
+// The quadrants around an observer are the units of parallelism of the
+// computation of a single viewshed: lines must be processed in order from
+// the observer line.
+constexpr int knViewshedQuadrants = 4;
+
+// Compute the viewshed of one observer, whose line has already been
+// read in vObserverLineVal. If poPool is not null, the four quadrants
+// around the observer are processed concurrently.
+static bool ViewshedProcess(ViewshedParams& p, ViewshedIO& oIO,
+                            ViewshedProgress& oProgress,
+                            std::vector<double>& vObserverLineVal,
+                            CPLWorkerThreadPool* poPool)
+{
+    p.dfZObserver = p.dfObserverHeight + vObserverLineVal[p.nX];
+
+    std::vector<GByte> vResult;
+    std::vector<double> vHeightResult;
+    try
+    {
+        vResult.resize(p.nXSize);
+        if (p.heightMode != GVOT_NORMAL)
+            vHeightResult.resize(p.nXSize);
+    } catch (...)
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "Cannot allocate vectors for viewshed");
+        return false;
+    }
+
+    double* padfHeightResult = p.heightMode != GVOT_NORMAL ? vHeightResult.data() : nullptr;
+    ProcessObserverLine(p, vObserverLineVal.data(), vResult.data(), padfHeightResult);
+
+    /* write result line */
+    if (!oIO.WriteLine(p.nXStart, p.nY, p.nXSize, vResult.data(), padfHeightResult))
+        return false;
+    if (!oProgress.Advance())
+        return false;
+
+    if (poPool == nullptr)
+    {
+        /* scan upwards, then downwards */
+        return SweepLines(p, oIO, oProgress, -1, 0, vObserverLineVal.data()) &&
+               SweepLines(p, oIO, oProgress, 1, 0, vObserverLineVal.data());
+    }
+
+    std::vector<ViewshedSweepJob> asJobs(knViewshedQuadrants);
+    for (int i = 0; i < knViewshedQuadrants; i++)
+    {
+        asJobs[i].psParams = &p;
+        asJobs[i].poIO = &oIO;
+        asJobs[i].poProgress = &oProgress;
+        asJobs[i].nDirY = (i / 2) == 0 ? -1 : 1;
+        asJobs[i].nDirX = (i % 2) == 0 ? -1 : 1;
+        asJobs[i].padfObserverLineVal = vObserverLineVal.data();
+    }
+    oProgress.SetRunningJobs(knViewshedQuadrants);
+    for (auto& sJob : asJobs)
+    {
+        if (!poPool->SubmitJob(ViewshedSweepJobFunc, &sJob))
+        {
+            oProgress.Fail();
+            oProgress.JobDone();
+        }
+    }
+    const bool bRet = oProgress.WaitJobs();
+    poPool->WaitCompletion();
+    return bRet;
+}
+
+} // namespace
+
 
 /************************************************************************/
 /*                        GDALViewshedGenerate()                         */
@@ -192,7 +896,11 @@ inline static double CalcHeight(double dfZ, double dfZ2, GDALViewshedMode eMode)
  *                   Parameters dfTargetHeight, dfVisibleVal and dfInvisibleVal will be ignored.
  *
  *
- * @param papszExtraOptions Future extra options. Must be set to NULL currently.
+ * @param papszExtraOptions NULL terminated list of options, or NULL.
+ * NUM_THREADS=number|ALL_CPUS sets the number of worker threads. When greater
+ * than 1, the four quadrants around the observer are processed concurrently,
+ * so at most 4 threads are used. Defaults to the value of the GDAL_NUM_THREADS
+ * configuration option, or 1.
  *
  * @return not NULL output dataset on success (to be closed with GDALClose()) or NULL if an error occurs.
  *
@@ -214,8 +922,6 @@ GDALDatasetH GDALViewshedGenerate(GDALRasterBandH hBand,
     VALIDATE_POINTER1( hBand, "GDALViewshedGenerate", nullptr );
     VALIDATE_POINTER1( pszTargetRasterName, "GDALViewshedGenerate", nullptr );
 
-    CPL_IGNORE_RET_VAL(papszExtraOptions);
-
     if( pfnProgress == nullptr )
         pfnProgress = GDALDummyProgress;
 
@@ -225,70 +931,47 @@ GDALDatasetH GDALViewshedGenerate(GDALRasterBandH hBand,
         return nullptr;
     }
 
+    ViewshedParams p;
     const GByte byNoDataVal = dfNoDataVal >= 0 && dfNoDataVal <= 255 ? static_cast<GByte>(dfNoDataVal) : 0;
-    const GByte byVisibleVal = dfVisibleVal >= 0 && dfVisibleVal <= 255 ? static_cast<GByte>(dfVisibleVal) : 255;
-    const GByte byInvisibleVal = dfInvisibleVal >= 0 && dfInvisibleVal <= 255 ? static_cast<GByte>(dfInvisibleVal) : 0;
-    const GByte byOutOfRangeVal = dfOutOfRangeVal >= 0 && dfOutOfRangeVal <= 255 ? static_cast<GByte>(dfOutOfRangeVal) : 0;
+    p.byVisibleVal = dfVisibleVal >= 0 && dfVisibleVal <= 255 ? static_cast<GByte>(dfVisibleVal) : 255;
+    p.byInvisibleVal = dfInvisibleVal >= 0 && dfInvisibleVal <= 255 ? static_cast<GByte>(dfInvisibleVal) : 0;
+    p.byOutOfRangeVal = dfOutOfRangeVal >= 0 && dfOutOfRangeVal <= 255 ? static_cast<GByte>(dfOutOfRangeVal) : 0;
+    p.dfOutOfRangeVal = dfOutOfRangeVal;
 
     if(heightMode != GVOT_MIN_TARGET_HEIGHT_FROM_DEM && heightMode != GVOT_MIN_TARGET_HEIGHT_FROM_GROUND)
         heightMode = GVOT_NORMAL;
+    p.heightMode = heightMode;
+    p.eMode = eMode;
+    p.dfObserverHeight = dfObserverHeight;
+    p.dfTargetHeight = dfTargetHeight;
+    p.dfCurvCoeff = dfCurvCoeff;
 
     /* set up geotransformation */
-    std::array<double, 6> adfGeoTransform {{0.0, 1.0, 0.0, 0.0, 0.0, 1.0}};
     GDALDatasetH hSrcDS = GDALGetBandDataset( hBand );
     if( hSrcDS != nullptr )
-        GDALGetGeoTransform( hSrcDS, adfGeoTransform.data());
+        GDALGetGeoTransform( hSrcDS, p.adfGeoTransform.data());
 
     double adfInvGeoTransform[6];
-    if (!GDALInvGeoTransform(adfGeoTransform.data(), adfInvGeoTransform))
+    if (!GDALInvGeoTransform(p.adfGeoTransform.data(), adfInvGeoTransform))
     {
         CPLError(CE_Failure, CPLE_AppDefined, "Cannot invert geotransform");
         return nullptr;
     }
 
-    /* calculate observer position */
-    double dfX, dfY;
-    GDALApplyGeoTransform(adfInvGeoTransform, dfObserverX, dfObserverY, &dfX, &dfY);
-    int nX = static_cast<int>(std::round(dfX));
-    int nY = static_cast<int>(std::round(dfY));
-
-    int nXSize = GDALGetRasterBandXSize( hBand );
-    int nYSize = GDALGetRasterBandYSize( hBand );
-
-    if (nX < 0 ||
-        nX > nXSize ||
-        nY < 0 ||
-        nY > nYSize)
+    /* calculate observer position and area of interest */
+    if (!ViewshedSetupWindow(p, adfInvGeoTransform, dfObserverX, dfObserverY,
+                             dfMaxDistance,
+                             GDALGetRasterBandXSize( hBand ),
+                             GDALGetRasterBandYSize( hBand )))
     {
         CPLError(CE_Failure, CPLE_AppDefined, "The observer location falls outside of the DEM area");
         return nullptr;
     }
 
-    /* calculate the area of interest */
-    int nXStart = dfMaxDistance > 0? (std::max)(0, static_cast<int>(std::floor(nX - adfInvGeoTransform[1] * dfMaxDistance))) : 0;
-    int nXStop = dfMaxDistance > 0? (std::min)(nXSize, static_cast<int>(std::ceil(nX + adfInvGeoTransform[1] * dfMaxDistance) + 1)) : nXSize;
-    int nYStart = dfMaxDistance > 0? (std::max)(0, static_cast<int>(std::floor(nY + adfInvGeoTransform[5] * dfMaxDistance))) : 0;
-    int nYStop = dfMaxDistance > 0? (std::min)(nYSize, static_cast<int>(std::ceil(nY - adfInvGeoTransform[5] * dfMaxDistance) + 1)) : nYSize;
-
-    /* normalize horizontal index (0 - nXSize) */
-    nXSize = nXStop - nXStart;
-    nX -= nXStart;
-
     std::vector<double> vFirstLineVal;
-    std::vector<double> vLastLineVal;
-    std::vector<double> vThisLineVal;
-    std::vector<GByte> vResult;
-    std::vector<double> vHeightResult;
-
     try
     {
-        vFirstLineVal.resize(nXSize);
-        vLastLineVal.resize(nXSize);
-        vThisLineVal.resize(nXSize);
-        vResult.resize(nXSize);
-
-        if(heightMode != GVOT_NORMAL)
-            vHeightResult.resize(nXSize);
+        vFirstLineVal.resize(p.nXSize);
     } catch (...)
     {
         CPLError(CE_Failure, CPLE_AppDefined,
@@ -296,12 +979,6 @@ GDALDatasetH GDALViewshedGenerate(GDALRasterBandH hBand,
         return nullptr;
     }
 
-    double *padfFirstLineVal = vFirstLineVal.data();
-    double *padfLastLineVal = vLastLineVal.data();
-    double *padfThisLineVal = vThisLineVal.data();
-    GByte *pabyResult = vResult.data();
-    double *dfHeightResult = vHeightResult.data();
-
     GDALDriverManager *hMgr = GetGDALDriverManager();
     GDALDriver *hDriver = hMgr->GetDriverByName(pszDriverName ? pszDriverName : "GTiff");
     if (!hDriver)
@@ -311,7 +988,7 @@ GDALDatasetH GDALViewshedGenerate(GDALRasterBandH hBand,
     }
 
     /* create output raster */
-    auto poDstDS = std::unique_ptr<GDALDataset>(hDriver->Create(pszTargetRasterName, nXSize, nYStop - nYStart, 1, heightMode != GVOT_NORMAL ? GDT_Float64 : GDT_Byte,
+    auto poDstDS = std::unique_ptr<GDALDataset>(hDriver->Create(pszTargetRasterName, p.nXSize, p.nYStop - p.nYStart, 1, heightMode != GVOT_NORMAL ? GDT_Float64 : GDT_Byte,
                                                 const_cast<char**>(papszCreationOptions)));
     if (!poDstDS)
     {
@@ -323,11 +1000,12 @@ GDALDatasetH GDALViewshedGenerate(GDALRasterBandH hBand,
     if (hSrcDS)
         poDstDS->SetSpatialRef(GDALDataset::FromHandle(hSrcDS)->GetSpatialRef());
 
+    const std::array<double, 6>& adfGeoTransform = p.adfGeoTransform;
     std::array<double, 6> adfDstGeoTransform;
-    adfDstGeoTransform[0] = adfGeoTransform[0] + adfGeoTransform[1] * nXStart + adfGeoTransform[2] * nYStart;
+    adfDstGeoTransform[0] = adfGeoTransform[0] + adfGeoTransform[1] * p.nXStart + adfGeoTransform[2] * p.nYStart;
     adfDstGeoTransform[1] = adfGeoTransform[1];
     adfDstGeoTransform[2] = adfGeoTransform[2];
-    adfDstGeoTransform[3] = adfGeoTransform[3] + adfGeoTransform[4] * nXStart + adfGeoTransform[5] * nYStart;
+    adfDstGeoTransform[3] = adfGeoTransform[3] + adfGeoTransform[4] * p.nXStart + adfGeoTransform[5] * p.nYStart;
     adfDstGeoTransform[4] = adfGeoTransform[4];
     adfDstGeoTransform[5] = adfGeoTransform[5];
     poDstDS->SetGeoTransform(adfDstGeoTransform.data());
@@ -343,515 +1021,272 @@ GDALDatasetH GDALViewshedGenerate(GDALRasterBandH hBand,
     if (dfNoDataVal >= 0)
         GDALSetRasterNoDataValue(hTargetBand, heightMode != GVOT_NORMAL ? dfNoDataVal : byNoDataVal);
 
-    /* process first line */
-    if (GDALRasterIO(hBand, GF_Read, nXStart, nY, nXSize, 1,
-        padfFirstLineVal, nXSize, 1, GDT_Float64, 0, 0))
-    {
-        CPLError(CE_Failure, CPLE_AppDefined,
-            "RasterIO error when reading DEM at position(%d, %d), size(%d, %d)", nXStart, nY, nXSize, 1);
+    /* read first line */
+    ViewshedIO oIO(hBand, GDALRasterBand::ToHandle(hTargetBand),
+                   p.nXStart, p.nYStart, /* bCumulative = */ false);
+    if (!oIO.ReadLine(p.nXStart, p.nY, p.nXSize, vFirstLineVal.data()))
         return nullptr;
-    }
 
-    const double dfZObserver = dfObserverHeight + padfFirstLineVal[nX];
-    double dfZ = 0.0;
-    const double dfDistance2 = dfMaxDistance * dfMaxDistance;
+    p.dfSphereDiameter = ViewshedGetSphereDiameter(poDstDS->GetSpatialRef());
 
-    /* If we can't get a SemiMajor axis from the SRS, it will be
-     * SRS_WGS84_SEMIMAJOR
-    */
-    double dfSphereDiameter(std::numeric_limits<double>::infinity());
-    const OGRSpatialReference* poDstSRS = poDstDS->GetSpatialRef();
-    if (poDstSRS)
+    /* the four quadrants around the observer may be processed concurrently,
+       so there is no use for more threads than quadrants */
+    std::unique_ptr<CPLWorkerThreadPool> poPool;
+    const int nThreads = std::min(ViewshedGetThreadCount(papszExtraOptions),
+                                  knViewshedQuadrants);
+    if (nThreads > 1)
     {
-        OGRErr eSRSerr;
-        double dfSemiMajor = poDstSRS->GetSemiMajor(&eSRSerr);
-
-        /* If we fetched the axis from the SRS, use it */
-        if (eSRSerr != OGRERR_FAILURE)
-            dfSphereDiameter = dfSemiMajor * 2.0;
-        else
-            CPLDebug( "GDALViewshedGenerate", "Unable to fetch SemiMajor axis from spatial reference");
-
+        poPool.reset(new CPLWorkerThreadPool());
+        if (!poPool->Setup(nThreads, nullptr, nullptr))
+            poPool.reset();
     }
 
-    /* mark the observer point as visible */
-    double dfGroundLevel = heightMode == GVOT_MIN_TARGET_HEIGHT_FROM_DEM ? padfFirstLineVal[nX] : 0.0;
-    pabyResult[nX] = byVisibleVal;
-    if(heightMode != GVOT_NORMAL)
-        dfHeightResult[nX] = dfGroundLevel;
+    ViewshedProgress oProgress(pfnProgress, pProgressArg, p.nYStop - p.nYStart);
+    if (!ViewshedProcess(p, oIO, oProgress, vFirstLineVal, poPool.get()))
+        return nullptr;
 
-    if (nX > 0)
-    {
-        dfGroundLevel = heightMode == GVOT_MIN_TARGET_HEIGHT_FROM_DEM ? padfFirstLineVal[nX - 1] : 0.0;
-        CPL_IGNORE_RET_VAL(
-            AdjustHeightInRange(adfGeoTransform.data(),
-                            1,
-                            0,
-                            padfFirstLineVal[nX - 1],
-                            dfDistance2,
-                            dfCurvCoeff,
-                            dfSphereDiameter));
-        pabyResult[nX - 1] = byVisibleVal;
-        if(heightMode != GVOT_NORMAL)
-            dfHeightResult[nX - 1] = dfGroundLevel;
-    }
-    if (nX < nXSize - 1)
-    {
-        dfGroundLevel = heightMode == GVOT_MIN_TARGET_HEIGHT_FROM_DEM ? padfFirstLineVal[nX + 1] : 0.0;
-        CPL_IGNORE_RET_VAL(
-            AdjustHeightInRange(adfGeoTransform.data(),
-                            1,
-                            0,
-                            padfFirstLineVal[nX + 1],
-                            dfDistance2,
-                            dfCurvCoeff,
-                            dfSphereDiameter));
-        pabyResult[nX + 1] = byVisibleVal;
-        if(heightMode != GVOT_NORMAL)
-            dfHeightResult[nX + 1] = dfGroundLevel;
-    }
-
-    /* process left direction */
-    for (int iPixel = nX - 2; iPixel >= 0; iPixel--)
-    {
-        dfGroundLevel = heightMode == GVOT_MIN_TARGET_HEIGHT_FROM_DEM ? padfFirstLineVal[iPixel] : 0.0;
-        bool adjusted = AdjustHeightInRange(adfGeoTransform.data(),
-                                            nX - iPixel,
-                                            0,
-                                            padfFirstLineVal[iPixel],
-                                            dfDistance2,
-                                            dfCurvCoeff,
-                                            dfSphereDiameter);
-        if (adjusted)
-        {
-            dfZ = CalcHeightLine(nX - iPixel,
-                                 padfFirstLineVal[iPixel + 1],
-                                 dfZObserver);
-
-            if(heightMode != GVOT_NORMAL)
-                dfHeightResult[iPixel] = std::max(0.0, (dfZ - padfFirstLineVal[iPixel] + dfGroundLevel));
-
-            SetVisibility(  iPixel,
-                            dfZ,
-                            dfTargetHeight,
-                            padfFirstLineVal,
-                            vResult,
-                            byVisibleVal,
-                            byInvisibleVal);
-        }
-        else
-        {
-            for (; iPixel >= 0; iPixel--)
-            {
-                pabyResult[iPixel] = byOutOfRangeVal;
-                if(heightMode != GVOT_NORMAL)
-                    dfHeightResult[iPixel] = dfOutOfRangeVal;
-            }
-        }
-    }
-    /* process right direction */
-    for (int iPixel = nX + 2; iPixel < nXSize; iPixel++)
-    {
-        dfGroundLevel = heightMode == GVOT_MIN_TARGET_HEIGHT_FROM_DEM ? padfFirstLineVal[iPixel] : 0.0;
-        bool adjusted = AdjustHeightInRange(adfGeoTransform.data(),
-                                            iPixel - nX,
-                                            0,
-                                            padfFirstLineVal[iPixel],
-                                            dfDistance2,
-                                            dfCurvCoeff,
-                                            dfSphereDiameter);
-        if (adjusted)
-        {
-            dfZ = CalcHeightLine(iPixel - nX,
-                                 padfFirstLineVal[iPixel - 1],
-                                 dfZObserver);
+    return GDALDataset::FromHandle(poDstDS.release());
+}
 
-            if(heightMode != GVOT_NORMAL)
-                dfHeightResult[iPixel] = std::max(0.0, (dfZ - padfFirstLineVal[iPixel] + dfGroundLevel));
+/************************************************************************/
+/*                   GDALViewshedGenerateCumulative()                   */
+/************************************************************************/
 
-            SetVisibility(iPixel,
-                          dfZ,
-                          dfTargetHeight,
-                          padfFirstLineVal,
-                          vResult,
-                          byVisibleVal,
-                          byInvisibleVal);
-        }
-        else
-        {
-            for (; iPixel < nXSize; iPixel++)
-            {
-                pabyResult[iPixel] = byOutOfRangeVal;
-                if(heightMode != GVOT_NORMAL)
-                    dfHeightResult[iPixel] = dfOutOfRangeVal;
-            }
-        }
-    }
-    /* write result line */
+namespace {
+
+struct ViewshedObserverJob
+{
+    ViewshedParams* psParams = nullptr;
+    ViewshedIO* poIO = nullptr;
+    ViewshedProgress* poProgress = nullptr;
+};
 
-    if (GDALRasterIO(hTargetBand, GF_Write, 0, nY - nYStart, nXSize, 1,
-        heightMode != GVOT_NORMAL ? static_cast<void*>(dfHeightResult) : static_cast<void*>(pabyResult), nXSize, 1, heightMode != GVOT_NORMAL ? GDT_Float64 : GDT_Byte, 0, 0))
+static bool ViewshedProcessObserver(ViewshedParams& p, ViewshedIO& oIO,
+                                    ViewshedProgress& oProgress)
+{
+    std::vector<double> vObserverLineVal;
+    try
+    {
+        vObserverLineVal.resize(p.nXSize);
+    } catch (...)
     {
         CPLError(CE_Failure, CPLE_AppDefined,
-            "RasterIO error when writing target raster at position (%d,%d), size (%d,%d)", 0, nY - nYStart, nXSize, 1);
-        return nullptr;
+                 "Cannot allocate vectors for viewshed");
+        return false;
     }
+    if (!oIO.ReadLine(p.nXStart, p.nY, p.nXSize, vObserverLineVal.data()))
+        return false;
+    return ViewshedProcess(p, oIO, oProgress, vObserverLineVal, nullptr);
+}
 
-    /* scan upwards */
-    std::copy(vFirstLineVal.begin(),
-              vFirstLineVal.end(),
-              vLastLineVal.begin());
-    for (int iLine = nY - 1; iLine >= nYStart; iLine--)
+static void ViewshedObserverJobFunc(void* pData)
+{
+    ViewshedObserverJob* psJob = static_cast<ViewshedObserverJob*>(pData);
+    if (!psJob->poProgress->IsStopped() &&
+        !ViewshedProcessObserver(*psJob->psParams, *psJob->poIO, *psJob->poProgress))
     {
-        if (GDALRasterIO(hBand, GF_Read, nXStart, iLine, nXSize, 1,
-            padfThisLineVal, nXSize, 1, GDT_Float64, 0, 0))
-        {
-            CPLError(CE_Failure, CPLE_AppDefined,
-                "RasterIO error when reading DEM at position (%d,%d), size (%d,%d)", nXStart, iLine, nXSize, 1);
-            return nullptr;
-        }
-
-        /* set up initial point on the scanline */
-        dfGroundLevel = heightMode == GVOT_MIN_TARGET_HEIGHT_FROM_DEM ? padfThisLineVal[nX] : 0.0;
-        bool adjusted = AdjustHeightInRange(adfGeoTransform.data(),
-                                            0,
-                                            nY - iLine,
-                                            padfThisLineVal[nX],
-                                            dfDistance2,
-                                            dfCurvCoeff,
-                                            dfSphereDiameter);
-        if (adjusted)
-        {
-            dfZ = CalcHeightLine(nY - iLine,
-                                 padfLastLineVal[nX],
-                                 dfZObserver);
+        psJob->poProgress->Fail();
+    }
+    psJob->poProgress->JobDone();
+}
 
-            if(heightMode != GVOT_NORMAL)
-                dfHeightResult[nX] = std::max(0.0, (dfZ - padfThisLineVal[nX] + dfGroundLevel));
+} // namespace
 
-            SetVisibility(nX,
-                          dfZ,
-                          dfTargetHeight,
-                          padfThisLineVal,
-                          vResult,
-                          byVisibleVal,
-                          byInvisibleVal);
-        }
-        else
-        {
-            pabyResult[nX] = byOutOfRangeVal;
-            if(heightMode != GVOT_NORMAL)
-                dfHeightResult[nX] = dfOutOfRangeVal;
-        }
+/**
+ * Create cumulative viewshed from raster DEM.
+ *
+ * The viewshed of each observer is computed with the same algorithm as
+ * GDALViewshedGenerate(), and the output raster contains, for each cell of
+ * the DEM, the number of observers from which it is visible. DEM lines are
+ * read through the block cache of hBand, so that reads are shared between
+ * observers instead of opening and reading the DEM again for each of them.
+ *
+ * The output raster has the extent of the DEM. It is of type UInt16, or
+ * UInt32 if there are more than 65535 observers.
+ *
+ * @param hBand The band to read the DEM data from.
+ *
+ * @param pszDriverName Driver name (GTiff if set to NULL)
+ *
+ * @param pszTargetRasterName The name of the target raster to be generated. Must not be NULL
+ *
+ * @param papszCreationOptions creation options.
+ *
+ * @param nObserverCount number of observers.
+ *
+ * @param padfObserverX array of nObserverCount observer X values (in SRS units)
+ *
+ * @param padfObserverY array of nObserverCount observer Y values (in SRS units)
+ *
+ * @param dfObserverHeight The height of the observers above the DEM surface.
+ *
+ * @param dfTargetHeight The height of the target above the DEM surface.
+ *
+ * @param dfCurvCoeff Coefficient to consider the effect of the curvature and refraction.
+ * See GDALViewshedGenerate().
+ *
+ * @param eMode The mode of the viewshed calculation.
+ * Possible values GVM_Diagonal = 1, GVM_Edge = 2 (default), GVM_Max = 3, GVM_Min = 4.
+ *
+ * @param dfMaxDistance maximum distance range to compute the viewshed of
+ *                      each observer. If set to 0, then unlimited range is
+ *                      assumed.
+ *
+ * @param pfnProgress A GDALProgressFunc that may be used to report progress
+ * to the user, or to interrupt the algorithm.  May be NULL if not required.
+ *
+ * @param pProgressArg The callback data for the pfnProgress function.
+ *
+ * @param papszExtraOptions NULL terminated list of options, or NULL.
+ * NUM_THREADS=number|ALL_CPUS sets the number of observers processed
+ * concurrently. Defaults to the value of the GDAL_NUM_THREADS configuration
+ * option, or 1.
+ *
+ * @return not NULL output dataset on success (to be closed with GDALClose()) or NULL if an error occurs.
+ *
+ * @since GDAL 3.1
+ */
 
-        /* process left direction */
-        for (int iPixel = nX - 1; iPixel >= 0; iPixel--)
-        {
-            dfGroundLevel = heightMode == GVOT_MIN_TARGET_HEIGHT_FROM_DEM ? padfThisLineVal[iPixel] : 0.0;
-            bool left_adjusted = AdjustHeightInRange(adfGeoTransform.data(),
-                                                     nX - iPixel,
-                                                     nY - iLine,
-                                                     padfThisLineVal[iPixel],
-                                                     dfDistance2,
-                                                     dfCurvCoeff,
-                                                     dfSphereDiameter);
-            if (left_adjusted)
-            {
-                if (eMode != GVM_Edge)
-                    dfZ = CalcHeightDiagonal(nX - iPixel,
-                                             nY - iLine,
-                                             padfThisLineVal[iPixel + 1],
-                                             padfLastLineVal[iPixel],
-                                             dfZObserver);
-
-                if (eMode != GVM_Diagonal)
-                {
-                    double dfZ2 = nX - iPixel >= nY - iLine ?
-                        CalcHeightEdge(nY - iLine,
-                                       nX - iPixel,
-                                       padfLastLineVal[iPixel + 1],
-                                       padfThisLineVal[iPixel + 1],
-                                       dfZObserver) :
-                        CalcHeightEdge(nX - iPixel,
-                                       nY - iLine,
-                                       padfLastLineVal[iPixel + 1],
-                                       padfLastLineVal[iPixel],
-                                       dfZObserver);
-                    dfZ = CalcHeight(dfZ, dfZ2, eMode);
-                }
+GDALDatasetH GDALViewshedGenerateCumulative(GDALRasterBandH hBand,
+                            const char* pszDriverName,
+                            const char* pszTargetRasterName,
+                            CSLConstList papszCreationOptions,
+                    int nObserverCount,
+                    const double* padfObserverX, const double* padfObserverY,
+                    double dfObserverHeight, double dfTargetHeight,
+                    double dfCurvCoeff, GDALViewshedMode eMode,
+                    double dfMaxDistance,
+                    GDALProgressFunc pfnProgress, void *pProgressArg,
+                    CSLConstList papszExtraOptions)
+{
+    VALIDATE_POINTER1( hBand, "GDALViewshedGenerateCumulative", nullptr );
+    VALIDATE_POINTER1( pszTargetRasterName, "GDALViewshedGenerateCumulative", nullptr );
+    if (nObserverCount > 0)
+    {
+        VALIDATE_POINTER1( padfObserverX, "GDALViewshedGenerateCumulative", nullptr );
+        VALIDATE_POINTER1( padfObserverY, "GDALViewshedGenerateCumulative", nullptr );
+    }
 
-                if(heightMode != GVOT_NORMAL)
-                    dfHeightResult[iPixel] = std::max(0.0, (dfZ - padfThisLineVal[iPixel] + dfGroundLevel));
+    if( pfnProgress == nullptr )
+        pfnProgress = GDALDummyProgress;
 
-                SetVisibility(iPixel,
-                              dfZ,
-                              dfTargetHeight,
-                              padfThisLineVal,
-                              vResult,
-                              byVisibleVal,
-                              byInvisibleVal);
-            }
-            else
-            {
-                for (; iPixel >= 0; iPixel--)
-                {
-                    pabyResult[iPixel] = byOutOfRangeVal;
-                    if(heightMode != GVOT_NORMAL)
-                        dfHeightResult[iPixel] = dfOutOfRangeVal;
-                }
-            }
-        }
-        /* process right direction */
-        for (int iPixel = nX + 1; iPixel < nXSize; iPixel++)
-        {
-            dfGroundLevel = heightMode == GVOT_MIN_TARGET_HEIGHT_FROM_DEM ? padfThisLineVal[iPixel] : 0.0;
-            bool right_adjusted = AdjustHeightInRange(adfGeoTransform.data(),
-                                                      iPixel - nX,
-                                                      nY - iLine,
-                                                      padfThisLineVal[iPixel],
-                                                      dfDistance2,
-                                                      dfCurvCoeff,
-                                                      dfSphereDiameter);
-            if (right_adjusted)
-            {
-                if (eMode != GVM_Edge)
-                    dfZ = CalcHeightDiagonal(iPixel - nX,
-                                             nY - iLine,
-                                             padfThisLineVal[iPixel - 1],
-                                             padfLastLineVal[iPixel],
-                                             dfZObserver);
-
-                if (eMode != GVM_Diagonal)
-                {
-                    double dfZ2 = iPixel - nX >= nY - iLine ?
-                        CalcHeightEdge(nY - iLine,
-                                       iPixel - nX,
-                                       padfLastLineVal[iPixel - 1],
-                                       padfThisLineVal[iPixel - 1],
-                                       dfZObserver) :
-                        CalcHeightEdge(iPixel - nX,
-                                       nY - iLine,
-                                       padfLastLineVal[iPixel - 1],
-                                       padfLastLineVal[iPixel],
-                                       dfZObserver);
-                    dfZ = CalcHeight(dfZ, dfZ2, eMode);
-                }
+    if( !pfnProgress( 0.0, "", pProgressArg ) )
+    {
+        CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+        return nullptr;
+    }
 
-                if(heightMode != GVOT_NORMAL)
-                    dfHeightResult[iPixel] = std::max(0.0, (dfZ - padfThisLineVal[iPixel] + dfGroundLevel));
+    const int nRasterXSize = GDALGetRasterBandXSize( hBand );
+    const int nRasterYSize = GDALGetRasterBandYSize( hBand );
 
-                SetVisibility(iPixel,
-                              dfZ,
-                              dfTargetHeight,
-                              padfThisLineVal,
-                              vResult,
-                              byVisibleVal,
-                              byInvisibleVal);
-            }
-            else
-            {
-                for (; iPixel < nXSize; iPixel++)
-                {
-                    pabyResult[iPixel] = byOutOfRangeVal;
-                    if(heightMode != GVOT_NORMAL)
-                        dfHeightResult[iPixel] = dfOutOfRangeVal;
-                }
-            }
-        }
+    /* parameters common to all observers: each visible cell counts for one */
+    ViewshedParams sCommon;
+    sCommon.byVisibleVal = 1;
+    sCommon.byInvisibleVal = 0;
+    sCommon.byOutOfRangeVal = 0;
+    sCommon.eMode = eMode;
+    sCommon.dfObserverHeight = dfObserverHeight;
+    sCommon.dfTargetHeight = dfTargetHeight;
+    sCommon.dfCurvCoeff = dfCurvCoeff;
 
-        /* write result line */
-        if (GDALRasterIO(hTargetBand, GF_Write, 0, iLine - nYStart, nXSize, 1,
-            heightMode != GVOT_NORMAL ? static_cast<void*>(dfHeightResult) : static_cast<void*>(pabyResult), nXSize, 1, heightMode != GVOT_NORMAL ? GDT_Float64 : GDT_Byte, 0, 0))
-        {
-            CPLError(CE_Failure, CPLE_AppDefined,
-                "RasterIO error when writing target raster at position (%d,%d), size (%d,%d)", 0, iLine - nYStart, nXSize, 1);
-            return nullptr;
-        }
+    GDALDatasetH hSrcDS = GDALGetBandDataset( hBand );
+    if( hSrcDS != nullptr )
+        GDALGetGeoTransform( hSrcDS, sCommon.adfGeoTransform.data());
 
-        std::swap(padfLastLineVal, padfThisLineVal);
+    double adfInvGeoTransform[6];
+    if (!GDALInvGeoTransform(sCommon.adfGeoTransform.data(), adfInvGeoTransform))
+    {
+        CPLError(CE_Failure, CPLE_AppDefined, "Cannot invert geotransform");
+        return nullptr;
+    }
 
-        if (!pfnProgress((nYStart - iLine + 1) / static_cast<double>(nYStop),
-                "", pProgressArg))
-        {
-            CPLError(CE_Failure, CPLE_UserInterrupt, "User terminated");
-            return nullptr;
-        }
+    GDALDriverManager *hMgr = GetGDALDriverManager();
+    GDALDriver *hDriver = hMgr->GetDriverByName(pszDriverName ? pszDriverName : "GTiff");
+    if (!hDriver)
+    {
+        CPLError(CE_Failure, CPLE_AppDefined, "Cannot get driver");
+        return nullptr;
     }
-    /* scan downwards */
-    memcpy(padfLastLineVal, padfFirstLineVal, nXSize * sizeof(double));
-    for(int iLine = nY + 1; iLine < nYStop; iLine++ )
+
+    /* create output raster */
+    const GDALDataType eCountType = nObserverCount <= 65535 ? GDT_UInt16 : GDT_UInt32;
+    auto poDstDS = std::unique_ptr<GDALDataset>(hDriver->Create(pszTargetRasterName, nRasterXSize, nRasterYSize, 1, eCountType,
+                                                const_cast<char**>(papszCreationOptions)));
+    if (!poDstDS)
     {
-        if (GDALRasterIO( hBand, GF_Read, nXStart, iLine, nXStop - nXStart, 1,
-            padfThisLineVal, nXStop - nXStart, 1, GDT_Float64, 0, 0 ))
-        {
-            CPLError(CE_Failure, CPLE_AppDefined,
-                "RasterIO error when reading DEM at position (%d,%d), size (%d,%d)", nXStart, iLine, nXStop - nXStart, 1);
-            return nullptr;
-        }
+        CPLError(CE_Failure, CPLE_AppDefined,
+            "Cannot create dataset for %s", pszTargetRasterName);
+        return nullptr;
+    }
+    if (hSrcDS)
+        poDstDS->SetSpatialRef(GDALDataset::FromHandle(hSrcDS)->GetSpatialRef());
+    poDstDS->SetGeoTransform(sCommon.adfGeoTransform.data());
 
-        /* set up initial point on the scanline */
-        dfGroundLevel = heightMode == GVOT_MIN_TARGET_HEIGHT_FROM_DEM ? padfThisLineVal[nX] : 0.0;
-        bool adjusted = AdjustHeightInRange(adfGeoTransform.data(),
-                                            0,
-                                            iLine - nY,
-                                            padfThisLineVal[nX],
-                                            dfDistance2,
-                                            dfCurvCoeff,
-                                            dfSphereDiameter);
-        if (adjusted)
-        {
-            dfZ = CalcHeightLine(iLine - nY,
-                                 padfLastLineVal[nX],
-                                 dfZObserver);
+    auto poTargetBand = poDstDS->GetRasterBand(1);
+    if (poTargetBand == nullptr || poTargetBand->Fill(0) != CE_None)
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+            "Cannot initialize band of %s", pszTargetRasterName);
+        return nullptr;
+    }
 
-            if(heightMode != GVOT_NORMAL)
-                dfHeightResult[nX] = std::max(0.0, (dfZ - padfThisLineVal[nX] + dfGroundLevel));
+    sCommon.dfSphereDiameter = ViewshedGetSphereDiameter(poDstDS->GetSpatialRef());
 
-            SetVisibility(nX,
-                          dfZ,
-                          dfTargetHeight,
-                          padfThisLineVal,
-                          vResult,
-                          byVisibleVal,
-                          byInvisibleVal);
-        }
-        else
+    std::vector<ViewshedParams> asParams;
+    double dfTotalLines = 0;
+    for (int i = 0; i < nObserverCount; i++)
+    {
+        ViewshedParams p(sCommon);
+        if (!ViewshedSetupWindow(p, adfInvGeoTransform,
+                                 padfObserverX[i], padfObserverY[i],
+                                 dfMaxDistance, nRasterXSize, nRasterYSize))
         {
-            pabyResult[nX] = byOutOfRangeVal;
-            if(heightMode != GVOT_NORMAL)
-                dfHeightResult[nX] = dfOutOfRangeVal;
+            CPLError(CE_Warning, CPLE_AppDefined,
+                     "The location of observer %d falls outside of the DEM area. Ignoring it", i);
+            continue;
         }
+        dfTotalLines += p.nYStop - p.nYStart;
+        asParams.push_back(p);
+    }
 
-        /* process left direction */
-        for (int iPixel = nX - 1; iPixel >= 0; iPixel--)
-        {
-            dfGroundLevel = heightMode == GVOT_MIN_TARGET_HEIGHT_FROM_DEM ? padfThisLineVal[iPixel] : 0.0;
-            bool left_adjusted = AdjustHeightInRange(adfGeoTransform.data(),
-                                                     nX - iPixel,
-                                                     iLine - nY,
-                                                     padfThisLineVal[iPixel],
-                                                     dfDistance2,
-                                                     dfCurvCoeff,
-                                                     dfSphereDiameter);
-            if (left_adjusted)
-            {
-                if (eMode != GVM_Edge)
-                    dfZ = CalcHeightDiagonal(nX - iPixel, iLine - nY,
-                        padfThisLineVal[iPixel + 1], padfLastLineVal[iPixel], dfZObserver);
-
-                if (eMode != GVM_Diagonal)
-                {
-                    double dfZ2 = nX - iPixel >= iLine - nY ?
-                        CalcHeightEdge(iLine - nY,
-                                       nX - iPixel,
-                                       padfLastLineVal[iPixel + 1],
-                                       padfThisLineVal[iPixel + 1],
-                                       dfZObserver) :
-                        CalcHeightEdge(nX - iPixel,
-                                       iLine - nY,
-                                       padfLastLineVal[iPixel + 1],
-                                       padfLastLineVal[iPixel],
-                                       dfZObserver);
-                    dfZ = CalcHeight(dfZ, dfZ2, eMode);
-                }
-
-                if(heightMode != GVOT_NORMAL)
-                    dfHeightResult[iPixel] = std::max(0.0, (dfZ - padfThisLineVal[iPixel] + dfGroundLevel));
+    ViewshedIO oIO(hBand, GDALRasterBand::ToHandle(poTargetBand),
+                   0, 0, /* bCumulative = */ true);
+    ViewshedProgress oProgress(pfnProgress, pProgressArg, dfTotalLines);
 
-                SetVisibility(iPixel,
-                              dfZ,
-                              dfTargetHeight,
-                              padfThisLineVal,
-                              vResult,
-                              byVisibleVal,
-                              byInvisibleVal);
-            }
-            else
-            {
-                for (; iPixel >= 0; iPixel--)
-                {
-                    pabyResult[iPixel] = byOutOfRangeVal;
-                    if(heightMode != GVOT_NORMAL)
-                        dfHeightResult[iPixel] = dfOutOfRangeVal;
-                }
-            }
-        }
-        /* process right direction */
-        for (int iPixel = nX + 1; iPixel < nXSize; iPixel++)
+    /* observers are distributed over the worker threads */
+    const int nThreads = std::min(ViewshedGetThreadCount(papszExtraOptions),
+                                  static_cast<int>(asParams.size()));
+    CPLWorkerThreadPool oPool;
+    if (nThreads > 1 && oPool.Setup(nThreads, nullptr, nullptr))
+    {
+        std::vector<ViewshedObserverJob> asJobs(asParams.size());
+        oProgress.SetRunningJobs(static_cast<int>(asJobs.size()));
+        for (size_t i = 0; i < asJobs.size(); i++)
         {
-            dfGroundLevel = heightMode == GVOT_MIN_TARGET_HEIGHT_FROM_DEM ? padfThisLineVal[iPixel] : 0.0;
-            bool right_adjusted = AdjustHeightInRange(adfGeoTransform.data(),
-                                                      iPixel - nX,
-                                                      iLine - nY,
-                                                      padfThisLineVal[iPixel],
-                                                      dfDistance2,
-                                                      dfCurvCoeff,
-                                                      dfSphereDiameter);
-            if (right_adjusted)
-            {
-                if (eMode != GVM_Edge)
-                    dfZ = CalcHeightDiagonal(iPixel - nX,
-                                             iLine - nY,
-                                             padfThisLineVal[iPixel - 1],
-                                             padfLastLineVal[iPixel],
-                                             dfZObserver);
-
-                if (eMode != GVM_Diagonal)
-                {
-                    double dfZ2 = iPixel - nX >= iLine - nY ?
-                        CalcHeightEdge(iLine - nY,
-                                       iPixel - nX,
-                                       padfLastLineVal[iPixel - 1],
-                                       padfThisLineVal[iPixel - 1],
-                                       dfZObserver) :
-                        CalcHeightEdge(iPixel - nX,
-                                       iLine - nY,
-                                       padfLastLineVal[iPixel - 1],
-                                       padfLastLineVal[iPixel],
-                                       dfZObserver);
-                    dfZ = CalcHeight(dfZ, dfZ2, eMode);
-                }
-
-                if(heightMode != GVOT_NORMAL)
-                    dfHeightResult[iPixel] = std::max(0.0, (dfZ - padfThisLineVal[iPixel] + dfGroundLevel));
-
-                SetVisibility(iPixel,
-                              dfZ,
-                              dfTargetHeight,
-                              padfThisLineVal,
-                              vResult,
-                              byVisibleVal,
-                              byInvisibleVal);
-            }
-            else
+            asJobs[i].psParams = &asParams[i];
+            asJobs[i].poIO = &oIO;
+            asJobs[i].poProgress = &oProgress;
+            if (!oPool.SubmitJob(ViewshedObserverJobFunc, &asJobs[i]))
             {
-                for (; iPixel < nXSize; iPixel++)
-                {
-                    pabyResult[iPixel] = byOutOfRangeVal;
-                    if(heightMode != GVOT_NORMAL)
-                        dfHeightResult[iPixel] = dfOutOfRangeVal;
-                }
+                oProgress.Fail();
+                oProgress.JobDone();
             }
         }
-
-        /* write result line */
-        if (GDALRasterIO(hTargetBand, GF_Write, 0, iLine - nYStart, nXSize, 1,
-            heightMode != GVOT_NORMAL ? static_cast<void*>(dfHeightResult) : static_cast<void*>(pabyResult), nXSize, 1, heightMode != GVOT_NORMAL ? GDT_Float64 : GDT_Byte, 0, 0))
-        {
-            CPLError(CE_Failure, CPLE_AppDefined,
-                "RasterIO error when writing target raster at position (%d,%d), size (%d,%d)", 0, iLine - nYStart, nXSize, 1);
+        const bool bRet = oProgress.WaitJobs();
+        oPool.WaitCompletion();
+        if (!bRet)
             return nullptr;
-        }
-
-        std::swap(padfLastLineVal, padfThisLineVal);
-
-        if(!pfnProgress((iLine + 1) / static_cast<double>(nYStop),
-                         "", pProgressArg) )
+    }
+    else
+    {
+        for (auto& p : asParams)
         {
-            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
-            return nullptr;
+            if (!ViewshedProcessObserver(p, oIO, oProgress))
+                return nullptr;
         }
     }
 
+    pfnProgress(1.0, "", pProgressArg);
+
     return GDALDataset::FromHandle(poDstDS.release());
 }
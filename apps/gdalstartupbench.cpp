@@ -0,0 +1,178 @@
+/******************************************************************************
+ *
+ * Project:  GDAL Utilities
+ * Purpose:  Benchmark of the driver registration and first open times.
+ *
+ ******************************************************************************
+ * Copyright (c) 2020, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "gdal.h"
+#include "cpl_conv.h"
+#include "cpl_string.h"
+#include "commonutils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+CPL_CVSID("$Id$")
+
+/************************************************************************/
+/*                               Usage()                                */
+/************************************************************************/
+
+static void Usage()
+{
+    printf("gdalstartupbench [-i <iterations>] [-mode lazy|eager|both]\n"
+           "                 [filename]\n"
+           "\n"
+           "Measures the time taken by GDALAllRegister(), and by the first\n"
+           "GDALOpenEx() of filename if specified, with the registration of\n"
+           "the drivers deferred to their first use (lazy) or not (eager).\n");
+    exit(1);
+}
+
+/************************************************************************/
+/*                               Timing                                 */
+/************************************************************************/
+
+struct Timing
+{
+    std::vector<double> adfRegister{};
+    std::vector<double> adfOpen{};
+    int                 nDrivers = 0;
+};
+
+static double Elapsed( std::chrono::steady_clock::time_point start )
+{
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+/************************************************************************/
+/*                              RunOnce()                               */
+/************************************************************************/
+
+static void RunOnce( bool bLazy, const char* pszFilename, Timing& oTiming )
+{
+    CPLSetConfigOption("GDAL_LAZY_DRIVER_REGISTRATION", bLazy ? "YES" : "NO");
+
+    auto start = std::chrono::steady_clock::now();
+    GDALAllRegister();
+    oTiming.adfRegister.push_back(Elapsed(start));
+    oTiming.nDrivers = GDALGetDriverCount();
+
+    if( pszFilename )
+    {
+        start = std::chrono::steady_clock::now();
+        GDALDatasetH hDS = GDALOpenEx(pszFilename, GDAL_OF_READONLY,
+                                      nullptr, nullptr, nullptr);
+        oTiming.adfOpen.push_back(Elapsed(start));
+        if( hDS == nullptr )
+        {
+            fprintf(stderr, "Cannot open %s\n", pszFilename);
+            exit(1);
+        }
+        GDALClose(hDS);
+    }
+
+    GDALDestroyDriverManager();
+}
+
+/************************************************************************/
+/*                               Report()                               */
+/************************************************************************/
+
+static void Report( const char* pszWhat, std::vector<double> adfValues )
+{
+    if( adfValues.empty() )
+        return;
+    std::sort(adfValues.begin(), adfValues.end());
+    printf("  %-16s min %9.3f ms  median %9.3f ms  max %9.3f ms\n",
+           pszWhat, adfValues.front(), adfValues[adfValues.size() / 2],
+           adfValues.back());
+}
+
+/************************************************************************/
+/*                                main()                                */
+/************************************************************************/
+
+MAIN_START(argc, argv)
+{
+    int nIterations = 10;
+    bool bLazy = true;
+    bool bEager = true;
+    const char* pszFilename = nullptr;
+
+    for( int i = 1; i < argc; i++ )
+    {
+        if( EQUAL(argv[i], "-i") && i + 1 < argc )
+        {
+            nIterations = std::max(1, atoi(argv[++i]));
+        }
+        else if( EQUAL(argv[i], "-mode") && i + 1 < argc )
+        {
+            ++i;
+            bLazy = EQUAL(argv[i], "lazy") || EQUAL(argv[i], "both");
+            bEager = EQUAL(argv[i], "eager") || EQUAL(argv[i], "both");
+            if( !bLazy && !bEager )
+                Usage();
+        }
+        else if( argv[i][0] == '-' || pszFilename != nullptr )
+        {
+            Usage();
+        }
+        else
+        {
+            pszFilename = argv[i];
+        }
+    }
+
+    Timing oLazy;
+    Timing oEager;
+    // Interleave the two modes so that they see the same cache state.
+    for( int iIter = 0; iIter < nIterations; iIter++ )
+    {
+        if( bLazy )
+            RunOnce(true, pszFilename, oLazy);
+        if( bEager )
+            RunOnce(false, pszFilename, oEager);
+    }
+    CPLSetConfigOption("GDAL_LAZY_DRIVER_REGISTRATION", nullptr);
+
+    printf("%d iterations\n", nIterations);
+    if( bLazy )
+    {
+        printf("Lazy registration (%d drivers):\n", oLazy.nDrivers);
+        Report("GDALAllRegister", oLazy.adfRegister);
+        Report("first open", oLazy.adfOpen);
+    }
+    if( bEager )
+    {
+        printf("Eager registration (%d drivers):\n", oEager.nDrivers);
+        Report("GDALAllRegister", oEager.adfRegister);
+        Report("first open", oEager.adfOpen);
+    }
+
+    return 0;
+}
+MAIN_END
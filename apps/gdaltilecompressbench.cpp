@@ -0,0 +1,342 @@
+/******************************************************************************
+ *
+ * Project:  GDAL Utilities
+ * Purpose:  Benchmark of the DEFLATE tile compression/decompression in GTiff.
+ *
+ ******************************************************************************
+ * Copyright (c) 2020, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "gdal.h"
+#include "cpl_conv.h"
+#include "cpl_string.h"
+#include "cpl_vsi.h"
+#include "commonutils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+CPL_CVSID("$Id$")
+
+/************************************************************************/
+/*                               Usage()                                */
+/************************************************************************/
+
+static void Usage()
+{
+    printf("gdaltilecompressbench [-i <iterations>] [-codec zlib|libdeflate|both]\n"
+           "                      [-zlevel <1-12>] [-blocksize <n>]\n"
+           "                      [-threads <n>|ALL_CPUS]\n"
+           "                      [-size <xsize> <ysize>] [-bands <n>]\n"
+           "                      [filename]\n"
+           "\n"
+           "Measures the throughput of writing and reading back a tiled\n"
+           "DEFLATE compressed GeoTIFF in /vsimem/, from filename or from\n"
+           "a synthetic Byte raster, with the zlib and/or libdeflate\n"
+           "backends of the ZIP codec.\n");
+    exit(1);
+}
+
+/************************************************************************/
+/*                               Timing                                 */
+/************************************************************************/
+
+struct Timing
+{
+    std::vector<double> adfWrite{};
+    std::vector<double> adfRead{};
+    vsi_l_offset        nCompressedSize = 0;
+};
+
+static double Elapsed( std::chrono::steady_clock::time_point start )
+{
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+/************************************************************************/
+/*                          CreateSynthetic()                           */
+/************************************************************************/
+
+// Smooth gradients with some noise, so that the data compresses roughly
+// like a real image rather than like a constant or a random buffer.
+static GDALDatasetH CreateSynthetic( int nXSize, int nYSize, int nBands )
+{
+    GDALDriverH hMemDrv = GDALGetDriverByName("MEM");
+    if( hMemDrv == nullptr )
+        return nullptr;
+    GDALDatasetH hDS = GDALCreate(hMemDrv, "", nXSize, nYSize, nBands,
+                                  GDT_Byte, nullptr);
+    if( hDS == nullptr )
+        return nullptr;
+
+    std::vector<GByte> abyLine(nXSize);
+    unsigned nSeed = 1;
+    for( int iBand = 1; iBand <= nBands; iBand++ )
+    {
+        GDALRasterBandH hBand = GDALGetRasterBand(hDS, iBand);
+        for( int iY = 0; iY < nYSize; iY++ )
+        {
+            for( int iX = 0; iX < nXSize; iX++ )
+            {
+                nSeed = nSeed * 1103515245U + 12345U;
+                abyLine[iX] = static_cast<GByte>(
+                    iX / 4 + iY / 8 + iBand * 32 + ((nSeed >> 16) & 7));
+            }
+            if( GDALRasterIO(hBand, GF_Write, 0, iY, nXSize, 1,
+                             abyLine.data(), nXSize, 1, GDT_Byte,
+                             0, 0) != CE_None )
+            {
+                GDALClose(hDS);
+                return nullptr;
+            }
+        }
+    }
+    return hDS;
+}
+
+/************************************************************************/
+/*                            WriteAndRead()                            */
+/************************************************************************/
+
+static bool WriteAndRead( GDALDatasetH hSrcDS, const char* pszTmpFilename,
+                          char** papszCreateOptions,
+                          std::vector<GByte>& abyBuffer, Timing& oTiming )
+{
+    GDALDriverH hGTiffDrv = GDALGetDriverByName("GTiff");
+    auto start = std::chrono::steady_clock::now();
+    GDALDatasetH hDS = GDALCreateCopy(hGTiffDrv, pszTmpFilename, hSrcDS,
+                                      FALSE, papszCreateOptions,
+                                      nullptr, nullptr);
+    if( hDS == nullptr )
+        return false;
+    GDALClose(hDS);
+    oTiming.adfWrite.push_back(Elapsed(start));
+
+    VSIStatBufL sStat;
+    if( VSIStatL(pszTmpFilename, &sStat) == 0 )
+        oTiming.nCompressedSize = sStat.st_size;
+
+    start = std::chrono::steady_clock::now();
+    hDS = GDALOpen(pszTmpFilename, GA_ReadOnly);
+    if( hDS == nullptr )
+        return false;
+    const int nXSize = GDALGetRasterXSize(hDS);
+    const int nYSize = GDALGetRasterYSize(hDS);
+    const int nBands = GDALGetRasterCount(hDS);
+    const CPLErr eErr = GDALDatasetRasterIO(hDS, GF_Read, 0, 0, nXSize, nYSize,
+                                            abyBuffer.data(), nXSize, nYSize,
+                                            GDT_Byte, nBands, nullptr,
+                                            0, 0, 0);
+    GDALClose(hDS);
+    oTiming.adfRead.push_back(Elapsed(start));
+
+    return eErr == CE_None;
+}
+
+/************************************************************************/
+/*                              RunOnce()                               */
+/************************************************************************/
+
+static bool RunOnce( GDALDatasetH hSrcDS, const char* pszSubCodec,
+                     char** papszCreateOptions, std::vector<GByte>& abyBuffer,
+                     Timing& oTiming )
+{
+    const char* pszTmpFilename = "/vsimem/gdaltilecompressbench.tif";
+    CPLSetConfigOption("GDAL_TIFF_DEFLATE_SUBCODEC", pszSubCodec);
+    const bool bRet = WriteAndRead(hSrcDS, pszTmpFilename, papszCreateOptions,
+                                   abyBuffer, oTiming);
+    CPLSetConfigOption("GDAL_TIFF_DEFLATE_SUBCODEC", nullptr);
+    VSIUnlink(pszTmpFilename);
+    return bRet;
+}
+
+/************************************************************************/
+/*                               Report()                               */
+/************************************************************************/
+
+static void Report( const char* pszWhat, std::vector<double> adfValues,
+                    double dfMegaBytes )
+{
+    if( adfValues.empty() )
+        return;
+    std::sort(adfValues.begin(), adfValues.end());
+    const double dfMedian = adfValues[adfValues.size() / 2];
+    printf("  %-6s min %9.3f ms  median %9.3f ms  max %9.3f ms"
+           "  (%.1f MB/s)\n",
+           pszWhat, adfValues.front(), dfMedian, adfValues.back(),
+           dfMedian > 0 ? dfMegaBytes * 1000.0 / dfMedian : 0.0);
+}
+
+/************************************************************************/
+/*                                main()                                */
+/************************************************************************/
+
+MAIN_START(argc, argv)
+{
+    int nIterations = 10;
+    bool bZLib = true;
+    bool bLibDeflate = true;
+    const char* pszZLevel = "6";
+    const char* pszThreads = "1";
+    int nBlockSize = 256;
+    int nXSize = 4096;
+    int nYSize = 4096;
+    int nBands = 1;
+    const char* pszFilename = nullptr;
+
+    for( int i = 1; i < argc; i++ )
+    {
+        if( EQUAL(argv[i], "-i") && i + 1 < argc )
+        {
+            nIterations = std::max(1, atoi(argv[++i]));
+        }
+        else if( EQUAL(argv[i], "-codec") && i + 1 < argc )
+        {
+            ++i;
+            bZLib = EQUAL(argv[i], "zlib") || EQUAL(argv[i], "both");
+            bLibDeflate = EQUAL(argv[i], "libdeflate") ||
+                          EQUAL(argv[i], "both");
+            if( !bZLib && !bLibDeflate )
+                Usage();
+        }
+        else if( EQUAL(argv[i], "-zlevel") && i + 1 < argc )
+        {
+            pszZLevel = argv[++i];
+        }
+        else if( EQUAL(argv[i], "-threads") && i + 1 < argc )
+        {
+            pszThreads = argv[++i];
+        }
+        else if( EQUAL(argv[i], "-blocksize") && i + 1 < argc )
+        {
+            nBlockSize = atoi(argv[++i]);
+            if( nBlockSize < 16 || (nBlockSize % 16) != 0 )
+                Usage();
+        }
+        else if( EQUAL(argv[i], "-size") && i + 2 < argc )
+        {
+            nXSize = atoi(argv[++i]);
+            nYSize = atoi(argv[++i]);
+            if( nXSize <= 0 || nYSize <= 0 )
+                Usage();
+        }
+        else if( EQUAL(argv[i], "-bands") && i + 1 < argc )
+        {
+            nBands = atoi(argv[++i]);
+            if( nBands <= 0 )
+                Usage();
+        }
+        else if( argv[i][0] == '-' || pszFilename != nullptr )
+        {
+            Usage();
+        }
+        else
+        {
+            pszFilename = argv[i];
+        }
+    }
+
+    GDALAllRegister();
+
+    GDALDatasetH hSrcDS = pszFilename
+        ? GDALOpen(pszFilename, GA_ReadOnly)
+        : CreateSynthetic(nXSize, nYSize, nBands);
+    if( hSrcDS == nullptr )
+    {
+        fprintf(stderr, "Cannot open %s\n",
+                pszFilename ? pszFilename : "synthetic dataset");
+        exit(1);
+    }
+    nXSize = GDALGetRasterXSize(hSrcDS);
+    nYSize = GDALGetRasterYSize(hSrcDS);
+    nBands = GDALGetRasterCount(hSrcDS);
+
+    char** papszCreateOptions = nullptr;
+    papszCreateOptions = CSLSetNameValue(papszCreateOptions, "TILED", "YES");
+    papszCreateOptions = CSLSetNameValue(papszCreateOptions,
+                                         "COMPRESS", "DEFLATE");
+    papszCreateOptions = CSLSetNameValue(papszCreateOptions,
+                                         "ZLEVEL", pszZLevel);
+    papszCreateOptions = CSLSetNameValue(papszCreateOptions,
+                                         "NUM_THREADS", pszThreads);
+    papszCreateOptions = CSLSetNameValue(papszCreateOptions, "BLOCKXSIZE",
+                                         CPLSPrintf("%d", nBlockSize));
+    papszCreateOptions = CSLSetNameValue(papszCreateOptions, "BLOCKYSIZE",
+                                         CPLSPrintf("%d", nBlockSize));
+
+    // The buffer holds the data read back as Byte.
+    std::vector<GByte> abyBuffer;
+    try
+    {
+        abyBuffer.resize(static_cast<size_t>(nXSize) * nYSize * nBands);
+    }
+    catch( const std::exception& )
+    {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+    const double dfMegaBytes = static_cast<double>(abyBuffer.size()) /
+                               (1024.0 * 1024.0);
+
+    Timing oZLib;
+    Timing oLibDeflate;
+    // Interleave the two backends so that they see the same cache state.
+    for( int iIter = 0; iIter < nIterations; iIter++ )
+    {
+        if( (bZLib &&
+             !RunOnce(hSrcDS, "ZLIB", papszCreateOptions, abyBuffer, oZLib)) ||
+            (bLibDeflate &&
+             !RunOnce(hSrcDS, "LIBDEFLATE", papszCreateOptions, abyBuffer,
+                      oLibDeflate)) )
+        {
+            fprintf(stderr, "Benchmark iteration failed\n");
+            exit(1);
+        }
+    }
+
+    printf("%d iterations, %dx%dx%d, %dx%d tiles, ZLEVEL=%s, "
+           "NUM_THREADS=%s\n",
+           nIterations, nXSize, nYSize, nBands, nBlockSize, nBlockSize,
+           pszZLevel, pszThreads);
+    if( bZLib )
+    {
+        printf("zlib (compressed size " CPL_FRMT_GUIB " bytes):\n",
+               static_cast<GUIntBig>(oZLib.nCompressedSize));
+        Report("write", oZLib.adfWrite, dfMegaBytes);
+        Report("read", oZLib.adfRead, dfMegaBytes);
+    }
+    if( bLibDeflate )
+    {
+        printf("libdeflate (compressed size " CPL_FRMT_GUIB " bytes):\n",
+               static_cast<GUIntBig>(oLibDeflate.nCompressedSize));
+        Report("write", oLibDeflate.adfWrite, dfMegaBytes);
+        Report("read", oLibDeflate.adfRead, dfMegaBytes);
+    }
+
+    CSLDestroy(papszCreateOptions);
+    GDALClose(hSrcDS);
+    GDALDestroyDriverManager();
+
+    return 0;
+}
+MAIN_END
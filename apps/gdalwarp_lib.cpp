@@ -2521,6 +2521,11 @@ GDALDatasetH GDALWarpDirect( const char *pszDest, GDALDatasetH hDstDS,
                                              hTransformArg, psOptions->dfErrorThreshold);
             pfnTransformer = GDALApproxTransform;
             GDALApproxTransformerOwnsSubtransformer(hTransformArg, TRUE);
+            // Optionally interpolate on a lattice of target pixels, which
+            // is reused by all chunks and threads.
+            GDALApproxTransformerSetGridStep(hTransformArg,
+                CPLAtof(CPLGetConfigOption(
+                    "GDAL_APPROX_TRANSFORMER_GRID_STEP", "0")));
         }
 
         psWO->pfnTransformer = pfnTransformer;
@@ -0,0 +1,151 @@
+#!/usr/bin/env pytest
+# -*- coding: utf-8 -*-
+###############################################################################
+#
+# Project:  GDAL/OGR Test Suite
+# Purpose:  Test drivers whose registration is deferred to their first use
+#           (GDAL_LAZY_DRIVER_REGISTRATION=YES)
+#
+###############################################################################
+# Copyright (c) 2020, GDAL contributors
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included
+# in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+# OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+# DEALINGS IN THE SOFTWARE.
+###############################################################################
+
+import os
+import subprocess
+import sys
+
+from osgeo import gdal
+
+import pytest
+
+# Drivers that GDALAllRegister() declares as deferred, and extension of the
+# test file created for each of them.
+DEFERRED_DRIVERS = [('GTiff', 'tif'), ('PNG', 'png'), ('JPEG', 'jpg'),
+                    ('GIF', 'gif'), ('BMP', 'bmp')]
+
+# Run in a fresh process, so that no deferred driver is loaded yet. All
+# threads are released at the same time to open the files of argv[2:], and
+# print the driver and checksum of the dataset they got.
+CHILD_SCRIPT = """
+import sys
+import threading
+from osgeo import gdal
+
+nThreadsPerFile = int(sys.argv[1])
+filenames = sys.argv[2:] * nThreadsPerFile
+barrier = threading.Barrier(len(filenames))
+results = [None] * len(filenames)
+
+def worker(i):
+    barrier.wait()
+    ds = gdal.OpenEx(filenames[i], gdal.OF_RASTER)
+    if ds is not None:
+        results[i] = '%s %s %d' % (filenames[i], ds.GetDriver().ShortName,
+                                   ds.GetRasterBand(1).Checksum())
+
+threads = [threading.Thread(target=worker, args=(i,))
+           for i in range(len(filenames))]
+for t in threads:
+    t.start()
+for t in threads:
+    t.join()
+for res in results:
+    print(res)
+"""
+
+
+def _create_files(tmp_path):
+    src_ds = gdal.GetDriverByName('MEM').Create('', 64, 48)
+    src_ds.GetRasterBand(1).Fill(0)
+    src_ds.GetRasterBand(1).WriteRaster(8, 8, 16, 16, b'\xff' * (16 * 16))
+    expected = {}
+    for driver_name, ext in DEFERRED_DRIVERS:
+        drv = gdal.GetDriverByName(driver_name)
+        if drv is None:
+            continue
+        filename = str(tmp_path / ('test.' + ext))
+        ds = drv.CreateCopy(filename, src_ds)
+        checksum = ds.GetRasterBand(1).Checksum()
+        ds = None
+        expected[filename] = '%s %s %d' % (filename, driver_name, checksum)
+    return expected
+
+
+def _run_child(filenames, nThreadsPerFile):
+    env = dict(os.environ)
+    env['GDAL_LAZY_DRIVER_REGISTRATION'] = 'YES'
+    env['CPL_DEBUG'] = 'ON'
+    proc = subprocess.run(
+        [sys.executable, '-c', CHILD_SCRIPT, str(nThreadsPerFile)] + filenames,
+        env=env, stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+        universal_newlines=True, check=True)
+    return proc.stdout.splitlines(), proc.stderr
+
+###############################################################################
+# Concurrent GDALOpenEx() on deferred drivers must load each of them once,
+# and return datasets attached to the registered driver.
+
+
+def test_deferred_driver_concurrent_open(tmp_path):
+
+    expected = _create_files(tmp_path)
+    if not expected:
+        pytest.skip('no deferred driver available')
+    filenames = sorted(expected)
+
+    nThreadsPerFile = 8
+    for _ in range(5):
+        lines, stderr = _run_child(filenames, nThreadsPerFile)
+        assert lines == [expected[f] for f in filenames] * nThreadsPerFile
+        for filename in filenames:
+            driver_name = expected[filename].split(' ')[1]
+            assert stderr.count('Loading deferred driver %s\n' %
+                                driver_name) <= 1, stderr
+
+###############################################################################
+# Metadata that is not declared, and creation, go to the real driver.
+
+
+def test_deferred_driver_metadata_and_create(tmp_path):
+
+    script = """
+import sys
+from osgeo import gdal
+drv = gdal.GetDriverByName('GTiff')
+assert drv.GetMetadataItem('DCAP_RASTER') == 'YES'
+assert 'COMPRESS' in drv.GetMetadataItem('DMD_CREATIONOPTIONLIST')
+ds = drv.Create(sys.argv[1], 10, 10)
+assert ds.GetDriver().ShortName == 'GTiff'
+ds = None
+assert drv.Delete(sys.argv[1]) == 0
+print('ok')
+"""
+    if gdal.GetDriverByName('GTiff') is None:
+        pytest.skip('GTiff driver missing')
+    env = dict(os.environ)
+    env['GDAL_LAZY_DRIVER_REGISTRATION'] = 'YES'
+    proc = subprocess.run(
+        [sys.executable, '-c', script, str(tmp_path / 'create.tif')],
+        env=env, stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+        universal_newlines=True)
+    assert proc.returncode == 0, proc.stderr
+    assert proc.stdout.strip() == 'ok'
+    assert not os.path.exists(str(tmp_path / 'create.tif'))
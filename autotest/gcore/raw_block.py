@@ -0,0 +1,148 @@
+#!/usr/bin/env pytest
+# -*- coding: utf-8 -*-
+###############################################################################
+#
+# Project:  GDAL/OGR Test Suite
+# Purpose:  Test the copy of stored (raw) blocks by
+#           GDALDatasetCopyWholeRaster(), without decoding them
+#
+###############################################################################
+# Copyright (c) 2020, GDAL contributors
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included
+# in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+# OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+# DEALINGS IN THE SOFTWARE.
+###############################################################################
+
+from osgeo import gdal
+
+import pytest
+
+
+pytestmark = pytest.mark.skipif(gdal.GetDriverByName('GTiff') is None,
+                                reason='GTiff driver missing')
+
+
+class _config_option(object):
+    """Sets a configuration option for the duration of a with block."""
+
+    def __init__(self, key, value):
+        self.key = key
+        self.value = value
+        self.old_value = None
+
+    def __enter__(self):
+        self.old_value = gdal.GetConfigOption(self.key)
+        gdal.SetConfigOption(self.key, self.value)
+
+    def __exit__(self, *args):
+        gdal.SetConfigOption(self.key, self.old_value)
+
+
+def _create_source(filename, options):
+    # Not a multiple of the block size, so that the last row and column of
+    # blocks are partial.
+    src_ds = gdal.GetDriverByName('MEM').Create('', 300, 200, 3)
+    for i in range(3):
+        data = bytes(((x * (i + 1) + y) % 251 for y in range(200)
+                      for x in range(300)))
+        src_ds.GetRasterBand(i + 1).WriteRaster(0, 0, 300, 200, data)
+    gdal.GetDriverByName('GTiff').CreateCopy(filename, src_ds,
+                                             options=options)
+
+
+def _copy(src_filename, dst_filename, options):
+    messages = []
+
+    def handler(err_class, err_no, msg):
+        if err_class == gdal.CE_Debug:
+            messages.append(msg)
+
+    src_ds = gdal.Open(src_filename)
+    with _config_option('CPL_DEBUG', 'ON'):
+        gdal.PushErrorHandler(handler)
+        try:
+            gdal.GetDriverByName('GTiff').CreateCopy(dst_filename, src_ds,
+                                                     options=options)
+        finally:
+            gdal.PopErrorHandler()
+    raw_copy = any('copying raw' in msg for msg in messages)
+    return src_ds, gdal.Open(dst_filename), raw_copy
+
+
+def _block_sizes(ds):
+    band = ds.GetRasterBand(1)
+    block_xsize, block_ysize = band.GetBlockSize()
+    nx = (ds.RasterXSize + block_xsize - 1) // block_xsize
+    ny = (ds.RasterYSize + block_ysize - 1) // block_ysize
+    return [band.GetMetadataItem('BLOCK_SIZE_%d_%d' % (x, y), 'TIFF')
+            for y in range(ny) for x in range(nx)]
+
+
+def _checksums(ds):
+    return [ds.GetRasterBand(i + 1).Checksum() for i in range(ds.RasterCount)]
+
+###############################################################################
+# Same storage: the stored blocks are copied as they are, including the
+# partial ones, and for band and pixel interleaving, tiles and strips.
+
+
+@pytest.mark.parametrize('options', [
+    ['TILED=YES', 'BLOCKXSIZE=128', 'BLOCKYSIZE=128', 'COMPRESS=DEFLATE'],
+    ['TILED=YES', 'BLOCKXSIZE=128', 'BLOCKYSIZE=128', 'COMPRESS=LZW',
+     'PREDICTOR=2', 'INTERLEAVE=BAND'],
+    ['BLOCKYSIZE=64', 'COMPRESS=DEFLATE', 'INTERLEAVE=PIXEL'],
+    ['BLOCKYSIZE=64', 'COMPRESS=PACKBITS', 'INTERLEAVE=BAND'],
+])
+def test_raw_block_copy_same_codec(tmp_path, options):
+
+    src_filename = str(tmp_path / 'src.tif')
+    dst_filename = str(tmp_path / 'dst.tif')
+    _create_source(src_filename, options)
+
+    src_ds, dst_ds, raw_copy = _copy(src_filename, dst_filename, options)
+    assert raw_copy
+    assert _checksums(dst_ds) == _checksums(src_ds)
+    assert _block_sizes(dst_ds) == _block_sizes(src_ds)
+
+###############################################################################
+# Different codec information: the blocks are decoded and encoded again,
+# and the result is the same as without raw copy.
+
+
+@pytest.mark.parametrize('src_options,dst_options', [
+    (['TILED=YES', 'COMPRESS=DEFLATE', 'PREDICTOR=2'],
+     ['TILED=YES', 'COMPRESS=DEFLATE']),
+    (['TILED=YES', 'COMPRESS=DEFLATE'],
+     ['TILED=YES', 'COMPRESS=LZW']),
+    (['BLOCKYSIZE=64', 'COMPRESS=DEFLATE', 'INTERLEAVE=PIXEL'],
+     ['BLOCKYSIZE=64', 'COMPRESS=DEFLATE', 'INTERLEAVE=BAND']),
+])
+def test_raw_block_copy_codec_mismatch(tmp_path, src_options, dst_options):
+
+    src_filename = str(tmp_path / 'src.tif')
+    dst_filename = str(tmp_path / 'dst.tif')
+    ref_filename = str(tmp_path / 'ref.tif')
+    _create_source(src_filename, src_options)
+
+    src_ds, dst_ds, raw_copy = _copy(src_filename, dst_filename, dst_options)
+    assert not raw_copy
+    assert _checksums(dst_ds) == _checksums(src_ds)
+
+    with _config_option('GDAL_COPY_WHOLE_RASTER_STREAMING', 'NO'):
+        _, ref_ds, _ = _copy(src_filename, ref_filename, dst_options)
+    assert _block_sizes(dst_ds) == _block_sizes(ref_ds)
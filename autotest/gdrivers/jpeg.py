@@ -0,0 +1,142 @@
+#!/usr/bin/env pytest
+# -*- coding: utf-8 -*-
+###############################################################################
+#
+# Project:  GDAL/OGR Test Suite
+# Purpose:  Test the multi-threaded decoding of JPEG files with restart
+#           markers
+#
+###############################################################################
+# Copyright (c) 2020, GDAL contributors
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included
+# in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+# OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+# DEALINGS IN THE SOFTWARE.
+###############################################################################
+
+import os
+
+from osgeo import gdal
+
+import pytest
+
+
+pytestmark = pytest.mark.skipif(gdal.GetDriverByName('JPEG') is None,
+                                reason='JPEG driver missing')
+
+# 300x250 RGB baseline JPEG, YCbCr with 4:2:0 subsampling (16x16 MCUs), with
+# a restart marker after each row of MCUs. The last row of MCUs is partial.
+RESTART_420 = os.path.join(os.path.dirname(__file__), 'data',
+                           'restart_420.jpg')
+
+
+def _read(filename, num_threads, window=None, band_list=None,
+          interleave='band'):
+    gdal.SetConfigOption('GDAL_NUM_THREADS', num_threads)
+    try:
+        ds = gdal.Open(filename)
+        if window is None:
+            window = (0, 0, ds.RasterXSize, ds.RasterYSize)
+        kwargs = {}
+        if interleave == 'pixel':
+            kwargs = {'buf_pixel_space': 3, 'buf_line_space': 3 * window[2],
+                      'buf_band_space': 1}
+        return ds.ReadRaster(window[0], window[1], window[2], window[3],
+                             band_list=band_list, **kwargs)
+    finally:
+        gdal.SetConfigOption('GDAL_NUM_THREADS', None)
+
+###############################################################################
+# Decoding the restart intervals in parallel gives the same bytes as the
+# sequential decoding, including at the boundaries of the strips where the
+# vertical chroma upsampling needs the neighbouring rows.
+
+
+@pytest.mark.parametrize('num_threads', ['2', '3', '4', 'ALL_CPUS'])
+@pytest.mark.parametrize('window', [
+    None,
+    (0, 0, 300, 250),
+    (17, 5, 250, 200),     # does not start or end on a row of MCUs
+    (0, 31, 300, 34),      # spans three rows of MCUs
+    (299, 0, 1, 250),
+])
+def test_jpeg_restart_parallel_same_as_sequential(num_threads, window):
+
+    expected = _read(RESTART_420, '1', window)
+    assert expected is not None
+    assert _read(RESTART_420, num_threads, window) == expected
+
+###############################################################################
+# Same with a band subset and pixel interleaved buffers.
+
+
+@pytest.mark.parametrize('band_list,interleave', [
+    ([1, 2, 3], 'pixel'),
+    ([3, 1], 'band'),
+    ([2], 'band'),
+])
+def test_jpeg_restart_parallel_band_layouts(band_list, interleave):
+
+    expected = _read(RESTART_420, '1', band_list=band_list,
+                     interleave=interleave)
+    assert expected is not None
+    assert _read(RESTART_420, '4', band_list=band_list,
+                 interleave=interleave) == expected
+
+###############################################################################
+# Thread-local configuration options of the caller apply to the decoding
+# threads: with GDAL_ERROR_ON_LIBJPEG_WARNING set in the calling thread only,
+# a corrupted restart interval is handled the same way in both modes, and
+# the errors are reported in the calling thread.
+
+
+def test_jpeg_restart_parallel_thread_local_options(tmp_path):
+
+    data = bytearray(open(RESTART_420, 'rb').read())
+    # Corrupt the entropy coded data just before the 8th restart marker.
+    markers = [i for i in range(len(data) - 1)
+               if data[i] == 0xFF and 0xD0 <= data[i + 1] <= 0xD7]
+    pos = markers[7]
+    data[pos - 40:pos] = b'\x55' * 40
+    filename = str(tmp_path / 'corrupted.jpg')
+    open(filename, 'wb').write(bytes(data))
+
+    def read_with_errors(num_threads):
+        errors = []
+
+        def handler(err_class, err_no, msg):
+            if err_class in (gdal.CE_Warning, gdal.CE_Failure):
+                errors.append(err_class)
+
+        gdal.SetThreadLocalConfigOption('GDAL_ERROR_ON_LIBJPEG_WARNING',
+                                        'YES')
+        gdal.PushErrorHandler(handler)
+        try:
+            res = _read(filename, num_threads)
+        finally:
+            gdal.PopErrorHandler()
+            gdal.SetThreadLocalConfigOption('GDAL_ERROR_ON_LIBJPEG_WARNING',
+                                            None)
+        return res, errors
+
+    expected, expected_errors = read_with_errors('1')
+    res, errors = read_with_errors('4')
+    assert (res is None) == (expected is None)
+    if expected_errors:
+        assert errors
+        assert (gdal.CE_Failure in errors) == \
+            (gdal.CE_Failure in expected_errors)
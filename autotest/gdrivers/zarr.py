@@ -0,0 +1,347 @@
+#!/usr/bin/env pytest
+# -*- coding: utf-8 -*-
+###############################################################################
+#
+# Project:  GDAL/OGR Test Suite
+# Purpose:  Test Zarr driver
+#
+###############################################################################
+# Copyright (c) 2020, GDAL contributors
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included
+# in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+# OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+# DEALINGS IN THE SOFTWARE.
+###############################################################################
+
+import array
+import gzip
+import json
+import math
+import os
+import struct
+import zlib
+
+from osgeo import gdal
+
+import pytest
+
+pytestmark = pytest.mark.skipif(gdal.GetDriverByName('Zarr') is None,
+                                reason='Zarr driver missing')
+
+# Int16 test array of 20x30 values, split in 3x2 chunks of 8x16, so that the
+# last chunk of each dimension is partial.
+SHAPE = (20, 30)
+CHUNKS = (8, 16)
+VALUES = [y * 100 + x - 1000 for y in range(SHAPE[0]) for x in range(SHAPE[1])]
+
+
+def _has_zstd():
+    options = gdal.GetDriverByName('Zarr').GetMetadataItem(
+        'DMD_MULTIDIM_ARRAY_CREATIONOPTIONLIST')
+    return options is not None and 'ZSTD' in options
+
+
+def _native_bytes(typecode, values):
+    return array.array(typecode, values).tobytes()
+
+
+def _unpack_native(typecode, data):
+    return array.array(typecode, bytes(data)).tolist()
+
+
+def _compress(compressor, data):
+    if compressor is None:
+        return data
+    if compressor == 'zlib':
+        return zlib.compress(data)
+    assert compressor == 'gzip'
+    return gzip.compress(data)
+
+
+def _decompress(compressor, data):
+    if compressor is None:
+        return data
+    if compressor == 'zlib':
+        return zlib.decompress(data)
+    assert compressor == 'gzip'
+    return gzip.decompress(data)
+
+
+def _chunk_values(values, shape, chunks, chunk_idx, order, fill_value):
+    """ Return the values of a full chunk, in C or F order """
+    y0 = chunk_idx[0] * chunks[0]
+    x0 = chunk_idx[1] * chunks[1]
+
+    def value(j, i):
+        if y0 + j >= shape[0] or x0 + i >= shape[1]:
+            return fill_value
+        return values[(y0 + j) * shape[1] + x0 + i]
+
+    if order == 'C':
+        return [value(j, i) for j in range(chunks[0]) for i in range(chunks[1])]
+    return [value(j, i) for i in range(chunks[1]) for j in range(chunks[0])]
+
+
+def _write_zarr(root, zarray, chunk_files=None):
+    """ Write a Zarr group with a single 'ar' array made of the .zarray
+        dictionary and of the {chunk_key: bytes} chunk files """
+    os.mkdir(root)
+    with open(os.path.join(root, '.zgroup'), 'wt') as f:
+        json.dump({'zarr_format': 2}, f)
+    ar_dir = os.path.join(root, 'ar')
+    os.mkdir(ar_dir)
+    with open(os.path.join(ar_dir, '.zarray'), 'wt') as f:
+        json.dump(zarray, f)
+    with open(os.path.join(ar_dir, '.zattrs'), 'wt') as f:
+        json.dump({'_ARRAY_DIMENSIONS': ['y', 'x'][2 - len(zarray['shape']):]},
+                  f)
+    for key, data in (chunk_files or {}).items():
+        filename = os.path.join(ar_dir, key)
+        if not os.path.exists(os.path.dirname(filename)):
+            os.makedirs(os.path.dirname(filename))
+        with open(filename, 'wb') as f:
+            f.write(data)
+    return ar_dir
+
+
+def _zarray(dtype, shape, chunks, compressor, fill_value,
+            order='C', dimension_separator='.'):
+    return {'zarr_format': 2,
+            'shape': list(shape),
+            'chunks': list(chunks),
+            'dtype': dtype,
+            'compressor': {'id': compressor} if compressor else None,
+            'fill_value': fill_value,
+            'filters': None,
+            'order': order,
+            'dimension_separator': dimension_separator}
+
+
+def _open_array(root, update=False):
+    flags = gdal.OF_MULTIDIM_RASTER
+    if update:
+        flags |= gdal.OF_UPDATE
+    ds = gdal.OpenEx(root, flags)
+    assert ds is not None
+    ar = ds.GetRootGroup().OpenMDArray('ar')
+    assert ar is not None
+    return ds, ar
+
+###############################################################################
+# Create arrays with each compressor, and read them back.
+
+
+@pytest.mark.parametrize('compress', ['NONE', 'ZLIB', 'GZIP', 'ZSTD'])
+def test_zarr_create_and_read(tmp_path, compress):
+
+    if compress == 'ZSTD' and not _has_zstd():
+        pytest.skip('ZSTD not available')
+
+    root = str(tmp_path / 'test.zarr')
+    ds = gdal.GetDriverByName('Zarr').CreateMultiDimensional(root)
+    assert ds is not None
+    rg = ds.GetRootGroup()
+    dimY = rg.CreateDimension('y', None, None, SHAPE[0])
+    dimX = rg.CreateDimension('x', None, None, SHAPE[1])
+    ar = rg.CreateMDArray('ar', [dimY, dimX],
+                          gdal.ExtendedDataType.Create(gdal.GDT_Int16),
+                          ['BLOCKSIZE=%d,%d' % CHUNKS,
+                           'COMPRESS=' + compress])
+    assert ar is not None
+    assert ar.Write(_native_bytes('h', VALUES)) == gdal.CE_None
+    ar = None
+    rg = None
+    ds = None
+
+    with open(str(tmp_path / 'test.zarr' / 'ar' / '.zarray')) as f:
+        zarray = json.load(f)
+    assert zarray['order'] == 'C'
+    assert zarray['dtype'] == '<i2'
+    assert zarray['chunks'] == list(CHUNKS)
+    if compress == 'NONE':
+        assert zarray['compressor'] is None
+    else:
+        assert zarray['compressor']['id'] == compress.lower()
+    assert sorted(os.listdir(str(tmp_path / 'test.zarr' / 'ar'))) == \
+        ['.zarray', '.zattrs', '0.0', '0.1', '1.0', '1.1', '2.0', '2.1']
+
+    if compress != 'ZSTD':
+        compressor = None if compress == 'NONE' else compress.lower()
+        with open(str(tmp_path / 'test.zarr' / 'ar' / '1.1'), 'rb') as f:
+            data = _decompress(compressor, f.read())
+        assert list(struct.unpack('<%dh' % (CHUNKS[0] * CHUNKS[1]), data)) == \
+            _chunk_values(VALUES, SHAPE, CHUNKS, (1, 1), 'C', 0)
+
+    ds, ar = _open_array(root)
+    assert [dim.GetName() for dim in ar.GetDimensions()] == ['y', 'x']
+    assert ar.GetDataType().GetNumericDataType() == gdal.GDT_Int16
+    assert _unpack_native('h', ar.Read()) == VALUES
+
+###############################################################################
+# Read and update arrays in C and F order, with the '.' and '/' dimension
+# separators, and each compressor.
+
+
+@pytest.mark.parametrize('order', ['C', 'F'])
+@pytest.mark.parametrize('dimension_separator', ['.', '/'])
+@pytest.mark.parametrize('compressor', [None, 'zlib', 'gzip', 'zstd'])
+def test_zarr_order_and_dimension_separator(tmp_path, order,
+                                            dimension_separator, compressor):
+
+    if compressor == 'zstd' and not _has_zstd():
+        pytest.skip('ZSTD not available')
+
+    # zstd is not available from the Python standard library: the chunks are
+    # only written by GDAL in that case.
+    chunk_files = {}
+    if compressor != 'zstd':
+        for cy in range(3):
+            for cx in range(2):
+                values = _chunk_values(VALUES, SHAPE, CHUNKS, (cy, cx),
+                                       order, -1)
+                data = struct.pack('<%dh' % len(values), *values)
+                key = '%d%s%d' % (cy, dimension_separator, cx)
+                chunk_files[key] = _compress(compressor, data)
+
+    root = str(tmp_path / 'test.zarr')
+    ar_dir = _write_zarr(root,
+                         _zarray('<i2', SHAPE, CHUNKS, compressor, -1,
+                                 order, dimension_separator),
+                         chunk_files)
+
+    if chunk_files:
+        ds, ar = _open_array(root)
+        assert ar.GetNoDataValueAsDouble() == -1
+        assert _unpack_native('h', ar.Read()) == VALUES
+        # Window that crosses chunk boundaries
+        data = ar.Read(array_start_idx=[5, 10], count=[10, 12])
+        assert _unpack_native('h', data) == \
+            [VALUES[y * SHAPE[1] + x]
+             for y in range(5, 15) for x in range(10, 22)]
+        ar = None
+        ds = None
+
+    # Overwrite the array with new values
+    new_values = [-v for v in VALUES]
+    ds, ar = _open_array(root, update=True)
+    assert ar.Write(_native_bytes('h', new_values)) == gdal.CE_None
+    ar = None
+    ds = None
+
+    with open(os.path.join(ar_dir, '.zarray')) as f:
+        zarray = json.load(f)
+    assert zarray['order'] == order
+    assert zarray.get('dimension_separator', '.') == dimension_separator
+
+    if dimension_separator == '/':
+        assert sorted(os.listdir(ar_dir)) == \
+            ['.zarray', '.zattrs', '0', '1', '2']
+        assert sorted(os.listdir(os.path.join(ar_dir, '2'))) == ['0', '1']
+    else:
+        assert sorted(os.listdir(ar_dir)) == \
+            ['.zarray', '.zattrs', '0.0', '0.1', '1.0', '1.1', '2.0', '2.1']
+
+    if compressor != 'zstd':
+        key = '2%s1' % dimension_separator
+        with open(os.path.join(ar_dir, key), 'rb') as f:
+            data = _decompress(compressor, f.read())
+        # The part of the last chunk that is outside of the array is set to
+        # the fill value.
+        assert list(struct.unpack('<%dh' % (CHUNKS[0] * CHUNKS[1]), data)) == \
+            _chunk_values(new_values, SHAPE, CHUNKS, (2, 1), order, -1)
+
+    ds, ar = _open_array(root)
+    assert _unpack_native('h', ar.Read()) == new_values
+
+###############################################################################
+# Read and write a big-endian array.
+
+
+@pytest.mark.parametrize('compressor', [None, 'zlib'])
+def test_zarr_byte_swapped_dtype(tmp_path, compressor):
+
+    shape = (3, 4)
+    chunks = (2, 4)
+    values = [-32768, -256, -1, 0, 1, 255, 256, 1000, 32767, -12345, 4660, 7]
+
+    chunk_files = {}
+    for cy in range(2):
+        chunk_values = _chunk_values(values, shape, chunks, (cy, 0), 'C', 0)
+        data = struct.pack('>%dh' % len(chunk_values), *chunk_values)
+        chunk_files['%d.0' % cy] = _compress(compressor, data)
+
+    root = str(tmp_path / 'test.zarr')
+    ar_dir = _write_zarr(root, _zarray('>i2', shape, chunks, compressor, 0),
+                         chunk_files)
+
+    ds, ar = _open_array(root)
+    assert ar.GetDataType().GetNumericDataType() == gdal.GDT_Int16
+    assert _unpack_native('h', ar.Read()) == values
+    ar = None
+    ds = None
+
+    new_values = values[::-1]
+    ds, ar = _open_array(root, update=True)
+    assert ar.Write(_native_bytes('h', new_values)) == gdal.CE_None
+    ar = None
+    ds = None
+
+    with open(os.path.join(ar_dir, '.zarray')) as f:
+        assert json.load(f)['dtype'] == '>i2'
+    with open(os.path.join(ar_dir, '0.0'), 'rb') as f:
+        data = _decompress(compressor, f.read())
+    assert list(struct.unpack('>8h', data)) == new_values[0:8]
+
+    ds, ar = _open_array(root)
+    assert _unpack_native('h', ar.Read()) == new_values
+
+###############################################################################
+# Read NaN and infinite fill values. Missing chunks are read as the fill
+# value.
+
+
+@pytest.mark.parametrize('dtype,typecode', [('<f4', 'f'), ('>f8', 'd')])
+@pytest.mark.parametrize('fill_value', ['NaN', 'Infinity', '-Infinity'])
+def test_zarr_nan_and_infinity_fill_value(tmp_path, dtype, typecode,
+                                          fill_value):
+
+    shape = (4, 5)
+    chunks = (2, 5)
+    values = [0.5 * i - 2 for i in range(10)]
+    # Only the first chunk is written
+    chunk_files = {'0.0': struct.pack(dtype[0] + '10' + typecode, *values)}
+
+    root = str(tmp_path / 'test.zarr')
+    _write_zarr(root, _zarray(dtype, shape, chunks, None, fill_value),
+                chunk_files)
+
+    expected_fill = float(fill_value.lower().replace('infinity', 'inf'))
+
+    ds, ar = _open_array(root)
+    nodata = ar.GetNoDataValueAsDouble()
+    if math.isnan(expected_fill):
+        assert math.isnan(nodata)
+    else:
+        assert nodata == expected_fill
+
+    data = _unpack_native(typecode, ar.Read())
+    assert data[0:10] == values
+    for v in data[10:]:
+        if math.isnan(expected_fill):
+            assert math.isnan(v)
+        else:
+            assert v == expected_fill
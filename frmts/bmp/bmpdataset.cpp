@@ -1592,6 +1592,23 @@ GDALDataset *BMPDataset::Create( const char * pszFilename,
     return (GDALDataset *) poDS;
 }
 
+/************************************************************************/
+/*                   GDALGetDeclaredMetadata_BMP()                    */
+/************************************************************************/
+
+// Items that GDALAllRegister() declares for the driver before registering it.
+CSLConstList GDALGetDeclaredMetadata_BMP()
+{
+    static const char* const apszMD[] = {
+        GDAL_DCAP_OPEN "=YES",
+        GDAL_DCAP_RASTER "=YES",
+        GDAL_DMD_LONGNAME "=MS Windows Device Independent Bitmap",
+        GDAL_DMD_EXTENSION "=bmp",
+        GDAL_DMD_OPEN_SIGNATURES "=0:424D",
+        nullptr };
+    return apszMD;
+}
+
 /************************************************************************/
 /*                        GDALRegister_BMP()                            */
 /************************************************************************/
@@ -1605,12 +1622,10 @@ void GDALRegister_BMP()
     GDALDriver *poDriver = new GDALDriver();
 
     poDriver->SetDescription( "BMP" );
-    poDriver->SetMetadataItem( GDAL_DCAP_RASTER, "YES" );
-    poDriver->SetMetadataItem( GDAL_DMD_LONGNAME,
-                               "MS Windows Device Independent Bitmap" );
+    poDriver->SetMetadata(
+        const_cast<char**>(GDALGetDeclaredMetadata_BMP()) );
     poDriver->SetMetadataItem( GDAL_DMD_HELPTOPIC,
                                "drivers/raster/bmp.html" );
-    poDriver->SetMetadataItem( GDAL_DMD_EXTENSION, "bmp" );
     poDriver->SetMetadataItem( GDAL_DMD_CREATIONDATATYPES, "Byte" );
     poDriver->SetMetadataItem( GDAL_DMD_CREATIONOPTIONLIST,
 "<CreationOptionList>"
@@ -42,6 +42,27 @@ CPL_CVSID("$Id: gdalallregister.cpp fa9cbb747c2bf17876167ed747fd7e7757f8fc29 202
 static char *szConfiguredFormats = "GDAL_FORMATS";
 #endif
 
+/************************************************************************/
+/*                       GDALRegisterMaybeDeferred()                    */
+/*                                                                      */
+/*      Register a driver, or only declare it so that its registration  */
+/*      function is run the first time it is needed.                    */
+/************************************************************************/
+
+#if defined(FRMT_gtiff) || defined(FRMT_png) || defined(FRMT_jpeg) || \
+    defined(FRMT_gif) || defined(FRMT_bmp) || defined(FRMT_webp)
+static void GDALRegisterMaybeDeferred( bool bDeferred, const char* pszName,
+                                       void (*pfnRegister)(void),
+                                       const char* const* papszMetadata )
+{
+    if( bDeferred )
+        GetGDALDriverManager()->DeclareDeferredDriver(
+            pszName, pfnRegister, papszMetadata);
+    else
+        pfnRegister();
+}
+#endif
+
 /************************************************************************/
 /*                          GDALAllRegister()                           */
 /*                                                                      */
@@ -57,6 +78,11 @@ static char *szConfiguredFormats = "GDAL_FORMATS";
  *
  * This function should generally be called once at the beginning of the
  * application.
+ *
+ * Starting with GDAL 3.1, the registration of a few drivers whose setup is
+ * costly (GTiff, COG, PNG, JPEG, GIF, BIGGIF, BMP, WEBP) can be deferred to
+ * their first use by setting the GDAL_LAZY_DRIVER_REGISTRATION configuration
+ * option to YES. See GDALDriverManager::DeclareDeferredDriver().
  */
 
 void CPL_STDCALL GDALAllRegister()
@@ -65,14 +91,20 @@ void CPL_STDCALL GDALAllRegister()
     // AutoLoadDrivers is a no-op if compiled with GDAL_NO_AUTOLOAD defined.
     GetGDALDriverManager()->AutoLoadDrivers();
 
+    const bool bDeferred =
+        CPLTestBool(CPLGetConfigOption("GDAL_LAZY_DRIVER_REGISTRATION", "NO"));
+    CPL_IGNORE_RET_VAL(bDeferred);
+
 #ifdef FRMT_vrt
     GDALRegister_VRT();
     GDALRegister_Derived();
 #endif
 
 #ifdef FRMT_gtiff
-    GDALRegister_GTiff();
-    GDALRegister_COG();
+    GDALRegisterMaybeDeferred(bDeferred, "GTiff", GDALRegister_GTiff,
+                              GDALGetDeclaredMetadata_GTiff());
+    GDALRegisterMaybeDeferred(bDeferred, "COG", GDALRegister_COG,
+                              GDALGetDeclaredMetadata_COG());
 #endif
 
 #ifdef FRMT_nitf
@@ -125,7 +157,8 @@ void CPL_STDCALL GDALAllRegister()
 #endif
 
 #ifdef FRMT_png
-    GDALRegister_PNG();
+    GDALRegisterMaybeDeferred(bDeferred, "PNG", GDALRegister_PNG,
+                              GDALGetDeclaredMetadata_PNG());
 #endif
 
 #ifdef FRMT_dds
@@ -137,7 +170,8 @@ void CPL_STDCALL GDALAllRegister()
 #endif
 
 #ifdef FRMT_jpeg
-    GDALRegister_JPEG();
+    GDALRegisterMaybeDeferred(bDeferred, "JPEG", GDALRegister_JPEG,
+                              GDALGetDeclaredMetadata_JPEG());
 #endif
 
 #ifdef FRMT_mem
@@ -153,8 +187,10 @@ void CPL_STDCALL GDALAllRegister()
 #endif
 
 #ifdef FRMT_gif
-    GDALRegister_GIF();
-    GDALRegister_BIGGIF();
+    GDALRegisterMaybeDeferred(bDeferred, "GIF", GDALRegister_GIF,
+                              GDALGetDeclaredMetadata_GIF());
+    GDALRegisterMaybeDeferred(bDeferred, "BIGGIF", GDALRegister_BIGGIF,
+                              GDALGetDeclaredMetadata_GIF());
 #endif
 
 #ifdef FRMT_envisat
@@ -174,7 +210,8 @@ void CPL_STDCALL GDALAllRegister()
 #endif
 
 #ifdef FRMT_bmp
-    GDALRegister_BMP();
+    GDALRegisterMaybeDeferred(bDeferred, "BMP", GDALRegister_BMP,
+                              GDALGetDeclaredMetadata_BMP());
 #endif
 
 #ifdef FRMT_dimap
@@ -366,7 +403,8 @@ void CPL_STDCALL GDALAllRegister()
 #endif
 
 #ifdef FRMT_webp
-    GDALRegister_WEBP();
+    GDALRegisterMaybeDeferred(bDeferred, "WEBP", GDALRegister_WEBP,
+                              GDALGetDeclaredMetadata_WEBP());
 #endif
 
 #ifdef FRMT_pdf
@@ -550,6 +588,10 @@ void CPL_STDCALL GDALAllRegister()
     GDALRegister_ZMap();
 #endif
 
+#ifdef FRMT_zarr
+    GDALRegister_Zarr();
+#endif
+
 #ifdef FRMT_ngsgeoid
     GDALRegister_NGSGEOID();
 #endif
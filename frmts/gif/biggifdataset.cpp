@@ -383,12 +383,11 @@ void GDALRegister_BIGGIF()
      GDALDriver *poDriver = new GDALDriver();
 
      poDriver->SetDescription( "BIGGIF" );
-     poDriver->SetMetadataItem( GDAL_DCAP_RASTER, "YES" );
-     poDriver->SetMetadataItem( GDAL_DMD_LONGNAME,
-                                "Graphics Interchange Format (.gif)" );
+     // Same declared items as the GIF driver.
+     poDriver->SetMetadata(
+         const_cast<char**>(GDALGetDeclaredMetadata_GIF()) );
      poDriver->SetMetadataItem( GDAL_DMD_HELPTOPIC,
                                 "drivers/raster/gif.html" );
-     poDriver->SetMetadataItem( GDAL_DMD_EXTENSION, "gif" );
      poDriver->SetMetadataItem( GDAL_DMD_MIMETYPE, "image/gif" );
      poDriver->SetMetadataItem( GDAL_DCAP_VIRTUALIO, "YES" );
 
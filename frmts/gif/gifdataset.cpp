@@ -697,6 +697,23 @@ error:
     return nullptr;
 }
 
+/************************************************************************/
+/*                   GDALGetDeclaredMetadata_GIF()                    */
+/************************************************************************/
+
+// Items that GDALAllRegister() declares for the driver before registering it.
+CSLConstList GDALGetDeclaredMetadata_GIF()
+{
+    static const char* const apszMD[] = {
+        GDAL_DCAP_OPEN "=YES",
+        GDAL_DCAP_RASTER "=YES",
+        GDAL_DMD_LONGNAME "=Graphics Interchange Format (.gif)",
+        GDAL_DMD_EXTENSION "=gif",
+        GDAL_DMD_OPEN_SIGNATURES "=0:474946383761 0:474946383961",
+        nullptr };
+    return apszMD;
+}
+
 /************************************************************************/
 /*                          GDALRegister_GIF()                          */
 /************************************************************************/
@@ -710,11 +727,9 @@ void GDALRegister_GIF()
     GDALDriver *poDriver = new GDALDriver();
 
     poDriver->SetDescription( "GIF" );
-    poDriver->SetMetadataItem( GDAL_DCAP_RASTER, "YES" );
-    poDriver->SetMetadataItem( GDAL_DMD_LONGNAME,
-                               "Graphics Interchange Format (.gif)" );
+    poDriver->SetMetadata(
+        const_cast<char**>(GDALGetDeclaredMetadata_GIF()) );
     poDriver->SetMetadataItem( GDAL_DMD_HELPTOPIC, "drivers/raster/gif.html" );
-    poDriver->SetMetadataItem( GDAL_DMD_EXTENSION, "gif" );
     poDriver->SetMetadataItem( GDAL_DMD_MIMETYPE, "image/gif" );
     poDriver->SetMetadataItem( GDAL_DMD_CREATIONDATATYPES, "Byte" );
 
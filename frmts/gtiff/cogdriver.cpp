@@ -33,12 +33,12 @@
 #include "gdalwarper.h"
 #include "cogdriver.h"
 #include "geotiff.h"
+#include "gdal_frmts.h"
 
 #include <algorithm>
 #include <memory>
 #include <vector>
 
-extern "C" CPL_DLL void GDALRegister_COG();
 
 /************************************************************************/
 /*                        HasZSTDCompression()                          */
@@ -587,10 +587,46 @@ GDALDataset* GDALCOGCreator::Create(const char * pszFilename,
             double(nXSize) * nYSize * (nBands + (bHasMask ? 1 : 0)) * 4. / 3;
     }
 
+    CPLString osPredictor;
+    const char* pszPredictor = CSLFetchNameValueDef(papszOptions, "PREDICTOR", "FALSE");
+    if( EQUAL(pszPredictor, "YES") || EQUAL(pszPredictor, "ON") || EQUAL(pszPredictor, "TRUE") )
+    {
+        if( GDALDataTypeIsFloating(poSrcDS->GetRasterBand(1)->GetRasterDataType()) )
+            osPredictor = "3";
+        else
+            osPredictor = "2";
+    }
+    else if( EQUAL(pszPredictor, "STANDARD") || EQUAL(pszPredictor, "2") )
+    {
+        osPredictor = "2";
+    }
+    else if( EQUAL(pszPredictor, "FLOATING_POINT") || EQUAL(pszPredictor, "3") )
+    {
+        osPredictor = "3";
+    }
+
+    // With a lossless compression, the temporary overviews are generated
+    // with the final compression and tile size, so that their tiles are
+    // copied as is in the final product, without being decompressed and
+    // compressed again.
+    const int nBlockSize = atoi(osBlockSize);
+    const bool bTmpOverviewsAsFinal =
+        (EQUAL(osCompress, "LZW") || EQUAL(osCompress, "DEFLATE") ||
+         EQUAL(osCompress, "ZSTD") || EQUAL(osCompress, "LZMA")) &&
+        nBlockSize >= 64 && nBlockSize <= 4096 &&
+        CPLIsPowerOfTwo(nBlockSize) &&
+        CPLGetConfigOption("COG_TMP_COMPRESSION", nullptr) == nullptr;
+
     CPLStringList aosOverviewOptions;
     aosOverviewOptions.SetNameValue("COMPRESS",
+        bTmpOverviewsAsFinal ? osCompress.c_str() :
         CPLGetConfigOption("COG_TMP_COMPRESSION", // only for debug purposes
                         HasZSTDCompression() ? "ZSTD" : "LZW"));
+    if( bTmpOverviewsAsFinal && !osPredictor.empty() )
+        aosOverviewOptions.SetNameValue("PREDICTOR", osPredictor);
+    CPLConfigOptionSetter oSetterOvrBlockSize(
+        "GDAL_TIFF_OVR_BLOCKSIZE",
+        bTmpOverviewsAsFinal ? osBlockSize.c_str() : nullptr, true);
     aosOverviewOptions.SetNameValue("NUM_THREADS",
                         CSLFetchNameValue(papszOptions, "NUM_THREADS"));
     aosOverviewOptions.SetNameValue("BIGTIFF", "YES");
@@ -678,22 +714,8 @@ GDALDataset* GDALCOGCreator::Create(const char * pszFilename,
     aosOptions.SetNameValue("TILED", "YES");
     aosOptions.SetNameValue("BLOCKXSIZE", osBlockSize);
     aosOptions.SetNameValue("BLOCKYSIZE", osBlockSize);
-    const char* pszPredictor = CSLFetchNameValueDef(papszOptions, "PREDICTOR", "FALSE");
-    if( EQUAL(pszPredictor, "YES") || EQUAL(pszPredictor, "ON") || EQUAL(pszPredictor, "TRUE") )
-    {
-        if( GDALDataTypeIsFloating(poSrcDS->GetRasterBand(1)->GetRasterDataType()) )
-            aosOptions.SetNameValue("PREDICTOR", "3");
-        else
-            aosOptions.SetNameValue("PREDICTOR", "2");
-    }
-    else if( EQUAL(pszPredictor, "STANDARD") || EQUAL(pszPredictor, "2") )
-    {
-        aosOptions.SetNameValue("PREDICTOR", "2");
-    }
-    else if( EQUAL(pszPredictor, "FLOATING_POINT") || EQUAL(pszPredictor, "3") )
-    {
-        aosOptions.SetNameValue("PREDICTOR", "3");
-    }
+    if( !osPredictor.empty() )
+        aosOptions.SetNameValue("PREDICTOR", osPredictor);
     const char* pszQuality = CSLFetchNameValue(papszOptions, "QUALITY");
     if( EQUAL(osCompress, "JPEG") )
     {
@@ -781,6 +803,20 @@ static GDALDataset* COGCreateCopy( const char * pszFilename,
                                    papszOptions, pfnProgress, pProgressData);
 }
 
+/************************************************************************/
+/*                    GDALGetDeclaredMetadata_COG()                   */
+/************************************************************************/
+
+// Items that GDALAllRegister() declares for the driver before registering it.
+CSLConstList GDALGetDeclaredMetadata_COG()
+{
+    static const char* const apszMD[] = {
+        GDAL_DCAP_RASTER "=YES",
+        GDAL_DMD_LONGNAME "=Cloud optimized GeoTIFF generator",
+        nullptr };
+    return apszMD;
+}
+
 /************************************************************************/
 /*                          GDALRegister_COG()                          */
 /************************************************************************/
@@ -875,8 +911,8 @@ void GDALRegister_COG()
 
     auto poDriver = new GDALDriver();
     poDriver->SetDescription( "COG" );
-    poDriver->SetMetadataItem( GDAL_DCAP_RASTER, "YES" );
-    poDriver->SetMetadataItem( GDAL_DMD_LONGNAME, "Cloud optimized GeoTIFF generator" );
+    poDriver->SetMetadata(
+        const_cast<char**>(GDALGetDeclaredMetadata_COG()) );
     poDriver->SetMetadataItem( GDAL_DMD_HELPTOPIC, "drivers/raster/cog.html" );
     poDriver->SetMetadataItem( GDAL_DMD_CREATIONOPTIONLIST, osOptions );
 
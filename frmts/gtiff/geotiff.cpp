@@ -376,7 +376,8 @@ private:
     {
         NO,
         YES,
-        IF_ENOUGH_RAM
+        IF_ENOUGH_RAM,
+        AUTO
     };
 
     VirtualMemIOEnum m_eVirtualMemIOUsage = VirtualMemIOEnum::NO;
@@ -534,6 +535,7 @@ private:
                                  GSpacing nPixelSpace, GSpacing nLineSpace,
                                  GSpacing nBandSpace,
                                  GDALRasterIOExtraArg* psExtraArg );
+    bool           IsVirtualMemIOLayoutValid( vsi_l_offset nFileSize );
 
     void            SetStructuralMDFromParent(GTiffDataset* poParentDS);
 
@@ -1188,6 +1190,11 @@ protected:
     void CacheMaskForBlock( int nBlockXOff, int nBlockYOff );
 #endif
 
+    int GetRawBlockIdAndFlush( int nBlockXOff, int nBlockYOff, bool bDiscard );
+
+    virtual CPLErr IReadRawBlock( int, int, void**, size_t* ) override;
+    virtual CPLErr IWriteRawBlock( int, int, const void*, size_t ) override;
+
 public:
              GTiffRasterBand( GTiffDataset *, int );
     virtual ~GTiffRasterBand();
@@ -1195,6 +1202,8 @@ public:
     virtual CPLErr IReadBlock( int, int, void * ) override;
     virtual CPLErr IWriteBlock( int, int, void * ) override;
 
+    virtual char **GetRawBlockCodecInfo( int, int ) override;
+
     virtual int IGetDataCoverageStatus( int nXOff, int nYOff,
                                         int nXSize, int nYSize,
                                         int nMaskFlagStop,
@@ -2248,7 +2257,8 @@ public:
                              bool bIsByteSwapped, bool bIsComplex,
                              int nBlockId )
     {
-        if( nOffset + nPixels * nDTSize > nMappingSize )
+        if( nOffset > nMappingSize ||
+            static_cast<size_t>(nPixels) * nDTSize > nMappingSize - nOffset )
         {
             CPLError(CE_Failure, CPLE_FileIO,
                      "Missing data for block %d", nBlockId);
@@ -2270,7 +2280,8 @@ public:
                      bool bIsByteSwapped, bool bIsComplex,
                      int nBlockId )
     {
-        if( nOffset + nPixels * nDTSize > nMappingSize )
+        if( nOffset > nMappingSize ||
+            static_cast<size_t>(nPixels) * nDTSize > nMappingSize - nOffset )
         {
             CPLError(CE_Failure, CPLE_FileIO,
                      "Missing data for block %d", nBlockId);
@@ -2291,6 +2302,64 @@ public:
     static const EMULATED_BOOL bMinimizeIO = false;
 };
 
+/************************************************************************/
+/*                      IsVirtualMemIOLayoutValid()                     */
+/************************************************************************/
+
+// Check that all the non-sparse strips or tiles are entirely stored in the
+// file, so that VirtualMemIO() returns the same result as the libtiff based
+// implementation, which errors out on truncated blocks.
+bool GTiffDataset::IsVirtualMemIOLayoutValid( vsi_l_offset nFileSize )
+{
+    toff_t *panOffsets = nullptr;
+    toff_t *panByteCounts = nullptr;
+    const bool bTiled = CPL_TO_BOOL(TIFFIsTiled( m_hTIFF ));
+    if( !TIFFGetField( m_hTIFF,
+                       bTiled ? TIFFTAG_TILEOFFSETS : TIFFTAG_STRIPOFFSETS,
+                       &panOffsets ) ||
+        panOffsets == nullptr ||
+        !TIFFGetField( m_hTIFF,
+                       bTiled ? TIFFTAG_TILEBYTECOUNTS :
+                                TIFFTAG_STRIPBYTECOUNTS,
+                       &panByteCounts ) ||
+        panByteCounts == nullptr )
+    {
+        return false;
+    }
+
+    const int nBandsPerBlock =
+        m_nPlanarConfig == PLANARCONFIG_SEPARATE ? 1 : nBands;
+    const vsi_l_offset nLineSize =
+        static_cast<vsi_l_offset>(m_nBlockXSize) * nBandsPerBlock *
+        (m_nBitsPerSample / 8);
+    int nBlocks = m_nBlocksPerBand;
+    if( m_nPlanarConfig == PLANARCONFIG_SEPARATE )
+        nBlocks *= nBands;
+    for( int i = 0; i < nBlocks; ++i )
+    {
+        if( panOffsets[i] == 0 )
+            continue;  // sparse block, filled with the nodata value
+        int nRows = m_nBlockYSize;
+        if( !bTiled )
+        {
+            // The last strip may be shorter
+            const int iStrip = i % m_nBlocksPerBand;
+            nRows = std::min(m_nBlockYSize,
+                             nRasterYSize - iStrip * m_nBlockYSize);
+        }
+        const vsi_l_offset nExpected = nLineSize * nRows;
+        if( panByteCounts[i] < nExpected ||
+            panOffsets[i] > nFileSize ||
+            nExpected > nFileSize - panOffsets[i] )
+        {
+            CPLDebug("GTiff",
+                     "Block %d is truncated: not using VirtualMemIO", i);
+            return false;
+        }
+    }
+    return true;
+}
+
 /************************************************************************/
 /*                         VirtualMemIO()                               */
 /************************************************************************/
@@ -2337,6 +2406,15 @@ int GTiffDataset::VirtualMemIO( GDALRWFlag eRWFlag,
         nMappingSize = static_cast<size_t>(nDataLength);
         if( pabySrcData == nullptr )
             return -1;
+        if( m_eVirtualMemIOUsage == VirtualMemIOEnum::AUTO )
+        {
+            if( !IsVirtualMemIOLayoutValid(nDataLength) )
+            {
+                m_eVirtualMemIOUsage = VirtualMemIOEnum::NO;
+                return -1;
+            }
+            m_eVirtualMemIOUsage = VirtualMemIOEnum::YES;
+        }
     }
     else if( m_psVirtualMemIOMapping == nullptr )
     {
@@ -2358,6 +2436,28 @@ int GTiffDataset::VirtualMemIO( GDALRWFlag eRWFlag,
             m_eVirtualMemIOUsage = VirtualMemIOEnum::NO;
             return -1;
         }
+        if( m_eVirtualMemIOUsage == VirtualMemIOEnum::AUTO )
+        {
+            // Each overview dataset would map the whole file again
+            if( m_poBaseDS != nullptr )
+            {
+                m_eVirtualMemIOUsage = VirtualMemIOEnum::NO;
+                return -1;
+            }
+#if SIZEOF_VOIDP == 4
+            // Do not exhaust the address space of 32-bit processes
+            if( nLength > 256 * 1024 * 1024 )
+            {
+                m_eVirtualMemIOUsage = VirtualMemIOEnum::NO;
+                return -1;
+            }
+#endif
+            if( !IsVirtualMemIOLayoutValid(nLength) )
+            {
+                m_eVirtualMemIOUsage = VirtualMemIOEnum::NO;
+                return -1;
+            }
+        }
         if( m_eVirtualMemIOUsage == VirtualMemIOEnum::IF_ENOUGH_RAM )
         {
             GIntBig nRAM = CPLGetUsablePhysicalRAM();
@@ -5118,6 +5218,187 @@ CPLErr GTiffRasterBand::IWriteBlock( int nBlockXOff, int nBlockYOff,
     return CE_None;
 }
 
+/************************************************************************/
+/*                        GetRawBlockCodecInfo()                        */
+/************************************************************************/
+
+char **GTiffRasterBand::GetRawBlockCodecInfo( int /* nBlockXOff */,
+                                              int nBlockYOff )
+{
+    m_poGDS->Crystalize();
+
+    // Blocks written with DISCARD_LSB must go through the encoding path.
+    if( m_poGDS->m_bStreamingIn || m_poGDS->m_bStreamingOut ||
+        m_poGDS->m_panMaskOffsetLsb )
+        return nullptr;
+
+    CPLStringList aosInfo;
+    aosInfo.SetNameValue("CODEC", "TIFF");
+    aosInfo.SetNameValue("BLOCK_XSIZE", CPLSPrintf("%d", nBlockXSize));
+    aosInfo.SetNameValue("BLOCK_YSIZE", CPLSPrintf("%d", nBlockYSize));
+    aosInfo.SetNameValue("DATA_TYPE", GDALGetDataTypeName(eDataType));
+    const bool bPixelInterleaved =
+        m_poGDS->m_nPlanarConfig == PLANARCONFIG_CONTIG &&
+        m_poGDS->nBands > 1;
+    aosInfo.SetNameValue("INTERLEAVE", bPixelInterleaved ? "PIXEL" : "BAND");
+    aosInfo.SetNameValue("BAND_COUNT",
+                         CPLSPrintf("%d", bPixelInterleaved ?
+                                            m_poGDS->nBands : 1));
+
+    aosInfo.SetNameValue("TIFF_COMPRESSION",
+                         CPLSPrintf("%d", m_poGDS->m_nCompression));
+    uint16 nPredictor = PREDICTOR_NONE;
+    TIFFGetField( m_poGDS->m_hTIFF, TIFFTAG_PREDICTOR, &nPredictor );
+    aosInfo.SetNameValue("TIFF_PREDICTOR", CPLSPrintf("%d", nPredictor));
+    aosInfo.SetNameValue("TIFF_PHOTOMETRIC",
+                         CPLSPrintf("%d", m_poGDS->m_nPhotometric));
+    aosInfo.SetNameValue("TIFF_BITS_PER_SAMPLE",
+                         CPLSPrintf("%d", m_poGDS->m_nBitsPerSample));
+    aosInfo.SetNameValue("TIFF_SAMPLE_FORMAT",
+                         CPLSPrintf("%d", m_poGDS->m_nSampleFormat));
+    aosInfo.SetNameValue("TIFF_SAMPLES_PER_PIXEL",
+                         CPLSPrintf("%d", m_poGDS->m_nSamplesPerPixel));
+    aosInfo.SetNameValue("TIFF_BYTE_ORDER",
+                         TIFFIsBigEndian(m_poGDS->m_hTIFF) ? "MSB" : "LSB");
+    aosInfo.SetNameValue("TIFF_TILED",
+                         TIFFIsTiled(m_poGDS->m_hTIFF) ? "YES" : "NO");
+
+    // The last strip only holds the remaining lines.
+    if( !TIFFIsTiled(m_poGDS->m_hTIFF) )
+    {
+        aosInfo.SetNameValue("TIFF_STRIP_ROWS", CPLSPrintf("%d",
+            std::min(nBlockYSize, nRasterYSize - nBlockYOff * nBlockYSize)));
+    }
+
+    uint32 nJPEGTableSize = 0;
+    void* pJPEGTable = nullptr;
+    if( m_poGDS->m_nCompression == COMPRESSION_JPEG &&
+        TIFFGetField( m_poGDS->m_hTIFF, TIFFTAG_JPEGTABLES,
+                      &nJPEGTableSize, &pJPEGTable ) == 1 &&
+        pJPEGTable != nullptr && nJPEGTableSize <= INT_MAX )
+    {
+        char* const pszHex = CPLBinaryToHex(
+            nJPEGTableSize, static_cast<const GByte*>(pJPEGTable) );
+        aosInfo.SetNameValue("TIFF_JPEGTABLES", pszHex);
+        CPLFree(pszHex);
+    }
+
+    return aosInfo.StealList();
+}
+
+/************************************************************************/
+/*                       GetRawBlockIdAndFlush()                        */
+/************************************************************************/
+
+// Returns the strile id of a block, after having written any pending
+// modification of it, or discarded them if bDiscard is set.
+int GTiffRasterBand::GetRawBlockIdAndFlush( int nBlockXOff, int nBlockYOff,
+                                            bool bDiscard )
+{
+    const bool bPixelInterleaved =
+        m_poGDS->m_nPlanarConfig == PLANARCONFIG_CONTIG &&
+        m_poGDS->nBands > 1;
+    int nBlockId = nBlockXOff + nBlockYOff * nBlocksPerRow;
+    if( m_poGDS->m_nPlanarConfig == PLANARCONFIG_SEPARATE )
+        nBlockId += (nBand - 1) * m_poGDS->m_nBlocksPerBand;
+
+    for( int iBand = 1; iBand <= m_poGDS->nBands; iBand++ )
+    {
+        if( iBand != nBand && !bPixelInterleaved )
+            continue;
+        CPL_IGNORE_RET_VAL(m_poGDS->GetRasterBand(iBand)->FlushBlock(
+            nBlockXOff, nBlockYOff, !bDiscard));
+    }
+
+    if( m_poGDS->m_nLoadedBlock == nBlockId )
+    {
+        if( bDiscard )
+        {
+            m_poGDS->m_bLoadedBlockDirty = false;
+            m_poGDS->m_nLoadedBlock = -1;
+        }
+        else
+        {
+            CPL_IGNORE_RET_VAL(m_poGDS->FlushBlockBuf());
+        }
+    }
+    m_poGDS->WaitCompletionForBlock(nBlockId);
+
+    return nBlockId;
+}
+
+/************************************************************************/
+/*                           IReadRawBlock()                            */
+/************************************************************************/
+
+CPLErr GTiffRasterBand::IReadRawBlock( int nBlockXOff, int nBlockYOff,
+                                       void** ppData, size_t* pnDataSize )
+{
+    const int nBlockId =
+        GetRawBlockIdAndFlush(nBlockXOff, nBlockYOff, false);
+
+    vsi_l_offset nOffset = 0;
+    vsi_l_offset nSize = 0;
+    bool bErrOccurred = false;
+    if( !m_poGDS->IsBlockAvailable(nBlockId, &nOffset, &nSize,
+                                   &bErrOccurred) )
+    {
+        return bErrOccurred ? CE_Failure : CE_None;
+    }
+    if( nSize > std::numeric_limits<size_t>::max() / 2 )
+        return CE_Failure;
+
+    void* pData = VSI_MALLOC_VERBOSE(static_cast<size_t>(nSize));
+    if( pData == nullptr )
+        return CE_Failure;
+
+    VSILFILE* fp = VSI_TIFFGetVSILFile(TIFFClientdata( m_poGDS->m_hTIFF ));
+    const vsi_l_offset nCurOffset = VSIFTellL(fp);
+    const bool bOK =
+        VSIFSeekL(fp, nOffset, SEEK_SET) == 0 &&
+        VSIFReadL(pData, 1, static_cast<size_t>(nSize), fp) ==
+            static_cast<size_t>(nSize);
+    VSIFSeekL(fp, nCurOffset, SEEK_SET);
+    if( !bOK )
+    {
+        ReportError(CE_Failure, CPLE_FileIO,
+                    "Cannot read " CPL_FRMT_GUIB " bytes at offset "
+                    CPL_FRMT_GUIB,
+                    static_cast<GUIntBig>(nSize),
+                    static_cast<GUIntBig>(nOffset));
+        VSIFree(pData);
+        return CE_Failure;
+    }
+
+    *ppData = pData;
+    *pnDataSize = static_cast<size_t>(nSize);
+    return CE_None;
+}
+
+/************************************************************************/
+/*                           IWriteRawBlock()                           */
+/************************************************************************/
+
+CPLErr GTiffRasterBand::IWriteRawBlock( int nBlockXOff, int nBlockYOff,
+                                        const void* pData, size_t nDataSize )
+{
+    if( m_poGDS->m_bDebugDontWriteBlocks )
+        return CE_None;
+
+    if( m_poGDS->m_bWriteError )
+        return CE_Failure;
+
+    const int nBlockId =
+        GetRawBlockIdAndFlush(nBlockXOff, nBlockYOff, true);
+
+    // WriteRawStripOrTile() does not modify the buffer.
+    m_poGDS->WriteRawStripOrTile(nBlockId,
+                                 static_cast<GByte*>(const_cast<void*>(pData)),
+                                 static_cast<GPtrDiff_t>(nDataSize));
+
+    return m_poGDS->m_bWriteError ? CE_Failure : CE_None;
+}
+
 /************************************************************************/
 /*                           SetDescription()                           */
 /************************************************************************/
@@ -6078,6 +6359,9 @@ class GTiffSplitBand final : public GTiffRasterBand
 
     virtual CPLErr IReadBlock( int, int, void * ) override;
     virtual CPLErr IWriteBlock( int, int, void * ) override;
+
+    virtual char **GetRawBlockCodecInfo( int, int ) override
+        { return nullptr; }
 };
 
 /************************************************************************/
@@ -6226,6 +6510,9 @@ class GTiffRGBABand final : public GTiffRasterBand
     virtual CPLErr IReadBlock( int, int, void * ) override;
     virtual CPLErr IWriteBlock( int, int, void * ) override;
 
+    virtual char **GetRawBlockCodecInfo( int, int ) override
+        { return nullptr; }
+
     virtual GDALColorInterp GetColorInterpretation() override;
 };
 
@@ -7495,6 +7782,9 @@ class GTiffSplitBitmapBand final : public GTiffBitmapBand
 
     virtual CPLErr IReadBlock( int, int, void * ) override;
     virtual CPLErr IWriteBlock( int, int, void * ) override;
+
+    virtual char **GetRawBlockCodecInfo( int, int ) override
+        { return nullptr; }
 };
 
 /************************************************************************/
@@ -7696,7 +7986,9 @@ GTiffDataset::GTiffDataset():
 
     const char* pszVirtualMemIO =
         CPLGetConfigOption("GTIFF_VIRTUAL_MEM_IO", "NO");
-    if( EQUAL(pszVirtualMemIO, "IF_ENOUGH_RAM") )
+    if( EQUAL(pszVirtualMemIO, "AUTO") )
+        m_eVirtualMemIOUsage = VirtualMemIOEnum::AUTO;
+    else if( EQUAL(pszVirtualMemIO, "IF_ENOUGH_RAM") )
         m_eVirtualMemIOUsage = VirtualMemIOEnum::IF_ENOUGH_RAM;
     else if( CPLTestBool(pszVirtualMemIO) )
         m_eVirtualMemIOUsage = VirtualMemIOEnum::YES;
@@ -12033,6 +12325,29 @@ bool GTiffDataset::SetDirectory()
     return true;
 }
 
+/************************************************************************/
+/*                      GTiffSetDeflateSubCodec()                       */
+/************************************************************************/
+
+// The ZIP codec uses libdeflate for whole tiles/strips when it is available.
+// GDAL_TIFF_DEFLATE_SUBCODEC=ZLIB forces zlib, mostly for benchmarking.
+static void GTiffSetDeflateSubCodec(TIFF* hTIFF, int nCompression)
+{
+    if( nCompression != COMPRESSION_ADOBE_DEFLATE &&
+        nCompression != COMPRESSION_DEFLATE )
+        return;
+#ifdef LIBDEFLATE_SUPPORT
+    const char* pszSubCodec =
+        CPLGetConfigOption("GDAL_TIFF_DEFLATE_SUBCODEC", nullptr);
+    if( pszSubCodec != nullptr && EQUAL(pszSubCodec, "ZLIB") )
+    {
+        TIFFSetField(hTIFF, TIFFTAG_DEFLATE_SUBCODEC, DEFLATE_SUBCODEC_ZLIB);
+    }
+#else
+    (void)hTIFF;
+#endif
+}
+
 /************************************************************************/
 /*                     RestoreVolatileParameters()                      */
 /************************************************************************/
@@ -12096,6 +12411,8 @@ void GTiffDataset::RestoreVolatileParameters(TIFF* hTIFF)
         if( m_bWebPLossless && m_nCompression == COMPRESSION_WEBP)
             TIFFSetField(hTIFF, TIFFTAG_WEBP_LOSSLESS, 1);
     }
+
+    GTiffSetDeflateSubCodec(hTIFF, m_nCompression);
 }
 
 /************************************************************************/
@@ -12545,6 +12862,7 @@ GDALDataset *GTiffDataset::Open( GDALOpenInfo * poOpenInfo )
     poOpenInfo->fpL = nullptr;
     poDS->m_bStreamingIn = bStreaming;
     poDS->m_nCompression = l_nCompression;
+    GTiffSetDeflateSubCodec(l_hTIFF, l_nCompression);
 
     // Check structural metadata (for COG)
     const int nOffsetOfStructuralMetadata =
@@ -15263,7 +15581,12 @@ static signed char GTiffGetZLevel(char** papszOptions)
     if( pszValue != nullptr )
     {
         nZLevel = atoi( pszValue );
-        if( nZLevel < 1 || nZLevel > 9 )
+#ifdef LIBDEFLATE_SUPPORT
+        constexpr int nMaxLevel = 12;
+#else
+        constexpr int nMaxLevel = 9;
+#endif
+        if( nZLevel < 1 || nZLevel > nMaxLevel )
         {
             CPLError( CE_Warning, CPLE_IllegalArg,
                       "ZLEVEL=%s value not recognised, ignoring.",
@@ -16051,6 +16374,7 @@ TIFF *GTiffDataset::CreateLL( const char * pszFilename,
     if( (l_nCompression == COMPRESSION_ADOBE_DEFLATE ||
          l_nCompression == COMPRESSION_LERC) && l_nZLevel != -1 )
         TIFFSetField( l_hTIFF, TIFFTAG_ZIPQUALITY, l_nZLevel );
+    GTiffSetDeflateSubCodec(l_hTIFF, l_nCompression);
     if( l_nCompression == COMPRESSION_JPEG && l_nJpegQuality != -1 )
         TIFFSetField( l_hTIFF, TIFFTAG_JPEGQUALITY, l_nJpegQuality );
     if( l_nCompression == COMPRESSION_LZMA && l_nLZMAPreset != -1)
@@ -16777,6 +17101,80 @@ CPLErr GTiffDataset::CopyImageryAndMask(GTiffDataset* poDstDS,
         CPLAssert( poDstDS->m_poMaskDS->m_nBlockYSize == poDstDS->m_nBlockYSize );
     }
 
+    // When the source stores its blocks as the destination does (e.g. a
+    // GTiff/COG source with the same creation options, or the temporary
+    // overviews of the COG driver), copy their stored bytes instead of
+    // decoding and encoding them again.
+    const auto CanCopyRawBlocks = [nXSize, nYSize](GDALRasterBand* poSrcBand,
+                                                   GDALRasterBand* poDstBand)
+    {
+        if( poSrcBand == nullptr ||
+            poSrcBand->GetXSize() != nXSize ||
+            poSrcBand->GetYSize() != nYSize )
+            return false;
+        char** papszSrcInfo = poSrcBand->GetRawBlockCodecInfo(0, 0);
+        char** papszDstInfo = poDstBand->GetRawBlockCodecInfo(0, 0);
+        const bool bRet = GDALRawBlockCodecInfoEqual(papszSrcInfo,
+                                                     papszDstInfo);
+        CSLDestroy(papszSrcInfo);
+        CSLDestroy(papszDstInfo);
+        return bRet;
+    };
+    const bool bCopyRawImagery =
+        CanCopyRawBlocks(poSrcDS->GetRasterBand(1),
+                         poDstDS->GetRasterBand(1));
+    const bool bCopyRawMask =
+        bCopyRawImagery && poDstDS->m_poMaskDS &&
+        CanCopyRawBlocks(poSrcMaskBand,
+                         poDstDS->m_poMaskDS->GetRasterBand(1));
+    if( bCopyRawImagery )
+    {
+        CPLDebug("GTiff", "Copying raw blocks of %s%s",
+                 poSrcDS->GetDescription(),
+                 bCopyRawMask ? " and of its mask" : "");
+    }
+
+    // Sets bCopied if the block could be copied as is. Otherwise (missing
+    // block, or block stored differently, such as a partial last strip),
+    // it must go through the regular path.
+    const auto CopyRawBlock = [poDstDS](GDALRasterBand* poSrcBand,
+                                        GTiffDataset* poBlockDstDS,
+                                        int nXBlock, int nYBlock, int iBlock,
+                                        bool& bCopied)
+    {
+        bCopied = false;
+        void* pData = nullptr;
+        size_t nDataSize = 0;
+        char** papszSrcInfo = nullptr;
+        const CPLErr eErrRead =
+            poSrcBand->ReadRawBlock(nXBlock, nYBlock, &pData, &nDataSize,
+                                    &papszSrcInfo);
+        if( eErrRead == CE_None && nDataSize != 0 )
+        {
+            char** papszDstInfo = poBlockDstDS->GetRasterBand(1)->
+                GetRawBlockCodecInfo(nXBlock, nYBlock);
+            if( GDALRawBlockCodecInfoEqual(papszSrcInfo, papszDstInfo) )
+            {
+                // Blocks compressed in worker threads must be written
+                // first to preserve the block order.
+                auto& oQueue = poDstDS->m_poBaseDS ?
+                    poDstDS->m_poBaseDS->m_asQueueJobIdx :
+                    poDstDS->m_asQueueJobIdx;
+                while( !oQueue.empty() )
+                    poDstDS->WaitCompletionForJobIdx(oQueue.front());
+
+                poBlockDstDS->WriteRawStripOrTile(
+                    iBlock, static_cast<GByte*>(pData),
+                    static_cast<GPtrDiff_t>(nDataSize));
+                bCopied = true;
+            }
+            CSLDestroy(papszDstInfo);
+        }
+        VSIFree(pData);
+        CSLDestroy(papszSrcInfo);
+        return eErrRead;
+    };
+
     int iBlock = 0;
     for( int iY = 0, nYBlock = 0; iY < nYSize && eErr == CE_None;
             iY = ((nYSize - iY < poDstDS->m_nBlockYSize) ? nYSize :
@@ -16798,7 +17196,18 @@ CPLErr GTiffDataset::CopyImageryAndMask(GTiffDataset* poDstDS,
                     l_nBands * nDataTypeSize);
             }
 
-            if( !bIsOddBand )
+            bool bRawCopied = false;
+            if( bCopyRawImagery )
+            {
+                eErr = CopyRawBlock(poSrcDS->GetRasterBand(1), poDstDS,
+                                    nXBlock, nYBlock, iBlock, bRawCopied);
+            }
+
+            if( eErr != CE_None || bRawCopied )
+            {
+                // Nothing to do.
+            }
+            else if( !bIsOddBand )
             {
                 eErr = poSrcDS->RasterIO( GF_Read,
                     iX, iY, nReqXSize, nReqYSize,
@@ -16870,7 +17279,13 @@ CPLErr GTiffDataset::CopyImageryAndMask(GTiffDataset* poDstDS,
                 }
             }
 
-            if( eErr == CE_None && poDstDS->m_poMaskDS )
+            bool bRawMaskCopied = false;
+            if( eErr == CE_None && bCopyRawMask )
+            {
+                eErr = CopyRawBlock(poSrcMaskBand, poDstDS->m_poMaskDS,
+                                    nXBlock, nYBlock, iBlock, bRawMaskCopied);
+            }
+            if( eErr == CE_None && poDstDS->m_poMaskDS && !bRawMaskCopied )
             {
                 if( nReqXSize < poDstDS->m_nBlockXSize ||
                     nReqYSize < poDstDS->m_nBlockYSize )
@@ -19778,6 +20193,25 @@ CPLString GTiffGetCompressValues(bool& bHasLZW,
     return osCompressValues;
 }
 
+/************************************************************************/
+/*                   GDALGetDeclaredMetadata_GTiff()                  */
+/************************************************************************/
+
+// Items that GDALAllRegister() declares for the driver before registering it.
+CSLConstList GDALGetDeclaredMetadata_GTiff()
+{
+    static const char* const apszMD[] = {
+        GDAL_DCAP_OPEN "=YES",
+        GDAL_DCAP_RASTER "=YES",
+        GDAL_DMD_LONGNAME "=GeoTIFF",
+        GDAL_DMD_EXTENSION "=tif",
+        GDAL_DMD_EXTENSIONS "=tif tiff",
+        GDAL_DMD_OPEN_SIGNATURES
+            "=0:49492A00 0:4D4D002A 0:49492B00 0:4D4D002B",
+        nullptr };
+    return apszMD;
+}
+
 /************************************************************************/
 /*                          GDALRegister_GTiff()                        */
 /************************************************************************/
@@ -19825,8 +20259,15 @@ void GDALRegister_GTiff()
 #endif
     }
     if( bHasDEFLATE )
+    {
+#ifdef LIBDEFLATE_SUPPORT
+        osOptions += ""
+"   <Option name='ZLEVEL' type='int' description='DEFLATE compression level 1-12' default='6'/>";
+#else
         osOptions += ""
 "   <Option name='ZLEVEL' type='int' description='DEFLATE compression level 1-9' default='6'/>";
+#endif
+    }
     if( bHasLZMA )
         osOptions += ""
 "   <Option name='LZMA_PRESET' type='int' description='LZMA compression level 0(fast)-9(slow)' default='6'/>";
@@ -19927,12 +20368,10 @@ void GDALRegister_GTiff()
 /*      Set the driver details.                                         */
 /* -------------------------------------------------------------------- */
     poDriver->SetDescription( "GTiff" );
-    poDriver->SetMetadataItem( GDAL_DCAP_RASTER, "YES" );
-    poDriver->SetMetadataItem( GDAL_DMD_LONGNAME, "GeoTIFF" );
+    poDriver->SetMetadata(
+        const_cast<char**>(GDALGetDeclaredMetadata_GTiff()) );
     poDriver->SetMetadataItem( GDAL_DMD_HELPTOPIC, "drivers/raster/gtiff.html" );
     poDriver->SetMetadataItem( GDAL_DMD_MIMETYPE, "image/tiff" );
-    poDriver->SetMetadataItem( GDAL_DMD_EXTENSION, "tif" );
-    poDriver->SetMetadataItem( GDAL_DMD_EXTENSIONS, "tif tiff" );
     poDriver->SetMetadataItem( GDAL_DMD_CREATIONDATATYPES,
                                "Byte UInt16 Int16 UInt32 Int32 Float32 "
                                "Float64 CInt16 CInt32 CFloat32 CFloat64" );
@@ -643,7 +643,8 @@ GTIFFBuildOverviewsEx( const char * pszFilename,
 /* -------------------------------------------------------------------- */
     int nPredictor = PREDICTOR_NONE;
     if( nCompression == COMPRESSION_LZW ||
-        nCompression == COMPRESSION_ADOBE_DEFLATE )
+        nCompression == COMPRESSION_ADOBE_DEFLATE ||
+        nCompression == COMPRESSION_ZSTD )
     {
         const char* pszPredictor = papszOptions ?
             CSLFetchNameValue(papszOptions, "PREDICTOR") :
@@ -673,6 +673,10 @@ TIFFWriteBufferSetup(TIFF* tif, void* bp, tmsize_t size)
 		 */
 		if (size < 8*1024)
 			size = 8*1024;
+		/* Add a 10% margin, so that codecs compressing a whole */
+		/* strip/tile at once can write it even if it expands a bit */
+		if( size < TIFF_TMSIZE_T_MAX - size / 10 )
+			size += size / 10;
 		bp = NULL;			/* NB: force malloc */
 	}
 	if (bp == NULL) {
@@ -47,6 +47,11 @@
 #include "tif_predict.h"
 #include "zlib.h"
 
+#ifdef LIBDEFLATE_SUPPORT
+#include "libdeflate.h"
+#endif
+#define LIBDEFLATE_MAX_COMPRESSION_LEVEL 12
+
 #include <stdio.h>
 
 /*
@@ -70,8 +75,17 @@ typedef struct {
         z_stream        stream;
 	int             zipquality;            /* compression level */
 	int             state;                 /* state flags */
+	int             subcodec;              /* DEFLATE_SUBCODEC_xxx */
 #define ZSTATE_INIT_DECODE 0x01
 #define ZSTATE_INIT_ENCODE 0x02
+#ifdef LIBDEFLATE_SUPPORT
+	/* -1 = until ZIPEncode() / ZIPDecode() is called for the strip/tile, */
+	/* 0 = use zlib, 1 = use libdeflate */
+	int             libdeflate_state;
+	struct libdeflate_decompressor* libdeflate_dec;
+	struct libdeflate_compressor*   libdeflate_enc;
+	int             libdeflate_enc_level;
+#endif
 
 	TIFFVGetMethod  vgetparent;            /* super-class method */
 	TIFFVSetMethod  vsetparent;            /* super-class method */
@@ -132,6 +146,9 @@ ZIPPreDecode(TIFF* tif, uint16 s)
 	if( (sp->state & ZSTATE_INIT_DECODE) == 0 )
             tif->tif_setupdecode( tif );
 
+#ifdef LIBDEFLATE_SUPPORT
+	sp->libdeflate_state = -1;
+#endif
 	sp->stream.next_in = tif->tif_rawdata;
 	assert(sizeof(sp->stream.avail_in)==4);  /* if this assert gets raised,
 	    we need to simplify this code to reflect a ZLib that is likely updated
@@ -151,6 +168,72 @@ ZIPDecode(TIFF* tif, uint8* op, tmsize_t occ, uint16 s)
 	assert(sp != NULL);
 	assert(sp->state == ZSTATE_INIT_DECODE);
 
+#ifdef LIBDEFLATE_SUPPORT
+	if( sp->libdeflate_state == 1 )
+		return 0;
+
+	/* If we are asked to decode a whole strip/tile in a single call, */
+	/* then libdeflate can be used, which is much faster than zlib */
+	do {
+		TIFFDirectory *td = &tif->tif_dir;
+		enum libdeflate_result res;
+
+		if( sp->libdeflate_state == 0 )
+			break;
+		if( sp->subcodec == DEFLATE_SUBCODEC_ZLIB )
+			break;
+
+		if (isTiled(tif)) {
+			if( TIFFTileSize64(tif) != (uint64)occ )
+				break;
+		} else {
+			uint32 strip_height = td->td_imagelength - tif->tif_row;
+			if (strip_height > td->td_rowsperstrip)
+				strip_height = td->td_rowsperstrip;
+			if( TIFFVStripSize64(tif, strip_height) != (uint64)occ )
+				break;
+		}
+
+		/* Check for overflow */
+		if( (size_t)tif->tif_rawcc != (uint64)tif->tif_rawcc )
+			break;
+		if( (size_t)occ != (uint64)occ )
+			break;
+
+		if( sp->libdeflate_dec == NULL )
+		{
+			sp->libdeflate_dec = libdeflate_alloc_decompressor();
+			if( sp->libdeflate_dec == NULL )
+				break;
+		}
+
+		sp->libdeflate_state = 1;
+
+		res = libdeflate_zlib_decompress(
+			sp->libdeflate_dec, tif->tif_rawcp, (size_t)tif->tif_rawcc,
+			op, (size_t)occ, NULL);
+
+		tif->tif_rawcp += tif->tif_rawcc;
+		tif->tif_rawcc = 0;
+
+		/* LIBDEFLATE_INSUFFICIENT_SPACE is accepted, as there are files */
+		/* where the last strip, smaller in height than td_rowsperstrip, */
+		/* actually contains data for td_rowsperstrip lines. zlib */
+		/* silently ignores the extra data too. */
+		if( res != LIBDEFLATE_SUCCESS &&
+		    res != LIBDEFLATE_INSUFFICIENT_SPACE )
+		{
+			TIFFErrorExt(tif->tif_clientdata, module,
+				     "Decoding error at scanline %lu",
+				     (unsigned long) tif->tif_row);
+			return 0;
+		}
+
+		return 1;
+	} while(0);
+	sp->libdeflate_state = 0;
+#endif /* LIBDEFLATE_SUPPORT */
+
         sp->stream.next_in = tif->tif_rawcp;
         
 	sp->stream.next_out = op;
@@ -198,6 +281,7 @@ ZIPSetupEncode(TIFF* tif)
 {
 	static const char module[] = "ZIPSetupEncode";
 	ZIPState* sp = EncoderState(tif);
+	int cappedQuality;
 
 	assert(sp != NULL);
 	if (sp->state & ZSTATE_INIT_DECODE) {
@@ -205,7 +289,11 @@ ZIPSetupEncode(TIFF* tif)
 		sp->state = 0;
 	}
 
-	if (deflateInit(&sp->stream, sp->zipquality) != Z_OK) {
+	cappedQuality = sp->zipquality;
+	if( cappedQuality > Z_BEST_COMPRESSION )
+		cappedQuality = Z_BEST_COMPRESSION;
+
+	if (deflateInit(&sp->stream, cappedQuality) != Z_OK) {
 		TIFFErrorExt(tif->tif_clientdata, module, "%s", SAFE_MSG(sp));
 		return (0);
 	} else {
@@ -227,6 +315,9 @@ ZIPPreEncode(TIFF* tif, uint16 s)
 	if( sp->state != ZSTATE_INIT_ENCODE )
             tif->tif_setupencode( tif );
 
+#ifdef LIBDEFLATE_SUPPORT
+	sp->libdeflate_state = -1;
+#endif
 	sp->stream.next_out = tif->tif_rawdata;
 	assert(sizeof(sp->stream.avail_out)==4);  /* if this assert gets raised,
 	    we need to simplify this code to reflect a ZLib that is likely updated
@@ -249,6 +340,85 @@ ZIPEncode(TIFF* tif, uint8* bp, tmsize_t cc, uint16 s)
 	assert(sp->state == ZSTATE_INIT_ENCODE);
 
 	(void) s;
+
+#ifdef LIBDEFLATE_SUPPORT
+	if( sp->libdeflate_state == 1 )
+		return 0;
+
+	/* If we are asked to encode a whole strip/tile in a single call, */
+	/* then libdeflate can be used, which is much faster than zlib */
+	do {
+		TIFFDirectory *td = &tif->tif_dir;
+		size_t nCompressedBytes;
+
+		if( sp->libdeflate_state == 0 )
+			break;
+		if( sp->subcodec == DEFLATE_SUBCODEC_ZLIB )
+			break;
+
+		/* libdeflate does not support the 0-compression level */
+		if( sp->zipquality == Z_NO_COMPRESSION )
+			break;
+
+		if (isTiled(tif)) {
+			if( TIFFTileSize64(tif) != (uint64)cc )
+				break;
+		} else {
+			uint32 strip_height = td->td_imagelength - tif->tif_row;
+			if (strip_height > td->td_rowsperstrip)
+				strip_height = td->td_rowsperstrip;
+			if( TIFFVStripSize64(tif, strip_height) != (uint64)cc )
+				break;
+		}
+
+		/* Check for overflow */
+		if( (size_t)tif->tif_rawdatasize != (uint64)tif->tif_rawdatasize )
+			break;
+		if( (size_t)cc != (uint64)cc )
+			break;
+
+		if( sp->libdeflate_enc == NULL )
+		{
+			/* libdeflate needs one extra level of compression to */
+			/* get a compression ratio as good as zlib's one */
+			sp->libdeflate_enc_level =
+				sp->zipquality == Z_DEFAULT_COMPRESSION ? 7 :
+				sp->zipquality >= 6 && sp->zipquality <= 9 ?
+					sp->zipquality + 1 : sp->zipquality;
+			sp->libdeflate_enc =
+				libdeflate_alloc_compressor(sp->libdeflate_enc_level);
+			if( sp->libdeflate_enc == NULL )
+				break;
+		}
+
+		/* The whole compressed strip/tile must fit in the output */
+		/* buffer, which TIFFWriteBufferSetup() sizes with a margin */
+		/* over the uncompressed size */
+		if( libdeflate_zlib_compress_bound(sp->libdeflate_enc, (size_t)cc) >
+		    (size_t)tif->tif_rawdatasize )
+			break;
+
+		sp->libdeflate_state = 1;
+		nCompressedBytes = libdeflate_zlib_compress(
+			sp->libdeflate_enc, bp, (size_t)cc,
+			tif->tif_rawdata, (size_t)tif->tif_rawdatasize);
+		if( nCompressedBytes == 0 )
+		{
+			TIFFErrorExt(tif->tif_clientdata, module,
+				     "Encoder error at scanline %lu",
+				     (unsigned long) tif->tif_row);
+			return 0;
+		}
+
+		tif->tif_rawcc = nCompressedBytes;
+		if( !TIFFFlushData1(tif) )
+			return 0;
+
+		return 1;
+	} while(0);
+	sp->libdeflate_state = 0;
+#endif /* LIBDEFLATE_SUPPORT */
+
 	sp->stream.next_in = bp;
 	assert(sizeof(sp->stream.avail_in)==4);  /* if this assert gets raised,
 	    we need to simplify this code to reflect a ZLib that is likely updated
@@ -285,6 +455,11 @@ ZIPPostEncode(TIFF* tif)
 	ZIPState *sp = EncoderState(tif);
 	int state;
 
+#ifdef LIBDEFLATE_SUPPORT
+	if( sp->libdeflate_state == 1 )
+		return 1;
+#endif
+
 	sp->stream.avail_in = 0;
 	do {
 		state = deflate(&sp->stream, Z_FINISH);
@@ -327,6 +502,14 @@ ZIPCleanup(TIFF* tif)
 		inflateEnd(&sp->stream);
 		sp->state = 0;
 	}
+
+#ifdef LIBDEFLATE_SUPPORT
+	if( sp->libdeflate_dec )
+		libdeflate_free_decompressor(sp->libdeflate_dec);
+	if( sp->libdeflate_enc )
+		libdeflate_free_compressor(sp->libdeflate_enc);
+#endif
+
 	_TIFFfree(sp);
 	tif->tif_data = NULL;
 
@@ -342,15 +525,52 @@ ZIPVSetField(TIFF* tif, uint32 tag, va_list ap)
 	switch (tag) {
 	case TIFFTAG_ZIPQUALITY:
 		sp->zipquality = (int) va_arg(ap, int);
+		if( sp->zipquality < Z_DEFAULT_COMPRESSION ||
+		    sp->zipquality > LIBDEFLATE_MAX_COMPRESSION_LEVEL ) {
+			TIFFErrorExt(tif->tif_clientdata, module,
+				     "Invalid ZipQuality value. Should be in [-1,%d] range",
+				     LIBDEFLATE_MAX_COMPRESSION_LEVEL);
+			return 0;
+		}
 		if ( sp->state&ZSTATE_INIT_ENCODE ) {
+			int cappedQuality = sp->zipquality;
+			if( cappedQuality > Z_BEST_COMPRESSION )
+				cappedQuality = Z_BEST_COMPRESSION;
 			if (deflateParams(&sp->stream,
-			    sp->zipquality, Z_DEFAULT_STRATEGY) != Z_OK) {
+			    cappedQuality, Z_DEFAULT_STRATEGY) != Z_OK) {
 				TIFFErrorExt(tif->tif_clientdata, module, "ZLib error: %s",
 					     SAFE_MSG(sp));
 				return (0);
 			}
 		}
+#ifdef LIBDEFLATE_SUPPORT
+		if( sp->libdeflate_enc )
+		{
+			libdeflate_free_compressor(sp->libdeflate_enc);
+			sp->libdeflate_enc = NULL;
+		}
+#endif
 		return (1);
+
+	case TIFFTAG_DEFLATE_SUBCODEC:
+		sp->subcodec = (int) va_arg(ap, int);
+		if( sp->subcodec != DEFLATE_SUBCODEC_ZLIB &&
+		    sp->subcodec != DEFLATE_SUBCODEC_LIBDEFLATE )
+		{
+			TIFFErrorExt(tif->tif_clientdata, module,
+				     "Invalid DeflateCodec value.");
+			return 0;
+		}
+#ifndef LIBDEFLATE_SUPPORT
+		if( sp->subcodec == DEFLATE_SUBCODEC_LIBDEFLATE )
+		{
+			TIFFErrorExt(tif->tif_clientdata, module,
+				     "DeflateCodec = DEFLATE_SUBCODEC_LIBDEFLATE unsupported in this build");
+			return 0;
+		}
+#endif
+		return 1;
+
 	default:
 		return (*sp->vsetparent)(tif, tag, ap);
 	}
@@ -366,6 +586,11 @@ ZIPVGetField(TIFF* tif, uint32 tag, va_list ap)
 	case TIFFTAG_ZIPQUALITY:
 		*va_arg(ap, int*) = sp->zipquality;
 		break;
+
+	case TIFFTAG_DEFLATE_SUBCODEC:
+		*va_arg(ap, int*) = sp->subcodec;
+		break;
+
 	default:
 		return (*sp->vgetparent)(tif, tag, ap);
 	}
@@ -374,6 +599,7 @@ ZIPVGetField(TIFF* tif, uint32 tag, va_list ap)
 
 static const TIFFField zipFields[] = {
     { TIFFTAG_ZIPQUALITY, 0, 0, TIFF_ANY, 0, TIFF_SETGET_INT, TIFF_SETGET_UNDEFINED, FIELD_PSEUDO, TRUE, FALSE, "", NULL },
+    { TIFFTAG_DEFLATE_SUBCODEC, 0, 0, TIFF_ANY, 0, TIFF_SETGET_INT, TIFF_SETGET_UNDEFINED, FIELD_PSEUDO, FALSE, FALSE, "", NULL },
 };
 
 int
@@ -420,6 +646,17 @@ TIFFInitZIP(TIFF* tif, int scheme)
 	/* Default values for codec-specific fields */
 	sp->zipquality = Z_DEFAULT_COMPRESSION;	/* default comp. level */
 	sp->state = 0;
+#ifdef LIBDEFLATE_SUPPORT
+	sp->subcodec = DEFLATE_SUBCODEC_LIBDEFLATE;
+#else
+	sp->subcodec = DEFLATE_SUBCODEC_ZLIB;
+#endif
+#ifdef LIBDEFLATE_SUPPORT
+	sp->libdeflate_state = -1;
+	sp->libdeflate_dec = NULL;
+	sp->libdeflate_enc = NULL;
+	sp->libdeflate_enc_level = 0;
+#endif
 
 	/*
 	 * Install codec methods.
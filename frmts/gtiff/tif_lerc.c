@@ -728,7 +728,10 @@ LERCPostEncode(TIFF* tif)
             strm.zalloc = NULL;
             strm.zfree = NULL;
             strm.opaque = NULL;
-            zlib_ret = deflateInit(&strm, sp->zipquality);
+            /* Levels above 9 are only meaningful for libdeflate */
+            zlib_ret = deflateInit(&strm,
+                sp->zipquality > Z_BEST_COMPRESSION ?
+                    Z_BEST_COMPRESSION : sp->zipquality);
             if( zlib_ret != Z_OK )
             {
                 TIFFErrorExt(tif->tif_clientdata, module,
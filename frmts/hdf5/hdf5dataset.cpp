@@ -51,6 +51,16 @@ CPL_CVSID("$Id: hdf5dataset.cpp a5d5ed208537a05de4437e97b6a09b7ba44f76c9 2020-03
 
 constexpr size_t MAX_METADATA_LEN = 32768;
 
+/************************************************************************/
+/*                         HDF5GetGlobalMutex()                         */
+/************************************************************************/
+
+std::recursive_mutex& HDF5GetGlobalMutex()
+{
+    static std::recursive_mutex oMutex;
+    return oMutex;
+}
+
 /************************************************************************/
 /*                          HDF5GetFileDriver()                         */
 /************************************************************************/
@@ -36,6 +36,8 @@
 #include "cpl_list.h"
 #include "gdal_pam.h"
 
+#include <mutex>
+
 typedef struct HDF5GroupObjects
 {
     char *pszName;
@@ -62,6 +64,13 @@ void HDF5UnloadFileDriver();
 
 hid_t GDAL_HDF5Open(const std::string& osFilename );
 
+// Serializes the libhdf5 calls of the multidimensional read paths, which can
+// be used from several threads. libhdf5 itself is generally not built
+// thread-safe.
+std::recursive_mutex& HDF5GetGlobalMutex();
+#define HDF5_GLOBAL_LOCK() \
+    std::lock_guard<std::recursive_mutex> oHDF5GlobalLock(HDF5GetGlobalMutex())
+
 #if defined(H5_VERSION_GE) // added in 1.8.7
 # if !H5_VERSION_GE(1,8,13)
 #ifndef _WIN32
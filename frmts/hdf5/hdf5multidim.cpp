@@ -279,6 +279,7 @@ class HDF5Array final: public GDALMDArray
     mutable bool    m_bHasDimensionList = false;
     mutable bool    m_bHasDimensionLabels = false;
     haddr_t         m_nOffset;
+    std::vector<GUInt64> m_anBlockSize{};
 
     HDF5Array(const std::string& osParentName,
               const std::string& osName,
@@ -346,6 +347,11 @@ public:
         return m_abyNoData.empty() ? nullptr : m_abyNoData.data();
     }
 
+    // IRead() holds the global HDF5 lock
+    bool IsReadThreadSafe() const override { return true; }
+
+    std::vector<GUInt64> GetBlockSize() const override { return m_anBlockSize; }
+
     const std::string& GetUnit() const override
     {
         return m_osUnit;
@@ -794,6 +800,23 @@ HDF5Array::HDF5Array(const std::string& osParentName,
     m_hNativeDT = H5Tget_native_type(hDataType, H5T_DIR_ASCEND);
     H5Tclose(hDataType);
 
+    const int nDimCount = H5Sget_simple_extent_ndims(m_hDataSpace);
+    m_anBlockSize.resize(std::max(nDimCount, 0));
+    const hid_t hListId = H5Dget_create_plist(hArray);
+    if( hListId > 0 )
+    {
+        if( nDimCount > 0 && H5Pget_layout(hListId) == H5D_CHUNKED )
+        {
+            std::vector<hsize_t> anChunkDims(nDimCount);
+            if( H5Pget_chunk(hListId, nDimCount, &anChunkDims[0]) == nDimCount )
+            {
+                for( int i = 0; i < nDimCount; ++i )
+                    m_anBlockSize[i] = anChunkDims[i];
+            }
+        }
+        H5Pclose(hListId);
+    }
+
     std::vector<std::pair<std::string, hid_t>> oTypes;
     if( !osParentName.empty() &&
         H5Tget_class(m_hNativeDT) == H5T_COMPOUND )
@@ -1640,6 +1663,13 @@ bool HDF5Array::IRead(const GUInt64* arrayStartIdx,
                                const GDALExtendedDataType& bufferDataType,
                                void* pDstBuffer) const
 {
+    bool bRet = false;
+    if( ReadFromChunkCache(arrayStartIdx, count, arrayStep, bufferStride,
+                           bufferDataType, pDstBuffer, bRet) )
+    {
+        return bRet;
+    }
+
     const size_t nDims(m_dims.size());
     std::vector<H5OFFSET_TYPE> anOffset(nDims);
     std::vector<hsize_t> anCount(nDims);
@@ -1670,6 +1700,9 @@ bool HDF5Array::IRead(const GUInt64* arrayStartIdx,
         nCurStride *= count[i];
     }
 
+    // m_hDataSpace is modified below
+    HDF5_GLOBAL_LOCK();
+
     hid_t hBufferType = H5I_INVALID_HID;
     GByte* pabyTemp = nullptr;
     if( m_dt.GetClass() == GEDTC_STRING )
@@ -1911,6 +1944,8 @@ bool HDF5Attribute::IRead(const GUInt64* arrayStartIdx,
                                const GDALExtendedDataType& bufferDataType,
                                void* pDstBuffer) const
 {
+    HDF5_GLOBAL_LOCK();
+
     const size_t nDims(m_dims.size());
     if( m_dt.GetClass() == GEDTC_STRING )
     {
@@ -47,13 +47,17 @@
 #include <setjmp.h>
 
 #include <algorithm>
+#include <mutex>
+#include <new>
 #include <string>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
 #include "cpl_progress.h"
 #include "cpl_string.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal.h"
 #include "gdal_frmts.h"
 #include "gdal_pam.h"
@@ -1843,6 +1847,656 @@ const GDAL_GCP *JPGDatasetCommon::GetGCPs()
     return pasGCPList;
 }
 
+/************************************************************************/
+/*                         InitRestartLayout()                          */
+/*                                                                      */
+/*      Locate the restart intervals of a single scan baseline JPEG     */
+/*      so that horizontal strips made of whole intervals can be        */
+/*      decoded independently of each other.                            */
+/************************************************************************/
+
+bool JPGDatasetCommon::InitRestartLayout()
+
+{
+    if( nRestartLayoutStatus != 0 )
+        return nRestartLayoutStatus > 0;
+    nRestartLayoutStatus = -1;
+
+    const vsi_l_offset nSavedPos = VSIFTellL(fpImage);
+
+    // Scan the marker segments up to the start of scan.
+    vsi_l_offset nPos = nSubfileOffset;
+    GByte abyBuf[4] = { 0, 0, 0, 0 };
+    bool bOK = VSIFSeekL(fpImage, nPos, SEEK_SET) == 0 &&
+               VSIFReadL(abyBuf, 2, 1, fpImage) == 1 &&
+               abyBuf[0] == 0xFF && abyBuf[1] == 0xD8;
+    nPos += 2;
+
+    bool bHasDHT = false;
+    bool bHasDQT = false;
+    int nComponents = 0;
+    int nHMax = 0;
+    int nVMax = 0;
+    int nRestartInterval = 0;
+    int nHeightOffset = 0;
+    vsi_l_offset nScanStart = 0;
+    std::vector<GByte> abySegment;
+    while( bOK && nScanStart == 0 )
+    {
+        if( VSIFSeekL(fpImage, nPos, SEEK_SET) != 0 ||
+            VSIFReadL(abyBuf, 4, 1, fpImage) != 1 ||
+            abyBuf[0] != 0xFF )
+        {
+            bOK = false;
+            break;
+        }
+        const GByte byMarker = abyBuf[1];
+        const int nSegmentSize = (abyBuf[2] << 8) | abyBuf[3];
+        if( nSegmentSize < 2 ||
+            nPos + 2 + nSegmentSize - nSubfileOffset > 10 * 1024 * 1024 )
+        {
+            bOK = false;
+            break;
+        }
+        abySegment.resize(nSegmentSize - 2);
+        if( !abySegment.empty() &&
+            VSIFReadL(&abySegment[0], abySegment.size(), 1, fpImage) != 1 )
+        {
+            bOK = false;
+            break;
+        }
+
+        if( byMarker == 0xC0 || byMarker == 0xC1 )
+        {
+            // Baseline or extended sequential Huffman frame.
+            if( abySegment.size() < 6 || nComponents != 0 )
+            {
+                bOK = false;
+                break;
+            }
+            const int nHeight = (abySegment[1] << 8) | abySegment[2];
+            const int nWidth = (abySegment[3] << 8) | abySegment[4];
+            nComponents = abySegment[5];
+            if( abySegment[0] != 8 ||
+                nHeight != nRasterYSize || nWidth != nRasterXSize ||
+                (nComponents != 1 && nComponents != 3) ||
+                abySegment.size() < 6 + 3 * static_cast<size_t>(nComponents) )
+            {
+                bOK = false;
+                break;
+            }
+            for( int i = 0; i < nComponents; i++ )
+            {
+                nHMax = std::max(nHMax, abySegment[6 + 3 * i + 1] >> 4);
+                nVMax = std::max(nVMax, abySegment[6 + 3 * i + 1] & 0xF);
+            }
+            nHeightOffset = static_cast<int>(nPos - nSubfileOffset) + 5;
+        }
+        else if( byMarker == 0xC4 )
+        {
+            bHasDHT = true;
+        }
+        else if( byMarker == 0xDB )
+        {
+            bHasDQT = true;
+        }
+        else if( byMarker == 0xDD )
+        {
+            if( abySegment.size() != 2 )
+            {
+                bOK = false;
+                break;
+            }
+            nRestartInterval = (abySegment[0] << 8) | abySegment[1];
+        }
+        else if( byMarker == 0xDA )
+        {
+            // Only a single scan with all the components can be split.
+            if( abySegment.empty() || nComponents == 0 ||
+                abySegment[0] != nComponents )
+            {
+                bOK = false;
+                break;
+            }
+            nScanStart = nPos + 2 + nSegmentSize;
+        }
+        else if( (byMarker >= 0xC2 && byMarker <= 0xCF) ||
+                 (byMarker >= 0xD0 && byMarker <= 0xD9) ||
+                 byMarker == 0x01 || byMarker == 0xFF )
+        {
+            // Progressive, lossless, arithmetic coded or unexpected marker.
+            bOK = false;
+            break;
+        }
+        nPos += 2 + nSegmentSize;
+    }
+
+    bOK = bOK && bHasDHT && bHasDQT && nRestartInterval > 0 &&
+          nHMax > 0 && nVMax > 0;
+    if( bOK )
+    {
+        abyRestartHeader.resize(
+            static_cast<size_t>(nScanStart - nSubfileOffset));
+        bOK = VSIFSeekL(fpImage, nSubfileOffset, SEEK_SET) == 0 &&
+              VSIFReadL(&abyRestartHeader[0], abyRestartHeader.size(), 1,
+                        fpImage) == 1;
+    }
+
+    // Scan the entropy coded data for RSTn and EOI markers.  Each interval
+    // ends at the 0xFF byte introducing the marker that terminates it.
+    anRestartStart.clear();
+    anRestartEnd.clear();
+    if( bOK )
+    {
+        anRestartStart.push_back(nScanStart);
+        std::vector<GByte> abyChunk(1024 * 1024);
+        vsi_l_offset nChunkPos = nScanStart;
+        bool bPrevFF = false;
+        bool bEOI = false;
+        while( bOK && !bEOI )
+        {
+            const size_t nRead =
+                VSIFReadL(&abyChunk[0], 1, abyChunk.size(), fpImage);
+            if( nRead == 0 )
+            {
+                bOK = false;
+                break;
+            }
+            size_t i = 0;
+            while( i < nRead )
+            {
+                if( !bPrevFF )
+                {
+                    const void* pFF = memchr(&abyChunk[i], 0xFF, nRead - i);
+                    if( pFF == nullptr )
+                        break;
+                    i = static_cast<const GByte*>(pFF) - &abyChunk[0] + 1;
+                    bPrevFF = true;
+                    continue;
+                }
+                const GByte byVal = abyChunk[i];
+                if( byVal != 0xFF )
+                {
+                    bPrevFF = false;
+                    if( byVal >= 0xD0 && byVal <= 0xD7 )
+                    {
+                        if( byVal - 0xD0 != static_cast<int>(
+                                (anRestartEnd.size() % 8)) )
+                        {
+                            bOK = false;
+                            break;
+                        }
+                        anRestartEnd.push_back(nChunkPos + i - 1);
+                        anRestartStart.push_back(nChunkPos + i + 1);
+                    }
+                    else if( byVal == 0xD9 )
+                    {
+                        anRestartEnd.push_back(nChunkPos + i - 1);
+                        bEOI = true;
+                        break;
+                    }
+                    else if( byVal != 0x00 )
+                    {
+                        bOK = false;
+                        break;
+                    }
+                }
+                i++;
+            }
+            nChunkPos += nRead;
+        }
+    }
+
+    VSIFSeekL(fpImage, nSavedPos, SEEK_SET);
+
+    // Group intervals so that each group covers whole MCU rows.
+    if( bOK )
+    {
+        const int nMCUWidth = nComponents == 1 ? 8 : 8 * nHMax;
+        const int nMCUHeight = nComponents == 1 ? 8 : 8 * nVMax;
+        const GUIntBig nMCUsPerRow =
+            (nRasterXSize + nMCUWidth - 1) / nMCUWidth;
+        const GUIntBig nMCURows =
+            (nRasterYSize + nMCUHeight - 1) / nMCUHeight;
+        const GUIntBig nIntervals =
+            (nMCUsPerRow * nMCURows + nRestartInterval - 1) /
+            nRestartInterval;
+        GUIntBig nGCD = nMCUsPerRow;
+        GUIntBig nOther = nRestartInterval;
+        while( nOther != 0 )
+        {
+            const GUIntBig nTmp = nGCD % nOther;
+            nGCD = nOther;
+            nOther = nTmp;
+        }
+        const GUIntBig nMCUsPerGroup =
+            nMCUsPerRow / nGCD * nRestartInterval;
+        const GUIntBig nLinesPerGroup =
+            nMCUsPerGroup / nMCUsPerRow * nMCUHeight;
+        bOK = nIntervals == anRestartStart.size() &&
+              nLinesPerGroup < static_cast<GUIntBig>(nRasterYSize);
+        if( bOK )
+        {
+            nRestartIntervalsPerGroup =
+                static_cast<int>(nMCUsPerGroup / nRestartInterval);
+            nRestartLinesPerGroup = static_cast<int>(nLinesPerGroup);
+            nRestartHeightOffset = nHeightOffset;
+            // Fancy upsampling of vertically subsampled chroma uses the
+            // neighbouring rows, so strips must then be decoded with one
+            // extra group on each side.
+            bRestartNeedsContext = nComponents > 1 && nVMax > 1;
+        }
+    }
+
+    if( !bOK )
+    {
+        abyRestartHeader.clear();
+        anRestartStart.clear();
+        anRestartEnd.clear();
+        return false;
+    }
+
+    CPLDebug("JPEG",
+             "%d restart intervals, decodable by groups of %d (%d lines)",
+             static_cast<int>(anRestartStart.size()),
+             nRestartIntervalsPerGroup, nRestartLinesPerGroup);
+    nRestartLayoutStatus = 1;
+    return true;
+}
+
+/************************************************************************/
+/*                     JPGGetDecodeThreadCount()                        */
+/************************************************************************/
+
+static int JPGGetDecodeThreadCount()
+{
+    return CPLGetNumThreadsOption(nullptr, "1");
+}
+
+/************************************************************************/
+/*                      CanUseParallelRestartIO()                       */
+/************************************************************************/
+
+bool JPGDatasetCommon::CanUseParallelRestartIO( int nYOff, int nYSize,
+                                                int nBandCount,
+                                                const int *panBandMap,
+                                                GSpacing nPixelSpace,
+                                                GSpacing nBandSpace,
+                                                int nThreads )
+{
+    if( nThreads <= 1 || nScaleFactor != 1 || GetDataPrecision() != 8 ||
+        nPixelSpace > INT_MAX || nPixelSpace < INT_MIN ||
+        nBandSpace > INT_MAX || nBandSpace < INT_MIN )
+        return false;
+
+    const int eColorSpace = GetOutColorSpace();
+    if( !((eColorSpace == JCS_GRAYSCALE && nBands == 1) ||
+          ((eColorSpace == JCS_RGB || eColorSpace == JCS_YCbCr) &&
+           nBands == 3)) )
+        return false;
+    for( int i = 0; i < nBandCount; i++ )
+    {
+        if( panBandMap[i] < 1 || panBandMap[i] > nBands )
+            return false;
+    }
+
+    if( !InitRestartLayout() )
+        return false;
+
+    // Worth it only if the request spans several groups of intervals.
+    const int nFirstGroup = nYOff / nRestartLinesPerGroup;
+    const int nLastGroup = (nYOff + nYSize - 1) / nRestartLinesPerGroup;
+    return nLastGroup > nFirstGroup;
+}
+
+/************************************************************************/
+/*                            JPGRestartJob                             */
+/************************************************************************/
+
+namespace {
+
+struct JPGErrorMessage
+{
+    CPLErr      eErr;
+    CPLErrorNum nNum;
+    CPLString   osMsg;
+};
+
+struct JPGRestartJob
+{
+    std::vector<GByte> abyData{};  // standalone JPEG stream of the strip
+    int nFirstLine = 0;            // image line of the first strip line
+    int nLines = 0;                // height of the strip
+    int nCopyStart = 0;            // image lines of the strip to copy
+    int nCopyEnd = 0;              // into the request buffer
+    int nWidth = 0;
+    int nComponents = 0;
+    int eOutColorSpace = 0;
+
+    int nXOff = 0;
+    int nXSize = 0;
+    int nYOff = 0;
+    GByte *pabyData = nullptr;
+    GDALDataType eBufType = GDT_Byte;
+    int nBandCount = 0;
+    const int *panBandMap = nullptr;
+    int nPixelSpace = 0;
+    GSpacing nLineSpace = 0;
+    int nBandSpace = 0;
+
+    // Thread-local configuration options of the calling thread, such as
+    // GDAL_ERROR_ON_LIBJPEG_WARNING or GDAL_JPEG_MAX_ALLOWED_SCAN_NUMBER.
+    CPLStringList aosConfigOptions{};
+
+    bool bSuccess = false;
+    std::vector<JPGErrorMessage> aoErrors{};
+};
+
+} // namespace
+
+static std::mutex gMutexDecodeThreadPool;
+static CPLWorkerThreadPool *gpoDecodeThreadPool = nullptr;
+
+/************************************************************************/
+/*                     JPGRestartJobErrorHandler()                      */
+/************************************************************************/
+
+static void CPL_STDCALL JPGRestartJobErrorHandler( CPLErr eErr,
+                                                   CPLErrorNum nNum,
+                                                   const char *pszMsg )
+{
+    JPGRestartJob *psJob =
+        static_cast<JPGRestartJob *>(CPLGetErrorHandlerUserData());
+    JPGErrorMessage oMsg;
+    oMsg.eErr = eErr;
+    oMsg.nNum = nNum;
+    oMsg.osMsg = pszMsg;
+    psJob->aoErrors.push_back(oMsg);
+}
+
+/************************************************************************/
+/*                        JPGDecodeRestartStrip()                       */
+/************************************************************************/
+
+static bool JPGDecodeRestartStrip( JPGRestartJob *psJob, VSILFILE *fp,
+                                   GByte *pabyScanline )
+{
+    GDALJPEGUserData sUserData;
+    struct jpeg_error_mgr sJErr;
+    struct jpeg_progress_mgr sJProgress;
+    struct jpeg_decompress_struct sDInfo;
+    memset(&sDInfo, 0, sizeof(sDInfo));
+    sDInfo.err = jpeg_std_error(&sJErr);
+    sJErr.error_exit = JPGDataset::ErrorExit;
+    sUserData.p_previous_emit_message = sJErr.emit_message;
+    sJErr.emit_message = JPGDataset::EmitMessage;
+    sDInfo.client_data = &sUserData;
+
+    // Setup to trap a fatal error.
+    if( setjmp(sUserData.setjmp_buffer) )
+    {
+        jpeg_destroy_decompress(&sDInfo);
+        return false;
+    }
+
+    jpeg_create_decompress(&sDInfo);
+    jpeg_vsiio_src(&sDInfo, fp);
+    jpeg_read_header(&sDInfo, TRUE);
+    sDInfo.out_color_space = static_cast<J_COLOR_SPACE>(psJob->eOutColorSpace);
+    sDInfo.progress = &sJProgress;
+    sJProgress.progress_monitor = JPGDataset::ProgressMonitor;
+    jpeg_start_decompress(&sDInfo);
+
+    if( sDInfo.output_components != psJob->nComponents ||
+        static_cast<int>(sDInfo.output_height) != psJob->nLines )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "Unexpected layout of restart interval strip");
+        jpeg_destroy_decompress(&sDInfo);
+        return false;
+    }
+
+    const int nEndLine = psJob->nCopyEnd - psJob->nFirstLine;
+    for( int iLine = 0; iLine < nEndLine; iLine++ )
+    {
+        JSAMPLE *ppSamples = reinterpret_cast<JSAMPLE *>(pabyScanline);
+        jpeg_read_scanlines(&sDInfo, &ppSamples, 1);
+        if( sUserData.bNonFatalErrorEncountered )
+        {
+            jpeg_destroy_decompress(&sDInfo);
+            return false;
+        }
+
+        const int iImageLine = psJob->nFirstLine + iLine;
+        if( iImageLine < psJob->nCopyStart )
+            continue;
+        GByte *pabyDstLine = psJob->pabyData +
+            (iImageLine - psJob->nYOff) * psJob->nLineSpace;
+        for( int iBand = 0; iBand < psJob->nBandCount; iBand++ )
+        {
+            GDALCopyWords(pabyScanline +
+                              psJob->nXOff * psJob->nComponents +
+                              psJob->panBandMap[iBand] - 1,
+                          GDT_Byte, psJob->nComponents,
+                          pabyDstLine +
+                              static_cast<GPtrDiff_t>(iBand) *
+                                  psJob->nBandSpace,
+                          psJob->eBufType, psJob->nPixelSpace,
+                          psJob->nXSize);
+        }
+    }
+
+    jpeg_destroy_decompress(&sDInfo);
+    return true;
+}
+
+/************************************************************************/
+/*                          JPGRestartJobFunc()                         */
+/************************************************************************/
+
+static void JPGRestartJobFunc( void *pData )
+{
+    JPGRestartJob *psJob = static_cast<JPGRestartJob *>(pData);
+
+    CPLPushErrorHandlerEx(JPGRestartJobErrorHandler, psJob);
+    char **papszOldConfigOptions = CPLGetThreadLocalConfigOptions();
+    CPLSetThreadLocalConfigOptions(psJob->aosConfigOptions.List());
+
+    const CPLString osTmpFilename(
+        CPLSPrintf("/vsimem/jpeg_restart_%p.jpg", psJob));
+    VSILFILE *fp = VSIFileFromMemBuffer(osTmpFilename,
+                                        &psJob->abyData[0],
+                                        psJob->abyData.size(), FALSE);
+    GByte *pabyScanline = static_cast<GByte *>(
+        VSI_MALLOC2_VERBOSE(psJob->nComponents, psJob->nWidth));
+    if( fp != nullptr && pabyScanline != nullptr )
+        psJob->bSuccess = JPGDecodeRestartStrip(psJob, fp, pabyScanline);
+
+    CPLFree(pabyScanline);
+    if( fp != nullptr )
+        VSIFCloseL(fp);
+    VSIUnlink(osTmpFilename);
+
+    CPLSetThreadLocalConfigOptions(papszOldConfigOptions);
+    CSLDestroy(papszOldConfigOptions);
+    CPLPopErrorHandler();
+}
+
+/************************************************************************/
+/*                         ParallelRestartIO()                          */
+/*                                                                      */
+/*      Decode the requested window by strips of whole restart          */
+/*      intervals, each one rewrapped as a standalone JPEG stream and   */
+/*      decompressed in a worker thread.                                */
+/************************************************************************/
+
+CPLErr JPGDatasetCommon::ParallelRestartIO( int nXOff, int nYOff,
+                                            int nXSize, int nYSize,
+                                            void *pData,
+                                            GDALDataType eBufType,
+                                            int nBandCount,
+                                            const int *panBandMap,
+                                            GSpacing nPixelSpace,
+                                            GSpacing nLineSpace,
+                                            GSpacing nBandSpace,
+                                            int nThreads )
+{
+    // Borrow the thread pool left by a previous request, if any.
+    CPLWorkerThreadPool *poPool = nullptr;
+    {
+        std::lock_guard<std::mutex> oLock(gMutexDecodeThreadPool);
+        if( gpoDecodeThreadPool &&
+            gpoDecodeThreadPool->GetThreadCount() == nThreads )
+        {
+            poPool = gpoDecodeThreadPool;
+            gpoDecodeThreadPool = nullptr;
+        }
+    }
+    if( poPool == nullptr )
+    {
+        poPool = new CPLWorkerThreadPool();
+        if( !poPool->Setup(nThreads, nullptr, nullptr) )
+        {
+            delete poPool;
+            return CE_Failure;
+        }
+    }
+
+    const int nFirstGroup = nYOff / nRestartLinesPerGroup;
+    const int nGroups =
+        (nYOff + nYSize - 1) / nRestartLinesPerGroup - nFirstGroup + 1;
+    const int nJobs = std::min(nGroups, nThreads);
+    const int nIntervals = static_cast<int>(anRestartStart.size());
+    const int nTotalGroups =
+        (nRasterYSize + nRestartLinesPerGroup - 1) / nRestartLinesPerGroup;
+    const int nComponents = nBands;
+
+    std::vector<JPGRestartJob> asJobs(nJobs);
+    const CPLStringList aosConfigOptions(CPLGetThreadLocalConfigOptions(),
+                                         TRUE);
+    const vsi_l_offset nSavedPos = VSIFTellL(fpImage);
+    bool bOK = true;
+    for( int iJob = 0; iJob < nJobs && bOK; iJob++ )
+    {
+        int iGroupStart =
+            nFirstGroup + static_cast<int>(
+                static_cast<GIntBig>(iJob) * nGroups / nJobs);
+        int iGroupEnd =
+            nFirstGroup + static_cast<int>(
+                static_cast<GIntBig>(iJob + 1) * nGroups / nJobs);
+
+        JPGRestartJob &sJob = asJobs[iJob];
+        sJob.nCopyStart = std::max(nYOff,
+                                   iGroupStart * nRestartLinesPerGroup);
+        sJob.nCopyEnd = std::min(nYOff + nYSize,
+                                 iGroupEnd * nRestartLinesPerGroup);
+        if( bRestartNeedsContext )
+        {
+            iGroupStart = std::max(0, iGroupStart - 1);
+            iGroupEnd = std::min(nTotalGroups, iGroupEnd + 1);
+        }
+        const int iIntervalStart = iGroupStart * nRestartIntervalsPerGroup;
+        const int iIntervalEnd =
+            std::min(nIntervals, iGroupEnd * nRestartIntervalsPerGroup);
+
+        sJob.nFirstLine = iGroupStart * nRestartLinesPerGroup;
+        sJob.nLines = std::min(nRasterYSize,
+                               iGroupEnd * nRestartLinesPerGroup) -
+                      sJob.nFirstLine;
+        sJob.nWidth = nRasterXSize;
+        sJob.nComponents = nComponents;
+        sJob.eOutColorSpace = GetOutColorSpace();
+        sJob.nXOff = nXOff;
+        sJob.nXSize = nXSize;
+        sJob.nYOff = nYOff;
+        sJob.pabyData = static_cast<GByte *>(pData);
+        sJob.eBufType = eBufType;
+        sJob.nBandCount = nBandCount;
+        sJob.panBandMap = panBandMap;
+        sJob.nPixelSpace = static_cast<int>(nPixelSpace);
+        sJob.nLineSpace = nLineSpace;
+        sJob.nBandSpace = static_cast<int>(nBandSpace);
+        sJob.aosConfigOptions = aosConfigOptions;
+
+        // Header with the frame height patched, followed by the entropy
+        // coded data of the intervals with their RSTn markers renumbered.
+        const vsi_l_offset nDataStart = anRestartStart[iIntervalStart];
+        const size_t nDataSize = static_cast<size_t>(
+            anRestartEnd[iIntervalEnd - 1] - nDataStart);
+        const size_t nHeaderSize = abyRestartHeader.size();
+        try
+        {
+            sJob.abyData.resize(nHeaderSize + nDataSize + 2);
+        }
+        catch( const std::bad_alloc& )
+        {
+            CPLError(CE_Failure, CPLE_OutOfMemory,
+                     "Cannot allocate memory for restart interval strip");
+            bOK = false;
+            break;
+        }
+        memcpy(&sJob.abyData[0], &abyRestartHeader[0], nHeaderSize);
+        sJob.abyData[nRestartHeightOffset] =
+            static_cast<GByte>(sJob.nLines >> 8);
+        sJob.abyData[nRestartHeightOffset + 1] =
+            static_cast<GByte>(sJob.nLines & 0xFF);
+        if( VSIFSeekL(fpImage, nDataStart, SEEK_SET) != 0 ||
+            VSIFReadL(&sJob.abyData[nHeaderSize], 1, nDataSize,
+                      fpImage) != nDataSize )
+        {
+            CPLError(CE_Failure, CPLE_FileIO,
+                     "Cannot read restart intervals %d to %d",
+                     iIntervalStart, iIntervalEnd - 1);
+            bOK = false;
+            break;
+        }
+        for( int i = iIntervalStart; i + 1 < iIntervalEnd; i++ )
+        {
+            sJob.abyData[nHeaderSize + static_cast<size_t>(
+                anRestartEnd[i] + 1 - nDataStart)] =
+                static_cast<GByte>(0xD0 + (i - iIntervalStart) % 8);
+        }
+        sJob.abyData[nHeaderSize + nDataSize] = 0xFF;
+        sJob.abyData[nHeaderSize + nDataSize + 1] = 0xD9;
+
+        // Start decoding this strip while reading the next ones.
+        poPool->SubmitJob(JPGRestartJobFunc, &sJob);
+    }
+    poPool->WaitCompletion();
+    VSIFSeekL(fpImage, nSavedPos, SEEK_SET);
+
+    {
+        std::lock_guard<std::mutex> oLock(gMutexDecodeThreadPool);
+        delete gpoDecodeThreadPool;
+        gpoDecodeThreadPool = poPool;
+    }
+
+    if( !bOK )
+        return CE_Failure;
+
+    // Re-emit in the calling thread what the workers reported.
+    CPLErr eErr = CE_None;
+    for( const auto &sJob : asJobs )
+    {
+        for( const auto &oMsg : sJob.aoErrors )
+            CPLError(oMsg.eErr, oMsg.nNum, "%s", oMsg.osMsg.c_str());
+        if( !sJob.bSuccess )
+            eErr = CE_Failure;
+    }
+    return eErr;
+}
+
+/************************************************************************/
+/*                      JPGDestroyDecodeThreadPool()                    */
+/************************************************************************/
+
+static void JPGDestroyDecodeThreadPool( CPL_UNUSED GDALDriver *poDriver )
+{
+    std::lock_guard<std::mutex> oLock(gMutexDecodeThreadPool);
+    delete gpoDecodeThreadPool;
+    gpoDecodeThreadPool = nullptr;
+}
+
 /************************************************************************/
 /*                             IRasterIO()                              */
 /*                                                                      */
@@ -1869,6 +2523,22 @@ CPLErr JPGDatasetCommon::IRasterIO( GDALRWFlag eRWFlag,
     }
 
 #ifndef JPEG_LIB_MK1
+    // Decode strips of restart intervals in parallel when the image has
+    // been written with restart markers.
+    if( eRWFlag == GF_Read && pData != nullptr &&
+        nXSize == nBufXSize && nYSize == nBufYSize )
+    {
+        const int nThreads = JPGGetDecodeThreadCount();
+        if( CanUseParallelRestartIO(nYOff, nYSize, nBandCount, panBandMap,
+                                    nPixelSpace, nBandSpace, nThreads) )
+        {
+            return ParallelRestartIO(nXOff, nYOff, nXSize, nYSize,
+                                     pData, eBufType, nBandCount, panBandMap,
+                                     nPixelSpace, nLineSpace, nBandSpace,
+                                     nThreads);
+        }
+    }
+
     if((eRWFlag == GF_Read) &&
        (nBandCount == 3) &&
        (nBands == 3) &&
@@ -3469,11 +4139,29 @@ JPGDataset::CreateCopyStage2( const char *pszFilename, GDALDataset *poSrcDS,
     return poJPG_DS;
 }
 
+#if !defined(JPGDataset)
+
 /************************************************************************/
-/*                         GDALRegister_JPEG()                          */
+/*                   GDALGetDeclaredMetadata_JPEG()                   */
 /************************************************************************/
 
-#if !defined(JPGDataset)
+// Items that GDALAllRegister() declares for the driver before registering it.
+CSLConstList GDALGetDeclaredMetadata_JPEG()
+{
+    static const char* const apszMD[] = {
+        GDAL_DCAP_OPEN "=YES",
+        GDAL_DCAP_RASTER "=YES",
+        GDAL_DMD_LONGNAME "=JPEG JFIF",
+        GDAL_DMD_EXTENSION "=jpg",
+        GDAL_DMD_EXTENSIONS "=jpg jpeg",
+        GDAL_DMD_OPEN_SIGNATURES "=0:FFD8FF",
+        nullptr };
+    return apszMD;
+}
+
+/************************************************************************/
+/*                         GDALRegister_JPEG()                          */
+/************************************************************************/
 
 char **GDALJPGDriver::GetMetadata( const char *pszDomain )
 {
@@ -3566,11 +4254,9 @@ void GDALRegister_JPEG()
     GDALDriver *poDriver = new GDALJPGDriver();
 
     poDriver->SetDescription("JPEG");
-    poDriver->SetMetadataItem(GDAL_DCAP_RASTER, "YES");
-    poDriver->SetMetadataItem(GDAL_DMD_LONGNAME, "JPEG JFIF");
+    poDriver->SetMetadata(
+        const_cast<char**>(GDALGetDeclaredMetadata_JPEG()));
     poDriver->SetMetadataItem(GDAL_DMD_HELPTOPIC, "drivers/raster/jpeg.html");
-    poDriver->SetMetadataItem(GDAL_DMD_EXTENSION, "jpg");
-    poDriver->SetMetadataItem(GDAL_DMD_EXTENSIONS, "jpg jpeg");
     poDriver->SetMetadataItem(GDAL_DMD_MIMETYPE, "image/jpeg");
 
 #if defined(JPEG_LIB_MK1_OR_12BIT) || defined(JPEG_DUAL_MODE_8_12)
@@ -3588,6 +4274,7 @@ void GDALRegister_JPEG()
     poDriver->pfnIdentify = JPGDatasetCommon::Identify;
     poDriver->pfnOpen = JPGDatasetCommon::Open;
     poDriver->pfnCreateCopy = JPGDataset::CreateCopy;
+    poDriver->pfnUnloadDriver = JPGDestroyDecodeThreadPool;
 
     GetGDALDriverManager()->RegisterDriver(poDriver);
 }
@@ -49,6 +49,7 @@
 
 #include <algorithm>
 #include <string>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
@@ -236,6 +237,28 @@ class JPGDatasetCommon CPL_NON_FINAL: public GDALPamDataset
     void   LoadWorldFileOrTab();
     CPLString osWldFilename;
 
+    // Layout of the restart intervals of a baseline JPEG, so that groups of
+    // them can be decoded independently and in parallel.
+    int    nRestartLayoutStatus = 0;  // 0: not computed, 1: usable, -1: not
+    std::vector<GByte> abyRestartHeader{};  // from SOI to the end of SOS
+    int    nRestartHeightOffset = 0;  // offset of the height in the SOF
+    std::vector<vsi_l_offset> anRestartStart{};  // entropy coded data
+    std::vector<vsi_l_offset> anRestartEnd{};    // of each interval
+    int    nRestartIntervalsPerGroup = 0;
+    int    nRestartLinesPerGroup = 0;
+    bool   bRestartNeedsContext = false;  // vertical chroma upsampling
+
+    bool   InitRestartLayout();
+    bool   CanUseParallelRestartIO( int nYOff, int nYSize,
+                                    int nBandCount, const int *panBandMap,
+                                    GSpacing nPixelSpace, GSpacing nBandSpace,
+                                    int nThreads );
+    CPLErr ParallelRestartIO( int nXOff, int nYOff, int nXSize, int nYSize,
+                              void *pData, GDALDataType eBufType,
+                              int nBandCount, const int *panBandMap,
+                              GSpacing nPixelSpace, GSpacing nLineSpace,
+                              GSpacing nBandSpace, int nThreads );
+
     virtual int         CloseDependentDatasets() override;
 
     virtual CPLErr IBuildOverviews( const char *, int, int *, int, int *,
@@ -286,9 +309,6 @@ class JPGDataset final: public JPGDatasetCommon
 
     bool ErrorOutOnNonFatalError();
 
-    static void EmitMessage(j_common_ptr cinfo, int msg_level);
-    static void ProgressMonitor (j_common_ptr cinfo );
-
     struct jpeg_decompress_struct sDInfo;
     struct jpeg_error_mgr sJErr;
     struct jpeg_progress_mgr sJProgress;
@@ -325,6 +345,8 @@ class JPGDataset final: public JPGDatasetCommon
         GDALJPEGUserData &sUserData, struct jpeg_compress_struct &sCInfo,
         struct jpeg_error_mgr &sJErr, GByte *&pabyScanline);
     static void ErrorExit(j_common_ptr cinfo);
+    static void EmitMessage(j_common_ptr cinfo, int msg_level);
+    static void ProgressMonitor (j_common_ptr cinfo );
 };
 
 /************************************************************************/
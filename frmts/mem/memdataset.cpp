@@ -248,6 +248,32 @@ CPLErr MEMRasterBand::IRasterIO( GDALRWFlag eRWFlag,
                                  GSpacing nLineSpaceBuf,
                                  GDALRasterIOExtraArg* psExtraArg )
 {
+    if( eRWFlag == GF_Read &&
+        (nXSize != nBufXSize || nYSize != nBufYSize) &&
+        psExtraArg->eResampleAlg == GRIORA_NearestNeighbour )
+    {
+        if( (nBufXSize < nXSize || nBufYSize < nYSize) &&
+            GetOverviewCount() > 0 )
+        {
+            int bTried = FALSE;
+            const CPLErr eErr = TryOverviewRasterIO(
+                eRWFlag, nXOff, nYOff, nXSize, nYSize,
+                pData, nBufXSize, nBufYSize, eBufType,
+                nPixelSpaceBuf, nLineSpaceBuf, psExtraArg, &bTried );
+            if( bTried )
+                return eErr;
+        }
+
+        // Subsample directly from memory rather than through the block
+        // cache.
+        FlushCache();
+        return ReadFromDirectView( pabyData, nPixelOffset, nLineOffset,
+                                   nXOff, nYOff, nXSize, nYSize,
+                                   pData, nBufXSize, nBufYSize, eBufType,
+                                   nPixelSpaceBuf, nLineSpaceBuf,
+                                   psExtraArg );
+    }
+
     if( nXSize != nBufXSize || nYSize != nBufYSize )
     {
         return GDALRasterBand::IRasterIO(eRWFlag, nXOff, nYOff, nXSize, nYSize,
@@ -296,6 +322,21 @@ CPLErr MEMRasterBand::IRasterIO( GDALRWFlag eRWFlag,
     return CE_None;
 }
 
+/************************************************************************/
+/*                        GetDirectReadPointer()                        */
+/************************************************************************/
+
+const void *MEMRasterBand::GetDirectReadPointer( GSpacing *pnPixelSpace,
+                                                 GSpacing *pnLineSpace )
+{
+    // In case block based I/O has been done before.
+    FlushCache();
+
+    *pnPixelSpace = nPixelOffset;
+    *pnLineSpace = nLineOffset;
+    return pabyData;
+}
+
 /************************************************************************/
 /*                             IRasterIO()                              */
 /************************************************************************/
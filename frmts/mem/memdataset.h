@@ -193,6 +193,8 @@ class CPL_DLL MEMRasterBand CPL_NON_FINAL: public GDALPamRasterBand
                                   GSpacing nPixelSpaceBuf,
                                   GSpacing nLineSpaceBuf,
                                   GDALRasterIOExtraArg* psExtraArg ) override;
+    virtual const void *GetDirectReadPointer( GSpacing *pnPixelSpace,
+                                              GSpacing *pnLineSpace ) override;
     virtual double GetNoDataValue( int *pbSuccess = nullptr ) override;
     virtual CPLErr SetNoDataValue( double ) override;
     virtual CPLErr DeleteNoDataValue() override;
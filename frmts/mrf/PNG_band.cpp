@@ -326,16 +326,20 @@ CPLErr PNG_Band::Decompress(buf_mgr &dst, buf_mgr &src)
 
 CPLErr PNG_Band::Compress(buf_mgr &dst, buf_mgr &src)
 {
-    if (!codec.PNGColors && img.comp == IL_PPNG) { // Late set PNG palette to conserve memory
-        GDALColorTable *poCT = GetColorTable();
-        if (!poCT) {
-            CPLError(CE_Failure, CPLE_NotSupported, "MRF PPNG needs a color table");
-            return CE_Failure;
+    {
+        // Pages might be compressed by multiple threads
+        std::lock_guard<std::mutex> lock(paletteMutex);
+        if (!codec.PNGColors && img.comp == IL_PPNG) { // Late set PNG palette to conserve memory
+            GDALColorTable *poCT = GetColorTable();
+            if (!poCT) {
+                CPLError(CE_Failure, CPLE_NotSupported, "MRF PPNG needs a color table");
+                return CE_Failure;
+            }
+            ResetPalette(poCT, codec);
         }
-        ResetPalette(poCT, codec);
-    }
 
-    codec.deflate_flags = deflate_flags;
+        codec.deflate_flags = deflate_flags;
+    }
     return codec.CompressPNG(dst, src);
 }
 
@@ -45,12 +45,14 @@
 
 #include "marfa.h"
 
+#include <atomic>
+
 CPL_CVSID("$Id: Tif_band.cpp 3f68d11104319388dc0f0c2faaf07e60198e8096 2019-10-05 11:41:37 +0200 Even Rouault $")
 
 NAMESPACE_MRF_START
 
 // Returns a string in /vsimem/ + prefix + count that doesn't exist when this function gets called
-// It is not thread safe, open the result as soon as possible
+// The counter is atomic, so concurrent calls get different names
 static CPLString uniq_memfname(const char *prefix)
 {
 
@@ -61,7 +63,7 @@ static CPLString uniq_memfname(const char *prefix)
 #else
     CPLString fname;
     VSIStatBufL statb;
-    static unsigned int cnt=0;
+    static std::atomic<unsigned int> cnt(0);
     do fname.Printf("/vsimem/%s_%08x",prefix, cnt++);
     while (!VSIStatL(fname, &statb));
     return fname;
@@ -52,8 +52,12 @@
 #include <gdal_pam.h>
 #include <ogr_srs_api.h>
 #include <ogr_spatialref.h>
+#include "cpl_worker_thread_pool.h"
 
+#include <condition_variable>
 #include <limits>
+#include <map>
+#include <mutex>
 // For printing values
 #include <ostream>
 #include <iostream>
@@ -309,6 +313,34 @@ enum { SAMPLING_ERR, SAMPLING_Avg, SAMPLING_Near };
 
 GDALMRFRasterBand *newMRFRasterBand(GDALMRFDataset *, const ILImage &, int, int level = 0);
 
+// An error raised by a worker thread, to be emitted again by the calling thread
+struct MRFErrorMessage {
+    CPLErr eErr;
+    CPLErrorNum nNum;
+    CPLString osMsg;
+};
+
+// A page encoded by a worker thread, then written in the order it was submitted
+struct MRFWriteJob {
+    GDALMRFRasterBand *band;
+    GUIntBig infooffset;
+    char *tbuffer;  // The raw page followed by room for the encoded one, owned
+    buf_mgr dst;    // The encoded page, empty for an empty tile
+    GUIntBig seq;
+    CPLErr ret;
+};
+
+// A page read from the data file, decoded by a worker thread into the block cache
+struct MRFReadJob {
+    GDALMRFRasterBand *band;
+    int x, y;
+    ILIdx tinfo;
+    void *data;     // The tile as read, followed by PADDING_BYTES, owned until decoded
+    std::vector<GDALRasterBlock *> blocks; // Locked, one per band in the page
+    CPLErr ret;
+    std::vector<MRFErrorMessage> errors; // Raised while decoding
+};
+
 class GDALMRFDataset final: public GDALPamDataset {
     friend class GDALMRFRasterBand;
     friend GDALMRFRasterBand *newMRFRasterBand(GDALMRFDataset *, const ILImage &, int, int level);
@@ -379,6 +411,12 @@ public:
         return pbsize;
     }
 
+    virtual void FlushCache() override;
+
+    virtual CPLErr AdviseRead(int nXOff, int nYOff, int nXSize, int nYSize,
+        int nBufXSize, int nBufYSize, GDALDataType eDT,
+        int nBandCount, int *panBandList, char **papszOptions) override;
+
 protected:
     CPLErr LevelInit(const int l);
 
@@ -432,6 +470,32 @@ protected:
     // Write a tile, the infooffset is the relative position in the index file
     virtual CPLErr WriteTile(void *buff, GUIntBig infooffset, GUIntBig size = 0);
 
+    // Pick the number of worker threads from an option value or GDAL_NUM_THREADS
+    void SetNumThreads(const char *val);
+
+    // The worker threads, null if not multi-threaded
+    CPLWorkerThreadPool *GetThreadPool();
+
+    // Hand a page to the workers for encoding, or directly to the writer if it is empty
+    CPLErr SubmitWrite(MRFWriteJob *job, bool encode);
+
+    // Called when a page is encoded, writes all the pages that are next in order
+    void QueueWrite(MRFWriteJob *job);
+
+    // Wait until all the submitted pages are written, returns the first write error
+    CPLErr WaitWrites();
+
+    // Error handler of the encoding workers, the user data is the dataset
+    static void CPL_STDCALL WorkerErrorHandler(CPLErr eErr, CPLErrorNum nNum, const char *pszMsg);
+
+    // Emit in the calling thread the errors raised by the encoding workers,
+    // then the write error ret, only the first time, returns ret
+    CPLErr ReportWriteErrors(CPLErr ret);
+
+    // Read and decode in parallel the pages of a window that are not in the block cache
+    void PrefetchBlocks(int nXOff, int nYOff, int nXSize, int nYSize,
+        int nBandCount, int *panBandList);
+
     // Custom CopyWholeRaster for Zen JPEG
     CPLErr ZenCopy(GDALDataset *poSrc, GDALProgressFunc pfnProgress, void * pProgressData);
 
@@ -524,6 +588,19 @@ protected:
 
     // statistical values
     std::vector<double> vNoData, vMin, vMax;
+
+    // Multi-threaded page encoding and decoding
+    int nThreads;
+    CPLWorkerThreadPool *poThreadPool;
+    std::mutex oWriteMutex;
+    std::condition_variable oWriteCond;
+    std::map<GUIntBig, MRFWriteJob *> oWriteQueue; // Encoded, waiting for their turn
+    GUIntBig nWriteSeq;  // Sequence number of the next submitted page
+    GUIntBig nWriteNext; // Sequence number of the next page to write
+    CPLErr eWriteErr;
+    bool bWriteErrReported;
+    std::mutex oErrorMutex; // Not oWriteMutex, errors are raised while holding it
+    std::vector<MRFErrorMessage> aoWorkerErrors;
 };
 
 class GDALMRFRasterBand CPL_NON_FINAL: public GDALPamRasterBand {
@@ -564,6 +641,10 @@ public:
     // de-interlace a buffer in pixel blocks
     CPLErr ReadInterleavedBlock(int xblk, int yblk, void *buffer);
 
+    // Worker thread functions, for MRFWriteJob and MRFReadJob
+    static void EncodeJob(void *);
+    static void DecodeJob(void *);
+
     const char *GetOptionValue(const char *opt, const char *def) const;
     void SetAccess(GDALAccess eA) { eAccess = eA; }
     void SetDeflate(int v) { deflatep = (v != 0); }
@@ -594,9 +675,15 @@ protected:
     const CPLStringList & GetOptlist() const { return poDS->optlist; }
 
     // Compression and decompression functions.  To be overwritten by specific implementations
+    // They may be called from multiple threads at the same time
     virtual CPLErr Compress(buf_mgr &dst, buf_mgr &src) = 0;
     virtual CPLErr Decompress(buf_mgr &dst, buf_mgr &src) = 0;
 
+    // Compress and deflate the page at the start of tbuffer, result in dst
+    CPLErr EncodePage(char *tbuffer, buf_mgr &dst);
+    // Inflate and decompress a tile as read from the data file into page, frees data
+    CPLErr DecodePage(void *data, size_t size, void *page);
+
     // Read the index record itself, can be overwritten
     //    virtual CPLErr ReadTileIdx(const ILSize &, ILIdx &, GIntBig bias = 0);
 
@@ -653,6 +740,7 @@ protected:
     virtual CPLErr Compress(buf_mgr &dst, buf_mgr &src) override;
 
     PNG_Codec codec;
+    std::mutex paletteMutex; // The PPNG palette is set on first use
 };
 
 /*
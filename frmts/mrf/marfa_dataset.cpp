@@ -93,7 +93,13 @@ GDALMRFDataset::GDALMRFDataset() :
     bdirty(0),
     bGeoTransformValid(TRUE),
     poColorTable(nullptr),
-    Quality(0)
+    Quality(0),
+    nThreads(1),
+    poThreadPool(nullptr),
+    nWriteSeq(0),
+    nWriteNext(0),
+    eWriteErr(CE_None),
+    bWriteErrReported(false)
 {
     //                X0   Xx   Xy  Y0    Yx   Yy
     double gt[6] = { 0.0, 1.0, 0.0, 0.0, 0.0, 1.0 };
@@ -153,6 +159,8 @@ GDALMRFDataset::~GDALMRFDataset()
 
     GDALMRFDataset::CloseDependentDatasets();
 
+    delete poThreadPool;
+
     if (ifp.FP)
         VSIFCloseL(ifp.FP);
     if (dfp.FP)
@@ -165,24 +173,27 @@ GDALMRFDataset::~GDALMRFDataset()
     pbsize = 0;
 }
 
-#ifdef unused
 /*
  *\brief Called before the IRaster IO gets called
  *
- *
+ * When multi-threaded, reads the tiles covering the window and decodes them in parallel
+ * The tile index records for a row of pages are read at once
  *
  */
 CPLErr GDALMRFDataset::AdviseRead(int nXOff, int nYOff, int nXSize, int nYSize,
     int nBufXSize, int nBufYSize,
-    GDALDataType eDT,
+    GDALDataType /*eDT*/,
     int nBandCount, int *panBandList,
-    char **papszOptions)
+    char ** /*papszOptions*/)
 {
     CPLDebug("MRF_IO", "AdviseRead %d, %d, %d, %d, bufsz %d,%d,%d\n",
         nXOff, nYOff, nXSize, nYSize, nBufXSize, nBufYSize, nBandCount);
+
+    // Decimated reads might use the overviews instead
+    if (nBufXSize == nXSize && nBufYSize == nYSize)
+        PrefetchBlocks(nXOff, nYOff, nXSize, nYSize, nBandCount, panBandList);
     return CE_None;
 }
-#endif
 
 /*
  *\brief Format specific RasterIO, may be bypassed by BlockBasedRasterIO by setting
@@ -207,6 +218,9 @@ CPLErr GDALMRFDataset::IRasterIO(GDALRWFlag eRWFlag, int nXOff, int nYOff, int n
         static_cast<int>(nPixelSpace), static_cast<int>(nLineSpace),
         static_cast<int>(nBandSpace));
 
+    if (eRWFlag == GF_Read && nBufXSize == nXSize && nBufYSize == nYSize)
+        PrefetchBlocks(nXOff, nYOff, nXSize, nYSize, nBandCount, panBandMap);
+
     //
     // Call the parent implementation, which splits it into bands and calls their IRasterIO
     //
@@ -1904,6 +1918,7 @@ void GDALMRFDataset::ProcessOpenOptions(char **papszOptions)
     const char *val = opt.FetchNameValue("ZSLICE");
     if (val)
         zslice = atoi(val);
+    SetNumThreads(opt.FetchNameValue("NUM_THREADS"));
 }
 
 // Apply create options to the current dataset, only valid during creation
@@ -1959,6 +1974,8 @@ void GDALMRFDataset::ProcessCreateOptions(char **papszOptions)
     val = opt.FetchNameValue("SPACING");
     if (val) spacing = atoi(val);
 
+    SetNumThreads(opt.FetchNameValue("NUM_THREADS"));
+
     optlist.Assign(CSLTokenizeString2(opt.FetchNameValue("OPTIONS"),
         " \t\n\r", CSLT_STRIPLEADSPACES | CSLT_STRIPENDSPACES));
 
@@ -2263,6 +2280,262 @@ CPLErr GDALMRFDataset::WriteTile(void *buff, GUIntBig infooffset, GUIntBig size)
     return ret;
 }
 
+//
+// Multi-threading
+//
+// Pages are encoded by the worker threads and written in the order they were submitted,
+// so the data file and the index are the same as when written by a single thread
+// Reads of large windows decode the pages in parallel, straight into the block cache
+//
+
+// Pick the number of threads, val can be a number or ALL_CPUS
+void GDALMRFDataset::SetNumThreads(const char *val)
+{
+    nThreads = CPLGetNumThreadsOption(val, "1");
+}
+
+CPLWorkerThreadPool *GDALMRFDataset::GetThreadPool()
+{
+    if (nThreads < 2)
+        return nullptr;
+    if (poThreadPool == nullptr) {
+        poThreadPool = new CPLWorkerThreadPool();
+        if (!poThreadPool->Setup(nThreads, nullptr, nullptr)) {
+            delete poThreadPool;
+            poThreadPool = nullptr;
+            nThreads = 1;
+        }
+    }
+    return poThreadPool;
+}
+
+// Takes ownership of the job, returns the error of a previous write, if any
+CPLErr GDALMRFDataset::SubmitWrite(MRFWriteJob *job, bool encode)
+{
+    CPLErr ret;
+    {
+        std::unique_lock<std::mutex> lock(oWriteMutex);
+        // Limit the number of pages held in memory
+        oWriteCond.wait(lock, [this] {
+            return nWriteSeq - nWriteNext < static_cast<GUIntBig>(2 * nThreads); });
+        job->seq = nWriteSeq++;
+        ret = eWriteErr;
+    }
+
+    if (!encode)
+        QueueWrite(job);
+    else if (!poThreadPool->SubmitJob(GDALMRFRasterBand::EncodeJob, job))
+        GDALMRFRasterBand::EncodeJob(job);
+    return ReportWriteErrors(ret);
+}
+
+// Called from any thread, the file writes are done while holding the lock
+void GDALMRFDataset::QueueWrite(MRFWriteJob *job)
+{
+    std::lock_guard<std::mutex> lock(oWriteMutex);
+    oWriteQueue[job->seq] = job;
+    while (!oWriteQueue.empty() && oWriteQueue.begin()->first == nWriteNext) {
+        MRFWriteJob *next = oWriteQueue.begin()->second;
+        oWriteQueue.erase(oWriteQueue.begin());
+        CPLErr ret = WriteTile(next->dst.buffer, next->infooffset, next->dst.size);
+        if (ret != CE_None)
+            CPLError(CE_Failure, CPLE_FileIO, "MRF: Error writing the tile at index offset "
+                CPL_FRMT_GUIB, next->infooffset);
+        if (next->ret == CE_None)
+            next->ret = ret;
+        if (eWriteErr == CE_None)
+            eWriteErr = next->ret;
+        CPLFree(next->tbuffer);
+        delete next;
+        nWriteNext++;
+    }
+    oWriteCond.notify_all();
+}
+
+CPLErr GDALMRFDataset::WaitWrites()
+{
+    CPLErr ret;
+    {
+        std::unique_lock<std::mutex> lock(oWriteMutex);
+        oWriteCond.wait(lock, [this] { return nWriteNext == nWriteSeq; });
+        ret = eWriteErr;
+    }
+    return ReportWriteErrors(ret);
+}
+
+void CPL_STDCALL GDALMRFDataset::WorkerErrorHandler(CPLErr eErr, CPLErrorNum nNum, const char *pszMsg)
+{
+    GDALMRFDataset *poDS = static_cast<GDALMRFDataset *>(CPLGetErrorHandlerUserData());
+    std::lock_guard<std::mutex> lock(poDS->oErrorMutex);
+    poDS->aoWorkerErrors.push_back(MRFErrorMessage{eErr, nNum, pszMsg});
+}
+
+CPLErr GDALMRFDataset::ReportWriteErrors(CPLErr ret)
+{
+    std::vector<MRFErrorMessage> errors;
+    {
+        std::lock_guard<std::mutex> lock(oErrorMutex);
+        std::swap(errors, aoWorkerErrors);
+    }
+    for (const auto &err : errors)
+        CPLError(err.eErr, err.nNum, "%s", err.osMsg.c_str());
+
+    if (ret != CE_None && !bWriteErrReported) {
+        bWriteErrReported = true;
+        CPLError(ret, CPLE_FileIO, "MRF: Failed to write %s, the file is incomplete",
+            GetDescription());
+    }
+    return ret;
+}
+
+// The errors of the pending writes are reported here, including at close
+void GDALMRFDataset::FlushCache()
+{
+    GDALPamDataset::FlushCache();
+    WaitWrites();
+}
+
+void GDALMRFDataset::PrefetchBlocks(int nXOff, int nYOff, int nXSize, int nYSize,
+    int nBandCount, int *panBandList)
+{
+    // Only for local MRFs opened read only, caching and single level access use IReadBlock
+    if (eAccess != GA_ReadOnly || !source.empty() || cds != nullptr
+        || nBands == 0 || nXSize <= 0 || nYSize <= 0)
+        return;
+
+    CPLWorkerThreadPool *pool = GetThreadPool();
+    if (pool == nullptr || current.idxfname[0] == '(')
+        return;
+
+    VSILFILE *l_ifp = IdxFP();
+    VSILFILE *l_dfp = DataFP();
+    if (missing || l_ifp == nullptr || l_dfp == nullptr)
+        return;
+
+    GDALMRFRasterBand *b0 = reinterpret_cast<GDALMRFRasterBand *>(GetRasterBand(1));
+    const ILImage &img = b0->img;
+    const int cstride = img.pagesize.c;
+    if (cstride != 1 && cstride != nBands)
+        return;
+
+    const int bx0 = nXOff / img.pagesize.x;
+    const int bx1 = (nXOff + nXSize - 1) / img.pagesize.x;
+    const int by0 = nYOff / img.pagesize.y;
+    const int by1 = (nYOff + nYSize - 1) / img.pagesize.y;
+    if (bx0 == bx1 && by0 == by1)
+        return; // A single page, nothing to gain
+
+    // The bands that own a page, interleaved bands share the page of the first one
+    vector<GDALMRFRasterBand *> pageBands;
+    if (cstride == 1) {
+        for (int i = 0; i < nBandCount; i++)
+            pageBands.push_back(reinterpret_cast<GDALMRFRasterBand *>(
+                GetRasterBand(panBandList ? panBandList[i] : i + 1)));
+    }
+    else
+        pageBands.push_back(b0);
+
+    vector<MRFReadJob> jobs;
+
+    // Reads the tiles in file order, then decodes them in parallel
+    auto decode = [&]() {
+        std::sort(jobs.begin(), jobs.end(), [](const MRFReadJob &a, const MRFReadJob &b) {
+            return a.tinfo.offset < b.tinfo.offset; });
+
+        vector<void *> ready;
+        for (auto &job : jobs) {
+            job.data = VSIMalloc(static_cast<size_t>(job.tinfo.size + PADDING_BYTES));
+            if (job.data == nullptr)
+                continue;
+            VSIFSeekL(l_dfp, job.tinfo.offset, SEEK_SET);
+            if (1 != VSIFReadL(job.data, static_cast<size_t>(job.tinfo.size), 1, l_dfp)) {
+                CPLFree(job.data);
+                job.data = nullptr;
+                continue;
+            }
+            memset(static_cast<char *>(job.data) + static_cast<size_t>(job.tinfo.size), 0, PADDING_BYTES);
+
+            // The decoder writes directly in the cache blocks of all the bands in the page
+            const int nPageBands = (cstride == 1) ? 1 : nBands;
+            for (int i = 0; i < nPageBands; i++) {
+                GDALRasterBand *b = (cstride == 1) ? job.band : GetRasterBand(i + 1);
+                GDALRasterBlock *poBlock = b->GetLockedBlockRef(job.x, job.y, TRUE);
+                if (poBlock == nullptr)
+                    break;
+                job.blocks.push_back(poBlock);
+            }
+
+            if (static_cast<int>(job.blocks.size()) != nPageBands) {
+                job.ret = CE_Failure;
+                continue;
+            }
+            ready.push_back(&job);
+        }
+
+        if (!ready.empty()) {
+            pool->SubmitJobs(GDALMRFRasterBand::DecodeJob, ready);
+            pool->WaitCompletion();
+        }
+
+        for (auto &job : jobs) {
+            for (auto poBlock : job.blocks) {
+                GDALRasterBand *b = poBlock->GetBand();
+                poBlock->DropLock();
+                // Drop the blocks that didn't get decoded, IReadBlock will report the error
+                if (job.ret != CE_None)
+                    b->FlushBlock(job.x, job.y, FALSE);
+            }
+            // Emit what the worker raised for the pages that are kept
+            if (job.ret == CE_None)
+                for (const auto &err : job.errors)
+                    CPLError(err.eErr, err.nNum, "%s", err.osMsg.c_str());
+            CPLFree(job.data);
+        }
+        jobs.clear();
+    };
+
+    // Keep the decoded pages well within the block cache
+    const GIntBig nMaxBytes = std::max(static_cast<GIntBig>(img.pageSizeBytes), GDALGetCacheMax64() / 4);
+
+    // The index records of a row of pages are contiguous, read them all at once
+    vector<ILIdx> idx(static_cast<size_t>(bx1 - bx0 + 1) * img.pagecount.c);
+    for (int y = by0; y <= by1; y++) {
+        VSIFSeekL(l_ifp, IdxOffset(ILSize(bx0, y, 0, 0, b0->m_l), img), SEEK_SET);
+        if (idx.size() != VSIFReadL(idx.data(), sizeof(ILIdx), idx.size(), l_ifp))
+            break;
+
+        for (int x = bx0; x <= bx1; x++) {
+            for (auto band : pageBands) {
+                const ILIdx &rec = idx[static_cast<size_t>(x - bx0) * img.pagecount.c
+                    + (band->GetBand() - 1) / cstride];
+                MRFReadJob job;
+                job.band = band;
+                job.x = x;
+                job.y = y;
+                job.tinfo.offset = net64(rec.offset);
+                job.tinfo.size = net64(rec.size);
+                job.data = nullptr;
+                job.ret = CE_None;
+
+                // Empty and invalid tiles are left to IReadBlock
+                if (job.tinfo.size <= 0 || job.tinfo.size > static_cast<GIntBig>(pbsize) * 2)
+                    continue;
+
+                GDALRasterBlock *poBlock = band->TryGetLockedBlockRef(x, y);
+                if (poBlock != nullptr) {
+                    poBlock->DropLock();
+                    continue;
+                }
+
+                jobs.push_back(job);
+                if (static_cast<GIntBig>(jobs.size()) * img.pageSizeBytes >= nMaxBytes)
+                    decode();
+            }
+        }
+    }
+    decode();
+}
+
 CPLErr GDALMRFDataset::SetGeoTransform(double *gt)
 
 {
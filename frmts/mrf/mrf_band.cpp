@@ -685,6 +685,10 @@ CPLErr GDALMRFRasterBand::IReadBlock(int xblk, int yblk, void *buffer)
     if (poDS->bypass_cache && !poDS->source.empty())
         return FetchBlock(xblk, yblk, buffer);
 
+    // The tile might still be in the write queue
+    if (poDS->poThreadPool)
+        poDS->WaitWrites();
+
     tinfo.size = 0; // Just in case it is missing
     if (CE_None != poDS->ReadTileIdx(tinfo, req, img)) {
         if (poDS->no_errors) {
@@ -768,7 +772,44 @@ CPLErr GDALMRFRasterBand::IReadBlock(int xblk, int yblk, void *buffer)
     /* initialize padding bytes */
     memset(((char*)data) + static_cast<size_t>(tinfo.size), 0, PADDING_BYTES);
 
-    buf_mgr src = {(char *)data, static_cast<size_t>(tinfo.size)};
+    // After unpacking, the size has to be pageSizeBytes
+    // If pages are interleaved, use the dataset page buffer instead
+    void *page = (1 == cstride) ? buffer : poDS->GetPBuffer();
+
+    if (poDS->no_errors)
+        CPLPushErrorHandler(CPLQuietErrorHandler);
+    CPLErr ret = DecodePage(data, static_cast<size_t>(tinfo.size), page);
+
+    if (poDS->no_errors) {
+        CPLPopErrorHandler();
+        if (ret != CE_None) {
+            // Set each page buffer to the correct no data value, then proceed
+            if (1 == cstride)
+                return FillBlock(buffer);
+            else
+                return FillBlock(xblk, yblk, buffer);
+        }
+    }
+
+    // If pages are separate or we had errors, we're done
+    if (1 == cstride || CE_None != ret)
+        return ret;
+
+    // De-interleave page from dataset buffer and return
+    return ReadInterleavedBlock(xblk, yblk, buffer);
+}
+
+/**
+*\brief Decode a tile as read from the data file
+*
+* The data has to be followed by PADDING_BYTES, it gets freed
+* The page receives pageSizeBytes, it is pixel interleaved if the bands are
+* Only uses the band codec, so it can be called from the worker threads
+*/
+
+CPLErr GDALMRFRasterBand::DecodePage(void *data, size_t size, void *page)
+{
+    buf_mgr src = {(char *)data, size};
     buf_mgr dst;
 
     // We got the data, do we need to decompress it before decoding?
@@ -795,7 +836,7 @@ CPLErr GDALMRFRasterBand::IReadBlock(int xblk, int yblk, void *buffer)
             // Got it unpacked, update the pointers
             CPLFree(data);
             data = dst.buffer;
-            tinfo.size = dst.size;
+            size = dst.size;
         } else {
             // assume the page was not gzipped, proceed
             CPLFree(dst.buffer);
@@ -805,15 +846,11 @@ CPLErr GDALMRFRasterBand::IReadBlock(int xblk, int yblk, void *buffer)
     }
 
     src.buffer = (char *)data;
-    src.size = static_cast<size_t>(tinfo.size);
+    src.size = size;
 
-    // After unpacking, the size has to be pageSizeBytes
-    // If pages are interleaved, use the dataset page buffer instead
-    dst.buffer = reinterpret_cast<char *>((1 == cstride) ? buffer : poDS->GetPBuffer());
+    dst.buffer = reinterpret_cast<char *>(page);
     dst.size = img.pageSizeBytes;
 
-    if (poDS->no_errors)
-        CPLPushErrorHandler(CPLQuietErrorHandler);
     CPLErr ret = Decompress(dst, src);
 
     dst.size = img.pageSizeBytes; // In case the decompress failed, force it back
@@ -823,24 +860,66 @@ CPLErr GDALMRFRasterBand::IReadBlock(int xblk, int yblk, void *buffer)
         swab_buff(dst, img);
 
     CPLFree(data);
+    return ret;
+}
 
-    if (poDS->no_errors) {
-        CPLPopErrorHandler();
-        if (ret != CE_None) {
-            // Set each page buffer to the correct no data value, then proceed
-            if (1 == cstride)
-                return FillBlock(buffer);
-            else
-                return FillBlock(xblk, yblk, buffer);
+static void CPL_STDCALL DecodeJobErrorHandler(CPLErr eErr, CPLErrorNum nNum, const char *pszMsg)
+{
+    MRFReadJob *job = static_cast<MRFReadJob *>(CPLGetErrorHandlerUserData());
+    job->errors.push_back(MRFErrorMessage{eErr, nNum, pszMsg});
+}
+
+/**
+*\brief Worker thread decoding of a page read by GDALMRFDataset::PrefetchBlocks
+*
+* The page goes directly in the locked cache blocks
+*/
+
+void GDALMRFRasterBand::DecodeJob(void *p)
+{
+    MRFReadJob *job = static_cast<MRFReadJob *>(p);
+    GDALMRFRasterBand *band = job->band;
+    const GInt32 cstride = band->img.pagesize.c;
+
+    // Kept for PrefetchBlocks to emit, if the page is not read again by IReadBlock
+    CPLPushErrorHandlerEx(DecodeJobErrorHandler, job);
+
+    void *page = (1 == cstride) ? job->blocks[0]->GetDataRef()
+                                : VSIMalloc(band->img.pageSizeBytes);
+    CPLErr ret = CE_Failure;
+    if (page != nullptr) {
+        ret = band->DecodePage(job->data, static_cast<size_t>(job->tinfo.size), page);
+        job->data = nullptr;
+    }
+
+    if (1 != cstride) {
+        for (int i = 0; ret == CE_None && i < static_cast<int>(job->blocks.size()); i++) {
+            void *ob = job->blocks[i]->GetDataRef();
+#define CpySI(T) cpy_stride_in<T> (ob, reinterpret_cast<T *>(page) + i,\
+    band->blockSizeBytes()/sizeof(T), cstride)
+
+            switch (GDALGetDataTypeSize(band->eDataType)/8)
+            {
+            case 1: CpySI(GByte); break;
+            case 2: CpySI(GInt16); break;
+            case 4: CpySI(GInt32); break;
+            case 8: CpySI(GIntBig); break;
+            }
+#undef CpySI
         }
+        CPLFree(page);
     }
 
-    // If pages are separate or we had errors, we're done
-    if (1 == cstride || CE_None != ret)
-        return ret;
+    CPLPopErrorHandler();
 
-    // De-interleave page from dataset buffer and return
-    return ReadInterleavedBlock(xblk, yblk, buffer);
+    // Same as IReadBlock, use no data for the pages that can't be decoded
+    if (ret != CE_None && band->poDS->no_errors) {
+        for (auto poBlock : job->blocks)
+            reinterpret_cast<GDALMRFRasterBand *>(poBlock->GetBand())->FillBlock(poBlock->GetDataRef());
+        ret = CE_None;
+    }
+
+    job->ret = ret;
 }
 
 /**
@@ -867,14 +946,31 @@ CPLErr GDALMRFRasterBand::IWriteBlock(int xblk, int yblk, void *buffer)
     if (!poDS->bCrystalized)
         poDS->Crystalize();
 
+    // Encode in the worker threads, not when caching
+    const bool threaded = poDS->source.empty() && poDS->GetThreadPool() != nullptr;
+
     if (1 == cstride) {     // Separate bands, we can write it as is
         // Empty page skip
 
         int success;
         double val = GetNoDataValue(&success);
         if (!success) val = 0.0;
-        if (isAllVal(eDataType, buffer, img.pageSizeBytes, val))
+        if (isAllVal(eDataType, buffer, img.pageSizeBytes, val)) {
+            if (threaded)
+                return poDS->SubmitWrite(new MRFWriteJob{this, infooffset, nullptr, {nullptr, 0}, 0, CE_None}, false);
             return poDS->WriteTile(nullptr, infooffset, 0);
+        }
+
+        if (threaded) {
+            // The worker needs its own copy of the page, the block buffer will be reused
+            char *tbuffer = static_cast<char *>(VSIMalloc(img.pageSizeBytes + poDS->pbsize));
+            if (!tbuffer) {
+                CPLError(CE_Failure,CPLE_AppDefined, "MRF: Can't allocate write buffer");
+                return CE_Failure;
+            }
+            memcpy(tbuffer, buffer, img.pageSizeBytes);
+            return poDS->SubmitWrite(new MRFWriteJob{this, infooffset, tbuffer, {nullptr, 0}, 0, CE_None}, true);
+        }
 
         // Use the pbuffer to hold the compressed page before writing it
         poDS->tile = ILSize(); // Mark it corrupt
@@ -984,6 +1080,8 @@ CPLErr GDALMRFRasterBand::IWriteBlock(int xblk, int yblk, void *buffer)
 
     if (GIntBig(empties) == AllBandMask()) {
         CPLFree(tbuffer);
+        if (threaded)
+            return poDS->SubmitWrite(new MRFWriteJob{this, infooffset, nullptr, {nullptr, 0}, 0, CE_None}, false);
         return poDS->WriteTile(nullptr, infooffset, 0);
     }
 
@@ -992,45 +1090,79 @@ CPLErr GDALMRFRasterBand::IWriteBlock(int xblk, int yblk, void *buffer)
         "MRF: IWrite, band dirty mask is " CPL_FRMT_GIB " instead of " CPL_FRMT_GIB,
         poDS->bdirty, AllBandMask());
 
+    poDS->bdirty = 0;
+
+    // The job takes ownership of tbuffer
+    if (threaded)
+        return poDS->SubmitWrite(new MRFWriteJob{this, infooffset, (char *)tbuffer, {nullptr, 0}, 0, CE_None}, true);
+
+    buf_mgr dst;
+    CPLErr ret = EncodePage((char *)tbuffer, dst);
+    // An empty dst writes an empty tile
+    CPLErr wret = poDS->WriteTile(dst.buffer, infooffset, dst.size);
+    CPLFree(tbuffer);
+
+    return (ret != CE_None) ? ret : wret;
+}
+
+/**
+*\brief Encode a page
+*
+* The raw page is at the start of tbuffer, followed by pbsize bytes for the encoded output
+* On return dst holds the page to be written, or is empty if the encoding failed
+* Only uses the band codec, so it can be called from the worker threads
+*/
+
+CPLErr GDALMRFRasterBand::EncodePage(char *tbuffer, buf_mgr &dst)
+{
     buf_mgr src;
-    src.buffer = (char *)tbuffer;
+    src.buffer = tbuffer;
     src.size = static_cast<size_t>(img.pageSizeBytes);
 
-    // Use the space after pagesizebytes for compressed output, it is of pbsize
-    char *outbuff = (char *)tbuffer + img.pageSizeBytes;
+    // Swab the source before encoding if we need to, this is a copy of the block
+    if (1 == img.pagesize.c && is_Endianess_Dependent(img.dt, img.comp) && (img.nbo != NET_ORDER))
+        swab_buff(src, img);
 
-    buf_mgr dst = {outbuff, poDS->pbsize};
-    CPLErr ret;
+    // Use the space after pagesizebytes for compressed output, it is of pbsize
+    char *outbuff = tbuffer + img.pageSizeBytes;
+    dst.buffer = outbuff;
+    dst.size = poDS->pbsize;
 
-    ret = Compress(dst, src);
-    if (ret != CE_None) {
+    if (Compress(dst, src) != CE_None) {
         // Compress failed, write it as an empty tile
-        CPLFree(tbuffer);
-        poDS->WriteTile(nullptr, infooffset, 0);
-        return CE_None; // Should report the error, but it triggers partial band attempts
+        // Should report the error, but it triggers partial band attempts
+        dst.buffer = nullptr;
+        dst.size = 0;
+        return CE_None;
     }
 
-    // Where the output is, in case we deflate
-    void *usebuff = outbuff;
     if (deflatep) {
         // Move the packed part at the start of tbuffer, to make more space available
         memcpy(tbuffer, outbuff, dst.size);
-        dst.buffer = (char *)tbuffer;
-        usebuff = DeflateBlock(dst, img.pageSizeBytes + poDS->pbsize - dst.size, deflate_flags);
+        dst.buffer = tbuffer;
+        void *usebuff = DeflateBlock(dst, img.pageSizeBytes + poDS->pbsize - dst.size, deflate_flags);
         if (!usebuff) {
             CPLError(CE_Failure,CPLE_AppDefined, "MRF: Deflate error");
-            CPLFree(tbuffer);
-            poDS->WriteTile(nullptr, infooffset, 0);
-            poDS->bdirty = 0;
+            dst.buffer = nullptr;
+            dst.size = 0;
             return CE_Failure;
         }
+        dst.buffer = static_cast<char *>(usebuff);
     }
 
-    ret = poDS->WriteTile(usebuff, infooffset, dst.size);
-    CPLFree(tbuffer);
+    return CE_None;
+}
 
-    poDS->bdirty = 0;
-    return ret;
+// Worker thread encoding of a page, then queue it for writing
+void GDALMRFRasterBand::EncodeJob(void *p)
+{
+    MRFWriteJob *job = static_cast<MRFWriteJob *>(p);
+    GDALMRFDataset *poDS = job->band->poDS;
+    // The calling thread emits these, from SubmitWrite or WaitWrites
+    CPLPushErrorHandlerEx(GDALMRFDataset::WorkerErrorHandler, poDS);
+    job->ret = job->band->EncodePage(job->tbuffer, job->dst);
+    poDS->QueueWrite(job);
+    CPLPopErrorHandler();
 }
 
 //
@@ -1051,7 +1183,10 @@ bool GDALMRFRasterBand::TestBlock(int xblk, int yblk)
     GInt32 cstride = img.pagesize.c;
     ILSize req(xblk, yblk, 0, (nBand - 1) / cstride, m_l);
 
-    
+    // The tile might still be in the write queue
+    if (poDS->poThreadPool)
+        poDS->WaitWrites();
+
     if (CE_None != poDS->ReadTileIdx(tinfo, req, img))
         // Got an error reading the tile index
         return !poDS->no_errors;
@@ -645,6 +645,8 @@ void GDALRegister_mrf()
         "       <Value>RGB</Value>"
         "       <Value>YCC</Value>"
         "   </Option>\n"
+        "   <Option name='NUM_THREADS' type='string' "
+                    "description='Number of worker threads for compression. Can be set to ALL_CPUS' default='1'/>\n"
         "</CreationOptionList>\n");
 
     driver->SetMetadataItem(
@@ -652,6 +654,7 @@ void GDALRegister_mrf()
       "<OpenOptionList>"
       "    <Option name='NOERRORS' type='boolean' description='Ignore decompression errors' default='FALSE'/>"
       "    <Option name='ZSLICE' type='int' description='For a third dimension MRF, pick a slice' default='0'/>"
+      "    <Option name='NUM_THREADS' type='string' description='Number of worker threads for decompression. Can be set to ALL_CPUS' default='1'/>"
       "</OpenOptionList>"
       );
 
@@ -309,6 +309,8 @@ class netCDFVariable final: public GDALMDArray
     mutable bool m_bPerfectDataTypeMatch = false;
     mutable std::vector<GByte> m_abyNoData{};
     mutable bool m_bGetRawNoDataValueHasRun = false;
+    mutable std::vector<GUInt64> m_anBlockSize{};
+    mutable bool m_bBlockSizeComputed = false;
     std::string m_osUnit{};
     CPLStringList m_aosStructuralInfo{};
     mutable bool m_bSRSRead = false;
@@ -377,6 +379,13 @@ protected:
                       const GDALExtendedDataType& bufferDataType,
                       const void* pSrcBuffer) override;
 
+    bool IReadWithConversion(const GUInt64* arrayStartIdx,
+                             const size_t* count,
+                             const GInt64* arrayStep,
+                             const GPtrDiff_t* bufferStride,
+                             const GDALExtendedDataType& bufferDataType,
+                             void* pDstBuffer) const;
+
 public:
     static std::shared_ptr<netCDFVariable> Create(
                    std::shared_ptr<netCDFSharedResources> poShared,
@@ -392,6 +401,8 @@ public:
 
     bool IsWritable() const override { return !m_poShared->IsReadOnly(); }
 
+    bool IsReadThreadSafe() const override;
+
     const std::vector<std::shared_ptr<GDALDimension>>& GetDimensions() const override;
 
     const GDALExtendedDataType &GetDataType() const override;
@@ -2396,6 +2407,42 @@ bool netCDFVariable::IRead(const GUInt64* arrayStartIdx,
         return true;
     }
 
+    bool bRet = false;
+    if( ReadFromChunkCache(arrayStartIdx, count, arrayStep, bufferStride,
+                           bufferDataType, pDstBuffer, bRet) )
+    {
+        return bRet;
+    }
+
+    // Numeric data type conversions are done outside of the netCDF lock,
+    // instead of element by element while holding it
+    const auto& dt = GetDataType();
+    if( m_nDims > 0 && m_bPerfectDataTypeMatch &&
+        dt.GetClass() == GEDTC_NUMERIC &&
+        bufferDataType.GetClass() == GEDTC_NUMERIC &&
+        dt != bufferDataType )
+    {
+        constexpr size_t MAX_TEMP_ARRAY_SIZE = 100 * 1024 * 1024;
+        size_t nEltCount = 1;
+        const GPtrDiff_t nLastStrideBytes = bufferStride[m_nDims - 1] *
+            static_cast<GPtrDiff_t>(bufferDataType.GetSize());
+        bool bConvert =
+            nLastStrideBytes <= std::numeric_limits<int>::max() &&
+            nLastStrideBytes >= -std::numeric_limits<int>::max();
+        for( int i = 0; bConvert && i < m_nDims; i++ )
+        {
+            nEltCount *= count[i];
+            bConvert = arrayStep[i] > 0 &&
+                       nEltCount <= MAX_TEMP_ARRAY_SIZE / dt.GetSize();
+        }
+        if( bConvert )
+        {
+            return IReadWithConversion(arrayStartIdx, count, arrayStep,
+                                       bufferStride, bufferDataType,
+                                       pDstBuffer);
+        }
+    }
+
     return IReadWrite
                 (arrayStartIdx, count, arrayStep, bufferStride,
                  bufferDataType, pDstBuffer,
@@ -2405,6 +2452,100 @@ bool netCDFVariable::IRead(const GUInt64* arrayStartIdx,
                  &netCDFVariable::ReadOneElement);
 }
 
+/************************************************************************/
+/*                        IReadWithConversion()                         */
+/************************************************************************/
+
+bool netCDFVariable::IReadWithConversion(const GUInt64* arrayStartIdx,
+                                         const size_t* count,
+                                         const GInt64* arrayStep,
+                                         const GPtrDiff_t* bufferStride,
+                                         const GDALExtendedDataType& bufferDataType,
+                                         void* pDstBuffer) const
+{
+    const auto& dt = GetDataType();
+    const size_t nDTSize = dt.GetSize();
+    const size_t nBufferDTSize = bufferDataType.GetSize();
+
+    size_t nEltCount = 1;
+    std::vector<GPtrDiff_t> anTempStride(m_nDims);
+    for( int i = m_nDims; i != 0; )
+    {
+        --i;
+        anTempStride[i] = static_cast<GPtrDiff_t>(nEltCount);
+        nEltCount *= count[i];
+    }
+
+    std::vector<GByte> abyTemp;
+    try
+    {
+        abyTemp.resize(nEltCount * nDTSize);
+    }
+    catch( const std::exception& e )
+    {
+        CPLError(CE_Failure, CPLE_OutOfMemory, "%s", e.what());
+        return false;
+    }
+
+    // Only this part holds the lock
+    if( !IReadWrite(arrayStartIdx, count, arrayStep, anTempStride.data(),
+                    dt, static_cast<void*>(abyTemp.data()),
+                    nc_get_var1,
+                    nc_get_vara,
+                    nc_get_varm,
+                    &netCDFVariable::ReadOneElement) )
+    {
+        return false;
+    }
+
+    // Convert line by line along the last dimension
+    const int nLastDim = m_nDims - 1;
+    const size_t nLineCount = count[nLastDim];
+    const int nDstPixelOffset =
+        static_cast<int>(bufferStride[nLastDim] * static_cast<GPtrDiff_t>(nBufferDTSize));
+    std::vector<size_t> anIdx(nLastDim);
+    const GByte* pabySrc = abyTemp.data();
+    while( true )
+    {
+        GPtrDiff_t nDstOffset = 0;
+        for( int i = 0; i < nLastDim; i++ )
+            nDstOffset += static_cast<GPtrDiff_t>(anIdx[i]) * bufferStride[i];
+        GDALCopyWords64(pabySrc, dt.GetNumericDataType(),
+                        static_cast<int>(nDTSize),
+                        static_cast<GByte*>(pDstBuffer) +
+                            nDstOffset * static_cast<GPtrDiff_t>(nBufferDTSize),
+                        bufferDataType.GetNumericDataType(),
+                        nDstPixelOffset,
+                        static_cast<GPtrDiff_t>(nLineCount));
+        pabySrc += nLineCount * nDTSize;
+
+        int i = nLastDim - 1;
+        for( ; i >= 0; --i )
+        {
+            if( ++anIdx[i] < count[i] )
+                break;
+            anIdx[i] = 0;
+        }
+        if( i < 0 )
+            break;
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                          IsReadThreadSafe()                          */
+/************************************************************************/
+
+bool netCDFVariable::IsReadThreadSafe() const
+{
+    // Reads hold hNCMutex while calling libnetcdf. Make sure the lazily
+    // initialized members are set before several threads use them.
+    GetDimensions();
+    GetDataType();
+    GetBlockSize();
+    return true;
+}
+
 /************************************************************************/
 /*                          ConvertGDALToNC()                           */
 /************************************************************************/
@@ -2658,6 +2799,12 @@ double netCDFVariable::GetOffset(bool* pbHasOffset) const
 
 std::vector<GUInt64> netCDFVariable::GetBlockSize() const
 {
+    // Queried on each read by the chunk cache
+    CPLMutexHolderD(&hNCMutex);
+    if( m_bBlockSizeComputed )
+        return m_anBlockSize;
+    m_bBlockSizeComputed = true;
+
     std::vector<GUInt64> res(GetDimensionCount());
     if( res.empty() )
         return res;
@@ -2669,6 +2816,7 @@ std::vector<GUInt64> netCDFVariable::GetBlockSize() const
         for( size_t i = 0; i < res.size(); ++i )
             res[i] = anTemp[i];
     }
+    m_anBlockSize = res;
     return res;
 }
 
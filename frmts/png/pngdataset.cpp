@@ -2054,6 +2054,23 @@ static void png_gdal_warning( CPL_UNUSED png_structp png_ptr,
               "libpng: %s", error_message );
 }
 
+/************************************************************************/
+/*                   GDALGetDeclaredMetadata_PNG()                    */
+/************************************************************************/
+
+// Items that GDALAllRegister() declares for the driver before registering it.
+CSLConstList GDALGetDeclaredMetadata_PNG()
+{
+    static const char* const apszMD[] = {
+        GDAL_DCAP_OPEN "=YES",
+        GDAL_DCAP_RASTER "=YES",
+        GDAL_DMD_LONGNAME "=Portable Network Graphics",
+        GDAL_DMD_EXTENSION "=png",
+        GDAL_DMD_OPEN_SIGNATURES "=0:89504E470D0A1A0A",
+        nullptr };
+    return apszMD;
+}
+
 /************************************************************************/
 /*                          GDALRegister_PNG()                          */
 /************************************************************************/
@@ -2067,12 +2084,10 @@ void GDALRegister_PNG()
     GDALDriver *poDriver = new GDALDriver();
 
     poDriver->SetDescription( "PNG" );
-    poDriver->SetMetadataItem( GDAL_DCAP_RASTER, "YES" );
-    poDriver->SetMetadataItem( GDAL_DMD_LONGNAME,
-                               "Portable Network Graphics" );
+    poDriver->SetMetadata(
+        const_cast<char**>(GDALGetDeclaredMetadata_PNG()) );
     poDriver->SetMetadataItem( GDAL_DMD_HELPTOPIC,
                                "drivers/raster/png.html" );
-    poDriver->SetMetadataItem( GDAL_DMD_EXTENSION, "png" );
     poDriver->SetMetadataItem( GDAL_DMD_MIMETYPE, "image/png" );
 
     poDriver->SetMetadataItem( GDAL_DMD_CREATIONDATATYPES,
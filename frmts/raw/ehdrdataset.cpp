@@ -335,6 +335,20 @@ CPLErr EHdrRasterBand::IRasterIO( GDALRWFlag eRWFlag,
                                      psExtraArg);
 }
 
+/************************************************************************/
+/*                        GetDirectReadPointer()                        */
+/************************************************************************/
+
+const void *EHdrRasterBand::GetDirectReadPointer( GSpacing *pnPixelSpace,
+                                                  GSpacing *pnLineSpace )
+{
+    // Sub-byte pixels are not addressable in place.
+    if( nBits < 8 )
+        return nullptr;
+
+    return RawRasterBand::GetDirectReadPointer(pnPixelSpace, pnLineSpace);
+}
+
 /************************************************************************/
 /*                              OSR_GDS()                               */
 /************************************************************************/
@@ -174,6 +174,9 @@ class EHdrRasterBand final: public RawRasterBand
     CPLErr IReadBlock( int, int, void * ) override;
     CPLErr IWriteBlock( int, int, void * ) override;
 
+    const void *GetDirectReadPointer( GSpacing *pnPixelSpace,
+                                      GSpacing *pnLineSpace ) override;
+
     double GetNoDataValue( int *pbSuccess = nullptr ) override;
     double GetMinimum( int *pbSuccess = nullptr ) override;
     double GetMaximum(int *pbSuccess = nullptr ) override;
@@ -29,8 +29,12 @@
 
 #include <cmath>
 #include "gdal.h"
+#include "gdalsse_priv.h"
 #include "vrtdataset.h"
 
+#include <algorithm>
+#include <vector>
+
 CPL_CVSID("$Id: pixelfunctions.cpp 3b0bbf7a8a012d69a783ee1f9cfeb5c52b370021 2017-06-27 20:57:02Z Even Rouault $")
 
 static CPLErr RealPixelFunc( void **papoSources, int nSources, void *pData,
@@ -124,6 +128,239 @@ static CPLErr PowPixelFuncHelper( void **papoSources, int nSources, void *pData,
                                   int nPixelSpace, int nLineSpace,
                                   double base, double fact );
 
+/************************************************************************/
+/*                         Line based helpers                           */
+/************************************************************************/
+
+// The pixel functions below work one line at a time: the (real and
+// imaginary parts of the) source pixels of a line are converted to doubles
+// with a single GDALCopyWords() call, the computation runs over contiguous
+// arrays of doubles, and the result is written to the output buffer with
+// a single GDALCopyWords() call.
+
+namespace {
+
+class PixelFuncLineBuffers
+{
+    double *m_padfBuffer;
+    int     m_nXSize;
+
+    PixelFuncLineBuffers(const PixelFuncLineBuffers&) = delete;
+    PixelFuncLineBuffers& operator= (const PixelFuncLineBuffers&) = delete;
+
+  public:
+    PixelFuncLineBuffers( int nXSize, int nLines ) :
+        m_padfBuffer(static_cast<double *>(
+            VSI_MALLOC3_VERBOSE(sizeof(double), nXSize, nLines))),
+        m_nXSize(nXSize)
+    {
+    }
+
+    ~PixelFuncLineBuffers() { VSIFree(m_padfBuffer); }
+
+    bool IsValid() const { return m_padfBuffer != nullptr; }
+
+    double *Line( int i )
+    {
+        return m_padfBuffer + static_cast<size_t>(i) * m_nXSize;
+    }
+};
+
+struct AddOp
+{
+    template<class T> static T Apply( const T& a, const T& b ) { return a + b; }
+};
+
+struct SubOp
+{
+    template<class T> static T Apply( const T& a, const T& b ) { return a - b; }
+};
+
+struct MulOp
+{
+    template<class T> static T Apply( const T& a, const T& b ) { return a * b; }
+};
+
+struct DivOp
+{
+    template<class T> static T Apply( const T& a, const T& b ) { return a / b; }
+};
+
+} // namespace
+
+/************************************************************************/
+/*                            LoadRealLine()                            */
+/************************************************************************/
+
+// Converts the real part (or the value for non-complex data types) of the
+// pixels of line iLine of a packed source buffer to doubles.
+static void LoadRealLine( const void *pSource, GDALDataType eSrcType,
+                          int nXSize, int iLine, double *padfLine )
+{
+    const int nPixelSpaceSrc = GDALGetDataTypeSizeBytes( eSrcType );
+    GDALCopyWords(
+        static_cast<const GByte *>(pSource) +
+            static_cast<size_t>(nPixelSpaceSrc) * nXSize * iLine,
+        GDALGetNonComplexDataType( eSrcType ), nPixelSpaceSrc,
+        padfLine, GDT_Float64, static_cast<int>(sizeof(double)), nXSize );
+}
+
+/************************************************************************/
+/*                            LoadImagLine()                            */
+/************************************************************************/
+
+// Same as LoadRealLine() for the imaginary part of a complex source buffer.
+static void LoadImagLine( const void *pSource, GDALDataType eSrcType,
+                          int nXSize, int iLine, double *padfLine )
+{
+    const int nPixelSpaceSrc = GDALGetDataTypeSizeBytes( eSrcType );
+    GDALCopyWords(
+        static_cast<const GByte *>(pSource) +
+            static_cast<size_t>(nPixelSpaceSrc) * nXSize * iLine +
+            nPixelSpaceSrc / 2,
+        GDALGetNonComplexDataType( eSrcType ), nPixelSpaceSrc,
+        padfLine, GDT_Float64, static_cast<int>(sizeof(double)), nXSize );
+}
+
+/************************************************************************/
+/*                             StoreLine()                              */
+/************************************************************************/
+
+static void StoreLine( const double *padfLine, void *pData, int iLine,
+                       int nXSize, GDALDataType eBufType,
+                       int nPixelSpace, int nLineSpace )
+{
+    GDALCopyWords(
+        padfLine, GDT_Float64, static_cast<int>(sizeof(double)),
+        static_cast<GByte *>(pData) + static_cast<GPtrDiff_t>(nLineSpace) * iLine,
+        eBufType, nPixelSpace, nXSize );
+}
+
+/************************************************************************/
+/*                          StoreComplexLine()                          */
+/************************************************************************/
+
+// Writes a line given as separate real and imaginary parts. Only the real
+// part is written if the buffer data type is not complex, which is what
+// GDALCopyWords() does when converting from a complex data type.
+static void StoreComplexLine( const double *padfReal, const double *padfImag,
+                              void *pData, int iLine, int nXSize,
+                              GDALDataType eBufType,
+                              int nPixelSpace, int nLineSpace )
+{
+    GByte *pabyDst = static_cast<GByte *>(pData) +
+                                static_cast<GPtrDiff_t>(nLineSpace) * iLine;
+    if( !GDALDataTypeIsComplex( eBufType ) )
+    {
+        GDALCopyWords( padfReal, GDT_Float64, static_cast<int>(sizeof(double)),
+                       pabyDst, eBufType, nPixelSpace, nXSize );
+        return;
+    }
+    const GDALDataType eBufBaseType = GDALGetNonComplexDataType( eBufType );
+    GDALCopyWords( padfReal, GDT_Float64, static_cast<int>(sizeof(double)),
+                   pabyDst, eBufBaseType, nPixelSpace, nXSize );
+    GDALCopyWords( padfImag, GDT_Float64, static_cast<int>(sizeof(double)),
+                   pabyDst + GDALGetDataTypeSizeBytes( eBufType ) / 2,
+                   eBufBaseType, nPixelSpace, nXSize );
+}
+
+/************************************************************************/
+/*                           BinaryKernel()                             */
+/************************************************************************/
+
+// padfOut[i] = Op(padfA[i], padfB[i]). padfOut may be padfA or padfB.
+template<class Op>
+static void BinaryKernel( const double *padfA, const double *padfB,
+                          double *padfOut, int nCount )
+{
+    int i = 0;
+    for( ; i + 3 < nCount; i += 4 )
+    {
+        const XMMReg2Double oA0 = XMMReg2Double::Load2Val(padfA + i);
+        const XMMReg2Double oA1 = XMMReg2Double::Load2Val(padfA + i + 2);
+        const XMMReg2Double oB0 = XMMReg2Double::Load2Val(padfB + i);
+        const XMMReg2Double oB1 = XMMReg2Double::Load2Val(padfB + i + 2);
+        Op::Apply(oA0, oB0).Store2Val(padfOut + i);
+        Op::Apply(oA1, oB1).Store2Val(padfOut + i + 2);
+    }
+    for( ; i < nCount; ++i )
+    {
+        padfOut[i] = Op::Apply(padfA[i], padfB[i]);
+    }
+}
+
+/************************************************************************/
+/*                          SquaredModKernel()                          */
+/************************************************************************/
+
+// padfOut[i] = padfReal[i]^2 + padfImag[i]^2
+static void SquaredModKernel( const double *padfReal, const double *padfImag,
+                              double *padfOut, int nCount )
+{
+    int i = 0;
+    for( ; i + 1 < nCount; i += 2 )
+    {
+        const XMMReg2Double oReal = XMMReg2Double::Load2Val(padfReal + i);
+        const XMMReg2Double oImag = XMMReg2Double::Load2Val(padfImag + i);
+        (oReal * oReal + oImag * oImag).Store2Val(padfOut + i);
+    }
+    for( ; i < nCount; ++i )
+    {
+        padfOut[i] = padfReal[i] * padfReal[i] + padfImag[i] * padfImag[i];
+    }
+}
+
+/************************************************************************/
+/*                        ComplexMulKernel()                            */
+/************************************************************************/
+
+// (padfReal, padfImag) *= (padfOtherReal, +/- padfOtherImag)
+template<bool bConjugate>
+static void ComplexMulKernel( double *padfReal, double *padfImag,
+                              const double *padfOtherReal,
+                              const double *padfOtherImag, int nCount )
+{
+    int i = 0;
+    for( ; i + 1 < nCount; i += 2 )
+    {
+        const XMMReg2Double oR0 = XMMReg2Double::Load2Val(padfReal + i);
+        const XMMReg2Double oI0 = XMMReg2Double::Load2Val(padfImag + i);
+        const XMMReg2Double oR1 = XMMReg2Double::Load2Val(padfOtherReal + i);
+        const XMMReg2Double oI1 = XMMReg2Double::Load2Val(padfOtherImag + i);
+        if( bConjugate )
+        {
+            (oR0 * oR1 + oI0 * oI1).Store2Val(padfReal + i);
+            (oR1 * oI0 - oR0 * oI1).Store2Val(padfImag + i);
+        }
+        else
+        {
+            (oR0 * oR1 - oI0 * oI1).Store2Val(padfReal + i);
+            (oR0 * oI1 + oI0 * oR1).Store2Val(padfImag + i);
+        }
+    }
+    for( ; i < nCount; ++i )
+    {
+        const double dfR0 = padfReal[i];
+        const double dfI0 = padfImag[i];
+        const double dfR1 = padfOtherReal[i];
+        const double dfI1 = padfOtherImag[i];
+        if( bConjugate )
+        {
+            padfReal[i] = dfR0 * dfR1 + dfI0 * dfI1;
+            padfImag[i] = dfR1 * dfI0 - dfR0 * dfI1;
+        }
+        else
+        {
+            padfReal[i] = dfR0 * dfR1 - dfI0 * dfI1;
+            padfImag[i] = dfR0 * dfI1 + dfI0 * dfR1;
+        }
+    }
+}
+
+/************************************************************************/
+/*                           Pixel functions                            */
+/************************************************************************/
+
 static CPLErr RealPixelFunc( void **papoSources, int nSources, void *pData,
                              int nXSize, int nYSize,
                              GDALDataType eSrcType, GDALDataType eBufType,
@@ -202,22 +439,17 @@ static CPLErr ComplexPixelFunc( void **papoSources, int nSources, void *pData,
     /* ---- Init ---- */
     if( nSources != 2 ) return CE_Failure;
 
-    const void * const pReal = papoSources[0];
-    const void * const pImag = papoSources[1];
+    PixelFuncLineBuffers oBuffers(nXSize, 2);
+    if( !oBuffers.IsValid() ) return CE_Failure;
+    double * const padfReal = oBuffers.Line(0);
+    double * const padfImag = oBuffers.Line(1);
 
     /* ---- Set pixels ---- */
-    for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-        for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-            // Source raster pixels may be obtained with SRCVAL macro.
-            const double adfPixVal[2] = {
-                SRCVAL(pReal, eSrcType, ii),  // re
-                SRCVAL(pImag, eSrcType, ii)  // im
-            };
-
-            GDALCopyWords(adfPixVal, GDT_CFloat64, 0,
-                          static_cast<GByte *>(pData) + nLineSpace * iLine +
-                          iCol * nPixelSpace, eBufType, nPixelSpace, 1);
-        }
+    for( int iLine = 0; iLine < nYSize; ++iLine ) {
+        LoadRealLine(papoSources[0], eSrcType, nXSize, iLine, padfReal);
+        LoadRealLine(papoSources[1], eSrcType, nXSize, iLine, padfImag);
+        StoreComplexLine(padfReal, padfImag, pData, iLine, nXSize,
+                         eBufType, nPixelSpace, nLineSpace);
     }
 
     /* ---- Return success ---- */
@@ -232,43 +464,33 @@ static CPLErr ModulePixelFunc( void **papoSources, int nSources, void *pData,
     /* ---- Init ---- */
     if( nSources != 1 ) return CE_Failure;
 
+    PixelFuncLineBuffers oBuffers(nXSize, 2);
+    if( !oBuffers.IsValid() ) return CE_Failure;
+    double * const padfReal = oBuffers.Line(0);
+    double * const padfImag = oBuffers.Line(1);
+
     if( GDALDataTypeIsComplex( eSrcType ) )
     {
-        const void *pReal = papoSources[0];
-        const void *pImag = static_cast<GByte *>(papoSources[0])
-                    + GDALGetDataTypeSizeBytes( eSrcType ) / 2;
-
         /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                const double dfReal = SRCVAL(pReal, eSrcType, ii);
-                const double dfImag = SRCVAL(pImag, eSrcType, ii);
-
-                const double dfPixVal =
-                    sqrt( dfReal * dfReal + dfImag * dfImag );
-
-                GDALCopyWords(
-                    &dfPixVal, GDT_Float64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1 );
-            }
+        for( int iLine = 0; iLine < nYSize; ++iLine ) {
+            LoadRealLine(papoSources[0], eSrcType, nXSize, iLine, padfReal);
+            LoadImagLine(papoSources[0], eSrcType, nXSize, iLine, padfImag);
+            SquaredModKernel(padfReal, padfImag, padfReal, nXSize);
+            for( int iCol = 0; iCol < nXSize; ++iCol )
+                padfReal[iCol] = sqrt(padfReal[iCol]);
+            StoreLine(padfReal, pData, iLine, nXSize,
+                      eBufType, nPixelSpace, nLineSpace);
         }
     }
     else
     {
         /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                const double dfPixVal =
-                    fabs(SRCVAL(papoSources[0], eSrcType, ii));
-
-                GDALCopyWords(
-                    &dfPixVal, GDT_Float64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1 );
-            }
+        for( int iLine = 0; iLine < nYSize; ++iLine ) {
+            LoadRealLine(papoSources[0], eSrcType, nXSize, iLine, padfReal);
+            for( int iCol = 0; iCol < nXSize; ++iCol )
+                padfReal[iCol] = fabs(padfReal[iCol]);
+            StoreLine(padfReal, pData, iLine, nXSize,
+                      eBufType, nPixelSpace, nLineSpace);
         }
     }
 
@@ -284,44 +506,32 @@ static CPLErr PhasePixelFunc( void **papoSources, int nSources, void *pData,
     /* ---- Init ---- */
     if( nSources != 1 ) return CE_Failure;
 
+    PixelFuncLineBuffers oBuffers(nXSize, 2);
+    if( !oBuffers.IsValid() ) return CE_Failure;
+    double * const padfReal = oBuffers.Line(0);
+    double * const padfImag = oBuffers.Line(1);
+
     if( GDALDataTypeIsComplex( eSrcType ) )
     {
-        const void * const pReal = papoSources[0];
-        const void * const pImag = static_cast<GByte *>(papoSources[0])
-            + GDALGetDataTypeSizeBytes( eSrcType ) / 2;
-
         /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                const double dfReal = SRCVAL(pReal, eSrcType, ii);
-                const double dfImag = SRCVAL(pImag, eSrcType, ii);
-
-                const double dfPixVal = atan2(dfImag, dfReal);
-
-                GDALCopyWords(
-                    &dfPixVal, GDT_Float64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1 );
-            }
+        for( int iLine = 0; iLine < nYSize; ++iLine ) {
+            LoadRealLine(papoSources[0], eSrcType, nXSize, iLine, padfReal);
+            LoadImagLine(papoSources[0], eSrcType, nXSize, iLine, padfImag);
+            for( int iCol = 0; iCol < nXSize; ++iCol )
+                padfReal[iCol] = atan2(padfImag[iCol], padfReal[iCol]);
+            StoreLine(padfReal, pData, iLine, nXSize,
+                      eBufType, nPixelSpace, nLineSpace);
         }
     }
     else
     {
         /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                const void * const pReal = papoSources[0];
-
-                // Source raster pixels may be obtained with SRCVAL macro.
-                const double dfReal = SRCVAL(pReal, eSrcType, ii);
-                const double dfPixVal = (dfReal < 0) ? M_PI : 0.0;
-
-                GDALCopyWords(
-                    &dfPixVal, GDT_Float64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1 );
-            }
+        for( int iLine = 0; iLine < nYSize; ++iLine ) {
+            LoadRealLine(papoSources[0], eSrcType, nXSize, iLine, padfReal);
+            for( int iCol = 0; iCol < nXSize; ++iCol )
+                padfReal[iCol] = (padfReal[iCol] < 0) ? M_PI : 0.0;
+            StoreLine(padfReal, pData, iLine, nXSize,
+                      eBufType, nPixelSpace, nLineSpace);
         }
     }
 
@@ -339,25 +549,19 @@ static CPLErr ConjPixelFunc( void **papoSources, int nSources, void *pData,
 
     if( GDALDataTypeIsComplex( eSrcType ) && GDALDataTypeIsComplex( eBufType ) )
     {
-        const int nOffset = GDALGetDataTypeSizeBytes( eSrcType ) / 2;
-        const void * const pReal = papoSources[0];
-        const void * const pImag =
-            static_cast<GByte *>(papoSources[0]) + nOffset;
+        PixelFuncLineBuffers oBuffers(nXSize, 2);
+        if( !oBuffers.IsValid() ) return CE_Failure;
+        double * const padfReal = oBuffers.Line(0);
+        double * const padfImag = oBuffers.Line(1);
 
         /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                const double adfPixVal[2] = {
-                    +SRCVAL(pReal, eSrcType, ii),  // re
-                    -SRCVAL(pImag, eSrcType, ii)  // im
-                };
-
-                GDALCopyWords(
-                    adfPixVal, GDT_CFloat64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1 );
-            }
+        for( int iLine = 0; iLine < nYSize; ++iLine ) {
+            LoadRealLine(papoSources[0], eSrcType, nXSize, iLine, padfReal);
+            LoadImagLine(papoSources[0], eSrcType, nXSize, iLine, padfImag);
+            for( int iCol = 0; iCol < nXSize; ++iCol )
+                padfImag[iCol] = -padfImag[iCol];
+            StoreComplexLine(padfReal, padfImag, pData, iLine, nXSize,
+                             eBufType, nPixelSpace, nLineSpace);
         }
     }
     else
@@ -379,50 +583,42 @@ static CPLErr SumPixelFunc(void **papoSources, int nSources, void *pData,
     /* ---- Init ---- */
     if( nSources < 2 ) return CE_Failure;
 
+    PixelFuncLineBuffers oBuffers(nXSize, 4);
+    if( !oBuffers.IsValid() ) return CE_Failure;
+    double * const padfSumReal = oBuffers.Line(0);
+    double * const padfSumImag = oBuffers.Line(1);
+    double * const padfReal = oBuffers.Line(2);
+    double * const padfImag = oBuffers.Line(3);
+
     /* ---- Set pixels ---- */
     if( GDALDataTypeIsComplex( eSrcType ) )
     {
-        const int nOffset = GDALGetDataTypeSizeBytes( eSrcType ) / 2;
-
-        /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                double adfSum[2] = { 0.0, 0.0 };
-
-                for( int iSrc = 0; iSrc < nSources; ++iSrc ) {
-                    const void * const pReal = papoSources[iSrc];
-                    const void * const pImag =
-                        static_cast<const GByte *>(pReal) + nOffset;
-
-                    // Source raster pixels may be obtained with SRCVAL macro.
-                    adfSum[0] += SRCVAL(pReal, eSrcType, ii);
-                    adfSum[1] += SRCVAL(pImag, eSrcType, ii);
-                }
-
-                GDALCopyWords(
-                    adfSum, GDT_CFloat64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1);
+        for( int iLine = 0; iLine < nYSize; ++iLine ) {
+            LoadRealLine(papoSources[0], eSrcType, nXSize, iLine, padfSumReal);
+            LoadImagLine(papoSources[0], eSrcType, nXSize, iLine, padfSumImag);
+            for( int iSrc = 1; iSrc < nSources; ++iSrc ) {
+                LoadRealLine(papoSources[iSrc], eSrcType, nXSize, iLine,
+                             padfReal);
+                LoadImagLine(papoSources[iSrc], eSrcType, nXSize, iLine,
+                             padfImag);
+                BinaryKernel<AddOp>(padfSumReal, padfReal, padfSumReal, nXSize);
+                BinaryKernel<AddOp>(padfSumImag, padfImag, padfSumImag, nXSize);
             }
+            StoreComplexLine(padfSumReal, padfSumImag, pData, iLine, nXSize,
+                             eBufType, nPixelSpace, nLineSpace);
         }
     }
     else
     {
-        /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                double dfSum = 0;  // Not complex.
-
-                for( int iSrc = 0; iSrc < nSources; ++iSrc ) {
-                    // Source raster pixels may be obtained with SRCVAL macro.
-                    dfSum += SRCVAL(papoSources[iSrc], eSrcType, ii);
-                }
-
-                GDALCopyWords(
-                    &dfSum, GDT_Float64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1);
+        for( int iLine = 0; iLine < nYSize; ++iLine ) {
+            LoadRealLine(papoSources[0], eSrcType, nXSize, iLine, padfSumReal);
+            for( int iSrc = 1; iSrc < nSources; ++iSrc ) {
+                LoadRealLine(papoSources[iSrc], eSrcType, nXSize, iLine,
+                             padfReal);
+                BinaryKernel<AddOp>(padfSumReal, padfReal, padfSumReal, nXSize);
             }
+            StoreLine(padfSumReal, pData, iLine, nXSize,
+                      eBufType, nPixelSpace, nLineSpace);
         }
     }
 
@@ -438,49 +634,36 @@ static CPLErr DiffPixelFunc( void **papoSources, int nSources, void *pData,
     /* ---- Init ---- */
     if( nSources != 2 ) return CE_Failure;
 
+    PixelFuncLineBuffers oBuffers(nXSize, 4);
+    if( !oBuffers.IsValid() ) return CE_Failure;
+    double * const padfReal0 = oBuffers.Line(0);
+    double * const padfImag0 = oBuffers.Line(1);
+    double * const padfReal1 = oBuffers.Line(2);
+    double * const padfImag1 = oBuffers.Line(3);
+
     if( GDALDataTypeIsComplex( eSrcType ) )
     {
-        const int nOffset = GDALGetDataTypeSizeBytes( eSrcType ) / 2;
-        const void * const pReal0 = papoSources[0];
-        const void * const pImag0 =
-            static_cast<GByte *>(papoSources[0]) + nOffset;
-        const void * const pReal1 = papoSources[1];
-        const void * const pImag1 =
-            static_cast<GByte *>(papoSources[1]) + nOffset;
-
         /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                double adfPixVal[2] = {
-                    SRCVAL(pReal0, eSrcType, ii)
-                    - SRCVAL(pReal1, eSrcType, ii),
-                    SRCVAL(pImag0, eSrcType, ii)
-                    - SRCVAL(pImag1, eSrcType, ii)
-                };
-
-                GDALCopyWords(
-                    adfPixVal, GDT_CFloat64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1 );
-            }
+        for( int iLine = 0; iLine < nYSize; ++iLine ) {
+            LoadRealLine(papoSources[0], eSrcType, nXSize, iLine, padfReal0);
+            LoadImagLine(papoSources[0], eSrcType, nXSize, iLine, padfImag0);
+            LoadRealLine(papoSources[1], eSrcType, nXSize, iLine, padfReal1);
+            LoadImagLine(papoSources[1], eSrcType, nXSize, iLine, padfImag1);
+            BinaryKernel<SubOp>(padfReal0, padfReal1, padfReal0, nXSize);
+            BinaryKernel<SubOp>(padfImag0, padfImag1, padfImag0, nXSize);
+            StoreComplexLine(padfReal0, padfImag0, pData, iLine, nXSize,
+                             eBufType, nPixelSpace, nLineSpace);
         }
     }
     else
     {
         /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                // Not complex.
-                const double dfPixVal = SRCVAL(papoSources[0], eSrcType, ii)
-                    - SRCVAL(papoSources[1], eSrcType, ii);
-
-                GDALCopyWords(
-                    &dfPixVal, GDT_Float64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1);
-            }
+        for( int iLine = 0; iLine < nYSize; ++iLine ) {
+            LoadRealLine(papoSources[0], eSrcType, nXSize, iLine, padfReal0);
+            LoadRealLine(papoSources[1], eSrcType, nXSize, iLine, padfReal1);
+            BinaryKernel<SubOp>(padfReal0, padfReal1, padfReal0, nXSize);
+            StoreLine(padfReal0, pData, iLine, nXSize,
+                      eBufType, nPixelSpace, nLineSpace);
         }
     }
 
@@ -496,56 +679,46 @@ static CPLErr MulPixelFunc( void **papoSources, int nSources, void *pData,
     /* ---- Init ---- */
     if( nSources < 2 ) return CE_Failure;
 
+    PixelFuncLineBuffers oBuffers(nXSize, 4);
+    if( !oBuffers.IsValid() ) return CE_Failure;
+    double * const padfProdReal = oBuffers.Line(0);
+    double * const padfProdImag = oBuffers.Line(1);
+    double * const padfReal = oBuffers.Line(2);
+    double * const padfImag = oBuffers.Line(3);
+
     /* ---- Set pixels ---- */
     if( GDALDataTypeIsComplex( eSrcType ) )
     {
-        const int nOffset = GDALGetDataTypeSizeBytes( eSrcType ) / 2;
-
-        /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                double adfPixVal[2] = { 1.0, 0.0 };
-
-                for( int iSrc = 0; iSrc < nSources; ++iSrc ) {
-                    const void * const pReal = papoSources[iSrc];
-                    const void * const pImag =
-                        static_cast<const GByte *>(pReal) + nOffset;
-
-                    const double dfOldR = adfPixVal[0];
-                    const double dfOldI = adfPixVal[1];
-
-                    // Source raster pixels may be obtained with SRCVAL macro.
-                    const double dfNewR = SRCVAL(pReal, eSrcType, ii);
-                    const double dfNewI = SRCVAL(pImag, eSrcType, ii);
-
-                    adfPixVal[0] = dfOldR * dfNewR - dfOldI * dfNewI;
-                    adfPixVal[1] = dfOldR * dfNewI + dfOldI * dfNewR;
-                }
-
-                GDALCopyWords(
-                    adfPixVal, GDT_CFloat64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1);
+        for( int iLine = 0; iLine < nYSize; ++iLine ) {
+            LoadRealLine(papoSources[0], eSrcType, nXSize, iLine,
+                         padfProdReal);
+            LoadImagLine(papoSources[0], eSrcType, nXSize, iLine,
+                         padfProdImag);
+            for( int iSrc = 1; iSrc < nSources; ++iSrc ) {
+                LoadRealLine(papoSources[iSrc], eSrcType, nXSize, iLine,
+                             padfReal);
+                LoadImagLine(papoSources[iSrc], eSrcType, nXSize, iLine,
+                             padfImag);
+                ComplexMulKernel<false>(padfProdReal, padfProdImag,
+                                        padfReal, padfImag, nXSize);
             }
+            StoreComplexLine(padfProdReal, padfProdImag, pData, iLine, nXSize,
+                             eBufType, nPixelSpace, nLineSpace);
         }
     }
     else
     {
-        /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                double dfPixVal = 1.0;  // Not complex.
-
-                for( int iSrc = 0; iSrc < nSources; ++iSrc ) {
-                    // Source raster pixels may be obtained with SRCVAL macro.
-                    dfPixVal *= SRCVAL(papoSources[iSrc], eSrcType, ii);
-                }
-
-                GDALCopyWords(
-                    &dfPixVal, GDT_Float64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1);
+        for( int iLine = 0; iLine < nYSize; ++iLine ) {
+            LoadRealLine(papoSources[0], eSrcType, nXSize, iLine,
+                         padfProdReal);
+            for( int iSrc = 1; iSrc < nSources; ++iSrc ) {
+                LoadRealLine(papoSources[iSrc], eSrcType, nXSize, iLine,
+                             padfReal);
+                BinaryKernel<MulOp>(padfProdReal, padfReal, padfProdReal,
+                                    nXSize);
             }
+            StoreLine(padfProdReal, pData, iLine, nXSize,
+                      eBufType, nPixelSpace, nLineSpace);
         }
     }
 
@@ -561,53 +734,37 @@ static CPLErr CMulPixelFunc( void **papoSources, int nSources, void *pData,
     /* ---- Init ---- */
     if( nSources != 2 ) return CE_Failure;
 
+    PixelFuncLineBuffers oBuffers(nXSize, 4);
+    if( !oBuffers.IsValid() ) return CE_Failure;
+    double * const padfReal0 = oBuffers.Line(0);
+    double * const padfImag0 = oBuffers.Line(1);
+    double * const padfReal1 = oBuffers.Line(2);
+    double * const padfImag1 = oBuffers.Line(3);
+
     /* ---- Set pixels ---- */
     if( GDALDataTypeIsComplex( eSrcType ) )
     {
-        const int nOffset = GDALGetDataTypeSizeBytes( eSrcType ) / 2;
-        const void * const pReal0 = papoSources[0];
-        const void * const pImag0 =
-            static_cast<GByte *>(papoSources[0]) + nOffset;
-        const void * const pReal1 = papoSources[1];
-        const void * const pImag1 =
-            static_cast<GByte *>(papoSources[1]) + nOffset;
-
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                const double dfReal0 = SRCVAL(pReal0, eSrcType, ii);
-                const double dfReal1 = SRCVAL(pReal1, eSrcType, ii);
-                const double dfImag0 = SRCVAL(pImag0, eSrcType, ii);
-                const double dfImag1 = SRCVAL(pImag1, eSrcType, ii);
-                const double adfPixVal[2] = {
-                    dfReal0 * dfReal1 + dfImag0 * dfImag1,
-                    dfReal1 * dfImag0 - dfReal0 * dfImag1
-                };
-
-                GDALCopyWords(
-                    adfPixVal, GDT_CFloat64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1 );
-            }
+        for( int iLine = 0; iLine < nYSize; ++iLine ) {
+            LoadRealLine(papoSources[0], eSrcType, nXSize, iLine, padfReal0);
+            LoadImagLine(papoSources[0], eSrcType, nXSize, iLine, padfImag0);
+            LoadRealLine(papoSources[1], eSrcType, nXSize, iLine, padfReal1);
+            LoadImagLine(papoSources[1], eSrcType, nXSize, iLine, padfImag1);
+            ComplexMulKernel<true>(padfReal0, padfImag0,
+                                   padfReal1, padfImag1, nXSize);
+            StoreComplexLine(padfReal0, padfImag0, pData, iLine, nXSize,
+                             eBufType, nPixelSpace, nLineSpace);
         }
     }
     else
     {
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                // Not complex.
-                const double adfPixVal[2] = {
-                    SRCVAL(papoSources[0], eSrcType, ii)
-                    * SRCVAL(papoSources[1], eSrcType, ii),
-                    0.0
-                };
-
-                GDALCopyWords(
-                    adfPixVal, GDT_CFloat64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1 );
-            }
+        // Not complex: the imaginary part of the result is 0.
+        std::fill(padfImag0, padfImag0 + nXSize, 0.0);
+        for( int iLine = 0; iLine < nYSize; ++iLine ) {
+            LoadRealLine(papoSources[0], eSrcType, nXSize, iLine, padfReal0);
+            LoadRealLine(papoSources[1], eSrcType, nXSize, iLine, padfReal1);
+            BinaryKernel<MulOp>(padfReal0, padfReal1, padfReal0, nXSize);
+            StoreComplexLine(padfReal0, padfImag0, pData, iLine, nXSize,
+                             eBufType, nPixelSpace, nLineSpace);
         }
     }
 
@@ -623,44 +780,36 @@ static CPLErr InvPixelFunc( void **papoSources, int nSources, void *pData,
     /* ---- Init ---- */
     if( nSources != 1 ) return CE_Failure;
 
+    PixelFuncLineBuffers oBuffers(nXSize, 3);
+    if( !oBuffers.IsValid() ) return CE_Failure;
+    double * const padfReal = oBuffers.Line(0);
+    double * const padfImag = oBuffers.Line(1);
+    double * const padfAux = oBuffers.Line(2);
+
     /* ---- Set pixels ---- */
     if( GDALDataTypeIsComplex( eSrcType ) )
     {
-        const int nOffset = GDALGetDataTypeSizeBytes( eSrcType ) / 2;
-        const void * const pReal = papoSources[0];
-        const void * const pImag =
-            static_cast<GByte *>(papoSources[0]) + nOffset;
-
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                const double dfReal = SRCVAL(pReal, eSrcType, ii);
-                const double dfImag = SRCVAL(pImag, eSrcType, ii);
-                const double dfAux = dfReal * dfReal + dfImag * dfImag;
-                const double adfPixVal[2] = { dfReal / dfAux, -dfImag / dfAux };
-
-                GDALCopyWords(
-                    adfPixVal, GDT_CFloat64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1);
-            }
+        for( int iLine = 0; iLine < nYSize; ++iLine ) {
+            LoadRealLine(papoSources[0], eSrcType, nXSize, iLine, padfReal);
+            LoadImagLine(papoSources[0], eSrcType, nXSize, iLine, padfImag);
+            SquaredModKernel(padfReal, padfImag, padfAux, nXSize);
+            BinaryKernel<DivOp>(padfReal, padfAux, padfReal, nXSize);
+            BinaryKernel<DivOp>(padfImag, padfAux, padfImag, nXSize);
+            for( int iCol = 0; iCol < nXSize; ++iCol )
+                padfImag[iCol] = -padfImag[iCol];
+            StoreComplexLine(padfReal, padfImag, pData, iLine, nXSize,
+                             eBufType, nPixelSpace, nLineSpace);
         }
     }
     else
     {
-        /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                // Not complex.
-                const double dfPixVal =
-                    1.0 / SRCVAL(papoSources[0], eSrcType, ii);
-
-                GDALCopyWords(
-                    &dfPixVal, GDT_Float64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1 );
-            }
+        // Not complex.
+        std::fill(padfAux, padfAux + nXSize, 1.0);
+        for( int iLine = 0; iLine < nYSize; ++iLine ) {
+            LoadRealLine(papoSources[0], eSrcType, nXSize, iLine, padfReal);
+            BinaryKernel<DivOp>(padfAux, padfReal, padfReal, nXSize);
+            StoreLine(padfReal, pData, iLine, nXSize,
+                      eBufType, nPixelSpace, nLineSpace);
         }
     }
 
@@ -676,43 +825,30 @@ static CPLErr IntensityPixelFunc( void **papoSources, int nSources, void *pData,
     /* ---- Init ---- */
     if( nSources != 1 ) return CE_Failure;
 
+    PixelFuncLineBuffers oBuffers(nXSize, 2);
+    if( !oBuffers.IsValid() ) return CE_Failure;
+    double * const padfReal = oBuffers.Line(0);
+    double * const padfImag = oBuffers.Line(1);
+
     if( GDALDataTypeIsComplex( eSrcType ) )
     {
-        const int nOffset = GDALGetDataTypeSizeBytes( eSrcType ) / 2;
-        const void * const pReal = papoSources[0];
-        const void * const pImag =
-            static_cast<GByte *>(papoSources[0]) + nOffset;
-
         /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                const double dfReal = SRCVAL(pReal, eSrcType, ii);
-                const double dfImag = SRCVAL(pImag, eSrcType, ii);
-
-                const double dfPixVal = dfReal * dfReal + dfImag * dfImag;
-
-                GDALCopyWords(
-                    &dfPixVal, GDT_Float64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1);
-            }
+        for( int iLine = 0; iLine < nYSize; ++iLine ) {
+            LoadRealLine(papoSources[0], eSrcType, nXSize, iLine, padfReal);
+            LoadImagLine(papoSources[0], eSrcType, nXSize, iLine, padfImag);
+            SquaredModKernel(padfReal, padfImag, padfReal, nXSize);
+            StoreLine(padfReal, pData, iLine, nXSize,
+                      eBufType, nPixelSpace, nLineSpace);
         }
     }
     else
     {
         /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                double dfPixVal = SRCVAL(papoSources[0], eSrcType, ii);
-                dfPixVal *= dfPixVal;
-
-                GDALCopyWords(
-                    &dfPixVal, GDT_Float64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1);
-            }
+        for( int iLine = 0; iLine < nYSize; ++iLine ) {
+            LoadRealLine(papoSources[0], eSrcType, nXSize, iLine, padfReal);
+            BinaryKernel<MulOp>(padfReal, padfReal, padfReal, nXSize);
+            StoreLine(padfReal, pData, iLine, nXSize,
+                      eBufType, nPixelSpace, nLineSpace);
         }
     }
 
@@ -729,18 +865,17 @@ static CPLErr SqrtPixelFunc( void **papoSources, int nSources, void *pData,
     if( nSources != 1 ) return CE_Failure;
     if( GDALDataTypeIsComplex( eSrcType ) ) return CE_Failure;
 
-    /* ---- Set pixels ---- */
-    for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-        for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-            // Source raster pixels may be obtained with SRCVAL macro.
-            const double dfPixVal =
-                sqrt( SRCVAL(papoSources[0], eSrcType, ii) );
+    PixelFuncLineBuffers oBuffers(nXSize, 1);
+    if( !oBuffers.IsValid() ) return CE_Failure;
+    double * const padfLine = oBuffers.Line(0);
 
-            GDALCopyWords(
-                &dfPixVal, GDT_Float64, 0,
-                static_cast<GByte *>(pData) + nLineSpace * iLine +
-                iCol * nPixelSpace, eBufType, nPixelSpace, 1);
-        }
+    /* ---- Set pixels ---- */
+    for( int iLine = 0; iLine < nYSize; ++iLine ) {
+        LoadRealLine(papoSources[0], eSrcType, nXSize, iLine, padfLine);
+        for( int iCol = 0; iCol < nXSize; ++iCol )
+            padfLine[iCol] = sqrt(padfLine[iCol]);
+        StoreLine(padfLine, pData, iLine, nXSize,
+                  eBufType, nPixelSpace, nLineSpace);
     }
 
     /* ---- Return success ---- */
@@ -758,46 +893,37 @@ static CPLErr Log10PixelFuncHelper( void **papoSources, int nSources,
     /* ---- Init ---- */
     if( nSources != 1 ) return CE_Failure;
 
+    PixelFuncLineBuffers oBuffers(nXSize, 2);
+    if( !oBuffers.IsValid() ) return CE_Failure;
+    double * const padfReal = oBuffers.Line(0);
+    double * const padfImag = oBuffers.Line(1);
+
     if( GDALDataTypeIsComplex( eSrcType ) )
     {
         // Complex input datatype.
-        const int nOffset = GDALGetDataTypeSizeBytes( eSrcType ) / 2;
-        const void * const pReal = papoSources[0];
-        const void * const pImag =
-            static_cast<GByte *>(papoSources[0]) + nOffset;
+        // fact * log10(sqrt(x)) == (fact / 2) * log10(x)
+        const double dfHalfFact = fact / 2;
 
         /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                const double dfReal = SRCVAL(pReal, eSrcType, ii);
-                const double dfImag = SRCVAL(pImag, eSrcType, ii);
-
-                const double dfPixVal =
-                    fact * log10( sqrt( dfReal * dfReal + dfImag * dfImag ) );
-
-                GDALCopyWords(
-                    &dfPixVal, GDT_Float64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1 );
-            }
+        for( int iLine = 0; iLine < nYSize; ++iLine ) {
+            LoadRealLine(papoSources[0], eSrcType, nXSize, iLine, padfReal);
+            LoadImagLine(papoSources[0], eSrcType, nXSize, iLine, padfImag);
+            SquaredModKernel(padfReal, padfImag, padfReal, nXSize);
+            for( int iCol = 0; iCol < nXSize; ++iCol )
+                padfReal[iCol] = dfHalfFact * log10(padfReal[iCol]);
+            StoreLine(padfReal, pData, iLine, nXSize,
+                      eBufType, nPixelSpace, nLineSpace);
         }
     }
     else
     {
         /* ---- Set pixels ---- */
-        for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-            for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-                // Source raster pixels may be obtained with SRCVAL macro.
-                const double dfPixVal =
-                    fact * log10( fabs(
-                        SRCVAL(papoSources[0], eSrcType, ii) ) );
-
-                GDALCopyWords(
-                    &dfPixVal, GDT_Float64, 0,
-                    static_cast<GByte *>(pData) + nLineSpace * iLine +
-                    iCol * nPixelSpace, eBufType, nPixelSpace, 1 );
-            }
+        for( int iLine = 0; iLine < nYSize; ++iLine ) {
+            LoadRealLine(papoSources[0], eSrcType, nXSize, iLine, padfReal);
+            for( int iCol = 0; iCol < nXSize; ++iCol )
+                padfReal[iCol] = fact * log10(fabs(padfReal[iCol]));
+            StoreLine(padfReal, pData, iLine, nXSize,
+                      eBufType, nPixelSpace, nLineSpace);
         }
     }
 
@@ -835,18 +961,17 @@ static CPLErr PowPixelFuncHelper( void **papoSources, int nSources, void *pData,
     if( nSources != 1 ) return CE_Failure;
     if( GDALDataTypeIsComplex( eSrcType ) ) return CE_Failure;
 
-    /* ---- Set pixels ---- */
-    for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
-        for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
-            // Source raster pixels may be obtained with SRCVAL macro.
-            const double dfPixVal =
-                pow(base, SRCVAL(papoSources[0], eSrcType, ii) / fact);
+    PixelFuncLineBuffers oBuffers(nXSize, 1);
+    if( !oBuffers.IsValid() ) return CE_Failure;
+    double * const padfLine = oBuffers.Line(0);
 
-            GDALCopyWords(
-                &dfPixVal, GDT_Float64, 0,
-                static_cast<GByte *>(pData) + nLineSpace * iLine +
-                iCol * nPixelSpace, eBufType, nPixelSpace, 1);
-        }
+    /* ---- Set pixels ---- */
+    for( int iLine = 0; iLine < nYSize; ++iLine ) {
+        LoadRealLine(papoSources[0], eSrcType, nXSize, iLine, padfLine);
+        for( int iCol = 0; iCol < nXSize; ++iCol )
+            padfLine[iCol] = pow(base, padfLine[iCol] / fact);
+        StoreLine(padfLine, pData, iLine, nXSize,
+                  eBufType, nPixelSpace, nLineSpace);
     }
 
     /* ---- Return success ---- */
@@ -873,6 +998,537 @@ static CPLErr dB2PowPixelFunc( void **papoSources, int nSources, void *pData,
                               nPixelSpace, nLineSpace, 10.0, 10.0);
 }  // dB2PowPixelFunc
 
+/************************************************************************/
+/* ==================================================================== */
+/*                          VRTPixelExpression                          */
+/* ==================================================================== */
+/************************************************************************/
+
+namespace {
+
+enum VRTPixelExpressionOp
+{
+    EXPR_OP_SOURCE,
+    EXPR_OP_CONSTANT,
+    EXPR_OP_NEG,
+    EXPR_OP_ADD,
+    EXPR_OP_SUB,
+    EXPR_OP_MUL,
+    EXPR_OP_DIV,
+    EXPR_OP_POW,
+    EXPR_OP_MIN,
+    EXPR_OP_MAX,
+    EXPR_OP_SQRT,
+    EXPR_OP_ABS,
+    EXPR_OP_EXP,
+    EXPR_OP_LOG,
+    EXPR_OP_LOG10
+};
+
+// Number of operands popped from the stack by an operation.
+int GetExprOpArity( int nOp )
+{
+    switch( nOp )
+    {
+        case EXPR_OP_SOURCE:
+        case EXPR_OP_CONSTANT:
+            return 0;
+        case EXPR_OP_NEG:
+        case EXPR_OP_SQRT:
+        case EXPR_OP_ABS:
+        case EXPR_OP_EXP:
+        case EXPR_OP_LOG:
+        case EXPR_OP_LOG10:
+            return 1;
+        case EXPR_OP_ADD:
+        case EXPR_OP_SUB:
+        case EXPR_OP_MUL:
+        case EXPR_OP_DIV:
+        case EXPR_OP_POW:
+        case EXPR_OP_MIN:
+        case EXPR_OP_MAX:
+            return 2;
+    }
+    CPLAssert(false);
+    return 0;
+}
+
+} // namespace
+
+/************************************************************************/
+/*                      VRTPixelExpressionParser                        */
+/************************************************************************/
+
+// Recursive descent parser producing the postfix code of a
+// VRTPixelExpression:
+//
+//   expr    := term ( ('+' | '-') term )*
+//   term    := unary ( ('*' | '/') unary )*
+//   unary   := ('-' | '+') unary | power
+//   power   := primary ( '^' unary )?
+//   primary := number | 'B' index | func '(' expr (',' expr)* ')'
+//            | '(' expr ')'
+
+class VRTPixelExpressionParser
+{
+    const char          *m_pszExpression;
+    const char          *m_pszCur;
+    VRTPixelExpression  &m_oExpr;
+    int                  m_nDepth = 0;
+    int                  m_nNesting = 0;
+    bool                 m_bError = false;
+
+    static constexpr int knMaxNesting = 256;
+
+    VRTPixelExpressionParser(const VRTPixelExpressionParser&) = delete;
+    VRTPixelExpressionParser& operator= (const VRTPixelExpressionParser&) = delete;
+
+    void SkipSpaces()
+    {
+        while( *m_pszCur == ' ' || *m_pszCur == '\t' ||
+               *m_pszCur == '\n' || *m_pszCur == '\r' )
+            ++m_pszCur;
+    }
+
+    bool Accept( char ch )
+    {
+        SkipSpaces();
+        if( *m_pszCur != ch )
+            return false;
+        ++m_pszCur;
+        return true;
+    }
+
+    void Error( const char* pszMsg )
+    {
+        if( !m_bError )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "Invalid pixel function expression '%s': %s at "
+                     "character %d",
+                     m_pszExpression, pszMsg,
+                     static_cast<int>(m_pszCur - m_pszExpression) + 1);
+        }
+        m_bError = true;
+    }
+
+    void Emit( int nOp, int nArg = 0 )
+    {
+        VRTPixelExpression::Instruction sInstr;
+        sInstr.nOp = nOp;
+        sInstr.nArg = nArg;
+        m_oExpr.m_aoCode.push_back(sInstr);
+        // Each operation pushes one result.
+        m_nDepth += 1 - GetExprOpArity(nOp);
+        m_oExpr.m_nStackDepth = std::max(m_oExpr.m_nStackDepth, m_nDepth);
+    }
+
+    void ParseExpr()
+    {
+        ParseTerm();
+        while( !m_bError )
+        {
+            if( Accept('+') )
+            {
+                ParseTerm();
+                Emit(EXPR_OP_ADD);
+            }
+            else if( Accept('-') )
+            {
+                ParseTerm();
+                Emit(EXPR_OP_SUB);
+            }
+            else
+                break;
+        }
+    }
+
+    void ParseTerm()
+    {
+        ParseUnary();
+        while( !m_bError )
+        {
+            if( Accept('*') )
+            {
+                ParseUnary();
+                Emit(EXPR_OP_MUL);
+            }
+            else if( Accept('/') )
+            {
+                ParseUnary();
+                Emit(EXPR_OP_DIV);
+            }
+            else
+                break;
+        }
+    }
+
+    void ParseUnary()
+    {
+        // All the recursions of the grammar go through this rule: bound
+        // them so that deeply nested expressions cannot overflow the stack.
+        if( m_nNesting == knMaxNesting )
+        {
+            Error("expression too deeply nested");
+            return;
+        }
+        ++m_nNesting;
+        ParseUnaryInternal();
+        --m_nNesting;
+    }
+
+    void ParseUnaryInternal()
+    {
+        if( Accept('-') )
+        {
+            ParseUnary();
+            Emit(EXPR_OP_NEG);
+        }
+        else if( Accept('+') )
+        {
+            ParseUnary();
+        }
+        else
+        {
+            ParsePower();
+        }
+    }
+
+    void ParsePower()
+    {
+        ParsePrimary();
+        if( !m_bError && Accept('^') )
+        {
+            ParseUnary();
+            Emit(EXPR_OP_POW);
+        }
+    }
+
+    void ParseFunction( const CPLString& osName )
+    {
+        static const struct
+        {
+            const char *pszName;
+            int         nOp;
+            int         nArgs;
+        } asFunctions[] = {
+            { "sqrt", EXPR_OP_SQRT, 1 },
+            { "abs", EXPR_OP_ABS, 1 },
+            { "exp", EXPR_OP_EXP, 1 },
+            { "log", EXPR_OP_LOG, 1 },
+            { "log10", EXPR_OP_LOG10, 1 },
+            { "pow", EXPR_OP_POW, 2 },
+            { "min", EXPR_OP_MIN, 2 },
+            { "max", EXPR_OP_MAX, 2 },
+        };
+        for( const auto& sFunction: asFunctions )
+        {
+            if( !EQUAL(osName, sFunction.pszName) )
+                continue;
+            if( !Accept('(') )
+            {
+                Error("'(' expected");
+                return;
+            }
+            for( int i = 0; i < sFunction.nArgs && !m_bError; ++i )
+            {
+                if( i > 0 && !Accept(',') )
+                {
+                    Error("',' expected");
+                    return;
+                }
+                ParseExpr();
+            }
+            if( m_bError )
+                return;
+            if( !Accept(')') )
+            {
+                Error("')' expected");
+                return;
+            }
+            Emit(sFunction.nOp);
+            return;
+        }
+        Error(CPLSPrintf("unknown function '%s'", osName.c_str()));
+    }
+
+    void ParsePrimary()
+    {
+        SkipSpaces();
+        const char ch = *m_pszCur;
+        if( Accept('(') )
+        {
+            ParseExpr();
+            if( !m_bError && !Accept(')') )
+                Error("')' expected");
+        }
+        else if( (ch >= '0' && ch <= '9') || ch == '.' )
+        {
+            char *pszEnd = nullptr;
+            const double dfValue = CPLStrtod(m_pszCur, &pszEnd);
+            if( pszEnd == m_pszCur )
+            {
+                Error("invalid number");
+                return;
+            }
+            m_pszCur = pszEnd;
+            Emit(EXPR_OP_CONSTANT,
+                 static_cast<int>(m_oExpr.m_adfConstants.size()));
+            m_oExpr.m_adfConstants.push_back(dfValue);
+        }
+        else if( (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') )
+        {
+            const char *pszStart = m_pszCur;
+            while( (*m_pszCur >= 'a' && *m_pszCur <= 'z') ||
+                   (*m_pszCur >= 'A' && *m_pszCur <= 'Z') ||
+                   (*m_pszCur >= '0' && *m_pszCur <= '9') ||
+                   *m_pszCur == '_' )
+                ++m_pszCur;
+            const CPLString osName(pszStart, m_pszCur - pszStart);
+            if( (osName[0] == 'B' || osName[0] == 'b') &&
+                osName.size() > 1 && osName.size() < 8 &&
+                osName.find_first_not_of("0123456789", 1) ==
+                                                        std::string::npos )
+            {
+                const int nBand = atoi(osName.c_str() + 1);
+                if( nBand < 1 )
+                {
+                    m_pszCur = pszStart;
+                    Error("invalid source band index");
+                    return;
+                }
+                m_oExpr.m_nMaxSourceIndex =
+                    std::max(m_oExpr.m_nMaxSourceIndex, nBand);
+                Emit(EXPR_OP_SOURCE, nBand - 1);
+            }
+            else
+            {
+                ParseFunction(osName);
+            }
+        }
+        else if( ch == '\0' )
+        {
+            Error("unexpected end of expression");
+        }
+        else
+        {
+            Error("unexpected character");
+        }
+    }
+
+  public:
+    VRTPixelExpressionParser( const char *pszExpression,
+                              VRTPixelExpression &oExpr ) :
+        m_pszExpression(pszExpression),
+        m_pszCur(pszExpression),
+        m_oExpr(oExpr)
+    {
+    }
+
+    bool Parse()
+    {
+        ParseExpr();
+        SkipSpaces();
+        if( !m_bError && *m_pszCur != '\0' )
+            Error("unexpected character");
+        return !m_bError;
+    }
+};
+
+/************************************************************************/
+/*                              Compile()                               */
+/************************************************************************/
+
+/**
+ * Compiles an arithmetic expression on source bands.
+ *
+ * Sources are referred to as B1, B2, ... (1-based). The +, -, *, / and ^
+ * operators, parentheses, numeric constants and the sqrt, abs, exp, log,
+ * log10, pow, min and max functions are supported.
+ *
+ * @return the compiled expression, or nullptr (with a CPLError() emitted)
+ * if the expression is invalid.
+ */
+std::unique_ptr<VRTPixelExpression>
+VRTPixelExpression::Compile( const char *pszExpression )
+{
+    std::unique_ptr<VRTPixelExpression> poExpr(new VRTPixelExpression());
+    VRTPixelExpressionParser oParser(pszExpression, *poExpr);
+    if( !oParser.Parse() )
+        return nullptr;
+    return poExpr;
+}
+
+/************************************************************************/
+/*                              Evaluate()                              */
+/************************************************************************/
+
+/**
+ * Evaluates the expression over packed source buffers. The arguments have
+ * the same meaning as for a GDALDerivedPixelFunc.
+ *
+ * The code is run one line at a time, each instruction processing a whole
+ * line, so that the interpretation overhead is negligible.
+ */
+CPLErr VRTPixelExpression::Evaluate( void **papoSources, int nSources,
+                                     void *pData, int nXSize, int nYSize,
+                                     GDALDataType eSrcType,
+                                     GDALDataType eBufType,
+                                     int nPixelSpace, int nLineSpace ) const
+{
+    if( nSources < m_nMaxSourceIndex )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "Pixel function expression refers to B%d, but only "
+                 "%d source(s) are defined",
+                 m_nMaxSourceIndex, nSources);
+        return CE_Failure;
+    }
+    if( GDALDataTypeIsComplex( eSrcType ) )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "Pixel function expression does not support complex "
+                 "source data types");
+        return CE_Failure;
+    }
+
+    // Lines: one per stack slot, one per referenced source and one per
+    // constant.
+    const int nConstants = static_cast<int>(m_adfConstants.size());
+    PixelFuncLineBuffers oBuffers(
+        nXSize, m_nStackDepth + m_nMaxSourceIndex + nConstants);
+    if( !oBuffers.IsValid() )
+        return CE_Failure;
+
+    std::vector<bool> abSourceUsed(m_nMaxSourceIndex, false);
+    for( const auto& sInstr: m_aoCode )
+    {
+        if( sInstr.nOp == EXPR_OP_SOURCE )
+            abSourceUsed[sInstr.nArg] = true;
+    }
+    for( int i = 0; i < nConstants; ++i )
+    {
+        double *padfLine = oBuffers.Line(m_nStackDepth + m_nMaxSourceIndex + i);
+        std::fill(padfLine, padfLine + nXSize, m_adfConstants[i]);
+    }
+
+    // Stack of the lines holding operands. An operand may point to a
+    // source or a constant line, results are written in the scratch line
+    // of their stack slot.
+    std::vector<const double *> apadfStack(m_nStackDepth);
+
+    for( int iLine = 0; iLine < nYSize; ++iLine )
+    {
+        for( int iSrc = 0; iSrc < m_nMaxSourceIndex; ++iSrc )
+        {
+            if( abSourceUsed[iSrc] )
+                LoadRealLine(papoSources[iSrc], eSrcType, nXSize, iLine,
+                             oBuffers.Line(m_nStackDepth + iSrc));
+        }
+
+        int nTop = 0;
+        for( const auto& sInstr: m_aoCode )
+        {
+            switch( sInstr.nOp )
+            {
+                case EXPR_OP_SOURCE:
+                    apadfStack[nTop++] =
+                        oBuffers.Line(m_nStackDepth + sInstr.nArg);
+                    continue;
+                case EXPR_OP_CONSTANT:
+                    apadfStack[nTop++] = oBuffers.Line(
+                        m_nStackDepth + m_nMaxSourceIndex + sInstr.nArg);
+                    continue;
+                default:
+                    break;
+            }
+
+            if( GetExprOpArity(sInstr.nOp) == 2 )
+            {
+                // Binary operator
+                --nTop;
+                const double *padfA = apadfStack[nTop - 1];
+                const double *padfB = apadfStack[nTop];
+                double *padfOut = oBuffers.Line(nTop - 1);
+                switch( sInstr.nOp )
+                {
+                    case EXPR_OP_ADD:
+                        BinaryKernel<AddOp>(padfA, padfB, padfOut, nXSize);
+                        break;
+                    case EXPR_OP_SUB:
+                        BinaryKernel<SubOp>(padfA, padfB, padfOut, nXSize);
+                        break;
+                    case EXPR_OP_MUL:
+                        BinaryKernel<MulOp>(padfA, padfB, padfOut, nXSize);
+                        break;
+                    case EXPR_OP_DIV:
+                        BinaryKernel<DivOp>(padfA, padfB, padfOut, nXSize);
+                        break;
+                    case EXPR_OP_POW:
+                        for( int i = 0; i < nXSize; ++i )
+                            padfOut[i] = pow(padfA[i], padfB[i]);
+                        break;
+                    case EXPR_OP_MIN:
+                        for( int i = 0; i < nXSize; ++i )
+                            padfOut[i] = std::min(padfA[i], padfB[i]);
+                        break;
+                    case EXPR_OP_MAX:
+                        for( int i = 0; i < nXSize; ++i )
+                            padfOut[i] = std::max(padfA[i], padfB[i]);
+                        break;
+                    default:
+                        CPLAssert(false);
+                        break;
+                }
+                apadfStack[nTop - 1] = padfOut;
+            }
+            else
+            {
+                // Unary operator
+                const double *padfA = apadfStack[nTop - 1];
+                double *padfOut = oBuffers.Line(nTop - 1);
+                switch( sInstr.nOp )
+                {
+                    case EXPR_OP_NEG:
+                        for( int i = 0; i < nXSize; ++i )
+                            padfOut[i] = -padfA[i];
+                        break;
+                    case EXPR_OP_SQRT:
+                        for( int i = 0; i < nXSize; ++i )
+                            padfOut[i] = sqrt(padfA[i]);
+                        break;
+                    case EXPR_OP_ABS:
+                        for( int i = 0; i < nXSize; ++i )
+                            padfOut[i] = fabs(padfA[i]);
+                        break;
+                    case EXPR_OP_EXP:
+                        for( int i = 0; i < nXSize; ++i )
+                            padfOut[i] = exp(padfA[i]);
+                        break;
+                    case EXPR_OP_LOG:
+                        for( int i = 0; i < nXSize; ++i )
+                            padfOut[i] = log(padfA[i]);
+                        break;
+                    case EXPR_OP_LOG10:
+                        for( int i = 0; i < nXSize; ++i )
+                            padfOut[i] = log10(padfA[i]);
+                        break;
+                    default:
+                        CPLAssert(false);
+                        break;
+                }
+                apadfStack[nTop - 1] = padfOut;
+            }
+        }
+        CPLAssert(nTop == 1);
+
+        StoreLine(apadfStack[0], pData, iLine, nXSize,
+                  eBufType, nPixelSpace, nLineSpace);
+    }
+
+    return CE_None;
+}
+
 /************************************************************************/
 /*                     GDALRegisterDefaultPixelFunc()                   */
 /************************************************************************/
@@ -911,6 +1567,10 @@ static CPLErr dB2PowPixelFunc( void **papoSources, int nSources, void *pData,
  *             (power) (i.e. 10 ^ ( x / 10 ) ) of a single raster
  *             band (real only)
  *
+ * The "expression" pixel function, which evaluates an arithmetic expression
+ * given in the PixelFunctionArguments of the band, is handled by
+ * VRTDerivedRasterBand itself through VRTPixelExpression.
+ *
  * @see GDALAddDerivedBandPixelFunc
  *
  * @return CE_None
@@ -31,6 +31,7 @@
 
 #include "cpl_minixml.h"
 #include "cpl_string.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal_frmts.h"
 #include "ogr_spatialref.h"
 #include "gdal_utils.h"
@@ -121,6 +122,39 @@ VRTDataset::~VRTDataset()
     for(size_t i=0;i<m_apoOverviewsBak.size();i++)
         delete m_apoOverviewsBak[i];
     CSLDestroy( m_papszXMLVRTMetadata );
+
+    delete m_poSourceThreadPool;
+}
+
+/************************************************************************/
+/*                        GetSourceThreadPool()                         */
+/************************************************************************/
+
+/** Returns the pool used to read the sources of a request concurrently,
+ * or nullptr if the VRT_NUM_THREADS configuration option (or
+ * GDAL_NUM_THREADS if it is not set) is not set to a value greater than one
+ * (or ALL_CPUS). The value is not capped to the number of CPUs, as the
+ * threads mostly wait for I/O.
+ */
+CPLWorkerThreadPool* VRTDataset::GetSourceThreadPool()
+{
+    if( !m_bSourceThreadPoolInitialized )
+    {
+        m_bSourceThreadPoolInitialized = true;
+
+        const int nThreads = CPLGetNumThreadsOption(
+            CPLGetConfigOption("VRT_NUM_THREADS", nullptr), "1");
+        if( nThreads > 1 )
+        {
+            m_poSourceThreadPool = new CPLWorkerThreadPool();
+            if( !m_poSourceThreadPool->Setup(nThreads, nullptr, nullptr) )
+            {
+                delete m_poSourceThreadPool;
+                m_poSourceThreadPool = nullptr;
+            }
+        }
+    }
+    return m_poSourceThreadPool;
 }
 
 /************************************************************************/
@@ -1874,15 +1908,33 @@ CPLErr VRTDataset::IRasterIO( GDALRWFlag eRWFlag,
         // they don't necessary instantiate all underlying rasterbands.
         VRTSourcedRasterBand* poBand = static_cast<VRTSourcedRasterBand *>(
             papoBands[nBands - 1] );
-        for( int iSource = 0;
-             eErr == CE_None && iSource < poBand->nSources;
-             iSource++ )
+        std::vector<int> anSources;
+        poBand->GetSourcesForWindow( nXOff, nYOff, nXSize, nYSize, anSources );
+        const int nSourcesToRead = static_cast<int>( anSources.size() );
+
+        CPLWorkerThreadPool* poThreadPool =
+            nSourcesToRead > 1 ? GetSourceThreadPool() : nullptr;
+        if( poThreadPool != nullptr &&
+            poBand->ReadSourcesMultiThreaded( poThreadPool, anSources,
+                                              nXOff, nYOff, nXSize, nYSize,
+                                              pData, nBufXSize, nBufYSize,
+                                              eBufType,
+                                              nBandCount, panBandMap,
+                                              nPixelSpace, nLineSpace,
+                                              nBandSpace,
+                                              psExtraArg, eErr ) )
+        {
+            return eErr;
+        }
+
+        for( int i = 0; eErr == CE_None && i < nSourcesToRead; i++ )
         {
+            const int iSource = anSources[i];
             psExtraArg->pfnProgress = GDALScaledProgress;
             psExtraArg->pProgressData =
                 GDALCreateScaledProgress(
-                    1.0 * iSource / poBand->nSources,
-                    1.0 * (iSource + 1) / poBand->nSources,
+                    1.0 * i / nSourcesToRead,
+                    1.0 * (i + 1) / nSourcesToRead,
                     pfnProgressGlobal,
                     pProgressDataGlobal );
 
@@ -35,6 +35,7 @@
 
 #include "cpl_hash_set.h"
 #include "cpl_minixml.h"
+#include "cpl_quad_tree.h"
 #include "gdal_pam.h"
 #include "gdal_priv.h"
 #include "gdal_rat.h"
@@ -45,10 +46,13 @@
 #include <memory>
 #include <vector>
 
+class CPLWorkerThreadPool;
+
 int VRTApplyMetadata( CPLXMLNode *, GDALMajorObject * );
 CPLXMLNode *VRTSerializeMetadata( GDALMajorObject * );
 CPLErr GDALRegisterDefaultPixelFunc();
 CPLString VRTSerializeNoData(double dfVal, GDALDataType eDataType, int nPrecision);
+
 #if 0
 int VRTWarpedOverviewTransform( void *pTransformArg, int bDstToSrc,
                                 int nPointCount,
@@ -57,6 +61,37 @@ int VRTWarpedOverviewTransform( void *pTransformArg, int bDstToSrc,
 void* VRTDeserializeWarpedOverviewTransformer( CPLXMLNode *psTree );
 #endif
 
+/************************************************************************/
+/*                          VRTPixelExpression                          */
+/************************************************************************/
+
+class VRTPixelExpression
+{
+    friend class VRTPixelExpressionParser;
+
+    struct Instruction
+    {
+        int nOp;
+        int nArg;
+    };
+
+    std::vector<Instruction> m_aoCode{};
+    std::vector<double>      m_adfConstants{};
+    int                      m_nStackDepth = 0;
+    int                      m_nMaxSourceIndex = 0;
+
+    VRTPixelExpression() = default;
+
+  public:
+    static std::unique_ptr<VRTPixelExpression> Compile(
+                                                const char *pszExpression );
+
+    CPLErr Evaluate( void **papoSources, int nSources, void *pData,
+                     int nXSize, int nYSize,
+                     GDALDataType eSrcType, GDALDataType eBufType,
+                     int nPixelSpace, int nLineSpace ) const;
+};
+
 /************************************************************************/
 /*                          VRTOverviewInfo()                           */
 /************************************************************************/
@@ -193,6 +228,10 @@ class CPL_DLL VRTDataset CPL_NON_FINAL: public GDALDataset
     std::map<CPLString, GDALDataset*> m_oMapSharedSources{};
     std::shared_ptr<VRTGroup> m_poRootGroup{};
 
+    // Pool used to read sources concurrently (VRT_NUM_THREADS)
+    CPLWorkerThreadPool *m_poSourceThreadPool = nullptr;
+    bool           m_bSourceThreadPoolInitialized = false;
+
     VRTRasterBand*      InitBand(const char* pszSubclass, int nBand,
                                  bool bAllowPansharpened);
     static GDALDataset *OpenVRTProtocol( const char* pszSpec );
@@ -211,6 +250,8 @@ class CPL_DLL VRTDataset CPL_NON_FINAL: public GDALDataset
 
     void SetWritable(int bWritableIn) { m_bWritable = bWritableIn; }
 
+    CPLWorkerThreadPool* GetSourceThreadPool();
+
     virtual CPLErr          CreateMaskBand( int nFlags ) override;
     void SetMaskBand(VRTRasterBand* poMaskBand);
 
@@ -557,8 +598,16 @@ class CPL_DLL VRTSourcedRasterBand CPL_NON_FINAL: public VRTRasterBand
     CPLString      m_osLastLocationInfo{};
     char         **m_papszSourceList;
 
+    // Spatial index of the destination windows of the sources, lazily built
+    // when there are many of them. m_nSourceIndexSources is the value of
+    // nSources when it was built (-1 if not built).
+    CPLQuadTree   *m_hSourceIndex = nullptr;
+    int            m_nSourceIndexSources = -1;
+
     bool           CanUseSourcesMinMaxImplementations();
     void           CheckSource( VRTSimpleSource *poSS );
+    void           BuildSourceIndex();
+    void           InvalidateSourceIndex();
 
     CPL_DISALLOW_COPY_ASSIGN(VRTSourcedRasterBand)
 
@@ -614,6 +663,24 @@ class CPL_DLL VRTSourcedRasterBand CPL_NON_FINAL: public VRTRasterBand
                                   void *pProgressData ) override;
 
     CPLErr         AddSource( VRTSource * );
+    void           GetSourcesForWindow( int nXOff, int nYOff,
+                                        int nXSize, int nYSize,
+                                        std::vector<int>& anSources );
+    // nBandCount == 0 reads this band, otherwise the bands of panBandMap
+    // with VRTSimpleSource::DatasetRasterIO()
+    bool           ReadSourcesMultiThreaded( CPLWorkerThreadPool *poThreadPool,
+                                             const std::vector<int>& anSources,
+                                             int nXOff, int nYOff,
+                                             int nXSize, int nYSize,
+                                             void *pData,
+                                             int nBufXSize, int nBufYSize,
+                                             GDALDataType eBufType,
+                                             int nBandCount, int *panBandMap,
+                                             GSpacing nPixelSpace,
+                                             GSpacing nLineSpace,
+                                             GSpacing nBandSpace,
+                                             GDALRasterIOExtraArg* psExtraArg,
+                                             CPLErr& eErr );
     CPLErr         AddSimpleSource( GDALRasterBand *poSrcBand,
                                     double dfSrcXOff=-1, double dfSrcYOff=-1,
                                     double dfSrcXSize=-1, double dfSrcYSize=-1,
@@ -147,6 +147,7 @@ class VRTDerivedRasterBandPrivateData
         bool      m_bExclusiveLock;
         bool      m_bFirstTime;
         std::vector< std::pair<CPLString,CPLString> > m_oFunctionArgs{};
+        std::unique_ptr<VRTPixelExpression> m_poExpression{};
 
         VRTDerivedRasterBandPrivateData():
             m_osLanguage("C"),
@@ -822,8 +823,22 @@ CPLErr VRTDerivedRasterBand::IRasterIO( GDALRWFlag eRWFlag,
 
     /* ---- Get pixel function for band ---- */
     GDALDerivedPixelFunc pfnPixelFunc = nullptr;
+    const VRTPixelExpression* poExpression = nullptr;
 
-    if( EQUAL(m_poPrivate->m_osLanguage, "C") )
+    if( EQUAL(m_poPrivate->m_osLanguage, "C") &&
+        pszFuncName != nullptr && EQUAL(pszFuncName, "expression") )
+    {
+        poExpression = m_poPrivate->m_poExpression.get();
+        if( poExpression == nullptr )
+        {
+            CPLError( CE_Failure, CPLE_AppDefined,
+                      "VRTDerivedRasterBand::IRasterIO: "
+                      "'expression' pixel function requires an 'expression' "
+                      "attribute in PixelFunctionArguments" );
+            return CE_Failure;
+        }
+    }
+    else if( EQUAL(m_poPrivate->m_osLanguage, "C") )
     {
         pfnPixelFunc = VRTDerivedRasterBand::GetPixelFunction(pszFuncName);
         if( pfnPixelFunc == nullptr )
@@ -1162,6 +1177,13 @@ CPLErr VRTDerivedRasterBand::IRasterIO( GDALRWFlag eRWFlag,
             VSIFree(pabyTmpBuffer);
         }
     }
+    else if( eErr == CE_None && poExpression != nullptr ) {
+        eErr = poExpression->Evaluate( static_cast<void **>( pBuffers ),
+                                       nSources, pData, nBufXSize, nBufYSize,
+                                       eSrcType, eBufType,
+                                       static_cast<int>(nPixelSpace),
+                                       static_cast<int>(nLineSpace) );
+    }
     else if( eErr == CE_None && pfnPixelFunc != nullptr ) {
         eErr = pfnPixelFunc( static_cast<void **>( pBuffers ), nSources,
                              pData, nBufXSize, nBufYSize,
@@ -1255,13 +1277,16 @@ CPLErr VRTDerivedRasterBand::XMLInit( CPLXMLNode *psTree,
         return CE_Failure;
     }
 
+    const bool bIsExpression = EQUAL(m_poPrivate->m_osLanguage, "C") &&
+                               EQUAL(pszFuncName, "expression");
     CPLXMLNode* psArgs = CPLGetXMLNode( psTree, "PixelFunctionArguments" );
     if( psArgs != nullptr )
     {
-        if( !EQUAL(m_poPrivate->m_osLanguage, "Python") )
+        if( !EQUAL(m_poPrivate->m_osLanguage, "Python") && !bIsExpression )
         {
             CPLError(CE_Failure, CPLE_NotSupported,
-                     "PixelFunctionArguments can only be used with Python");
+                     "PixelFunctionArguments can only be used with Python "
+                     "or the 'expression' pixel function");
             return CE_Failure;
         }
         for( CPLXMLNode* psIter = psArgs->psChild;
@@ -1277,6 +1302,27 @@ CPLErr VRTDerivedRasterBand::XMLInit( CPLXMLNode *psTree,
         }
     }
 
+    // Compile the expression once for all.
+    if( bIsExpression )
+    {
+        const char* pszExpression = nullptr;
+        for( const auto& oArg: m_poPrivate->m_oFunctionArgs )
+        {
+            if( EQUAL(oArg.first, "expression") )
+                pszExpression = oArg.second.c_str();
+        }
+        if( pszExpression == nullptr )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "'expression' pixel function requires an 'expression' "
+                     "attribute in PixelFunctionArguments");
+            return CE_Failure;
+        }
+        m_poPrivate->m_poExpression = VRTPixelExpression::Compile(pszExpression);
+        if( !m_poPrivate->m_poExpression )
+            return CE_Failure;
+    }
+
     // Read optional source transfer data type.
     const char *pszTypeName = CPLGetXMLValue(psTree, "SourceTransferType", nullptr);
     if( pszTypeName != nullptr )
@@ -1541,26 +1541,44 @@ CPLErr VRTPansharpenedRasterBand::IRasterIO( GDALRWFlag eRWFlag,
         // If so use the cached result
         const size_t nBufferSizePerBand
             = static_cast<size_t>(nXSize) * nYSize * nDataTypeSize;
-        if( nXOff == poGDS->m_nLastBandRasterIOXOff &&
+        if( nXOff >= poGDS->m_nLastBandRasterIOXOff &&
             nYOff >= poGDS->m_nLastBandRasterIOYOff &&
-            nXSize == poGDS->m_nLastBandRasterIOXSize &&
+            nXOff + nXSize <= poGDS->m_nLastBandRasterIOXOff + poGDS->m_nLastBandRasterIOXSize &&
             nYOff + nYSize <= poGDS->m_nLastBandRasterIOYOff + poGDS->m_nLastBandRasterIOYSize &&
             eBufType == poGDS->m_eLastBandRasterIODataType )
         {
             //{static int bDone = 0; if (!bDone) printf("(6)\n"); bDone = 1; }
             if( poGDS->m_pabyLastBufferBandRasterIO == nullptr )
                 return CE_Failure;
-            const size_t nBufferSizePerBandCached
-                = static_cast<size_t>( nXSize ) * poGDS->m_nLastBandRasterIOYSize
+            const size_t nCachedLineSize
+                = static_cast<size_t>( poGDS->m_nLastBandRasterIOXSize )
                 * nDataTypeSize;
-            memcpy(pData,
-                   poGDS->m_pabyLastBufferBandRasterIO +
-                        nBufferSizePerBandCached * m_nIndexAsPansharpenedBand +
-                        static_cast<size_t>(nYOff - poGDS->m_nLastBandRasterIOYOff) * nXSize * nDataTypeSize,
-                   nBufferSizePerBand);
+            const size_t nBufferSizePerBandCached
+                = nCachedLineSize * poGDS->m_nLastBandRasterIOYSize;
+            const GByte* pabySrc = poGDS->m_pabyLastBufferBandRasterIO +
+                nBufferSizePerBandCached * m_nIndexAsPansharpenedBand +
+                static_cast<size_t>(nYOff - poGDS->m_nLastBandRasterIOYOff) * nCachedLineSize +
+                static_cast<size_t>(nXOff - poGDS->m_nLastBandRasterIOXOff) * nDataTypeSize;
+            if( nXSize == poGDS->m_nLastBandRasterIOXSize )
+            {
+                memcpy(pData, pabySrc, nBufferSizePerBand);
+            }
+            else
+            {
+                const size_t nLineSize
+                    = static_cast<size_t>( nXSize ) * nDataTypeSize;
+                for( int iY = 0; iY < nYSize; iY++ )
+                {
+                    memcpy(static_cast<GByte*>(pData) + iY * nLineSize,
+                           pabySrc + iY * nCachedLineSize,
+                           nLineSize);
+                }
+            }
             return CE_None;
         }
 
+        int nXOffToCache = nXOff;
+        int nXSizeToCache = nXSize;
         int nYSizeToCache = nYSize;
         if( nYSize == 1 && nXSize == nRasterXSize )
         {
@@ -1572,8 +1590,22 @@ CPLErr VRTPansharpenedRasterBand::IRasterIO( GDALRWFlag eRWFlag,
             else if( nYOff + nYSizeToCache > nRasterYSize )
                 nYSizeToCache = nRasterYSize - nYOff;
         }
+        else if( nXSize == nBlockXSize && nYSize <= nBlockYSize &&
+                 (nXOff % nBlockXSize) == 0 && (nYOff % nBlockYSize) == 0 &&
+                 nXSize < nRasterXSize &&
+                 poGDS->m_poPansharpener->GetThreadCount() > 1 &&
+                 static_cast<GUIntBig>( nRasterXSize ) * nYSize * nDataTypeSize
+                    * psOptions->nOutPansharpenedBands <= 64 * 1024 * 1024 )
+        {
+            // Block by block reading in multi-threaded mode: compute the
+            // whole row of blocks at once, so that the threads of the
+            // pansharpener work on several output blocks concurrently. The
+            // other blocks of the row are then served from the cache.
+            nXOffToCache = 0;
+            nXSizeToCache = nRasterXSize;
+        }
         const GUIntBig nBufferSize
-            = static_cast<GUIntBig>( nXSize ) * nYSizeToCache * nDataTypeSize
+            = static_cast<GUIntBig>( nXSizeToCache ) * nYSizeToCache * nDataTypeSize
             * psOptions->nOutPansharpenedBands;
         // Check the we don't overflow (for 32 bit platforms)
         if( static_cast<GUIntBig>( static_cast<size_t>( nBufferSize ) )
@@ -1590,26 +1622,41 @@ CPLErr VRTPansharpenedRasterBand::IRasterIO( GDALRWFlag eRWFlag,
         {
             return CE_Failure;
         }
-        poGDS->m_nLastBandRasterIOXOff = nXOff;
+        poGDS->m_nLastBandRasterIOXOff = nXOffToCache;
         poGDS->m_nLastBandRasterIOYOff = nYOff;
-        poGDS->m_nLastBandRasterIOXSize = nXSize;
+        poGDS->m_nLastBandRasterIOXSize = nXSizeToCache;
         poGDS->m_nLastBandRasterIOYSize = nYSizeToCache;
         poGDS->m_eLastBandRasterIODataType = eBufType;
         poGDS->m_pabyLastBufferBandRasterIO = pabyTemp;
 
         CPLErr eErr = poGDS->m_poPansharpener->ProcessRegion(
-                            nXOff, nYOff, nXSize, nYSizeToCache,
+                            nXOffToCache, nYOff, nXSizeToCache, nYSizeToCache,
                             poGDS->m_pabyLastBufferBandRasterIO, eBufType);
         if( eErr == CE_None )
         {
             //{static int bDone = 0; if (!bDone) printf("(8)\n"); bDone = 1; }
-            size_t nBufferSizePerBandCached
-                = static_cast<size_t>( nXSize ) * poGDS->m_nLastBandRasterIOYSize
-                * nDataTypeSize;
-            memcpy(pData,
-                   poGDS->m_pabyLastBufferBandRasterIO +
-                        nBufferSizePerBandCached * m_nIndexAsPansharpenedBand,
-                   nBufferSizePerBand);
+            const size_t nCachedLineSize
+                = static_cast<size_t>( nXSizeToCache ) * nDataTypeSize;
+            const size_t nBufferSizePerBandCached
+                = nCachedLineSize * poGDS->m_nLastBandRasterIOYSize;
+            const GByte* pabySrc = poGDS->m_pabyLastBufferBandRasterIO +
+                nBufferSizePerBandCached * m_nIndexAsPansharpenedBand +
+                static_cast<size_t>(nXOff - nXOffToCache) * nDataTypeSize;
+            if( nXSizeToCache == nXSize )
+            {
+                memcpy(pData, pabySrc, nBufferSizePerBand);
+            }
+            else
+            {
+                const size_t nLineSize
+                    = static_cast<size_t>( nXSize ) * nDataTypeSize;
+                for( int iY = 0; iY < nYSize; iY++ )
+                {
+                    memcpy(static_cast<GByte*>(pData) + iY * nLineSize,
+                           pabySrc + iY * nCachedLineSize,
+                           nLineSize);
+                }
+            }
         }
         else
         {
@@ -38,20 +38,27 @@
 #include <cstdlib>
 #include <cstring>
 #include <string>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
 #include "cpl_hash_set.h"
 #include "cpl_minixml.h"
 #include "cpl_progress.h"
+#include "cpl_quad_tree.h"
 #include "cpl_string.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal.h"
 #include "gdal_priv.h"
 #include "ogr_geometry.h"
 
 CPL_CVSID("$Id: vrtsourcedrasterband.cpp 414463132a6fa8d2258b4b38a6dcea78da8d3e70 2020-04-02 13:20:58 +0200 Even Rouault $")
 
+// Minimum number of sources for which a spatial index of their
+// destination windows is built.
+constexpr int VRT_MIN_SOURCES_FOR_INDEX = 64;
+
 /*! @cond Doxygen_Suppress */
 
 /************************************************************************/
@@ -125,6 +132,7 @@ VRTSourcedRasterBand::~VRTSourcedRasterBand()
 {
     VRTSourcedRasterBand::CloseDependentDatasets();
     CSLDestroy(m_papszSourceList);
+    InvalidateSourceIndex();
 }
 
 /************************************************************************/
@@ -184,7 +192,9 @@ CPLErr VRTSourcedRasterBand::IRasterIO( GDALRWFlag eRWFlag,
         psExtraArg->eResampleAlg != GRIORA_NearestNeighbour &&
         m_bNoDataValueSet )
     {
-        for( int i = 0; i < nSources; i++ )
+        std::vector<int> anSources;
+        GetSourcesForWindow( nXOff, nYOff, nXSize, nYSize, anSources );
+        for( const int i : anSources )
         {
             bool bFallbackToBase = false;
             if( !papoSources[i]->IsSimpleSource() )
@@ -287,13 +297,34 @@ CPLErr VRTSourcedRasterBand::IRasterIO( GDALRWFlag eRWFlag,
 /* -------------------------------------------------------------------- */
 /*      Overlay each source in turn over top this.                      */
 /* -------------------------------------------------------------------- */
+    std::vector<int> anSources;
+    GetSourcesForWindow( nXOff, nYOff, nXSize, nYSize, anSources );
+    const int nSourcesToRead = static_cast<int>( anSources.size() );
+
     CPLErr eErr = CE_None;
-    for( int iSource = 0; eErr == CE_None && iSource < nSources; iSource++ )
+    VRTDataset* poVRTDS = dynamic_cast<VRTDataset*>( poDS );
+    CPLWorkerThreadPool* poThreadPool =
+        ( eRWFlag == GF_Read && nSourcesToRead > 1 && poVRTDS != nullptr ) ?
+            poVRTDS->GetSourceThreadPool() : nullptr;
+    if( poThreadPool != nullptr &&
+        ReadSourcesMultiThreaded( poThreadPool, anSources,
+                                  nXOff, nYOff, nXSize, nYSize,
+                                  pData, nBufXSize, nBufYSize,
+                                  eBufType, 0, nullptr,
+                                  nPixelSpace, nLineSpace, 0,
+                                  psExtraArg, eErr ) )
+    {
+        m_nRecursionCounter--;
+        return eErr;
+    }
+
+    for( int i = 0; eErr == CE_None && i < nSourcesToRead; i++ )
     {
+        const int iSource = anSources[i];
         psExtraArg->pfnProgress = GDALScaledProgress;
         psExtraArg->pProgressData =
-            GDALCreateScaledProgress( 1.0 * iSource / nSources,
-                                      1.0 * (iSource + 1) / nSources,
+            GDALCreateScaledProgress( 1.0 * i / nSourcesToRead,
+                                      1.0 * (i + 1) / nSourcesToRead,
                                       pfnProgressGlobal,
                                       pProgressDataGlobal );
         if( psExtraArg->pProgressData == nullptr )
@@ -317,6 +348,265 @@ CPLErr VRTSourcedRasterBand::IRasterIO( GDALRWFlag eRWFlag,
     return eErr;
 }
 
+/************************************************************************/
+/*                         VRTSourceReadJob                             */
+/************************************************************************/
+
+namespace {
+// An error raised by a worker thread, emitted again by the calling thread.
+struct VRTSourceReadError
+{
+    CPLErr        eErr = CE_None;
+    CPLErrorNum   nNum = CPLE_None;
+    CPLString     osMsg{};
+};
+
+struct VRTSourceReadJob
+{
+    VRTSource    *poSource = nullptr;
+    GDALDataType  eBandDataType = GDT_Unknown;
+    int           nXOff = 0;
+    int           nYOff = 0;
+    int           nXSize = 0;
+    int           nYSize = 0;
+    void         *pData = nullptr;
+    int           nBufXSize = 0;
+    int           nBufYSize = 0;
+    GDALDataType  eBufType = GDT_Unknown;
+    GSpacing      nPixelSpace = 0;
+    GSpacing      nLineSpace = 0;
+    int           nBandCount = 0;
+    int          *panBandMap = nullptr;
+    GSpacing      nBandSpace = 0;
+    GDALRasterIOExtraArg sExtraArg{};
+    CPLErr        eErr = CE_None;
+    std::vector<VRTSourceReadError> aoErrors{};
+};
+
+// Window of the output buffer written by a source, and key of the
+// dataset it reads from.
+struct VRTSourceWriteWindow
+{
+    int           iSource = 0;
+    int           nOutXOff = 0;
+    int           nOutYOff = 0;
+    int           nOutXSize = 0;
+    int           nOutYSize = 0;
+    CPLString     osDatasetKey{};
+};
+} // namespace
+
+static void CPL_STDCALL VRTSourceReadJobErrorHandler( CPLErr eErr,
+                                                      CPLErrorNum nNum,
+                                                      const char *pszMsg )
+{
+    VRTSourceReadJob* psJob =
+        static_cast<VRTSourceReadJob*>( CPLGetErrorHandlerUserData() );
+    VRTSourceReadError oError;
+    oError.eErr = eErr;
+    oError.nNum = nNum;
+    oError.osMsg = pszMsg;
+    psJob->aoErrors.push_back( oError );
+}
+
+static void VRTSourceReadJobFunc( void* pData )
+{
+    VRTSourceReadJob* psJob = static_cast<VRTSourceReadJob*>( pData );
+    CPLPushErrorHandlerEx( VRTSourceReadJobErrorHandler, psJob );
+    if( psJob->nBandCount > 0 )
+    {
+        psJob->eErr = static_cast<VRTSimpleSource*>( psJob->poSource )->
+            DatasetRasterIO( psJob->eBandDataType,
+                             psJob->nXOff, psJob->nYOff,
+                             psJob->nXSize, psJob->nYSize,
+                             psJob->pData,
+                             psJob->nBufXSize, psJob->nBufYSize,
+                             psJob->eBufType,
+                             psJob->nBandCount, psJob->panBandMap,
+                             psJob->nPixelSpace, psJob->nLineSpace,
+                             psJob->nBandSpace,
+                             &psJob->sExtraArg );
+    }
+    else
+    {
+        psJob->eErr = psJob->poSource->RasterIO( psJob->eBandDataType,
+                                                 psJob->nXOff, psJob->nYOff,
+                                                 psJob->nXSize, psJob->nYSize,
+                                                 psJob->pData,
+                                                 psJob->nBufXSize,
+                                                 psJob->nBufYSize,
+                                                 psJob->eBufType,
+                                                 psJob->nPixelSpace,
+                                                 psJob->nLineSpace,
+                                                 &psJob->sExtraArg );
+    }
+    CPLPopErrorHandler();
+}
+
+/************************************************************************/
+/*                       ReadSourcesMultiThreaded()                     */
+/************************************************************************/
+
+// Reads the sources with the worker threads of poThreadPool.
+// Consecutive sources that write to disjoint regions of the output buffer,
+// and read from different datasets, are read concurrently. Sources that
+// overlap a source of the current batch start a new batch, so that the
+// result is the same as when compositing them sequentially.
+// The errors raised by the workers are emitted again by the calling thread,
+// in the order of the sources.
+// Returns false if the sources must be read sequentially.
+bool VRTSourcedRasterBand::ReadSourcesMultiThreaded(
+    CPLWorkerThreadPool *poThreadPool,
+    const std::vector<int>& anSources,
+    int nXOff, int nYOff, int nXSize, int nYSize,
+    void *pData, int nBufXSize, int nBufYSize,
+    GDALDataType eBufType,
+    int nBandCount, int *panBandMap,
+    GSpacing nPixelSpace, GSpacing nLineSpace, GSpacing nBandSpace,
+    GDALRasterIOExtraArg* psExtraArg,
+    CPLErr& eErr )
+{
+    std::vector<VRTSourceWriteWindow> asWindows;
+    asWindows.reserve( anSources.size() );
+    for( const int iSource : anSources )
+    {
+        if( !papoSources[iSource]->IsSimpleSource() )
+            return false;
+        VRTSimpleSource* const poSS =
+            static_cast<VRTSimpleSource *>( papoSources[iSource] );
+        GDALRasterBand* poSrcBand = poSS->m_poMaskBandMainBand ?
+            poSS->m_poMaskBandMainBand : poSS->m_poRasterBand;
+        if( poSrcBand == nullptr || poSrcBand->GetDataset() == nullptr )
+            return false;
+
+        double dfReqXOff = 0.0;
+        double dfReqYOff = 0.0;
+        double dfReqXSize = 0.0;
+        double dfReqYSize = 0.0;
+        int nReqXOff = 0;
+        int nReqYOff = 0;
+        int nReqXSize = 0;
+        int nReqYSize = 0;
+        VRTSourceWriteWindow sWindow;
+        if( !poSS->GetSrcDstWindow( nXOff, nYOff, nXSize, nYSize,
+                                    nBufXSize, nBufYSize,
+                                    &dfReqXOff, &dfReqYOff,
+                                    &dfReqXSize, &dfReqYSize,
+                                    &nReqXOff, &nReqYOff,
+                                    &nReqXSize, &nReqYSize,
+                                    &sWindow.nOutXOff, &sWindow.nOutYOff,
+                                    &sWindow.nOutXSize, &sWindow.nOutYSize ) )
+        {
+            // Nothing to read from this source.
+            continue;
+        }
+        sWindow.iSource = iSource;
+        // Sources referencing the same file share the same underlying
+        // dataset (or GDALProxyPoolDataset), which must not be accessed
+        // from several threads at once.
+        GDALDataset* poSrcDS = poSrcBand->GetDataset();
+        sWindow.osDatasetKey = poSrcDS->GetDescription();
+        if( sWindow.osDatasetKey.empty() )
+            sWindow.osDatasetKey.Printf("%p", poSrcDS);
+        asWindows.push_back( sWindow );
+    }
+
+    const auto Intersects = [](const VRTSourceWriteWindow& a,
+                               const VRTSourceWriteWindow& b)
+    {
+        return a.nOutXOff < b.nOutXOff + b.nOutXSize &&
+               b.nOutXOff < a.nOutXOff + a.nOutXSize &&
+               a.nOutYOff < b.nOutYOff + b.nOutYSize &&
+               b.nOutYOff < a.nOutYOff + a.nOutYSize;
+    };
+
+    const size_t nMaxBatchSize =
+        static_cast<size_t>( 4 * poThreadPool->GetThreadCount() );
+    const size_t nWindows = asWindows.size();
+    std::vector<VRTSourceReadJob> asJobs;
+    eErr = CE_None;
+    size_t iStart = 0;
+    while( eErr == CE_None && iStart < nWindows )
+    {
+        size_t iEnd = iStart + 1;
+        for( ; iEnd < nWindows && iEnd - iStart < nMaxBatchSize; ++iEnd )
+        {
+            bool bCompatible = true;
+            for( size_t j = iStart; bCompatible && j < iEnd; ++j )
+            {
+                bCompatible =
+                    !Intersects( asWindows[iEnd], asWindows[j] ) &&
+                    asWindows[iEnd].osDatasetKey != asWindows[j].osDatasetKey;
+            }
+            if( !bCompatible )
+                break;
+        }
+
+        asJobs.clear();
+        asJobs.resize( iEnd - iStart );
+        for( size_t i = iStart; i < iEnd; ++i )
+        {
+            VRTSourceReadJob& sJob = asJobs[i - iStart];
+            sJob.poSource = papoSources[asWindows[i].iSource];
+            sJob.eBandDataType = eDataType;
+            sJob.nXOff = nXOff;
+            sJob.nYOff = nYOff;
+            sJob.nXSize = nXSize;
+            sJob.nYSize = nYSize;
+            sJob.pData = pData;
+            sJob.nBufXSize = nBufXSize;
+            sJob.nBufYSize = nBufYSize;
+            sJob.eBufType = eBufType;
+            sJob.nPixelSpace = nPixelSpace;
+            sJob.nLineSpace = nLineSpace;
+            sJob.nBandCount = nBandCount;
+            sJob.panBandMap = panBandMap;
+            sJob.nBandSpace = nBandSpace;
+            sJob.sExtraArg = *psExtraArg;
+            // Progress is reported by this thread.
+            sJob.sExtraArg.pfnProgress = nullptr;
+            sJob.sExtraArg.pProgressData = nullptr;
+        }
+
+        if( asJobs.size() == 1 )
+        {
+            VRTSourceReadJobFunc( &asJobs[0] );
+        }
+        else
+        {
+            for( auto& sJob : asJobs )
+            {
+                if( !poThreadPool->SubmitJob( VRTSourceReadJobFunc, &sJob ) )
+                    VRTSourceReadJobFunc( &sJob );
+            }
+            poThreadPool->WaitCompletion();
+        }
+
+        for( const auto& sJob : asJobs )
+        {
+            for( const auto& oError : sJob.aoErrors )
+                CPLError( oError.eErr, oError.nNum, "%s",
+                          oError.osMsg.c_str() );
+            if( sJob.eErr != CE_None )
+            {
+                eErr = sJob.eErr;
+                break;
+            }
+        }
+
+        iStart = iEnd;
+        if( eErr == CE_None && psExtraArg->pfnProgress != nullptr &&
+            !psExtraArg->pfnProgress( 1.0 * iStart / nWindows, "",
+                                      psExtraArg->pProgressData ) )
+        {
+            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+            eErr = CE_Failure;
+        }
+    }
+
+    return true;
+}
+
 /************************************************************************/
 /*                         IGetDataCoverageStatus()                     */
 /************************************************************************/
@@ -355,7 +645,9 @@ int  VRTSourcedRasterBand::IGetDataCoverageStatus( int nXOff,
     poLR->addPoint( nXOff, nYOff );
     poPolyNonCoveredBySources->addRingDirectly(poLR);
 
-    for( int iSource = 0; iSource < nSources; iSource++ )
+    std::vector<int> anSources;
+    GetSourcesForWindow( nXOff, nYOff, nXSize, nYSize, anSources );
+    for( const int iSource : anSources )
     {
         if( !papoSources[iSource]->IsSimpleSource() )
         {
@@ -935,9 +1227,131 @@ CPLErr VRTSourcedRasterBand::AddSource( VRTSource *poNewSource )
         CheckSource( poSS );
     }
 
+    InvalidateSourceIndex();
+
     return CE_None;
 }
 
+/************************************************************************/
+/*                        InvalidateSourceIndex()                       */
+/************************************************************************/
+
+void VRTSourcedRasterBand::InvalidateSourceIndex()
+{
+    if( m_hSourceIndex )
+        CPLQuadTreeDestroy( m_hSourceIndex );
+    m_hSourceIndex = nullptr;
+    m_nSourceIndexSources = -1;
+}
+
+/************************************************************************/
+/*                          BuildSourceIndex()                          */
+/************************************************************************/
+
+void VRTSourcedRasterBand::BuildSourceIndex()
+{
+    InvalidateSourceIndex();
+    m_nSourceIndexSources = nSources;
+
+    // Only the destination window of simple sources is known.
+    for( int iSource = 0; iSource < nSources; iSource++ )
+    {
+        if( !papoSources[iSource]->IsSimpleSource() )
+            return;
+    }
+
+    CPLRectObj sGlobalBounds;
+    sGlobalBounds.minx = 0;
+    sGlobalBounds.miny = 0;
+    sGlobalBounds.maxx = nRasterXSize;
+    sGlobalBounds.maxy = nRasterYSize;
+    m_hSourceIndex = CPLQuadTreeCreate( &sGlobalBounds, nullptr );
+    CPLQuadTreeSetMaxDepth( m_hSourceIndex,
+                            CPLQuadTreeGetAdvisedMaxDepth( nSources ) );
+
+    for( int iSource = 0; iSource < nSources; iSource++ )
+    {
+        const VRTSimpleSource* poSS =
+            static_cast<const VRTSimpleSource *>( papoSources[iSource] );
+        // Those sources are never read (see GetSrcDstWindow())
+        if( poSS->m_dfSrcXSize == 0.0 || poSS->m_dfSrcYSize == 0.0 ||
+            poSS->m_dfDstXSize == 0.0 || poSS->m_dfDstYSize == 0.0 )
+            continue;
+
+        CPLRectObj sBounds = sGlobalBounds;
+        const bool bDstWinSet =
+            poSS->m_dfDstXOff != -1 || poSS->m_dfDstXSize != -1 ||
+            poSS->m_dfDstYOff != -1 || poSS->m_dfDstYSize != -1;
+        if( bDstWinSet )
+        {
+            // The intersection test of GetSrcDstWindow() considers windows
+            // that just touch the source as intersecting it, which matches
+            // the closed rectangles of the quad tree.
+            sBounds.minx = std::max( sGlobalBounds.minx, poSS->m_dfDstXOff );
+            sBounds.miny = std::max( sGlobalBounds.miny, poSS->m_dfDstYOff );
+            sBounds.maxx = std::min( sGlobalBounds.maxx,
+                                 poSS->m_dfDstXOff + poSS->m_dfDstXSize );
+            sBounds.maxy = std::min( sGlobalBounds.maxy,
+                                 poSS->m_dfDstYOff + poSS->m_dfDstYSize );
+            // Completely outside of the raster.
+            if( !(sBounds.minx <= sBounds.maxx && sBounds.miny <= sBounds.maxy) )
+                continue;
+        }
+        CPLQuadTreeInsertWithBounds( m_hSourceIndex,
+                                     reinterpret_cast<void*>(
+                                         static_cast<size_t>(iSource) ),
+                                     &sBounds );
+    }
+}
+
+/************************************************************************/
+/*                         GetSourcesForWindow()                        */
+/************************************************************************/
+
+/**
+ * Returns the indices, in increasing order, of the sources that may
+ * contribute to a window of the band.
+ *
+ * With many sources, this uses a spatial index of their destination
+ * windows, built at the first call. Otherwise all the sources are returned.
+ */
+void VRTSourcedRasterBand::GetSourcesForWindow( int nXOff, int nYOff,
+                                                int nXSize, int nYSize,
+                                                std::vector<int>& anSources )
+{
+    anSources.clear();
+    if( nSources >= VRT_MIN_SOURCES_FOR_INDEX )
+    {
+        if( m_nSourceIndexSources != nSources )
+            BuildSourceIndex();
+        if( m_hSourceIndex )
+        {
+            CPLRectObj sAoi;
+            sAoi.minx = nXOff;
+            sAoi.miny = nYOff;
+            sAoi.maxx = static_cast<double>(nXOff) + nXSize;
+            sAoi.maxy = static_cast<double>(nYOff) + nYSize;
+            int nFeatureCount = 0;
+            void** pahFeatures =
+                CPLQuadTreeSearch( m_hSourceIndex, &sAoi, &nFeatureCount );
+            anSources.reserve( nFeatureCount );
+            for( int i = 0; i < nFeatureCount; i++ )
+            {
+                anSources.push_back( static_cast<int>(
+                    reinterpret_cast<size_t>( pahFeatures[i] ) ) );
+            }
+            CPLFree( pahFeatures );
+            // Sources must be composited in their order of declaration.
+            std::sort( anSources.begin(), anSources.end() );
+            return;
+        }
+    }
+
+    anSources.resize( nSources );
+    for( int iSource = 0; iSource < nSources; iSource++ )
+        anSources[iSource] = iSource;
+}
+
 /*! @endcond */
 
 /************************************************************************/
@@ -1621,6 +2035,7 @@ CPLErr VRTSourcedRasterBand::SetMetadataItem( const char *pszName,
         {
             delete papoSources[iSource];
             papoSources[iSource] = poSource;
+            InvalidateSourceIndex();
             static_cast<VRTDataset *>( poDS )->SetNeedsFlush();
             return CE_None;
         }
@@ -1652,6 +2067,7 @@ CPLErr VRTSourcedRasterBand::SetMetadata( char **papszNewMD, const char *pszDoma
             CPLFree( papoSources );
             papoSources = nullptr;
             nSources = 0;
+            InvalidateSourceIndex();
         }
 
         for( int i = 0; i < CSLCount(papszNewMD); i++ )
@@ -1715,6 +2131,7 @@ int VRTSourcedRasterBand::CloseDependentDatasets()
     CPLFree( papoSources );
     papoSources = nullptr;
     nSources = 0;
+    InvalidateSourceIndex();
 
     return TRUE;
 }
@@ -309,6 +309,27 @@ CPLErr WEBPDataset::Uncompress()
     VSIFReadL(pabyCompressed, 1, nSize, fpImage);
     uint8_t* pRet;
 
+#if WEBP_DECODER_ABI_VERSION >= 0x0002
+    // Use the advanced API so that libwebp can run the in-loop filtering
+    // in a separate thread.
+    WebPDecoderConfig sConfig;
+    if( WebPInitDecoderConfig(&sConfig) )
+    {
+        const int nThreads = CPLGetNumThreadsOption(nullptr, "1");
+        sConfig.options.use_threads = nThreads > 1 ? 1 : 0;
+        sConfig.output.colorspace = nBands == 4 ? MODE_RGBA : MODE_RGB;
+        sConfig.output.is_external_memory = 1;
+        sConfig.output.u.RGBA.rgba = pabyUncompressed;
+        sConfig.output.u.RGBA.stride = nRasterXSize * nBands;
+        sConfig.output.u.RGBA.size =
+            static_cast<size_t>(nRasterXSize) * nRasterYSize * nBands;
+        const VP8StatusCode eStatus =
+            WebPDecode(pabyCompressed, nSize, &sConfig);
+        WebPFreeDecBuffer(&sConfig.output);
+        pRet = eStatus == VP8_STATUS_OK ? pabyUncompressed : nullptr;
+    }
+    else
+#endif
     if (nBands == 4)
         pRet = WebPDecodeRGBAInto(
             pabyCompressed,
@@ -859,6 +880,23 @@ WEBPDataset::CreateCopy( const char * pszFilename, GDALDataset *poSrcDS,
     return nullptr;
 }
 
+/************************************************************************/
+/*                   GDALGetDeclaredMetadata_WEBP()                   */
+/************************************************************************/
+
+// Items that GDALAllRegister() declares for the driver before registering it.
+CSLConstList GDALGetDeclaredMetadata_WEBP()
+{
+    static const char* const apszMD[] = {
+        GDAL_DCAP_OPEN "=YES",
+        GDAL_DCAP_RASTER "=YES",
+        GDAL_DMD_LONGNAME "=WEBP",
+        GDAL_DMD_EXTENSION "=webp",
+        GDAL_DMD_OPEN_SIGNATURES "=8:57454250",
+        nullptr };
+    return apszMD;
+}
+
 /************************************************************************/
 /*                         GDALRegister_WEBP()                          */
 /************************************************************************/
@@ -872,10 +910,9 @@ void GDALRegister_WEBP()
     GDALDriver *poDriver = new GDALDriver();
 
     poDriver->SetDescription( "WEBP" );
-    poDriver->SetMetadataItem( GDAL_DCAP_RASTER, "YES" );
-    poDriver->SetMetadataItem( GDAL_DMD_LONGNAME, "WEBP" );
+    poDriver->SetMetadata(
+        const_cast<char**>(GDALGetDeclaredMetadata_WEBP()) );
     poDriver->SetMetadataItem( GDAL_DMD_HELPTOPIC, "drivers/raster/webp.html" );
-    poDriver->SetMetadataItem( GDAL_DMD_EXTENSION, "webp" );
     poDriver->SetMetadataItem( GDAL_DMD_MIMETYPE, "image/webp" );
     poDriver->SetMetadataItem( GDAL_DMD_CREATIONDATATYPES, "Byte" );
 
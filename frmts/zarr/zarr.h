@@ -0,0 +1,391 @@
+/******************************************************************************
+ *
+ * Project:  GDAL
+ * Purpose:  Zarr driver
+ *
+ ******************************************************************************
+ * Copyright (c) 2020, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef ZARR_H
+#define ZARR_H
+
+#include "cpl_json.h"
+#include "cpl_worker_thread_pool.h"
+#include "gdal_priv.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+bool ZarrWriteJSONFile(const std::string& osFilename,
+                       const CPLJSONObject& oObj);
+
+/************************************************************************/
+/*                            ZarrDataset                               */
+/************************************************************************/
+
+class ZarrDataset final: public GDALDataset
+{
+    std::shared_ptr<GDALGroup> m_poRootGroup;
+    CPLStringList              m_aosSubdatasets{};
+
+public:
+    explicit ZarrDataset(const std::shared_ptr<GDALGroup>& poRootGroup);
+
+    static int Identify( GDALOpenInfo* poOpenInfo );
+    static GDALDataset* Open( GDALOpenInfo* poOpenInfo );
+    static GDALDataset* CreateMultiDimensional( const char * pszFilename,
+                                                CSLConstList papszRootGroupOptions,
+                                                CSLConstList papszOptions );
+
+    char** GetMetadata( const char* pszDomain ) override;
+
+    std::shared_ptr<GDALGroup> GetRootGroup() const override { return m_poRootGroup; }
+};
+
+/************************************************************************/
+/*                          ZarrSharedResource                          */
+/************************************************************************/
+
+// State shared by all the groups and arrays of a dataset
+class ZarrSharedResource
+{
+    int         m_nThreads = 1;
+    std::mutex  m_oMutex{};
+    std::unique_ptr<CPLWorkerThreadPool> m_poThreadPool{};
+
+public:
+    explicit ZarrSharedResource(int nThreads): m_nThreads(nThreads) {}
+
+    int GetNumThreads() const { return m_nThreads; }
+
+    CPLWorkerThreadPool* GetThreadPool();
+};
+
+/************************************************************************/
+/*                            ZarrAttribute                             */
+/************************************************************************/
+
+// Attribute stored in a .zattrs file. Only scalar and 1D string or numeric
+// values are handled; other JSON values are exposed as their JSON
+// serialization.
+class ZarrAttribute final: public GDALAttribute
+{
+    std::vector<std::shared_ptr<GDALDimension>> m_dims{};
+    GDALExtendedDataType m_dt;
+    std::vector<std::string> m_aosValues{};   // for strings
+    std::vector<double>      m_adfValues{};   // for numbers
+    CPLJSONObject            m_oJSONValue{};  // other values, if unmodified
+    bool                     m_bIsJSONValue = false;
+    std::shared_ptr<bool>    m_pbModified;
+
+protected:
+    ZarrAttribute(const std::string& osParentName,
+                  const std::string& osName,
+                  GUInt64 nDimSize,
+                  const GDALExtendedDataType& oDataType,
+                  const std::shared_ptr<bool>& pbModified);
+
+    bool IRead(const GUInt64* arrayStartIdx,
+               const size_t* count,
+               const GInt64* arrayStep,
+               const GPtrDiff_t* bufferStride,
+               const GDALExtendedDataType& bufferDataType,
+               void* pDstBuffer) const override;
+
+    bool IWrite(const GUInt64* arrayStartIdx,
+                const size_t* count,
+                const GInt64* arrayStep,
+                const GPtrDiff_t* bufferStride,
+                const GDALExtendedDataType& bufferDataType,
+                const void* pSrcBuffer) override;
+
+public:
+    static std::shared_ptr<ZarrAttribute> Create(
+                  const std::string& osParentName,
+                  const std::string& osName,
+                  GUInt64 nDimSize,
+                  const GDALExtendedDataType& oDataType,
+                  const std::shared_ptr<bool>& pbModified);
+
+    static std::shared_ptr<ZarrAttribute> CreateFromJSON(
+                  const std::string& osParentName,
+                  const std::string& osName,
+                  const CPLJSONObject& oValue,
+                  const std::shared_ptr<bool>& pbModified);
+
+    const std::vector<std::shared_ptr<GDALDimension>>& GetDimensions() const override { return m_dims; }
+
+    const GDALExtendedDataType& GetDataType() const override { return m_dt; }
+
+    void AddToJSON(CPLJSONObject& oParent) const;
+};
+
+/************************************************************************/
+/*                          ZarrAttributeGroup                          */
+/************************************************************************/
+
+// Set of attributes of a group or an array, loaded from and saved to a
+// .zattrs file.
+class ZarrAttributeGroup
+{
+    std::string m_osParentName;
+    std::vector<std::shared_ptr<ZarrAttribute>> m_apoAttributes{};
+    std::shared_ptr<bool> m_pbModified = std::make_shared<bool>(false);
+
+public:
+    explicit ZarrAttributeGroup(const std::string& osParentName):
+        m_osParentName(osParentName) {}
+
+    void Init(const CPLJSONObject& oAttributes,
+              const std::vector<std::string>& aosHiddenNames);
+
+    std::shared_ptr<GDALAttribute> GetAttribute(const std::string& osName) const;
+
+    std::vector<std::shared_ptr<GDALAttribute>> GetAttributes() const;
+
+    std::shared_ptr<GDALAttribute> CreateAttribute(
+        const std::string& osName,
+        const std::vector<GUInt64>& anDimensions,
+        const GDALExtendedDataType& oDataType);
+
+    bool IsModified() const { return *m_pbModified; }
+
+    void SetModified(bool bModified) { *m_pbModified = bModified; }
+
+    CPLJSONObject Serialize() const;
+};
+
+/************************************************************************/
+/*                              ZarrGroup                               */
+/************************************************************************/
+
+class ZarrArray;
+
+class ZarrGroup final: public GDALGroup
+{
+    std::shared_ptr<ZarrSharedResource> m_poShared;
+    std::string m_osDirectoryName;
+    bool        m_bUpdatable;
+    std::weak_ptr<ZarrGroup> m_pSelf{};
+    mutable bool m_bDirectoryExplored = false;
+    mutable std::vector<std::string> m_aosGroups{};
+    mutable std::vector<std::string> m_aosArrays{};
+    mutable std::map<CPLString, std::shared_ptr<ZarrGroup>> m_oMapGroups{};
+    mutable std::map<CPLString, std::shared_ptr<ZarrArray>> m_oMapMDArrays{};
+    mutable std::map<CPLString, std::shared_ptr<GDALDimension>> m_oMapDimensions{};
+    mutable bool m_bAttributesLoaded = false;
+    mutable ZarrAttributeGroup m_oAttrGroup;
+    mutable bool m_bIsArrayDirectory = false;  // root directory is an array
+
+    ZarrGroup(const std::shared_ptr<ZarrSharedResource>& poShared,
+              const std::string& osParentName,
+              const std::string& osName,
+              const std::string& osDirectoryName,
+              bool bUpdatable);
+
+    void ExploreDirectory() const;
+    void LoadAttributes() const;
+
+public:
+    static std::shared_ptr<ZarrGroup> Create(
+              const std::shared_ptr<ZarrSharedResource>& poShared,
+              const std::string& osParentName,
+              const std::string& osName,
+              const std::string& osDirectoryName,
+              bool bUpdatable);
+
+    ~ZarrGroup();
+
+    const std::string& GetDirectoryName() const { return m_osDirectoryName; }
+
+    std::shared_ptr<GDALDimension> GetOrCreateDimension(const std::string& osName,
+                                                        GUInt64 nSize) const;
+
+    std::vector<std::string> GetMDArrayNames(CSLConstList papszOptions = nullptr) const override;
+    std::shared_ptr<GDALMDArray> OpenMDArray(const std::string& osName,
+                                             CSLConstList papszOptions = nullptr) const override;
+
+    std::vector<std::string> GetGroupNames(CSLConstList papszOptions = nullptr) const override;
+    std::shared_ptr<GDALGroup> OpenGroup(const std::string& osName,
+                                         CSLConstList papszOptions = nullptr) const override;
+
+    std::vector<std::shared_ptr<GDALDimension>> GetDimensions(CSLConstList papszOptions = nullptr) const override;
+
+    std::shared_ptr<GDALAttribute> GetAttribute(const std::string& osName) const override;
+
+    std::vector<std::shared_ptr<GDALAttribute>> GetAttributes(CSLConstList papszOptions = nullptr) const override;
+
+    std::shared_ptr<GDALGroup> CreateGroup(const std::string& osName,
+                                           CSLConstList papszOptions = nullptr) override;
+
+    std::shared_ptr<GDALDimension> CreateDimension(const std::string& osName,
+                                                   const std::string& osType,
+                                                   const std::string& osDirection,
+                                                   GUInt64 nSize,
+                                                   CSLConstList papszOptions = nullptr) override;
+
+    std::shared_ptr<GDALMDArray> CreateMDArray(const std::string& osName,
+                                               const std::vector<std::shared_ptr<GDALDimension>>& aoDimensions,
+                                               const GDALExtendedDataType& oDataType,
+                                               CSLConstList papszOptions = nullptr) override;
+
+    std::shared_ptr<GDALAttribute> CreateAttribute(
+        const std::string& osName,
+        const std::vector<GUInt64>& anDimensions,
+        const GDALExtendedDataType& oDataType,
+        CSLConstList papszOptions = nullptr) override;
+};
+
+/************************************************************************/
+/*                              ZarrArray                               */
+/************************************************************************/
+
+class ZarrArray final: public GDALMDArray
+{
+    struct ChunkRange
+    {
+        GUInt64 nChunkIdx;  // index of the chunk along the dimension
+        size_t  nFirst;     // index of the first element in the request
+        size_t  nCount;     // number of elements of the request in the chunk
+    };
+
+    std::shared_ptr<ZarrSharedResource> m_poShared;
+    std::string          m_osDirectoryName;
+    bool                 m_bUpdatable;
+    std::vector<std::shared_ptr<GDALDimension>> m_aoDims;
+    GDALExtendedDataType m_oType;
+    std::vector<GUInt64> m_anBlockSize;
+    std::string          m_osDtype{};
+    bool                 m_bNeedByteSwap = false;
+    bool                 m_bFortranOrder = false;
+    std::string          m_osDimSeparator = ".";
+    std::string          m_osCompressorId{};
+    int                  m_nCompressionLevel = -1;
+    std::vector<GByte>   m_abyNoData{};
+    mutable ZarrAttributeGroup m_oAttrGroup;
+    bool                 m_bDefinitionModified = false;
+
+    ZarrArray(const std::shared_ptr<ZarrSharedResource>& poShared,
+              const std::string& osParentName,
+              const std::string& osName,
+              const std::string& osDirectoryName,
+              bool bUpdatable,
+              const std::vector<std::shared_ptr<GDALDimension>>& aoDims,
+              const GDALExtendedDataType& oType,
+              const std::vector<GUInt64>& anBlockSize);
+
+    std::string GetChunkFilename(const std::vector<GUInt64>& anChunkIdx) const;
+    size_t GetChunkByteSize() const;
+    std::vector<GPtrDiff_t> GetChunkStrides() const;
+
+    bool ReadChunk(const std::vector<GUInt64>& anChunkIdx,
+                   std::vector<GByte>& abyChunk,
+                   bool& bMissing) const;
+    bool WriteChunk(const std::vector<GUInt64>& anChunkIdx,
+                    std::vector<GByte>& abyChunk) const;
+    void FillWithNoData(std::vector<GByte>& abyChunk) const;
+
+    struct ProcessContext;
+
+    struct ChunkJob
+    {
+        const ZarrArray*        poArray = nullptr;
+        ProcessContext*         psCtx = nullptr;
+        std::vector<ChunkRange> aoRanges{};
+    };
+
+    bool ProcessChunk(const ProcessContext& sCtx,
+                      const std::vector<ChunkRange>& aoRanges) const;
+    static void ChunkJobFunc(void* pData);
+
+    bool ProcessChunks(bool bIsWrite,
+                       const GUInt64* arrayStartIdx,
+                       const size_t* count,
+                       const GInt64* arrayStep,
+                       const GPtrDiff_t* bufferStride,
+                       const GDALExtendedDataType& bufferDataType,
+                       GByte* pabyBuffer) const;
+
+    bool SerializeDefinition() const;
+
+protected:
+    bool IRead(const GUInt64* arrayStartIdx,
+               const size_t* count,
+               const GInt64* arrayStep,
+               const GPtrDiff_t* bufferStride,
+               const GDALExtendedDataType& bufferDataType,
+               void* pDstBuffer) const override;
+
+    bool IWrite(const GUInt64* arrayStartIdx,
+                const size_t* count,
+                const GInt64* arrayStep,
+                const GPtrDiff_t* bufferStride,
+                const GDALExtendedDataType& bufferDataType,
+                const void* pSrcBuffer) override;
+
+public:
+    static std::shared_ptr<ZarrArray> Open(
+              const std::shared_ptr<ZarrSharedResource>& poShared,
+              const ZarrGroup* poGroup,
+              const std::string& osName,
+              const std::string& osDirectoryName,
+              bool bUpdatable);
+
+    static std::shared_ptr<ZarrArray> CreateNew(
+              const std::shared_ptr<ZarrSharedResource>& poShared,
+              const std::string& osParentName,
+              const std::string& osName,
+              const std::string& osDirectoryName,
+              const std::vector<std::shared_ptr<GDALDimension>>& aoDims,
+              const GDALExtendedDataType& oType,
+              CSLConstList papszOptions);
+
+    ~ZarrArray();
+
+    bool IsWritable() const override { return m_bUpdatable; }
+
+    const std::vector<std::shared_ptr<GDALDimension>>& GetDimensions() const override { return m_aoDims; }
+
+    const GDALExtendedDataType& GetDataType() const override { return m_oType; }
+
+    std::vector<GUInt64> GetBlockSize() const override { return m_anBlockSize; }
+
+    bool IsReadThreadSafe() const override { return true; }
+
+    const void* GetRawNoDataValue() const override;
+
+    bool SetRawNoDataValue(const void* pRawNoData) override;
+
+    std::shared_ptr<GDALAttribute> GetAttribute(const std::string& osName) const override;
+
+    std::vector<std::shared_ptr<GDALAttribute>> GetAttributes(CSLConstList papszOptions = nullptr) const override;
+
+    std::shared_ptr<GDALAttribute> CreateAttribute(
+        const std::string& osName,
+        const std::vector<GUInt64>& anDimensions,
+        const GDALExtendedDataType& oDataType,
+        CSLConstList papszOptions = nullptr) override;
+};
+
+#endif  // ZARR_H
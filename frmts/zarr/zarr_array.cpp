@@ -0,0 +1,1209 @@
+/******************************************************************************
+ *
+ * Project:  GDAL
+ * Purpose:  Zarr driver
+ *
+ ******************************************************************************
+ * Copyright (c) 2020, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "zarr.h"
+
+#include "zlib.h"
+#ifdef ZSTD_SUPPORT
+#include <zstd.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <limits>
+
+CPL_CVSID("$Id$")
+
+/************************************************************************/
+/*                       ZarrArray::ProcessContext                      */
+/************************************************************************/
+
+// Parameters of a IRead() / IWrite() request, shared by its chunk jobs
+struct ZarrArray::ProcessContext
+{
+    bool                        bIsWrite = false;
+    const GUInt64*              arrayStartIdx = nullptr;
+    const GInt64*               arrayStep = nullptr;
+    const GPtrDiff_t*           bufferStride = nullptr;
+    const GDALExtendedDataType* pBufferDataType = nullptr;
+    GByte*                      pabyBuffer = nullptr;
+
+    std::mutex                  oMutex{};
+    std::condition_variable     oCond{};
+    size_t                      nRemainingJobs = 0;
+    bool                        bOK = true;
+};
+
+/************************************************************************/
+/*                             ParseDtype()                             */
+/************************************************************************/
+
+static bool ParseDtype(const std::string& osDtype,
+                       GDALDataType& eDT, bool& bNeedByteSwap)
+{
+    eDT = GDT_Unknown;
+    bNeedByteSwap = false;
+    if( osDtype.size() < 3 )
+        return false;
+    const char chEndian = osDtype[0];
+    const char chType = osDtype[1];
+    const int nBytes = atoi(osDtype.c_str() + 2);
+    if( chEndian != '<' && chEndian != '>' && chEndian != '|' )
+        return false;
+
+    if( (chType == 'b' || chType == 'u') && nBytes == 1 )
+        eDT = GDT_Byte;
+    else if( chType == 'u' && nBytes == 2 )
+        eDT = GDT_UInt16;
+    else if( chType == 'u' && nBytes == 4 )
+        eDT = GDT_UInt32;
+    else if( chType == 'i' && nBytes == 2 )
+        eDT = GDT_Int16;
+    else if( chType == 'i' && nBytes == 4 )
+        eDT = GDT_Int32;
+    else if( chType == 'f' && nBytes == 4 )
+        eDT = GDT_Float32;
+    else if( chType == 'f' && nBytes == 8 )
+        eDT = GDT_Float64;
+    else if( chType == 'c' && nBytes == 8 )
+        eDT = GDT_CFloat32;
+    else if( chType == 'c' && nBytes == 16 )
+        eDT = GDT_CFloat64;
+    else
+        return false;
+
+    if( nBytes > 1 )
+    {
+#if CPL_IS_LSB
+        bNeedByteSwap = chEndian == '>';
+#else
+        bNeedByteSwap = chEndian == '<';
+#endif
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                             GetDtype()                               */
+/************************************************************************/
+
+static std::string GetDtype(GDALDataType eDT)
+{
+#if CPL_IS_LSB
+    const std::string osEndian("<");
+#else
+    const std::string osEndian(">");
+#endif
+    switch( eDT )
+    {
+        case GDT_Byte: return "|u1";
+        case GDT_UInt16: return osEndian + "u2";
+        case GDT_UInt32: return osEndian + "u4";
+        case GDT_Int16: return osEndian + "i2";
+        case GDT_Int32: return osEndian + "i4";
+        case GDT_Float32: return osEndian + "f4";
+        case GDT_Float64: return osEndian + "f8";
+        case GDT_CFloat32: return osEndian + "c8";
+        case GDT_CFloat64: return osEndian + "c16";
+        default: break;
+    }
+    return std::string();
+}
+
+/************************************************************************/
+/*                        IsSupportedCompressor()                       */
+/************************************************************************/
+
+static bool IsSupportedCompressor(const std::string& osId)
+{
+    return osId.empty() || osId == "zlib" || osId == "gzip"
+#ifdef ZSTD_SUPPORT
+        || osId == "zstd"
+#endif
+        ;
+}
+
+/************************************************************************/
+/*                             ZarrArray()                              */
+/************************************************************************/
+
+ZarrArray::ZarrArray(const std::shared_ptr<ZarrSharedResource>& poShared,
+                     const std::string& osParentName,
+                     const std::string& osName,
+                     const std::string& osDirectoryName,
+                     bool bUpdatable,
+                     const std::vector<std::shared_ptr<GDALDimension>>& aoDims,
+                     const GDALExtendedDataType& oType,
+                     const std::vector<GUInt64>& anBlockSize):
+    GDALAbstractMDArray(osParentName, osName),
+    GDALMDArray(osParentName, osName),
+    m_poShared(poShared),
+    m_osDirectoryName(osDirectoryName),
+    m_bUpdatable(bUpdatable),
+    m_aoDims(aoDims),
+    m_oType(oType),
+    m_anBlockSize(anBlockSize),
+    m_oAttrGroup(GetFullName())
+{
+}
+
+/************************************************************************/
+/*                            ~ZarrArray()                              */
+/************************************************************************/
+
+ZarrArray::~ZarrArray()
+{
+    if( m_bDefinitionModified || m_oAttrGroup.IsModified() )
+        SerializeDefinition();
+}
+
+/************************************************************************/
+/*                                Open()                                */
+/************************************************************************/
+
+std::shared_ptr<ZarrArray> ZarrArray::Open(
+              const std::shared_ptr<ZarrSharedResource>& poShared,
+              const ZarrGroup* poGroup,
+              const std::string& osName,
+              const std::string& osDirectoryName,
+              bool bUpdatable)
+{
+    CPLJSONDocument oDoc;
+    const std::string osZarrayFilename(
+        CPLFormFilename(osDirectoryName.c_str(), ".zarray", nullptr));
+    if( !oDoc.Load(osZarrayFilename) )
+        return nullptr;
+    const auto oRoot = oDoc.GetRoot();
+    if( oRoot.GetInteger("zarr_format") != 2 )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "%s: only zarr_format=2 is supported",
+                 osZarrayFilename.c_str());
+        return nullptr;
+    }
+
+    const auto oShape = oRoot.GetArray("shape");
+    const auto oChunks = oRoot.GetArray("chunks");
+    if( !oShape.IsValid() || !oChunks.IsValid() ||
+        oShape.Size() != oChunks.Size() )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "%s: invalid or inconsistent shape and chunks",
+                 osZarrayFilename.c_str());
+        return nullptr;
+    }
+    const size_t nDims = static_cast<size_t>(oShape.Size());
+
+    GDALDataType eDT = GDT_Unknown;
+    bool bNeedByteSwap = false;
+    const std::string osDtype = oRoot.GetString("dtype");
+    if( !ParseDtype(osDtype, eDT, bNeedByteSwap) )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "%s: unsupported dtype %s",
+                 osZarrayFilename.c_str(), osDtype.c_str());
+        return nullptr;
+    }
+    const size_t nDTSize = GDALGetDataTypeSizeBytes(eDT);
+
+    std::vector<GUInt64> anShape(nDims);
+    std::vector<GUInt64> anBlockSize(nDims);
+    double dfChunkBytes = static_cast<double>(nDTSize);
+    for( size_t i = 0; i < nDims; ++i )
+    {
+        const GInt64 nSize = oShape[static_cast<int>(i)].ToLong(-1);
+        const GInt64 nBlockSize = oChunks[static_cast<int>(i)].ToLong(-1);
+        if( nSize < 0 || nBlockSize <= 0 )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "%s: invalid shape or chunks",
+                     osZarrayFilename.c_str());
+            return nullptr;
+        }
+        anShape[i] = static_cast<GUInt64>(nSize);
+        anBlockSize[i] = static_cast<GUInt64>(nBlockSize);
+        dfChunkBytes *= static_cast<double>(nBlockSize);
+    }
+    if( dfChunkBytes > std::numeric_limits<int>::max() )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "%s: chunks larger than 2 GB are not supported",
+                 osZarrayFilename.c_str());
+        return nullptr;
+    }
+
+    const std::string osOrder = oRoot.GetString("order", "C");
+    if( osOrder != "C" && osOrder != "F" )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "%s: unsupported order %s",
+                 osZarrayFilename.c_str(), osOrder.c_str());
+        return nullptr;
+    }
+
+    std::string osCompressorId;
+    int nCompressionLevel = -1;
+    const auto oCompressor = oRoot["compressor"];
+    if( oCompressor.GetType() == CPLJSONObject::Object )
+    {
+        osCompressorId = oCompressor.GetString("id");
+        nCompressionLevel = oCompressor.GetInteger("level", -1);
+        if( osCompressorId.empty() )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "%s: missing compressor id", osZarrayFilename.c_str());
+            return nullptr;
+        }
+    }
+    if( !IsSupportedCompressor(osCompressorId) )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "%s: compressor %s is not supported by this build",
+                 osZarrayFilename.c_str(), osCompressorId.c_str());
+        return nullptr;
+    }
+
+    const auto oFilters = oRoot["filters"];
+    if( oFilters.GetType() == CPLJSONObject::Array &&
+        oFilters.ToArray().Size() > 0 )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "%s: filters are not supported", osZarrayFilename.c_str());
+        return nullptr;
+    }
+
+    const std::string osDimSeparator =
+        oRoot.GetString("dimension_separator", ".");
+    if( osDimSeparator != "." && osDimSeparator != "/" )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "%s: unsupported dimension_separator %s",
+                 osZarrayFilename.c_str(), osDimSeparator.c_str());
+        return nullptr;
+    }
+
+    // Dimension names are stored as in xarray
+    CPLJSONDocument oAttrsDoc;
+    CPLJSONObject oAttributes;
+    const std::string osZattrsFilename(
+        CPLFormFilename(osDirectoryName.c_str(), ".zattrs", nullptr));
+    VSIStatBufL sStat;
+    if( VSIStatL(osZattrsFilename.c_str(), &sStat) == 0 &&
+        oAttrsDoc.Load(osZattrsFilename) )
+    {
+        oAttributes = oAttrsDoc.GetRoot();
+    }
+    const auto oDimNames = oAttributes.GetArray("_ARRAY_DIMENSIONS");
+    const bool bHasDimNames =
+        oDimNames.IsValid() && static_cast<size_t>(oDimNames.Size()) == nDims;
+
+    const std::string osFullName(poGroup->GetFullName() == "/" ?
+        "/" + osName : poGroup->GetFullName() + "/" + osName);
+    std::vector<std::shared_ptr<GDALDimension>> aoDims;
+    for( size_t i = 0; i < nDims; ++i )
+    {
+        const std::string osDimName = bHasDimNames ?
+            oDimNames[static_cast<int>(i)].ToString() : std::string();
+        if( !osDimName.empty() )
+        {
+            aoDims.emplace_back(
+                poGroup->GetOrCreateDimension(osDimName, anShape[i]));
+        }
+        else
+        {
+            aoDims.emplace_back(std::make_shared<GDALDimension>(
+                osFullName, CPLSPrintf("dim%d", static_cast<int>(i)),
+                std::string(), std::string(), anShape[i]));
+        }
+    }
+
+    auto poArray(std::shared_ptr<ZarrArray>(
+        new ZarrArray(poShared, poGroup->GetFullName(), osName,
+                      osDirectoryName, bUpdatable, aoDims,
+                      GDALExtendedDataType::Create(eDT), anBlockSize)));
+    poArray->SetSelf(poArray);
+    poArray->m_osDtype = osDtype;
+    poArray->m_bNeedByteSwap = bNeedByteSwap;
+    poArray->m_bFortranOrder = osOrder == "F";
+    poArray->m_osDimSeparator = osDimSeparator;
+    poArray->m_osCompressorId = osCompressorId;
+    poArray->m_nCompressionLevel = nCompressionLevel;
+    poArray->m_oAttrGroup.Init(oAttributes,
+                               std::vector<std::string>{"_ARRAY_DIMENSIONS"});
+
+    // Fill value
+    const auto oFillValue = oRoot["fill_value"];
+    const auto eFillType = oFillValue.GetType();
+    double dfNoData = 0;
+    bool bHasNoData = true;
+    if( eFillType == CPLJSONObject::String )
+    {
+        const auto osFillValue = oFillValue.ToString();
+        if( osFillValue == "NaN" )
+            dfNoData = std::numeric_limits<double>::quiet_NaN();
+        else if( osFillValue == "Infinity" )
+            dfNoData = std::numeric_limits<double>::infinity();
+        else if( osFillValue == "-Infinity" )
+            dfNoData = -std::numeric_limits<double>::infinity();
+        else
+            bHasNoData = false;
+    }
+    else if( eFillType == CPLJSONObject::Integer ||
+             eFillType == CPLJSONObject::Long )
+    {
+        dfNoData = static_cast<double>(oFillValue.ToLong());
+    }
+    else if( eFillType == CPLJSONObject::Double )
+    {
+        dfNoData = oFillValue.ToDouble();
+    }
+    else if( eFillType == CPLJSONObject::Boolean )
+    {
+        dfNoData = oFillValue.ToBool() ? 1 : 0;
+    }
+    else
+    {
+        bHasNoData = false;
+    }
+    if( bHasNoData )
+    {
+        poArray->m_abyNoData.resize(nDTSize);
+        GDALCopyWords(&dfNoData, GDT_Float64, 0,
+                      &poArray->m_abyNoData[0], eDT, 0, 1);
+    }
+
+    return poArray;
+}
+
+/************************************************************************/
+/*                              CreateNew()                             */
+/************************************************************************/
+
+std::shared_ptr<ZarrArray> ZarrArray::CreateNew(
+              const std::shared_ptr<ZarrSharedResource>& poShared,
+              const std::string& osParentName,
+              const std::string& osName,
+              const std::string& osDirectoryName,
+              const std::vector<std::shared_ptr<GDALDimension>>& aoDims,
+              const GDALExtendedDataType& oType,
+              CSLConstList papszOptions)
+{
+    const std::string osDtype = oType.GetClass() == GEDTC_NUMERIC ?
+        GetDtype(oType.GetNumericDataType()) : std::string();
+    if( osDtype.empty() )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "Unsupported data type for a Zarr array");
+        return nullptr;
+    }
+
+    const size_t nDims = aoDims.size();
+    std::vector<GUInt64> anBlockSize(nDims);
+    const char* pszBlockSize = CSLFetchNameValue(papszOptions, "BLOCKSIZE");
+    if( pszBlockSize )
+    {
+        const CPLStringList aosTokens(
+            CSLTokenizeString2(pszBlockSize, ",", 0));
+        if( static_cast<size_t>(aosTokens.size()) != nDims )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "Invalid number of values in BLOCKSIZE");
+            return nullptr;
+        }
+        for( size_t i = 0; i < nDims; ++i )
+        {
+            const GIntBig nVal = CPLAtoGIntBig(aosTokens[static_cast<int>(i)]);
+            if( nVal <= 0 )
+            {
+                CPLError(CE_Failure, CPLE_AppDefined,
+                         "Invalid value in BLOCKSIZE");
+                return nullptr;
+            }
+            anBlockSize[i] = static_cast<GUInt64>(nVal);
+        }
+    }
+    else
+    {
+        // Default to 256x256 tiles on the 2 fastest varying dimensions
+        for( size_t i = 0; i < nDims; ++i )
+        {
+            const GUInt64 nSize = std::max(aoDims[i]->GetSize(),
+                                           static_cast<GUInt64>(1));
+            if( nDims == 1 )
+                anBlockSize[i] = std::min(nSize, static_cast<GUInt64>(65536));
+            else if( i + 2 >= nDims )
+                anBlockSize[i] = std::min(nSize, static_cast<GUInt64>(256));
+            else
+                anBlockSize[i] = 1;
+        }
+    }
+    double dfChunkBytes = static_cast<double>(oType.GetSize());
+    for( const auto nBlockSize: anBlockSize )
+        dfChunkBytes *= static_cast<double>(nBlockSize);
+    if( dfChunkBytes > std::numeric_limits<int>::max() )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "Chunks larger than 2 GB are not supported");
+        return nullptr;
+    }
+
+    const char* pszCompress =
+        CSLFetchNameValueDef(papszOptions, "COMPRESS", "NONE");
+    std::string osCompressorId;
+    int nCompressionLevel = -1;
+    if( EQUAL(pszCompress, "ZLIB") || EQUAL(pszCompress, "GZIP") )
+    {
+        osCompressorId = CPLString(pszCompress).tolower();
+        nCompressionLevel =
+            atoi(CSLFetchNameValueDef(papszOptions, "ZLEVEL", "6"));
+    }
+    else if( EQUAL(pszCompress, "ZSTD") )
+    {
+        osCompressorId = "zstd";
+        nCompressionLevel =
+            atoi(CSLFetchNameValueDef(papszOptions, "ZSTD_LEVEL", "9"));
+    }
+    else if( !EQUAL(pszCompress, "NONE") )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "Unsupported COMPRESS=%s", pszCompress);
+        return nullptr;
+    }
+    if( !IsSupportedCompressor(osCompressorId) )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "COMPRESS=%s is not supported by this build", pszCompress);
+        return nullptr;
+    }
+
+    if( VSIMkdir(osDirectoryName.c_str(), 0755) != 0 )
+    {
+        CPLError(CE_Failure, CPLE_FileIO,
+                 "Cannot create directory %s", osDirectoryName.c_str());
+        return nullptr;
+    }
+
+    auto poArray(std::shared_ptr<ZarrArray>(
+        new ZarrArray(poShared, osParentName, osName, osDirectoryName, true,
+                      aoDims, oType, anBlockSize)));
+    poArray->SetSelf(poArray);
+    poArray->m_osDtype = osDtype;
+    poArray->m_osCompressorId = osCompressorId;
+    poArray->m_nCompressionLevel = nCompressionLevel;
+    if( !poArray->SerializeDefinition() )
+        return nullptr;
+    return poArray;
+}
+
+/************************************************************************/
+/*                         SerializeDefinition()                        */
+/************************************************************************/
+
+// Write the .zarray and .zattrs files
+bool ZarrArray::SerializeDefinition() const
+{
+    CPLJSONObject oRoot;
+    CPLJSONArray oChunks;
+    CPLJSONArray oShape;
+    for( size_t i = 0; i < m_aoDims.size(); ++i )
+    {
+        oChunks.Add(static_cast<GInt64>(m_anBlockSize[i]));
+        oShape.Add(static_cast<GInt64>(m_aoDims[i]->GetSize()));
+    }
+    oRoot.Add("chunks", oChunks);
+    if( m_osCompressorId.empty() )
+    {
+        oRoot.AddNull("compressor");
+    }
+    else
+    {
+        CPLJSONObject oCompressor;
+        oCompressor.Add("id", m_osCompressorId);
+        if( m_nCompressionLevel >= 0 )
+            oCompressor.Add("level", m_nCompressionLevel);
+        oRoot.Add("compressor", oCompressor);
+    }
+    if( m_osDimSeparator != "." )
+        oRoot.Add("dimension_separator", m_osDimSeparator);
+    oRoot.Add("dtype", m_osDtype);
+
+    if( m_abyNoData.empty() )
+    {
+        oRoot.AddNull("fill_value");
+    }
+    else
+    {
+        double dfNoData = 0;
+        GDALCopyWords(m_abyNoData.data(), m_oType.GetNumericDataType(), 0,
+                      &dfNoData, GDT_Float64, 0, 1);
+        if( std::isnan(dfNoData) )
+            oRoot.Add("fill_value", "NaN");
+        else if( std::isinf(dfNoData) )
+            oRoot.Add("fill_value", dfNoData > 0 ? "Infinity" : "-Infinity");
+        else if( GDALDataTypeIsInteger(m_oType.GetNumericDataType()) )
+            oRoot.Add("fill_value", static_cast<GInt64>(dfNoData));
+        else
+            oRoot.Add("fill_value", dfNoData);
+    }
+    oRoot.AddNull("filters");
+    oRoot.Add("order", m_bFortranOrder ? "F" : "C");
+    oRoot.Add("shape", oShape);
+    oRoot.Add("zarr_format", 2);
+
+    if( !ZarrWriteJSONFile(
+            CPLFormFilename(m_osDirectoryName.c_str(), ".zarray", nullptr),
+            oRoot) )
+    {
+        return false;
+    }
+
+    auto oAttrs = m_oAttrGroup.Serialize();
+    CPLJSONArray oDimNames;
+    for( const auto& poDim: m_aoDims )
+        oDimNames.Add(poDim->GetName());
+    oAttrs.Add("_ARRAY_DIMENSIONS", oDimNames);
+    return ZarrWriteJSONFile(
+        CPLFormFilename(m_osDirectoryName.c_str(), ".zattrs", nullptr),
+        oAttrs);
+}
+
+/************************************************************************/
+/*                          GetRawNoDataValue()                         */
+/************************************************************************/
+
+const void* ZarrArray::GetRawNoDataValue() const
+{
+    return m_abyNoData.empty() ? nullptr : m_abyNoData.data();
+}
+
+/************************************************************************/
+/*                          SetRawNoDataValue()                         */
+/************************************************************************/
+
+bool ZarrArray::SetRawNoDataValue(const void* pRawNoData)
+{
+    if( !m_bUpdatable )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "Dataset not open in update mode");
+        return false;
+    }
+    if( pRawNoData == nullptr )
+    {
+        m_abyNoData.clear();
+    }
+    else
+    {
+        const auto nSize = m_oType.GetSize();
+        m_abyNoData.resize(nSize);
+        memcpy(&m_abyNoData[0], pRawNoData, nSize);
+    }
+    m_bDefinitionModified = true;
+    return true;
+}
+
+/************************************************************************/
+/*                            GetAttribute()                            */
+/************************************************************************/
+
+std::shared_ptr<GDALAttribute> ZarrArray::GetAttribute(
+                                        const std::string& osName) const
+{
+    return m_oAttrGroup.GetAttribute(osName);
+}
+
+/************************************************************************/
+/*                           GetAttributes()                            */
+/************************************************************************/
+
+std::vector<std::shared_ptr<GDALAttribute>> ZarrArray::GetAttributes(
+                                                        CSLConstList) const
+{
+    return m_oAttrGroup.GetAttributes();
+}
+
+/************************************************************************/
+/*                          CreateAttribute()                           */
+/************************************************************************/
+
+std::shared_ptr<GDALAttribute> ZarrArray::CreateAttribute(
+        const std::string& osName,
+        const std::vector<GUInt64>& anDimensions,
+        const GDALExtendedDataType& oDataType,
+        CSLConstList)
+{
+    if( !m_bUpdatable )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "Dataset not open in update mode");
+        return nullptr;
+    }
+    return m_oAttrGroup.CreateAttribute(osName, anDimensions, oDataType);
+}
+
+/************************************************************************/
+/*                          GetChunkFilename()                          */
+/************************************************************************/
+
+std::string ZarrArray::GetChunkFilename(
+                            const std::vector<GUInt64>& anChunkIdx) const
+{
+    std::string osKey;
+    for( const auto nIdx: anChunkIdx )
+    {
+        if( !osKey.empty() )
+            osKey += m_osDimSeparator;
+        osKey += CPLSPrintf(CPL_FRMT_GUIB, static_cast<GUIntBig>(nIdx));
+    }
+    if( osKey.empty() )
+        osKey = "0";
+    return CPLFormFilename(m_osDirectoryName.c_str(), osKey.c_str(), nullptr);
+}
+
+/************************************************************************/
+/*                          GetChunkByteSize()                          */
+/************************************************************************/
+
+size_t ZarrArray::GetChunkByteSize() const
+{
+    size_t nSize = m_oType.GetSize();
+    for( const auto nBlockSize: m_anBlockSize )
+        nSize *= static_cast<size_t>(nBlockSize);
+    return nSize;
+}
+
+/************************************************************************/
+/*                          GetChunkStrides()                           */
+/************************************************************************/
+
+// Strides, in elements, of the dimensions within a (full size) chunk
+std::vector<GPtrDiff_t> ZarrArray::GetChunkStrides() const
+{
+    const size_t nDims = m_anBlockSize.size();
+    std::vector<GPtrDiff_t> anStrides(nDims);
+    GPtrDiff_t nStride = 1;
+    for( size_t i = 0; i < nDims; ++i )
+    {
+        const size_t iDim = m_bFortranOrder ? i : nDims - 1 - i;
+        anStrides[iDim] = nStride;
+        nStride *= static_cast<GPtrDiff_t>(m_anBlockSize[iDim]);
+    }
+    return anStrides;
+}
+
+/************************************************************************/
+/*                           FillWithNoData()                           */
+/************************************************************************/
+
+void ZarrArray::FillWithNoData(std::vector<GByte>& abyChunk) const
+{
+    if( m_abyNoData.empty() )
+    {
+        memset(abyChunk.data(), 0, abyChunk.size());
+        return;
+    }
+    const size_t nDTSize = m_oType.GetSize();
+    GDALCopyWords64(m_abyNoData.data(), m_oType.GetNumericDataType(), 0,
+                    abyChunk.data(), m_oType.GetNumericDataType(),
+                    static_cast<int>(nDTSize),
+                    static_cast<GPtrDiff_t>(abyChunk.size() / nDTSize));
+}
+
+/************************************************************************/
+/*                              SwapChunk()                             */
+/************************************************************************/
+
+static void SwapChunk(std::vector<GByte>& abyChunk, GDALDataType eDT)
+{
+    // Complex values are swapped component by component
+    const int nWordSize = GDALDataTypeIsComplex(eDT) ?
+        GDALGetDataTypeSizeBytes(eDT) / 2 : GDALGetDataTypeSizeBytes(eDT);
+    GDALSwapWordsEx(abyChunk.data(), nWordSize, abyChunk.size() / nWordSize,
+                    nWordSize);
+}
+
+/************************************************************************/
+/*                              ReadChunk()                             */
+/************************************************************************/
+
+// Read and decompress a chunk. bMissing is set if the chunk file does not
+// exist, which means that the chunk is filled with the fill value.
+bool ZarrArray::ReadChunk(const std::vector<GUInt64>& anChunkIdx,
+                          std::vector<GByte>& abyChunk,
+                          bool& bMissing) const
+{
+    bMissing = false;
+    const std::string osFilename = GetChunkFilename(anChunkIdx);
+    VSILFILE* fp = VSIFOpenL(osFilename.c_str(), "rb");
+    if( fp == nullptr )
+    {
+        bMissing = true;
+        return true;
+    }
+    GByte* pabyData = nullptr;
+    vsi_l_offset nSize = 0;
+    const bool bIngested = VSIIngestFile(fp, osFilename.c_str(), &pabyData,
+                                         &nSize, -1) != 0;
+    VSIFCloseL(fp);
+    if( !bIngested )
+        return false;
+
+    bool bOK = false;
+    if( m_osCompressorId.empty() )
+    {
+        bOK = nSize == abyChunk.size();
+        if( bOK )
+            memcpy(abyChunk.data(), pabyData, abyChunk.size());
+    }
+    else if( m_osCompressorId == "zlib" || m_osCompressorId == "gzip" )
+    {
+        size_t nOutBytes = 0;
+        bOK = CPLZLibInflate(pabyData, static_cast<size_t>(nSize),
+                             abyChunk.data(), abyChunk.size(),
+                             &nOutBytes) != nullptr &&
+              nOutBytes == abyChunk.size();
+    }
+#ifdef ZSTD_SUPPORT
+    else if( m_osCompressorId == "zstd" )
+    {
+        const size_t nRet = ZSTD_decompress(abyChunk.data(), abyChunk.size(),
+                                            pabyData,
+                                            static_cast<size_t>(nSize));
+        bOK = !ZSTD_isError(nRet) && nRet == abyChunk.size();
+    }
+#endif
+    VSIFree(pabyData);
+    if( !bOK )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "Cannot decode chunk %s", osFilename.c_str());
+        return false;
+    }
+
+    if( m_bNeedByteSwap )
+        SwapChunk(abyChunk, m_oType.GetNumericDataType());
+    return true;
+}
+
+/************************************************************************/
+/*                             WriteChunk()                             */
+/************************************************************************/
+
+// Compress and write a chunk. abyChunk may be modified.
+bool ZarrArray::WriteChunk(const std::vector<GUInt64>& anChunkIdx,
+                           std::vector<GByte>& abyChunk) const
+{
+    if( m_bNeedByteSwap )
+        SwapChunk(abyChunk, m_oType.GetNumericDataType());
+
+    std::vector<GByte> abyCompressed;
+    const GByte* pabyToWrite = abyChunk.data();
+    size_t nToWrite = abyChunk.size();
+    if( m_osCompressorId == "zlib" || m_osCompressorId == "gzip" )
+    {
+        z_stream sStream;
+        memset(&sStream, 0, sizeof(sStream));
+        const int nLevel = m_nCompressionLevel >= 0 ?
+            std::min(m_nCompressionLevel, 9) : Z_DEFAULT_COMPRESSION;
+        // 31 = 15 + 16 means a gzip header and trailer
+        if( deflateInit2(&sStream, nLevel, Z_DEFLATED,
+                         m_osCompressorId == "gzip" ? 31 : 15, 8,
+                         Z_DEFAULT_STRATEGY) != Z_OK )
+        {
+            return false;
+        }
+        abyCompressed.resize(
+            deflateBound(&sStream, static_cast<uLong>(abyChunk.size())) + 32);
+        sStream.next_in = abyChunk.data();
+        sStream.avail_in = static_cast<uInt>(abyChunk.size());
+        sStream.next_out = abyCompressed.data();
+        sStream.avail_out = static_cast<uInt>(abyCompressed.size());
+        const int nRet = deflate(&sStream, Z_FINISH);
+        nToWrite = abyCompressed.size() - sStream.avail_out;
+        deflateEnd(&sStream);
+        if( nRet != Z_STREAM_END )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined, "Compression failed");
+            return false;
+        }
+        pabyToWrite = abyCompressed.data();
+    }
+#ifdef ZSTD_SUPPORT
+    else if( m_osCompressorId == "zstd" )
+    {
+        abyCompressed.resize(ZSTD_compressBound(abyChunk.size()));
+        const size_t nRet = ZSTD_compress(abyCompressed.data(),
+                                          abyCompressed.size(),
+                                          abyChunk.data(), abyChunk.size(),
+                                          m_nCompressionLevel >= 0 ?
+                                            m_nCompressionLevel : 1);
+        if( ZSTD_isError(nRet) )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined, "Compression failed");
+            return false;
+        }
+        nToWrite = nRet;
+        pabyToWrite = abyCompressed.data();
+    }
+#endif
+
+    const std::string osFilename = GetChunkFilename(anChunkIdx);
+    if( m_osDimSeparator == "/" )
+        VSIMkdirRecursive(CPLGetPath(osFilename.c_str()), 0755);
+    VSILFILE* fp = VSIFOpenL(osFilename.c_str(), "wb");
+    if( fp == nullptr )
+    {
+        CPLError(CE_Failure, CPLE_FileIO,
+                 "Cannot create %s", osFilename.c_str());
+        return false;
+    }
+    bool bOK = VSIFWriteL(pabyToWrite, 1, nToWrite, fp) == nToWrite;
+    bOK = VSIFCloseL(fp) == 0 && bOK;
+    if( !bOK )
+    {
+        CPLError(CE_Failure, CPLE_FileIO,
+                 "Cannot write %s", osFilename.c_str());
+    }
+    return bOK;
+}
+
+/************************************************************************/
+/*                            ProcessChunk()                            */
+/************************************************************************/
+
+// Transfer the part of the request that intersects one chunk
+bool ZarrArray::ProcessChunk(const ProcessContext& sCtx,
+                             const std::vector<ChunkRange>& aoRanges) const
+{
+    const size_t nDims = m_aoDims.size();
+    const auto eDT = m_oType.GetNumericDataType();
+    const size_t nDTSize = m_oType.GetSize();
+    const auto& oBufferDT = *(sCtx.pBufferDataType);
+    const auto eBufferDT = oBufferDT.GetNumericDataType();
+    const GPtrDiff_t nBufferDTSize = static_cast<GPtrDiff_t>(oBufferDT.GetSize());
+
+    std::vector<GUInt64> anChunkIdx(nDims);
+    bool bFullChunk = sCtx.bIsWrite;
+    bool bPartialEdgeChunk = false;
+    for( size_t i = 0; i < nDims; ++i )
+    {
+        anChunkIdx[i] = aoRanges[i].nChunkIdx;
+        const GUInt64 nChunkStart = anChunkIdx[i] * m_anBlockSize[i];
+        const GUInt64 nValidCount = std::min(
+            m_anBlockSize[i], m_aoDims[i]->GetSize() - nChunkStart);
+        bPartialEdgeChunk |= nValidCount < m_anBlockSize[i];
+        bFullChunk &= aoRanges[i].nCount == nValidCount &&
+                      (aoRanges[i].nCount == 1 ||
+                       std::abs(sCtx.arrayStep[i]) == 1);
+    }
+
+    std::vector<GByte> abyChunk;
+    try
+    {
+        abyChunk.resize(GetChunkByteSize());
+    }
+    catch( const std::exception& e )
+    {
+        CPLError(CE_Failure, CPLE_OutOfMemory, "%s", e.what());
+        return false;
+    }
+    if( !bFullChunk )
+    {
+        bool bMissing = false;
+        if( !ReadChunk(anChunkIdx, abyChunk, bMissing) )
+            return false;
+        if( bMissing )
+            FillWithNoData(abyChunk);
+    }
+    else if( bPartialEdgeChunk )
+    {
+        FillWithNoData(abyChunk);
+    }
+
+    if( nDims == 0 )
+    {
+        if( sCtx.bIsWrite )
+        {
+            GDALCopyWords64(sCtx.pabyBuffer, eBufferDT, 0,
+                            abyChunk.data(), eDT, 0, 1);
+            return WriteChunk(anChunkIdx, abyChunk);
+        }
+        GDALCopyWords64(abyChunk.data(), eDT, 0,
+                        sCtx.pabyBuffer, eBufferDT, 0, 1);
+        return true;
+    }
+
+    // Copy row by row along the last dimension
+    const auto anChunkStrides = GetChunkStrides();
+    const size_t iLast = nDims - 1;
+    const GPtrDiff_t nChunkStep =
+        static_cast<GPtrDiff_t>(sCtx.arrayStep[iLast]) *
+        anChunkStrides[iLast] * static_cast<GPtrDiff_t>(nDTSize);
+    const GPtrDiff_t nBufferStep = sCtx.bufferStride[iLast] * nBufferDTSize;
+    const bool bIntStrides =
+        std::abs(nBufferStep) <= std::numeric_limits<int>::max() &&
+        std::abs(nChunkStep) <= std::numeric_limits<int>::max();
+    std::vector<size_t> anIdx(nDims);
+    while( true )
+    {
+        GPtrDiff_t nChunkOffset = 0;
+        GPtrDiff_t nBufferOffset = 0;
+        for( size_t i = 0; i < nDims; ++i )
+        {
+            const size_t j = aoRanges[i].nFirst + (i < iLast ? anIdx[i] : 0);
+            const GUInt64 nArrayIdx = static_cast<GUInt64>(
+                sCtx.arrayStartIdx[i] + j * sCtx.arrayStep[i]);
+            nChunkOffset += static_cast<GPtrDiff_t>(
+                nArrayIdx - anChunkIdx[i] * m_anBlockSize[i]) *
+                anChunkStrides[i];
+            nBufferOffset += static_cast<GPtrDiff_t>(j) * sCtx.bufferStride[i];
+        }
+        GByte* pabyChunk =
+            abyChunk.data() + nChunkOffset * static_cast<GPtrDiff_t>(nDTSize);
+        GByte* pabyBuffer = sCtx.pabyBuffer + nBufferOffset * nBufferDTSize;
+        const size_t nCount = aoRanges[iLast].nCount;
+        if( bIntStrides )
+        {
+            if( sCtx.bIsWrite )
+                GDALCopyWords64(pabyBuffer, eBufferDT,
+                                static_cast<int>(nBufferStep),
+                                pabyChunk, eDT, static_cast<int>(nChunkStep),
+                                static_cast<GPtrDiff_t>(nCount));
+            else
+                GDALCopyWords64(pabyChunk, eDT, static_cast<int>(nChunkStep),
+                                pabyBuffer, eBufferDT,
+                                static_cast<int>(nBufferStep),
+                                static_cast<GPtrDiff_t>(nCount));
+        }
+        else
+        {
+            for( size_t k = 0; k < nCount; ++k )
+            {
+                if( sCtx.bIsWrite )
+                    GDALCopyWords64(pabyBuffer + k * nBufferStep, eBufferDT, 0,
+                                    pabyChunk + k * nChunkStep, eDT, 0, 1);
+                else
+                    GDALCopyWords64(pabyChunk + k * nChunkStep, eDT, 0,
+                                    pabyBuffer + k * nBufferStep, eBufferDT,
+                                    0, 1);
+            }
+        }
+
+        // Advance to the next row
+        bool bDone = true;
+        for( size_t i = iLast; i != 0; )
+        {
+            --i;
+            if( ++anIdx[i] < aoRanges[i].nCount )
+            {
+                bDone = false;
+                break;
+            }
+            anIdx[i] = 0;
+        }
+        if( bDone )
+            break;
+    }
+
+    if( sCtx.bIsWrite )
+        return WriteChunk(anChunkIdx, abyChunk);
+    return true;
+}
+
+/************************************************************************/
+/*                            ChunkJobFunc()                            */
+/************************************************************************/
+
+void ZarrArray::ChunkJobFunc(void* pData)
+{
+    ChunkJob* psJob = static_cast<ChunkJob*>(pData);
+    ProcessContext& sCtx = *(psJob->psCtx);
+    bool bOK;
+    {
+        std::lock_guard<std::mutex> oLock(sCtx.oMutex);
+        bOK = sCtx.bOK;
+    }
+    // Skip the remaining jobs once one has failed
+    if( bOK )
+        bOK = psJob->poArray->ProcessChunk(sCtx, psJob->aoRanges);
+
+    std::lock_guard<std::mutex> oLock(sCtx.oMutex);
+    if( !bOK )
+        sCtx.bOK = false;
+    if( --sCtx.nRemainingJobs == 0 )
+        sCtx.oCond.notify_one();
+}
+
+/************************************************************************/
+/*                            ProcessChunks()                           */
+/************************************************************************/
+
+// Split a request into the chunks it intersects, and process them, on the
+// thread pool of the dataset if there are several.
+bool ZarrArray::ProcessChunks(bool bIsWrite,
+                              const GUInt64* arrayStartIdx,
+                              const size_t* count,
+                              const GInt64* arrayStep,
+                              const GPtrDiff_t* bufferStride,
+                              const GDALExtendedDataType& bufferDataType,
+                              GByte* pabyBuffer) const
+{
+    if( bufferDataType.GetClass() != GEDTC_NUMERIC )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "Only numeric buffer data types are supported");
+        return false;
+    }
+
+    ProcessContext sCtx;
+    sCtx.bIsWrite = bIsWrite;
+    sCtx.arrayStartIdx = arrayStartIdx;
+    sCtx.arrayStep = arrayStep;
+    sCtx.bufferStride = bufferStride;
+    sCtx.pBufferDataType = &bufferDataType;
+    sCtx.pabyBuffer = pabyBuffer;
+
+    // Ranges of request indices falling in the same chunk, per dimension.
+    // Indices are monotonic, so those ranges are contiguous.
+    const size_t nDims = m_aoDims.size();
+    std::vector<std::vector<ChunkRange>> aaoRanges(nDims);
+    size_t nJobs = 1;
+    for( size_t i = 0; i < nDims; ++i )
+    {
+        const GUInt64 nStart = arrayStartIdx[i];
+        const GInt64 nStep = arrayStep[i];
+        const GUInt64 nBlockSize = m_anBlockSize[i];
+        size_t j = 0;
+        while( j < count[i] )
+        {
+            const GUInt64 nIdx = static_cast<GUInt64>(nStart + j * nStep);
+            const GUInt64 nChunkIdx = nIdx / nBlockSize;
+            GUInt64 nEnd = count[i];
+            if( nStep > 0 )
+            {
+                nEnd = ((nChunkIdx + 1) * nBlockSize - nStart + nStep - 1) /
+                       static_cast<GUInt64>(nStep);
+            }
+            else if( nStep < 0 )
+            {
+                nEnd = (nStart - nChunkIdx * nBlockSize) /
+                       static_cast<GUInt64>(-nStep) + 1;
+            }
+            nEnd = std::min(nEnd, static_cast<GUInt64>(count[i]));
+            aaoRanges[i].emplace_back(
+                ChunkRange{nChunkIdx, j, static_cast<size_t>(nEnd) - j});
+            j = static_cast<size_t>(nEnd);
+        }
+        nJobs *= aaoRanges[i].size();
+    }
+
+    std::vector<ChunkJob> asJobs(nJobs);
+    std::vector<size_t> anIdx(nDims);
+    for( size_t iJob = 0; iJob < nJobs; ++iJob )
+    {
+        asJobs[iJob].poArray = this;
+        asJobs[iJob].psCtx = &sCtx;
+        asJobs[iJob].aoRanges.resize(nDims);
+        for( size_t i = 0; i < nDims; ++i )
+            asJobs[iJob].aoRanges[i] = aaoRanges[i][anIdx[i]];
+        for( size_t i = nDims; i != 0; )
+        {
+            --i;
+            if( ++anIdx[i] < aaoRanges[i].size() )
+                break;
+            anIdx[i] = 0;
+        }
+    }
+
+    CPLWorkerThreadPool* poPool = nJobs > 1 ? m_poShared->GetThreadPool() :
+                                              nullptr;
+    if( poPool )
+    {
+        std::vector<void*> apData;
+        for( auto& sJob: asJobs )
+            apData.push_back(&sJob);
+        sCtx.nRemainingJobs = nJobs;
+        if( poPool->SubmitJobs(ChunkJobFunc, apData) )
+        {
+            std::unique_lock<std::mutex> oLock(sCtx.oMutex);
+            sCtx.oCond.wait(oLock, [&sCtx]{ return sCtx.nRemainingJobs == 0; });
+            return sCtx.bOK;
+        }
+    }
+
+    for( const auto& sJob: asJobs )
+    {
+        if( !ProcessChunk(sCtx, sJob.aoRanges) )
+            return false;
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                                IRead()                               */
+/************************************************************************/
+
+bool ZarrArray::IRead(const GUInt64* arrayStartIdx,
+                      const size_t* count,
+                      const GInt64* arrayStep,
+                      const GPtrDiff_t* bufferStride,
+                      const GDALExtendedDataType& bufferDataType,
+                      void* pDstBuffer) const
+{
+    bool bRet = false;
+    if( ReadFromChunkCache(arrayStartIdx, count, arrayStep, bufferStride,
+                           bufferDataType, pDstBuffer, bRet) )
+    {
+        return bRet;
+    }
+    return ProcessChunks(false, arrayStartIdx, count, arrayStep,
+                         bufferStride, bufferDataType,
+                         static_cast<GByte*>(pDstBuffer));
+}
+
+/************************************************************************/
+/*                               IWrite()                               */
+/************************************************************************/
+
+bool ZarrArray::IWrite(const GUInt64* arrayStartIdx,
+                       const size_t* count,
+                       const GInt64* arrayStep,
+                       const GPtrDiff_t* bufferStride,
+                       const GDALExtendedDataType& bufferDataType,
+                       const void* pSrcBuffer)
+{
+    if( !m_bUpdatable )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "Dataset not open in update mode");
+        return false;
+    }
+    return ProcessChunks(true, arrayStartIdx, count, arrayStep,
+                         bufferStride, bufferDataType,
+                         static_cast<GByte*>(const_cast<void*>(pSrcBuffer)));
+}
@@ -0,0 +1,397 @@
+/******************************************************************************
+ *
+ * Project:  GDAL
+ * Purpose:  Zarr driver
+ *
+ ******************************************************************************
+ * Copyright (c) 2020, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "zarr.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+CPL_CVSID("$Id$")
+
+/************************************************************************/
+/*                           ZarrAttribute()                            */
+/************************************************************************/
+
+ZarrAttribute::ZarrAttribute(const std::string& osParentName,
+                             const std::string& osName,
+                             GUInt64 nDimSize,
+                             const GDALExtendedDataType& oDataType,
+                             const std::shared_ptr<bool>& pbModified):
+    GDALAbstractMDArray(osParentName, osName),
+    GDALAttribute(osParentName, osName),
+    m_dt(oDataType),
+    m_pbModified(pbModified)
+{
+    size_t nValues = 1;
+    if( nDimSize > 0 )
+    {
+        m_dims.emplace_back(std::make_shared<GDALDimension>(
+            std::string(), "dim0", std::string(), std::string(), nDimSize));
+        nValues = static_cast<size_t>(nDimSize);
+    }
+    if( m_dt.GetClass() == GEDTC_STRING )
+        m_aosValues.resize(nValues);
+    else
+        m_adfValues.resize(nValues);
+}
+
+/************************************************************************/
+/*                               Create()                               */
+/************************************************************************/
+
+std::shared_ptr<ZarrAttribute> ZarrAttribute::Create(
+                  const std::string& osParentName,
+                  const std::string& osName,
+                  GUInt64 nDimSize,
+                  const GDALExtendedDataType& oDataType,
+                  const std::shared_ptr<bool>& pbModified)
+{
+    auto poAttr(std::shared_ptr<ZarrAttribute>(
+        new ZarrAttribute(osParentName, osName, nDimSize, oDataType,
+                          pbModified)));
+    poAttr->SetSelf(poAttr);
+    return poAttr;
+}
+
+/************************************************************************/
+/*                           CreateFromJSON()                           */
+/************************************************************************/
+
+std::shared_ptr<ZarrAttribute> ZarrAttribute::CreateFromJSON(
+                  const std::string& osParentName,
+                  const std::string& osName,
+                  const CPLJSONObject& oValue,
+                  const std::shared_ptr<bool>& pbModified)
+{
+    const auto eType = oValue.GetType();
+    if( eType == CPLJSONObject::String )
+    {
+        auto poAttr = Create(osParentName, osName, 0,
+                             GDALExtendedDataType::CreateString(),
+                             pbModified);
+        poAttr->m_aosValues[0] = oValue.ToString();
+        return poAttr;
+    }
+    if( eType == CPLJSONObject::Integer )
+    {
+        auto poAttr = Create(osParentName, osName, 0,
+                             GDALExtendedDataType::Create(GDT_Int32),
+                             pbModified);
+        poAttr->m_adfValues[0] = oValue.ToInteger();
+        return poAttr;
+    }
+    if( eType == CPLJSONObject::Long || eType == CPLJSONObject::Double )
+    {
+        auto poAttr = Create(osParentName, osName, 0,
+                             GDALExtendedDataType::Create(GDT_Float64),
+                             pbModified);
+        poAttr->m_adfValues[0] = eType == CPLJSONObject::Long ?
+            static_cast<double>(oValue.ToLong()) : oValue.ToDouble();
+        return poAttr;
+    }
+    if( eType == CPLJSONObject::Array )
+    {
+        const auto oArray = oValue.ToArray();
+        const int nSize = oArray.Size();
+        bool bAllStrings = nSize > 0;
+        bool bAllNumbers = nSize > 0;
+        bool bAllInt32 = nSize > 0;
+        for( int i = 0; i < nSize; ++i )
+        {
+            const auto eItemType = oArray[i].GetType();
+            bAllStrings &= eItemType == CPLJSONObject::String;
+            bAllNumbers &= eItemType == CPLJSONObject::Integer ||
+                           eItemType == CPLJSONObject::Long ||
+                           eItemType == CPLJSONObject::Double;
+            bAllInt32 &= eItemType == CPLJSONObject::Integer;
+        }
+        if( bAllStrings || bAllNumbers )
+        {
+            auto poAttr = Create(
+                osParentName, osName, nSize,
+                bAllStrings ? GDALExtendedDataType::CreateString() :
+                bAllInt32 ? GDALExtendedDataType::Create(GDT_Int32) :
+                            GDALExtendedDataType::Create(GDT_Float64),
+                pbModified);
+            for( int i = 0; i < nSize; ++i )
+            {
+                if( bAllStrings )
+                    poAttr->m_aosValues[i] = oArray[i].ToString();
+                else if( oArray[i].GetType() == CPLJSONObject::Long )
+                    poAttr->m_adfValues[i] =
+                        static_cast<double>(oArray[i].ToLong());
+                else
+                    poAttr->m_adfValues[i] = oArray[i].ToDouble();
+            }
+            return poAttr;
+        }
+    }
+
+    // Objects, booleans, null and heterogeneous arrays are exposed as their
+    // JSON serialization, and saved back unchanged if not modified.
+    auto poAttr = Create(osParentName, osName, 0,
+                         GDALExtendedDataType::CreateString(), pbModified);
+    poAttr->m_aosValues[0] = eType == CPLJSONObject::Null ?
+        std::string("null") : oValue.Format(CPLJSONObject::Plain);
+    poAttr->m_oJSONValue = oValue;
+    poAttr->m_bIsJSONValue = true;
+    return poAttr;
+}
+
+/************************************************************************/
+/*                              AddToJSON()                             */
+/************************************************************************/
+
+void ZarrAttribute::AddToJSON(CPLJSONObject& oParent) const
+{
+    const auto& osName = GetName();
+    if( m_bIsJSONValue )
+    {
+        oParent.Add(osName, m_oJSONValue);
+        return;
+    }
+
+    const bool bString = m_dt.GetClass() == GEDTC_STRING;
+    const bool bInteger = !bString &&
+        GDALDataTypeIsInteger(m_dt.GetNumericDataType());
+    const auto AddValue = [bInteger](CPLJSONArray& oArray, double dfVal)
+    {
+        if( bInteger )
+            oArray.Add(static_cast<GInt64>(dfVal));
+        else
+            oArray.Add(dfVal);
+    };
+    if( m_dims.empty() )
+    {
+        if( bString )
+            oParent.Add(osName, m_aosValues[0]);
+        else if( bInteger )
+            oParent.Add(osName, static_cast<GInt64>(m_adfValues[0]));
+        else
+            oParent.Add(osName, m_adfValues[0]);
+    }
+    else
+    {
+        CPLJSONArray oArray;
+        if( bString )
+        {
+            for( const auto& osVal: m_aosValues )
+                oArray.Add(osVal);
+        }
+        else
+        {
+            for( const double dfVal: m_adfValues )
+                AddValue(oArray, dfVal);
+        }
+        oParent.Add(osName, oArray);
+    }
+}
+
+/************************************************************************/
+/*                                IRead()                               */
+/************************************************************************/
+
+bool ZarrAttribute::IRead(const GUInt64* arrayStartIdx,
+                          const size_t* count,
+                          const GInt64* arrayStep,
+                          const GPtrDiff_t* bufferStride,
+                          const GDALExtendedDataType& bufferDataType,
+                          void* pDstBuffer) const
+{
+    const bool bString = m_dt.GetClass() == GEDTC_STRING;
+    const auto oSrcType = bString ? GDALExtendedDataType::CreateString() :
+                                    GDALExtendedDataType::Create(GDT_Float64);
+    const size_t nCount = m_dims.empty() ? 1 : count[0];
+    size_t nIdx = m_dims.empty() ? 0 : static_cast<size_t>(arrayStartIdx[0]);
+    GByte* pabyDst = static_cast<GByte*>(pDstBuffer);
+    for( size_t i = 0; i < nCount; ++i )
+    {
+        if( bString )
+        {
+            const char* pszVal = m_aosValues[nIdx].c_str();
+            if( !GDALExtendedDataType::CopyValue(&pszVal, oSrcType,
+                                                 pabyDst, bufferDataType) )
+                return false;
+        }
+        else if( !GDALExtendedDataType::CopyValue(&m_adfValues[nIdx], oSrcType,
+                                                  pabyDst, bufferDataType) )
+        {
+            return false;
+        }
+        if( !m_dims.empty() )
+        {
+            nIdx = static_cast<size_t>(nIdx + arrayStep[0]);
+            pabyDst += bufferStride[0] *
+                       static_cast<GPtrDiff_t>(bufferDataType.GetSize());
+        }
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                               IWrite()                               */
+/************************************************************************/
+
+bool ZarrAttribute::IWrite(const GUInt64* arrayStartIdx,
+                           const size_t* count,
+                           const GInt64* arrayStep,
+                           const GPtrDiff_t* bufferStride,
+                           const GDALExtendedDataType& bufferDataType,
+                           const void* pSrcBuffer)
+{
+    const bool bString = m_dt.GetClass() == GEDTC_STRING;
+    const auto oDstType = bString ? GDALExtendedDataType::CreateString() :
+                                    GDALExtendedDataType::Create(GDT_Float64);
+    const size_t nCount = m_dims.empty() ? 1 : count[0];
+    size_t nIdx = m_dims.empty() ? 0 : static_cast<size_t>(arrayStartIdx[0]);
+    const GByte* pabySrc = static_cast<const GByte*>(pSrcBuffer);
+    for( size_t i = 0; i < nCount; ++i )
+    {
+        if( bString )
+        {
+            char* pszVal = nullptr;
+            if( !GDALExtendedDataType::CopyValue(pabySrc, bufferDataType,
+                                                 &pszVal, oDstType) )
+                return false;
+            m_aosValues[nIdx] = pszVal ? pszVal : "";
+            CPLFree(pszVal);
+        }
+        else if( !GDALExtendedDataType::CopyValue(pabySrc, bufferDataType,
+                                                  &m_adfValues[nIdx], oDstType) )
+        {
+            return false;
+        }
+        if( !m_dims.empty() )
+        {
+            nIdx = static_cast<size_t>(nIdx + arrayStep[0]);
+            pabySrc += bufferStride[0] *
+                       static_cast<GPtrDiff_t>(bufferDataType.GetSize());
+        }
+    }
+    m_bIsJSONValue = false;
+    *m_pbModified = true;
+    return true;
+}
+
+/************************************************************************/
+/*                     ZarrAttributeGroup::Init()                       */
+/************************************************************************/
+
+void ZarrAttributeGroup::Init(const CPLJSONObject& oAttributes,
+                              const std::vector<std::string>& aosHiddenNames)
+{
+    if( oAttributes.GetType() != CPLJSONObject::Object )
+        return;
+    for( const auto& oItem: oAttributes.GetChildren() )
+    {
+        const auto osName = oItem.GetName();
+        if( std::find(aosHiddenNames.begin(), aosHiddenNames.end(), osName) !=
+                aosHiddenNames.end() )
+        {
+            continue;
+        }
+        m_apoAttributes.emplace_back(ZarrAttribute::CreateFromJSON(
+            m_osParentName, osName, oItem, m_pbModified));
+    }
+}
+
+/************************************************************************/
+/*                 ZarrAttributeGroup::GetAttribute()                   */
+/************************************************************************/
+
+std::shared_ptr<GDALAttribute> ZarrAttributeGroup::GetAttribute(
+                                            const std::string& osName) const
+{
+    for( const auto& poAttr: m_apoAttributes )
+    {
+        if( poAttr->GetName() == osName )
+            return poAttr;
+    }
+    return nullptr;
+}
+
+/************************************************************************/
+/*                 ZarrAttributeGroup::GetAttributes()                  */
+/************************************************************************/
+
+std::vector<std::shared_ptr<GDALAttribute>>
+                                ZarrAttributeGroup::GetAttributes() const
+{
+    return std::vector<std::shared_ptr<GDALAttribute>>(m_apoAttributes.begin(),
+                                                       m_apoAttributes.end());
+}
+
+/************************************************************************/
+/*                ZarrAttributeGroup::CreateAttribute()                 */
+/************************************************************************/
+
+std::shared_ptr<GDALAttribute> ZarrAttributeGroup::CreateAttribute(
+        const std::string& osName,
+        const std::vector<GUInt64>& anDimensions,
+        const GDALExtendedDataType& oDataType)
+{
+    if( GetAttribute(osName) )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "An attribute with same name already exists");
+        return nullptr;
+    }
+    if( anDimensions.size() > 1 ||
+        (anDimensions.size() == 1 && anDimensions[0] == 0) )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "Only scalar or non-empty 1D attributes are supported");
+        return nullptr;
+    }
+    if( oDataType.GetClass() == GEDTC_COMPOUND ||
+        (oDataType.GetClass() == GEDTC_NUMERIC &&
+         GDALDataTypeIsComplex(oDataType.GetNumericDataType())) )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "Only string or non-complex numeric attributes are supported");
+        return nullptr;
+    }
+    auto poAttr = ZarrAttribute::Create(
+        m_osParentName, osName, anDimensions.empty() ? 0 : anDimensions[0],
+        oDataType, m_pbModified);
+    m_apoAttributes.emplace_back(poAttr);
+    *m_pbModified = true;
+    return poAttr;
+}
+
+/************************************************************************/
+/*                   ZarrAttributeGroup::Serialize()                    */
+/************************************************************************/
+
+CPLJSONObject ZarrAttributeGroup::Serialize() const
+{
+    CPLJSONObject oAttributes;
+    for( const auto& poAttr: m_apoAttributes )
+        poAttr->AddToJSON(oAttributes);
+    return oAttributes;
+}
@@ -0,0 +1,474 @@
+/******************************************************************************
+ *
+ * Project:  GDAL
+ * Purpose:  Zarr driver
+ *
+ ******************************************************************************
+ * Copyright (c) 2020, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "zarr.h"
+
+#include <algorithm>
+
+CPL_CVSID("$Id$")
+
+/************************************************************************/
+/*                             ZarrGroup()                              */
+/************************************************************************/
+
+ZarrGroup::ZarrGroup(const std::shared_ptr<ZarrSharedResource>& poShared,
+                     const std::string& osParentName,
+                     const std::string& osName,
+                     const std::string& osDirectoryName,
+                     bool bUpdatable):
+    GDALGroup(osParentName, osName),
+    m_poShared(poShared),
+    m_osDirectoryName(osDirectoryName),
+    m_bUpdatable(bUpdatable),
+    m_oAttrGroup(osParentName.empty() ? std::string("/") :
+                 osParentName == "/" ? "/" + osName :
+                 osParentName + "/" + osName)
+{
+}
+
+/************************************************************************/
+/*                               Create()                               */
+/************************************************************************/
+
+std::shared_ptr<ZarrGroup> ZarrGroup::Create(
+              const std::shared_ptr<ZarrSharedResource>& poShared,
+              const std::string& osParentName,
+              const std::string& osName,
+              const std::string& osDirectoryName,
+              bool bUpdatable)
+{
+    auto poGroup(std::shared_ptr<ZarrGroup>(
+        new ZarrGroup(poShared, osParentName, osName, osDirectoryName,
+                      bUpdatable)));
+    poGroup->m_pSelf = poGroup;
+    return poGroup;
+}
+
+/************************************************************************/
+/*                            ~ZarrGroup()                              */
+/************************************************************************/
+
+ZarrGroup::~ZarrGroup()
+{
+    if( m_bUpdatable && m_oAttrGroup.IsModified() )
+    {
+        ZarrWriteJSONFile(
+            CPLFormFilename(m_osDirectoryName.c_str(), ".zattrs", nullptr),
+            m_oAttrGroup.Serialize());
+    }
+}
+
+/************************************************************************/
+/*                          ExploreDirectory()                          */
+/************************************************************************/
+
+void ZarrGroup::ExploreDirectory() const
+{
+    if( m_bDirectoryExplored )
+        return;
+    m_bDirectoryExplored = true;
+
+    VSIStatBufL sStat;
+    if( GetFullName() == "/" &&
+        VSIStatL(CPLFormFilename(m_osDirectoryName.c_str(), ".zarray",
+                                 nullptr), &sStat) == 0 )
+    {
+        // The dataset is a single array
+        m_bIsArrayDirectory = true;
+        m_aosArrays.emplace_back(CPLGetFilename(m_osDirectoryName.c_str()));
+        return;
+    }
+
+    const CPLStringList aosFiles(VSIReadDir(m_osDirectoryName.c_str()));
+    for( int i = 0; i < aosFiles.size(); ++i )
+    {
+        const char* pszName = aosFiles[i];
+        if( pszName[0] == '.' )
+            continue;
+        const std::string osSubDir(
+            CPLFormFilename(m_osDirectoryName.c_str(), pszName, nullptr));
+        if( VSIStatL(CPLFormFilename(osSubDir.c_str(), ".zarray", nullptr),
+                     &sStat) == 0 )
+        {
+            m_aosArrays.emplace_back(pszName);
+        }
+        else if( VSIStatL(CPLFormFilename(osSubDir.c_str(), ".zgroup",
+                                          nullptr), &sStat) == 0 )
+        {
+            m_aosGroups.emplace_back(pszName);
+        }
+    }
+    std::sort(m_aosArrays.begin(), m_aosArrays.end());
+    std::sort(m_aosGroups.begin(), m_aosGroups.end());
+}
+
+/************************************************************************/
+/*                           LoadAttributes()                           */
+/************************************************************************/
+
+void ZarrGroup::LoadAttributes() const
+{
+    if( m_bAttributesLoaded )
+        return;
+    m_bAttributesLoaded = true;
+
+    const std::string osZattrsFilename(
+        CPLFormFilename(m_osDirectoryName.c_str(), ".zattrs", nullptr));
+    VSIStatBufL sStat;
+    CPLJSONDocument oDoc;
+    if( VSIStatL(osZattrsFilename.c_str(), &sStat) == 0 &&
+        oDoc.Load(osZattrsFilename) )
+    {
+        m_oAttrGroup.Init(oDoc.GetRoot(), std::vector<std::string>());
+    }
+}
+
+/************************************************************************/
+/*                          GetMDArrayNames()                           */
+/************************************************************************/
+
+std::vector<std::string> ZarrGroup::GetMDArrayNames(CSLConstList) const
+{
+    ExploreDirectory();
+    return m_aosArrays;
+}
+
+/************************************************************************/
+/*                            OpenMDArray()                             */
+/************************************************************************/
+
+std::shared_ptr<GDALMDArray> ZarrGroup::OpenMDArray(const std::string& osName,
+                                                    CSLConstList) const
+{
+    auto oIter = m_oMapMDArrays.find(osName);
+    if( oIter != m_oMapMDArrays.end() )
+        return oIter->second;
+
+    ExploreDirectory();
+    if( std::find(m_aosArrays.begin(), m_aosArrays.end(), osName) ==
+            m_aosArrays.end() )
+    {
+        return nullptr;
+    }
+    const std::string osArrayDir = m_bIsArrayDirectory ? m_osDirectoryName :
+        std::string(CPLFormFilename(m_osDirectoryName.c_str(),
+                                    osName.c_str(), nullptr));
+    auto poArray = ZarrArray::Open(m_poShared, this, osName, osArrayDir,
+                                   m_bUpdatable);
+    if( !poArray )
+        return nullptr;
+    // Store the array before resolving indexing variables, which may
+    // re-enter OpenMDArray()
+    m_oMapMDArrays[osName] = poArray;
+
+    for( const auto& poDim: poArray->GetDimensions() )
+    {
+        if( poDim->GetIndexingVariable() ||
+            m_oMapDimensions.find(poDim->GetName()) == m_oMapDimensions.end() )
+        {
+            continue;
+        }
+        std::shared_ptr<GDALMDArray> poIndexingVar;
+        if( poDim->GetName() == osName )
+            poIndexingVar = poArray;
+        else
+            poIndexingVar = OpenMDArray(poDim->GetName());
+        if( poIndexingVar && poIndexingVar->GetDimensionCount() == 1 &&
+            poIndexingVar->GetDimensions()[0]->GetName() == poDim->GetName() )
+        {
+            poDim->SetIndexingVariable(poIndexingVar);
+        }
+    }
+    return poArray;
+}
+
+/************************************************************************/
+/*                           GetGroupNames()                            */
+/************************************************************************/
+
+std::vector<std::string> ZarrGroup::GetGroupNames(CSLConstList) const
+{
+    ExploreDirectory();
+    return m_aosGroups;
+}
+
+/************************************************************************/
+/*                             OpenGroup()                              */
+/************************************************************************/
+
+std::shared_ptr<GDALGroup> ZarrGroup::OpenGroup(const std::string& osName,
+                                                CSLConstList) const
+{
+    auto oIter = m_oMapGroups.find(osName);
+    if( oIter != m_oMapGroups.end() )
+        return oIter->second;
+
+    ExploreDirectory();
+    if( std::find(m_aosGroups.begin(), m_aosGroups.end(), osName) ==
+            m_aosGroups.end() )
+    {
+        return nullptr;
+    }
+    auto poGroup = Create(m_poShared, GetFullName(), osName,
+                          CPLFormFilename(m_osDirectoryName.c_str(),
+                                          osName.c_str(), nullptr),
+                          m_bUpdatable);
+    m_oMapGroups[osName] = poGroup;
+    return poGroup;
+}
+
+/************************************************************************/
+/*                        GetOrCreateDimension()                        */
+/************************************************************************/
+
+// Dimensions are only known by their name in the _ARRAY_DIMENSIONS
+// attribute of arrays, so they are shared by the arrays of a group.
+std::shared_ptr<GDALDimension> ZarrGroup::GetOrCreateDimension(
+                                                const std::string& osName,
+                                                GUInt64 nSize) const
+{
+    auto oIter = m_oMapDimensions.find(osName);
+    if( oIter != m_oMapDimensions.end() && oIter->second->GetSize() == nSize )
+        return oIter->second;
+    auto poDim(std::make_shared<GDALDimensionWeakIndexingVar>(
+        GetFullName(), osName, std::string(), std::string(), nSize));
+    // Keep the first declaration if sizes are inconsistent
+    if( oIter == m_oMapDimensions.end() )
+        m_oMapDimensions[osName] = poDim;
+    return poDim;
+}
+
+/************************************************************************/
+/*                           GetDimensions()                            */
+/************************************************************************/
+
+std::vector<std::shared_ptr<GDALDimension>> ZarrGroup::GetDimensions(
+                                                        CSLConstList) const
+{
+    // Dimensions are discovered by opening the arrays
+    for( const auto& osName: GetMDArrayNames() )
+        OpenMDArray(osName);
+
+    std::vector<std::shared_ptr<GDALDimension>> apoDims;
+    for( const auto& oIter: m_oMapDimensions )
+        apoDims.push_back(oIter.second);
+    return apoDims;
+}
+
+/************************************************************************/
+/*                            GetAttribute()                            */
+/************************************************************************/
+
+std::shared_ptr<GDALAttribute> ZarrGroup::GetAttribute(
+                                        const std::string& osName) const
+{
+    LoadAttributes();
+    return m_oAttrGroup.GetAttribute(osName);
+}
+
+/************************************************************************/
+/*                           GetAttributes()                            */
+/************************************************************************/
+
+std::vector<std::shared_ptr<GDALAttribute>> ZarrGroup::GetAttributes(
+                                                        CSLConstList) const
+{
+    LoadAttributes();
+    return m_oAttrGroup.GetAttributes();
+}
+
+/************************************************************************/
+/*                            CreateGroup()                             */
+/************************************************************************/
+
+std::shared_ptr<GDALGroup> ZarrGroup::CreateGroup(const std::string& osName,
+                                                  CSLConstList)
+{
+    if( !m_bUpdatable )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "Dataset not open in update mode");
+        return nullptr;
+    }
+    ExploreDirectory();
+    if( osName.empty() || osName[0] == '.' ||
+        osName.find('/') != std::string::npos || m_bIsArrayDirectory )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported, "Invalid group name");
+        return nullptr;
+    }
+    if( std::find(m_aosGroups.begin(), m_aosGroups.end(), osName) !=
+            m_aosGroups.end() ||
+        std::find(m_aosArrays.begin(), m_aosArrays.end(), osName) !=
+            m_aosArrays.end() )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "A group or array with same name already exists");
+        return nullptr;
+    }
+
+    const std::string osDirectoryName(
+        CPLFormFilename(m_osDirectoryName.c_str(), osName.c_str(), nullptr));
+    if( VSIMkdir(osDirectoryName.c_str(), 0755) != 0 )
+    {
+        CPLError(CE_Failure, CPLE_FileIO,
+                 "Cannot create directory %s", osDirectoryName.c_str());
+        return nullptr;
+    }
+    CPLJSONObject oZgroup;
+    oZgroup.Add("zarr_format", 2);
+    if( !ZarrWriteJSONFile(
+            CPLFormFilename(osDirectoryName.c_str(), ".zgroup", nullptr),
+            oZgroup) )
+    {
+        return nullptr;
+    }
+
+    auto poGroup = Create(m_poShared, GetFullName(), osName,
+                          osDirectoryName, true);
+    m_aosGroups.emplace_back(osName);
+    m_oMapGroups[osName] = poGroup;
+    return poGroup;
+}
+
+/************************************************************************/
+/*                          CreateDimension()                           */
+/************************************************************************/
+
+std::shared_ptr<GDALDimension> ZarrGroup::CreateDimension(
+                                            const std::string& osName,
+                                            const std::string& osType,
+                                            const std::string& osDirection,
+                                            GUInt64 nSize,
+                                            CSLConstList)
+{
+    if( !m_bUpdatable )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "Dataset not open in update mode");
+        return nullptr;
+    }
+    if( osName.empty() )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "Empty dimension name not supported");
+        return nullptr;
+    }
+    if( m_oMapDimensions.find(osName) != m_oMapDimensions.end() )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "A dimension with same name already exists");
+        return nullptr;
+    }
+    auto poDim(std::make_shared<GDALDimensionWeakIndexingVar>(
+        GetFullName(), osName, osType, osDirection, nSize));
+    m_oMapDimensions[osName] = poDim;
+    return poDim;
+}
+
+/************************************************************************/
+/*                           CreateMDArray()                            */
+/************************************************************************/
+
+std::shared_ptr<GDALMDArray> ZarrGroup::CreateMDArray(
+                const std::string& osName,
+                const std::vector<std::shared_ptr<GDALDimension>>& aoDimensions,
+                const GDALExtendedDataType& oDataType,
+                CSLConstList papszOptions)
+{
+    if( !m_bUpdatable )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "Dataset not open in update mode");
+        return nullptr;
+    }
+    ExploreDirectory();
+    if( osName.empty() || osName[0] == '.' ||
+        osName.find('/') != std::string::npos || m_bIsArrayDirectory )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported, "Invalid array name");
+        return nullptr;
+    }
+    if( std::find(m_aosGroups.begin(), m_aosGroups.end(), osName) !=
+            m_aosGroups.end() ||
+        std::find(m_aosArrays.begin(), m_aosArrays.end(), osName) !=
+            m_aosArrays.end() )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "A group or array with same name already exists");
+        return nullptr;
+    }
+
+    // Use the dimensions of this group, so that they can be shared
+    std::vector<std::shared_ptr<GDALDimension>> aoDims;
+    for( const auto& poDim: aoDimensions )
+    {
+        auto oIter = m_oMapDimensions.find(poDim->GetName());
+        if( oIter != m_oMapDimensions.end() &&
+            oIter->second->GetSize() == poDim->GetSize() )
+        {
+            aoDims.push_back(oIter->second);
+        }
+        else
+        {
+            aoDims.push_back(
+                GetOrCreateDimension(poDim->GetName(), poDim->GetSize()));
+        }
+    }
+
+    auto poArray = ZarrArray::CreateNew(
+        m_poShared, GetFullName(), osName,
+        CPLFormFilename(m_osDirectoryName.c_str(), osName.c_str(), nullptr),
+        aoDims, oDataType, papszOptions);
+    if( !poArray )
+        return nullptr;
+    m_aosArrays.emplace_back(osName);
+    m_oMapMDArrays[osName] = poArray;
+    if( aoDims.size() == 1 && aoDims[0]->GetName() == osName )
+        aoDims[0]->SetIndexingVariable(poArray);
+    return poArray;
+}
+
+/************************************************************************/
+/*                          CreateAttribute()                           */
+/************************************************************************/
+
+std::shared_ptr<GDALAttribute> ZarrGroup::CreateAttribute(
+        const std::string& osName,
+        const std::vector<GUInt64>& anDimensions,
+        const GDALExtendedDataType& oDataType,
+        CSLConstList)
+{
+    if( !m_bUpdatable )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "Dataset not open in update mode");
+        return nullptr;
+    }
+    LoadAttributes();
+    return m_oAttrGroup.CreateAttribute(osName, anDimensions, oDataType);
+}
@@ -0,0 +1,390 @@
+/******************************************************************************
+ *
+ * Project:  GDAL
+ * Purpose:  Zarr driver
+ *
+ ******************************************************************************
+ * Copyright (c) 2020, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "zarr.h"
+
+#include "gdal_frmts.h"
+
+#include <algorithm>
+
+CPL_CVSID("$Id$")
+
+/************************************************************************/
+/*                          ZarrWriteJSONFile()                         */
+/************************************************************************/
+
+bool ZarrWriteJSONFile(const std::string& osFilename,
+                       const CPLJSONObject& oObj)
+{
+    VSILFILE* fp = VSIFOpenL(osFilename.c_str(), "wb");
+    if( fp == nullptr )
+    {
+        CPLError(CE_Failure, CPLE_FileIO,
+                 "Cannot create %s", osFilename.c_str());
+        return false;
+    }
+    const std::string osContent = oObj.Format(CPLJSONObject::Pretty);
+    bool bOK = VSIFWriteL(osContent.data(), 1, osContent.size(), fp) ==
+                    osContent.size();
+    bOK = VSIFCloseL(fp) == 0 && bOK;
+    if( !bOK )
+    {
+        CPLError(CE_Failure, CPLE_FileIO,
+                 "Cannot write %s", osFilename.c_str());
+    }
+    return bOK;
+}
+
+/************************************************************************/
+/*                    ZarrSharedResource::GetThreadPool()               */
+/************************************************************************/
+
+// The pool is created on the first request that spans several chunks
+CPLWorkerThreadPool* ZarrSharedResource::GetThreadPool()
+{
+    if( m_nThreads <= 1 )
+        return nullptr;
+    std::lock_guard<std::mutex> oLock(m_oMutex);
+    if( !m_poThreadPool )
+    {
+        m_poThreadPool.reset(new CPLWorkerThreadPool());
+        if( !m_poThreadPool->Setup(m_nThreads, nullptr, nullptr) )
+        {
+            m_poThreadPool.reset();
+            m_nThreads = 1;
+        }
+    }
+    return m_poThreadPool.get();
+}
+
+/************************************************************************/
+/*                            ZarrDataset()                             */
+/************************************************************************/
+
+ZarrDataset::ZarrDataset(const std::shared_ptr<GDALGroup>& poRootGroup):
+    m_poRootGroup(poRootGroup)
+{
+}
+
+/************************************************************************/
+/*                             GetMetadata()                            */
+/************************************************************************/
+
+char** ZarrDataset::GetMetadata( const char* pszDomain )
+{
+    if( pszDomain != nullptr && EQUAL(pszDomain, "SUBDATASETS") )
+        return m_aosSubdatasets.List();
+    return GDALDataset::GetMetadata(pszDomain);
+}
+
+/************************************************************************/
+/*                              Identify()                              */
+/************************************************************************/
+
+int ZarrDataset::Identify( GDALOpenInfo* poOpenInfo )
+{
+    if( STARTS_WITH(poOpenInfo->pszFilename, "ZARR:") )
+        return TRUE;
+    if( !poOpenInfo->bIsDirectory )
+        return FALSE;
+
+    VSIStatBufL sStat;
+    return VSIStatL(CPLFormFilename(poOpenInfo->pszFilename, ".zgroup",
+                                    nullptr), &sStat) == 0 ||
+           VSIStatL(CPLFormFilename(poOpenInfo->pszFilename, ".zarray",
+                                    nullptr), &sStat) == 0;
+}
+
+/************************************************************************/
+/*                            GetNumThreads()                           */
+/************************************************************************/
+
+static int GetNumThreads(GDALOpenInfo* poOpenInfo)
+{
+    return CPLGetNumThreadsOption(
+        CSLFetchNameValue(poOpenInfo->papszOpenOptions, "NUM_THREADS"),
+        "ALL_CPUS");
+}
+
+/************************************************************************/
+/*                          CollectArrays()                             */
+/************************************************************************/
+
+// Collect recursively the arrays of at least 2 dimensions
+static void CollectArrays(const std::shared_ptr<GDALGroup>& poGroup,
+                          std::vector<std::shared_ptr<GDALMDArray>>& apoArrays)
+{
+    for( const auto& osName: poGroup->GetMDArrayNames() )
+    {
+        auto poArray = poGroup->OpenMDArray(osName);
+        if( poArray && poArray->GetDimensionCount() >= 2 )
+            apoArrays.push_back(poArray);
+    }
+    for( const auto& osName: poGroup->GetGroupNames() )
+    {
+        auto poSubGroup = poGroup->OpenGroup(osName);
+        if( poSubGroup )
+            CollectArrays(poSubGroup, apoArrays);
+    }
+}
+
+/************************************************************************/
+/*                         OpenArrayFromPath()                          */
+/************************************************************************/
+
+static std::shared_ptr<GDALMDArray> OpenArrayFromPath(
+                                    const std::shared_ptr<GDALGroup>& poRoot,
+                                    const std::string& osPath)
+{
+    const CPLStringList aosTokens(
+        CSLTokenizeString2(osPath.c_str(), "/", 0));
+    if( aosTokens.empty() )
+        return nullptr;
+    auto poGroup = poRoot;
+    for( int i = 0; poGroup && i < aosTokens.size() - 1; ++i )
+        poGroup = poGroup->OpenGroup(aosTokens[i]);
+    if( !poGroup )
+        return nullptr;
+    return poGroup->OpenMDArray(aosTokens[aosTokens.size() - 1]);
+}
+
+/************************************************************************/
+/*                                Open()                                */
+/************************************************************************/
+
+GDALDataset* ZarrDataset::Open( GDALOpenInfo* poOpenInfo )
+{
+    if( !Identify(poOpenInfo) )
+        return nullptr;
+
+    // ZARR:"directory":/path/to/array
+    std::string osDirectoryName(poOpenInfo->pszFilename);
+    std::string osArrayPath;
+    if( STARTS_WITH(poOpenInfo->pszFilename, "ZARR:") )
+    {
+        const CPLStringList aosTokens(
+            CSLTokenizeString2(poOpenInfo->pszFilename, ":",
+                               CSLT_HONOURSTRINGS));
+        if( aosTokens.size() < 2 || aosTokens.size() > 3 )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "Invalid syntax. Should be ZARR:\"directory\"[:/array]");
+            return nullptr;
+        }
+        osDirectoryName = aosTokens[1];
+        if( aosTokens.size() == 3 )
+            osArrayPath = aosTokens[2];
+        VSIStatBufL sStat;
+        if( VSIStatL(osDirectoryName.c_str(), &sStat) != 0 ||
+            !VSI_ISDIR(sStat.st_mode) )
+        {
+            CPLError(CE_Failure, CPLE_OpenFailed,
+                     "%s is not a directory", osDirectoryName.c_str());
+            return nullptr;
+        }
+    }
+
+    auto poShared(std::make_shared<ZarrSharedResource>(
+        GetNumThreads(poOpenInfo)));
+    auto poRootGroup = ZarrGroup::Create(poShared, std::string(), "/",
+                                         osDirectoryName,
+                                         poOpenInfo->eAccess == GA_Update);
+
+    if( poOpenInfo->nOpenFlags & GDAL_OF_MULTIDIM_RASTER )
+    {
+        auto poDS = new ZarrDataset(poRootGroup);
+        poDS->eAccess = poOpenInfo->eAccess;
+        return poDS;
+    }
+
+    // Classic raster mode: expose the 2 last dimensions of an array
+    std::shared_ptr<GDALMDArray> poArray;
+    if( !osArrayPath.empty() )
+    {
+        poArray = OpenArrayFromPath(poRootGroup, osArrayPath);
+        if( !poArray )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "Cannot find array %s", osArrayPath.c_str());
+            return nullptr;
+        }
+        if( poArray->GetDimensionCount() < 2 )
+        {
+            CPLError(CE_Failure, CPLE_NotSupported,
+                     "Array %s has less than 2 dimensions",
+                     osArrayPath.c_str());
+            return nullptr;
+        }
+    }
+    else
+    {
+        std::vector<std::shared_ptr<GDALMDArray>> apoArrays;
+        CollectArrays(poRootGroup, apoArrays);
+        if( apoArrays.empty() )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "No array of at least 2 dimensions found");
+            return nullptr;
+        }
+        if( apoArrays.size() > 1 )
+        {
+            auto poDS = new ZarrDataset(poRootGroup);
+            poDS->eAccess = poOpenInfo->eAccess;
+            int iSubDS = 1;
+            for( const auto& poSubArray: apoArrays )
+            {
+                poDS->m_aosSubdatasets.SetNameValue(
+                    CPLSPrintf("SUBDATASET_%d_NAME", iSubDS),
+                    CPLSPrintf("ZARR:\"%s\":%s", osDirectoryName.c_str(),
+                               poSubArray->GetFullName().c_str()));
+                std::string osDesc("[");
+                for( const auto& poDim: poSubArray->GetDimensions() )
+                {
+                    if( osDesc.size() > 1 )
+                        osDesc += 'x';
+                    osDesc += CPLSPrintf(CPL_FRMT_GUIB,
+                        static_cast<GUIntBig>(poDim->GetSize()));
+                }
+                osDesc += "] ";
+                osDesc += poSubArray->GetFullName();
+                osDesc += " (";
+                osDesc += GDALGetDataTypeName(
+                    poSubArray->GetDataType().GetNumericDataType());
+                osDesc += ')';
+                poDS->m_aosSubdatasets.SetNameValue(
+                    CPLSPrintf("SUBDATASET_%d_DESC", iSubDS), osDesc.c_str());
+                ++iSubDS;
+            }
+            return poDS;
+        }
+        poArray = apoArrays[0];
+    }
+
+    const size_t nDims = poArray->GetDimensionCount();
+    return poArray->AsClassicDataset(nDims - 1, nDims - 2);
+}
+
+/************************************************************************/
+/*                       CreateMultiDimensional()                       */
+/************************************************************************/
+
+GDALDataset* ZarrDataset::CreateMultiDimensional( const char * pszFilename,
+                                                  CSLConstList /* papszRootGroupOptions */,
+                                                  CSLConstList papszOptions )
+{
+    VSIStatBufL sStat;
+    if( VSIStatL(pszFilename, &sStat) == 0 )
+    {
+        CPLError(CE_Failure, CPLE_FileIO,
+                 "%s already exists", pszFilename);
+        return nullptr;
+    }
+    if( VSIMkdir(pszFilename, 0755) != 0 )
+    {
+        CPLError(CE_Failure, CPLE_FileIO,
+                 "Cannot create directory %s", pszFilename);
+        return nullptr;
+    }
+    CPLJSONObject oZgroup;
+    oZgroup.Add("zarr_format", 2);
+    if( !ZarrWriteJSONFile(CPLFormFilename(pszFilename, ".zgroup", nullptr),
+                           oZgroup) )
+    {
+        return nullptr;
+    }
+
+    GDALOpenInfo oOpenInfo(pszFilename, GA_Update);
+    oOpenInfo.papszOpenOptions = const_cast<char**>(papszOptions);
+    auto poShared(std::make_shared<ZarrSharedResource>(
+        GetNumThreads(&oOpenInfo)));
+    oOpenInfo.papszOpenOptions = nullptr;
+    auto poRootGroup = ZarrGroup::Create(poShared, std::string(), "/",
+                                         pszFilename, true);
+    auto poDS = new ZarrDataset(poRootGroup);
+    poDS->eAccess = GA_Update;
+    poDS->SetDescription(pszFilename);
+    return poDS;
+}
+
+/************************************************************************/
+/*                          GDALRegister_Zarr()                         */
+/************************************************************************/
+
+void GDALRegister_Zarr()
+
+{
+    if( GDALGetDriverByName( "Zarr" ) != nullptr )
+        return;
+
+    GDALDriver *poDriver = new GDALDriver();
+
+    poDriver->SetDescription( "Zarr" );
+    poDriver->SetMetadataItem( GDAL_DCAP_RASTER, "YES" );
+    poDriver->SetMetadataItem( GDAL_DCAP_MULTIDIM_RASTER, "YES" );
+    poDriver->SetMetadataItem( GDAL_DMD_LONGNAME, "Zarr" );
+    poDriver->SetMetadataItem( GDAL_DMD_HELPTOPIC,
+                               "drivers/raster/zarr.html" );
+    poDriver->SetMetadataItem( GDAL_DCAP_VIRTUALIO, "YES" );
+    poDriver->SetMetadataItem( GDAL_DMD_SUBDATASETS, "YES" );
+
+    poDriver->SetMetadataItem( GDAL_DMD_OPENOPTIONLIST,
+"<OpenOptionList>"
+"   <Option name='NUM_THREADS' type='string' "
+    "description='Number of worker threads to decode chunks, or ALL_CPUS' "
+    "default='ALL_CPUS'/>"
+"</OpenOptionList>" );
+
+    poDriver->SetMetadataItem(GDAL_DMD_MULTIDIM_DATASET_CREATIONOPTIONLIST,
+"<MultiDimDatasetCreationOptionList>"
+"   <Option name='NUM_THREADS' type='string' "
+    "description='Number of worker threads to encode chunks, or ALL_CPUS' "
+    "default='ALL_CPUS'/>"
+"</MultiDimDatasetCreationOptionList>" );
+
+    poDriver->SetMetadataItem(GDAL_DMD_MULTIDIM_ARRAY_CREATIONOPTIONLIST,
+"<MultiDimArrayCreationOptionList>"
+"   <Option name='BLOCKSIZE' type='string' description='Comma separated list of chunk size along each dimension'/>"
+"   <Option name='COMPRESS' type='string-select' default='NONE'>"
+"     <Value>NONE</Value>"
+"     <Value>ZLIB</Value>"
+"     <Value>GZIP</Value>"
+#ifdef ZSTD_SUPPORT
+"     <Value>ZSTD</Value>"
+#endif
+"   </Option>"
+"   <Option name='ZLEVEL' type='int' description='ZLIB/GZIP compression level 1-9' default='6'/>"
+#ifdef ZSTD_SUPPORT
+"   <Option name='ZSTD_LEVEL' type='int' description='ZSTD compression level 1-22' default='9'/>"
+#endif
+"</MultiDimArrayCreationOptionList>" );
+
+    poDriver->pfnIdentify = ZarrDataset::Identify;
+    poDriver->pfnOpen = ZarrDataset::Open;
+    poDriver->pfnCreateMultiDimensional = ZarrDataset::CreateMultiDimensional;
+
+    GetGDALDriverManager()->RegisterDriver( poDriver );
+}
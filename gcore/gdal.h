@@ -324,6 +324,16 @@ typedef struct GDALDimensionHS* GDALDimensionH;
  */
 #define GDAL_DMD_EXTENSIONS "DMD_EXTENSIONS"
 
+/** List of (space separated) signatures of the files opened by the driver.
+ * Each signature is written as OFFSET:HEXBYTES, e.g. 0:89504E47 for bytes
+ * 0x89 0x50 0x4E 0x47 at the start of the file. When set, GDALOpenEx() only
+ * probes the driver on files that match one of them, or for which no header
+ * could be read. It must thus be set only by drivers that reject any file
+ * not matching them, and before the driver is registered.
+ * @since GDAL 3.1
+ */
+#define GDAL_DMD_OPEN_SIGNATURES "DMD_OPEN_SIGNATURES"
+
 /** XML snippet with creation options. */
 #define GDAL_DMD_CREATIONOPTIONLIST "DMD_CREATIONOPTIONLIST"
 
@@ -760,6 +770,23 @@ CPLErr CPL_DLL CPL_STDCALL GDALDatasetRasterIOEx(
     GSpacing nPixelSpace, GSpacing nLineSpace, GSpacing nBandSpace,
     GDALRasterIOExtraArg* psExtraArg) CPL_WARN_UNUSED_RESULT;
 
+/** Callback of GDALDatasetRasterIOAsync(), called when a request is
+ * completed.
+ * @since GDAL 3.1
+ */
+typedef void (*GDALRasterIOAsyncCallback)(CPLErr eErr, void* pUserData);
+
+CPLErr CPL_DLL GDALDatasetRasterIOAsync(
+    GDALDatasetH hDS,
+    int nDSXOff, int nDSYOff, int nDSXSize, int nDSYSize,
+    void * pBuffer, int nBXSize, int nBYSize, GDALDataType eBDataType,
+    int nBandCount, int *panBandMap,
+    GSpacing nPixelSpace, GSpacing nLineSpace, GSpacing nBandSpace,
+    GDALRasterIOExtraArg* psExtraArg,
+    GDALRasterIOAsyncCallback pfnCallback, void* pUserData);
+
+void CPL_DLL GDALDatasetWaitRasterIOAsync( GDALDatasetH hDS );
+
 CPLErr CPL_DLL CPL_STDCALL GDALDatasetAdviseRead( GDALDatasetH hDS,
     int nDSXOff, int nDSYOff, int nDSXSize, int nDSYSize,
     int nBXSize, int nBYSize, GDALDataType eBDataType,
@@ -1349,6 +1376,21 @@ CPLVirtualMem CPL_DLL* GDALGetVirtualMemAuto( GDALRasterBandH hBand,
                                               GIntBig *pnLineSpace,
                                               CSLConstList papszOptions ) CPL_WARN_UNUSED_RESULT;
 
+const void CPL_DLL* GDALGetDirectReadPointer( GDALRasterBandH hBand,
+                                              GSpacing *pnPixelSpace,
+                                              GSpacing *pnLineSpace );
+
+char CPL_DLL ** GDALGetRawBlockCodecInfo( GDALRasterBandH hBand,
+                                          int nXBlockOff, int nYBlockOff );
+CPLErr CPL_DLL GDALReadRawBlock( GDALRasterBandH hBand,
+                                 int nXBlockOff, int nYBlockOff,
+                                 void** ppData, size_t* pnDataSize,
+                                 char*** ppapszCodecInfo ) CPL_WARN_UNUSED_RESULT;
+CPLErr CPL_DLL GDALWriteRawBlock( GDALRasterBandH hBand,
+                                  int nXBlockOff, int nYBlockOff,
+                                  const void* pData, size_t nDataSize,
+                                  CSLConstList papszCodecInfo ) CPL_WARN_UNUSED_RESULT;
+
 /**! Enumeration to describe the tile organization */
 typedef enum
 {
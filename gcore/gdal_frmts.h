@@ -174,6 +174,7 @@ void CPL_DLL GDALRegister_E00GRID(void);
 void CPL_DLL GDALRegister_SNODAS(void);
 void CPL_DLL GDALRegister_WEBP(void);
 void CPL_DLL GDALRegister_ZMap(void);
+void CPL_DLL GDALRegister_Zarr(void);
 void CPL_DLL GDALRegister_NGSGEOID(void);
 void CPL_DLL GDALRegister_MBTiles(void);
 void CPL_DLL GDALRegister_ARG(void);
@@ -204,6 +205,17 @@ void CPL_DLL GDALRegister_DAAS(void);
 void CPL_DLL GDALRegister_COG(void);
 void CPL_DLL GDALRegister_RDB(void);
 void CPL_DLL GDALRegister_EXR(void);
+
+/* Metadata items set by the registration function of the drivers whose */
+/* registration GDALAllRegister() may defer, given to */
+/* GDALDriverManager::DeclareDeferredDriver(). */
+CSLConstList CPL_DLL GDALGetDeclaredMetadata_GTiff(void);
+CSLConstList CPL_DLL GDALGetDeclaredMetadata_COG(void);
+CSLConstList CPL_DLL GDALGetDeclaredMetadata_PNG(void);
+CSLConstList CPL_DLL GDALGetDeclaredMetadata_JPEG(void);
+CSLConstList CPL_DLL GDALGetDeclaredMetadata_GIF(void);
+CSLConstList CPL_DLL GDALGetDeclaredMetadata_BMP(void);
+CSLConstList CPL_DLL GDALGetDeclaredMetadata_WEBP(void);
 CPL_C_END
 
 #endif /* ndef GDAL_FRMTS_H_INCLUDED */
@@ -347,6 +347,7 @@ class CPL_DLL GDALDataset : public GDALMajorObject
     friend class GDALDefaultOverviews;
     friend class GDALProxyDataset;
     friend class GDALDriverManager;
+    friend class GDALDeferredDriver;
 
     CPL_INTERNAL void AddToDatasetOpenList();
 
@@ -546,6 +547,17 @@ class CPL_DLL GDALDataset : public GDALMajorObject
                          char **papszOptions);
     virtual void EndAsyncReader(GDALAsyncReader *);
 
+    CPLErr      RasterIOAsync( int nXOff, int nYOff, int nXSize, int nYSize,
+                               void *pData, int nBufXSize, int nBufYSize,
+                               GDALDataType eBufType,
+                               int nBandCount, int *panBandMap,
+                               GSpacing nPixelSpace, GSpacing nLineSpace,
+                               GSpacing nBandSpace,
+                               GDALRasterIOExtraArg* psExtraArg,
+                               GDALRasterIOAsyncCallback pfnCallback,
+                               void* pUserData );
+    void        WaitRasterIOAsync();
+
 //! @cond Doxygen_Suppress
     struct RawBinaryLayout
     {
@@ -1174,9 +1186,20 @@ class CPL_DLL GDALRasterBand : public GDALMajorObject
                                 GDALRasterIOExtraArg* psExtraArg,
                                 int* pbTried );
 
+    CPLErr ReadFromDirectView( const void *pView,
+                               GSpacing nViewPixelSpace,
+                               GSpacing nViewLineSpace,
+                               int nXOff, int nYOff, int nXSize, int nYSize,
+                               void * pData, int nBufXSize, int nBufYSize,
+                               GDALDataType eBufType,
+                               GSpacing nPixelSpace, GSpacing nLineSpace,
+                               GDALRasterIOExtraArg* psExtraArg );
+
     int            InitBlockInfo();
 
     void           AddBlockToFreeList( GDALRasterBlock * );
+    bool           ValidateRawBlockOffset( int nXBlockOff, int nYBlockOff,
+                                           const char* pszFunction );
 //! @endcond
 
     GDALRasterBlock *TryGetLockedBlockRef( int nXBlockOff, int nYBlockYOff );
@@ -1300,6 +1323,13 @@ class CPL_DLL GDALRasterBand : public GDALMajorObject
                                                GIntBig *pnLineSpace,
                                                char **papszOptions ) CPL_WARN_UNUSED_RESULT;
 
+    CPLErr      ReadRawBlock( int nXBlockOff, int nYBlockOff,
+                              void** ppData, size_t* pnDataSize,
+                              char*** ppapszCodecInfo ) CPL_WARN_UNUSED_RESULT;
+    CPLErr      WriteRawBlock( int nXBlockOff, int nYBlockOff,
+                               const void* pData, size_t nDataSize,
+                               CSLConstList papszCodecInfo ) CPL_WARN_UNUSED_RESULT;
+
     int GetDataCoverageStatus( int nXOff, int nYOff,
                                int nXSize, int nYSize,
                                int nMaskFlagStop = 0,
@@ -1323,6 +1353,19 @@ class CPL_DLL GDALRasterBand : public GDALMajorObject
     static inline GDALRasterBand* FromHandle(GDALRasterBandH hBand)
         { return static_cast<GDALRasterBand*>(hBand); }
 
+    // Virtual methods added after GetVirtualMemAuto() go last, so that the
+    // vtable layout of the previous ones does not change.
+    virtual const void     *GetDirectReadPointer( GSpacing *pnPixelSpace,
+                                                  GSpacing *pnLineSpace );
+    virtual char          **GetRawBlockCodecInfo( int nXBlockOff,
+                                                  int nYBlockOff );
+
+  protected:
+    virtual CPLErr IReadRawBlock( int nXBlockOff, int nYBlockOff,
+                                  void** ppData, size_t* pnDataSize );
+    virtual CPLErr IWriteRawBlock( int nXBlockOff, int nYBlockOff,
+                                   const void* pData, size_t nDataSize );
+
 private:
     CPL_DISALLOW_COPY_ASSIGN(GDALRasterBand)
 };
@@ -1543,6 +1586,8 @@ class CPL_DLL GDALDriver : public GDALMajorObject
                                                  char ** papszOptions );
     CPLErr              (*pfnDeleteDataSource)( GDALDriver*,
                                                  const char * pszName );
+
+    GDALDriver          *GetRealDriver();
 //! @endcond
 
 /* -------------------------------------------------------------------- */
@@ -1619,6 +1664,9 @@ class CPL_DLL GDALDriverManager : public GDALMajorObject
             { return (iDriver >= 0 && iDriver < nDrivers) ?
                   papoDrivers[iDriver] : nullptr; }
 
+    // Drivers declared with DeclareDeferredDriver() and not loaded yet.
+    std::map<CPLString, GDALDriver*> oMapNameToDeferredDrivers{};
+
     GDALDriver  *GetDriverByName_unlocked( const char * pszName )
             { return oMapNameToDrivers[CPLString(pszName).toupper()]; }
 
@@ -1626,6 +1674,13 @@ class CPL_DLL GDALDriverManager : public GDALMajorObject
 
     static void   CleanupPythonDrivers();
 
+    static void   SetDefaultCapabilities( GDALDriver * poDriver );
+
+    struct OpenSignatureTable;
+    std::unique_ptr<OpenSignatureTable> m_poOpenSignatureTable{};
+
+    friend class GDALDeferredDriver;
+
     CPL_DISALLOW_COPY_ASSIGN(GDALDriverManager)
 
  public:
@@ -1639,11 +1694,21 @@ class CPL_DLL GDALDriverManager : public GDALMajorObject
     int         RegisterDriver( GDALDriver * );
     void        DeregisterDriver( GDALDriver * );
 
+    int         DeclareDeferredDriver( const char * pszName,
+                                       void (*pfnRegister)( void ),
+                                       CSLConstList papszMetadata );
+
     // AutoLoadDrivers is a no-op if compiled with GDAL_NO_AUTOLOAD defined.
     static void        AutoLoadDrivers();
     void        AutoSkipDrivers();
 
     static void        AutoLoadPythonDrivers();
+
+//! @cond Doxygen_Suppress
+    void        GetOpenCandidateDrivers( const GByte* pabyHeader,
+                                         int nHeaderBytes,
+                                         std::vector<GDALDriver*>& apoDrivers );
+//! @endcond
 };
 
 CPL_C_START
@@ -2116,6 +2181,15 @@ public:
                                  FuncProcessPerChunkType pfnFunc,
                                  void* pUserData);
 
+    bool ProcessPerChunk(const GUInt64* arrayStartIdx,
+                         const GUInt64* count,
+                         const size_t* chunkSize,
+                         FuncProcessPerChunkType pfnFunc,
+                         void* pUserData,
+                         CSLConstList papszOptions);
+
+    virtual bool IsReadThreadSafe() const;
+
     bool Read(const GUInt64* arrayStartIdx,     // array of size GetDimensionCount()
                       const size_t* count,                 // array of size GetDimensionCount()
                       const GInt64* arrayStep,        // step in elements
@@ -2333,12 +2407,23 @@ class CPL_DLL GDALMDArray: virtual public GDALAbstractMDArray, public GDALIHasAt
         return atInternal(indices, tail...);
     }
 
+    mutable GUInt64 m_nChunkCacheId = 0;
+
 protected:
 //! @cond Doxygen_Suppress
     GDALMDArray(const std::string& osParentName, const std::string& osName);
+
+    bool ReadFromChunkCache(const GUInt64* arrayStartIdx,
+                            const size_t* count,
+                            const GInt64* arrayStep,
+                            const GPtrDiff_t* bufferStride,
+                            const GDALExtendedDataType& bufferDataType,
+                            void* pDstBuffer,
+                            bool& bRet) const;
 //! @endcond
 
 public:
+    ~GDALMDArray() override;
 
     GUInt64 GetTotalCopyCost() const;
 
@@ -2711,6 +2796,7 @@ void CPL_DLL GDALCopyRasterIOExtraArg(GDALRasterIOExtraArg* psDestArg,
 CPL_C_END
 
 void GDALNullifyOpenDatasetsList();
+void GDALMDArrayChunkCacheTrim(GIntBig nMaxSize);
 CPLMutex** GDALGetphDMMutex();
 CPLMutex** GDALGetphDLMutex();
 void GDALNullifyProxyPoolSingleton();
@@ -2774,6 +2860,9 @@ void GDALSerializeOpenOptionsToXML( CPLXMLNode* psParentNode, char** papszOpenOp
 char** GDALDeserializeOpenOptionsFromXML( CPLXMLNode* psParentNode );
 
 int GDALCanFileAcceptSidecarFile(const char* pszFilename);
+
+bool GDALRawBlockCodecInfoEqual( CSLConstList papszInfo1,
+                                 CSLConstList papszInfo2 );
 //! @endcond
 
 #endif /* ndef GDAL_PRIV_H_INCLUDED */
@@ -212,6 +212,20 @@ class CPL_DLL GDALProxyRasterBand : public GDALRasterBand
 typedef struct _GDALProxyPoolCacheEntry GDALProxyPoolCacheEntry;
 class     GDALProxyPoolRasterBand;
 
+/** Metrics of the pool of datasets shared by GDALProxyPoolDataset objects */
+typedef struct
+{
+    GIntBig nHits;              /**< Lookups served by an opened dataset */
+    GIntBig nMisses;            /**< Lookups that opened a dataset */
+    GIntBig nEvictions;         /**< Datasets closed to make room */
+    double  dfEvictionSeconds;  /**< Time spent closing evicted datasets */
+    double  dfOpenSeconds;      /**< Time spent opening datasets */
+    int     nOpenDatasets;      /**< Current number of entries */
+    int     nMaxDatasets;       /**< GDAL_MAX_DATASET_POOL_SIZE */
+} GDALDatasetPoolStatistics;
+
+bool CPL_DLL GDALGetDatasetPoolStatistics( GDALDatasetPoolStatistics* psStats );
+
 class CPL_DLL GDALProxyPoolDataset : public GDALProxyDataset
 {
   private:
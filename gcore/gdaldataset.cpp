@@ -38,6 +38,7 @@
 #include <cstring>
 #include <algorithm>
 #include <map>
+#include <mutex>
 #include <new>
 #include <set>
 #include <string>
@@ -51,6 +52,7 @@
 #include "cpl_string.h"
 #include "cpl_vsi.h"
 #include "cpl_vsi_error.h"
+#include "cpl_worker_thread_pool.h"
 #include "ogr_api.h"
 #include "ogr_attrind.h"
 #include "ogr_core.h"
@@ -97,6 +99,56 @@ enum class GDALAllowReadWriteMutexState
 const GIntBig TOTAL_FEATURES_NOT_INIT = -2;
 const GIntBig TOTAL_FEATURES_UNKNOWN = -1;
 
+/************************************************************************/
+/*                       GDALRasterIOAsyncContext                       */
+/************************************************************************/
+
+// State of the asynchronous RasterIO requests of a dataset. Requests are
+// executed by a pool of worker threads. As a dataset cannot be used from
+// several threads at once, each request is served by a clone of the dataset,
+// that is another handle opened from the same name, with the same driver and
+// open options. Clones are kept in a free list and reused by later requests.
+class GDALRasterIOAsyncContext
+{
+    CPL_DISALLOW_COPY_ASSIGN(GDALRasterIOAsyncContext)
+
+  public:
+    struct Request
+    {
+        GDALRasterIOAsyncContext* poContext = nullptr;
+        int nXOff = 0;
+        int nYOff = 0;
+        int nXSize = 0;
+        int nYSize = 0;
+        void* pData = nullptr;
+        int nBufXSize = 0;
+        int nBufYSize = 0;
+        GDALDataType eBufType = GDT_Unknown;
+        std::vector<int> anBandMap{};
+        GSpacing nPixelSpace = 0;
+        GSpacing nLineSpace = 0;
+        GSpacing nBandSpace = 0;
+        GDALRasterIOExtraArg sExtraArg{};
+        GDALRasterIOAsyncCallback pfnCallback = nullptr;
+        void* pUserData = nullptr;
+    };
+
+    CPLString osFilename{};
+    CPLString osDriverName{};
+    CPLStringList aosOpenOptions{};
+    CPLWorkerThreadPool oPool{};
+    std::mutex oMutex{};
+    std::vector<GDALDataset*> apoFreeClones{};
+
+    GDALRasterIOAsyncContext() = default;
+    ~GDALRasterIOAsyncContext();
+
+    GDALDataset* AcquireClone();
+    void         ReleaseClone(GDALDataset* poClone);
+
+    static void  RequestFunc(void* pData);
+};
+
 class GDALDataset::Private
 {
     CPL_DISALLOW_COPY_ASSIGN(Private)
@@ -123,6 +175,10 @@ class GDALDataset::Private
 
     GDALDataset* poParentDataset = nullptr;
 
+    // Used by RasterIOAsync()
+    GDALRasterIOAsyncContext* poRasterIOAsyncContext = nullptr;
+    bool bRasterIOAsyncSynchronous = false;
+
     Private() = default;
 };
 
@@ -270,6 +326,11 @@ GDALDataset::GDALDataset(int bForceCachedIOIn):
 GDALDataset::~GDALDataset()
 
 {
+    // Pending asynchronous requests only use clones of this dataset, so
+    // waiting for them here is safe even if the subclass is already gone.
+    if( m_poPrivate != nullptr )
+        delete m_poPrivate->poRasterIOAsyncContext;
+
     // we don't want to report destruction of datasets that
     // were never really open or meant as internal
     if( !bIsInternal && (nBands != 0 || !EQUAL(GetDescription(), "")) )
@@ -3312,7 +3373,19 @@ GDALDatasetH CPL_STDCALL GDALOpenEx( const char *pszFilename,
     const int nDriverCount = poDM->GetDriverCount();
     const int nAllowedDrivers = CSLCount( papszAllowedDrivers );
 
-    for( int iDriver = -1; iDriver < nDriverCount; ++iDriver )
+    // Only probe the drivers whose declared signatures, if any, match the
+    // file header.
+    std::vector<GDALDriver*> apoCandidateDrivers;
+#ifndef FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION
+    poDM->GetOpenCandidateDrivers(oOpenInfo.pabyHeader, oOpenInfo.nHeaderBytes,
+                                  apoCandidateDrivers);
+#else
+    // During fuzzing, let all drivers see crazy content.
+    poDM->GetOpenCandidateDrivers(nullptr, 0, apoCandidateDrivers);
+#endif
+    const int nCandidateDrivers = static_cast<int>(apoCandidateDrivers.size());
+
+    for( int iDriver = -1; iDriver < nCandidateDrivers; ++iDriver )
     {
         GDALDriver *poDriver = nullptr;
 
@@ -3325,7 +3398,7 @@ GDALDatasetH CPL_STDCALL GDALOpenEx( const char *pszFilename,
         }
         else
         {
-            poDriver = poDM->GetDriver(iDriver);
+            poDriver = apoCandidateDrivers[iDriver];
             if (papszAllowedDrivers != nullptr &&
                 CSLFindString(papszAllowedDrivers,
                               GDALGetDriverShortName(poDriver)) == -1)
@@ -3958,6 +4031,354 @@ void CPL_STDCALL GDALEndAsyncReader( GDALDatasetH hDS,
         ->EndAsyncReader(static_cast<GDALAsyncReader *>(hAsyncReaderH));
 }
 
+/************************************************************************/
+/*                    ~GDALRasterIOAsyncContext()                       */
+/************************************************************************/
+
+GDALRasterIOAsyncContext::~GDALRasterIOAsyncContext()
+{
+    oPool.WaitCompletion();
+    for( auto poClone: apoFreeClones )
+        GDALClose(poClone);
+}
+
+/************************************************************************/
+/*                            AcquireClone()                            */
+/************************************************************************/
+
+GDALDataset* GDALRasterIOAsyncContext::AcquireClone()
+{
+    {
+        std::lock_guard<std::mutex> oLock(oMutex);
+        if( !apoFreeClones.empty() )
+        {
+            GDALDataset* poClone = apoFreeClones.back();
+            apoFreeClones.pop_back();
+            return poClone;
+        }
+    }
+    const char* const apszAllowedDrivers[] = { osDriverName.c_str(), nullptr };
+    return GDALDataset::Open( osFilename,
+                              GDAL_OF_RASTER | GDAL_OF_INTERNAL,
+                              osDriverName.empty() ? nullptr :
+                                                     apszAllowedDrivers,
+                              aosOpenOptions.List() );
+}
+
+/************************************************************************/
+/*                            ReleaseClone()                            */
+/************************************************************************/
+
+void GDALRasterIOAsyncContext::ReleaseClone(GDALDataset* poClone)
+{
+    std::lock_guard<std::mutex> oLock(oMutex);
+    apoFreeClones.push_back(poClone);
+}
+
+/************************************************************************/
+/*                            RequestFunc()                             */
+/************************************************************************/
+
+void GDALRasterIOAsyncContext::RequestFunc(void* pData)
+{
+    Request* psRequest = static_cast<Request*>(pData);
+    GDALRasterIOAsyncContext* poContext = psRequest->poContext;
+
+    CPLErr eErr = CE_Failure;
+    GDALDataset* poClone = poContext->AcquireClone();
+    if( poClone == nullptr )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "RasterIOAsync(): cannot reopen %s",
+                 poContext->osFilename.c_str());
+    }
+    else
+    {
+        eErr = poClone->RasterIO(
+            GF_Read,
+            psRequest->nXOff, psRequest->nYOff,
+            psRequest->nXSize, psRequest->nYSize,
+            psRequest->pData, psRequest->nBufXSize, psRequest->nBufYSize,
+            psRequest->eBufType,
+            static_cast<int>(psRequest->anBandMap.size()),
+            &psRequest->anBandMap[0],
+            psRequest->nPixelSpace, psRequest->nLineSpace,
+            psRequest->nBandSpace, &psRequest->sExtraArg);
+        poContext->ReleaseClone(poClone);
+    }
+
+    if( psRequest->pfnCallback )
+        psRequest->pfnCallback(eErr, psRequest->pUserData);
+    delete psRequest;
+}
+
+/************************************************************************/
+/*                           RasterIOAsync()                            */
+/************************************************************************/
+
+/**
+ * \brief Read a region of image data for multiple bands asynchronously.
+ *
+ * This method takes the same arguments as GDALDataset::RasterIO() in
+ * GF_Read mode, and returns as soon as the request is queued. The request is
+ * executed by a pool of worker threads, and pfnCallback is called, from one of
+ * these threads, once pData has been filled (or on failure). Many requests can
+ * be in flight at once, which is useful to overlap the latency of remote
+ * files, such as /vsicurl/ ones, or to decode several windows of a local file
+ * on several CPUs. The order of completion is unspecified.
+ *
+ * As a dataset is not thread-safe, requests are served by other handles of the
+ * same dataset, opened from its name, with the same driver and open options.
+ * Those handles are kept open and reused by later requests. The
+ * GDAL_RASTERIO_ASYNC_NUM_THREADS configuration option sets the number of
+ * worker threads, and thus the maximum number of requests executed
+ * concurrently. It may be set to an integer or ALL_CPUS (the default).
+ *
+ * When the dataset cannot be reopened (for example a MEM dataset, or a
+ * dataset opened in update mode, whose pending changes would not be seen by
+ * other handles), the request is executed synchronously, and pfnCallback is
+ * called before this method returns.
+ *
+ * pData, panBandMap (which is copied) and the extra arguments must remain
+ * valid until the callback is called. Any progress function of psExtraArg is
+ * ignored. WaitRasterIOAsync() must not be called from a callback, and all
+ * requests must be completed, with WaitRasterIOAsync(), before pData is freed
+ * or the dataset is closed.
+ *
+ * This method is the same as the C function GDALDatasetRasterIOAsync().
+ *
+ * @param nXOff The pixel offset to the top left corner of the region
+ * of the band to be accessed.
+ * @param nYOff The line offset to the top left corner of the region
+ * of the band to be accessed.
+ * @param nXSize The width of the region of the band to be accessed in pixels.
+ * @param nYSize The height of the region of the band to be accessed in lines.
+ * @param pData The buffer into which the data should be read.
+ * @param nBufXSize the width of the buffer image into which the desired region
+ * is to be read.
+ * @param nBufYSize the height of the buffer image into which the desired
+ * region is to be read.
+ * @param eBufType the type of the pixel values in the pData data buffer.
+ * @param nBandCount the number of bands being read.
+ * @param panBandMap the list of nBandCount band numbers being read.
+ * Note band numbers are 1 based. This may be NULL to select the first
+ * nBandCount bands.
+ * @param nPixelSpace The byte offset from the start of one pixel value in
+ * pData to the start of the next pixel value within a scanline. If defaulted
+ * (0) the size of the datatype eBufType is used.
+ * @param nLineSpace The byte offset from the start of one scanline in
+ * pData to the start of the next. If defaulted (0) the size of the datatype
+ * eBufType * nBufXSize is used.
+ * @param nBandSpace the byte offset from the start of one bands data to the
+ * start of the next. If defaulted (0) the value will be
+ * nLineSpace * nBufYSize implying band sequential organization
+ * of the data buffer.
+ * @param psExtraArg (optional) pointer to a GDALRasterIOExtraArg structure
+ * with additional arguments to specify resampling. May be NULL.
+ * @param pfnCallback function called when the request is completed. May be
+ * NULL.
+ * @param pUserData user data passed to pfnCallback.
+ *
+ * @return CE_None if the request has been queued (or has been executed
+ * successfully in synchronous mode), CE_Failure otherwise.
+ *
+ * @since GDAL 3.1
+ */
+
+CPLErr GDALDataset::RasterIOAsync( int nXOff, int nYOff, int nXSize, int nYSize,
+                                   void *pData, int nBufXSize, int nBufYSize,
+                                   GDALDataType eBufType,
+                                   int nBandCount, int *panBandMap,
+                                   GSpacing nPixelSpace, GSpacing nLineSpace,
+                                   GSpacing nBandSpace,
+                                   GDALRasterIOExtraArg* psExtraArg,
+                                   GDALRasterIOAsyncCallback pfnCallback,
+                                   void* pUserData )
+{
+    if( nBandCount <= 0 || nBandCount > nBands )
+    {
+        CPLError(CE_Failure, CPLE_IllegalArg,
+                 "RasterIOAsync(): invalid band count %d", nBandCount);
+        return CE_Failure;
+    }
+    if( nXOff < 0 || nXSize < 1 || nXOff > nRasterXSize - nXSize ||
+        nYOff < 0 || nYSize < 1 || nYOff > nRasterYSize - nYSize )
+    {
+        CPLError(CE_Failure, CPLE_IllegalArg,
+                 "RasterIOAsync(): access window %d,%d,%d,%d out of range",
+                 nXOff, nYOff, nXSize, nYSize);
+        return CE_Failure;
+    }
+
+    GDALRasterIOAsyncContext* poContext =
+        m_poPrivate ? m_poPrivate->poRasterIOAsyncContext : nullptr;
+    if( poContext == nullptr && m_poPrivate != nullptr &&
+        !m_poPrivate->bRasterIOAsyncSynchronous )
+    {
+        // Check that the dataset can be reopened, and keep that first clone.
+        GDALDataset* poClone = nullptr;
+        if( eAccess == GA_ReadOnly && GetDescription()[0] != '\0' &&
+            poDriver != nullptr && !EQUAL(poDriver->GetDescription(), "MEM") )
+        {
+            poContext = new GDALRasterIOAsyncContext();
+            poContext->osFilename = GetDescription();
+            poContext->osDriverName = poDriver->GetDescription();
+            poContext->aosOpenOptions = CSLDuplicate(papszOpenOptions);
+            CPLPushErrorHandler(CPLQuietErrorHandler);
+            poClone = poContext->AcquireClone();
+            CPLPopErrorHandler();
+            CPLErrorReset();
+        }
+        int nThreads = 0;
+        if( poClone != nullptr )
+        {
+            nThreads = CPLGetNumThreadsOption(
+                CPLGetConfigOption("GDAL_RASTERIO_ASYNC_NUM_THREADS",
+                                   "ALL_CPUS"), "ALL_CPUS");
+        }
+        if( poClone != nullptr &&
+            poClone->GetRasterXSize() == nRasterXSize &&
+            poClone->GetRasterYSize() == nRasterYSize &&
+            poClone->GetRasterCount() == nBands &&
+            poContext->oPool.Setup(nThreads, nullptr, nullptr) )
+        {
+            CPLDebug("GDAL", "RasterIOAsync(%s): using %d threads",
+                     GetDescription(), nThreads);
+            poContext->ReleaseClone(poClone);
+            m_poPrivate->poRasterIOAsyncContext = poContext;
+        }
+        else
+        {
+            CPLDebug("GDAL", "RasterIOAsync(%s): synchronous mode",
+                     GetDescription());
+            if( poClone )
+                GDALClose(poClone);
+            delete poContext;
+            poContext = nullptr;
+            m_poPrivate->bRasterIOAsyncSynchronous = true;
+        }
+    }
+
+    if( poContext == nullptr )
+    {
+        const CPLErr eErr = RasterIO( GF_Read, nXOff, nYOff, nXSize, nYSize,
+                                      pData, nBufXSize, nBufYSize, eBufType,
+                                      nBandCount, panBandMap,
+                                      nPixelSpace, nLineSpace, nBandSpace,
+                                      psExtraArg );
+        if( pfnCallback )
+            pfnCallback(eErr, pUserData);
+        return eErr;
+    }
+
+    auto psRequest = new GDALRasterIOAsyncContext::Request();
+    psRequest->poContext = poContext;
+    psRequest->nXOff = nXOff;
+    psRequest->nYOff = nYOff;
+    psRequest->nXSize = nXSize;
+    psRequest->nYSize = nYSize;
+    psRequest->pData = pData;
+    psRequest->nBufXSize = nBufXSize;
+    psRequest->nBufYSize = nBufYSize;
+    psRequest->eBufType = eBufType;
+    for( int i = 0; i < nBandCount; i++ )
+        psRequest->anBandMap.push_back(panBandMap ? panBandMap[i] : i + 1);
+    psRequest->nPixelSpace = nPixelSpace;
+    psRequest->nLineSpace = nLineSpace;
+    psRequest->nBandSpace = nBandSpace;
+    if( psExtraArg )
+        psRequest->sExtraArg = *psExtraArg;
+    else
+        INIT_RASTERIO_EXTRA_ARG(psRequest->sExtraArg);
+    psRequest->sExtraArg.pfnProgress = nullptr;
+    psRequest->sExtraArg.pProgressData = nullptr;
+    psRequest->pfnCallback = pfnCallback;
+    psRequest->pUserData = pUserData;
+
+    if( !poContext->oPool.SubmitJob(GDALRasterIOAsyncContext::RequestFunc,
+                                    psRequest) )
+    {
+        delete psRequest;
+        return CE_Failure;
+    }
+    return CE_None;
+}
+
+/************************************************************************/
+/*                       GDALDatasetRasterIOAsync()                     */
+/************************************************************************/
+
+/**
+ * \brief Read a region of image data for multiple bands asynchronously.
+ *
+ * This function is the same as the C++ method GDALDataset::RasterIOAsync().
+ *
+ * @since GDAL 3.1
+ */
+
+CPLErr GDALDatasetRasterIOAsync( GDALDatasetH hDS,
+                                 int nXOff, int nYOff, int nXSize, int nYSize,
+                                 void *pData, int nBufXSize, int nBufYSize,
+                                 GDALDataType eBufType,
+                                 int nBandCount, int *panBandMap,
+                                 GSpacing nPixelSpace, GSpacing nLineSpace,
+                                 GSpacing nBandSpace,
+                                 GDALRasterIOExtraArg* psExtraArg,
+                                 GDALRasterIOAsyncCallback pfnCallback,
+                                 void* pUserData )
+{
+    VALIDATE_POINTER1(hDS, "GDALDatasetRasterIOAsync", CE_Failure);
+
+    return GDALDataset::FromHandle(hDS)->RasterIOAsync(
+        nXOff, nYOff, nXSize, nYSize, pData, nBufXSize, nBufYSize, eBufType,
+        nBandCount, panBandMap, nPixelSpace, nLineSpace, nBandSpace,
+        psExtraArg, pfnCallback, pUserData);
+}
+
+/************************************************************************/
+/*                         WaitRasterIOAsync()                          */
+/************************************************************************/
+
+/**
+ * \brief Wait for the completion of all pending asynchronous RasterIO
+ * requests.
+ *
+ * When this method returns, the callbacks of all the requests issued by
+ * RasterIOAsync() have been called. It must not be called from such a
+ * callback.
+ *
+ * This method is the same as the C function GDALDatasetWaitRasterIOAsync().
+ *
+ * @since GDAL 3.1
+ */
+
+void GDALDataset::WaitRasterIOAsync()
+{
+    if( m_poPrivate && m_poPrivate->poRasterIOAsyncContext )
+        m_poPrivate->poRasterIOAsyncContext->oPool.WaitCompletion();
+}
+
+/************************************************************************/
+/*                     GDALDatasetWaitRasterIOAsync()                   */
+/************************************************************************/
+
+/**
+ * \brief Wait for the completion of all pending asynchronous RasterIO
+ * requests.
+ *
+ * This function is the same as the C++ method
+ * GDALDataset::WaitRasterIOAsync().
+ *
+ * @since GDAL 3.1
+ */
+
+void GDALDatasetWaitRasterIOAsync( GDALDatasetH hDS )
+{
+    VALIDATE_POINTER0(hDS, "GDALDatasetWaitRasterIOAsync");
+
+    GDALDataset::FromHandle(hDS)->WaitRasterIOAsync();
+}
+
 /************************************************************************/
 /*                       CloseDependentDatasets()                       */
 /************************************************************************/
@@ -167,6 +167,16 @@ GDALDataset * GDALDriver::Create( const char * pszFilename,
                                   GDALDataType eType, char ** papszOptions )
 
 {
+    GDALDriver *poRealDriver = GetRealDriver();
+    if( poRealDriver != this )
+    {
+        GDALDataset *poDS = poRealDriver->Create( pszFilename, nXSize, nYSize,
+                                                  nBands, eType, papszOptions );
+        if( poDS != nullptr && poDS->poDriver == poRealDriver )
+            poDS->poDriver = this;
+        return poDS;
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Does this format support creation.                              */
 /* -------------------------------------------------------------------- */
@@ -356,6 +366,16 @@ GDALDataset * GDALDriver::CreateMultiDimensional( const char * pszFilename,
                                                   CSLConstList papszOptions )
 
 {
+    GDALDriver *poRealDriver = GetRealDriver();
+    if( poRealDriver != this )
+    {
+        GDALDataset *poDS = poRealDriver->CreateMultiDimensional(
+                            pszFilename, papszRootGroupOptions, papszOptions );
+        if( poDS != nullptr && poDS->poDriver == poRealDriver )
+            poDS->poDriver = this;
+        return poDS;
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Does this format support creation.                              */
 /* -------------------------------------------------------------------- */
@@ -970,6 +990,17 @@ GDALDataset *GDALDriver::CreateCopy( const char * pszFilename,
                                      void * pProgressData )
 
 {
+    GDALDriver *poRealDriver = GetRealDriver();
+    if( poRealDriver != this )
+    {
+        GDALDataset *poDS = poRealDriver->CreateCopy(
+                                pszFilename, poSrcDS, bStrict, papszOptions,
+                                pfnProgress, pProgressData );
+        if( poDS != nullptr && poDS->poDriver == poRealDriver )
+            poDS->poDriver = this;
+        return poDS;
+    }
+
     if( pfnProgress == nullptr )
         pfnProgress = GDALDummyProgress;
 
@@ -1205,9 +1236,10 @@ CPLErr GDALDriver::QuietDelete( const char *pszName,
 
     CPLDebug( "GDAL", "QuietDelete(%s) invoking Delete()", pszName );
 
+    GDALDriver * const poRealDriver = poDriver->GetRealDriver();
     const bool bQuiet =
-        !bExists && poDriver->pfnDelete == nullptr &&
-        poDriver->pfnDeleteDataSource == nullptr;
+        !bExists && poRealDriver->pfnDelete == nullptr &&
+        poRealDriver->pfnDeleteDataSource == nullptr;
     if( bQuiet )
         CPLPushErrorHandler(CPLQuietErrorHandler);
     CPLErr eErr = poDriver->Delete( pszName );
@@ -1246,6 +1278,10 @@ CPLErr GDALDriver::QuietDelete( const char *pszName,
 CPLErr GDALDriver::Delete( const char * pszFilename )
 
 {
+    GDALDriver *poRealDriver = GetRealDriver();
+    if( poRealDriver != this )
+        return poRealDriver->Delete( pszFilename );
+
     if( pfnDelete != nullptr )
         return pfnDelete( pszFilename );
     else if( pfnDeleteDataSource != nullptr )
@@ -1421,6 +1457,10 @@ CPLErr GDALDriver::DefaultRename( const char * pszNewName,
 CPLErr GDALDriver::Rename( const char * pszNewName, const char *pszOldName )
 
 {
+    GDALDriver *poRealDriver = GetRealDriver();
+    if( poRealDriver != this )
+        return poRealDriver->Rename( pszNewName, pszOldName );
+
     if( pfnRename != nullptr )
         return pfnRename( pszNewName, pszOldName );
 
@@ -1546,6 +1586,10 @@ CPLErr GDALDriver::DefaultCopyFiles( const char *pszNewName,
 CPLErr GDALDriver::CopyFiles( const char *pszNewName, const char *pszOldName )
 
 {
+    GDALDriver *poRealDriver = GetRealDriver();
+    if( poRealDriver != this )
+        return poRealDriver->CopyFiles( pszNewName, pszOldName );
+
     if( pfnCopyFiles != nullptr )
         return pfnCopyFiles( pszNewName, pszOldName );
 
@@ -2199,7 +2243,11 @@ GDALIdentifyDriverEx( const char* pszFilename,
 
     CPLErrorReset();
 
-    const int nDriverCount = poDM->GetDriverCount();
+    // Skip the drivers whose declared signatures do not match the header.
+    std::vector<GDALDriver*> apoCandidateDrivers;
+    poDM->GetOpenCandidateDrivers(oOpenInfo.pabyHeader, oOpenInfo.nHeaderBytes,
+                                  apoCandidateDrivers);
+    const int nDriverCount = static_cast<int>(apoCandidateDrivers.size());
 
     // First pass: only use drivers that have a pfnIdentify implementation.
     for( int iDriver = -1; iDriver < nDriverCount; ++iDriver )
@@ -2210,7 +2258,7 @@ GDALIdentifyDriverEx( const char* pszFilename,
             poDriver = GDALGetAPIPROXYDriver();
         else
         {
-            poDriver = poDM->GetDriver( iDriver );
+            poDriver = apoCandidateDrivers[iDriver];
             if (papszAllowedDrivers != nullptr &&
                 CSLFindString(papszAllowedDrivers,
                               GDALGetDriverShortName(poDriver)) == -1)
@@ -2258,7 +2306,7 @@ GDALIdentifyDriverEx( const char* pszFilename,
             poDriver = GDALGetAPIPROXYDriver();
         else
         {
-            poDriver = poDM->GetDriver( iDriver );
+            poDriver = apoCandidateDrivers[iDriver];
             if (papszAllowedDrivers != nullptr &&
                 CSLFindString(papszAllowedDrivers,
                               GDALGetDriverShortName(poDriver)) == -1)
@@ -30,8 +30,10 @@
 #include "cpl_port.h"
 #include "gdal_priv.h"
 
+#include <atomic>
 #include <cstring>
 #include <map>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
@@ -110,6 +112,37 @@ GDALDriverManager * GetGDALDriverManager()
     return const_cast<GDALDriverManager *>( poDM );
 }
 
+/************************************************************************/
+/*                         OpenSignatureTable                           */
+/************************************************************************/
+
+//! @cond Doxygen_Suppress
+// Dispatch table built from the GDAL_DMD_OPEN_SIGNATURES of the drivers.
+// Signatures at offset 0, which are the vast majority, are stored in a
+// byte trie walked once over the file header; other ones are tested one
+// by one.
+struct GDALDriverManager::OpenSignatureTable
+{
+    struct Node
+    {
+        std::map<GByte, int> oMapChildren{};
+        std::vector<int>     anDrivers{};
+    };
+
+    struct OffsetSignature
+    {
+        int                  nOffset = 0;
+        std::vector<GByte>   abyBytes{};
+        int                  iDriver = 0;
+    };
+
+    std::vector<Node>            aoTrie{ Node() };
+    std::vector<OffsetSignature> aoOffsetSignatures{};
+    std::vector<bool>            abHasSignatures{};
+    std::vector<bool>            abMatched{};   // Scratch buffer.
+};
+//! @endcond
+
 /************************************************************************/
 /*                         GDALDriverManager()                          */
 /************************************************************************/
@@ -401,6 +434,312 @@ GDALDriverH CPL_STDCALL GDALGetDriver( int iDriver )
     return /* (GDALDriverH) */ GetGDALDriverManager()->GetDriver(iDriver);
 }
 
+/************************************************************************/
+/* ==================================================================== */
+/*                          GDALDeferredDriver                          */
+/* ==================================================================== */
+/************************************************************************/
+
+//! @cond Doxygen_Suppress
+// Placeholder registered by GDALDriverManager::DeclareDeferredDriver(). It
+// only carries the metadata needed to select it in GDALOpenEx(), and runs
+// the real registration function the first time anything else is needed.
+// The real driver then registers itself through RegisterDriver(), which
+// hands it over to the placeholder, so that the GDALDriver* seen by
+// applications never changes.
+// The callbacks of the placeholder are set once, in its constructor, since
+// GDALOpenEx() and GDALIdentifyDriverEx() read them without any lock: its
+// trampolines and GDALDriver::GetRealDriver() forward to the real driver.
+class GDALDeferredDriver final: public GDALDriver
+{
+    void                   (*m_pfnRegister)( void ) = nullptr;
+    // Set by SetRealDriver() during the registration, and published to
+    // other threads in m_poRealDriver when the registration is complete.
+    GDALDriver             *m_poRegisteredDriver = nullptr;
+    std::atomic<GDALDriver*> m_poRealDriver{nullptr};
+    std::atomic<bool>       m_bLoading{false};
+    std::atomic<bool>       m_bLoadFailed{false};
+
+    static bool         CannotBeForDriver( GDALDriver *poDriver,
+                                           GDALOpenInfo *poOpenInfo );
+    static bool         IsDeclaredItem( const char *pszName,
+                                        const char *pszDomain );
+
+    static GDALDataset *OpenTrampoline( GDALDriver *poDriver,
+                                        GDALOpenInfo *poOpenInfo );
+    static int          IdentifyTrampoline( GDALDriver *poDriver,
+                                            GDALOpenInfo *poOpenInfo );
+
+    CPL_DISALLOW_COPY_ASSIGN(GDALDeferredDriver)
+
+  public:
+    GDALDeferredDriver( const char *pszName, void (*pfnRegister)( void ),
+                        CSLConstList papszMetadata );
+    ~GDALDeferredDriver() override;
+
+    bool        IsLoading() const { return m_bLoading; }
+    void        SetRealDriver( GDALDriver *poRealDriver );
+
+    GDALDriver *Load();
+
+    char      **GetMetadataDomainList() override;
+    char      **GetMetadata( const char *pszDomain = "" ) override;
+    const char *GetMetadataItem( const char *pszName,
+                                 const char *pszDomain = "" ) override;
+    CPLErr      SetMetadataItem( const char *pszName,
+                                 const char *pszValue,
+                                 const char *pszDomain = "" ) override;
+};
+
+/************************************************************************/
+/*                         GDALDeferredDriver()                         */
+/************************************************************************/
+
+GDALDeferredDriver::GDALDeferredDriver( const char *pszName,
+                                        void (*pfnRegister)( void ),
+                                        CSLConstList papszMetadata ) :
+    m_pfnRegister(pfnRegister)
+{
+    SetDescription(pszName);
+    for( CSLConstList papszIter = papszMetadata;
+         papszIter && *papszIter; ++papszIter )
+    {
+        char *pszKey = nullptr;
+        const char *pszValue = CPLParseNameValue(*papszIter, &pszKey);
+        if( pszKey && pszValue && IsDeclaredItem(pszKey, "") )
+            GDALDriver::SetMetadataItem(pszKey, pszValue);
+        CPLFree(pszKey);
+    }
+
+    // Drivers that cannot open datasets are not candidates in GDALOpenEx().
+    if( GDALDriver::GetMetadataItem(GDAL_DCAP_OPEN) != nullptr )
+    {
+        pfnIdentifyEx = IdentifyTrampoline;
+        pfnOpenWithDriverArg = OpenTrampoline;
+    }
+}
+
+/************************************************************************/
+/*                        ~GDALDeferredDriver()                         */
+/************************************************************************/
+
+GDALDeferredDriver::~GDALDeferredDriver()
+{
+    delete m_poRealDriver.load();
+}
+
+/************************************************************************/
+/*                           IsDeclaredItem()                           */
+/************************************************************************/
+
+// Metadata items that must be given to DeclareDeferredDriver() and that
+// can thus be answered without loading the driver.
+bool GDALDeferredDriver::IsDeclaredItem( const char *pszName,
+                                         const char *pszDomain )
+{
+    if( pszDomain != nullptr && pszDomain[0] != '\0' )
+        return false;
+    return EQUAL(pszName, GDAL_DCAP_RASTER) ||
+           EQUAL(pszName, GDAL_DCAP_VECTOR) ||
+           EQUAL(pszName, GDAL_DCAP_GNM) ||
+           EQUAL(pszName, GDAL_DCAP_MULTIDIM_RASTER) ||
+           EQUAL(pszName, GDAL_DCAP_OPEN) ||
+           EQUAL(pszName, GDAL_DMD_OPEN_SIGNATURES) ||
+           EQUAL(pszName, GDAL_DMD_LONGNAME) ||
+           EQUAL(pszName, GDAL_DMD_EXTENSION) ||
+           EQUAL(pszName, GDAL_DMD_EXTENSIONS) ||
+           EQUAL(pszName, GDAL_DMD_CONNECTION_PREFIX);
+}
+
+/************************************************************************/
+/*                                Load()                                */
+/************************************************************************/
+
+// Returns the real driver, running the registration function on first
+// call, or nullptr if it is being registered or could not be.
+GDALDriver *GDALDeferredDriver::Load()
+{
+    GDALDriver *poRealDriver = m_poRealDriver.load(std::memory_order_acquire);
+    if( poRealDriver != nullptr || m_bLoadFailed )
+        return poRealDriver;
+
+    CPLMutexHolderD( &hDMMutex );
+    poRealDriver = m_poRealDriver.load(std::memory_order_relaxed);
+    if( poRealDriver != nullptr || m_bLoading || m_bLoadFailed )
+        return poRealDriver;
+
+    // Hide the placeholder from GetDriverByName() so that the early return
+    // of the registration function does not fire. RegisterDriver() then
+    // calls SetRealDriver().
+    GDALDriverManager *poDriverManager = GetGDALDriverManager();
+    const CPLString osName(CPLString(GetDescription()).toupper());
+    poDriverManager->oMapNameToDrivers.erase(osName);
+    m_bLoading = true;
+    CPLDebug("GDAL", "Loading deferred driver %s", GetDescription());
+    m_pfnRegister();
+    m_bLoading = false;
+    poDriverManager->oMapNameToDrivers[osName] = this;
+
+    if( m_poRegisteredDriver == nullptr )
+    {
+        CPLError(CE_Warning, CPLE_AppDefined,
+                 "Deferred driver %s did not register itself",
+                 GetDescription());
+        m_bLoadFailed = true;
+        poDriverManager->oMapNameToDeferredDrivers.erase(osName);
+        return nullptr;
+    }
+
+    // The registration function may still have modified the driver after
+    // RegisterDriver(): only publish it now.
+    m_poRealDriver.store(m_poRegisteredDriver, std::memory_order_release);
+    return m_poRegisteredDriver;
+}
+
+/************************************************************************/
+/*                           SetRealDriver()                            */
+/************************************************************************/
+
+// Called by RegisterDriver() with the driver instantiated by the
+// registration function, and the driver manager mutex held.
+void GDALDeferredDriver::SetRealDriver( GDALDriver *poRealDriver )
+{
+    m_poRegisteredDriver = poRealDriver;
+}
+
+/************************************************************************/
+/*                         CannotBeForDriver()                          */
+/************************************************************************/
+
+// A driver with open signatures only gets there with a matching header,
+// or an empty one. In the latter case, only connection strings such as
+// "GTIFF_DIR:1:foo.tif" can be for it, and those have a colon. This avoids
+// loading the driver for files that do not exist or are directories.
+bool GDALDeferredDriver::CannotBeForDriver( GDALDriver *poDriver,
+                                            GDALOpenInfo *poOpenInfo )
+{
+    return poOpenInfo->nHeaderBytes == 0 &&
+           poDriver->GetMetadataItem(GDAL_DMD_OPEN_SIGNATURES) != nullptr &&
+           strchr(poOpenInfo->pszFilename, ':') == nullptr;
+}
+
+/************************************************************************/
+/*                           OpenTrampoline()                           */
+/************************************************************************/
+
+GDALDataset *GDALDeferredDriver::OpenTrampoline( GDALDriver *poDriver,
+                                                 GDALOpenInfo *poOpenInfo )
+{
+    if( CannotBeForDriver(poDriver, poOpenInfo) )
+        return nullptr;
+
+    GDALDriver *poRealDriver =
+        cpl::down_cast<GDALDeferredDriver*>(poDriver)->Load();
+    if( poRealDriver == nullptr )
+        return nullptr;
+    GDALDataset *poDS = nullptr;
+    if( poRealDriver->pfnOpen )
+        poDS = poRealDriver->pfnOpen(poOpenInfo);
+    else if( poRealDriver->pfnOpenWithDriverArg )
+        poDS = poRealDriver->pfnOpenWithDriverArg(poRealDriver, poOpenInfo);
+    if( poDS != nullptr && poDS->poDriver == poRealDriver )
+        poDS->poDriver = poDriver;
+    return poDS;
+}
+
+/************************************************************************/
+/*                         IdentifyTrampoline()                         */
+/************************************************************************/
+
+int GDALDeferredDriver::IdentifyTrampoline( GDALDriver *poDriver,
+                                            GDALOpenInfo *poOpenInfo )
+{
+    if( CannotBeForDriver(poDriver, poOpenInfo) )
+        return FALSE;
+
+    GDALDriver *poRealDriver =
+        cpl::down_cast<GDALDeferredDriver*>(poDriver)->Load();
+    if( poRealDriver == nullptr )
+        return FALSE;
+    if( poRealDriver->pfnIdentifyEx )
+        return poRealDriver->pfnIdentifyEx(poRealDriver, poOpenInfo);
+    if( poRealDriver->pfnIdentify )
+        return poRealDriver->pfnIdentify(poOpenInfo);
+    return -1;
+}
+
+/************************************************************************/
+/*                       GetMetadataDomainList()                        */
+/************************************************************************/
+
+char **GDALDeferredDriver::GetMetadataDomainList()
+{
+    GDALDriver *poRealDriver = Load();
+    if( poRealDriver != nullptr )
+        return poRealDriver->GetMetadataDomainList();
+    return GDALDriver::GetMetadataDomainList();
+}
+
+/************************************************************************/
+/*                            GetMetadata()                             */
+/************************************************************************/
+
+char **GDALDeferredDriver::GetMetadata( const char *pszDomain )
+{
+    GDALDriver *poRealDriver = Load();
+    if( poRealDriver != nullptr )
+        return poRealDriver->GetMetadata(pszDomain);
+    return GDALDriver::GetMetadata(pszDomain);
+}
+
+/************************************************************************/
+/*                          GetMetadataItem()                           */
+/************************************************************************/
+
+const char *GDALDeferredDriver::GetMetadataItem( const char *pszName,
+                                                 const char *pszDomain )
+{
+    if( m_poRealDriver.load(std::memory_order_acquire) == nullptr &&
+        !m_bLoading && IsDeclaredItem(pszName, pszDomain) )
+        return GDALDriver::GetMetadataItem(pszName, pszDomain);
+    GDALDriver *poRealDriver = Load();
+    if( poRealDriver != nullptr )
+        return poRealDriver->GetMetadataItem(pszName, pszDomain);
+    return GDALDriver::GetMetadataItem(pszName, pszDomain);
+}
+
+/************************************************************************/
+/*                          SetMetadataItem()                           */
+/************************************************************************/
+
+CPLErr GDALDeferredDriver::SetMetadataItem( const char *pszName,
+                                            const char *pszValue,
+                                            const char *pszDomain )
+{
+    GDALDriver *poRealDriver = m_poRealDriver.load(std::memory_order_acquire);
+    if( poRealDriver != nullptr )
+        return poRealDriver->SetMetadataItem(pszName, pszValue, pszDomain);
+    return GDALDriver::SetMetadataItem(pszName, pszValue, pszDomain);
+}
+
+/************************************************************************/
+/*                     GDALDriver::GetRealDriver()                      */
+/************************************************************************/
+
+// Returns the driver that implements this one: the real driver of a driver
+// declared with DeclareDeferredDriver(), loaded on first call, or this
+// driver otherwise, including when a deferred driver could not be loaded.
+GDALDriver *GDALDriver::GetRealDriver()
+{
+    GDALDeferredDriver *poDeferredDriver =
+        dynamic_cast<GDALDeferredDriver*>(this);
+    if( poDeferredDriver == nullptr )
+        return this;
+    GDALDriver *poRealDriver = poDeferredDriver->Load();
+    return poRealDriver ? poRealDriver : this;
+}
+//! @endcond
+
 /************************************************************************/
 /*                           RegisterDriver()                           */
 /************************************************************************/
@@ -429,6 +768,33 @@ int GDALDriverManager::RegisterDriver( GDALDriver * poDriver )
 {
     CPLMutexHolderD( &hDMMutex );
 
+/* -------------------------------------------------------------------- */
+/*      If this is the real driver of a deferred driver being loaded,   */
+/*      hand it over to the placeholder, which keeps its index.         */
+/* -------------------------------------------------------------------- */
+    const CPLString osName(CPLString(poDriver->GetDescription()).toupper());
+    auto oIterDeferred = oMapNameToDeferredDrivers.find(osName);
+    if( oIterDeferred != oMapNameToDeferredDrivers.end() &&
+        oIterDeferred->second != poDriver )
+    {
+        GDALDeferredDriver* poDeferredDriver =
+            cpl::down_cast<GDALDeferredDriver*>(oIterDeferred->second);
+        if( poDeferredDriver->IsLoading() )
+        {
+            oMapNameToDeferredDrivers.erase(oIterDeferred);
+            SetDefaultCapabilities(poDriver);
+            poDeferredDriver->SetRealDriver(poDriver);
+            m_poOpenSignatureTable.reset();
+            for( int i = 0; i < nDrivers; ++i )
+            {
+                if( papoDrivers[i] == poDeferredDriver )
+                    return i;
+            }
+            CPLAssert( false );
+            return -1;
+        }
+    }
+
 /* -------------------------------------------------------------------- */
 /*      If it is already registered, just return the existing           */
 /*      index.                                                          */
@@ -458,6 +824,24 @@ int GDALDriverManager::RegisterDriver( GDALDriver * poDriver )
     papoDrivers[nDrivers] = poDriver;
     ++nDrivers;
 
+    SetDefaultCapabilities(poDriver);
+
+    oMapNameToDrivers[osName] = poDriver;
+    m_poOpenSignatureTable.reset();
+
+    int iResult = nDrivers - 1;
+
+    return iResult;
+}
+
+/************************************************************************/
+/*                       SetDefaultCapabilities()                       */
+/************************************************************************/
+
+// Derive the DCAP_ metadata items from the callbacks set on the driver.
+void GDALDriverManager::SetDefaultCapabilities( GDALDriver * poDriver )
+
+{
     if( poDriver->pfnOpen != nullptr ||
         poDriver->pfnOpenWithDriverArg != nullptr )
         poDriver->SetMetadataItem( GDAL_DCAP_OPEN, "YES" );
@@ -495,13 +879,6 @@ int GDALDriverManager::RegisterDriver( GDALDriver * poDriver )
                   "implement Identify(), so that it can be used",
                   poDriver->GetDescription() );
     }
-
-    oMapNameToDrivers[CPLString(poDriver->GetDescription()).toupper()] =
-        poDriver;
-
-    int iResult = nDrivers - 1;
-
-    return iResult;
 }
 
 /************************************************************************/
@@ -523,6 +900,70 @@ int CPL_STDCALL GDALRegisterDriver( GDALDriverH hDriver )
         RegisterDriver( static_cast<GDALDriver *>( hDriver ) );
 }
 
+/************************************************************************/
+/*                       DeclareDeferredDriver()                        */
+/************************************************************************/
+
+/**
+ * \brief Declare a driver whose registration is deferred to its first use.
+ *
+ * A placeholder driver is registered in place of the real one. It is
+ * returned by GetDriverByName() and GetDriver() like any other driver, but
+ * pfnRegister, the usual GDALRegister_XXX() function of the driver, is only
+ * called the first time the driver is needed: when a file matches its
+ * GDAL_DMD_OPEN_SIGNATURES, when a metadata item other than the declared
+ * ones is requested, or when Create(), CreateCopy(), Delete() ... is called.
+ *
+ * papszMetadata must contain all the following items that the real driver
+ * sets, since they are answered without loading it: GDAL_DCAP_OPEN,
+ * GDAL_DCAP_RASTER, GDAL_DCAP_VECTOR, GDAL_DCAP_GNM,
+ * GDAL_DCAP_MULTIDIM_RASTER, GDAL_DMD_LONGNAME, GDAL_DMD_EXTENSION(S), GDAL_DMD_CONNECTION_PREFIX and
+ * GDAL_DMD_OPEN_SIGNATURES. Other items are ignored.
+ *
+ * Nothing is done if a driver of the same name is already registered.
+ *
+ * @param pszName the short name of the driver.
+ * @param pfnRegister the function registering the real driver.
+ * @param papszMetadata the declared metadata items, as NAME=VALUE strings.
+ *
+ * @return the index of the new installed driver, or -1.
+ *
+ * @since GDAL 3.1
+ */
+
+int GDALDriverManager::DeclareDeferredDriver( const char * pszName,
+                                              void (*pfnRegister)( void ),
+                                              CSLConstList papszMetadata )
+
+{
+    CPLMutexHolderD( &hDMMutex );
+
+    if( GetDriverByName_unlocked( pszName ) != nullptr )
+        return -1;
+
+    GDALDeferredDriver* poDriver =
+        new GDALDeferredDriver( pszName, pfnRegister, papszMetadata );
+
+    GDALDriver** papoNewDrivers = static_cast<GDALDriver **>(
+        VSI_REALLOC_VERBOSE(papoDrivers, sizeof(GDALDriver *) * (nDrivers+1)) );
+    if( papoNewDrivers == nullptr )
+    {
+        delete poDriver;
+        return -1;
+    }
+    papoDrivers = papoNewDrivers;
+
+    papoDrivers[nDrivers] = poDriver;
+    ++nDrivers;
+
+    const CPLString osName(CPLString(pszName).toupper());
+    oMapNameToDrivers[osName] = poDriver;
+    oMapNameToDeferredDrivers[osName] = poDriver;
+    m_poOpenSignatureTable.reset();
+
+    return nDrivers - 1;
+}
+
 /************************************************************************/
 /*                          DeregisterDriver()                          */
 /************************************************************************/
@@ -553,6 +994,9 @@ void GDALDriverManager::DeregisterDriver( GDALDriver * poDriver )
         return;
 
     oMapNameToDrivers.erase(CPLString(poDriver->GetDescription()).toupper());
+    oMapNameToDeferredDrivers.erase(
+                        CPLString(poDriver->GetDescription()).toupper());
+    m_poOpenSignatureTable.reset();
     --nDrivers;
     // Move all following drivers down by one to pack the list.
     while( i < nDrivers )
@@ -580,6 +1024,139 @@ void CPL_STDCALL GDALDeregisterDriver( GDALDriverH hDriver )
     GetGDALDriverManager()->DeregisterDriver( static_cast<GDALDriver *>(hDriver) );
 }
 
+/************************************************************************/
+/*                      GetOpenCandidateDrivers()                       */
+/************************************************************************/
+
+//! @cond Doxygen_Suppress
+/**
+ * \brief Return the drivers that GDALOpenEx() must try on a file.
+ *
+ * Drivers that declare GDAL_DMD_OPEN_SIGNATURES are only returned if the
+ * header matches one of their signatures, unless the header is empty (non
+ * file based datasets, directories, ...). Other drivers are always returned.
+ * The registration order is preserved.
+ *
+ * @param pabyHeader the first bytes of the file.
+ * @param nHeaderBytes the number of bytes in pabyHeader.
+ * @param apoDrivers the vector to fill with the candidate drivers.
+ */
+void GDALDriverManager::GetOpenCandidateDrivers(
+                                    const GByte* pabyHeader, int nHeaderBytes,
+                                    std::vector<GDALDriver*>& apoDrivers )
+{
+    CPLMutexHolderD( &hDMMutex );
+
+    apoDrivers.clear();
+    if( nHeaderBytes == 0 ||
+        !CPLTestBool(CPLGetConfigOption("GDAL_OPEN_USE_SIGNATURES", "YES")) )
+    {
+        apoDrivers.insert(apoDrivers.end(), papoDrivers,
+                          papoDrivers + nDrivers);
+        return;
+    }
+
+    if( !m_poOpenSignatureTable )
+    {
+        m_poOpenSignatureTable.reset(new OpenSignatureTable());
+        auto& aoTrie = m_poOpenSignatureTable->aoTrie;
+        m_poOpenSignatureTable->abHasSignatures.resize(nDrivers);
+        for( int iDriver = 0; iDriver < nDrivers; ++iDriver )
+        {
+            const char* pszSignatures = papoDrivers[iDriver]->
+                GetMetadataItem(GDAL_DMD_OPEN_SIGNATURES);
+            if( pszSignatures == nullptr )
+                continue;
+            const CPLStringList aosSignatures(
+                CSLTokenizeString2(pszSignatures, " ", 0));
+            for( int i = 0; i < aosSignatures.size(); i++ )
+            {
+                const char* pszSig = aosSignatures[i];
+                const char* pszColon = strchr(pszSig, ':');
+                int nBytes = 0;
+                GByte* pabyBytes = pszColon ?
+                    CPLHexToBinary(pszColon + 1, &nBytes) : nullptr;
+                if( pszColon == nullptr || nBytes == 0 )
+                {
+                    CPLFree(pabyBytes);
+                    CPLDebug("GDAL", "Invalid signature %s for driver %s",
+                             pszSig, papoDrivers[iDriver]->GetDescription());
+                    continue;
+                }
+                m_poOpenSignatureTable->abHasSignatures[iDriver] = true;
+
+                const int nOffset = atoi(pszSig);
+                if( nOffset == 0 )
+                {
+                    int iNode = 0;
+                    for( int j = 0; j < nBytes; j++ )
+                    {
+                        auto oIter =
+                            aoTrie[iNode].oMapChildren.find(pabyBytes[j]);
+                        if( oIter == aoTrie[iNode].oMapChildren.end() )
+                        {
+                            aoTrie.emplace_back();
+                            const int iNewNode =
+                                static_cast<int>(aoTrie.size()) - 1;
+                            aoTrie[iNode].oMapChildren[pabyBytes[j]] =
+                                iNewNode;
+                            iNode = iNewNode;
+                        }
+                        else
+                        {
+                            iNode = oIter->second;
+                        }
+                    }
+                    aoTrie[iNode].anDrivers.push_back(iDriver);
+                }
+                else
+                {
+                    OpenSignatureTable::OffsetSignature sSig;
+                    sSig.nOffset = nOffset;
+                    sSig.abyBytes.assign(pabyBytes, pabyBytes + nBytes);
+                    sSig.iDriver = iDriver;
+                    m_poOpenSignatureTable->aoOffsetSignatures.push_back(sSig);
+                }
+                CPLFree(pabyBytes);
+            }
+        }
+    }
+
+    auto& abMatched = m_poOpenSignatureTable->abMatched;
+    abMatched.assign(nDrivers, false);
+
+    const auto& aoTrie = m_poOpenSignatureTable->aoTrie;
+    int iNode = 0;
+    for( int i = 0; i < nHeaderBytes; i++ )
+    {
+        const auto oIter = aoTrie[iNode].oMapChildren.find(pabyHeader[i]);
+        if( oIter == aoTrie[iNode].oMapChildren.end() )
+            break;
+        iNode = oIter->second;
+        for( const int iDriver: aoTrie[iNode].anDrivers )
+            abMatched[iDriver] = true;
+    }
+
+    for( const auto& sSig: m_poOpenSignatureTable->aoOffsetSignatures )
+    {
+        if( static_cast<size_t>(nHeaderBytes) >=
+                sSig.nOffset + sSig.abyBytes.size() &&
+            memcmp(pabyHeader + sSig.nOffset, sSig.abyBytes.data(),
+                   sSig.abyBytes.size()) == 0 )
+        {
+            abMatched[sSig.iDriver] = true;
+        }
+    }
+
+    const auto& abHasSignatures = m_poOpenSignatureTable->abHasSignatures;
+    for( int iDriver = 0; iDriver < nDrivers; ++iDriver )
+    {
+        if( !abHasSignatures[iDriver] || abMatched[iDriver] )
+            apoDrivers.push_back(papoDrivers[iDriver]);
+    }
+}
+//! @endcond
+
 /************************************************************************/
 /*                          GetDriverByName()                           */
 /************************************************************************/
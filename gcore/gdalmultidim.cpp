@@ -30,9 +30,15 @@
 
 #include <assert.h>
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <mutex>
 
 #include "gdal_priv.h"
 #include "cpl_safemaths.hpp"
+#include "cpl_worker_thread_pool.h"
 
 #if defined(__clang__) || defined(_MSC_VER)
 #define COMPILER_WARNS_ABOUT_ABSTRACT_VBASE_INIT
@@ -1811,47 +1817,16 @@ namespace
     };
 }
 
-/** \brief Call a user-provided function to operate on an array chunk by chunk.
- *
- * This method is to be used when doing operations on an array, or a subset of it,
- * in a chunk by chunk way.
- *
- * @param arrayStartIdx Values representing the starting index to use
- *                      in each dimension (in [0, aoDims[i].GetSize()-1] range).
- *                      Array of GetDimensionCount() values. Must not be
- *                      nullptr, unless for a zero-dimensional array.
- *
- * @param count         Values representing the number of values to use in
- *                      each dimension.
- *                      Array of GetDimensionCount() values. Must not be
- *                      nullptr, unless for a zero-dimensional array.
- *
- * @param chunkSize     Values representing the chunk size in each dimension.
- *                      Might typically the outptu of GetProcessingChunkSize().
- *                      Array of GetDimensionCount() values. Must not be
- *                      nullptr, unless for a zero-dimensional array.
- *
- * @param pfnFunc       User-provided function of type FuncProcessPerChunkType.
- *                      Must NOT be nullptr.
- *
- * @param pUserData     Pointer to pass as the value of the pUserData argument of
- *                      FuncProcessPerChunkType. Might be nullptr (depends on
- *                      pfnFunc.
- *
- * @return true in case of success.
- */
-bool GDALAbstractMDArray::ProcessPerChunk(const GUInt64* arrayStartIdx,
-                                          const GUInt64* count,
-                                          const size_t* chunkSize,
-                                          FuncProcessPerChunkType pfnFunc,
-                                          void* pUserData)
-{
-    const auto& dims = GetDimensions();
-    if( dims.empty() )
-    {
-        return pfnFunc(this, nullptr, nullptr, 1, 1, pUserData);
-    }
+/************************************************************************/
+/*                        CheckChunkParameters()                        */
+/************************************************************************/
 
+static bool CheckChunkParameters(
+                const std::vector<std::shared_ptr<GDALDimension>>& dims,
+                const GUInt64* arrayStartIdx,
+                const GUInt64* count,
+                const size_t* chunkSize)
+{
     // Sanity check
     size_t nTotalChunkSize = 1;
     for( size_t i = 0; i < dims.size(); i++ )
@@ -1876,9 +1851,25 @@ bool GDALAbstractMDArray::ProcessPerChunk(const GUInt64* arrayStartIdx,
         nTotalChunkSize *= chunkSize[i];
     }
 
+    return true;
+}
+
+/************************************************************************/
+/*                            ForEachChunk()                            */
+/************************************************************************/
+
+// Calls func(chunkArrayStartIdx, chunkCount, iCurChunk, nChunkCount) for
+// each chunk, in order, until it returns false.
+template<class Func>
+static bool ForEachChunk(size_t nDims,
+                         const GUInt64* arrayStartIdx,
+                         const GUInt64* count,
+                         const size_t* chunkSize,
+                         Func func)
+{
     size_t dimIdx = 0;
-    std::vector<GUInt64> chunkArrayStartIdx(dims.size());
-    std::vector<size_t> chunkCount(dims.size());
+    std::vector<GUInt64> chunkArrayStartIdx(nDims);
+    std::vector<size_t> chunkCount(nDims);
     struct Stack
     {
         GUInt64 nBlockCounter = 0;
@@ -1886,10 +1877,10 @@ bool GDALAbstractMDArray::ProcessPerChunk(const GUInt64* arrayStartIdx,
         size_t  first_count = 0; // only used if nBlocks > 1
         Caller  return_point = Caller::CALLER_END_OF_LOOP;
     };
-    std::vector<Stack> stack(dims.size());
+    std::vector<Stack> stack(nDims);
     GUInt64 iCurChunk = 0;
     GUInt64 nChunkCount = 1;
-    for( size_t i = 0; i < dims.size(); i++ )
+    for( size_t i = 0; i < nDims; i++ )
     {
         const auto nStartBlock = arrayStartIdx[i] / chunkSize[i];
         const auto nEndBlock = (arrayStartIdx[i] + count[i] - 1) / chunkSize[i];
@@ -1908,11 +1899,11 @@ bool GDALAbstractMDArray::ProcessPerChunk(const GUInt64* arrayStartIdx,
     }
 
 lbl_next_depth:
-    if( dimIdx == dims.size() )
+    if( dimIdx == nDims )
     {
         ++ iCurChunk;
-        if( !pfnFunc(this, chunkArrayStartIdx.data(), chunkCount.data(),
-                     iCurChunk, nChunkCount, pUserData) )
+        if( !func(chunkArrayStartIdx.data(), chunkCount.data(),
+                  iCurChunk, nChunkCount) )
         {
             return false;
         }
@@ -1959,6 +1950,221 @@ end:
     return true;
 }
 
+/** \brief Call a user-provided function to operate on an array chunk by chunk.
+ *
+ * This method is to be used when doing operations on an array, or a subset of it,
+ * in a chunk by chunk way.
+ *
+ * @param arrayStartIdx Values representing the starting index to use
+ *                      in each dimension (in [0, aoDims[i].GetSize()-1] range).
+ *                      Array of GetDimensionCount() values. Must not be
+ *                      nullptr, unless for a zero-dimensional array.
+ *
+ * @param count         Values representing the number of values to use in
+ *                      each dimension.
+ *                      Array of GetDimensionCount() values. Must not be
+ *                      nullptr, unless for a zero-dimensional array.
+ *
+ * @param chunkSize     Values representing the chunk size in each dimension.
+ *                      Might typically the outptu of GetProcessingChunkSize().
+ *                      Array of GetDimensionCount() values. Must not be
+ *                      nullptr, unless for a zero-dimensional array.
+ *
+ * @param pfnFunc       User-provided function of type FuncProcessPerChunkType.
+ *                      Must NOT be nullptr.
+ *
+ * @param pUserData     Pointer to pass as the value of the pUserData argument of
+ *                      FuncProcessPerChunkType. Might be nullptr (depends on
+ *                      pfnFunc.
+ *
+ * @return true in case of success.
+ */
+bool GDALAbstractMDArray::ProcessPerChunk(const GUInt64* arrayStartIdx,
+                                          const GUInt64* count,
+                                          const size_t* chunkSize,
+                                          FuncProcessPerChunkType pfnFunc,
+                                          void* pUserData)
+{
+    const auto& dims = GetDimensions();
+    if( dims.empty() )
+    {
+        return pfnFunc(this, nullptr, nullptr, 1, 1, pUserData);
+    }
+
+    if( !CheckChunkParameters(dims, arrayStartIdx, count, chunkSize) )
+        return false;
+
+    return ForEachChunk(dims.size(), arrayStartIdx, count, chunkSize,
+        [this, pfnFunc, pUserData](const GUInt64* chunkArrayStartIdx,
+                                   const size_t* chunkCount,
+                                   GUInt64 iCurChunk,
+                                   GUInt64 nChunkCount)
+        {
+            return pfnFunc(this, chunkArrayStartIdx, chunkCount,
+                           iCurChunk, nChunkCount, pUserData);
+        });
+}
+
+/** \brief Call a user-provided function to operate on an array chunk by chunk,
+ * possibly from several threads.
+ *
+ * This is the same as the other ProcessPerChunk() method, except that chunks
+ * are dispatched to a pool of worker threads when the NUM_THREADS option is
+ * set (or the GDAL_NUM_THREADS configuration option) and IsReadThreadSafe()
+ * returns true. pfnFunc is then called concurrently, in no particular order,
+ * and must be thread-safe. iCurChunk still identifies the chunk in the order
+ * of the sequential iteration.
+ *
+ * At most MAX_PENDING_CHUNKS chunks are submitted to the workers and not yet
+ * processed, which bounds the memory used when pfnFunc allocates a buffer
+ * per chunk. When pfnFunc returns false, no further chunk is submitted.
+ *
+ * @param arrayStartIdx See the other ProcessPerChunk() method.
+ * @param count         See the other ProcessPerChunk() method.
+ * @param chunkSize     See the other ProcessPerChunk() method. Chunks aligned
+ *                      on GetBlockSize(), as returned by
+ *                      GetProcessingChunkSize(), avoid that several threads
+ *                      decode the same blocks.
+ * @param pfnFunc       User-provided function of type FuncProcessPerChunkType.
+ *                      Must NOT be nullptr.
+ * @param pUserData     Pointer to pass as the value of the pUserData argument of
+ *                      FuncProcessPerChunkType.
+ * @param papszOptions  NULL-terminated list of options, or nullptr:
+ *                      <ul>
+ *                      <li>NUM_THREADS=number or ALL_CPUS. Defaults to the
+ *                      GDAL_NUM_THREADS configuration option, or 1.</li>
+ *                      <li>MAX_PENDING_CHUNKS=number. Defaults to twice the
+ *                      number of threads.</li>
+ *                      </ul>
+ *
+ * @return true in case of success.
+ * @since GDAL 3.1
+ */
+bool GDALAbstractMDArray::ProcessPerChunk(const GUInt64* arrayStartIdx,
+                                          const GUInt64* count,
+                                          const size_t* chunkSize,
+                                          FuncProcessPerChunkType pfnFunc,
+                                          void* pUserData,
+                                          CSLConstList papszOptions)
+{
+    const int nThreads = CPLGetNumThreadsOption(
+        CSLFetchNameValue(papszOptions, "NUM_THREADS"), "1");
+    const auto& dims = GetDimensions();
+    if( nThreads <= 1 || dims.empty() || !IsReadThreadSafe() )
+    {
+        return ProcessPerChunk(arrayStartIdx, count, chunkSize,
+                               pfnFunc, pUserData);
+    }
+
+    if( !CheckChunkParameters(dims, arrayStartIdx, count, chunkSize) )
+        return false;
+
+    CPLWorkerThreadPool oPool;
+    if( !oPool.Setup(nThreads, nullptr, nullptr) )
+    {
+        return ProcessPerChunk(arrayStartIdx, count, chunkSize,
+                               pfnFunc, pUserData);
+    }
+
+    const int nMaxPending = std::max(1, atoi(CSLFetchNameValueDef(
+        papszOptions, "MAX_PENDING_CHUNKS", CPLSPrintf("%d", 2 * nThreads))));
+
+    struct Job
+    {
+        GDALAbstractMDArray*  poArray = nullptr;
+        std::vector<GUInt64>  anStartIdx{};
+        std::vector<size_t>   anCount{};
+        GUInt64               iCurChunk = 0;
+        GUInt64               nChunkCount = 0;
+        FuncProcessPerChunkType pfnFunc = nullptr;
+        void*                 pUserData = nullptr;
+        std::mutex*           pMutex = nullptr;
+        std::condition_variable* pCond = nullptr;
+        int*                  pnPending = nullptr;
+        bool*                 pbError = nullptr;
+
+        static void Run(void* pData)
+        {
+            Job* job = static_cast<Job*>(pData);
+            bool bSkip;
+            {
+                std::lock_guard<std::mutex> oLock(*job->pMutex);
+                bSkip = *job->pbError;
+            }
+            const bool bOK = bSkip ||
+                job->pfnFunc(job->poArray, job->anStartIdx.data(),
+                             job->anCount.data(), job->iCurChunk,
+                             job->nChunkCount, job->pUserData);
+            {
+                std::lock_guard<std::mutex> oLock(*job->pMutex);
+                if( !bOK )
+                    *job->pbError = true;
+                -- (*job->pnPending);
+            }
+            job->pCond->notify_one();
+            delete job;
+        }
+    };
+
+    std::mutex oMutex;
+    std::condition_variable oCond;
+    int nPending = 0;
+    bool bError = false;
+    const size_t nDims = dims.size();
+
+    ForEachChunk(nDims, arrayStartIdx, count, chunkSize,
+        [&](const GUInt64* chunkArrayStartIdx,
+            const size_t* chunkCount,
+            GUInt64 iCurChunk,
+            GUInt64 nChunkCount)
+        {
+            {
+                std::unique_lock<std::mutex> oLock(oMutex);
+                oCond.wait(oLock, [&]{ return nPending < nMaxPending || bError; });
+                if( bError )
+                    return false;
+                ++ nPending;
+            }
+            Job* job = new Job();
+            job->poArray = this;
+            job->anStartIdx.assign(chunkArrayStartIdx, chunkArrayStartIdx + nDims);
+            job->anCount.assign(chunkCount, chunkCount + nDims);
+            job->iCurChunk = iCurChunk;
+            job->nChunkCount = nChunkCount;
+            job->pfnFunc = pfnFunc;
+            job->pUserData = pUserData;
+            job->pMutex = &oMutex;
+            job->pCond = &oCond;
+            job->pnPending = &nPending;
+            job->pbError = &bError;
+            if( !oPool.SubmitJob(Job::Run, job) )
+                Job::Run(job);
+            return true;
+        });
+
+    oPool.WaitCompletion();
+    return !bError;
+}
+
+/************************************************************************/
+/*                          IsReadThreadSafe()                          */
+/************************************************************************/
+
+/** Return whether Read() can be called concurrently from several threads
+ * on this array.
+ *
+ * The default implementation returns false. Drivers whose read path is
+ * protected, for example by a lock around a non thread-safe library, return
+ * true, which enables the multi-threaded ProcessPerChunk() and the read-ahead
+ * of CopyFrom().
+ *
+ * @since GDAL 3.1
+ */
+bool GDALAbstractMDArray::IsReadThreadSafe() const
+{
+    return false;
+}
+
 /************************************************************************/
 /*                          GDALAttribute()                             */
 /************************************************************************/
@@ -2495,6 +2701,361 @@ GDALMDArray::GDALMDArray(CPL_UNUSED const std::string &osParentName,
 {}
 //! @endcond
 
+/************************************************************************/
+/*                        GDALMDArrayChunkCache                         */
+/************************************************************************/
+
+namespace {
+
+// Process-wide LRU cache of whole chunks of arrays, in their native data
+// type. Its size is accounted against GDAL_CACHEMAX together with the one of
+// the raster block cache, which takes precedence.
+class GDALMDArrayChunkCache
+{
+public:
+    typedef std::shared_ptr<std::vector<GByte>> ChunkPtr;
+    typedef std::pair<GUInt64, std::vector<GUInt64>> Key;
+
+    static GDALMDArrayChunkCache& Get()
+    {
+        // Intentionally leaked, as arrays may be destroyed after static
+        // objects.
+        static GDALMDArrayChunkCache* poCache = new GDALMDArrayChunkCache();
+        return *poCache;
+    }
+
+    GUInt64 GetArrayId(GUInt64& nArrayId)
+    {
+        std::lock_guard<std::mutex> oLock(m_oMutex);
+        if( nArrayId == 0 )
+            nArrayId = ++m_nLastArrayId;
+        return nArrayId;
+    }
+
+    ChunkPtr Find(const Key& oKey)
+    {
+        std::lock_guard<std::mutex> oLock(m_oMutex);
+        auto oIter = m_oMap.find(oKey);
+        if( oIter == m_oMap.end() )
+            return nullptr;
+        m_oLRU.splice(m_oLRU.begin(), m_oLRU, oIter->second);
+        return oIter->second->poChunk;
+    }
+
+    // Maximum size of the cache, that is what the raster block cache leaves
+    // of GDAL_CACHEMAX.
+    static GIntBig GetCapacity()
+    {
+        return GDALGetCacheMax64() - GDALGetCacheUsed64();
+    }
+
+    void Insert(const Key& oKey, const ChunkPtr& poChunk)
+    {
+        const GIntBig nSize = static_cast<GIntBig>(poChunk->size());
+        const GIntBig nMaxSize = GetCapacity() - nSize;
+        std::lock_guard<std::mutex> oLock(m_oMutex);
+        auto oIter = m_oMap.find(oKey);
+        if( oIter != m_oMap.end() )
+            RemoveEntry(oIter);
+        TrimUnlocked(nMaxSize);
+        if( nMaxSize < 0 )
+            return;
+        m_oLRU.emplace_front(Entry{oKey, poChunk});
+        m_oMap[oKey] = m_oLRU.begin();
+        m_nUsed += nSize;
+    }
+
+    void RemoveArray(GUInt64 nArrayId)
+    {
+        // Chunk indices are non-negative and keys have at least one of
+        // them, so {0} sorts before all the chunk keys of the array.
+        const Key oFirstKey(nArrayId, std::vector<GUInt64>(1, 0));
+        std::lock_guard<std::mutex> oLock(m_oMutex);
+        auto oIter = m_oMap.lower_bound(oFirstKey);
+        while( oIter != m_oMap.end() && oIter->first.first == nArrayId )
+            oIter = RemoveEntry(oIter);
+    }
+
+    void Trim(GIntBig nMaxSize)
+    {
+        if( m_nUsed <= std::max(nMaxSize, static_cast<GIntBig>(0)) )
+            return;
+        std::lock_guard<std::mutex> oLock(m_oMutex);
+        TrimUnlocked(nMaxSize);
+    }
+
+private:
+    struct Entry
+    {
+        Key      oKey;
+        ChunkPtr poChunk;
+    };
+
+    std::mutex m_oMutex{};
+    std::list<Entry> m_oLRU{}; // most recently used first
+    std::map<Key, std::list<Entry>::iterator> m_oMap{};
+    std::atomic<GIntBig> m_nUsed{0};
+    GUInt64 m_nLastArrayId = 0;
+
+    GDALMDArrayChunkCache() = default;
+
+    std::map<Key, std::list<Entry>::iterator>::iterator
+        RemoveEntry(std::map<Key, std::list<Entry>::iterator>::iterator oIter)
+    {
+        m_nUsed -= static_cast<GIntBig>(oIter->second->poChunk->size());
+        m_oLRU.erase(oIter->second);
+        return m_oMap.erase(oIter);
+    }
+
+    void TrimUnlocked(GIntBig nMaxSize)
+    {
+        while( !m_oLRU.empty() && m_nUsed > nMaxSize )
+            RemoveEntry(m_oMap.find(m_oLRU.back().oKey));
+    }
+};
+
+} // namespace
+
+//! @cond Doxygen_Suppress
+void GDALMDArrayChunkCacheTrim(GIntBig nMaxSize)
+{
+    GDALMDArrayChunkCache::Get().Trim(nMaxSize);
+}
+//! @endcond
+
+/************************************************************************/
+/*                          ~GDALMDArray()                              */
+/************************************************************************/
+
+//! @cond Doxygen_Suppress
+GDALMDArray::~GDALMDArray()
+{
+    if( m_nChunkCacheId != 0 )
+        GDALMDArrayChunkCache::Get().RemoveArray(m_nChunkCacheId);
+}
+//! @endcond
+
+/************************************************************************/
+/*                         ReadFromChunkCache()                         */
+/************************************************************************/
+
+//! @cond Doxygen_Suppress
+/** Serve a read request from the chunk cache.
+ *
+ * Meant to be called at the beginning of IRead() by drivers of chunked
+ * formats. When the request only uses a small part of the chunks it
+ * intersects, typically pixel-drill or strided reads, the whole chunks are
+ * read in their native data type through IRead(), cached, and the request is
+ * served from them, so that subsequent requests touching the same chunks do
+ * not decompress them again.
+ *
+ * Chunks are cached per array object. As drivers may return a new object for
+ * each OpenMDArray() call, writes through one of them would not be seen by
+ * the others, so writable arrays are not cached.
+ *
+ * This can be disabled by setting the GDAL_MDARRAY_CHUNK_CACHE configuration
+ * option to NO.
+ *
+ * @return true if the request has been processed, in which case bRet is set
+ * to its success status. false if IRead() must process it itself.
+ */
+bool GDALMDArray::ReadFromChunkCache(const GUInt64* arrayStartIdx,
+                                     const size_t* count,
+                                     const GInt64* arrayStep,
+                                     const GPtrDiff_t* bufferStride,
+                                     const GDALExtendedDataType& bufferDataType,
+                                     void* pDstBuffer,
+                                     bool& bRet) const
+{
+    const size_t nDims = GetDimensionCount();
+    const auto& dt = GetDataType();
+    if( nDims == 0 || dt.GetClass() != GEDTC_NUMERIC ||
+        bufferDataType.GetClass() != GEDTC_NUMERIC || IsWritable() )
+    {
+        return false;
+    }
+    const auto anBlockSize = GetBlockSize();
+    if( anBlockSize.size() != nDims )
+        return false;
+    for( const auto nBlockSize: anBlockSize )
+    {
+        if( nBlockSize == 0 || nBlockSize > std::numeric_limits<int>::max() )
+            return false;
+    }
+    if( !CPLTestBool(CPLGetConfigOption("GDAL_MDARRAY_CHUNK_CACHE", "YES")) )
+        return false;
+
+    const size_t nDTSize = dt.GetSize();
+    const size_t nBufferDTSize = bufferDataType.GetSize();
+    const GPtrDiff_t nLastStrideBytes = bufferStride[nDims - 1] *
+        static_cast<GPtrDiff_t>(nBufferDTSize);
+    if( nLastStrideBytes > std::numeric_limits<int>::max() ||
+        nLastStrideBytes < -std::numeric_limits<int>::max() )
+    {
+        return false;
+    }
+
+    // Only worth it if the request uses a small part of the chunks it
+    // intersects, and if all of them can be kept in the cache. Otherwise
+    // each request would decompress whole chunks and drop them.
+    const auto& dims = GetDimensions();
+    double dfRequested = 1;
+    double dfTouched = 1;
+    for( size_t i = 0; i < nDims; i++ )
+    {
+        const GUInt64 nBlockSize = anBlockSize[i];
+        const GUInt64 nDimSize = dims[i]->GetSize();
+        dfRequested *= static_cast<double>(count[i]);
+        if( count[i] == 1 ||
+            static_cast<GUInt64>(std::abs(arrayStep[i])) < nBlockSize )
+        {
+            const GUInt64 nLastIdx = static_cast<GUInt64>(
+                arrayStartIdx[i] + (count[i] - 1) * arrayStep[i]);
+            const GUInt64 nFirstChunk =
+                std::min(arrayStartIdx[i], nLastIdx) / nBlockSize;
+            const GUInt64 nLastChunk =
+                std::max(arrayStartIdx[i], nLastIdx) / nBlockSize;
+            dfTouched *= static_cast<double>(
+                std::min((nLastChunk + 1) * nBlockSize, nDimSize) -
+                nFirstChunk * nBlockSize);
+        }
+        else
+        {
+            dfTouched *= static_cast<double>(count[i]) *
+                         static_cast<double>(nBlockSize);
+        }
+    }
+    if( dfRequested * 2 >= dfTouched ||
+        dfTouched * nDTSize >
+            static_cast<double>(GDALMDArrayChunkCache::GetCapacity()) )
+    {
+        return false;
+    }
+
+    // Chunk index, and index within the chunk, of each requested index
+    std::vector<std::vector<GUInt64>> aanChunkIdx(nDims);
+    std::vector<std::vector<size_t>> aanIdxInChunk(nDims);
+    for( size_t i = 0; i < nDims; i++ )
+    {
+        aanChunkIdx[i].resize(count[i]);
+        aanIdxInChunk[i].resize(count[i]);
+        for( size_t j = 0; j < count[i]; j++ )
+        {
+            const GUInt64 nIdx = static_cast<GUInt64>(
+                arrayStartIdx[i] + j * arrayStep[i]);
+            aanChunkIdx[i][j] = nIdx / anBlockSize[i];
+            aanIdxInChunk[i][j] = static_cast<size_t>(nIdx % anBlockSize[i]);
+        }
+    }
+
+    auto& oCache = GDALMDArrayChunkCache::Get();
+    GDALMDArrayChunkCache::Key oKey;
+    oKey.first = oCache.GetArrayId(m_nChunkCacheId);
+    oKey.second.resize(nDims);
+
+    std::vector<GUInt64> anChunkStart(nDims);
+    std::vector<size_t> anChunkCount(nDims);
+    std::vector<GInt64> anChunkStep(nDims, 1);
+    std::vector<GPtrDiff_t> anChunkStride(nDims);
+    const size_t iLast = nDims - 1;
+    const auto eDT = dt.GetNumericDataType();
+    const auto eBufferDT = bufferDataType.GetNumericDataType();
+    std::vector<size_t> anIdx(nDims);
+    while( true )
+    {
+        GByte* pabyDstRow = static_cast<GByte*>(pDstBuffer);
+        for( size_t i = 0; i < iLast; i++ )
+        {
+            oKey.second[i] = aanChunkIdx[i][anIdx[i]];
+            pabyDstRow += anIdx[i] * bufferStride[i] *
+                          static_cast<GPtrDiff_t>(nBufferDTSize);
+        }
+
+        // Process the innermost dimension by runs of indices in the same
+        // chunk
+        size_t j = 0;
+        while( j < count[iLast] )
+        {
+            const size_t jStart = j;
+            oKey.second[iLast] = aanChunkIdx[iLast][j];
+            while( j < count[iLast] &&
+                   aanChunkIdx[iLast][j] == oKey.second[iLast] )
+            {
+                j++;
+            }
+
+            size_t nChunkElts = 1;
+            for( size_t i = nDims; i != 0; )
+            {
+                --i;
+                anChunkStart[i] = oKey.second[i] * anBlockSize[i];
+                anChunkCount[i] = static_cast<size_t>(std::min(
+                    anBlockSize[i], dims[i]->GetSize() - anChunkStart[i]));
+                anChunkStride[i] = static_cast<GPtrDiff_t>(nChunkElts);
+                nChunkElts *= anChunkCount[i];
+            }
+
+            auto poChunk = oCache.Find(oKey);
+            if( !poChunk )
+            {
+                poChunk = std::make_shared<std::vector<GByte>>();
+                try
+                {
+                    poChunk->resize(nChunkElts * nDTSize);
+                }
+                catch( const std::exception& e )
+                {
+                    CPLError(CE_Failure, CPLE_OutOfMemory, "%s", e.what());
+                    bRet = false;
+                    return true;
+                }
+                // The request covers exactly the chunk, so this does not
+                // recurse into the cache.
+                if( !IRead(anChunkStart.data(), anChunkCount.data(),
+                           anChunkStep.data(), anChunkStride.data(),
+                           dt, poChunk->data()) )
+                {
+                    bRet = false;
+                    return true;
+                }
+                oCache.Insert(oKey, poChunk);
+            }
+
+            size_t nOffset = aanIdxInChunk[iLast][jStart];
+            for( size_t i = 0; i < iLast; i++ )
+                nOffset += aanIdxInChunk[i][anIdx[i]] * anChunkStride[i];
+            const int nSrcStep = j - jStart > 1 ?
+                static_cast<int>(arrayStep[iLast] *
+                                 static_cast<GInt64>(nDTSize)) : 0;
+            GDALCopyWords64(poChunk->data() + nOffset * nDTSize,
+                            eDT, nSrcStep,
+                            pabyDstRow + jStart * nLastStrideBytes,
+                            eBufferDT, static_cast<int>(nLastStrideBytes),
+                            static_cast<GPtrDiff_t>(j - jStart));
+        }
+
+        // Next row
+        size_t i = iLast;
+        while( i != 0 )
+        {
+            --i;
+            if( ++anIdx[i] < count[i] )
+                break;
+            anIdx[i] = 0;
+            if( i == 0 )
+            {
+                bRet = true;
+                return true;
+            }
+        }
+        if( iLast == 0 )
+            break;
+    }
+    bRet = true;
+    return true;
+}
+//! @endcond
+
 /************************************************************************/
 /*                           GetTotalCopyCost()                         */
 /************************************************************************/
@@ -2586,6 +3147,157 @@ bool GDALMDArray::CopyFromAllExceptValues(const GDALMDArray* poSrcArray,
 
 //! @endcond
 
+/************************************************************************/
+/*                          CopyWithReadAhead()                         */
+/************************************************************************/
+
+// Copies poSrcArray into poDstArray chunk by chunk. The pool threads read up
+// to nMaxPending chunks ahead while the calling thread writes them in order,
+// so poDstArray does not need to be thread-safe.
+static bool CopyWithReadAhead(const GDALMDArray* poSrcArray,
+                              GDALMDArray* poDstArray,
+                              CPLWorkerThreadPool& oPool,
+                              size_t nMaxPending,
+                              const std::vector<size_t>& anChunkSizes,
+                              GUInt64 nCurCost,
+                              GUInt64 nTotalCost,
+                              GUInt64 nTotalBytesThisArray,
+                              GDALProgressFunc pfnProgress,
+                              void* pProgressData,
+                              bool& bStop)
+{
+    const auto& dims = poSrcArray->GetDimensions();
+    const size_t nDims = dims.size();
+    const auto dt(poSrcArray->GetDataType());
+    const auto nDTSize = dt.GetSize();
+    std::vector<GUInt64> arrayStartIdx(nDims);
+    std::vector<GUInt64> count(nDims);
+    for( size_t i = 0; i < nDims; i++ )
+    {
+        count[i] = dims[i]->GetSize();
+    }
+
+    struct Chunk
+    {
+        const GDALMDArray*       poSrcArray = nullptr;
+        std::vector<GUInt64>     anStartIdx{};
+        std::vector<size_t>      anCount{};
+        size_t                   nEltCount = 1;
+        GUInt64                  iCurChunk = 0;
+        GUInt64                  nChunkCount = 0;
+        std::vector<GByte>       abyData{};
+        bool                     bDone = false;
+        bool                     bOK = false;
+        std::mutex*              pMutex = nullptr;
+        std::condition_variable* pCond = nullptr;
+
+        static void Read(void* pData)
+        {
+            Chunk* chunk = static_cast<Chunk*>(pData);
+            const bool bOK = chunk->poSrcArray->Read(
+                chunk->anStartIdx.data(), chunk->anCount.data(),
+                nullptr, nullptr,
+                chunk->poSrcArray->GetDataType(), chunk->abyData.data());
+            {
+                std::lock_guard<std::mutex> oLock(*chunk->pMutex);
+                chunk->bOK = bOK;
+                chunk->bDone = true;
+            }
+            chunk->pCond->notify_all();
+        }
+
+        void FreeDynamicMemory(const GDALExtendedDataType& l_dt)
+        {
+            if( !bOK || !l_dt.NeedsFreeDynamicMemory() )
+                return;
+            GByte* ptr = abyData.data();
+            for( size_t i = 0; i < nEltCount; i++ )
+            {
+                l_dt.FreeDynamicMemory(ptr);
+                ptr += l_dt.GetSize();
+            }
+        }
+    };
+
+    std::mutex oMutex;
+    std::condition_variable oCond;
+    std::deque<std::unique_ptr<Chunk>> apoPending;
+
+    // Waits for the oldest chunk to be read, and writes it
+    const auto WriteOldest = [&]()
+    {
+        std::unique_ptr<Chunk> chunk(std::move(apoPending.front()));
+        apoPending.pop_front();
+        {
+            std::unique_lock<std::mutex> oLock(oMutex);
+            oCond.wait(oLock, [&chunk]{ return chunk->bDone; });
+        }
+        const bool bOK = chunk->bOK &&
+            poDstArray->Write(chunk->anStartIdx.data(), chunk->anCount.data(),
+                              nullptr, nullptr, dt, chunk->abyData.data());
+        chunk->FreeDynamicMemory(dt);
+        if( !bOK )
+            return false;
+
+        double dfCurCost = double(nCurCost) +
+            double(chunk->iCurChunk) / chunk->nChunkCount * nTotalBytesThisArray;
+        if( !pfnProgress(dfCurCost / nTotalCost, "", pProgressData) )
+        {
+            bStop = true;
+            return false;
+        }
+        return true;
+    };
+
+    bool bRet = ForEachChunk(nDims, arrayStartIdx.data(), count.data(),
+                             anChunkSizes.data(),
+        [&](const GUInt64* chunkArrayStartIdx,
+            const size_t* chunkCount,
+            GUInt64 iCurChunk,
+            GUInt64 nChunkCount)
+        {
+            if( apoPending.size() >= nMaxPending && !WriteOldest() )
+                return false;
+
+            std::unique_ptr<Chunk> chunk(new Chunk());
+            chunk->poSrcArray = poSrcArray;
+            chunk->anStartIdx.assign(chunkArrayStartIdx, chunkArrayStartIdx + nDims);
+            chunk->anCount.assign(chunkCount, chunkCount + nDims);
+            for( size_t i = 0; i < nDims; i++ )
+                chunk->nEltCount *= chunkCount[i];
+            chunk->iCurChunk = iCurChunk;
+            chunk->nChunkCount = nChunkCount;
+            chunk->pMutex = &oMutex;
+            chunk->pCond = &oCond;
+            try
+            {
+                chunk->abyData.resize(chunk->nEltCount * nDTSize);
+            }
+            catch( const std::exception& )
+            {
+                CPLError(CE_Failure, CPLE_OutOfMemory,
+                         "Cannot allocate temporary buffer");
+                return false;
+            }
+
+            Chunk* poChunk = chunk.get();
+            apoPending.push_back(std::move(chunk));
+            if( !oPool.SubmitJob(Chunk::Read, poChunk) )
+                Chunk::Read(poChunk);
+            return true;
+        });
+
+    while( bRet && !apoPending.empty() )
+        bRet = WriteOldest();
+
+    // Chunks still pending after an error must not be freed while being read
+    oPool.WaitCompletion();
+    for( auto& chunk: apoPending )
+        chunk->FreeDynamicMemory(dt);
+
+    return bRet;
+}
+
 /************************************************************************/
 /*                               CopyFrom()                             */
 /************************************************************************/
@@ -2735,6 +3447,27 @@ bool GDALMDArray::CopyFrom(CPL_UNUSED GDALDataset* poSrcDS,
             static_cast<size_t>(
                 std::min(GIntBig(std::numeric_limits<size_t>::max() / 2),
                          GDALGetCacheMax64() / 4));
+        // With GDAL_NUM_THREADS, read the next chunks while writing the
+        // current one, if the source array can be read from several threads.
+        // The swath is split among the chunks in flight.
+        const int nThreads = CPLGetNumThreadsOption(nullptr, "1");
+        CPLWorkerThreadPool oPool;
+        if( nThreads > 1 && copyFunc.nTotalBytesThisArray != 0 &&
+            poSrcArray->IsReadThreadSafe() &&
+            oPool.Setup(nThreads, nullptr, nullptr) )
+        {
+            const size_t nMaxPending = 2 * static_cast<size_t>(nThreads);
+            const auto anChunkSizes(GetProcessingChunkSize(
+                std::max<size_t>(1, nMaxChunkSize / (nMaxPending + 1))));
+            bool bStop = false;
+            const bool bRet = CopyWithReadAhead(
+                poSrcArray, this, oPool, nMaxPending, anChunkSizes,
+                nCurCost, nTotalCost, copyFunc.nTotalBytesThisArray,
+                pfnProgress, pProgressData, bStop);
+            nCurCost += copyFunc.nTotalBytesThisArray;
+            return bRet || !(bStrict || bStop);
+        }
+
         const auto anChunkSizes(GetProcessingChunkSize(nMaxChunkSize));
         size_t nRealChunkSize = nDTSize;
         for( const auto& nChunkSize: anChunkSizes )
@@ -117,6 +117,8 @@ class GDALOverviewBand final: public GDALProxyRasterBand
     GDALRasterBand*         poUnderlyingBand = nullptr;
     GDALRasterBand* RefUnderlyingRasterBand() override;
 
+    CPLErr IReadRawBlock( int, int, void**, size_t* ) override;
+
   public:
     GDALOverviewBand( GDALOverviewDataset* poDS, int nBand );
     ~GDALOverviewBand() override;
@@ -129,6 +131,8 @@ class GDALOverviewBand final: public GDALProxyRasterBand
     int GetMaskFlags() override;
     GDALRasterBand* GetMaskBand() override;
 
+    char **GetRawBlockCodecInfo( int, int ) override;
+
   private:
     CPL_DISALLOW_COPY_ASSIGN(GDALOverviewBand)
 };
@@ -602,6 +606,32 @@ GDALRasterBand* GDALOverviewBand::RefUnderlyingRasterBand()
     return nullptr;
 }
 
+/************************************************************************/
+/*                        GetRawBlockCodecInfo()                        */
+/************************************************************************/
+
+// The overview band has the blocks of the underlying band, so its stored
+// blocks can be read directly, e.g. by GTiff CreateCopy().
+char **GDALOverviewBand::GetRawBlockCodecInfo( int nXBlockOff, int nYBlockOff )
+{
+    if( poUnderlyingBand == nullptr )
+        return nullptr;
+    return poUnderlyingBand->GetRawBlockCodecInfo(nXBlockOff, nYBlockOff);
+}
+
+/************************************************************************/
+/*                           IReadRawBlock()                            */
+/************************************************************************/
+
+CPLErr GDALOverviewBand::IReadRawBlock( int nXBlockOff, int nYBlockOff,
+                                        void** ppData, size_t* pnDataSize )
+{
+    if( poUnderlyingBand == nullptr )
+        return CE_Failure;
+    return poUnderlyingBand->ReadRawBlock(nXBlockOff, nYBlockOff,
+                                          ppData, pnDataSize, nullptr);
+}
+
 /************************************************************************/
 /*                         GetOverviewCount()                           */
 /************************************************************************/
@@ -30,9 +30,16 @@
 #include "cpl_port.h"
 #include "gdal_proxy.h"
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
@@ -46,10 +53,10 @@
 
 CPL_CVSID("$Id: gdalproxypool.cpp 48750f0a05e88eec700319b3e1a3146da6054e09 2019-09-20 20:55:41 +0300 drons $")
 
-/* We *must* share the same mutex as the gdaldataset.cpp file, as we are */
-/* doing GDALOpen() calls that can indirectly call GDALOpenShared() on */
-/* an auxiliary dataset ... */
-/* Then we could get dead-locks in multi-threaded use case */
+/* The lifetime of the pool singleton is protected by the same mutex as */
+/* the gdaldataset.cpp file. Lookups only take the mutex of a shard, and */
+/* datasets are opened and closed without any lock held, since GDALOpen() */
+/* can indirectly call GDALOpenShared() on an auxiliary dataset ... */
 
 /* ******************************************************************** */
 /*                         GDALDatasetPool                              */
@@ -63,21 +70,56 @@ static GDALDatasetPool* singleton = nullptr;
 
 void GDALNullifyProxyPoolSingleton() { singleton = nullptr; }
 
+/* Number of opens or closes of pooled datasets in progress in the current */
+/* thread. A GDALProxyPoolDataset created while it is not zero is an "inner" */
+/* one that must not take a reference on the pool. This used to be a member */
+/* of the pool, but opens and closes are no longer serialized. */
+static thread_local int g_tls_nOpenCloseInProgress = 0;
+
 struct _GDALProxyPoolCacheEntry
 {
     GIntBig       responsiblePID;
     char         *pszFileName;
     char         *pszOwner;
-	char		 *pszTableName;
+    char         *pszTableName;
+    GDALAccess    eAccess;
     GDALDataset  *poDS;
 
     /* Ref count of the cached dataset */
     int           refCount;
 
+    /* Set while the thread that created the entry opens the dataset */
+    bool          bOpening;
+
+    /* Thread that opens the dataset, when bOpening is set */
+    GIntBig       nOpeningThreadId;
+
+    /* Index of the shard that owns the entry */
+    int           iShard;
+
     GDALProxyPoolCacheEntry* prev;
     GDALProxyPoolCacheEntry* next;
 };
 
+/* A subset of the pool, selected by a hash of the file name, so that */
+/* threads working on different files do not contend on the same mutex. */
+/* The mutex only protects the lookup structures: datasets are opened */
+/* and closed without holding it. */
+struct GDALDatasetPoolShard
+{
+    std::mutex               oMutex{};
+
+    /* Signaled when an entry has finished opening */
+    std::condition_variable  oCond{};
+
+    std::unordered_multimap<std::string, GDALProxyPoolCacheEntry*>
+                             oMapEntries{};
+
+    /* LRU list, most recently used first */
+    GDALProxyPoolCacheEntry* firstEntry = nullptr;
+    GDALProxyPoolCacheEntry* lastEntry = nullptr;
+};
+
 class GDALDatasetPool
 {
     private:
@@ -85,27 +127,43 @@ class GDALDatasetPool
 
         /* Ref count of the pool singleton */
         /* Taken by "toplevel" GDALProxyPoolDataset in its constructor and released */
-        /* in its destructor. See also refCountOfDisableRefCount for the difference */
-        /* between toplevel and inner GDALProxyPoolDataset */
+        /* in its destructor. See also g_tls_nOpenCloseInProgress for the */
+        /* difference between toplevel and inner GDALProxyPoolDataset */
         int refCount = 0;
 
+        /* Set by PreventDestroy() so that GDALDestroyDriverManager() can */
+        /* destroy the pool itself afterwards */
+        int refCountOfDisableRefCount = 0;
+
         int maxSize = 0;
-        int currentSize = 0;
-        GDALProxyPoolCacheEntry* firstEntry = nullptr;
-        GDALProxyPoolCacheEntry* lastEntry = nullptr;
-
-        /* This variable prevents a dataset that is going to be opened in GDALDatasetPool::_RefDataset */
-        /* from increasing refCount if, during its opening, it creates a GDALProxyPoolDataset */
-        /* We increment it before opening or closing a cached dataset and decrement it afterwards */
-        /* The typical use case is a VRT made of simple sources that are VRT */
-        /* We don't want the "inner" VRT to take a reference on the pool, otherwise there is */
-        /* a high chance that this reference will not be dropped and the pool remain ghost */
-        int refCountOfDisableRefCount= 0;
+        std::atomic<int> currentSize{0};
+
+        int nShards = 0;
+        std::unique_ptr<GDALDatasetPoolShard[]> pasShards{};
+
+        /* Metrics, see GDALGetDatasetPoolStatistics() */
+        std::atomic<GIntBig> nHits{0};
+        std::atomic<GIntBig> nMisses{0};
+        std::atomic<GIntBig> nEvictions{0};
+        std::atomic<GIntBig> nEvictionMicroSeconds{0};
+        std::atomic<GIntBig> nOpenMicroSeconds{0};
 
         /* Caution : to be sure that we don't run out of entries, size must be at */
         /* least greater or equal than the maximum number of threads */
-        explicit GDALDatasetPool(int maxSize);
+        GDALDatasetPool(int maxSize, int nShards);
         ~GDALDatasetPool();
+
+        int GetShardIndex(const char* pszFileName) const;
+        static void Unlink(GDALDatasetPoolShard& shard,
+                           GDALProxyPoolCacheEntry* cur);
+        static void PushFront(GDALDatasetPoolShard& shard,
+                              GDALProxyPoolCacheEntry* cur);
+        static void Detach(GDALDatasetPoolShard& shard,
+                           GDALProxyPoolCacheEntry* cur);
+        GDALProxyPoolCacheEntry* TakeEvictionVictim(int iFirstShard);
+        void CloseEntry(GDALProxyPoolCacheEntry* cur, bool bEviction);
+        static void FreeEntry(GDALProxyPoolCacheEntry* cur);
+
         GDALProxyPoolCacheEntry* _RefDataset(const char* pszFileName,
                                              GDALAccess eAccess,
                                              char** papszOpenOptions,
@@ -118,7 +176,7 @@ class GDALDatasetPool
 #ifdef DEBUG_PROXY_POOL
         // cppcheck-suppress unusedPrivateFunction
         void ShowContent();
-        void CheckLinks();
+        void CheckLinks(GDALDatasetPoolShard& shard);
 #endif
 
         CPL_DISALLOW_COPY_ASSIGN(GDALDatasetPool)
@@ -138,13 +196,18 @@ class GDALDatasetPool
 
         static void PreventDestroy();
         static void ForceDestroy();
+
+        static bool GetStatistics(GDALDatasetPoolStatistics* psStats);
 };
 
 /************************************************************************/
 /*                         GDALDatasetPool()                            */
 /************************************************************************/
 
-GDALDatasetPool::GDALDatasetPool(int maxSizeIn): maxSize(maxSizeIn)
+GDALDatasetPool::GDALDatasetPool(int maxSizeIn, int nShardsIn):
+    maxSize(maxSizeIn),
+    nShards(nShardsIn),
+    pasShards(new GDALDatasetPoolShard[nShardsIn])
 {
 }
 
@@ -155,23 +218,30 @@ GDALDatasetPool::GDALDatasetPool(int maxSizeIn): maxSize(maxSizeIn)
 GDALDatasetPool::~GDALDatasetPool()
 {
     bInDestruction = true;
-    GDALProxyPoolCacheEntry* cur = firstEntry;
-    GIntBig responsiblePID = GDALGetResponsiblePIDForCurrentThread();
-    while(cur)
+    for( int i = 0; i < nShards; i++ )
     {
-        GDALProxyPoolCacheEntry* next = cur->next;
-        CPLFree(cur->pszFileName);
-        CPLFree(cur->pszOwner);
-        CPLAssert(cur->refCount == 0);
-        if (cur->poDS)
+        GDALProxyPoolCacheEntry* cur = pasShards[i].firstEntry;
+        while(cur)
         {
-            GDALSetResponsiblePIDForCurrentThread(cur->responsiblePID);
-            GDALClose(cur->poDS);
+            GDALProxyPoolCacheEntry* next = cur->next;
+            CPLAssert(cur->refCount == 0);
+            CloseEntry(cur, false);
+            FreeEntry(cur);
+            cur = next;
         }
-        CPLFree(cur);
-        cur = next;
     }
-    GDALSetResponsiblePIDForCurrentThread(responsiblePID);
+
+    const GIntBig nLookups = nHits + nMisses;
+    if( nLookups > 0 )
+    {
+        CPLDebug("GDAL",
+                 "Dataset pool: " CPL_FRMT_GIB " lookups, hit rate %.1f %%, "
+                 CPL_FRMT_GIB " evictions taking %.3f s, opens taking %.3f s",
+                 nLookups, 100.0 * static_cast<double>(nHits) / nLookups,
+                 static_cast<GIntBig>(nEvictions),
+                 static_cast<double>(nEvictionMicroSeconds) * 1e-6,
+                 static_cast<double>(nOpenMicroSeconds) * 1e-6);
+    }
 }
 
 #ifdef DEBUG_PROXY_POOL
@@ -181,16 +251,20 @@ GDALDatasetPool::~GDALDatasetPool()
 
 void GDALDatasetPool::ShowContent()
 {
-    GDALProxyPoolCacheEntry* cur = firstEntry;
-    int i = 0;
-    while(cur)
+    for( int iShard = 0; iShard < nShards; iShard++ )
     {
-        printf("[%d] pszFileName=%s, owner=%s, refCount=%d, responsiblePID=%d\n",/*ok*/
-               i, cur->pszFileName,
-               cur->pszOwner ? cur->pszOwner : "(null)",
-               cur->refCount, (int)cur->responsiblePID);
-        i++;
-        cur = cur->next;
+        std::lock_guard<std::mutex> oLock(pasShards[iShard].oMutex);
+        GDALProxyPoolCacheEntry* cur = pasShards[iShard].firstEntry;
+        int i = 0;
+        while(cur)
+        {
+            printf("[%d/%d] pszFileName=%s, owner=%s, refCount=%d, responsiblePID=%d\n",/*ok*/
+                   iShard, i, cur->pszFileName,
+                   cur->pszOwner ? cur->pszOwner : "(null)",
+                   cur->refCount, (int)cur->responsiblePID);
+            i++;
+            cur = cur->next;
+        }
     }
 }
 
@@ -198,22 +272,155 @@ void GDALDatasetPool::ShowContent()
 /*                             CheckLinks()                             */
 /************************************************************************/
 
-void GDALDatasetPool::CheckLinks()
+void GDALDatasetPool::CheckLinks(GDALDatasetPoolShard& shard)
 {
-    GDALProxyPoolCacheEntry* cur = firstEntry;
-    int i = 0;
+    GDALProxyPoolCacheEntry* cur = shard.firstEntry;
+    size_t i = 0;
     while(cur)
     {
-        CPLAssert(cur == firstEntry || cur->prev->next == cur);
-        CPLAssert(cur == lastEntry || cur->next->prev == cur);
+        CPLAssert(cur == shard.firstEntry || cur->prev->next == cur);
+        CPLAssert(cur == shard.lastEntry || cur->next->prev == cur);
         ++i;
-        CPLAssert(cur->next != nullptr || cur == lastEntry);
+        CPLAssert(cur->next != nullptr || cur == shard.lastEntry);
         cur = cur->next;
     }
-    CPLAssert(i == currentSize);
+    CPLAssert(i == shard.oMapEntries.size());
 }
 #endif
 
+/************************************************************************/
+/*                           GetShardIndex()                            */
+/************************************************************************/
+
+int GDALDatasetPool::GetShardIndex(const char* pszFileName) const
+{
+    return static_cast<int>(
+        std::hash<std::string>()(pszFileName) % static_cast<size_t>(nShards));
+}
+
+/************************************************************************/
+/*                       Unlink() / PushFront()                         */
+/************************************************************************/
+
+void GDALDatasetPool::Unlink(GDALDatasetPoolShard& shard,
+                             GDALProxyPoolCacheEntry* cur)
+{
+    if (cur->prev)
+        cur->prev->next = cur->next;
+    else
+        shard.firstEntry = cur->next;
+    if (cur->next)
+        cur->next->prev = cur->prev;
+    else
+        shard.lastEntry = cur->prev;
+    cur->prev = nullptr;
+    cur->next = nullptr;
+}
+
+void GDALDatasetPool::PushFront(GDALDatasetPoolShard& shard,
+                                GDALProxyPoolCacheEntry* cur)
+{
+    cur->prev = nullptr;
+    cur->next = shard.firstEntry;
+    if (shard.firstEntry)
+        shard.firstEntry->prev = cur;
+    else
+        shard.lastEntry = cur;
+    shard.firstEntry = cur;
+}
+
+/************************************************************************/
+/*                               Detach()                               */
+/************************************************************************/
+
+/* Remove an entry from the lookup structures of its shard */
+void GDALDatasetPool::Detach(GDALDatasetPoolShard& shard,
+                             GDALProxyPoolCacheEntry* cur)
+{
+    auto oRange = shard.oMapEntries.equal_range(cur->pszFileName);
+    for( auto oIter = oRange.first; oIter != oRange.second; ++oIter )
+    {
+        if( oIter->second == cur )
+        {
+            shard.oMapEntries.erase(oIter);
+            break;
+        }
+    }
+    Unlink(shard, cur);
+#ifdef DEBUG_PROXY_POOL
+    CheckLinks(shard);
+#endif
+}
+
+/************************************************************************/
+/*                        TakeEvictionVictim()                          */
+/************************************************************************/
+
+/* Detach the least recently used unreferenced entry, looking in the */
+/* given shard first, then in the other ones. */
+GDALProxyPoolCacheEntry* GDALDatasetPool::TakeEvictionVictim(int iFirstShard)
+{
+    for( int i = 0; i < nShards; i++ )
+    {
+        GDALDatasetPoolShard& shard = pasShards[(iFirstShard + i) % nShards];
+        std::lock_guard<std::mutex> oLock(shard.oMutex);
+        for( GDALProxyPoolCacheEntry* cur = shard.lastEntry; cur;
+             cur = cur->prev )
+        {
+            if( cur->refCount == 0 && !cur->bOpening )
+            {
+                Detach(shard, cur);
+                return cur;
+            }
+        }
+    }
+    return nullptr;
+}
+
+/************************************************************************/
+/*                            CloseEntry()                              */
+/************************************************************************/
+
+/* Close the dataset of a detached entry. No lock must be held. */
+void GDALDatasetPool::CloseEntry(GDALProxyPoolCacheEntry* cur,
+                                 bool bEviction)
+{
+    if( cur->poDS == nullptr )
+        return;
+
+    /* Close by pretending we are the thread that GDALOpen'ed this */
+    /* dataset */
+    const GIntBig responsiblePID = GDALGetResponsiblePIDForCurrentThread();
+    GDALSetResponsiblePIDForCurrentThread(cur->responsiblePID);
+
+    const auto start = std::chrono::steady_clock::now();
+    g_tls_nOpenCloseInProgress ++;
+    GDALClose(cur->poDS);
+    g_tls_nOpenCloseInProgress --;
+    if( bEviction )
+    {
+        nEvictions ++;
+        nEvictionMicroSeconds +=
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count();
+    }
+
+    cur->poDS = nullptr;
+    GDALSetResponsiblePIDForCurrentThread(responsiblePID);
+}
+
+/************************************************************************/
+/*                             FreeEntry()                              */
+/************************************************************************/
+
+void GDALDatasetPool::FreeEntry(GDALProxyPoolCacheEntry* cur)
+{
+    CPLFree(cur->pszFileName);
+    CPLFree(cur->pszOwner);
+    CPLFree(cur->pszTableName);
+    delete cur;
+}
+
 /************************************************************************/
 /*                            _RefDataset()                             */
 /************************************************************************/
@@ -228,146 +435,137 @@ GDALProxyPoolCacheEntry* GDALDatasetPool::_RefDataset(const char* pszFileName,
     if( bInDestruction )
         return nullptr;
 
-    GDALProxyPoolCacheEntry* cur = firstEntry;
-    GIntBig responsiblePID = GDALGetResponsiblePIDForCurrentThread();
-    GDALProxyPoolCacheEntry* lastEntryWithZeroRefCount = nullptr;
-	const char * iTable = CSLFetchNameValue(papszOpenOptions, "Table");
+    const GIntBig responsiblePID = GDALGetResponsiblePIDForCurrentThread();
+    const char * iTable = CSLFetchNameValue(papszOpenOptions, "Table");
+    const int iShard = GetShardIndex(pszFileName);
+    GDALDatasetPoolShard& shard = pasShards[iShard];
 
-    while(cur)
+    GDALProxyPoolCacheEntry* cur = nullptr;
     {
-        GDALProxyPoolCacheEntry* next = cur->next;
-
-        if (strcmp(cur->pszFileName, pszFileName) == 0 &&
-            ((bShared && cur->responsiblePID == responsiblePID &&
-              ((cur->pszOwner == nullptr && pszOwner == nullptr) ||
-                (cur->pszOwner != nullptr && pszOwner != nullptr &&
-                 strcmp(cur->pszOwner, pszOwner) == 0))) ||
-             (!bShared && cur->refCount == 0)) )
+        std::unique_lock<std::mutex> oLock(shard.oMutex);
+        while( true )
         {
-			//Check for Table match
-			bool ok = true;
-			if (iTable && cur->pszTableName)
-			{
-				if (strcmp(iTable, cur->pszTableName) != 0)
-					ok = false;
-			}
-			if (ok)
-			{
-            	if (cur != firstEntry)
-            	{
-                	/* Move to begin */
-                	if (cur->next)
-                    	cur->next->prev = cur->prev;
-                	else
-                    	lastEntry = cur->prev;
-                	cur->prev->next = cur->next;
-                	cur->prev = nullptr;
-                	firstEntry->prev = cur;
-                	cur->next = firstEntry;
-                	firstEntry = cur;
-
+            GDALProxyPoolCacheEntry* found = nullptr;
+            auto oRange = shard.oMapEntries.equal_range(pszFileName);
+            for( auto oIter = oRange.first; oIter != oRange.second; ++oIter )
+            {
+                GDALProxyPoolCacheEntry* entry = oIter->second;
+                if( entry->eAccess != eAccess )
+                    continue;
+                if( !((bShared && entry->responsiblePID == responsiblePID &&
+                       ((entry->pszOwner == nullptr && pszOwner == nullptr) ||
+                        (entry->pszOwner != nullptr && pszOwner != nullptr &&
+                         strcmp(entry->pszOwner, pszOwner) == 0))) ||
+                      (!bShared && entry->refCount == 0)) )
+                    continue;
+                //Check for Table match
+                if( iTable && entry->pszTableName &&
+                    strcmp(iTable, entry->pszTableName) != 0 )
+                    continue;
+                found = entry;
+                break;
+            }
+            if( found == nullptr )
+                break;
+            if( found->bOpening )
+            {
+                if( found->nOpeningThreadId == CPLGetPID() )
+                {
+                    /* Opening the dataset requires itself: waiting would */
+                    /* never end. */
+                    CPLError(CE_Failure, CPLE_AppDefined,
+                             "Recursive opening of %s through the dataset "
+                             "pool", pszFileName);
+                    return nullptr;
+                }
+                /* Another thread is opening the same shared dataset */
+                shard.oCond.wait(oLock);
+                continue;
+            }
+
+            if( found != shard.firstEntry )
+            {
+                /* Move to begin */
+                Unlink(shard, found);
+                PushFront(shard, found);
 #ifdef DEBUG_PROXY_POOL
-                	CheckLinks();
+                CheckLinks(shard);
 #endif
-            	}
-
-            	cur->refCount ++;
-            	return cur;
-        	}
+            }
+            found->refCount ++;
+            nHits ++;
+            return found;
         }
 
-        if (cur->refCount == 0)
-            lastEntryWithZeroRefCount = cur;
-
-        cur = next;
+        if( !bForceOpen )
+            return nullptr;
+        nMisses ++;
+
+        /* Reserve the entry, so that other threads wanting the same */
+        /* shared dataset wait for us to open it instead of opening it too */
+        cur = new GDALProxyPoolCacheEntry();
+        cur->pszFileName = CPLStrdup(pszFileName);
+        cur->pszOwner = (pszOwner) ? CPLStrdup(pszOwner) : nullptr;
+        cur->pszTableName = (iTable) ? CPLStrdup(iTable) : nullptr;
+        cur->eAccess = eAccess;
+        cur->responsiblePID = responsiblePID;
+        cur->refCount = 1;
+        cur->bOpening = true;
+        cur->nOpeningThreadId = CPLGetPID();
+        cur->iShard = iShard;
+        shard.oMapEntries.emplace(pszFileName, cur);
+        PushFront(shard, cur);
+#ifdef DEBUG_PROXY_POOL
+        CheckLinks(shard);
+#endif
     }
 
-    if( !bForceOpen )
-        return nullptr;
-
-    if (currentSize == maxSize)
+/* -------------------------------------------------------------------- */
+/*      Make room if needed, closing the victim without lock held.      */
+/* -------------------------------------------------------------------- */
+    if( ++currentSize > maxSize )
     {
-        if (lastEntryWithZeroRefCount == nullptr)
+        GDALProxyPoolCacheEntry* victim = TakeEvictionVictim(iShard);
+        if( victim == nullptr )
         {
+            {
+                std::lock_guard<std::mutex> oLock(shard.oMutex);
+                Detach(shard, cur);
+            }
+            shard.oCond.notify_all();
+            currentSize --;
+            FreeEntry(cur);
             CPLError(CE_Failure, CPLE_AppDefined,
                      "Too many threads are running for the current value of the dataset pool size (%d).\n"
                      "or too many proxy datasets are opened in a cascaded way.\n"
                      "Try increasing GDAL_MAX_DATASET_POOL_SIZE.", maxSize);
             return nullptr;
         }
-
-        lastEntryWithZeroRefCount->pszFileName[0] = '\0';
-        if (lastEntryWithZeroRefCount->poDS)
-        {
-            /* Close by pretending we are the thread that GDALOpen'ed this */
-            /* dataset */
-            GDALSetResponsiblePIDForCurrentThread(lastEntryWithZeroRefCount->responsiblePID);
-
-            refCountOfDisableRefCount ++;
-            GDALClose(lastEntryWithZeroRefCount->poDS);
-            refCountOfDisableRefCount --;
-
-            lastEntryWithZeroRefCount->poDS = nullptr;
-            GDALSetResponsiblePIDForCurrentThread(responsiblePID);
-        }
-        CPLFree(lastEntryWithZeroRefCount->pszFileName);
-        CPLFree(lastEntryWithZeroRefCount->pszOwner);
-
-        /* Recycle this entry for the to-be-opened dataset and */
-        /* moves it to the top of the list */
-        if (lastEntryWithZeroRefCount->prev)
-            lastEntryWithZeroRefCount->prev->next = lastEntryWithZeroRefCount->next;
-        else {
-            CPLAssert(false);
-        }
-        if (lastEntryWithZeroRefCount->next)
-            lastEntryWithZeroRefCount->next->prev = lastEntryWithZeroRefCount->prev;
-        else
-        {
-            CPLAssert(lastEntryWithZeroRefCount == lastEntry);
-            lastEntry->prev->next = nullptr;
-            lastEntry = lastEntry->prev;
-        }
-        lastEntryWithZeroRefCount->prev = nullptr;
-        lastEntryWithZeroRefCount->next = firstEntry;
-        firstEntry->prev = lastEntryWithZeroRefCount;
-        cur = firstEntry = lastEntryWithZeroRefCount;
-#ifdef DEBUG_PROXY_POOL
-        CheckLinks();
-#endif
+        currentSize --;
+        CloseEntry(victim, true);
+        FreeEntry(victim);
     }
-    else
+
+    const auto start = std::chrono::steady_clock::now();
+    g_tls_nOpenCloseInProgress ++;
+    int nFlag = ((eAccess == GA_Update) ? GDAL_OF_UPDATE : GDAL_OF_READONLY) | GDAL_OF_RASTER | GDAL_OF_VERBOSE_ERROR;
+    GDALDataset* poDS;
     {
-        /* Prepend */
-        cur = static_cast<GDALProxyPoolCacheEntry*>(CPLMalloc(sizeof(GDALProxyPoolCacheEntry)));
-        if (lastEntry == nullptr)
-            lastEntry = cur;
-        cur->prev = nullptr;
-        cur->next = firstEntry;
-        if (firstEntry)
-            firstEntry->prev = cur;
-        firstEntry = cur;
-        currentSize ++;
-#ifdef DEBUG_PROXY_POOL
-        CheckLinks();
-#endif
+        CPLConfigOptionSetter oSetter("CPL_ALLOW_VSISTDIN", "NO", true);
+        poDS = GDALDataset::Open( pszFileName, nFlag, nullptr,
+                                  papszOpenOptions, nullptr );
     }
+    g_tls_nOpenCloseInProgress --;
+    nOpenMicroSeconds +=
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
 
-    cur->pszFileName = CPLStrdup(pszFileName);
-    cur->pszOwner = (pszOwner) ? CPLStrdup(pszOwner) : nullptr;
-	if (iTable)
-		cur->pszTableName = CPLStrdup(iTable);
-	else
-		cur->pszTableName = NULL;
-    cur->responsiblePID = responsiblePID;
-    cur->refCount = 1;
-
-    refCountOfDisableRefCount ++;
-    int nFlag = ((eAccess == GA_Update) ? GDAL_OF_UPDATE : GDAL_OF_READONLY) | GDAL_OF_RASTER | GDAL_OF_VERBOSE_ERROR;
-    CPLConfigOptionSetter oSetter("CPL_ALLOW_VSISTDIN", "NO", true);
-    cur->poDS = GDALDataset::Open( pszFileName, nFlag, nullptr,
-                                            papszOpenOptions, nullptr );
-    refCountOfDisableRefCount --;
+    {
+        std::lock_guard<std::mutex> oLock(shard.oMutex);
+        cur->poDS = poDS;
+        cur->bOpening = false;
+    }
+    shard.oCond.notify_all();
 
     return cur;
 }
@@ -377,42 +575,36 @@ GDALProxyPoolCacheEntry* GDALDatasetPool::_RefDataset(const char* pszFileName,
 /************************************************************************/
 
 void GDALDatasetPool::_CloseDataset( const char* pszFileName,
-                                     GDALAccess /* eAccess */,
+                                     GDALAccess eAccess,
                                      const char* pszOwner )
 {
-    GDALProxyPoolCacheEntry* cur = firstEntry;
-    GIntBig responsiblePID = GDALGetResponsiblePIDForCurrentThread();
-
-    while(cur)
+    GDALDatasetPoolShard& shard = pasShards[GetShardIndex(pszFileName)];
+    GDALProxyPoolCacheEntry* found = nullptr;
     {
-        GDALProxyPoolCacheEntry* next = cur->next;
-
-        CPLAssert(cur->pszFileName);
-        if (strcmp(cur->pszFileName, pszFileName) == 0 && cur->refCount == 0 &&
-            ((pszOwner == nullptr && cur->pszOwner == nullptr) ||
-             (pszOwner != nullptr && cur->pszOwner != nullptr &&
-              strcmp(cur->pszOwner, pszOwner) == 0)) &&
-            cur->poDS != nullptr )
+        std::lock_guard<std::mutex> oLock(shard.oMutex);
+        auto oRange = shard.oMapEntries.equal_range(pszFileName);
+        for( auto oIter = oRange.first; oIter != oRange.second; ++oIter )
         {
-            /* Close by pretending we are the thread that GDALOpen'ed this */
-            /* dataset */
-            GDALSetResponsiblePIDForCurrentThread(cur->responsiblePID);
-
-            refCountOfDisableRefCount ++;
-            GDALClose(cur->poDS);
-            refCountOfDisableRefCount --;
-
-            GDALSetResponsiblePIDForCurrentThread(responsiblePID);
-
-            cur->poDS = nullptr;
-            cur->pszFileName[0] = '\0';
-            CPLFree(cur->pszOwner);
-            cur->pszOwner = nullptr;
-            break;
+            GDALProxyPoolCacheEntry* cur = oIter->second;
+            if (cur->refCount == 0 && !cur->bOpening &&
+                cur->eAccess == eAccess &&
+                ((pszOwner == nullptr && cur->pszOwner == nullptr) ||
+                 (pszOwner != nullptr && cur->pszOwner != nullptr &&
+                  strcmp(cur->pszOwner, pszOwner) == 0)) &&
+                cur->poDS != nullptr )
+            {
+                found = cur;
+                break;
+            }
         }
-
-        cur = next;
+        if( found == nullptr )
+            return;
+        Detach(shard, found);
     }
+
+    currentSize --;
+    CloseEntry(found, false);
+    FreeEntry(found);
 }
 
 /************************************************************************/
@@ -427,9 +619,13 @@ void GDALDatasetPool::Ref()
         int l_maxSize = atoi(CPLGetConfigOption("GDAL_MAX_DATASET_POOL_SIZE", "100"));
         if (l_maxSize < 2 || l_maxSize > 1000)
             l_maxSize = 100;
-        singleton = new GDALDatasetPool(l_maxSize);
+        int l_nShards = atoi(CPLGetConfigOption("GDAL_DATASET_POOL_SHARDS", "16"));
+        if (l_nShards < 1 || l_nShards > 256)
+            l_nShards = 16;
+        singleton = new GDALDatasetPool(l_maxSize, l_nShards);
     }
-    if (singleton->refCountOfDisableRefCount == 0)
+    if (singleton->refCountOfDisableRefCount == 0 &&
+        g_tls_nOpenCloseInProgress == 0)
       singleton->refCount++;
 }
 
@@ -462,7 +658,8 @@ void GDALDatasetPool::Unref()
         CPLAssert(false);
         return;
     }
-    if (singleton->refCountOfDisableRefCount == 0)
+    if (singleton->refCountOfDisableRefCount == 0 &&
+        g_tls_nOpenCloseInProgress == 0)
     {
       singleton->refCount--;
       if (singleton->refCount == 0)
@@ -498,6 +695,9 @@ void GDALDatasetPoolForceDestroy()
 /*                           RefDataset()                               */
 /************************************************************************/
 
+/* The pool cannot be destroyed while the calling GDALProxyPoolDataset */
+/* holds its reference, so the singleton can be used without taking the */
+/* global dataset mutex. */
 GDALProxyPoolCacheEntry* GDALDatasetPool::RefDataset(const char* pszFileName,
                                                      GDALAccess eAccess,
                                                      char** papszOpenOptions,
@@ -505,7 +705,6 @@ GDALProxyPoolCacheEntry* GDALDatasetPool::RefDataset(const char* pszFileName,
                                                      bool bForceOpen,
                                                      const char* pszOwner)
 {
-    CPLMutexHolderD( GDALGetphDLMutex() );
     return singleton->_RefDataset(pszFileName, eAccess, papszOpenOptions,
                                   bShared, bForceOpen, pszOwner);
 }
@@ -516,7 +715,8 @@ GDALProxyPoolCacheEntry* GDALDatasetPool::RefDataset(const char* pszFileName,
 
 void GDALDatasetPool::UnrefDataset(GDALProxyPoolCacheEntry* cacheEntry)
 {
-    CPLMutexHolderD( GDALGetphDLMutex() );
+    GDALDatasetPoolShard& shard = singleton->pasShards[cacheEntry->iShard];
+    std::lock_guard<std::mutex> oLock(shard.oMutex);
     cacheEntry->refCount --;
 }
 
@@ -527,10 +727,49 @@ void GDALDatasetPool::UnrefDataset(GDALProxyPoolCacheEntry* cacheEntry)
 void GDALDatasetPool::CloseDataset(const char* pszFileName, GDALAccess eAccess,
                                    const char* pszOwner)
 {
-    CPLMutexHolderD( GDALGetphDLMutex() );
     singleton->_CloseDataset(pszFileName, eAccess, pszOwner);
 }
 
+/************************************************************************/
+/*                           GetStatistics()                            */
+/************************************************************************/
+
+bool GDALDatasetPool::GetStatistics(GDALDatasetPoolStatistics* psStats)
+{
+    CPLMutexHolderD( GDALGetphDLMutex() );
+    if (! singleton)
+        return false;
+    psStats->nHits = singleton->nHits;
+    psStats->nMisses = singleton->nMisses;
+    psStats->nEvictions = singleton->nEvictions;
+    psStats->dfEvictionSeconds =
+        static_cast<double>(singleton->nEvictionMicroSeconds) * 1e-6;
+    psStats->dfOpenSeconds =
+        static_cast<double>(singleton->nOpenMicroSeconds) * 1e-6;
+    psStats->nOpenDatasets = singleton->currentSize;
+    psStats->nMaxDatasets = singleton->maxSize;
+    return true;
+}
+
+/************************************************************************/
+/*                    GDALGetDatasetPoolStatistics()                    */
+/************************************************************************/
+
+/** Return the metrics of the pool of datasets used by GDALProxyPoolDataset.
+ *
+ * The counters are cumulated since the creation of the pool, which happens
+ * when the first GDALProxyPoolDataset is created, and they are reset when
+ * the pool is destroyed with the last one.
+ *
+ * @param psStats structure to fill.
+ * @return false if there is no pool currently.
+ * @since GDAL 3.1
+ */
+bool GDALGetDatasetPoolStatistics(GDALDatasetPoolStatistics* psStats)
+{
+    return GDALDatasetPool::GetStatistics(psStats);
+}
+
 struct GetMetadataElt
 {
     char* pszDomain;
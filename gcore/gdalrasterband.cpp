@@ -39,9 +39,11 @@
 #include <cstdlib>
 #include <cstring>
 #include <algorithm>
+#include <functional>
 #include <limits>
 #include <memory>
 #include <new>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
@@ -49,9 +51,11 @@
 #include "cpl_string.h"
 #include "cpl_virtualmem.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal.h"
 #include "gdal_rat.h"
 #include "gdal_priv_templates.hpp"
+#include "gdalsse_priv.h"
 
 CPL_CVSID("$Id: gdalrasterband.cpp edcc6709ca4195da164b4345888ee2f74560e24d 2020-02-05 02:47:17 +0100 Even Rouault $")
 
@@ -2881,6 +2885,253 @@ static inline void ComputeFloatNoDataValue( GDALDataType eDataType,
     }
 }
 
+/************************************************************************/
+/*                    GDALGetBlockReductionThreadCount()                */
+/************************************************************************/
+
+// Number of threads used by ComputeStatistics(), GetHistogram() and
+// ComputeRasterMinMax() to reduce blocks, as set by GDAL_NUM_THREADS.
+static int GDALGetBlockReductionThreadCount()
+{
+    return CPLGetNumThreadsOption(nullptr, "1");
+}
+
+/************************************************************************/
+/*                      GDALReduceSampledBlocks()                       */
+/************************************************************************/
+
+// Called for each sampled block with the index of the accumulator to update
+// (calls with the same iSlot never run concurrently), the block pixels, the
+// actual block size and the number of pixels between the starts of two
+// lines. bFromBlockCache is true when pData comes from a GDALRasterBlock, and
+// is thus suitably aligned for the SSE2 kernels.
+typedef std::function<void(int iSlot, const void* pData,
+                           int nXCheck, int nYCheck, int nLineStride,
+                           bool bFromBlockCache)> GDALBlockReduceFunc;
+
+namespace {
+
+struct GDALReductionBlock
+{
+    GDALRasterBlock *poBlock;
+    const void      *pData;
+    int              nXCheck;
+    int              nYCheck;
+    int              nLineStride;
+};
+
+struct GDALReductionJob
+{
+    const GDALBlockReduceFunc             *pfnReduce;
+    const std::vector<GDALReductionBlock> *paoBlocks;
+    int                                    iSlot;
+    int                                    nSlots;
+    bool                                   bFromBlockCache;
+};
+
+void GDALReductionJobFunc( void* pData )
+{
+    const GDALReductionJob* psJob = static_cast<GDALReductionJob*>(pData);
+    const std::vector<GDALReductionBlock>& aoBlocks = *(psJob->paoBlocks);
+    for( size_t i = psJob->iSlot; i < aoBlocks.size(); i += psJob->nSlots )
+    {
+        (*psJob->pfnReduce)( psJob->iSlot, aoBlocks[i].pData,
+                             aoBlocks[i].nXCheck, aoBlocks[i].nYCheck,
+                             aoBlocks[i].nLineStride,
+                             psJob->bFromBlockCache );
+    }
+}
+
+} // namespace
+
+// Calls pfnReduce on every nSampleRate-th block of the band, with up to
+// nSlots threads.
+//
+// Drivers are not thread-safe, so blocks are fetched by the calling thread
+// in batches, while the worker threads reduce the previous batch. When the
+// band exposes its pixels through GetDirectReadPointer(), there is nothing
+// to fetch and the worker threads read the pixels themselves. Each worker
+// reduces a fixed subset of each batch into its own accumulator, so that
+// results do not depend on thread scheduling.
+static CPLErr GDALReduceSampledBlocks( GDALRasterBand* poBand,
+                                       int nSampleRate, int nSlots,
+                                       const GDALBlockReduceFunc& pfnReduce,
+                                       const char* pszMessage,
+                                       GDALProgressFunc pfnProgress,
+                                       void* pProgressData )
+{
+    int nBlockXSize = 0;
+    int nBlockYSize = 0;
+    poBand->GetBlockSize( &nBlockXSize, &nBlockYSize );
+    const int nBlocksPerRow = DIV_ROUND_UP(poBand->GetXSize(), nBlockXSize);
+    const int nBlocksPerColumn =
+        DIV_ROUND_UP(poBand->GetYSize(), nBlockYSize);
+    const int nBlockCount = nBlocksPerRow * nBlocksPerColumn;
+    const int nDTSize =
+        GDALGetDataTypeSizeBytes(poBand->GetRasterDataType());
+
+    GSpacing nViewPixelSpace = 0;
+    GSpacing nViewLineSpace = 0;
+    const GByte* pabyView = static_cast<const GByte*>(
+        poBand->GetDirectReadPointer(&nViewPixelSpace, &nViewLineSpace));
+    if( pabyView != nullptr &&
+        (nViewPixelSpace != nDTSize || (nViewLineSpace % nDTSize) != 0 ||
+         nViewLineSpace / nDTSize > INT_MAX) )
+    {
+        pabyView = nullptr;
+    }
+    const bool bFromBlockCache = pabyView == nullptr;
+
+    // Returns the pixels of a block, or false if it cannot be read.
+    const auto GetBlock = [&](int iSampleBlock, GDALReductionBlock& oBlock)
+    {
+        const int iYBlock = iSampleBlock / nBlocksPerRow;
+        const int iXBlock = iSampleBlock - nBlocksPerRow * iYBlock;
+        poBand->GetActualBlockSize(iXBlock, iYBlock,
+                                   &oBlock.nXCheck, &oBlock.nYCheck);
+        if( pabyView != nullptr )
+        {
+            oBlock.poBlock = nullptr;
+            oBlock.pData = pabyView +
+                static_cast<GPtrDiff_t>(iYBlock) * nBlockYSize *
+                                                        nViewLineSpace +
+                static_cast<GPtrDiff_t>(iXBlock) * nBlockXSize * nDTSize;
+            oBlock.nLineStride = static_cast<int>(nViewLineSpace / nDTSize);
+            return true;
+        }
+        oBlock.poBlock = poBand->GetLockedBlockRef( iXBlock, iYBlock );
+        if( oBlock.poBlock == nullptr )
+            return false;
+        oBlock.pData = oBlock.poBlock->GetDataRef();
+        oBlock.nLineStride = nBlockXSize;
+        return true;
+    };
+
+    const int nSampledBlocks = DIV_ROUND_UP(nBlockCount, nSampleRate);
+    nSlots = std::min(nSlots, nSampledBlocks);
+
+    std::unique_ptr<CPLWorkerThreadPool> poPool;
+    if( nSlots > 1 )
+    {
+        poPool.reset(new CPLWorkerThreadPool());
+        if( !poPool->Setup(nSlots, nullptr, nullptr) )
+            poPool.reset();
+    }
+
+    if( poPool == nullptr )
+    {
+        for( int iSampleBlock = 0;
+             iSampleBlock < nBlockCount;
+             iSampleBlock += nSampleRate )
+        {
+            GDALReductionBlock oBlock;
+            if( !GetBlock(iSampleBlock, oBlock) )
+                return CE_Failure;
+
+            pfnReduce( 0, oBlock.pData, oBlock.nXCheck, oBlock.nYCheck,
+                       oBlock.nLineStride, bFromBlockCache );
+
+            if( oBlock.poBlock )
+                oBlock.poBlock->DropLock();
+
+            if( !pfnProgress( iSampleBlock / static_cast<double>(nBlockCount),
+                              pszMessage, pProgressData ) )
+            {
+                CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+                return CE_Failure;
+            }
+        }
+        return CE_None;
+    }
+
+    // Blocks of the cache are locked until reduced, so bound the number of
+    // blocks in flight (two batches) to a fraction of the cache. Direct
+    // read pointers are split in batches of a few megabytes per worker.
+    const GIntBig nBlockBytes = std::max<GIntBig>(1,
+        static_cast<GIntBig>(nBlockXSize) * nBlockYSize * nDTSize);
+    GIntBig nBatchSize = 0;
+    if( bFromBlockCache )
+    {
+        nBatchSize = std::min<GIntBig>(4 * nSlots,
+                                       GDALGetCacheMax64() / 4 / nBlockBytes);
+    }
+    else
+    {
+        nBatchSize = nSlots *
+            std::max<GIntBig>(1, 4 * 1024 * 1024 / nBlockBytes);
+    }
+    nBatchSize = std::max<GIntBig>(1, std::min<GIntBig>(nBatchSize,
+                                                        nSampledBlocks));
+
+    std::vector<GDALReductionJob> asJobs(nSlots);
+    std::vector<void*> apJobs(nSlots);
+    std::vector<GDALReductionBlock> aoPending;
+    std::vector<GDALReductionBlock> aoNext;
+    for( int iSlot = 0; iSlot < nSlots; iSlot++ )
+    {
+        asJobs[iSlot].pfnReduce = &pfnReduce;
+        asJobs[iSlot].paoBlocks = &aoPending;
+        asJobs[iSlot].iSlot = iSlot;
+        asJobs[iSlot].nSlots = nSlots;
+        asJobs[iSlot].bFromBlockCache = bFromBlockCache;
+        apJobs[iSlot] = &asJobs[iSlot];
+    }
+
+    CPLErr eErr = CE_None;
+    int iSampleBlock = 0;
+    int nPendingEnd = 0;
+    while( true )
+    {
+        // Fetch the next batch while the previous one is being reduced.
+        aoNext.clear();
+        while( iSampleBlock < nBlockCount &&
+               static_cast<GIntBig>(aoNext.size()) < nBatchSize )
+        {
+            GDALReductionBlock oBlock;
+            if( !GetBlock(iSampleBlock, oBlock) )
+            {
+                eErr = CE_Failure;
+                break;
+            }
+            aoNext.push_back(oBlock);
+            iSampleBlock += nSampleRate;
+        }
+
+        poPool->WaitCompletion();
+        for( const auto& oBlock: aoPending )
+        {
+            if( oBlock.poBlock )
+                oBlock.poBlock->DropLock();
+        }
+        aoPending.clear();
+
+        if( eErr == CE_None && nPendingEnd > 0 &&
+            !pfnProgress( std::min(nPendingEnd, nBlockCount) /
+                                            static_cast<double>(nBlockCount),
+                          pszMessage, pProgressData ) )
+        {
+            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+            eErr = CE_Failure;
+        }
+
+        if( eErr != CE_None || aoNext.empty() )
+        {
+            for( const auto& oBlock: aoNext )
+            {
+                if( oBlock.poBlock )
+                    oBlock.poBlock->DropLock();
+            }
+            break;
+        }
+
+        std::swap(aoPending, aoNext);
+        nPendingEnd = iSampleBlock;
+        poPool->SubmitJobs(GDALReductionJobFunc, apJobs);
+    }
+
+    return eErr;
+}
+
 /************************************************************************/
 /*                            GetHistogram()                            */
 /************************************************************************/
@@ -2907,6 +3158,10 @@ static inline void ComputeFloatNoDataValue( GDALDataType eDataType,
  * in generating histogram based luts for instance.  Generally bApproxOK is
  * much faster than an exactly computed histogram.
  *
+ * Starting with GDAL 3.1, blocks are reduced on several threads when the
+ * GDAL_NUM_THREADS configuration option is set to a value greater than one,
+ * or ALL_CPUS.
+ *
  * This method is the same as the C functions GDALGetRasterHistogram() and
  * GDALGetRasterHistogramEx().
  *
@@ -3169,46 +3424,35 @@ CPLErr GDALRasterBand::GetHistogram( double dfMin, double dfMax,
 /* -------------------------------------------------------------------- */
 /*      Read the blocks, and add to histogram.                          */
 /* -------------------------------------------------------------------- */
-        for( int iSampleBlock = 0;
-             iSampleBlock < nBlocksPerRow * nBlocksPerColumn;
-             iSampleBlock += nSampleRate )
+        // Worker threads other than the first one count in their own
+        // histogram, added to panHistogram at the end.
+        const int nSlots = GDALGetBlockReductionThreadCount();
+        std::vector<std::vector<GUIntBig>> aanSlotHistograms(
+            nSlots - 1, std::vector<GUIntBig>(nBuckets));
+
+        const GDALBlockReduceFunc pfnReduce =
+            [&]( int iSlot, const void* pData, int nXCheck, int nYCheck,
+                 int nLineStride, bool /* bFromBlockCache */ )
         {
-            if( !pfnProgress(
-                    iSampleBlock /
-                        (static_cast<double>(nBlocksPerRow) * nBlocksPerColumn),
-                    "Compute Histogram", pProgressData ) )
-                return CE_Failure;
-
-            const int iYBlock = iSampleBlock / nBlocksPerRow;
-            const int iXBlock = iSampleBlock - nBlocksPerRow * iYBlock;
-
-            GDALRasterBlock *poBlock = GetLockedBlockRef( iXBlock, iYBlock );
-            if( poBlock == nullptr )
-                return CE_Failure;
-
-            void *pData = poBlock->GetDataRef();
-
-            int nXCheck = 0, nYCheck = 0;
-            GetActualBlockSize(iXBlock, iYBlock, &nXCheck, &nYCheck);
+            GUIntBig* const panSlotHistogram = iSlot == 0 ?
+                panHistogram : aanSlotHistograms[iSlot - 1].data();
 
             // this is a special case for a common situation.
             if( eDataType == GDT_Byte && !bSignedByte
                 && dfScale == 1.0 && (dfMin >= -0.5 && dfMin <= 0.5)
-                && nYCheck == nBlockYSize && nXCheck == nBlockXSize
-                && nBuckets == 256 )
+                && nXCheck == nLineStride && nBuckets == 256 )
             {
                 const GPtrDiff_t nPixels = static_cast<GPtrDiff_t>(nXCheck) * nYCheck;
-                GByte *pabyData = static_cast<GByte *>(pData);
+                const GByte *pabyData = static_cast<const GByte *>(pData);
 
                 for( GPtrDiff_t i = 0; i < nPixels; i++ )
                     if( ! (bGotNoDataValue &&
                            (pabyData[i] == static_cast<GByte>(dfNoDataValue))))
                     {
-                        panHistogram[pabyData[i]]++;
+                        panSlotHistogram[pabyData[i]]++;
                     }
 
-                poBlock->DropLock();
-                continue;  // To next sample block.
+                return;  // To next sample block.
             }
 
             // This isn't the fastest way to do this, but is easier for now.
@@ -3216,7 +3460,7 @@ CPLErr GDALRasterBand::GetHistogram( double dfMin, double dfMax,
             {
                 for( int iX = 0; iX < nXCheck; iX++ )
                 {
-                    const GPtrDiff_t iOffset = iX + static_cast<GPtrDiff_t>(iY) * nBlockXSize;
+                    const GPtrDiff_t iOffset = iX + static_cast<GPtrDiff_t>(iY) * nLineStride;
                     double dfValue = 0.0;
 
                     switch( eDataType )
@@ -3225,26 +3469,26 @@ CPLErr GDALRasterBand::GetHistogram( double dfMin, double dfMax,
                       {
                         if( bSignedByte )
                             dfValue =
-                                static_cast<signed char *>(pData)[iOffset];
+                                static_cast<const signed char *>(pData)[iOffset];
                         else
-                            dfValue = static_cast<GByte *>(pData)[iOffset];
+                            dfValue = static_cast<const GByte *>(pData)[iOffset];
                         break;
                       }
                       case GDT_UInt16:
-                        dfValue = static_cast<GUInt16 *>(pData)[iOffset];
+                        dfValue = static_cast<const GUInt16 *>(pData)[iOffset];
                         break;
                       case GDT_Int16:
-                        dfValue = static_cast<GInt16 *>(pData)[iOffset];
+                        dfValue = static_cast<const GInt16 *>(pData)[iOffset];
                         break;
                       case GDT_UInt32:
-                        dfValue = static_cast<GUInt32 *>(pData)[iOffset];
+                        dfValue = static_cast<const GUInt32 *>(pData)[iOffset];
                         break;
                       case GDT_Int32:
-                        dfValue = static_cast<GInt32 *>(pData)[iOffset];
+                        dfValue = static_cast<const GInt32 *>(pData)[iOffset];
                         break;
                       case GDT_Float32:
                       {
-                        const float fValue = static_cast<float *>(pData)[iOffset];
+                        const float fValue = static_cast<const float *>(pData)[iOffset];
                         if( CPLIsNan(fValue) ||
                             (bGotFloatNoDataValue && ARE_REAL_EQUAL(fValue, fNoDataValue)) )
                             continue;
@@ -3252,34 +3496,34 @@ CPLErr GDALRasterBand::GetHistogram( double dfMin, double dfMax,
                         break;
                       }
                       case GDT_Float64:
-                        dfValue = static_cast<double *>(pData)[iOffset];
+                        dfValue = static_cast<const double *>(pData)[iOffset];
                         if( CPLIsNan(dfValue) )
                             continue;
                         break;
                       case GDT_CInt16:
                         {
                             double  dfReal =
-                                static_cast<GInt16 *>(pData)[iOffset*2];
+                                static_cast<const GInt16 *>(pData)[iOffset*2];
                             double  dfImag =
-                                static_cast<GInt16 *>(pData)[iOffset*2+1];
+                                static_cast<const GInt16 *>(pData)[iOffset*2+1];
                             dfValue = sqrt( dfReal * dfReal + dfImag * dfImag );
                         }
                         break;
                       case GDT_CInt32:
                         {
                             double  dfReal =
-                                static_cast<GInt32 *>(pData)[iOffset*2];
+                                static_cast<const GInt32 *>(pData)[iOffset*2];
                             double  dfImag =
-                                static_cast<GInt32 *>(pData)[iOffset*2+1];
+                                static_cast<const GInt32 *>(pData)[iOffset*2+1];
                             dfValue = sqrt( dfReal * dfReal + dfImag * dfImag );
                         }
                         break;
                       case GDT_CFloat32:
                         {
                             double  dfReal =
-                                static_cast<float *>(pData)[iOffset*2];
+                                static_cast<const float *>(pData)[iOffset*2];
                             double  dfImag =
-                                static_cast<float *>(pData)[iOffset*2+1];
+                                static_cast<const float *>(pData)[iOffset*2+1];
                             if ( CPLIsNan(dfReal) || CPLIsNan(dfImag) )
                                 continue;
                             dfValue = sqrt( dfReal * dfReal + dfImag * dfImag );
@@ -3288,9 +3532,9 @@ CPLErr GDALRasterBand::GetHistogram( double dfMin, double dfMax,
                       case GDT_CFloat64:
                         {
                             double  dfReal =
-                                static_cast<double *>(pData)[iOffset*2];
+                                static_cast<const double *>(pData)[iOffset*2];
                             double  dfImag =
-                                static_cast<double *>(pData)[iOffset*2+1];
+                                static_cast<const double *>(pData)[iOffset*2+1];
                             if ( CPLIsNan(dfReal) || CPLIsNan(dfImag) )
                                 continue;
                             dfValue = sqrt( dfReal * dfReal + dfImag * dfImag );
@@ -3298,7 +3542,7 @@ CPLErr GDALRasterBand::GetHistogram( double dfMin, double dfMax,
                         break;
                       default:
                         CPLAssert( false );
-                        return CE_Failure;
+                        return;
                     }
 
                     if( eDataType != GDT_Float32 && bGotNoDataValue &&
@@ -3311,22 +3555,34 @@ CPLErr GDALRasterBand::GetHistogram( double dfMin, double dfMax,
                     if( nIndex < 0 )
                     {
                         if( bIncludeOutOfRange )
-                            ++panHistogram[0];
+                            ++panSlotHistogram[0];
                     }
                     else if( nIndex >= nBuckets )
                     {
                         if( bIncludeOutOfRange )
-                            ++panHistogram[nBuckets-1];
+                            ++panSlotHistogram[nBuckets-1];
                     }
                     else
                     {
-                        panHistogram[nIndex]++;
+                        panSlotHistogram[nIndex]++;
                     }
                 }
             }
+        };
 
-            poBlock->DropLock();
+        const CPLErr eErr =
+            GDALReduceSampledBlocks( this, nSampleRate, nSlots, pfnReduce,
+                                     "Compute Histogram",
+                                     pfnProgress, pProgressData );
+
+        for( const auto& anSlotHistogram: aanSlotHistograms )
+        {
+            for( int i = 0; i < nBuckets; i++ )
+                panHistogram[i] += anSlotHistogram[i];
         }
+
+        if( eErr != CE_None )
+            return eErr;
     }
 
     pfnProgress( 1.0, "Compute Histogram", pProgressData );
@@ -4808,6 +5064,359 @@ inline double GetPixelValue( GDALDataType eDataType,
     return dfValue;
 }
 
+/************************************************************************/
+/*                      GDALStatisticsAccumulator                       */
+/************************************************************************/
+
+namespace {
+
+struct GDALStatisticsAccumulator
+{
+    double   dfMin = std::numeric_limits<double>::infinity();
+    double   dfMax = -std::numeric_limits<double>::infinity();
+    double   dfMean = 0.0;
+    // Sum of squares of differences to the mean.
+    double   dfM2 = 0.0;
+    GUIntBig nSampleCount = 0;
+    GUIntBig nValidCount = 0;
+
+    // Combines with the statistics of another set of values, with the
+    // pairwise update of Chan, Golub and LeVeque, which stays accurate
+    // when the sets have very different means or sizes.
+    void Merge( GUIntBig nOtherValidCount, double dfOtherMean,
+                double dfOtherM2, double dfOtherMin, double dfOtherMax )
+    {
+        if( nOtherValidCount == 0 )
+            return;
+        dfMin = std::min(dfMin, dfOtherMin);
+        dfMax = std::max(dfMax, dfOtherMax);
+        if( nValidCount == 0 )
+        {
+            nValidCount = nOtherValidCount;
+            dfMean = dfOtherMean;
+            dfM2 = dfOtherM2;
+            return;
+        }
+        const GUIntBig nNewValidCount = nValidCount + nOtherValidCount;
+        const double dfDelta = dfOtherMean - dfMean;
+        const double dfOtherRatio =
+            static_cast<double>(nOtherValidCount) / nNewValidCount;
+        dfMean += dfDelta * dfOtherRatio;
+        dfM2 += dfOtherM2 +
+                dfDelta * dfDelta * static_cast<double>(nValidCount) *
+                                                                dfOtherRatio;
+        nValidCount = nNewValidCount;
+    }
+
+    void Merge( const GDALStatisticsAccumulator& oOther )
+    {
+        nSampleCount += oOther.nSampleCount;
+        Merge( oOther.nValidCount, oOther.dfMean, oOther.dfM2,
+               oOther.dfMin, oOther.dfMax );
+    }
+};
+
+} // namespace
+
+/************************************************************************/
+/*                       ComputeBlockStatistics()                       */
+/************************************************************************/
+
+template<class T> static inline XMMReg2Double LoadPixelPair( const T* p )
+{
+    return XMMReg2Double::Load2Val(p);
+}
+
+template<> inline XMMReg2Double LoadPixelPair<signed char>(
+                                                    const signed char* p )
+{
+    const double adf[2] = { static_cast<double>(p[0]),
+                            static_cast<double>(p[1]) };
+    return XMMReg2Double::Load2Val(adf);
+}
+
+template<> inline XMMReg2Double LoadPixelPair<GUInt32>( const GUInt32* p )
+{
+    const double adf[2] = { static_cast<double>(p[0]),
+                            static_cast<double>(p[1]) };
+    return XMMReg2Double::Load2Val(adf);
+}
+
+// All ones for the values that are neither NaN nor, if bHasNoData,
+// ARE_REAL_EQUAL() to the nodata value.
+template<bool bHasNoData>
+static inline XMMReg2Double GetValidPixelMask( const XMMReg2Double& oValue,
+                                               const XMMReg2Double& oNoData,
+                                               const XMMReg2Double& oTolerance,
+                                               const XMMReg2Double& oZero )
+{
+    const XMMReg2Double oNotNaN = XMMReg2Double::Equals(oValue, oValue);
+    if( !bHasNoData )
+        return oNotNaN;
+    const XMMReg2Double oDiff = oValue - oNoData;
+    const XMMReg2Double oSum = oValue + oNoData;
+    const XMMReg2Double oClose = XMMReg2Double::Greater(
+        XMMReg2Double::Max(oSum, oZero - oSum) * oTolerance,
+        XMMReg2Double::Max(oDiff, oZero - oDiff));
+    return XMMReg2Double::Ternary(
+        oClose, oZero,
+        XMMReg2Double::And(oNotNaN,
+                           XMMReg2Double::NotEquals(oValue, oNoData)));
+}
+
+// Statistics of a block of a real data type, two pixels at a time.
+// The block mean and sum of squared differences are computed in two
+// passes (the second one on data that is still in the CPU cache), which is
+// both faster and more accurate than a running update at each pixel.
+template<class T, bool bHasNoData, bool bComputeMoments>
+static void ComputeBlockStatisticsSIMD( const T* pData,
+                                        int nXCheck, int nYCheck,
+                                        int nLineStride,
+                                        double dfNoDataValue,
+                                        GDALStatisticsAccumulator& oAcc )
+{
+    const double dfOne = 1.0;
+    const double dfTolerance = 2 * std::numeric_limits<float>::epsilon();
+    const double dfInf = std::numeric_limits<double>::infinity();
+    const double dfMinusInf = -dfInf;
+    const XMMReg2Double oZero = XMMReg2Double::Zero();
+    const XMMReg2Double oOne = XMMReg2Double::Load1ValHighAndLow(&dfOne);
+    const XMMReg2Double oNoData =
+        XMMReg2Double::Load1ValHighAndLow(&dfNoDataValue);
+    const XMMReg2Double oTolerance =
+        XMMReg2Double::Load1ValHighAndLow(&dfTolerance);
+
+    const auto IsValid = [dfNoDataValue](double dfValue)
+    {
+        return !CPLIsNan(dfValue) &&
+               !(bHasNoData && ARE_REAL_EQUAL(dfValue, dfNoDataValue));
+    };
+
+    XMMReg2Double oMin = XMMReg2Double::Load1ValHighAndLow(&dfInf);
+    XMMReg2Double oMax = XMMReg2Double::Load1ValHighAndLow(&dfMinusInf);
+    XMMReg2Double oSum = oZero;
+    XMMReg2Double oCount = oZero;
+    double dfMin = dfInf;
+    double dfMax = dfMinusInf;
+    double dfSum = 0.0;
+    double dfCount = 0.0;
+    for( int iY = 0; iY < nYCheck; iY++ )
+    {
+        const T* const pLine =
+            pData + static_cast<GPtrDiff_t>(iY) * nLineStride;
+        int iX = 0;
+        for( ; iX + 1 < nXCheck; iX += 2 )
+        {
+            const XMMReg2Double oValue = LoadPixelPair(pLine + iX);
+            const XMMReg2Double oValid = GetValidPixelMask<bHasNoData>(
+                oValue, oNoData, oTolerance, oZero);
+            oMin = XMMReg2Double::Ternary(
+                oValid, XMMReg2Double::Min(oMin, oValue), oMin);
+            oMax = XMMReg2Double::Ternary(
+                oValid, XMMReg2Double::Max(oMax, oValue), oMax);
+            oCount += XMMReg2Double::Ternary(oValid, oOne, oZero);
+            if( bComputeMoments )
+                oSum += XMMReg2Double::Ternary(oValid, oValue, oZero);
+        }
+        for( ; iX < nXCheck; iX++ )
+        {
+            const double dfValue = static_cast<double>(pLine[iX]);
+            if( !IsValid(dfValue) )
+                continue;
+            dfMin = std::min(dfMin, dfValue);
+            dfMax = std::max(dfMax, dfValue);
+            dfSum += dfValue;
+            dfCount += 1.0;
+        }
+    }
+
+    double adfMin[2], adfMax[2];
+    oMin.Store2Val(adfMin);
+    oMax.Store2Val(adfMax);
+    dfMin = std::min(dfMin, std::min(adfMin[0], adfMin[1]));
+    dfMax = std::max(dfMax, std::max(adfMax[0], adfMax[1]));
+    dfSum += oSum.GetHorizSum();
+    dfCount += oCount.GetHorizSum();
+
+    oAcc.nSampleCount += static_cast<GUIntBig>(nXCheck) * nYCheck;
+    const GUIntBig nValidCount = static_cast<GUIntBig>(dfCount);
+    if( nValidCount == 0 )
+        return;
+    if( !bComputeMoments )
+    {
+        oAcc.Merge(nValidCount, 0.0, 0.0, dfMin, dfMax);
+        return;
+    }
+
+    // Second pass, with the "corrected two-pass algorithm" that compensates
+    // for the rounding error of the mean.
+    double dfMean = dfSum / dfCount;
+    const XMMReg2Double oMean = XMMReg2Double::Load1ValHighAndLow(&dfMean);
+    XMMReg2Double oM2 = oZero;
+    XMMReg2Double oDev = oZero;
+    double dfM2 = 0.0;
+    double dfDev = 0.0;
+    for( int iY = 0; iY < nYCheck; iY++ )
+    {
+        const T* const pLine =
+            pData + static_cast<GPtrDiff_t>(iY) * nLineStride;
+        int iX = 0;
+        for( ; iX + 1 < nXCheck; iX += 2 )
+        {
+            const XMMReg2Double oValue = LoadPixelPair(pLine + iX);
+            const XMMReg2Double oValid = GetValidPixelMask<bHasNoData>(
+                oValue, oNoData, oTolerance, oZero);
+            const XMMReg2Double oDelta =
+                XMMReg2Double::Ternary(oValid, oValue - oMean, oZero);
+            oM2 += oDelta * oDelta;
+            oDev += oDelta;
+        }
+        for( ; iX < nXCheck; iX++ )
+        {
+            const double dfValue = static_cast<double>(pLine[iX]);
+            if( !IsValid(dfValue) )
+                continue;
+            const double dfDelta = dfValue - dfMean;
+            dfM2 += dfDelta * dfDelta;
+            dfDev += dfDelta;
+        }
+    }
+    dfM2 += oM2.GetHorizSum();
+    dfDev += oDev.GetHorizSum();
+    dfM2 -= dfDev * dfDev / dfCount;
+    dfMean += dfDev / dfCount;
+
+    oAcc.Merge(nValidCount, dfMean, std::max(0.0, dfM2), dfMin, dfMax);
+}
+
+template<class T>
+static void ComputeBlockStatisticsSIMD( const T* pData,
+                                        int nXCheck, int nYCheck,
+                                        int nLineStride,
+                                        bool bHasNoData,
+                                        double dfNoDataValue,
+                                        bool bComputeMoments,
+                                        GDALStatisticsAccumulator& oAcc )
+{
+    if( bHasNoData )
+    {
+        if( bComputeMoments )
+            ComputeBlockStatisticsSIMD<T, true, true>(
+                pData, nXCheck, nYCheck, nLineStride, dfNoDataValue, oAcc);
+        else
+            ComputeBlockStatisticsSIMD<T, true, false>(
+                pData, nXCheck, nYCheck, nLineStride, dfNoDataValue, oAcc);
+    }
+    else
+    {
+        if( bComputeMoments )
+            ComputeBlockStatisticsSIMD<T, false, true>(
+                pData, nXCheck, nYCheck, nLineStride, dfNoDataValue, oAcc);
+        else
+            ComputeBlockStatisticsSIMD<T, false, false>(
+                pData, nXCheck, nYCheck, nLineStride, dfNoDataValue, oAcc);
+    }
+}
+
+// Adds the pixels of a block to oAcc, with the same nodata semantics as
+// GetPixelValue(). If bComputeMoments is false, only the minimum, maximum
+// and pixel counts are computed.
+static void ComputeBlockStatistics( GDALDataType eDataType,
+                                    bool bSignedByte,
+                                    const void* pData,
+                                    int nXCheck, int nYCheck,
+                                    int nLineStride,
+                                    bool bGotNoDataValue,
+                                    double dfNoDataValue,
+                                    bool bGotFloatNoDataValue,
+                                    float fNoDataValue,
+                                    bool bComputeMoments,
+                                    GDALStatisticsAccumulator& oAcc )
+{
+    switch( eDataType )
+    {
+        case GDT_Byte:
+            if( bSignedByte )
+                ComputeBlockStatisticsSIMD(
+                    static_cast<const signed char*>(pData),
+                    nXCheck, nYCheck, nLineStride,
+                    bGotNoDataValue, dfNoDataValue, bComputeMoments, oAcc);
+            else
+                ComputeBlockStatisticsSIMD(
+                    static_cast<const GByte*>(pData),
+                    nXCheck, nYCheck, nLineStride,
+                    bGotNoDataValue, dfNoDataValue, bComputeMoments, oAcc);
+            return;
+        case GDT_UInt16:
+            ComputeBlockStatisticsSIMD(
+                static_cast<const GUInt16*>(pData),
+                nXCheck, nYCheck, nLineStride,
+                bGotNoDataValue, dfNoDataValue, bComputeMoments, oAcc);
+            return;
+        case GDT_Int16:
+            ComputeBlockStatisticsSIMD(
+                static_cast<const GInt16*>(pData),
+                nXCheck, nYCheck, nLineStride,
+                bGotNoDataValue, dfNoDataValue, bComputeMoments, oAcc);
+            return;
+        case GDT_UInt32:
+            ComputeBlockStatisticsSIMD(
+                static_cast<const GUInt32*>(pData),
+                nXCheck, nYCheck, nLineStride,
+                bGotNoDataValue, dfNoDataValue, bComputeMoments, oAcc);
+            return;
+        case GDT_Int32:
+            ComputeBlockStatisticsSIMD(
+                static_cast<const GInt32*>(pData),
+                nXCheck, nYCheck, nLineStride,
+                bGotNoDataValue, dfNoDataValue, bComputeMoments, oAcc);
+            return;
+        case GDT_Float32:
+            // GetPixelValue() compares Float32 values to the nodata value
+            // cast to float.
+            ComputeBlockStatisticsSIMD(
+                static_cast<const float*>(pData),
+                nXCheck, nYCheck, nLineStride,
+                bGotFloatNoDataValue, static_cast<double>(fNoDataValue),
+                bComputeMoments, oAcc);
+            return;
+        case GDT_Float64:
+            ComputeBlockStatisticsSIMD(
+                static_cast<const double*>(pData),
+                nXCheck, nYCheck, nLineStride,
+                bGotNoDataValue, dfNoDataValue, bComputeMoments, oAcc);
+            return;
+        default:
+            break;
+    }
+
+    // Complex data types: statistics of the real part.
+    GDALStatisticsAccumulator oBlockAcc;
+    for( int iY = 0; iY < nYCheck; iY++ )
+    {
+        for( int iX = 0; iX < nXCheck; iX++ )
+        {
+            const GPtrDiff_t iOffset =
+                iX + static_cast<GPtrDiff_t>(iY) * nLineStride;
+            bool bValid = true;
+            const double dfValue = GetPixelValue( eDataType,
+                                                  bSignedByte,
+                                                  pData,
+                                                  iOffset,
+                                                  bGotNoDataValue,
+                                                  dfNoDataValue,
+                                                  bGotFloatNoDataValue,
+                                                  fNoDataValue,
+                                                  bValid );
+            if( bValid )
+                oBlockAcc.Merge(1, dfValue, 0.0, dfValue, dfValue);
+        }
+    }
+    oAcc.nSampleCount += static_cast<GUIntBig>(nXCheck) * nYCheck;
+    oAcc.Merge( oBlockAcc.nValidCount, oBlockAcc.dfMean, oBlockAcc.dfM2,
+                oBlockAcc.dfMin, oBlockAcc.dfMax );
+}
+
 /************************************************************************/
 /*                         SetValidPercent()                            */
 /************************************************************************/
@@ -4869,6 +5478,10 @@ void GDALRasterBand::SetValidPercent(GUIntBig nSampleCount, GUIntBig nValidCount
  * Once computed, the statistics will generally be "set" back on the
  * raster band using SetStatistics().
  *
+ * Starting with GDAL 3.1, blocks are reduced on several threads when the
+ * GDAL_NUM_THREADS configuration option is set to a value greater than one,
+ * or ALL_CPUS.
+ *
  * This method is the same as the C function GDALComputeRasterStatistics().
  *
  * @param bApproxOK If TRUE statistics may be computed based on overviews
@@ -4945,17 +5558,12 @@ GDALRasterBand::ComputeStatistics( int bApproxOK,
 /* -------------------------------------------------------------------- */
 /*      Read actual data and compute statistics.                        */
 /* -------------------------------------------------------------------- */
-    bool bFirstValue = true;
-    // Using Welford algorithm:
+    // The mean and the sum of squares of differences to the mean (dfM2) are
+    // computed per block, and blocks are combined with the pairwise
+    // algorithm of Chan et al., which is numerically more robust than the
+    // difference of the sum of square values with the square of the sum:
     // http://en.wikipedia.org/wiki/Algorithms_for_calculating_variance
-    // to compute standard deviation in a more numerically robust way than
-    // the difference of the sum of square values with the square of the sum.
-    // dfMean and dfM2 are updated at each sample.
-    // dfM2 is the sum of square of differences to the current mean.
-    double dfMin = 0.0;
-    double dfMax = 0.0;
-    double dfMean = 0.0;
-    double dfM2 = 0.0;
+    GDALStatisticsAccumulator oAcc;
 
     GDALRasterIOExtraArg sExtraArg;
     INIT_RASTERIO_EXTRA_ARG(sExtraArg);
@@ -4973,9 +5581,6 @@ GDALRasterBand::ComputeStatistics( int bApproxOK,
     const bool bSignedByte =
         pszPixelType != nullptr && EQUAL(pszPixelType, "SIGNEDBYTE");
 
-    GUIntBig nSampleCount = 0;
-    GUIntBig nValidCount = 0;
-
     if ( bApproxOK && HasArbitraryOverviews() )
     {
 /* -------------------------------------------------------------------- */
@@ -5013,44 +5618,11 @@ GDALRasterBand::ComputeStatistics( int bApproxOK,
             return eErr;
         }
 
-        /* this isn't the fastest way to do this, but is easier for now */
-        for( int iY = 0; iY < nYReduced; iY++ )
-        {
-            for( int iX = 0; iX < nXReduced; iX++ )
-            {
-                const int iOffset = iX + iY * nXReduced;
-                bool bValid = true;
-                double dfValue = GetPixelValue( eDataType,
-                                                bSignedByte,
-                                                pData,
-                                                iOffset,
-                                                CPL_TO_BOOL(bGotNoDataValue),
-                                                dfNoDataValue,
-                                                bGotFloatNoDataValue,
-                                                fNoDataValue,
-                                                bValid );
-                nSampleCount++;
-                if( !bValid )
-                    continue;
-
-                if( bFirstValue )
-                {
-                    dfMin = dfValue;
-                    dfMax = dfValue;
-                    bFirstValue = false;
-                }
-                else
-                {
-                    dfMin = std::min(dfMin, dfValue);
-                    dfMax = std::max(dfMax, dfValue);
-                }
-
-                nValidCount++;
-                const double dfDelta = dfValue - dfMean;
-                dfMean += dfDelta / nValidCount;
-                dfM2 += dfDelta * (dfValue - dfMean);
-            }
-        }
+        ComputeBlockStatistics( eDataType, bSignedByte, pData,
+                                nXReduced, nYReduced, nXReduced,
+                                CPL_TO_BOOL(bGotNoDataValue), dfNoDataValue,
+                                bGotFloatNoDataValue, fNoDataValue,
+                                true, oAcc );
 
         CPLFree( pData );
     }
@@ -5080,6 +5652,9 @@ GDALRasterBand::ComputeStatistics( int bApproxOK,
         if( nSampleRate == 1 )
             bApproxOK = false;
 
+        // Each worker thread reduces its blocks into its own accumulator.
+        const int nSlots = GDALGetBlockReductionThreadCount();
+
 #ifdef CPL_HAS_GINT64
         // Particular case for GDT_Byte that only use integral types for all
         // intermediate computations. Only possible if the number of pixels
@@ -5096,10 +5671,6 @@ GDALRasterBand::ComputeStatistics( int bApproxOK,
                         (static_cast<GUInt64>(nBlockXSize) * static_cast<GUInt64>(nBlockYSize))) )
         {
             const GUInt32 nMaxValueType = (eDataType == GDT_Byte) ? 255 : 65535;
-            GUInt32 nMin = nMaxValueType;
-            GUInt32 nMax = 0;
-            GUIntBig nSum = 0;
-            GUIntBig nSumSquare = 0;
             // If no valid nodata, map to invalid value (256 for Byte)
             const GUInt32 nNoDataValue =
                 (bGotNoDataValue && dfNoDataValue >= 0 &&
@@ -5109,60 +5680,103 @@ GDALRasterBand::ComputeStatistics( int bApproxOK,
                             static_cast<GUInt32>(dfNoDataValue + 1e-10) :
                             nMaxValueType+1;
 
-            for( int iSampleBlock = 0;
-                iSampleBlock < nBlocksPerRow * nBlocksPerColumn;
-                iSampleBlock += nSampleRate )
+            struct IntegralStatistics
             {
-                const int iYBlock = iSampleBlock / nBlocksPerRow;
-                const int iXBlock = iSampleBlock - nBlocksPerRow * iYBlock;
-
-                GDALRasterBlock * const poBlock =
-                    GetLockedBlockRef( iXBlock, iYBlock );
-                if( poBlock == nullptr )
-                    return CE_Failure;
-
-                void* const pData = poBlock->GetDataRef();
-
-                int nXCheck = 0, nYCheck = 0;
-                GetActualBlockSize(iXBlock, iYBlock, &nXCheck, &nYCheck);
-
-                if( eDataType == GDT_Byte )
+                GUInt32  nMin;
+                GUInt32  nMax;
+                GUIntBig nSum;
+                GUIntBig nSumSquare;
+                GUIntBig nSampleCount;
+                GUIntBig nValidCount;
+            };
+            std::vector<IntegralStatistics> asSlotStats(
+                nSlots, IntegralStatistics{ nMaxValueType, 0, 0, 0, 0, 0 });
+
+            const GDALBlockReduceFunc pfnReduce =
+                [&]( int iSlot, const void* pData, int nXCheck, int nYCheck,
+                     int nLineStride, bool bFromBlockCache )
+            {
+                IntegralStatistics& s = asSlotStats[iSlot];
+                if( eDataType == GDT_Byte && bFromBlockCache )
                 {
                     ComputeStatisticsInternal( nXCheck,
-                                               nBlockXSize,
+                                               nLineStride,
                                                nYCheck,
                                                static_cast<const GByte*>(pData),
                                                nNoDataValue <= nMaxValueType,
                                                nNoDataValue,
-                                               nMin, nMax, nSum,
-                                               nSumSquare,
-                                               nSampleCount,
-                                               nValidCount );
+                                               s.nMin, s.nMax, s.nSum,
+                                               s.nSumSquare,
+                                               s.nSampleCount,
+                                               s.nValidCount );
                 }
-                else
+                else if( eDataType == GDT_Byte )
+                {
+                    // The SSE2 kernels require aligned data.
+                    ComputeStatisticsInternalGeneric( nXCheck,
+                                               nLineStride,
+                                               nYCheck,
+                                               static_cast<const GByte*>(pData),
+                                               nNoDataValue <= nMaxValueType,
+                                               nNoDataValue,
+                                               s.nMin, s.nMax, s.nSum,
+                                               s.nSumSquare,
+                                               s.nSampleCount,
+                                               s.nValidCount );
+                }
+                else if( bFromBlockCache )
                 {
                     ComputeStatisticsInternal( nXCheck,
-                                               nBlockXSize,
+                                               nLineStride,
+                                               nYCheck,
+                                               static_cast<const GUInt16*>(pData),
+                                               nNoDataValue <= nMaxValueType,
+                                               nNoDataValue,
+                                               s.nMin, s.nMax, s.nSum,
+                                               s.nSumSquare,
+                                               s.nSampleCount,
+                                               s.nValidCount );
+                }
+                else
+                {
+                    ComputeStatisticsInternalGeneric( nXCheck,
+                                               nLineStride,
                                                nYCheck,
                                                static_cast<const GUInt16*>(pData),
                                                nNoDataValue <= nMaxValueType,
                                                nNoDataValue,
-                                               nMin, nMax, nSum,
-                                               nSumSquare,
-                                               nSampleCount,
-                                               nValidCount );
+                                               s.nMin, s.nMax, s.nSum,
+                                               s.nSumSquare,
+                                               s.nSampleCount,
+                                               s.nValidCount );
                 }
+            };
 
-                poBlock->DropLock();
+            if( GDALReduceSampledBlocks( this, nSampleRate, nSlots, pfnReduce,
+                                         "Compute Statistics",
+                                         pfnProgress, pProgressData )
+                                                                != CE_None )
+            {
+                return CE_Failure;
+            }
 
-                if ( !pfnProgress( iSampleBlock
-                        / static_cast<double>(nBlocksPerRow*nBlocksPerColumn),
-                        "Compute Statistics", pProgressData) )
+            GUInt32 nMin = nMaxValueType;
+            GUInt32 nMax = 0;
+            GUIntBig nSum = 0;
+            GUIntBig nSumSquare = 0;
+            GUIntBig nSampleCount = 0;
+            GUIntBig nValidCount = 0;
+            for( const auto& s: asSlotStats )
+            {
+                if( s.nValidCount )
                 {
-                    ReportError( CE_Failure, CPLE_UserInterrupt,
-                                 "User terminated" );
-                    return CE_Failure;
+                    nMin = std::min(nMin, s.nMin);
+                    nMax = std::max(nMax, s.nMax);
                 }
+                nSum += s.nSum;
+                nSumSquare += s.nSumSquare;
+                nSampleCount += s.nSampleCount;
+                nValidCount += s.nValidCount;
             }
 
             if( !pfnProgress( 1.0, "Compute Statistics", pProgressData ) )
@@ -5175,6 +5789,7 @@ GDALRasterBand::ComputeStatistics( int bApproxOK,
 /* -------------------------------------------------------------------- */
 /*      Save computed information.                                      */
 /* -------------------------------------------------------------------- */
+            double dfMean = 0.0;
             if( nValidCount )
                 dfMean = static_cast<double>(nSum) / nValidCount;
 
@@ -5228,73 +5843,28 @@ GDALRasterBand::ComputeStatistics( int bApproxOK,
         }
 #endif
 
-        for( int iSampleBlock = 0;
-             iSampleBlock < nBlocksPerRow * nBlocksPerColumn;
-             iSampleBlock += nSampleRate )
+        std::vector<GDALStatisticsAccumulator> aoSlotAcc(nSlots);
+        const GDALBlockReduceFunc pfnReduce =
+            [&]( int iSlot, const void* pData, int nXCheck, int nYCheck,
+                 int nLineStride, bool /* bFromBlockCache */ )
         {
-            const int iYBlock = iSampleBlock / nBlocksPerRow;
-            const int iXBlock = iSampleBlock - nBlocksPerRow * iYBlock;
-
-            GDALRasterBlock * const poBlock = GetLockedBlockRef( iXBlock, iYBlock );
-            if( poBlock == nullptr )
-                return CE_Failure;
+            ComputeBlockStatistics( eDataType, bSignedByte, pData,
+                                    nXCheck, nYCheck, nLineStride,
+                                    CPL_TO_BOOL(bGotNoDataValue),
+                                    dfNoDataValue,
+                                    bGotFloatNoDataValue, fNoDataValue,
+                                    true, aoSlotAcc[iSlot] );
+        };
 
-            void* const pData = poBlock->GetDataRef();
-
-            int nXCheck = 0, nYCheck = 0;
-            GetActualBlockSize(iXBlock, iYBlock, &nXCheck, &nYCheck);
-
-            // This isn't the fastest way to do this, but is easier for now.
-            for( int iY = 0; iY < nYCheck; iY++ )
-            {
-                for( int iX = 0; iX < nXCheck; iX++ )
-                {
-                    const GPtrDiff_t iOffset = iX + static_cast<GPtrDiff_t>(iY) * nBlockXSize;
-                    bool bValid = true;
-                    double dfValue = GetPixelValue( eDataType,
-                                                    bSignedByte,
-                                                    pData,
-                                                    iOffset,
-                                                    CPL_TO_BOOL(bGotNoDataValue),
-                                                    dfNoDataValue,
-                                                    bGotFloatNoDataValue,
-                                                    fNoDataValue,
-                                                    bValid );
-
-                    nSampleCount++;
-                    if( !bValid )
-                        continue;
-
-                    if( bFirstValue )
-                    {
-                        dfMin = dfValue;
-                        dfMax = dfValue;
-                        bFirstValue = false;
-                    }
-                    else
-                    {
-                        dfMin = std::min(dfMin, dfValue);
-                        dfMax = std::max(dfMax, dfValue);
-                    }
-
-                    nValidCount++;
-                    const double dfDelta = dfValue - dfMean;
-                    dfMean += dfDelta / nValidCount;
-                    dfM2 += dfDelta * (dfValue - dfMean);
-                }
-            }
-
-            poBlock->DropLock();
-
-            if ( !pfnProgress(
-                     iSampleBlock
-                         / static_cast<double>(nBlocksPerRow*nBlocksPerColumn),
-                     "Compute Statistics", pProgressData) )
-            {
-                ReportError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
-                return CE_Failure;
-            }
+        if( GDALReduceSampledBlocks( this, nSampleRate, nSlots, pfnReduce,
+                                     "Compute Statistics",
+                                     pfnProgress, pProgressData ) != CE_None )
+        {
+            return CE_Failure;
         }
+
+        for( const auto& oSlotAcc: aoSlotAcc )
+            oAcc.Merge(oSlotAcc);
     }
 
     if( !pfnProgress( 1.0, "Compute Statistics", pProgressData ) )
@@ -5306,8 +5876,12 @@ GDALRasterBand::ComputeStatistics( int bApproxOK,
 /* -------------------------------------------------------------------- */
 /*      Save computed information.                                      */
 /* -------------------------------------------------------------------- */
+    const GUIntBig nValidCount = oAcc.nValidCount;
+    const double dfMin = nValidCount > 0 ? oAcc.dfMin : 0.0;
+    const double dfMax = nValidCount > 0 ? oAcc.dfMax : 0.0;
+    const double dfMean = oAcc.dfMean;
     const double dfStdDev =
-        nValidCount > 0 ? sqrt(dfM2 / nValidCount) : 0.0;
+        nValidCount > 0 ? sqrt(oAcc.dfM2 / nValidCount) : 0.0;
 
     if( nValidCount > 0 )
     {
@@ -5322,7 +5896,7 @@ GDALRasterBand::ComputeStatistics( int bApproxOK,
         SetStatistics( dfMin, dfMax, dfMean, dfStdDev );
     }
 
-    SetValidPercent( nSampleCount, nValidCount );
+    SetValidPercent( oAcc.nSampleCount, nValidCount );
 
 /* -------------------------------------------------------------------- */
 /*      Record results.                                                 */
@@ -5457,6 +6031,10 @@ CPLErr CPL_STDCALL GDALSetRasterStatistics(
  * If bApprox is FALSE, then all pixels will be read and used to compute
  * an exact range.
  *
+ * Starting with GDAL 3.1, blocks are reduced on several threads when the
+ * GDAL_NUM_THREADS configuration option is set to a value greater than one,
+ * or ALL_CPUS.
+ *
  * This method is the same as the C function GDALComputeRasterMinMax().
  *
  * @param bApproxOK TRUE if an approximate (faster) answer is OK, otherwise
@@ -5523,7 +6101,7 @@ CPLErr GDALRasterBand::ComputeRasterMinMax( int bApproxOK,
     GDALRasterIOExtraArg sExtraArg;
     INIT_RASTERIO_EXTRA_ARG(sExtraArg);
 
-    bool bFirstValue = true;
+    GDALStatisticsAccumulator oAcc;
     if ( bApproxOK && HasArbitraryOverviews() )
     {
 /* -------------------------------------------------------------------- */
@@ -5561,38 +6139,11 @@ CPLErr GDALRasterBand::ComputeRasterMinMax( int bApproxOK,
             return eErr;
         }
 
-        /* this isn't the fastest way to do this, but is easier for now */
-        for( int iY = 0; iY < nYReduced; iY++ )
-        {
-            for( int iX = 0; iX < nXReduced; iX++ )
-            {
-                const int iOffset = iX + iY * nXReduced;
-                bool bValid = true;
-                double dfValue = GetPixelValue( eDataType,
-                                                bSignedByte,
-                                                pData,
-                                                iOffset,
-                                                CPL_TO_BOOL(bGotNoDataValue),
-                                                dfNoDataValue,
-                                                bGotFloatNoDataValue,
-                                                fNoDataValue,
-                                                bValid );
-                if( !bValid )
-                    continue;
-
-                if( bFirstValue )
-                {
-                    dfMin = dfValue;
-                    dfMax = dfValue;
-                    bFirstValue = false;
-                }
-                else
-                {
-                    dfMin = std::min(dfMin, dfValue);
-                    dfMax = std::max(dfMax, dfValue);
-                }
-            }
-        }
+        ComputeBlockStatistics( eDataType, bSignedByte, pData,
+                                nXReduced, nYReduced, nXReduced,
+                                CPL_TO_BOOL(bGotNoDataValue), dfNoDataValue,
+                                bGotFloatNoDataValue, fNoDataValue,
+                                false, oAcc );
 
         CPLFree( pData );
     }
@@ -5621,63 +6172,40 @@ CPLErr GDALRasterBand::ComputeRasterMinMax( int bApproxOK,
               nSampleRate += 1;
         }
 
-        for( int iSampleBlock = 0;
-             iSampleBlock < nBlocksPerRow * nBlocksPerColumn;
-             iSampleBlock += nSampleRate )
+        const int nSlots = GDALGetBlockReductionThreadCount();
+        std::vector<GDALStatisticsAccumulator> aoSlotAcc(nSlots);
+        const GDALBlockReduceFunc pfnReduce =
+            [&]( int iSlot, const void* pData, int nXCheck, int nYCheck,
+                 int nLineStride, bool /* bFromBlockCache */ )
         {
-            const int iYBlock = iSampleBlock / nBlocksPerRow;
-            const int iXBlock = iSampleBlock - nBlocksPerRow * iYBlock;
-
-            GDALRasterBlock *poBlock = GetLockedBlockRef( iXBlock, iYBlock );
-            if( poBlock == nullptr )
-                return CE_Failure;
-
-            void * const pData = poBlock->GetDataRef();
-
-            int nXCheck = 0, nYCheck = 0;
-            GetActualBlockSize(iXBlock, iYBlock, &nXCheck, &nYCheck);
-
-            // This isn't the fastest way to do this, but is easier for now.
-            for( int iY = 0; iY < nYCheck; iY++ )
-            {
-                for( int iX = 0; iX < nXCheck; iX++ )
-                {
-                    const GPtrDiff_t iOffset = iX + static_cast<GPtrDiff_t>(iY) * nBlockXSize;
-                    bool bValid = true;
-                    double dfValue = GetPixelValue( eDataType,
-                                                    bSignedByte,
-                                                    pData,
-                                                    iOffset,
-                                                    CPL_TO_BOOL(bGotNoDataValue),
-                                                    dfNoDataValue,
-                                                    bGotFloatNoDataValue,
-                                                    fNoDataValue,
-                                                    bValid );
-                    if( !bValid )
-                        continue;
-
-                    if( bFirstValue )
-                    {
-                        dfMin = dfValue;
-                        dfMax = dfValue;
-                        bFirstValue = false;
-                    }
-                    else
-                    {
-                        dfMin = std::min(dfMin, dfValue);
-                        dfMax = std::max(dfMax, dfValue);
-                    }
-                }
-            }
+            ComputeBlockStatistics( eDataType, bSignedByte, pData,
+                                    nXCheck, nYCheck, nLineStride,
+                                    CPL_TO_BOOL(bGotNoDataValue),
+                                    dfNoDataValue,
+                                    bGotFloatNoDataValue, fNoDataValue,
+                                    false, aoSlotAcc[iSlot] );
+        };
 
-            poBlock->DropLock();
+        if( GDALReduceSampledBlocks( this, nSampleRate, nSlots, pfnReduce,
+                                     "Compute Min Max",
+                                     GDALDummyProgress, nullptr ) != CE_None )
+        {
+            return CE_Failure;
         }
+
+        for( const auto& oSlotAcc: aoSlotAcc )
+            oAcc.Merge(oSlotAcc);
     }
 
+    if( oAcc.nValidCount > 0 )
+    {
+        dfMin = oAcc.dfMin;
+        dfMax = oAcc.dfMax;
+    }
     adfMinMax[0] = dfMin;
     adfMinMax[1] = dfMax;
 
-    if (bFirstValue)
+    if( oAcc.nValidCount == 0 )
     {
         ReportError(
             CE_Failure, CPLE_AppDefined,
@@ -6699,6 +7227,412 @@ CPLVirtualMem * GDALGetVirtualMemAuto( GDALRasterBandH hBand,
                                       const_cast<char**>(papszOptions) );
 }
 
+/************************************************************************/
+/*                        GetDirectReadPointer()                        */
+/************************************************************************/
+
+/** \brief Return a read-only view on the pixel values of the band.
+ *
+ * Some bands store their pixel values in memory (MEM driver), or in a file
+ * that can be mapped into memory ("raw" drivers such as EHdr or ENVI opened
+ * in read-only mode, with the native byte order). For them, this method
+ * returns a pointer to the value of the pixel at (0, 0), so that the
+ * values can be read without any copy. Other bands return NULL, in which
+ * case RasterIO() must be used.
+ *
+ * If p is the returned pointer and base_type the type matching
+ * GDALGetRasterDataType(), the value of the pixel at (x, y) is
+ * *(const base_type*) ((const GByte*)p + x * *pnPixelSpace + y * *pnLineSpace)
+ *
+ * The pointer remains valid until the band is destroyed. The view must not
+ * be written, and does not necessarily reflect the values written to the
+ * band after this method has been called.
+ *
+ * This method is the same as the C GDALGetDirectReadPointer() function.
+ *
+ * @param pnPixelSpace Output parameter giving the byte offset from the start
+ * of one pixel value to the start of the next pixel value within a scanline.
+ *
+ * @param pnLineSpace Output parameter giving the byte offset from the start
+ * of one scanline to the start of the next.
+ *
+ * @return a pointer to the value of the pixel at (0, 0), or NULL.
+ *
+ * @since GDAL 3.1
+ */
+
+const void *GDALRasterBand::GetDirectReadPointer(
+                                        GSpacing * /* pnPixelSpace */,
+                                        GSpacing * /* pnLineSpace */ )
+{
+    return nullptr;
+}
+
+/************************************************************************/
+/*                      GDALGetDirectReadPointer()                      */
+/************************************************************************/
+
+/**
+ * \brief Return a read-only view on the pixel values of the band.
+ *
+ * @see GDALRasterBand::GetDirectReadPointer()
+ * @since GDAL 3.1
+ */
+
+const void *GDALGetDirectReadPointer( GDALRasterBandH hBand,
+                                      GSpacing *pnPixelSpace,
+                                      GSpacing *pnLineSpace )
+{
+    VALIDATE_POINTER1( hBand, "GDALGetDirectReadPointer", nullptr );
+    VALIDATE_POINTER1( pnPixelSpace, "GDALGetDirectReadPointer", nullptr );
+    VALIDATE_POINTER1( pnLineSpace, "GDALGetDirectReadPointer", nullptr );
+
+    GDALRasterBand *poBand = GDALRasterBand::FromHandle(hBand);
+
+    return poBand->GetDirectReadPointer( pnPixelSpace, pnLineSpace );
+}
+
+/************************************************************************/
+/*                        GetRawBlockCodecInfo()                        */
+/************************************************************************/
+
+/** \brief Return how a block is stored by the driver.
+ *
+ * Drivers that store their blocks as independently encoded chunks (GTiff,
+ * and thus COG) can give access to the stored (typically compressed) bytes of
+ * a block through ReadRawBlock() and WriteRawBlock(). This method returns
+ * the parameters needed to decode those bytes, as a list of NAME=VALUE
+ * strings. The following items are always set:
+ * <ul>
+ * <li>CODEC: the name of the encoding family, e.g. "TIFF".</li>
+ * <li>BLOCK_XSIZE and BLOCK_YSIZE: the block dimensions.</li>
+ * <li>DATA_TYPE: the data type of the decoded values.</li>
+ * <li>INTERLEAVE: PIXEL if the block holds the values of BAND_COUNT bands
+ * (the first band of the dataset gives access to it), or BAND if it holds
+ * the values of this band only.</li>
+ * <li>BAND_COUNT: the number of bands stored in the block.</li>
+ * </ul>
+ * Drivers add their own items (e.g. TIFF_COMPRESSION).
+ *
+ * Two blocks are interchangeable when their codec information lists are
+ * identical.
+ *
+ * This method is the same as the C GDALGetRawBlockCodecInfo() function.
+ *
+ * @param nXBlockOff the horizontal block offset.
+ * @param nYBlockOff the vertical block offset.
+ *
+ * @return a list to free with CSLDestroy(), or NULL if the band does not
+ * support raw block access.
+ *
+ * @since GDAL 3.1
+ */
+
+char **GDALRasterBand::GetRawBlockCodecInfo( int /* nXBlockOff */,
+                                             int /* nYBlockOff */ )
+{
+    return nullptr;
+}
+
+/************************************************************************/
+/*                      GDALGetRawBlockCodecInfo()                      */
+/************************************************************************/
+
+/**
+ * \brief Return how a block is stored by the driver.
+ *
+ * @see GDALRasterBand::GetRawBlockCodecInfo()
+ * @since GDAL 3.1
+ */
+
+char **GDALGetRawBlockCodecInfo( GDALRasterBandH hBand,
+                                 int nXBlockOff, int nYBlockOff )
+{
+    VALIDATE_POINTER1( hBand, "GDALGetRawBlockCodecInfo", nullptr );
+
+    GDALRasterBand *poBand = GDALRasterBand::FromHandle(hBand);
+    return poBand->GetRawBlockCodecInfo( nXBlockOff, nYBlockOff );
+}
+
+/************************************************************************/
+/*                     GDALRawBlockCodecInfoEqual()                     */
+/************************************************************************/
+
+//! @cond Doxygen_Suppress
+bool GDALRawBlockCodecInfoEqual( CSLConstList papszInfo1,
+                                 CSLConstList papszInfo2 )
+{
+    if( papszInfo1 == nullptr || papszInfo2 == nullptr ||
+        CSLCount(papszInfo1) != CSLCount(papszInfo2) )
+        return false;
+    for( CSLConstList papszIter = papszInfo1; *papszIter; ++papszIter )
+    {
+        if( CSLFindString(papszInfo2, *papszIter) < 0 )
+            return false;
+    }
+    return true;
+}
+//! @endcond
+
+/************************************************************************/
+/*                        ValidateRawBlockOffset()                      */
+/************************************************************************/
+
+//! @cond Doxygen_Suppress
+bool GDALRasterBand::ValidateRawBlockOffset( int nXBlockOff, int nYBlockOff,
+                                             const char* pszFunction )
+{
+    if( !InitBlockInfo() )
+        return false;
+
+    if( nXBlockOff < 0 || nXBlockOff >= nBlocksPerRow ||
+        nYBlockOff < 0 || nYBlockOff >= nBlocksPerColumn )
+    {
+        ReportError( CE_Failure, CPLE_IllegalArg,
+                     "Illegal block offset (%d,%d) in "
+                     "GDALRasterBand::%s()",
+                     nXBlockOff, nYBlockOff, pszFunction );
+        return false;
+    }
+    return true;
+}
+//! @endcond
+
+/************************************************************************/
+/*                            ReadRawBlock()                            */
+/************************************************************************/
+
+/** \brief Read the stored bytes of a block, without decoding them.
+ *
+ * See GetRawBlockCodecInfo() for the drivers supporting it. Serving tiles
+ * or reorganizing files this way costs no decompression or compression.
+ *
+ * A block that has never been written is returned with a size of 0.
+ *
+ * This method is the same as the C GDALReadRawBlock() function.
+ *
+ * @param nXBlockOff the horizontal block offset.
+ * @param nYBlockOff the vertical block offset.
+ * @param ppData pointer to a buffer set to the block bytes, to be freed with
+ * VSIFree(). Set to NULL for a block of size 0.
+ * @param pnDataSize pointer to the size of *ppData.
+ * @param ppapszCodecInfo pointer to a list set to the result of
+ * GetRawBlockCodecInfo(), to be freed with CSLDestroy(), or NULL.
+ *
+ * @return CE_None on success or CE_Failure on an error.
+ *
+ * @since GDAL 3.1
+ */
+
+CPLErr GDALRasterBand::ReadRawBlock( int nXBlockOff, int nYBlockOff,
+                                     void** ppData, size_t* pnDataSize,
+                                     char*** ppapszCodecInfo )
+{
+    CPLAssert( ppData != nullptr );
+    CPLAssert( pnDataSize != nullptr );
+
+    *ppData = nullptr;
+    *pnDataSize = 0;
+    if( ppapszCodecInfo )
+        *ppapszCodecInfo = nullptr;
+
+    if( !ValidateRawBlockOffset(nXBlockOff, nYBlockOff, "ReadRawBlock") )
+        return CE_Failure;
+
+    char** papszCodecInfo = GetRawBlockCodecInfo(nXBlockOff, nYBlockOff);
+    if( papszCodecInfo == nullptr )
+    {
+        ReportError( CE_Failure, CPLE_NotSupported,
+                     "ReadRawBlock() not supported for this dataset." );
+        return CE_Failure;
+    }
+
+    const bool bCallLeaveReadWrite = CPL_TO_BOOL(EnterReadWrite(GF_Read));
+    const CPLErr eErr =
+        IReadRawBlock( nXBlockOff, nYBlockOff, ppData, pnDataSize );
+    if( bCallLeaveReadWrite ) LeaveReadWrite();
+
+    if( ppapszCodecInfo && eErr == CE_None )
+        *ppapszCodecInfo = papszCodecInfo;
+    else
+        CSLDestroy(papszCodecInfo);
+    return eErr;
+}
+
+/************************************************************************/
+/*                          GDALReadRawBlock()                          */
+/************************************************************************/
+
+/**
+ * \brief Read the stored bytes of a block, without decoding them.
+ *
+ * @see GDALRasterBand::ReadRawBlock()
+ * @since GDAL 3.1
+ */
+
+CPLErr GDALReadRawBlock( GDALRasterBandH hBand, int nXBlockOff, int nYBlockOff,
+                         void** ppData, size_t* pnDataSize,
+                         char*** ppapszCodecInfo )
+{
+    VALIDATE_POINTER1( hBand, "GDALReadRawBlock", CE_Failure );
+    VALIDATE_POINTER1( ppData, "GDALReadRawBlock", CE_Failure );
+    VALIDATE_POINTER1( pnDataSize, "GDALReadRawBlock", CE_Failure );
+
+    GDALRasterBand *poBand = GDALRasterBand::FromHandle(hBand);
+    return poBand->ReadRawBlock( nXBlockOff, nYBlockOff, ppData, pnDataSize,
+                                 ppapszCodecInfo );
+}
+
+/************************************************************************/
+/*                           WriteRawBlock()                            */
+/************************************************************************/
+
+/** \brief Write the stored bytes of a block, without encoding them.
+ *
+ * The bytes, typically obtained with ReadRawBlock() on another dataset, are
+ * written as is. They are only accepted if papszCodecInfo is identical to
+ * what GetRawBlockCodecInfo() returns for the target block.
+ *
+ * When the codec information has INTERLEAVE=PIXEL, the block is written
+ * for all the bands at once.
+ *
+ * This method is the same as the C GDALWriteRawBlock() function.
+ *
+ * @param nXBlockOff the horizontal block offset.
+ * @param nYBlockOff the vertical block offset.
+ * @param pData the block bytes.
+ * @param nDataSize the size of pData.
+ * @param papszCodecInfo the codec information of pData.
+ *
+ * @return CE_None on success or CE_Failure on an error.
+ *
+ * @since GDAL 3.1
+ */
+
+CPLErr GDALRasterBand::WriteRawBlock( int nXBlockOff, int nYBlockOff,
+                                      const void* pData, size_t nDataSize,
+                                      CSLConstList papszCodecInfo )
+{
+    CPLAssert( pData != nullptr || nDataSize == 0 );
+
+    if( !ValidateRawBlockOffset(nXBlockOff, nYBlockOff, "WriteRawBlock") )
+        return CE_Failure;
+
+    if( eAccess == GA_ReadOnly )
+    {
+        ReportError( CE_Failure, CPLE_NoWriteAccess,
+                     "Attempt to write to read only dataset in "
+                     "GDALRasterBand::WriteRawBlock()." );
+        return CE_Failure;
+    }
+
+    if( nDataSize == 0 )
+    {
+        ReportError( CE_Failure, CPLE_IllegalArg,
+                     "Empty block in GDALRasterBand::WriteRawBlock()." );
+        return CE_Failure;
+    }
+
+    char** papszOwnCodecInfo = GetRawBlockCodecInfo(nXBlockOff, nYBlockOff);
+    if( papszOwnCodecInfo == nullptr )
+    {
+        ReportError( CE_Failure, CPLE_NotSupported,
+                     "WriteRawBlock() not supported for this dataset." );
+        return CE_Failure;
+    }
+    const bool bCompatible =
+        GDALRawBlockCodecInfoEqual(papszOwnCodecInfo, papszCodecInfo);
+    CSLDestroy(papszOwnCodecInfo);
+    if( !bCompatible )
+    {
+        ReportError( CE_Failure, CPLE_NotSupported,
+                     "WriteRawBlock(): the codec information of the block "
+                     "does not match the one of the band." );
+        return CE_Failure;
+    }
+
+    const bool bCallLeaveReadWrite = CPL_TO_BOOL(EnterReadWrite(GF_Write));
+    const CPLErr eErr =
+        IWriteRawBlock( nXBlockOff, nYBlockOff, pData, nDataSize );
+    if( bCallLeaveReadWrite ) LeaveReadWrite();
+
+    return eErr;
+}
+
+/************************************************************************/
+/*                         GDALWriteRawBlock()                          */
+/************************************************************************/
+
+/**
+ * \brief Write the stored bytes of a block, without encoding them.
+ *
+ * @see GDALRasterBand::WriteRawBlock()
+ * @since GDAL 3.1
+ */
+
+CPLErr GDALWriteRawBlock( GDALRasterBandH hBand, int nXBlockOff, int nYBlockOff,
+                          const void* pData, size_t nDataSize,
+                          CSLConstList papszCodecInfo )
+{
+    VALIDATE_POINTER1( hBand, "GDALWriteRawBlock", CE_Failure );
+
+    GDALRasterBand *poBand = GDALRasterBand::FromHandle(hBand);
+    return poBand->WriteRawBlock( nXBlockOff, nYBlockOff, pData, nDataSize,
+                                  papszCodecInfo );
+}
+
+/************************************************************************/
+/*                           IReadRawBlock()                            */
+/************************************************************************/
+
+/**
+ * \fn GDALRasterBand::IReadRawBlock(int, int, void**, size_t*)
+ * Read the stored bytes of a block.
+ *
+ * To be overridden by subclasses that override GetRawBlockCodecInfo().
+ * @param nXBlockOff Block X Offset
+ * @param nYBlockOff Block Y Offset
+ * @param ppData Set to a buffer allocated with VSIMalloc(), or NULL
+ * @param pnDataSize Set to the size of *ppData
+ * @return CE_None on success or CE_Failure on an error.
+ */
+
+CPLErr GDALRasterBand::IReadRawBlock( int /* nXBlockOff */,
+                                      int /* nYBlockOff */,
+                                      void** /* ppData */,
+                                      size_t* /* pnDataSize */ )
+{
+    ReportError( CE_Failure, CPLE_NotSupported,
+                 "ReadRawBlock() not supported for this dataset." );
+    return CE_Failure;
+}
+
+/************************************************************************/
+/*                           IWriteRawBlock()                           */
+/************************************************************************/
+
+/**
+ * \fn GDALRasterBand::IWriteRawBlock(int, int, const void*, size_t)
+ * Write the stored bytes of a block.
+ *
+ * To be overridden by subclasses that override GetRawBlockCodecInfo().
+ * @param nXBlockOff Block X Offset
+ * @param nYBlockOff Block Y Offset
+ * @param pData Block bytes
+ * @param nDataSize Size of pData
+ * @return CE_None on success or CE_Failure on an error.
+ */
+
+CPLErr GDALRasterBand::IWriteRawBlock( int /* nXBlockOff */,
+                                       int /* nYBlockOff */,
+                                       const void* /* pData */,
+                                       size_t /* nDataSize */ )
+{
+    ReportError( CE_Failure, CPLE_NotSupported,
+                 "WriteRawBlock() not supported for this dataset." );
+    return CE_Failure;
+}
+
 /************************************************************************/
 /*                        GDALGetDataCoverageStatus()                   */
 /************************************************************************/
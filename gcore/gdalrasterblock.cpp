@@ -173,6 +173,8 @@ void CPL_STDCALL GDALSetCacheMax64( GIntBig nNewSizeInBytes )
         if( nCacheUsed == nOldCacheUsed )
             break;
     }
+
+    GDALMDArrayChunkCacheTrim(nCacheMax - nCacheUsed);
 }
 
 /************************************************************************/
@@ -950,6 +952,10 @@ CPLErr GDALRasterBlock::Internalize()
     // No risk of overflow as it is checked in GDALRasterBand::InitBlockInfo().
     const auto nSizeInBytes = GetBlockSize();
 
+    // The multidimensional array chunk cache yields its memory first.
+    GDALMDArrayChunkCacheTrim(nCurCacheMax - nCacheUsed -
+                              GetEffectiveBlockSize(nSizeInBytes));
+
 /* -------------------------------------------------------------------- */
 /*      Flush old blocks if we are nearing our memory limit.            */
 /* -------------------------------------------------------------------- */
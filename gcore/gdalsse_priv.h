@@ -165,6 +165,13 @@ class XMMReg2Double
         return reg;
     }
 
+    static inline XMMReg2Double Load2Val(const int* ptr)
+    {
+        XMMReg2Double reg;
+        reg.nsLoad2Val(ptr);
+        return reg;
+    }
+
     static inline XMMReg2Double Equals(const XMMReg2Double& expr1, const XMMReg2Double& expr2)
     {
         XMMReg2Double reg;
@@ -207,6 +214,13 @@ class XMMReg2Double
         return reg;
     }
 
+    static inline XMMReg2Double Max(const XMMReg2Double& expr1, const XMMReg2Double& expr2)
+    {
+        XMMReg2Double reg;
+        reg.xmm = _mm_max_pd(expr1.xmm, expr2.xmm);
+        return reg;
+    }
+
     inline void nsLoad1ValHighAndLow(const double* ptr)
     {
         xmm =  _mm_load1_pd(ptr);
@@ -262,6 +276,11 @@ class XMMReg2Double
         xmm = _mm_cvtepi32_pd(xmm_i);
     }
 
+    inline void nsLoad2Val(const int* ptr)
+    {
+        xmm = _mm_cvtepi32_pd(GDALCopyInt64ToXMM(ptr));
+    }
+
     static inline void Load4Val(const unsigned char* ptr, XMMReg2Double& low, XMMReg2Double& high)
     {
         __m128i xmm_i = GDALCopyInt32ToXMM(ptr);
@@ -527,6 +546,14 @@ class XMMReg2Double
         return reg;
     }
 
+    static inline XMMReg2Double Max(const XMMReg2Double& expr1, const XMMReg2Double& expr2)
+    {
+        XMMReg2Double reg;
+        reg.low = (expr1.low > expr2.low) ? expr1.low : expr2.low;
+        reg.high = (expr1.high > expr2.high) ? expr1.high : expr2.high;
+        return reg;
+    }
+
     static inline XMMReg2Double Load2Val(const double* ptr)
     {
         XMMReg2Double reg;
@@ -569,6 +596,13 @@ class XMMReg2Double
         return reg;
     }
 
+    static inline XMMReg2Double Load2Val(const int* ptr)
+    {
+        XMMReg2Double reg;
+        reg.nsLoad2Val(ptr);
+        return reg;
+    }
+
     inline void nsLoad1ValHighAndLow(const double* ptr)
     {
         low = ptr[0];
@@ -611,6 +645,12 @@ class XMMReg2Double
         high = ptr[1];
     }
 
+    inline void nsLoad2Val(const int* ptr)
+    {
+        low = ptr[0];
+        high = ptr[1];
+    }
+
     static inline void Load4Val(const unsigned char* ptr, XMMReg2Double& low, XMMReg2Double& high)
     {
         low.low = ptr[0];
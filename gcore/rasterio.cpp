@@ -40,12 +40,18 @@
 #include <cstring>
 
 #include <algorithm>
+#include <condition_variable>
+#include <deque>
 #include <limits>
+#include <mutex>
+#include <new>
 #include <stdexcept>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_cpu_features.h"
 #include "cpl_error.h"
+#include "cpl_multiproc.h"
 #include "cpl_progress.h"
 #include "cpl_string.h"
 #include "cpl_vsi.h"
@@ -772,6 +778,130 @@ CPLErr GDALRasterBand::IRasterIO( GDALRWFlag eRWFlag,
     return eErr;
 }
 
+/************************************************************************/
+/*                         ReadFromDirectView()                         */
+/************************************************************************/
+
+//! @cond Doxygen_Suppress
+/**
+ * Nearest neighbour read of a window from a view of the band values, as
+ * returned by GetDirectReadPointer(), without going through the block
+ * cache. The source locations are computed as in the general case of
+ * IRasterIO().
+ */
+CPLErr GDALRasterBand::ReadFromDirectView( const void *pView,
+                                           GSpacing nViewPixelSpace,
+                                           GSpacing nViewLineSpace,
+                                           int nXOff, int nYOff,
+                                           int nXSize, int nYSize,
+                                           void * pData,
+                                           int nBufXSize, int nBufYSize,
+                                           GDALDataType eBufType,
+                                           GSpacing nPixelSpace,
+                                           GSpacing nLineSpace,
+                                           GDALRasterIOExtraArg* psExtraArg )
+{
+    const GByte *pabyView = static_cast<const GByte *>(pView);
+    GByte *pabyData = static_cast<GByte *>(pData);
+
+    if( nXSize == nBufXSize && nYSize == nBufYSize )
+    {
+        for( int iBufYOff = 0; iBufYOff < nBufYSize; iBufYOff++ )
+        {
+            GDALCopyWords(
+                pabyView + (nYOff + iBufYOff) * nViewLineSpace +
+                    nXOff * nViewPixelSpace,
+                eDataType, static_cast<int>(nViewPixelSpace),
+                pabyData + iBufYOff * nLineSpace,
+                eBufType, static_cast<int>(nPixelSpace), nBufXSize );
+
+            if( psExtraArg->pfnProgress != nullptr &&
+                !psExtraArg->pfnProgress(1.0 * (iBufYOff + 1) / nBufYSize, "",
+                                         psExtraArg->pProgressData) )
+            {
+                return CE_Failure;
+            }
+        }
+        return CE_None;
+    }
+
+    double dfXOff = nXOff;
+    double dfYOff = nYOff;
+    double dfXSize = nXSize;
+    double dfYSize = nYSize;
+    if( psExtraArg->bFloatingPointWindowValidity )
+    {
+        dfXOff = psExtraArg->dfXOff;
+        dfYOff = psExtraArg->dfYOff;
+        dfXSize = psExtraArg->dfXSize;
+        dfYSize = psExtraArg->dfYSize;
+    }
+
+    const double dfSrcXInc = dfXSize / static_cast<double>( nBufXSize );
+    const double dfSrcYInc = dfYSize / static_cast<double>( nBufYSize );
+    const double EPS = 1e-10;
+    const int nBandDataSize = GDALGetDataTypeSizeBytes( eDataType );
+
+    // Offsets in the view of the source pixels of a buffer line.
+    std::vector<GPtrDiff_t> anSrcXOffsets;
+    try
+    {
+        anSrcXOffsets.resize(nBufXSize);
+    }
+    catch( const std::bad_alloc& )
+    {
+        ReportError(CE_Failure, CPLE_OutOfMemory, "Out of memory");
+        return CE_Failure;
+    }
+    double dfSrcX = 0.5 * dfSrcXInc + dfXOff + EPS;
+    for( int iBufXOff = 0; iBufXOff < nBufXSize;
+         iBufXOff++, dfSrcX += dfSrcXInc )
+    {
+        const int iSrcX = static_cast<int>(std::min(std::max(0.0, dfSrcX),
+                                    static_cast<double>(nRasterXSize - 1)));
+        anSrcXOffsets[iBufXOff] = iSrcX * nViewPixelSpace;
+    }
+
+    for( int iBufYOff = 0; iBufYOff < nBufYSize; iBufYOff++ )
+    {
+        const double dfSrcY = (iBufYOff+0.5) * dfSrcYInc + dfYOff + EPS;
+        const int iSrcY = static_cast<int>(std::min(std::max(0.0, dfSrcY),
+                                    static_cast<double>(nRasterYSize - 1)));
+        const GByte *pabySrcLine = pabyView + iSrcY * nViewLineSpace;
+        GByte *pabyDstLine = pabyData + iBufYOff * nLineSpace;
+
+        if( eBufType == eDataType )
+        {
+            for( int iBufXOff = 0; iBufXOff < nBufXSize; iBufXOff++ )
+            {
+                memcpy( pabyDstLine + iBufXOff * nPixelSpace,
+                        pabySrcLine + anSrcXOffsets[iBufXOff],
+                        nBandDataSize );
+            }
+        }
+        else
+        {
+            for( int iBufXOff = 0; iBufXOff < nBufXSize; iBufXOff++ )
+            {
+                GDALCopyWords( pabySrcLine + anSrcXOffsets[iBufXOff],
+                               eDataType, 0,
+                               pabyDstLine + iBufXOff * nPixelSpace,
+                               eBufType, 0, 1 );
+            }
+        }
+
+        if( psExtraArg->pfnProgress != nullptr &&
+            !psExtraArg->pfnProgress(1.0 * (iBufYOff + 1) / nBufYSize, "",
+                                     psExtraArg->pProgressData) )
+        {
+            return CE_Failure;
+        }
+    }
+
+    return CE_None;
+}
+//! @endcond
+
 /************************************************************************/
 /*                         GDALRasterIOTransformer()                    */
 /************************************************************************/
@@ -4354,6 +4484,493 @@ static void GDALCopyWholeRasterGetSwathSize(
     *pnSwathLines = nSwathLines;
 }
 
+/************************************************************************/
+/*                 GDALCopyWholeRasterCanStreamBlocks()                 */
+/************************************************************************/
+
+// Whether GDALCopyWholeRasterStreamBlocks() can be used: band interleaved
+// source and destination, with the same block size for all their bands.
+static bool GDALCopyWholeRasterCanStreamBlocks( GDALDataset* poSrcDS,
+                                                GDALDataset* poDstDS )
+{
+    if( !CPLTestBool(CPLGetConfigOption(
+                        "GDAL_COPY_WHOLE_RASTER_STREAMING", "YES")) )
+        return false;
+
+    // Reading blocks directly would miss blocks modified in the block cache.
+    if( poSrcDS->GetAccess() != GA_ReadOnly ||
+        poDstDS->GetAccess() != GA_Update )
+        return false;
+
+    int nBlockXSize = 0;
+    int nBlockYSize = 0;
+    poDstDS->GetRasterBand(1)->GetBlockSize(&nBlockXSize, &nBlockYSize);
+    if( nBlockXSize == poDstDS->GetRasterXSize() && nBlockYSize == 1 )
+        return false;
+
+    for( int iBand = 1; iBand <= poDstDS->GetRasterCount(); iBand++ )
+    {
+        for( GDALDataset* poDS: { poSrcDS, poDstDS } )
+        {
+            int nThisBlockXSize = 0;
+            int nThisBlockYSize = 0;
+            poDS->GetRasterBand(iBand)->GetBlockSize(&nThisBlockXSize,
+                                                     &nThisBlockYSize);
+            if( nThisBlockXSize != nBlockXSize ||
+                nThisBlockYSize != nBlockYSize )
+                return false;
+        }
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                   GDALCopyWholeRasterStreamBlocks()                  */
+/************************************************************************/
+
+namespace {
+struct GDALCopyWholeRasterStreamState
+{
+    GDALDataset*            poSrcDS = nullptr;
+    GDALDataset*            poDstDS = nullptr;
+    size_t                  nBlockPixels = 0;
+    std::vector<std::vector<GByte>> aabyBuffers{};
+    std::vector<int>        anFreeBuffers{};
+
+    struct Item
+    {
+        int nBand;
+        int nXBlock;
+        int nYBlock;
+        int iBuffer;
+    };
+
+    // Error raised by the writer thread, emitted again by the calling one.
+    struct Error
+    {
+        CPLErr      eErr;
+        CPLErrorNum nNum;
+        CPLString   osMsg;
+    };
+
+    std::mutex              oMutex{};
+    std::condition_variable oCV{};
+    std::deque<Item>        aoQueue{};
+    bool                    bNoMoreItems = false;
+    CPLErr                  eWriteErr = CE_None;
+    std::vector<Error>      aoErrors{};
+};
+} // namespace
+
+static void CPL_STDCALL GDALCopyWholeRasterWriterErrorHandler(
+    CPLErr eErr, CPLErrorNum nNum, const char* pszMsg )
+{
+    GDALCopyWholeRasterStreamState* psState =
+        static_cast<GDALCopyWholeRasterStreamState*>(
+            CPLGetErrorHandlerUserData());
+    std::lock_guard<std::mutex> oLock(psState->oMutex);
+    psState->aoErrors.push_back(
+        GDALCopyWholeRasterStreamState::Error{eErr, nNum, pszMsg});
+}
+
+// Emits in the calling thread the errors raised by the writer thread so far.
+static void GDALCopyWholeRasterEmitWriterErrors(
+    GDALCopyWholeRasterStreamState& sState )
+{
+    std::vector<GDALCopyWholeRasterStreamState::Error> aoErrors;
+    {
+        std::lock_guard<std::mutex> oLock(sState.oMutex);
+        std::swap(aoErrors, sState.aoErrors);
+    }
+    for( const auto& oError : aoErrors )
+        CPLError(oError.eErr, oError.nNum, "%s", oError.osMsg.c_str());
+}
+
+// Writes the blocks queued by GDALCopyWholeRasterStreamBlocks(), converting
+// them to the destination data type if needed.
+static void GDALCopyWholeRasterWriterThread( void* pData )
+{
+    GDALCopyWholeRasterStreamState* psState =
+        static_cast<GDALCopyWholeRasterStreamState*>(pData);
+    std::vector<GByte> abyConverted;
+
+    CPLPushErrorHandlerEx(GDALCopyWholeRasterWriterErrorHandler, psState);
+    while( true )
+    {
+        GDALCopyWholeRasterStreamState::Item sItem;
+        {
+            std::unique_lock<std::mutex> oLock(psState->oMutex);
+            psState->oCV.wait(oLock, [psState]
+                { return !psState->aoQueue.empty() || psState->bNoMoreItems; });
+            if( psState->aoQueue.empty() )
+                break;
+            sItem = psState->aoQueue.front();
+            psState->aoQueue.pop_front();
+        }
+
+        CPLErr eErr;
+        {
+            std::lock_guard<std::mutex> oLock(psState->oMutex);
+            eErr = psState->eWriteErr;
+        }
+        if( eErr == CE_None )
+        {
+            GDALRasterBand* poSrcBand = psState->poSrcDS->GetRasterBand(sItem.nBand);
+            GDALRasterBand* poDstBand = psState->poDstDS->GetRasterBand(sItem.nBand);
+            const GDALDataType eSrcDT = poSrcBand->GetRasterDataType();
+            const GDALDataType eDstDT = poDstBand->GetRasterDataType();
+            void* pBlock = psState->aabyBuffers[sItem.iBuffer].data();
+            if( eSrcDT != eDstDT )
+            {
+                const int nDstDTSize = GDALGetDataTypeSizeBytes(eDstDT);
+                abyConverted.resize(psState->nBlockPixels * nDstDTSize);
+                GDALCopyWords64(pBlock, eSrcDT, GDALGetDataTypeSizeBytes(eSrcDT),
+                                abyConverted.data(), eDstDT, nDstDTSize,
+                                psState->nBlockPixels);
+                pBlock = abyConverted.data();
+            }
+            eErr = poDstBand->WriteBlock(sItem.nXBlock, sItem.nYBlock, pBlock);
+        }
+
+        {
+            std::lock_guard<std::mutex> oLock(psState->oMutex);
+            if( eErr != CE_None )
+                psState->eWriteErr = eErr;
+            psState->anFreeBuffers.push_back(sItem.iBuffer);
+        }
+        psState->oCV.notify_all();
+    }
+    CPLPopErrorHandler();
+}
+
+// Copies a raster block by block, when the source and the destination have
+// the same block layout. Blocks bypass the block cache: they are read with
+// ReadBlock() by the calling thread, and passed through a bounded queue to a
+// writer thread that encodes them with WriteBlock(). Blocks are copied band
+// after band, or, if bInterleave, block after block.
+static CPLErr GDALCopyWholeRasterStreamBlocks( GDALDataset* poSrcDS,
+                                               GDALDataset* poDstDS,
+                                               bool bInterleave,
+                                               bool bCheckHoles,
+                                               GDALProgressFunc pfnProgress,
+                                               void *pProgressData )
+{
+    const int nXSize = poDstDS->GetRasterXSize();
+    const int nYSize = poDstDS->GetRasterYSize();
+    const int nBandCount = poDstDS->GetRasterCount();
+    int nBlockXSize = 0;
+    int nBlockYSize = 0;
+    poDstDS->GetRasterBand(1)->GetBlockSize(&nBlockXSize, &nBlockYSize);
+    const int nXBlocks = DIV_ROUND_UP(nXSize, nBlockXSize);
+    const int nYBlocks = DIV_ROUND_UP(nYSize, nBlockYSize);
+
+    GDALCopyWholeRasterStreamState sState;
+    sState.poSrcDS = poSrcDS;
+    sState.poDstDS = poDstDS;
+    sState.nBlockPixels = static_cast<size_t>(nBlockXSize) * nBlockYSize;
+
+    int nMaxDTSize = 0;
+    for( int iBand = 1; iBand <= nBandCount; iBand++ )
+    {
+        nMaxDTSize = std::max(nMaxDTSize, GDALGetDataTypeSizeBytes(
+            poSrcDS->GetRasterBand(iBand)->GetRasterDataType()));
+    }
+    const GIntBig nBlockBytes =
+        static_cast<GIntBig>(sState.nBlockPixels) * nMaxDTSize;
+
+    // As the swath path, use up to 1/4 of the cache size for the queue.
+    const int nBuffers = static_cast<int>(std::max(GIntBig(2),
+        std::min(GIntBig(64), GDALGetCacheMax64() / 4 / nBlockBytes)));
+    try
+    {
+        sState.aabyBuffers.resize(nBuffers);
+        for( int i = 0; i < nBuffers; i++ )
+        {
+            sState.aabyBuffers[i].resize(static_cast<size_t>(nBlockBytes));
+            sState.anFreeBuffers.push_back(i);
+        }
+    }
+    catch( const std::exception& )
+    {
+        CPLError(CE_Failure, CPLE_OutOfMemory,
+                 "Cannot allocate streaming buffers");
+        return CE_Failure;
+    }
+
+    CPLDebug("GDAL",
+             "GDALDatasetCopyWholeRaster(): streaming %dx%d blocks "
+             "through %d buffers",
+             nBlockXSize, nBlockYSize, nBuffers);
+
+    // Make sure that no dirty block of the destination is flushed afterwards
+    // over the streamed ones.
+    poDstDS->FlushCache();
+
+    CPLJoinableThread* hWriterThread =
+        CPLCreateJoinableThread(GDALCopyWholeRasterWriterThread, &sState);
+    if( hWriterThread == nullptr )
+        return CE_Failure;
+
+    const GIntBig nTotalBlocks =
+        static_cast<GIntBig>(nBandCount) * nXBlocks * nYBlocks;
+    GIntBig nBlocksDone = 0;
+    CPLErr eErr = CE_None;
+
+    const GIntBig nBlocksPerBand = static_cast<GIntBig>(nXBlocks) * nYBlocks;
+    for( GIntBig iItem = 0; iItem < nTotalBlocks && eErr == CE_None; iItem++ )
+    {
+        // In the interleaved case, all the bands of a block are written
+        // before moving to the next block, so that a pixel interleaved
+        // destination encodes each of its blocks once.
+        int iBand;
+        GIntBig nBlock;
+        if( bInterleave )
+        {
+            iBand = static_cast<int>(iItem % nBandCount) + 1;
+            nBlock = iItem / nBandCount;
+        }
+        else
+        {
+            iBand = static_cast<int>(iItem / nBlocksPerBand) + 1;
+            nBlock = iItem % nBlocksPerBand;
+        }
+        const int iXBlock = static_cast<int>(nBlock % nXBlocks);
+        const int iYBlock = static_cast<int>(nBlock / nXBlocks);
+        GDALRasterBand* poSrcBand = poSrcDS->GetRasterBand(iBand);
+
+        nBlocksDone++;
+        bool bHole = false;
+        if( bCheckHoles )
+        {
+            const int nXOff = iXBlock * nBlockXSize;
+            const int nYOff = iYBlock * nBlockYSize;
+            const int nStatus = poSrcBand->GetDataCoverageStatus(
+                nXOff, nYOff,
+                std::min(nBlockXSize, nXSize - nXOff),
+                std::min(nBlockYSize, nYSize - nYOff),
+                GDAL_DATA_COVERAGE_STATUS_DATA);
+            bHole = !(nStatus & GDAL_DATA_COVERAGE_STATUS_DATA);
+        }
+
+        if( !bHole )
+        {
+            int iBuffer = -1;
+            {
+                std::unique_lock<std::mutex> oLock(sState.oMutex);
+                sState.oCV.wait(oLock, [&sState]
+                    { return !sState.anFreeBuffers.empty() ||
+                             sState.eWriteErr != CE_None; });
+                if( sState.eWriteErr != CE_None )
+                {
+                    eErr = sState.eWriteErr;
+                    break;
+                }
+                iBuffer = sState.anFreeBuffers.back();
+                sState.anFreeBuffers.pop_back();
+            }
+
+            eErr = poSrcBand->ReadBlock(iXBlock, iYBlock,
+                                        sState.aabyBuffers[iBuffer].data());
+            {
+                std::lock_guard<std::mutex> oLock(sState.oMutex);
+                if( eErr == CE_None )
+                    sState.aoQueue.push_back(
+                        GDALCopyWholeRasterStreamState::Item{
+                            iBand, iXBlock, iYBlock, iBuffer});
+                else
+                    sState.anFreeBuffers.push_back(iBuffer);
+            }
+            sState.oCV.notify_all();
+        }
+
+        GDALCopyWholeRasterEmitWriterErrors(sState);
+
+        if( eErr == CE_None &&
+            !pfnProgress(
+                nBlocksDone / static_cast<double>(nTotalBlocks),
+                nullptr, pProgressData ) )
+        {
+            eErr = CE_Failure;
+            CPLError( CE_Failure, CPLE_UserInterrupt,
+                      "User terminated CreateCopy()" );
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> oLock(sState.oMutex);
+        sState.bNoMoreItems = true;
+    }
+    sState.oCV.notify_all();
+    CPLJoinThread(hWriterThread);
+    GDALCopyWholeRasterEmitWriterErrors(sState);
+
+    if( eErr == CE_None )
+        eErr = sState.eWriteErr;
+    if( eErr == CE_None )
+        pfnProgress(1.0, nullptr, pProgressData);
+    return eErr;
+}
+
+/************************************************************************/
+/*                 GDALCopyWholeRasterCanCopyRawBlocks()                */
+/************************************************************************/
+
+// Whether the blocks of the source can be copied without decoding them,
+// i.e. they are stored the same way as in the destination. Only the first
+// block is checked here, to choose the copy method:
+// GDALCopyWholeRasterCopyRawBlocks() compares the codec information of
+// every block it reads with the one of the destination block, and copies
+// the blocks that differ through ReadBlock() / WriteBlock().
+static bool GDALCopyWholeRasterCanCopyRawBlocks( GDALDataset* poSrcDS,
+                                                 GDALDataset* poDstDS )
+{
+    const int nBandCount = poDstDS->GetRasterCount();
+    for( int iBand = 1; iBand <= nBandCount; iBand++ )
+    {
+        char** papszSrcInfo =
+            poSrcDS->GetRasterBand(iBand)->GetRawBlockCodecInfo(0, 0);
+        char** papszDstInfo =
+            poDstDS->GetRasterBand(iBand)->GetRawBlockCodecInfo(0, 0);
+        const bool bSame =
+            GDALRawBlockCodecInfoEqual(papszSrcInfo, papszDstInfo);
+        const bool bPixelInterleaved = EQUAL(
+            CSLFetchNameValueDef(papszSrcInfo, "INTERLEAVE", ""), "PIXEL");
+        CSLDestroy(papszSrcInfo);
+        CSLDestroy(papszDstInfo);
+        if( !bSame )
+            return false;
+        // The first band holds the blocks of all bands.
+        if( bPixelInterleaved )
+            break;
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                  GDALCopyWholeRasterCopyRawBlocks()                  */
+/************************************************************************/
+
+// Copies the stored bytes of the blocks, without decoding and encoding them.
+// Blocks whose storage would still differ (e.g. a last strip of a different
+// height) are copied through ReadBlock() / WriteBlock().
+static CPLErr GDALCopyWholeRasterCopyRawBlocks( GDALDataset* poSrcDS,
+                                                GDALDataset* poDstDS,
+                                                GDALProgressFunc pfnProgress,
+                                                void *pProgressData )
+{
+    const int nXSize = poDstDS->GetRasterXSize();
+    const int nYSize = poDstDS->GetRasterYSize();
+    int nBlockXSize = 0;
+    int nBlockYSize = 0;
+    poDstDS->GetRasterBand(1)->GetBlockSize(&nBlockXSize, &nBlockYSize);
+    const int nXBlocks = DIV_ROUND_UP(nXSize, nBlockXSize);
+    const int nYBlocks = DIV_ROUND_UP(nYSize, nBlockYSize);
+
+    char** papszInfo = poSrcDS->GetRasterBand(1)->GetRawBlockCodecInfo(0, 0);
+    const bool bPixelInterleaved =
+        EQUAL(CSLFetchNameValueDef(papszInfo, "INTERLEAVE", ""), "PIXEL");
+    CSLDestroy(papszInfo);
+    const int nBandCount = bPixelInterleaved ? 1 : poDstDS->GetRasterCount();
+
+    CPLDebug("GDAL",
+             "GDALDatasetCopyWholeRaster(): copying raw %dx%d blocks",
+             nBlockXSize, nBlockYSize);
+
+    poDstDS->FlushCache();
+
+    std::vector<GByte> abyBlock;
+    const GIntBig nTotalBlocks =
+        static_cast<GIntBig>(nBandCount) * nXBlocks * nYBlocks;
+    GIntBig nBlocksDone = 0;
+    CPLErr eErr = CE_None;
+    for( int iBand = 1; iBand <= nBandCount && eErr == CE_None; iBand++ )
+    {
+        GDALRasterBand* poSrcBand = poSrcDS->GetRasterBand(iBand);
+        GDALRasterBand* poDstBand = poDstDS->GetRasterBand(iBand);
+        for( int iYBlock = 0; iYBlock < nYBlocks && eErr == CE_None; iYBlock++ )
+        {
+            for( int iXBlock = 0;
+                 iXBlock < nXBlocks && eErr == CE_None;
+                 iXBlock++ )
+            {
+                void* pData = nullptr;
+                size_t nDataSize = 0;
+                char** papszCodecInfo = nullptr;
+                eErr = poSrcBand->ReadRawBlock(iXBlock, iYBlock,
+                                               &pData, &nDataSize,
+                                               &papszCodecInfo);
+                if( eErr == CE_None && nDataSize != 0 )
+                {
+                    char** papszDstInfo =
+                        poDstBand->GetRawBlockCodecInfo(iXBlock, iYBlock);
+                    const bool bSame =
+                        GDALRawBlockCodecInfoEqual(papszDstInfo,
+                                                   papszCodecInfo);
+                    CSLDestroy(papszDstInfo);
+
+                    if( bSame )
+                    {
+                        eErr = poDstBand->WriteRawBlock(iXBlock, iYBlock,
+                                                        pData, nDataSize,
+                                                        papszCodecInfo);
+                    }
+                    else
+                    {
+                        const int nFirstBand = bPixelInterleaved ? 1 : iBand;
+                        const int nLastBand = bPixelInterleaved ?
+                                poDstDS->GetRasterCount() : iBand;
+                        for( int i = nFirstBand;
+                             i <= nLastBand && eErr == CE_None; i++ )
+                        {
+                            GDALRasterBand* poSrc = poSrcDS->GetRasterBand(i);
+                            GDALRasterBand* poDst = poDstDS->GetRasterBand(i);
+                            const GDALDataType eDT =
+                                poDst->GetRasterDataType();
+                            const int nDTSize = GDALGetDataTypeSizeBytes(eDT);
+                            try
+                            {
+                                abyBlock.resize(static_cast<size_t>(
+                                    nBlockXSize) * nBlockYSize * nDTSize);
+                            }
+                            catch( const std::exception& )
+                            {
+                                CPLError(CE_Failure, CPLE_OutOfMemory,
+                                         "Out of memory in "
+                                         "GDALDatasetCopyWholeRaster()");
+                                eErr = CE_Failure;
+                                break;
+                            }
+                            // Same data type, as checked with DATA_TYPE.
+                            eErr = poSrc->ReadBlock(iXBlock, iYBlock,
+                                                    abyBlock.data());
+                            if( eErr == CE_None )
+                                eErr = poDst->WriteBlock(iXBlock, iYBlock,
+                                                         abyBlock.data());
+                        }
+                    }
+                }
+                VSIFree(pData);
+                CSLDestroy(papszCodecInfo);
+
+                nBlocksDone++;
+                if( eErr == CE_None &&
+                    !pfnProgress(
+                        nBlocksDone / static_cast<double>(nTotalBlocks),
+                        nullptr, pProgressData ) )
+                {
+                    eErr = CE_Failure;
+                    CPLError( CE_Failure, CPLE_UserInterrupt,
+                              "User terminated CreateCopy()" );
+                }
+            }
+        }
+    }
+
+    if( eErr == CE_None )
+        pfnProgress(1.0, nullptr, pProgressData);
+    return eErr;
+}
+
 /************************************************************************/
 /*                     GDALDatasetCopyWholeRaster()                     */
 /************************************************************************/
@@ -4381,6 +4998,17 @@ static void GDALCopyWholeRasterGetSwathSize(
  * </ul>
  * More options may be supported in the future.
  *
+ * When the source and destination store their blocks the same way (see
+ * GDALRasterBand::GetRawBlockCodecInfo()), the stored bytes of the blocks are
+ * copied without being decoded and encoded again (GDAL &gt;= 3.1).
+ *
+ * When all source and destination bands share the same block size, blocks
+ * are streamed from the source to the destination without going through the
+ * block cache, reading on the calling thread while a second thread writes
+ * (GDAL &gt;= 3.1). In the pixel interleaved case, all the bands of a block
+ * are copied before the next block. Both can be disabled
+ * by setting the GDAL_COPY_WHOLE_RASTER_STREAMING configuration option to NO.
+ *
  * @param hSrcDS the source dataset
  * @param hDstDS the destination dataset
  * @param papszOptions transfer hints in "StringList" Name=Value format.
@@ -4442,6 +5070,17 @@ CPLErr CPL_STDCALL GDALDatasetCopyWholeRaster(
     GDALRasterBand *poDstPrototypeBand = poDstDS->GetRasterBand(1);
     GDALDataType eDT = poDstPrototypeBand->GetRasterDataType();
 
+/* -------------------------------------------------------------------- */
+/*      Copy the stored bytes of the blocks when the source and         */
+/*      destination store them the same way.                            */
+/* -------------------------------------------------------------------- */
+    if( GDALCopyWholeRasterCanStreamBlocks(poSrcDS, poDstDS) &&
+        GDALCopyWholeRasterCanCopyRawBlocks(poSrcDS, poDstDS) )
+    {
+        return GDALCopyWholeRasterCopyRawBlocks( poSrcDS, poDstDS,
+                                                 pfnProgress, pProgressData );
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Do we want to try and do the operation in a pixel               */
 /*      interleaved fashion?                                            */
@@ -4474,6 +5113,20 @@ CPLErr CPL_STDCALL GDALDatasetCopyWholeRaster(
     if (pszDstCompressed != nullptr && CPLTestBool(pszDstCompressed))
         bDstIsCompressed = true;
 
+    const bool bCheckHoles = CPLTestBool( CSLFetchNameValueDef(
+                                        papszOptions, "SKIP_HOLES", "NO" ) );
+
+/* -------------------------------------------------------------------- */
+/*      Stream the blocks, without going through the block cache,       */
+/*      when the source and destination have the same block layout.     */
+/* -------------------------------------------------------------------- */
+    if( GDALCopyWholeRasterCanStreamBlocks(poSrcDS, poDstDS) )
+    {
+        return GDALCopyWholeRasterStreamBlocks( poSrcDS, poDstDS, bInterleave,
+                                                bCheckHoles,
+                                                pfnProgress, pProgressData );
+    }
+
 /* -------------------------------------------------------------------- */
 /*      What will our swath size be?                                    */
 /* -------------------------------------------------------------------- */
@@ -4510,8 +5163,6 @@ CPLErr CPL_STDCALL GDALDatasetCopyWholeRaster(
 /*      Band oriented (uninterleaved) case.                             */
 /* ==================================================================== */
     CPLErr eErr = CE_None;
-    const bool bCheckHoles = CPLTestBool( CSLFetchNameValueDef(
-                                        papszOptions, "SKIP_HOLES", "NO" ) );
 
     if( !bInterleave )
     {
@@ -302,6 +302,9 @@ RawRasterBand::~RawRasterBand()
 
     RawRasterBand::FlushCache();
 
+    if( m_poDirectReadView )
+        CPLVirtualMemFree(m_poDirectReadView);
+
     if (bOwnsFP)
     {
         if( VSIFCloseL(fpRawL) != 0 )
@@ -729,6 +732,27 @@ int RawRasterBand::CanUseDirectIO(int /* nXOff */,
     return CPLTestBool(pszGDAL_ONE_BIG_READ);
 }
 
+/************************************************************************/
+/*                        CanUseDirectReadView()                        */
+/************************************************************************/
+
+// Whether a read request can be served from the memory mapping returned
+// by GetDirectReadPointer(), which saves the copy from the file to the
+// line buffer or the block cache.
+bool RawRasterBand::CanUseDirectReadView(GDALRWFlag eRWFlag,
+                                         GDALRasterIOExtraArg* psExtraArg)
+{
+    if( eRWFlag != GF_Read ||
+        psExtraArg->eResampleAlg != GRIORA_NearestNeighbour ||
+        !CPLTestBool(CPLGetConfigOption("GDAL_RAW_USE_MMAP", "YES")) )
+    {
+        return false;
+    }
+    GSpacing nViewPixelSpace = 0;
+    GSpacing nViewLineSpace = 0;
+    return GetDirectReadPointer(&nViewPixelSpace, &nViewLineSpace) != nullptr;
+}
+
 /************************************************************************/
 /*                             IRasterIO()                              */
 /************************************************************************/
@@ -750,6 +774,31 @@ CPLErr RawRasterBand::IRasterIO( GDALRWFlag eRWFlag,
 #endif
     const int nBufDataSize = GDALGetDataTypeSizeBytes(eBufType);
 
+    if( CanUseDirectReadView(eRWFlag, psExtraArg) )
+    {
+        // Do we have overviews that are appropriate to satisfy this request?
+        if( (nBufXSize < nXSize || nBufYSize < nYSize)
+            && GetOverviewCount() > 0 )
+        {
+            int bTried = FALSE;
+            const CPLErr eErr = TryOverviewRasterIO(
+                eRWFlag, nXOff, nYOff, nXSize, nYSize,
+                pData, nBufXSize, nBufYSize, eBufType,
+                nPixelSpace, nLineSpace, psExtraArg, &bTried );
+            if( bTried )
+                return eErr;
+        }
+
+        GSpacing nViewPixelSpace = 0;
+        GSpacing nViewLineSpace = 0;
+        const void *pView =
+            GetDirectReadPointer(&nViewPixelSpace, &nViewLineSpace);
+        return ReadFromDirectView(pView, nViewPixelSpace, nViewLineSpace,
+                                  nXOff, nYOff, nXSize, nYSize,
+                                  pData, nBufXSize, nBufYSize, eBufType,
+                                  nPixelSpace, nLineSpace, psExtraArg);
+    }
+
     if( !CanUseDirectIO(nXOff, nYOff, nXSize, nYSize, eBufType, psExtraArg) )
     {
         return GDALRasterBand::IRasterIO(eRWFlag, nXOff, nYOff,
@@ -1226,6 +1275,60 @@ CPLVirtualMem  *RawRasterBand::GetVirtualMemAuto( GDALRWFlag eRWFlag,
     return pVMem;
 }
 
+/************************************************************************/
+/*                        GetDirectReadPointer()                        */
+/************************************************************************/
+
+const void *RawRasterBand::GetDirectReadPointer( GSpacing *pnPixelSpace,
+                                                 GSpacing *pnLineSpace )
+{
+    if( !m_bDirectReadViewTried )
+    {
+        m_bDirectReadViewTried = true;
+
+        // The mapping is only valid as long as the file is not modified
+        // through fpRawL, hence the read-only restriction.
+        if( eAccess != GA_ReadOnly ||
+            pLineBuffer == nullptr ||
+            VSIFGetNativeFileDescriptorL(fpRawL) == nullptr ||
+            !CPLIsVirtualMemFileMapAvailable() ||
+            NeedsByteOrderChange() ||
+            nPixelOffset < 0 ||
+            nLineOffset < 0 )
+        {
+            return nullptr;
+        }
+
+        const vsi_l_offset nSize =
+            static_cast<vsi_l_offset>(nRasterYSize - 1) * nLineOffset +
+            static_cast<vsi_l_offset>(nRasterXSize - 1) * nPixelOffset +
+            GDALGetDataTypeSizeBytes(eDataType);
+        if( static_cast<vsi_l_offset>(static_cast<size_t>(nSize)) != nSize )
+            return nullptr;
+#if SIZEOF_VOIDP == 4
+        // Do not exhaust the address space of 32-bit processes
+        if( nSize > 256 * 1024 * 1024 )
+            return nullptr;
+#endif
+
+        // Truncated files are refused by CPLVirtualMemFileMapNew() and go
+        // through the regular code path, so do not emit its error.
+        CPLPushErrorHandler(CPLQuietErrorHandler);
+        m_poDirectReadView = CPLVirtualMemFileMapNew(
+            fpRawL, nImgOffset, nSize, VIRTUALMEM_READONLY, nullptr, nullptr);
+        CPLPopErrorHandler();
+        if( m_poDirectReadView == nullptr )
+            CPLErrorReset();
+    }
+
+    if( m_poDirectReadView == nullptr )
+        return nullptr;
+
+    *pnPixelSpace = nPixelOffset;
+    *pnLineSpace = nLineOffset;
+    return CPLVirtualMemGetAddr(m_poDirectReadView);
+}
+
 /************************************************************************/
 /* ==================================================================== */
 /*      RawDataset                                                      */
@@ -1265,9 +1368,9 @@ CPLErr RawDataset::IRasterIO( GDALRWFlag eRWFlag,
 
     // The default GDALDataset::IRasterIO() implementation would go to
     // BlockBasedRasterIO if the dataset is interleaved. However if the
-    // access pattern is compatible with DirectIO() we don't want to go
-    // BlockBasedRasterIO, but rather used our optimized path in
-    // RawRasterBand::IRasterIO().
+    // access pattern is compatible with DirectIO() or with the memory
+    // mapped view we don't want to go BlockBasedRasterIO, but rather used our
+    // optimized path in RawRasterBand::IRasterIO().
     if (nXSize == nBufXSize && nYSize == nBufYSize && nBandCount > 1 &&
         (pszInterleave = GetMetadataItem("INTERLEAVE",
                                          "IMAGE_STRUCTURE")) != nullptr &&
@@ -1279,8 +1382,10 @@ CPLErr RawDataset::IRasterIO( GDALRWFlag eRWFlag,
             RawRasterBand *poBand = dynamic_cast<RawRasterBand *>(
                 GetRasterBand(panBandMap[iBandIndex]));
             if( poBand == nullptr ||
-                !poBand->CanUseDirectIO(nXOff, nYOff,
-                                        nXSize, nYSize, eBufType, psExtraArg) )
+                (!poBand->CanUseDirectReadView(eRWFlag, psExtraArg) &&
+                 !poBand->CanUseDirectIO(nXOff, nYOff,
+                                         nXSize, nYSize, eBufType,
+                                         psExtraArg)) )
             {
                 break;
             }
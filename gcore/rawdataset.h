@@ -111,6 +111,9 @@ protected:
 
     int         bOwnsFP{};
 
+    CPLVirtualMem *m_poDirectReadView = nullptr;
+    bool        m_bDirectReadViewTried = false;
+
     int         Seek( vsi_l_offset, int );
     size_t      Read( void *, size_t, size_t );
     size_t      Write( void *, size_t, size_t );
@@ -129,6 +132,9 @@ protected:
                                GDALDataType eBufType,
                                GDALRasterIOExtraArg* psExtraArg);
 
+    bool        CanUseDirectReadView(GDALRWFlag eRWFlag,
+                                     GDALRasterIOExtraArg* psExtraArg);
+
 public:
 
     enum class OwnFP
@@ -185,6 +191,9 @@ public:
                                       GIntBig *pnLineSpace,
                                       char **papszOptions ) override;
 
+    const void *GetDirectReadPointer( GSpacing *pnPixelSpace,
+                                      GSpacing *pnLineSpace ) override;
+
     CPLErr          AccessLine( int iLine );
 
     void            SetAccess( GDALAccess eAccess );
@@ -226,6 +226,7 @@ void OSRProjTLSCache::clear()
 {
     m_oCacheEPSG.clear();
     m_oCacheWKT.clear();
+    m_oCacheCT.clear();
 }
 
 PJ* OSRProjTLSCache::GetPJForEPSGCode(int nCode, bool bUseNonDeprecated, bool bAddTOWGS84)
@@ -268,6 +269,24 @@ void OSRProjTLSCache::CachePJForWKT(const std::string& wkt, PJ* pj)
                     proj_clone(OSRGetProjTLSContext(), pj), OSRPJDeleter()));
 }
 
+// Contrary to the above methods, the returned object is not a clone: it is
+// shared by all the users of the coordinate operation in the current thread.
+std::shared_ptr<PJ> OSRProjTLSCache::GetPJForCoordinateOperation(GUIntBig nId)
+{
+    std::shared_ptr<PJ> cached;
+    if( m_oCacheCT.tryGet(nId, cached) )
+        return cached;
+    return nullptr;
+}
+
+// Takes ownership of pj.
+std::shared_ptr<PJ> OSRProjTLSCache::CachePJForCoordinateOperation(GUIntBig nId, PJ* pj)
+{
+    std::shared_ptr<PJ> cached(pj, OSRPJDeleter());
+    m_oCacheCT.insert(nId, cached);
+    return cached;
+}
+
 /************************************************************************/
 /*                         OSRCleanupTLSContext()                       */
 /************************************************************************/
@@ -295,6 +314,20 @@ void OSRSetPROJSearchPaths( const char* const * papszPaths )
     g_aosSearchpaths.Assign(CSLDuplicate(papszPaths), true);
 }
 
+/*! @cond Doxygen_Suppress */
+
+/************************************************************************/
+/*                OSRGetPROJSearchPathsGenerationCounter()              */
+/************************************************************************/
+
+unsigned OSRGetPROJSearchPathsGenerationCounter()
+{
+    std::lock_guard<std::mutex> oLock(g_oSearchPathMutex);
+    return g_searchPathGenerationCounter;
+}
+
+/*! @endcond */
+
 /************************************************************************/
 /*                        OSRGetPROJSearchPaths()                       */
 /************************************************************************/
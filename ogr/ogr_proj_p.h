@@ -31,6 +31,7 @@
 
 #include "proj.h"
 
+#include "cpl_port.h"
 #include "cpl_mem_cache.h"
 
 #include <unordered_map>
@@ -41,6 +42,7 @@
 
 PJ_CONTEXT* OSRGetProjTLSContext();
 void OSRCleanupTLSContext();
+unsigned OSRGetPROJSearchPathsGenerationCounter();
 
 class OSRProjTLSCache
 {
@@ -78,6 +80,9 @@ class OSRProjTLSCache
                             std::shared_ptr<PJ>>>::iterator,
                             EPSGCacheKeyHasher>> m_oCacheEPSG{};
         lru11::Cache<std::string, std::shared_ptr<PJ>> m_oCacheWKT{};
+        // Coordinate operations instantiated for this thread, keyed by
+        // a process-wide unique identifier of their definition.
+        lru11::Cache<GUIntBig, std::shared_ptr<PJ>> m_oCacheCT{256, 32};
 
     public:
         OSRProjTLSCache() = default;
@@ -89,6 +94,9 @@ class OSRProjTLSCache
 
         PJ* GetPJForWKT(const std::string& wkt);
         void CachePJForWKT(const std::string& wkt, PJ* pj);
+
+        std::shared_ptr<PJ> GetPJForCoordinateOperation(GUIntBig nId);
+        std::shared_ptr<PJ> CachePJForCoordinateOperation(GUIntBig nId, PJ* pj);
 };
 
 OSRProjTLSCache* OSRGetProjTLSCache();
@@ -31,14 +31,19 @@
 #include "ogr_spatialref.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cmath>
 #include <cstring>
 #include <limits>
 #include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
+#include "cpl_mem_cache.h"
 #include "cpl_string.h"
 #include "ogr_core.h"
 #include "ogr_srs_api.h"
@@ -321,23 +326,15 @@ class OGRProjCT : public OGRCoordinateTransformation
 
     bool        bWebMercatorToWGS84LongLat = false;
 
-    int         nErrorCount = 0;
+    std::atomic<int> nErrorCount{0};
 
     bool        bCheckWithInvertProj = false;
     double      dfThreshold = 0.0;
 
-    PJ*         m_pj = nullptr;
-    bool        m_bReversePj = false;
-
-    int         nMaxCount = 0;
-    double     *padfOriX = nullptr;
-    double     *padfOriY = nullptr;
-    double     *padfOriZ = nullptr;
-    double     *padfOriT = nullptr;
-    double     *padfTargetX = nullptr;
-    double     *padfTargetY = nullptr;
-    double     *padfTargetZ = nullptr;
-    double     *padfTargetT = nullptr;
+    // Captured at initialization, since querying them on the
+    // OGRSpatialReference objects is not thread-safe.
+    OGRAxisOrientation m_eSourceFirstAxisOrient = OAO_Other;
+    OGRAxisOrientation m_eTargetFirstAxisOrient = OAO_Other;
 
     bool        m_bEmitErrors = true;
 
@@ -355,58 +352,70 @@ class OGRProjCT : public OGRCoordinateTransformation
     Strategy    m_eStrategy = Strategy::BEST_ACCURACY;
 #endif
 
-    bool        ListCoordinateOperations(const char* pszSrcSRS,
-                                         const char* pszTargetSRS,
-                                         const OGRCoordinateTransformationOptions& options );
-
     struct Transformation
     {
         double minx = 0.0;
         double miny = 0.0;
         double maxx = 0.0;
         double maxy = 0.0;
-        PJ* pj = nullptr;
+        GUIntBig nPJId = 0;
         CPLString osName{};
         CPLString osProjString{};
         double accuracy = 0.0;
 
         Transformation(double minxIn, double minyIn, double maxxIn, double maxyIn,
-                       PJ* pjIn,
+                       GUIntBig nPJIdIn,
                        const CPLString& osNameIn,
                        const CPLString& osProjStringIn,
                        double accuracyIn):
             minx(minxIn), miny(minyIn), maxx(maxxIn), maxy(maxyIn),
-            pj(pjIn), osName(osNameIn), osProjString(osProjStringIn),
+            nPJId(nPJIdIn), osName(osNameIn), osProjString(osProjStringIn),
             accuracy(accuracyIn) {}
+    };
 
-        Transformation(const Transformation&) = delete;
-        Transformation(Transformation&& other):
-            minx(other.minx), miny(other.miny), maxx(other.maxx), maxy(other.maxy),
-            pj(other.pj), osName(std::move(other.osName)),
-            osProjString(std::move(other.osProjString)),
-            accuracy(other.accuracy)
-        {
-            other.pj = nullptr;
-        }
-        Transformation& operator=(const Transformation&) = delete;
-
-        ~Transformation()
-        {
-            if( pj )
-            {
-                proj_assign_context(pj, OSRGetProjTLSContext());
-                proj_destroy(pj);
-            }
-        }
+    // Result of the research of the coordinate operations, which can be
+    // costly. It only contains the definitions of the operations, and is
+    // immutable once built, so that it can be shared between clones and
+    // between objects created with the same parameters, from any thread.
+    // The PJ objects are instantiated lazily in each thread that uses them,
+    // with the PROJ context of that thread, and cached by OSRProjTLSCache
+    // under the identifier of their definition.
+    struct Operations
+    {
+        // Identifier of the operation to use, or 0 if it must be
+        // dynamically selected among aoTransformations.
+        GUIntBig nPJId = 0;
+        // If set, the operation is instantiated with
+        // proj_create_crs_to_crs(osPJDef, osTargetSRS), otherwise with
+        // proj_create(osPJDef).
+        bool bCRSToCRS = false;
+        CPLString osPJDef{};
+        CPLString osTargetSRS{};
+        bool bHasAreaOfInterest = false;
+        double dfWestLongitudeDeg = 0.0;
+        double dfSouthLatitudeDeg = 0.0;
+        double dfEastLongitudeDeg = 0.0;
+        double dfNorthLatitudeDeg = 0.0;
+        bool bReversePj = false;
+        std::vector<Transformation> aoTransformations{};
     };
-    std::vector<Transformation> m_oTransformations{};
-    int m_iCurTransformation = -1;
+    std::shared_ptr<const Operations> m_poOperations{};
+    std::atomic<int> m_iCurTransformation{-1};
     OGRCoordinateTransformationOptions m_options{};
 
-    OGRProjCT(const OGRProjCT& other)
-    {
-        Initialize(other.poSRSSource, other.poSRSTarget, other.m_options);
-    }
+    typedef lru11::Cache<std::string, std::shared_ptr<const Operations>,
+                         std::mutex> OperationsCache;
+    static OperationsCache& GetOperationsCache();
+    static GUIntBig GetNewPJId();
+
+    std::shared_ptr<PJ> GetPJ(int iTransformation) const;
+
+    bool        ListCoordinateOperations(const char* pszSrcSRS,
+                                         const char* pszTargetSRS,
+                                         const OGRCoordinateTransformationOptions& options,
+                                         Operations& oOperations );
+
+    OGRProjCT(const OGRProjCT& other);
     OGRProjCT& operator= (const OGRProjCT& ) = delete;
 
 public:
@@ -560,6 +569,12 @@ OGRCreateCoordinateTransformation( const OGRSpatialReference *poSource,
  * reseached, and at each call to Transform(), the best of those candidate
  * regarding the centroid of the coordinate set will be dynamically selected.
  *
+ * The research of the coordinate operations is cached, so that creating
+ * several transformation objects with the same parameters, or cloning them,
+ * is cheap. Transform() may be called concurrently from several threads on
+ * the same object: the PROJ objects are lazily instantiated once per thread,
+ * with the PROJ context of that thread.
+ *
  * @param poSource source spatial reference system.
  * @param poTarget target spatial reference system.
  * @param options Coordinate transformation options.
@@ -682,6 +697,34 @@ OGRProjCT::OGRProjCT()
 {
 }
 
+/************************************************************************/
+/*                  OGRProjCT(const OGRProjCT& other)                   */
+/************************************************************************/
+
+// Cheap: the coordinate operations are shared with the other object,
+// instead of being researched again.
+OGRProjCT::OGRProjCT(const OGRProjCT& other) :
+    OGRCoordinateTransformation(),
+    poSRSSource(other.poSRSSource ? other.poSRSSource->Clone() : nullptr),
+    bSourceLatLong(other.bSourceLatLong),
+    bSourceWrap(other.bSourceWrap),
+    dfSourceWrapLong(other.dfSourceWrapLong),
+    poSRSTarget(other.poSRSTarget ? other.poSRSTarget->Clone() : nullptr),
+    bTargetLatLong(other.bTargetLatLong),
+    bTargetWrap(other.bTargetWrap),
+    dfTargetWrapLong(other.dfTargetWrapLong),
+    bWebMercatorToWGS84LongLat(other.bWebMercatorToWGS84LongLat),
+    bCheckWithInvertProj(other.bCheckWithInvertProj),
+    dfThreshold(other.dfThreshold),
+    m_eSourceFirstAxisOrient(other.m_eSourceFirstAxisOrient),
+    m_eTargetFirstAxisOrient(other.m_eTargetFirstAxisOrient),
+    bNoTransform(other.bNoTransform),
+    m_eStrategy(other.m_eStrategy),
+    m_poOperations(other.m_poOperations),
+    m_options(other.m_options)
+{
+}
+
 /************************************************************************/
 /*                            ~OGRProjCT()                             */
 /************************************************************************/
@@ -698,21 +741,83 @@ OGRProjCT::~OGRProjCT()
     {
         poSRSTarget->Release();
     }
+}
+
+/************************************************************************/
+/*                             GetNewPJId()                             */
+/************************************************************************/
 
-    if( m_pj )
+GUIntBig OGRProjCT::GetNewPJId()
+{
+    static std::atomic<GUIntBig> nLastId{0};
+    return ++nLastId;
+}
+
+/************************************************************************/
+/*                         GetOperationsCache()                         */
+/************************************************************************/
+
+// Process-wide cache of the coordinate operations researched by
+// Initialize(), keyed by the source and target CRS and the parameters
+// that influence the research.
+OGRProjCT::OperationsCache& OGRProjCT::GetOperationsCache()
+{
+    static OperationsCache oCache;
+    return oCache;
+}
+
+/************************************************************************/
+/*                                GetPJ()                               */
+/************************************************************************/
+
+// Returns the PJ object, bound to the PROJ context of the current thread,
+// of the operation to use (iTransformation < 0) or of one of the candidate
+// operations.
+std::shared_ptr<PJ> OGRProjCT::GetPJ(int iTransformation) const
+{
+    const GUIntBig nId = iTransformation < 0 ? m_poOperations->nPJId :
+        m_poOperations->aoTransformations[iTransformation].nPJId;
+    auto poCache = OSRGetProjTLSCache();
+    auto pj = poCache->GetPJForCoordinateOperation(nId);
+    if( pj )
+        return pj;
+
+    auto ctx = OSRGetProjTLSContext();
+    PJ* pjNew = nullptr;
+    if( iTransformation >= 0 )
     {
-        proj_assign_context(m_pj, OSRGetProjTLSContext());
-        proj_destroy(m_pj);
-    }
-
-    CPLFree(padfOriX);
-    CPLFree(padfOriY);
-    CPLFree(padfOriZ);
-    CPLFree(padfOriT);
-    CPLFree(padfTargetX);
-    CPLFree(padfTargetY);
-    CPLFree(padfTargetZ);
-    CPLFree(padfTargetT);
+        const auto& osProjString =
+            m_poOperations->aoTransformations[iTransformation].osProjString;
+        /* Null transform ? */
+        pjNew = proj_create(ctx, osProjString.empty() ? "proj=affine" :
+                                                        osProjString.c_str());
+    }
+    else if( m_poOperations->bCRSToCRS )
+    {
+        PJ_AREA* area = nullptr;
+        if( m_poOperations->bHasAreaOfInterest )
+        {
+            area = proj_area_create();
+            proj_area_set_bbox(area,
+                m_poOperations->dfWestLongitudeDeg,
+                m_poOperations->dfSouthLatitudeDeg,
+                m_poOperations->dfEastLongitudeDeg,
+                m_poOperations->dfNorthLatitudeDeg);
+        }
+        pjNew = proj_create_crs_to_crs(ctx,
+                                       m_poOperations->osPJDef,
+                                       m_poOperations->osTargetSRS,
+                                       area);
+        if( area )
+            proj_area_destroy(area);
+    }
+    else
+    {
+        pjNew = proj_create(ctx, m_poOperations->osPJDef);
+    }
+    if( !pjNew )
+        return nullptr;
+    return poCache->CachePJForCoordinateOperation(nId, pjNew);
 }
 
 /************************************************************************/
@@ -747,9 +852,15 @@ int OGRProjCT::Initialize( const OGRSpatialReference * poSourceIn,
     }
 
     if( poSRSSource )
+    {
         bSourceLatLong = CPL_TO_BOOL(poSRSSource->IsGeographic());
+        poSRSSource->GetAxis(nullptr, 0, &m_eSourceFirstAxisOrient);
+    }
     if( poSRSTarget )
+    {
         bTargetLatLong = CPL_TO_BOOL(poSRSTarget->IsGeographic());
+        poSRSTarget->GetAxis(nullptr, 0, &m_eTargetFirstAxisOrient);
+    }
 
 /* -------------------------------------------------------------------- */
 /*      Setup source and target translations to radians for lat/long    */
@@ -933,21 +1044,34 @@ int OGRProjCT::Initialize( const OGRSpatialReference * poSourceIn,
 
     if( !options.d->osCoordOperation.empty() )
     {
-        auto ctx = OSRGetProjTLSContext();
-        m_pj = proj_create(ctx, options.d->osCoordOperation);
-        if( !m_pj )
+        // Share the PJ objects between the transformations using the
+        // same pipeline.
+        std::string osKey("pipeline|");
+        osKey += options.d->bReverseCO ? "reverse|" : "|";
+        osKey += options.d->osCoordOperation;
+        if( !GetOperationsCache().tryGet(osKey, m_poOperations) )
         {
-            CPLError( CE_Failure, CPLE_NotSupported,
-                      "Cannot instantiate pipeline %s",
-                      options.d->osCoordOperation.c_str() );
-            return FALSE;
-        }
-        m_bReversePj = options.d->bReverseCO;
+            auto poOperations = std::make_shared<Operations>();
+            poOperations->nPJId = GetNewPJId();
+            poOperations->osPJDef = options.d->osCoordOperation;
+            poOperations->bReversePj = options.d->bReverseCO;
+            m_poOperations = poOperations;
+            auto pj = GetPJ(-1);
+            if( !pj )
+            {
+                CPLError( CE_Failure, CPLE_NotSupported,
+                          "Cannot instantiate pipeline %s",
+                          options.d->osCoordOperation.c_str() );
+                m_poOperations.reset();
+                return FALSE;
+            }
+            GetOperationsCache().insert(osKey, m_poOperations);
 #ifdef DEBUG
-        auto info = proj_pj_info(m_pj);
-        CPLDebug("OGRCT", "%s %s(user set)", info.definition,
-                 m_bReversePj ? "(reversed) " : "");
+            auto info = proj_pj_info(pj.get());
+            CPLDebug("OGRCT", "%s %s(user set)", info.definition,
+                     options.d->bReverseCO ? "(reversed) " : "");
 #endif
+        }
     }
     else if( !bWebMercatorToWGS84LongLat && poSRSSource && poSRSTarget )
     {
@@ -1033,23 +1157,59 @@ int OGRProjCT::Initialize( const OGRSpatialReference * poSourceIn,
         CPLDebug("OGR_CT", "Target CRS: '%s'", pszTargetSRS);
 #endif
 
-        if( m_eStrategy == Strategy::PROJ )
+        // The research of the coordinate operations only depends on the
+        // CRS definitions, the area of interest, the selection strategy,
+        // a few configuration options and the available grids.
+        std::string osKey(CPLSPrintf("%d|%u|%s|%s|",
+            static_cast<int>(m_eStrategy),
+            OSRGetPROJSearchPathsGenerationCounter(),
+            CPLGetConfigOption("OSR_USE_APPROX_TMERC", ""),
+            CPLGetConfigOption("OSR_USE_ETMERC", "")));
+        if( options.d->bHasAreaOfInterest )
+        {
+            osKey += CPLSPrintf("%.17g,%.17g,%.17g,%.17g",
+                                options.d->dfWestLongitudeDeg,
+                                options.d->dfSouthLatitudeDeg,
+                                options.d->dfEastLongitudeDeg,
+                                options.d->dfNorthLatitudeDeg);
+        }
+        osKey += '|';
+        osKey += pszSrcSRS;
+        osKey += '|';
+        osKey += pszTargetSRS;
+
+        if( !GetOperationsCache().tryGet(osKey, m_poOperations) )
         {
-            PJ_AREA* area = nullptr;
-            if( options.d->bHasAreaOfInterest )
+            auto poOperations = std::make_shared<Operations>();
+            bool bOK;
+            if( m_eStrategy == Strategy::PROJ )
             {
-                area = proj_area_create();
-                proj_area_set_bbox(area,
-                    options.d->dfWestLongitudeDeg,
-                    options.d->dfSouthLatitudeDeg,
-                    options.d->dfEastLongitudeDeg,
-                    options.d->dfNorthLatitudeDeg);
+                poOperations->nPJId = GetNewPJId();
+                poOperations->bCRSToCRS = true;
+                poOperations->osPJDef = pszSrcSRS;
+                poOperations->osTargetSRS = pszTargetSRS;
+                if( options.d->bHasAreaOfInterest )
+                {
+                    poOperations->bHasAreaOfInterest = true;
+                    poOperations->dfWestLongitudeDeg =
+                        options.d->dfWestLongitudeDeg;
+                    poOperations->dfSouthLatitudeDeg =
+                        options.d->dfSouthLatitudeDeg;
+                    poOperations->dfEastLongitudeDeg =
+                        options.d->dfEastLongitudeDeg;
+                    poOperations->dfNorthLatitudeDeg =
+                        options.d->dfNorthLatitudeDeg;
+                }
+                m_poOperations = poOperations;
+                bOK = GetPJ(-1) != nullptr;
+            }
+            else
+            {
+                bOK = ListCoordinateOperations(pszSrcSRS, pszTargetSRS,
+                                               options, *poOperations);
+                m_poOperations = poOperations;
             }
-            auto ctx = OSRGetProjTLSContext();
-            m_pj = proj_create_crs_to_crs(ctx, pszSrcSRS, pszTargetSRS, area);
-            if( area )
-                proj_area_destroy(area);
-            if( m_pj == nullptr )
+            if( !bOK )
             {
                 CPLError( CE_Failure, CPLE_NotSupported,
                             "Cannot find coordinate operations from `%s' to `%s'",
@@ -1057,25 +1217,22 @@ int OGRProjCT::Initialize( const OGRSpatialReference * poSourceIn,
                             pszTargetSRS );
                 CPLFree( pszSrcSRS );
                 CPLFree( pszTargetSRS );
+                m_poOperations.reset();
                 return FALSE;
             }
-
-        }
-        else if( !ListCoordinateOperations(pszSrcSRS, pszTargetSRS, options) )
-        {
-            CPLError( CE_Failure, CPLE_NotSupported,
-                        "Cannot find coordinate operations from `%s' to `%s'",
-                        pszSrcSRS,
-                        pszTargetSRS );
-            CPLFree( pszSrcSRS );
-            CPLFree( pszTargetSRS );
-            return FALSE;
+            GetOperationsCache().insert(osKey, m_poOperations);
         }
 
         CPLFree(pszSrcSRS);
         CPLFree(pszTargetSRS);
     }
 
+    if( !m_poOperations )
+    {
+        // No PROJ operation needed, or none available.
+        m_poOperations = std::make_shared<Operations>();
+    }
+
     if( options.d->osCoordOperation.empty() && poSRSSource && poSRSTarget )
     {
         // Determine if we can skip the transformation completely.
@@ -1141,7 +1298,8 @@ static PJ* op_to_pj(PJ_CONTEXT* ctx, PJ* op, CPLString* osOutProjString = nullpt
 
 bool OGRProjCT::ListCoordinateOperations(const char* pszSrcSRS,
                                          const char* pszTargetSRS,
-                                         const OGRCoordinateTransformationOptions& options )
+                                         const OGRCoordinateTransformationOptions& options,
+                                         Operations& oOperations )
 {
     auto ctx = OSRGetProjTLSContext();
 
@@ -1205,7 +1363,8 @@ bool OGRProjCT::ListCoordinateOperations(const char* pszSrcSRS,
         proj_get_type(dst) == PJ_TYPE_GEOCENTRIC_CRS ) {
         auto op = proj_list_get(ctx, op_list, 0);
         CPLAssert(op);
-        m_pj = op_to_pj(ctx, op);
+        CPLString osProjString;
+        auto pj = op_to_pj(ctx, op, &osProjString);
         CPLString osName;
         auto name = proj_get_name(op);
         if( name )
@@ -1215,12 +1374,17 @@ bool OGRProjCT::ListCoordinateOperations(const char* pszSrcSRS,
         proj_operation_factory_context_destroy(operation_ctx);
         proj_destroy(src);
         proj_destroy(dst);
-        if( !m_pj )
+        if( !pj )
             return false;
 #ifdef DEBUG
-        auto info = proj_pj_info(m_pj);
+        auto info = proj_pj_info(pj);
         CPLDebug("OGRCT", "%s (%s)", info.definition, osName.c_str());
 #endif
+        oOperations.nPJId = GetNewPJId();
+        oOperations.osPJDef =
+            osProjString.empty() ? "proj=affine" : osProjString.c_str();
+        OSRGetProjTLSCache()->CachePJForCoordinateOperation(
+                                                    oOperations.nPJId, pj);
         return true;
     }
 
@@ -1295,7 +1459,7 @@ bool OGRProjCT::ListCoordinateOperations(const char* pszSrcSRS,
         return false;
     }
 
-    const auto addTransformation = [=](PJ* op,
+    const auto addTransformation = [=, &oOperations](PJ* op,
                                        double west_lon, double south_lat,
                                        double east_lon, double north_lat) {
         double minx = -std::numeric_limits<double>::max();
@@ -1354,8 +1518,11 @@ bool OGRProjCT::ListCoordinateOperations(const char* pszSrcSRS,
             op = nullptr;
             if( pj )
             {
-                m_oTransformations.emplace_back(
-                    minx, miny, maxx, maxy, pj, osName, osProjString, accuracy);
+                const GUIntBig nPJId = GetNewPJId();
+                OSRGetProjTLSCache()->CachePJForCoordinateOperation(nPJId, pj);
+                oOperations.aoTransformations.emplace_back(
+                    minx, miny, maxx, maxy, nPJId, osName, osProjString,
+                    accuracy);
             }
         }
         return op;
@@ -1443,7 +1610,7 @@ bool OGRProjCT::ListCoordinateOperations(const char* pszSrcSRS,
     proj_destroy(src);
     proj_destroy(dst);
     proj_destroy(pjGeogToSrc);
-    return !m_oTransformations.empty();
+    return !oOperations.aoTransformations.empty();
 }
 
 /************************************************************************/
@@ -1560,10 +1727,7 @@ int OGRProjCT::Transform( int nCount, double *x, double *y, double *z,
 /* -------------------------------------------------------------------- */
     if( bSourceLatLong && bSourceWrap )
     {
-        OGRAxisOrientation orientation;
-        assert( poSRSSource );
-        poSRSSource->GetAxis(nullptr, 0, &orientation);
-        if( orientation == OAO_East )
+        if( m_eSourceFirstAxisOrient == OAO_East )
         {
             for( int i = 0; i < nCount; i++ )
             {
@@ -1601,9 +1765,7 @@ int OGRProjCT::Transform( int nCount, double *x, double *y, double *z,
 
         if( poSRSSource )
         {
-            OGRAxisOrientation orientation;
-            poSRSSource->GetAxis(nullptr, 0, &orientation);
-            if( orientation != OAO_East )
+            if( m_eSourceFirstAxisOrient != OAO_East )
             {
                 for( int i = 0; i < nCount; i++ )
                 {
@@ -1677,9 +1839,7 @@ int OGRProjCT::Transform( int nCount, double *x, double *y, double *z,
 
         if( poSRSTarget )
         {
-            OGRAxisOrientation orientation;
-            poSRSTarget->GetAxis(nullptr, 0, &orientation);
-            if( orientation != OAO_East )
+            if( m_eTargetFirstAxisOrient != OAO_East )
             {
                 for( int i = 0; i < nCount; i++ )
                 {
@@ -1697,8 +1857,13 @@ int OGRProjCT::Transform( int nCount, double *x, double *y, double *z,
 /* -------------------------------------------------------------------- */
 
     auto ctx = OSRGetProjTLSContext();
-    auto pj = m_pj;
-    if( !bTransformDone && !pj )
+    const bool bReversePj = m_poOperations->bReversePj;
+    std::shared_ptr<PJ> pj;
+    if( !bTransformDone && m_poOperations->nPJId != 0 )
+    {
+        pj = GetPJ(-1);
+    }
+    else if( !bTransformDone )
     {
         double avgX = 0.0;
         double avgY = 0.0;
@@ -1721,7 +1886,8 @@ int OGRProjCT::Transform( int nCount, double *x, double *y, double *z,
         constexpr int N_MAX_RETRY = 2;
         int iExcluded[N_MAX_RETRY] = {-1, -1};
 
-        const int nOperations = static_cast<int>(m_oTransformations.size());
+        const auto& aoTransformations = m_poOperations->aoTransformations;
+        const int nOperations = static_cast<int>(aoTransformations.size());
         PJ_COORD coord;
         coord.xyzt.x = avgX;
         coord.xyzt.y = avgY;
@@ -1746,7 +1912,7 @@ int OGRProjCT::Transform( int nCount, double *x, double *y, double *z,
                 {
                     continue;
                 }
-                const auto& transf = m_oTransformations[i];
+                const auto& transf = aoTransformations[i];
                 if( avgX >= transf.minx && avgX <= transf.maxx &&
                     avgY >= transf.miny && avgY <= transf.maxy &&
                     (iBestTransf < 0 || (transf.accuracy >= 0 &&
@@ -1762,22 +1928,25 @@ int OGRProjCT::Transform( int nCount, double *x, double *y, double *z,
             {
                 break;
             }
-            const auto& transf = m_oTransformations[iBestTransf];
-            pj = transf.pj;
-            proj_assign_context( pj, ctx );
-            if( iBestTransf != m_iCurTransformation )
+            const auto& transf = aoTransformations[iBestTransf];
+            pj = GetPJ(iBestTransf);
+            if( pj )
             {
-                CPLDebug("OGRCT", "Selecting transformation %s (%s)",
-                        transf.osProjString.c_str(),
-                        transf.osName.c_str());
-                m_iCurTransformation = iBestTransf;
-            }
+                proj_assign_context( pj.get(), ctx );
+                if( m_iCurTransformation.exchange(iBestTransf) != iBestTransf )
+                {
+                    CPLDebug("OGRCT", "Selecting transformation %s (%s)",
+                            transf.osProjString.c_str(),
+                            transf.osName.c_str());
+                }
 
-            auto res = proj_trans(pj, m_bReversePj ? PJ_INV : PJ_FWD, coord);
-            if( res.xyzt.x != HUGE_VAL ) {
-                break;
+                auto res = proj_trans(pj.get(), bReversePj ? PJ_INV : PJ_FWD,
+                                      coord);
+                if( res.xyzt.x != HUGE_VAL ) {
+                    break;
+                }
+                pj.reset();
             }
-            pj = nullptr;
             CPLDebug("OGRCT", 
                      "Did not result in valid result. "
                      "Attempting a retry with another operation.");
@@ -1794,49 +1963,51 @@ int OGRProjCT::Transform( int nCount, double *x, double *y, double *z,
             // use the first operation that does not require grids.
             for( int i = 0; i < nOperations; i++ )
             {
-                const auto& transf = m_oTransformations[i];
-                if( proj_coordoperation_get_grid_used_count(ctx, transf.pj) == 0 )
+                const auto& transf = aoTransformations[i];
+                auto pjTransf = GetPJ(i);
+                if( pjTransf &&
+                    proj_coordoperation_get_grid_used_count(
+                                            ctx, pjTransf.get()) == 0 )
                 {
-                    pj = transf.pj;
-                    proj_assign_context( pj, ctx );
-                    if( i != m_iCurTransformation )
+                    pj = pjTransf;
+                    if( m_iCurTransformation.exchange(i) != i )
                     {
                         CPLDebug("OGRCT", "Selecting transformation %s (%s)",
                                 transf.osProjString.c_str(),
                                 transf.osName.c_str());
-                        m_iCurTransformation = i;
                     }
                     break;
                 }
             }
         }
+    }
 
-        if( !pj )
+    if( !bTransformDone && !pj )
+    {
+        const int nErrors = m_bEmitErrors ? ++nErrorCount : nErrorCount.load();
+        if( m_bEmitErrors && nErrors < 20 )
         {
-            if( m_bEmitErrors && ++nErrorCount < 20 )
-            {
-                CPLError(CE_Failure, CPLE_AppDefined,
-                        "Cannot find transformation for provided coordinates");
-            }
-            else if( nErrorCount == 20 )
-            {
-                CPLError( CE_Failure, CPLE_AppDefined,
-                        "Reprojection failed, further errors will be "
-                        "suppressed on the transform object.");
-            }
-            for( int i = 0; i < nCount; i++ )
-            {
-                x[i] = HUGE_VAL;
-                y[i] = HUGE_VAL;
-            }
-            if( pabSuccess )
-                memset( pabSuccess, 0, sizeof(int) * nCount );
-            return FALSE;
+            CPLError(CE_Failure, CPLE_AppDefined,
+                    "Cannot find transformation for provided coordinates");
         }
+        else if( nErrors == 20 )
+        {
+            CPLError( CE_Failure, CPLE_AppDefined,
+                    "Reprojection failed, further errors will be "
+                    "suppressed on the transform object.");
+        }
+        for( int i = 0; i < nCount; i++ )
+        {
+            x[i] = HUGE_VAL;
+            y[i] = HUGE_VAL;
+        }
+        if( pabSuccess )
+            memset( pabSuccess, 0, sizeof(int) * nCount );
+        return FALSE;
     }
     if( pj )
     {
-        proj_assign_context( pj, ctx );
+        proj_assign_context( pj.get(), ctx );
     }
 
 /* -------------------------------------------------------------------- */
@@ -1853,38 +2024,11 @@ int OGRProjCT::Transform( int nCount, double *x, double *y, double *z,
         // For some projections, we cannot detect if we are trying to reproject
         // coordinates outside the validity area of the projection. So let's do
         // the reverse reprojection and compare with the source coordinates.
-        if( nCount > nMaxCount )
-        {
-            nMaxCount = nCount;
-            padfOriX = static_cast<double*>(
-                CPLRealloc(padfOriX, sizeof(double) * nCount));
-            padfOriY = static_cast<double*>(
-                CPLRealloc(padfOriY, sizeof(double)*nCount));
-            padfOriZ = static_cast<double*>(
-                CPLRealloc(padfOriZ, sizeof(double)*nCount));
-            padfOriT = static_cast<double*>(
-                CPLRealloc(padfOriT, sizeof(double)*nCount));
-            padfTargetX = static_cast<double*>(
-                CPLRealloc(padfTargetX, sizeof(double)*nCount));
-            padfTargetY = static_cast<double*>(
-                CPLRealloc(padfTargetY, sizeof(double)*nCount));
-            padfTargetZ = static_cast<double*>(
-                CPLRealloc(padfTargetZ, sizeof(double)*nCount));
-            padfTargetT = static_cast<double*>(
-                CPLRealloc(padfTargetT, sizeof(double)*nCount));
-        }
-        memcpy(padfOriX, x, sizeof(double) * nCount);
-        memcpy(padfOriY, y, sizeof(double) * nCount);
-        if( z )
-        {
-            memcpy(padfOriZ, z, sizeof(double)*nCount);
-        }
-        if( t )
-        {
-            memcpy(padfOriT, t, sizeof(double)*nCount);
-        }
+        // Local buffers, so that Transform() can be called concurrently.
+        const std::vector<double> adfOriX(x, x + nCount);
+        const std::vector<double> adfOriY(y, y + nCount);
 
-        size_t nRet = proj_trans_generic (pj, m_bReversePj ? PJ_INV : PJ_FWD,
+        size_t nRet = proj_trans_generic (pj.get(), bReversePj ? PJ_INV : PJ_FWD,
                                 x, sizeof(double), nCount,
                                 y, sizeof(double), nCount,
                                 z, z ? sizeof(double) : 0, z ? nCount : 0,
@@ -1893,22 +2037,20 @@ int OGRProjCT::Transform( int nCount, double *x, double *y, double *z,
                     0 : proj_context_errno(ctx);
         if( err == 0 )
         {
-            memcpy(padfTargetX, x, sizeof(double) * nCount);
-            memcpy(padfTargetY, y, sizeof(double) * nCount);
+            std::vector<double> adfTargetX(x, x + nCount);
+            std::vector<double> adfTargetY(y, y + nCount);
+            std::vector<double> adfTargetZ;
             if( z )
-            {
-                memcpy(padfTargetZ, z, sizeof(double) * nCount);
-            }
+                adfTargetZ.assign(z, z + nCount);
+            std::vector<double> adfTargetT;
             if( t )
-            {
-                memcpy(padfTargetT, t, sizeof(double) * nCount);
-            }
+                adfTargetT.assign(t, t + nCount);
 
-            nRet = proj_trans_generic (pj, m_bReversePj ? PJ_FWD : PJ_INV,
-                padfTargetX, sizeof(double), nCount,
-                padfTargetY, sizeof(double), nCount,
-                z ? padfTargetZ : nullptr, z ? sizeof(double) : 0, z ? nCount : 0,
-                t ? padfTargetT : nullptr, t ? sizeof(double) : 0, t ? nCount : 0);
+            nRet = proj_trans_generic (pj.get(), bReversePj ? PJ_FWD : PJ_INV,
+                adfTargetX.data(), sizeof(double), nCount,
+                adfTargetY.data(), sizeof(double), nCount,
+                z ? adfTargetZ.data() : nullptr, z ? sizeof(double) : 0, z ? nCount : 0,
+                t ? adfTargetT.data() : nullptr, t ? sizeof(double) : 0, t ? nCount : 0);
             err = ( static_cast<int>(nRet) == nCount ) ?
                     0 : proj_context_errno(ctx);
             if( err == 0 )
@@ -1916,8 +2058,8 @@ int OGRProjCT::Transform( int nCount, double *x, double *y, double *z,
                 for( int i = 0; i < nCount; i++ )
                 {
                     if( x[i] != HUGE_VAL && y[i] != HUGE_VAL &&
-                        (fabs(padfTargetX[i] - padfOriX[i]) > dfThreshold ||
-                         fabs(padfTargetY[i] - padfOriY[i]) > dfThreshold) )
+                        (fabs(adfTargetX[i] - adfOriX[i]) > dfThreshold ||
+                         fabs(adfTargetY[i] - adfOriY[i]) > dfThreshold) )
                     {
                         x[i] = HUGE_VAL;
                         y[i] = HUGE_VAL;
@@ -1928,7 +2070,7 @@ int OGRProjCT::Transform( int nCount, double *x, double *y, double *z,
     }
     else
     {
-        size_t nRet = proj_trans_generic (pj, m_bReversePj ? PJ_INV : PJ_FWD,
+        size_t nRet = proj_trans_generic (pj.get(), bReversePj ? PJ_INV : PJ_FWD,
                                 x, sizeof(double), nCount,
                                 y, sizeof(double), nCount,
                                 z, z ? sizeof(double) : 0, z ? nCount : 0,
@@ -1948,7 +2090,8 @@ int OGRProjCT::Transform( int nCount, double *x, double *y, double *z,
         if( pabSuccess )
             memset( pabSuccess, 0, sizeof(int) * nCount );
 
-        if( m_bEmitErrors && ++nErrorCount < 20 )
+        const int nErrors = m_bEmitErrors ? ++nErrorCount : nErrorCount.load();
+        if( m_bEmitErrors && nErrors < 20 )
         {
             const char *pszError = proj_errno_string(err);
             if( pszError == nullptr )
@@ -1958,7 +2101,7 @@ int OGRProjCT::Transform( int nCount, double *x, double *y, double *z,
             else
                 CPLError( CE_Failure, CPLE_AppDefined, "%s", pszError );
         }
-        else if( nErrorCount == 20 )
+        else if( nErrors == 20 )
         {
             CPLError( CE_Failure, CPLE_AppDefined,
                       "Reprojection failed, err = %d, further errors will be "
@@ -1973,10 +2116,7 @@ int OGRProjCT::Transform( int nCount, double *x, double *y, double *z,
 /* -------------------------------------------------------------------- */
     if( bTargetLatLong && bTargetWrap )
     {
-        OGRAxisOrientation orientation;
-        assert( poSRSTarget );
-        poSRSTarget->GetAxis(nullptr, 0, &orientation);
-        if( orientation == OAO_East )
+        if( m_eTargetFirstAxisOrient == OAO_East )
         {
             for( int i = 0; i < nCount; i++ )
             {
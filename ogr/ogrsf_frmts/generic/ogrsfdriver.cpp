@@ -174,7 +174,8 @@ int OGR_Dr_TestCapability( OGRSFDriverH hDriver, const char *pszCap )
     VALIDATE_POINTER1( hDriver, "OGR_Dr_TestCapability", 0 );
     VALIDATE_POINTER1( pszCap, "OGR_Dr_TestCapability", 0 );
 
-    GDALDriver* poDriver = reinterpret_cast<GDALDriver *>(hDriver);
+    GDALDriver* poDriver =
+        reinterpret_cast<GDALDriver *>(hDriver)->GetRealDriver();
     if( EQUAL(pszCap, ODrCCreateDataSource) )
     {
         return poDriver->pfnCreate != nullptr ||
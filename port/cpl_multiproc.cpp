@@ -2296,6 +2296,32 @@ void CPLDestroySpinLock( CPLSpinLock* psSpin )
 
 #endif  // def CPL_MULTIPROC_PTHREAD
 
+/************************************************************************/
+/*                       CPLGetNumThreadsOption()                       */
+/************************************************************************/
+
+/**
+ * \brief Returns the number of worker threads requested by an option.
+ *
+ * @param pszValue value of a NUM_THREADS-like option: a number of threads
+ * or ALL_CPUS. If nullptr, the value of the GDAL_NUM_THREADS configuration
+ * option is used instead.
+ * @param pszDefault value used if pszValue is nullptr and GDAL_NUM_THREADS
+ * is not set. Usually "1".
+ * @return the number of threads, between 1 and 128.
+ * @since GDAL 3.1
+ */
+int CPLGetNumThreadsOption( const char *pszValue, const char *pszDefault )
+{
+    if( pszValue == nullptr )
+        pszValue = CPLGetConfigOption("GDAL_NUM_THREADS", pszDefault);
+    if( pszValue == nullptr )
+        return 1;
+    const int nThreads =
+        EQUAL(pszValue, "ALL_CPUS") ? CPLGetNumCPUs() : atoi(pszValue);
+    return std::max(1, std::min(nThreads, 128));
+}
+
 /************************************************************************/
 /*                             CPLGetTLS()                              */
 /************************************************************************/
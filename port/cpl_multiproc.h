@@ -107,6 +107,8 @@ void  CPL_DLL CPLSleep( double dfWaitInSeconds );
 const char CPL_DLL *CPLGetThreadingModel( void );
 
 int CPL_DLL CPLGetNumCPUs( void );
+int CPL_DLL CPLGetNumThreadsOption( const char *pszValue,
+                                    const char *pszDefault );
 
 typedef struct _CPLLock CPLLock;
 
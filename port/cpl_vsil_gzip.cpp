@@ -92,6 +92,9 @@
 #  include <sys/stat.h>
 #endif
 #include <zlib.h>
+#ifdef HAVE_LIBDEFLATE
+#  include "libdeflate.h"
+#endif
 
 #include <algorithm>
 #include <list>
@@ -113,6 +116,31 @@
 
 CPL_CVSID("$Id: cpl_vsil_gzip.cpp a720b845266cdba8890ac2eb41a098693edd16e7 2020-03-13 09:23:33 +0100 Even Rouault $")
 
+/************************************************************************/
+/*                          CPLGZipCRC32()                              */
+/************************************************************************/
+
+// Same result as zlib's crc32(), but without the 4 GB limit on the buffer
+// size, and using the faster (PCLMUL accelerated on x86) implementation of
+// libdeflate when available.
+static uLong CPLGZipCRC32( uLong nCRC, const void* pData, size_t nSize )
+{
+#ifdef HAVE_LIBDEFLATE
+    return libdeflate_crc32(static_cast<uint32_t>(nCRC), pData, nSize);
+#else
+    size_t nOffset = 0;
+    while( nOffset < nSize )
+    {
+        const uInt nChunk = static_cast<uInt>(
+            std::min(static_cast<size_t>(UINT_MAX), nSize - nOffset));
+        nCRC = crc32(nCRC, static_cast<const Bytef *>(pData) + nOffset,
+                     nChunk);
+        nOffset += nChunk;
+    }
+    return nCRC;
+#endif
+}
+
 constexpr int Z_BUFSIZE = 65536;  // Original size is 16384
 constexpr int gz_magic[2] = {0x1f, 0x8b};  // gzip magic header
 
@@ -1483,9 +1511,8 @@ void VSIGZipWriteHandleMT::CRCCompute(void* inData)
 {
     Job* psJob = static_cast<Job*>(inData);
     psJob->bInCRCComputation_ = true;
-    psJob->nCRC_ = crc32(0U,
-        reinterpret_cast<const Bytef*>(psJob->pBuffer_->data()),
-        static_cast<uInt>(psJob->pBuffer_->size()));
+    psJob->nCRC_ = static_cast<uInt>(CPLGZipCRC32(0U,
+        psJob->pBuffer_->data(), psJob->pBuffer_->size()));
 
     {
         std::lock_guard<std::mutex> oLock(psJob->pParent_->sMutex_);
@@ -1963,19 +1990,7 @@ size_t VSIGZipWriteHandle::Write( const void * const pBuffer,
 {
     size_t nBytesToWrite = nSize * nMemb;
 
-    {
-        size_t nOffset = 0;
-        while( nOffset < nBytesToWrite )
-        {
-            uInt nChunk = static_cast<uInt>(
-                std::min(static_cast<size_t>(UINT_MAX),
-                         nBytesToWrite - nOffset));
-            nCRC = crc32(nCRC,
-                         reinterpret_cast<const Bytef *>(pBuffer) + nOffset,
-                         nChunk);
-            nOffset += nChunk;
-        }
-    }
+    nCRC = CPLGZipCRC32(nCRC, pBuffer, nBytesToWrite);
 
     if( !bCompressActive )
         return 0;
@@ -3344,6 +3359,49 @@ void* CPLZLibDeflate( const void* ptr,
                       size_t nOutAvailableBytes,
                       size_t* pnOutBytes )
 {
+#ifdef HAVE_LIBDEFLATE
+    // The whole buffer is available, so libdeflate can be used.  Its level 7
+    // gives a compression ratio similar to the zlib default one.
+    struct libdeflate_compressor* enc = libdeflate_alloc_compressor(7);
+    if( enc != nullptr )
+    {
+        size_t nTmpSize = 0;
+        void* pTmp;
+        if( outptr == nullptr )
+        {
+            nTmpSize = libdeflate_zlib_compress_bound(enc, nBytes);
+            pTmp = VSIMalloc(nTmpSize);
+            if( pTmp == nullptr )
+            {
+                libdeflate_free_compressor(enc);
+                if( pnOutBytes != nullptr )
+                    *pnOutBytes = 0;
+                return nullptr;
+            }
+        }
+        else
+        {
+            pTmp = outptr;
+            nTmpSize = nOutAvailableBytes;
+        }
+
+        const size_t nCompressedBytes =
+            libdeflate_zlib_compress(enc, ptr, nBytes, pTmp, nTmpSize);
+        libdeflate_free_compressor(enc);
+        if( nCompressedBytes == 0 )
+        {
+            if( pTmp != outptr )
+                VSIFree(pTmp);
+            if( pnOutBytes != nullptr )
+                *pnOutBytes = 0;
+            return nullptr;
+        }
+        if( pnOutBytes != nullptr )
+            *pnOutBytes = nCompressedBytes;
+        return pTmp;
+    }
+#endif
+
     z_stream strm;
     strm.zalloc = nullptr;
     strm.zfree = nullptr;
@@ -3419,6 +3477,42 @@ void* CPLZLibInflate( const void* ptr, size_t nBytes,
                       void* outptr, size_t nOutAvailableBytes,
                       size_t* pnOutBytes )
 {
+#ifdef HAVE_LIBDEFLATE
+    // When the output buffer is provided, its size bounds the uncompressed
+    // size, and libdeflate can decompress the whole stream at once.
+    if( outptr != nullptr )
+    {
+        const GByte* pabyIn = static_cast<const GByte*>(ptr);
+        const bool bGZip = nBytes >= 2 && pabyIn[0] == 0x1F &&
+                           pabyIn[1] == 0x8B;
+        struct libdeflate_decompressor* dec = libdeflate_alloc_decompressor();
+        if( dec != nullptr )
+        {
+            size_t nOutBytes = 0;
+            const enum libdeflate_result res = bGZip ?
+                libdeflate_gzip_decompress(dec, ptr, nBytes,
+                                           outptr, nOutAvailableBytes,
+                                           &nOutBytes) :
+                libdeflate_zlib_decompress(dec, ptr, nBytes,
+                                           outptr, nOutAvailableBytes,
+                                           &nOutBytes);
+            libdeflate_free_decompressor(dec);
+            if( res != LIBDEFLATE_SUCCESS )
+            {
+                if( pnOutBytes != nullptr )
+                    *pnOutBytes = 0;
+                return nullptr;
+            }
+            // Nul-terminate if possible.
+            if( nOutBytes < nOutAvailableBytes )
+                static_cast<char *>(outptr)[nOutBytes] = '\0';
+            if( pnOutBytes != nullptr )
+                *pnOutBytes = nOutBytes;
+            return outptr;
+        }
+    }
+#endif
+
     z_stream strm;
     strm.zalloc = nullptr;
     strm.zfree = nullptr;